@@ -0,0 +1,491 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "rmw/rmw.h"
+
+#include "benchmark_common.hpp"
+
+namespace
+{
+std::atomic<uint64_t> g_allocations{0};
+}  // namespace
+
+// Counts the allocations of the whole process, including the ones of the rmw
+void * operator new(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void * ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t & tag) noexcept
+{
+  return operator new(size, tag);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace benchmark
+{
+static rmw_qos_profile_t
+declare_qos(rclcpp::Node & node)
+{
+  rmw_qos_profile_t qos = rmw_qos_profile_default;
+  const std::string reliability =
+    node.declare_parameter<std::string>("reliability", "reliable");
+  const std::string durability = node.declare_parameter<std::string>("durability", "volatile");
+  const int64_t depth = node.declare_parameter<int64_t>("depth", 10);
+
+  qos.reliability = reliability == "best_effort" ?
+    RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT : RMW_QOS_POLICY_RELIABILITY_RELIABLE;
+  qos.durability = durability == "transient_local" ?
+    RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL : RMW_QOS_POLICY_DURABILITY_VOLATILE;
+  // A depth of 0 keeps all samples
+  qos.history = depth > 0 ? RMW_QOS_POLICY_HISTORY_KEEP_LAST : RMW_QOS_POLICY_HISTORY_KEEP_ALL;
+  qos.depth = depth > 0 ? static_cast<size_t>(depth) : 0;
+  return qos;
+}
+
+Options
+declare_options(rclcpp::Node & node)
+{
+  Options options;
+  options.type = node.declare_parameter<std::string>("type", "bytes");
+  options.typesupport = node.declare_parameter<std::string>("typesupport", "cpp");
+  options.size = static_cast<size_t>(
+    std::max<int64_t>(
+      node.declare_parameter<int64_t>("size", 1024), static_cast<int64_t>(kHeaderSize)));
+  options.rate = node.declare_parameter<double>("rate", 0.0);
+  options.count = static_cast<uint64_t>(
+    std::max<int64_t>(node.declare_parameter<int64_t>("count", 10000), 1));
+  options.warmup = static_cast<uint64_t>(
+    std::max<int64_t>(node.declare_parameter<int64_t>("warmup", 100), 0));
+  options.topic = node.declare_parameter<std::string>("topic", "benchmark");
+  options.qos = declare_qos(node);
+  options.timeout = node.declare_parameter<double>("timeout", 10.0);
+  options.output = node.declare_parameter<std::string>("output", "");
+  return options;
+}
+
+uint64_t
+now_ns()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t
+allocation_count()
+{
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t
+cpu_time_ns()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  auto to_ns = [](const struct timeval & tv) {
+      return static_cast<uint64_t>(tv.tv_sec) * 1000000000ull +
+             static_cast<uint64_t>(tv.tv_usec) * 1000ull;
+    };
+  return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+}
+
+void
+write_header(uint8_t * payload, uint64_t sequence_number, uint64_t timestamp)
+{
+  char header[kHeaderSize + 1];
+  std::snprintf(header, sizeof(header), "%016" PRIx64 "%016" PRIx64, sequence_number, timestamp);
+  std::memcpy(payload, header, kHeaderSize);
+}
+
+void
+read_header(const uint8_t * payload, uint64_t * sequence_number, uint64_t * timestamp)
+{
+  char field[kHeaderSize / 2 + 1] = {};
+  std::memcpy(field, payload, kHeaderSize / 2);
+  *sequence_number = std::strtoull(field, nullptr, 16);
+  std::memcpy(field, payload + kHeaderSize / 2, kHeaderSize / 2);
+  *timestamp = std::strtoull(field, nullptr, 16);
+}
+
+static std::string
+quote(const std::string & value)
+{
+  std::string quoted = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  quoted += '"';
+  return quoted;
+}
+
+void
+JsonObject::add_raw(const std::string & key, const std::string & value)
+{
+  if (!body_.empty()) {
+    body_ += ", ";
+  }
+  body_ += quote(key) + ": " + value;
+}
+
+JsonObject &
+JsonObject::add(const std::string & key, const std::string & value)
+{
+  add_raw(key, quote(value));
+  return *this;
+}
+
+JsonObject &
+JsonObject::add(const std::string & key, const char * value)
+{
+  add_raw(key, quote(value));
+  return *this;
+}
+
+JsonObject &
+JsonObject::add(const std::string & key, double value)
+{
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", value);
+  add_raw(key, text);
+  return *this;
+}
+
+JsonObject &
+JsonObject::add(const std::string & key, uint64_t value)
+{
+  add_raw(key, std::to_string(value));
+  return *this;
+}
+
+JsonObject &
+JsonObject::add(const std::string & key, const JsonObject & value)
+{
+  add_raw(key, value.str());
+  return *this;
+}
+
+std::string
+JsonObject::str() const
+{
+  return "{" + body_ + "}";
+}
+
+JsonObject
+summarize_latency(std::vector<uint64_t> latencies_ns)
+{
+  JsonObject summary;
+  summary.add("samples", static_cast<uint64_t>(latencies_ns.size()));
+  if (latencies_ns.empty()) {
+    return summary;
+  }
+
+  std::sort(latencies_ns.begin(), latencies_ns.end());
+  auto percentile = [&latencies_ns](double p) {
+      size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(latencies_ns.size()));
+      index = std::min(index, latencies_ns.size() - 1);
+      return static_cast<double>(latencies_ns[index]) / 1000.0;
+    };
+
+  uint64_t sum = 0;
+  for (uint64_t latency : latencies_ns) {
+    sum += latency;
+  }
+
+  summary
+  .add("min", static_cast<double>(latencies_ns.front()) / 1000.0)
+  .add("mean", static_cast<double>(sum) / static_cast<double>(latencies_ns.size()) / 1000.0)
+  .add("p50", percentile(50.0))
+  .add("p90", percentile(90.0))
+  .add("p99", percentile(99.0))
+  .add("p99.9", percentile(99.9))
+  .add("max", static_cast<double>(latencies_ns.back()) / 1000.0);
+  return summary;
+}
+
+JsonObject
+describe_options(const Options & options)
+{
+  JsonObject qos;
+  qos
+  .add(
+    "reliability",
+    options.qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT ? "best_effort" : "reliable")
+  .add(
+    "durability",
+    options.qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL ?
+    "transient_local" : "volatile")
+  .add("depth", static_cast<uint64_t>(options.qos.depth));
+
+  JsonObject description;
+  description
+  .add("rmw", rmw_get_implementation_identifier())
+  .add("type", options.type == "string" ? "string" : "bytes")
+  .add("typesupport", options.typesupport == "c" ? "c" : "cpp")
+  .add("size", static_cast<uint64_t>(options.size))
+  .add("rate", options.rate)
+  .add("count", options.count)
+  .add("warmup", options.warmup)
+  .add("qos", qos);
+  return description;
+}
+
+bool
+write_result(const std::string & output, const JsonObject & result)
+{
+  if (output.empty()) {
+    std::cout << result.str() << std::endl;
+    return true;
+  }
+
+  std::ofstream file(output, std::ios::app);
+  if (!file) {
+    std::cerr << "failed to open " << output << std::endl;
+    return false;
+  }
+  file << result.str() << std::endl;
+  return true;
+}
+
+bool
+write_result(const Options & options, const JsonObject & result)
+{
+  return write_result(options.output, result);
+}
+
+void
+ResourceMeter::start()
+{
+  wall_ns_ = now_ns();
+  cpu_ns_ = cpu_time_ns();
+  allocations_ = allocation_count();
+}
+
+void
+ResourceMeter::stop()
+{
+  wall_ns_ = now_ns() - wall_ns_;
+  cpu_ns_ = cpu_time_ns() - cpu_ns_;
+  allocations_ = allocation_count() - allocations_;
+}
+
+double
+ResourceMeter::cpu_percent() const
+{
+  if (wall_ns_ == 0) {
+    return 0.0;
+  }
+  return 100.0 * static_cast<double>(cpu_ns_) / static_cast<double>(wall_ns_);
+}
+
+double
+ResourceMeter::seconds() const
+{
+  return static_cast<double>(wall_ns_) / 1e9;
+}
+
+double
+ResourceMeter::allocations_per(uint64_t messages) const
+{
+  if (messages == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(allocations_) / static_cast<double>(messages);
+}
+
+Publisher::Publisher(
+  rcl_node_t * node, const rosidl_message_type_support_t * type_support,
+  const std::string & topic, const rmw_qos_profile_t & qos)
+: node_{node}, publisher_{rcl_get_zero_initialized_publisher()}
+{
+  rcl_publisher_options_t options = rcl_publisher_get_default_options();
+  options.qos = qos;
+  if (rcl_publisher_init(&publisher_, node_, type_support, topic.c_str(), &options) != RCL_RET_OK) {
+    const std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error("failed to create publisher: " + error);
+  }
+}
+
+Publisher::~Publisher()
+{
+  (void)rcl_publisher_fini(&publisher_, node_);
+}
+
+bool
+Publisher::publish(const void * message)
+{
+  if (rcl_publish(&publisher_, message, nullptr) != RCL_RET_OK) {
+    rcl_reset_error();
+    return false;
+  }
+  return true;
+}
+
+size_t
+Publisher::subscription_count() const
+{
+  size_t count = 0;
+  if (rcl_publisher_get_subscription_count(&publisher_, &count) != RCL_RET_OK) {
+    rcl_reset_error();
+    return 0;
+  }
+  return count;
+}
+
+Subscription::Subscription(
+  rcl_node_t * node, rcl_context_t * context,
+  const rosidl_message_type_support_t * type_support,
+  const std::string & topic, const rmw_qos_profile_t & qos)
+: node_{node},
+  subscription_{rcl_get_zero_initialized_subscription()},
+  wait_set_{rcl_get_zero_initialized_wait_set()}
+{
+  rcl_subscription_options_t options = rcl_subscription_get_default_options();
+  options.qos = qos;
+  if (rcl_subscription_init(
+      &subscription_, node_, type_support, topic.c_str(), &options) != RCL_RET_OK)
+  {
+    const std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error("failed to create subscription: " + error);
+  }
+
+  if (rcl_wait_set_init(
+      &wait_set_, 1, 0, 0, 0, 0, 0, context, rcl_get_default_allocator()) != RCL_RET_OK)
+  {
+    const std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    (void)rcl_subscription_fini(&subscription_, node_);
+    throw std::runtime_error("failed to create wait set: " + error);
+  }
+}
+
+Subscription::~Subscription()
+{
+  (void)rcl_wait_set_fini(&wait_set_);
+  (void)rcl_subscription_fini(&subscription_, node_);
+}
+
+bool
+Subscription::wait(std::chrono::nanoseconds timeout)
+{
+  if (rcl_wait_set_clear(&wait_set_) != RCL_RET_OK ||
+    rcl_wait_set_add_subscription(&wait_set_, &subscription_, nullptr) != RCL_RET_OK)
+  {
+    rcl_reset_error();
+    return false;
+  }
+
+  rcl_ret_t ret = rcl_wait(&wait_set_, timeout.count());
+  if (ret != RCL_RET_OK) {
+    rcl_reset_error();
+    return false;
+  }
+  return wait_set_.subscriptions[0] != nullptr;
+}
+
+bool
+Subscription::take(void * message)
+{
+  rmw_message_info_t message_info = rmw_get_zero_initialized_message_info();
+  rcl_ret_t ret = rcl_take(&subscription_, message, &message_info, nullptr);
+  if (ret != RCL_RET_OK) {
+    rcl_reset_error();
+    return false;
+  }
+  return true;
+}
+
+size_t
+Subscription::publisher_count() const
+{
+  size_t count = 0;
+  if (rcl_subscription_get_publisher_count(&subscription_, &count) != RCL_RET_OK) {
+    rcl_reset_error();
+    return 0;
+  }
+  return count;
+}
+
+bool
+wait_for_match(const Publisher * publisher, const Subscription * subscription, double timeout)
+{
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(timeout));
+  while (rclcpp::ok() && std::chrono::steady_clock::now() < deadline) {
+    if ((publisher == nullptr || publisher->subscription_count() > 0) &&
+      (subscription == nullptr || subscription->publisher_count() > 0))
+    {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+}  // namespace benchmark
@@ -0,0 +1,293 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BENCHMARK_COMMON_HPP_
+#define BENCHMARK_COMMON_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/rcl.h"
+#include "rclcpp/rclcpp.hpp"
+#include "rosidl_runtime_c/primitives_sequence_functions.h"
+#include "rosidl_runtime_c/string_functions.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "std_msgs/msg/string.h"
+#include "std_msgs/msg/string.hpp"
+#include "std_msgs/msg/u_int8_multi_array.h"
+#include "std_msgs/msg/u_int8_multi_array.hpp"
+
+namespace benchmark
+{
+// Every payload starts with the sequence number and send time as hex text, so that
+// string and byte messages carry the same header
+constexpr size_t kHeaderSize = 32;
+
+struct Options
+{
+  // "bytes" (std_msgs/UInt8MultiArray) or "string" (std_msgs/String)
+  std::string type;
+  // "cpp" or "c"
+  std::string typesupport;
+  size_t size;
+  // Messages per second, 0 sends as fast as possible
+  double rate;
+  uint64_t count;
+  uint64_t warmup;
+  std::string topic;
+  rmw_qos_profile_t qos;
+  // Seconds to wait for a match or a message
+  double timeout;
+  // Result file, empty writes the result to stdout
+  std::string output;
+};
+
+// Declares the common parameters on the node and reads them
+Options declare_options(rclcpp::Node & node);
+
+uint64_t now_ns();
+
+// Heap allocations made through operator new since the start of the process
+uint64_t allocation_count();
+
+// User and system CPU time of the process
+uint64_t cpu_time_ns();
+
+void write_header(uint8_t * payload, uint64_t sequence_number, uint64_t timestamp);
+
+void read_header(const uint8_t * payload, uint64_t * sequence_number, uint64_t * timestamp);
+
+// Flat JSON object, values are added in order
+class JsonObject
+{
+public:
+  JsonObject & add(const std::string & key, const std::string & value);
+  JsonObject & add(const std::string & key, const char * value);
+  JsonObject & add(const std::string & key, double value);
+  JsonObject & add(const std::string & key, uint64_t value);
+  JsonObject & add(const std::string & key, const JsonObject & value);
+
+  std::string str() const;
+
+private:
+  void add_raw(const std::string & key, const std::string & value);
+
+  std::string body_;
+};
+
+// Percentiles of a latency sample in microseconds
+JsonObject summarize_latency(std::vector<uint64_t> latencies_ns);
+
+// Parameters of the run, common to every benchmark result
+JsonObject describe_options(const Options & options);
+
+// Writes the result as one line to the output file, or to stdout if it is empty
+bool write_result(const std::string & output, const JsonObject & result);
+
+bool write_result(const Options & options, const JsonObject & result);
+
+// Measures CPU time and allocations over the measured part of a run
+class ResourceMeter
+{
+public:
+  void start();
+  void stop();
+
+  // CPU time of the process over wall time, in percent of one core
+  double cpu_percent() const;
+  // Wall time between start and stop
+  double seconds() const;
+  double allocations_per(uint64_t messages) const;
+
+private:
+  uint64_t wall_ns_{0};
+  uint64_t cpu_ns_{0};
+  uint64_t allocations_{0};
+};
+
+class Publisher
+{
+public:
+  Publisher(
+    rcl_node_t * node, const rosidl_message_type_support_t * type_support,
+    const std::string & topic, const rmw_qos_profile_t & qos);
+  ~Publisher();
+
+  bool publish(const void * message);
+  size_t subscription_count() const;
+
+private:
+  rcl_node_t * node_;
+  rcl_publisher_t publisher_;
+};
+
+class Subscription
+{
+public:
+  Subscription(
+    rcl_node_t * node, rcl_context_t * context,
+    const rosidl_message_type_support_t * type_support,
+    const std::string & topic, const rmw_qos_profile_t & qos);
+  ~Subscription();
+
+  // Waits until a message may be taken, false on timeout
+  bool wait(std::chrono::nanoseconds timeout);
+  // False if there was no message to take
+  bool take(void * message);
+  size_t publisher_count() const;
+
+private:
+  rcl_node_t * node_;
+  rcl_subscription_t subscription_;
+  rcl_wait_set_t wait_set_;
+};
+
+// Waits for the publisher and the subscription to be matched with a remote endpoint
+bool wait_for_match(
+  const Publisher * publisher, const Subscription * subscription, double timeout);
+
+struct CppBytes
+{
+  using Message = std_msgs::msg::UInt8MultiArray;
+
+  static const rosidl_message_type_support_t * type_support()
+  {
+    return rosidl_typesupport_cpp::get_message_type_support_handle<Message>();
+  }
+  static void init(Message & message, size_t size) {message.data.resize(size);}
+  static void fini(Message &) {}
+  static uint8_t * payload(Message & message) {return message.data.data();}
+  static size_t payload_size(const Message & message) {return message.data.size();}
+};
+
+struct CppString
+{
+  using Message = std_msgs::msg::String;
+
+  static const rosidl_message_type_support_t * type_support()
+  {
+    return rosidl_typesupport_cpp::get_message_type_support_handle<Message>();
+  }
+  static void init(Message & message, size_t size) {message.data.assign(size, 'x');}
+  static void fini(Message &) {}
+  static uint8_t * payload(Message & message)
+  {
+    return reinterpret_cast<uint8_t *>(&message.data[0]);
+  }
+  static size_t payload_size(const Message & message) {return message.data.size();}
+};
+
+struct CBytes
+{
+  using Message = std_msgs__msg__UInt8MultiArray;
+
+  static const rosidl_message_type_support_t * type_support()
+  {
+    return ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray);
+  }
+  static void init(Message & message, size_t size)
+  {
+    std_msgs__msg__UInt8MultiArray__init(&message);
+    rosidl_runtime_c__uint8__Sequence__fini(&message.data);
+    rosidl_runtime_c__uint8__Sequence__init(&message.data, size);
+  }
+  static void fini(Message & message) {std_msgs__msg__UInt8MultiArray__fini(&message);}
+  static uint8_t * payload(Message & message) {return message.data.data;}
+  static size_t payload_size(const Message & message) {return message.data.size;}
+};
+
+struct CString
+{
+  using Message = std_msgs__msg__String;
+
+  static const rosidl_message_type_support_t * type_support()
+  {
+    return ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String);
+  }
+  static void init(Message & message, size_t size)
+  {
+    std_msgs__msg__String__init(&message);
+    const std::string data(size, 'x');
+    rosidl_runtime_c__String__assignn(&message.data, data.c_str(), size);
+  }
+  static void fini(Message & message) {std_msgs__msg__String__fini(&message);}
+  static uint8_t * payload(Message & message)
+  {
+    return reinterpret_cast<uint8_t *>(message.data.data);
+  }
+  static size_t payload_size(const Message & message) {return message.data.size;}
+};
+
+// Message of a benchmark type, initialized to the payload size of the run
+template<typename Traits>
+class BenchmarkMessage
+{
+public:
+  explicit BenchmarkMessage(size_t size)
+  {
+    Traits::init(message_, size);
+  }
+
+  ~BenchmarkMessage()
+  {
+    Traits::fini(message_);
+  }
+
+  BenchmarkMessage(const BenchmarkMessage &) = delete;
+  BenchmarkMessage & operator=(const BenchmarkMessage &) = delete;
+
+  typename Traits::Message * get() {return &message_;}
+
+  void stamp(uint64_t sequence_number, uint64_t timestamp)
+  {
+    write_header(Traits::payload(message_), sequence_number, timestamp);
+  }
+
+  // False if the payload is too short to hold a header
+  bool read(uint64_t * sequence_number, uint64_t * timestamp)
+  {
+    if (Traits::payload_size(message_) < kHeaderSize) {
+      return false;
+    }
+    read_header(Traits::payload(message_), sequence_number, timestamp);
+    return true;
+  }
+
+private:
+  typename Traits::Message message_{};
+};
+
+// Calls run<Traits>(args...) with the message traits selected by the options
+template<template<typename> class Runner, typename ... Args>
+int dispatch(const Options & options, Args && ... args)
+{
+  if (options.typesupport == "c") {
+    if (options.type == "string") {
+      return Runner<CString>::run(options, std::forward<Args>(args)...);
+    }
+    return Runner<CBytes>::run(options, std::forward<Args>(args)...);
+  }
+  if (options.type == "string") {
+    return Runner<CppString>::run(options, std::forward<Args>(args)...);
+  }
+  return Runner<CppBytes>::run(options, std::forward<Args>(args)...);
+}
+}  // namespace benchmark
+
+#endif  // BENCHMARK_COMMON_HPP_
@@ -0,0 +1,422 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Startup and discovery time at scale. The launcher spawns `processes` worker processes, each
+// creates `nodes` nodes with `endpoints` publishers and subscriptions on the same `endpoints`
+// topics. A worker measures, from the start of rclcpp::init:
+//   - the creation of its nodes and endpoints
+//   - convergence, when every one of its nodes counts all the publishers and subscriptions
+//   - delivery, when every one of its subscriptions received a message
+// and reports it to the launcher, which releases the workers once every report arrived.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds discovery --ros-args -p processes:=8 -p nodes:=4
+//
+// Across hosts, start a launcher on each host with the same parameters and hosts:=<count>.
+// The network traffic of the launcher result is counted for the whole host, on Linux.
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rmw/rmw.h"
+#include "std_msgs/msg/float64_multi_array.hpp"
+#include "std_msgs/msg/string.hpp"
+
+#include "benchmark_common.hpp"
+
+extern char ** environ;
+
+namespace
+{
+struct DiscoveryOptions
+{
+  int64_t processes;
+  int64_t nodes;
+  int64_t endpoints;
+  int64_t hosts;
+  double timeout;
+  std::string output;
+};
+
+// Layout of the report a worker sends to the launchers
+enum ReportField
+{
+  REPORT_PID,
+  REPORT_CONVERGED,
+  REPORT_INIT_MS,
+  REPORT_NODES_MS,
+  REPORT_ENDPOINTS_MS,
+  REPORT_CONVERGED_MS,
+  REPORT_FIRST_MESSAGE_MS,
+  REPORT_ALL_RECEIVED_MS,
+  REPORT_FIELD_COUNT
+};
+
+const char * const kReportTopic = "discovery_report";
+const char * const kDoneTopic = "discovery_done";
+
+rclcpp::QoS
+control_qos()
+{
+  return rclcpp::QoS(rclcpp::KeepAll()).reliable().transient_local();
+}
+
+DiscoveryOptions
+declare_discovery_options(rclcpp::Node & node)
+{
+  DiscoveryOptions options;
+  options.processes = std::max<int64_t>(node.declare_parameter<int64_t>("processes", 4), 1);
+  options.nodes = std::max<int64_t>(node.declare_parameter<int64_t>("nodes", 4), 1);
+  options.endpoints = std::max<int64_t>(node.declare_parameter<int64_t>("endpoints", 4), 1);
+  options.hosts = std::max<int64_t>(node.declare_parameter<int64_t>("hosts", 1), 1);
+  options.timeout = node.declare_parameter<double>("timeout", 60.0);
+  options.output = node.declare_parameter<std::string>("output", "");
+  return options;
+}
+
+double
+ms_since(uint64_t start_ns, uint64_t time_ns)
+{
+  return time_ns == 0 ? -1.0 : static_cast<double>(time_ns - start_ns) / 1e6;
+}
+
+// Host wide counters of /proc, zero where they cannot be read
+struct TrafficCounters
+{
+  uint64_t udp_datagrams_sent{0};
+  uint64_t udp_datagrams_received{0};
+  uint64_t bytes_sent{0};
+
+  static TrafficCounters read()
+  {
+    TrafficCounters counters;
+    std::ifstream snmp("/proc/net/snmp");
+    std::string header;
+    std::string values;
+    while (std::getline(snmp, header) && std::getline(snmp, values)) {
+      if (header.compare(0, 4, "Udp:") != 0) {
+        continue;
+      }
+      std::istringstream names(header);
+      std::istringstream numbers(values);
+      std::string name;
+      std::string number;
+      while (names >> name && numbers >> number) {
+        if (name == "OutDatagrams") {
+          counters.udp_datagrams_sent = std::stoull(number);
+        } else if (name == "InDatagrams") {
+          counters.udp_datagrams_received = std::stoull(number);
+        }
+      }
+      break;
+    }
+
+    // Interface lines are "name: rx_bytes <7 rx fields> tx_bytes ..."
+    std::ifstream dev("/proc/net/dev");
+    std::string line;
+    while (std::getline(dev, line)) {
+      const size_t colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      std::istringstream fields(line.substr(colon + 1));
+      uint64_t field = 0;
+      for (int i = 0; i < 9 && fields >> field; i++) {
+        if (i == 8) {
+          counters.bytes_sent += field;
+        }
+      }
+    }
+    return counters;
+  }
+};
+
+int
+run_worker(const DiscoveryOptions & options, uint64_t start_ns, uint64_t init_ns)
+{
+  const size_t expected =
+    static_cast<size_t>(options.hosts * options.processes * options.nodes);
+  const uint64_t timeout_ns = static_cast<uint64_t>(options.timeout * 1e9);
+  const std::string prefix = "discovery_" + std::to_string(getpid()) + "_";
+
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  for (int64_t m = 0; m < options.nodes; m++) {
+    nodes.push_back(std::make_shared<rclcpp::Node>(prefix + std::to_string(m)));
+  }
+  const uint64_t nodes_ns = benchmark::now_ns();
+
+  std::vector<rclcpp::Publisher<std_msgs::msg::String>::SharedPtr> publishers;
+  std::vector<rclcpp::Subscription<std_msgs::msg::String>::SharedPtr> subscriptions;
+  const size_t subscription_count = static_cast<size_t>(options.nodes * options.endpoints);
+  std::unique_ptr<std::atomic<bool>[]> received(new std::atomic<bool>[subscription_count]);
+  std::atomic<uint64_t> first_message_ns{0};
+  std::atomic<size_t> received_count{0};
+  for (auto & node : nodes) {
+    for (int64_t k = 0; k < options.endpoints; k++) {
+      const std::string topic = "discovery_" + std::to_string(k);
+      publishers.push_back(node->create_publisher<std_msgs::msg::String>(topic, 10));
+      std::atomic<bool> * flag = &received[subscriptions.size()];
+      flag->store(false);
+      subscriptions.push_back(
+        node->create_subscription<std_msgs::msg::String>(
+          topic, 10,
+          [flag, &first_message_ns, &received_count](const std_msgs::msg::String::SharedPtr) {
+            uint64_t none = 0;
+            first_message_ns.compare_exchange_strong(none, benchmark::now_ns());
+            if (!flag->exchange(true)) {
+              received_count.fetch_add(1);
+            }
+          }));
+    }
+  }
+  const uint64_t endpoints_ns = benchmark::now_ns();
+
+  auto report_pub = nodes.front()->create_publisher<std_msgs::msg::Float64MultiArray>(
+    kReportTopic, control_qos());
+  std::atomic<bool> released{false};
+  auto done_sub = nodes.front()->create_subscription<std_msgs::msg::String>(
+    kDoneTopic, control_qos(),
+    [&released](const std_msgs::msg::String::SharedPtr) {released.store(true);});
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  for (auto & node : nodes) {
+    executor.add_node(node);
+  }
+  std::thread spinner([&executor]() {executor.spin();});
+
+  // Every node counts the endpoints of every process on each topic
+  auto converged = [&nodes, &options, expected]() {
+      for (auto & node : nodes) {
+        for (int64_t k = 0; k < options.endpoints; k++) {
+          const std::string topic = "/discovery_" + std::to_string(k);
+          if (node->count_publishers(topic) < expected ||
+            node->count_subscribers(topic) < expected)
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    };
+
+  uint64_t converged_ns = 0;
+  uint64_t all_received_ns = 0;
+  uint64_t next_publish = 0;
+  std_msgs::msg::String message;
+  message.data = "discovery";
+  while (rclcpp::ok() && benchmark::now_ns() - start_ns < timeout_ns) {
+    if (converged_ns == 0 && converged()) {
+      converged_ns = benchmark::now_ns();
+    }
+    if (all_received_ns == 0 && received_count.load() == subscription_count) {
+      all_received_ns = benchmark::now_ns();
+    }
+    if (converged_ns != 0 && all_received_ns != 0) {
+      break;
+    }
+
+    // Publishers send at 10 Hz so that late subscriptions get a message too
+    if (benchmark::now_ns() >= next_publish) {
+      for (auto & publisher : publishers) {
+        publisher->publish(message);
+      }
+      next_publish = benchmark::now_ns() + 100000000;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std_msgs::msg::Float64MultiArray report;
+  report.data.assign(REPORT_FIELD_COUNT, -1.0);
+  report.data[REPORT_PID] = static_cast<double>(getpid());
+  report.data[REPORT_CONVERGED] = converged_ns != 0 && all_received_ns != 0 ? 1.0 : 0.0;
+  report.data[REPORT_INIT_MS] = ms_since(start_ns, init_ns);
+  report.data[REPORT_NODES_MS] = ms_since(start_ns, nodes_ns);
+  report.data[REPORT_ENDPOINTS_MS] = ms_since(start_ns, endpoints_ns);
+  report.data[REPORT_CONVERGED_MS] = ms_since(start_ns, converged_ns);
+  report.data[REPORT_FIRST_MESSAGE_MS] = ms_since(start_ns, first_message_ns.load());
+  report.data[REPORT_ALL_RECEIVED_MS] = ms_since(start_ns, all_received_ns);
+  report_pub->publish(report);
+
+  // The endpoints stay alive until every process converged, or the launcher is gone
+  while (rclcpp::ok() && !released.load() && benchmark::now_ns() - start_ns < 2 * timeout_ns) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  executor.cancel();
+  spinner.join();
+  return report.data[REPORT_CONVERGED] > 0.0 ? 0 : 1;
+}
+
+benchmark::JsonObject
+summarize_field(const std::vector<std::vector<double>> & reports, ReportField field)
+{
+  double max = 0.0;
+  double sum = 0.0;
+  size_t count = 0;
+  for (const auto & report : reports) {
+    if (report[field] < 0.0) {
+      continue;
+    }
+    max = std::max(max, report[field]);
+    sum += report[field];
+    count++;
+  }
+
+  benchmark::JsonObject summary;
+  summary
+  .add("mean", count == 0 ? -1.0 : sum / static_cast<double>(count))
+  .add("max", count == 0 ? -1.0 : max);
+  return summary;
+}
+
+int
+run_launcher(
+  const DiscoveryOptions & options, rclcpp::Node::SharedPtr node, const char * executable)
+{
+  const size_t expected_reports = static_cast<size_t>(options.hosts * options.processes);
+  std::vector<std::vector<double>> reports;
+  std::mutex reports_mutex;
+  auto report_sub = node->create_subscription<std_msgs::msg::Float64MultiArray>(
+    kReportTopic, control_qos(),
+    [&reports, &reports_mutex](const std_msgs::msg::Float64MultiArray::SharedPtr report) {
+      if (report->data.size() == REPORT_FIELD_COUNT) {
+        std::lock_guard<std::mutex> guard(reports_mutex);
+        reports.push_back(report->data);
+      }
+    });
+  auto done_pub = node->create_publisher<std_msgs::msg::String>(kDoneTopic, control_qos());
+
+  const TrafficCounters traffic_start = TrafficCounters::read();
+  const uint64_t start_ns = benchmark::now_ns();
+
+  std::vector<std::string> args = {
+    executable, "--ros-args",
+    "-p", "role:=worker",
+    "-p", "processes:=" + std::to_string(options.processes),
+    "-p", "nodes:=" + std::to_string(options.nodes),
+    "-p", "endpoints:=" + std::to_string(options.endpoints),
+    "-p", "hosts:=" + std::to_string(options.hosts),
+    "-p", "timeout:=" + std::to_string(options.timeout),
+  };
+  std::vector<char *> argv;
+  for (auto & arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  std::vector<pid_t> workers;
+  for (int64_t i = 0; i < options.processes; i++) {
+    pid_t pid = 0;
+    if (posix_spawn(&pid, executable, nullptr, nullptr, argv.data(), environ) != 0) {
+      std::cerr << "failed to spawn worker " << i << std::endl;
+      continue;
+    }
+    workers.push_back(pid);
+  }
+
+  const uint64_t timeout_ns = static_cast<uint64_t>(options.timeout * 1e9);
+  uint64_t complete_ns = 0;
+  while (rclcpp::ok() && benchmark::now_ns() - start_ns < timeout_ns) {
+    rclcpp::spin_some(node);
+    std::lock_guard<std::mutex> guard(reports_mutex);
+    if (reports.size() >= expected_reports) {
+      complete_ns = benchmark::now_ns();
+      break;
+    }
+  }
+  const TrafficCounters traffic_end = TrafficCounters::read();
+
+  std_msgs::msg::String done;
+  done.data = "done";
+  done_pub->publish(done);
+  for (pid_t pid : workers) {
+    int status = 0;
+    if (complete_ns == 0) {
+      kill(pid, SIGINT);
+    }
+    waitpid(pid, &status, 0);
+  }
+
+  size_t converged = 0;
+  for (const auto & report : reports) {
+    converged += report[REPORT_CONVERGED] > 0.0 ? 1 : 0;
+  }
+
+  benchmark::JsonObject traffic;
+  traffic
+  .add("udp_datagrams_sent", traffic_end.udp_datagrams_sent - traffic_start.udp_datagrams_sent)
+  .add(
+    "udp_datagrams_received",
+    traffic_end.udp_datagrams_received - traffic_start.udp_datagrams_received)
+  .add("bytes_sent", traffic_end.bytes_sent - traffic_start.bytes_sent);
+
+  benchmark::JsonObject result;
+  result
+  .add("benchmark", "discovery")
+  .add("rmw", rmw_get_implementation_identifier())
+  .add("hosts", static_cast<uint64_t>(options.hosts))
+  .add("processes", static_cast<uint64_t>(options.processes))
+  .add("nodes", static_cast<uint64_t>(options.nodes))
+  .add("endpoints", static_cast<uint64_t>(options.endpoints))
+  .add("reports", static_cast<uint64_t>(reports.size()))
+  .add("converged", static_cast<uint64_t>(converged))
+  .add("launch_to_all_reports_ms", ms_since(start_ns, complete_ns))
+  .add("init_ms", summarize_field(reports, REPORT_INIT_MS))
+  .add("nodes_created_ms", summarize_field(reports, REPORT_NODES_MS))
+  .add("endpoints_created_ms", summarize_field(reports, REPORT_ENDPOINTS_MS))
+  .add("converged_ms", summarize_field(reports, REPORT_CONVERGED_MS))
+  .add("first_message_ms", summarize_field(reports, REPORT_FIRST_MESSAGE_MS))
+  .add("all_received_ms", summarize_field(reports, REPORT_ALL_RECEIVED_MS))
+  .add("host_traffic", traffic);
+  benchmark::write_result(options.output, result);
+  return complete_ns != 0 && converged == expected_reports ? 0 : 1;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  const uint64_t start_ns = benchmark::now_ns();
+  rclcpp::init(argc, argv);
+  const uint64_t init_ns = benchmark::now_ns();
+
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>(
+      "discovery_" + std::to_string(getpid()),
+      rclcpp::NodeOptions().start_parameter_services(false));
+    const std::string role = node->declare_parameter<std::string>("role", "launcher");
+    const DiscoveryOptions options = declare_discovery_options(*node);
+    if (role == "worker") {
+      // Workers only use their own nodes, so that the count of the graph is exact
+      node.reset();
+      ret = run_worker(options, start_ns, init_ns);
+    } else {
+      ret = run_launcher(options, node, "/proc/self/exe");
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,203 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Round trip latency: the ping process publishes a message and waits for the pong process
+// to publish it back before sending the next one.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds ping_pong --ros-args -p role:=pong
+//   ros2 run demo_nodes_cpp_native_gurumdds ping_pong --ros-args -p role:=ping -p size:=65536
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "benchmark_common.hpp"
+
+using benchmark::BenchmarkMessage;
+
+template<typename Traits>
+struct PingPong
+{
+  static int run(const benchmark::Options & options, rclcpp::Node & node, const std::string & role)
+  {
+    rcl_node_t * rcl_node = node.get_node_base_interface()->get_rcl_node_handle();
+    rcl_context_t * context =
+      node.get_node_base_interface()->get_context()->get_rcl_context().get();
+    const rosidl_message_type_support_t * type_support = Traits::type_support();
+
+    if (role == "pong") {
+      benchmark::Subscription ping_sub(
+        rcl_node, context, type_support, options.topic + "_ping", options.qos);
+      benchmark::Publisher pong_pub(rcl_node, type_support, options.topic + "_pong", options.qos);
+      return pong(options, ping_sub, pong_pub);
+    }
+
+    benchmark::Publisher ping_pub(rcl_node, type_support, options.topic + "_ping", options.qos);
+    benchmark::Subscription pong_sub(
+      rcl_node, context, type_support, options.topic + "_pong", options.qos);
+    return ping(options, ping_pub, pong_sub);
+  }
+
+  static int ping(
+    const benchmark::Options & options,
+    benchmark::Publisher & ping_pub,
+    benchmark::Subscription & pong_sub)
+  {
+    if (!benchmark::wait_for_match(&ping_pub, &pong_sub, options.timeout)) {
+      std::cerr << "no pong process was discovered" << std::endl;
+      return 1;
+    }
+
+    BenchmarkMessage<Traits> ping_message(options.size);
+    BenchmarkMessage<Traits> pong_message(options.size);
+    std::vector<uint64_t> round_trips;
+    round_trips.reserve(options.count);
+
+    const uint64_t timeout_ns = static_cast<uint64_t>(options.timeout * 1e9);
+    const uint64_t period_ns = options.rate > 0.0 ? static_cast<uint64_t>(1e9 / options.rate) : 0;
+    const uint64_t total = options.warmup + options.count;
+    benchmark::ResourceMeter meter;
+    uint64_t lost = 0;
+    uint64_t next_send = benchmark::now_ns();
+
+    for (uint64_t i = 0; i < total && rclcpp::ok(); i++) {
+      if (i == options.warmup) {
+        meter.start();
+      }
+
+      if (period_ns > 0) {
+        uint64_t now = benchmark::now_ns();
+        if (next_send > now) {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(next_send - now));
+        }
+        next_send += period_ns;
+      }
+
+      const uint64_t send_time = benchmark::now_ns();
+      ping_message.stamp(i, send_time);
+      if (!ping_pub.publish(ping_message.get())) {
+        lost += i >= options.warmup ? 1 : 0;
+        continue;
+      }
+
+      // Pongs of earlier pings that timed out are discarded
+      uint64_t receive_time = 0;
+      while (receive_time == 0) {
+        const uint64_t now = benchmark::now_ns();
+        if (now - send_time >= timeout_ns ||
+          !pong_sub.wait(std::chrono::nanoseconds(timeout_ns - (now - send_time))))
+        {
+          break;
+        }
+
+        while (pong_sub.take(pong_message.get())) {
+          uint64_t sequence_number = 0;
+          uint64_t timestamp = 0;
+          if (pong_message.read(&sequence_number, &timestamp) && sequence_number == i) {
+            receive_time = benchmark::now_ns();
+          }
+        }
+      }
+
+      if (i < options.warmup) {
+        continue;
+      }
+      if (receive_time == 0) {
+        lost++;
+      } else {
+        round_trips.push_back(receive_time - send_time);
+      }
+    }
+    meter.stop();
+
+    benchmark::JsonObject result;
+    result
+    .add("benchmark", "ping_pong")
+    .add("role", "ping")
+    .add("options", benchmark::describe_options(options))
+    .add("received", static_cast<uint64_t>(round_trips.size()))
+    .add("lost", lost)
+    .add("round_trip_us", benchmark::summarize_latency(round_trips))
+    .add("cpu_percent", meter.cpu_percent())
+    .add("allocations_per_message", meter.allocations_per(options.count));
+    return benchmark::write_result(options, result) ? 0 : 1;
+  }
+
+  // Echoes pings until no ping arrived for the timeout of the options
+  static int pong(
+    const benchmark::Options & options,
+    benchmark::Subscription & ping_sub,
+    benchmark::Publisher & pong_pub)
+  {
+    BenchmarkMessage<Traits> message(options.size);
+    const uint64_t timeout_ns = static_cast<uint64_t>(options.timeout * 1e9);
+    benchmark::ResourceMeter meter;
+    uint64_t echoed = 0;
+    uint64_t last_receive = 0;
+
+    while (rclcpp::ok()) {
+      if (!ping_sub.wait(std::chrono::milliseconds(100))) {
+        if (last_receive != 0 && benchmark::now_ns() - last_receive >= timeout_ns) {
+          break;
+        }
+        continue;
+      }
+
+      while (ping_sub.take(message.get())) {
+        if (last_receive == 0) {
+          meter.start();
+        }
+        pong_pub.publish(message.get());
+        echoed++;
+      }
+      last_receive = benchmark::now_ns();
+    }
+    if (echoed > 0) {
+      meter.stop();
+    }
+
+    benchmark::JsonObject result;
+    result
+    .add("benchmark", "ping_pong")
+    .add("role", "pong")
+    .add("options", benchmark::describe_options(options))
+    .add("echoed", echoed)
+    .add("cpu_percent", meter.cpu_percent())
+    .add("allocations_per_message", meter.allocations_per(echoed));
+    return benchmark::write_result(options, result) ? 0 : 1;
+  }
+};
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("ping_pong");
+    const std::string role = node->declare_parameter<std::string>("role", "ping");
+    const benchmark::Options options = benchmark::declare_options(*node);
+    try {
+      ret = benchmark::dispatch<PingPong>(options, *node, role);
+    } catch (const std::exception & e) {
+      std::cerr << e.what() << std::endl;
+      ret = 1;
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
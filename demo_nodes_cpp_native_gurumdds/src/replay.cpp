@@ -0,0 +1,442 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Replays traffic recorded by the capture mode of rmw_gurumdds_cpp, see raw_capture.hpp, so
+// that serializer and transport changes are measured on a real mix of types instead of
+// synthetic messages. Every type prints one JSON line, followed by the totals of the run.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds replay --ros-args -p captures:="[/tmp/tf.cap]"
+//   ros2 run demo_nodes_cpp_native_gurumdds replay --ros-args -p captures:="[/tmp/tf.cap]" \
+//     -p mode:=transport -p timing:=recorded
+//
+// mode:=serialization deserializes every sample with rmw_deserialize and serializes it back
+// with rmw_serialize. mode:=transport publishes the samples and takes them from a
+// subscription of the same node, at the recorded timing or, with timing:=flat, each one as
+// soon as the previous one is taken. The type support of every type is loaded by name.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/typesupport_helpers.hpp"
+#include "rcpputils/shared_library.hpp"
+#include "rcutils/allocator.h"
+#include "rcutils/error_handling.h"
+#include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "rmw_gurumdds_cpp/raw_capture.hpp"
+
+#include "benchmark_common.hpp"
+
+namespace
+{
+// Message of a type support loaded at run time, created through its introspection members
+class DynamicMessage
+{
+public:
+  DynamicMessage(const rosidl_message_type_support_t * type_support, bool c_typesupport)
+  {
+    if (c_typesupport) {
+      const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+        type_support, rosidl_typesupport_introspection_c__identifier);
+      if (introspection == nullptr) {
+        rcutils_reset_error();
+        return;
+      }
+      auto members = static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(
+        introspection->data);
+      data_ = std::calloc(1, members->size_of_);
+      if (data_ != nullptr) {
+        members->init_function(data_, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+        fini_ = members->fini_function;
+      }
+    } else {
+      const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+        type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+      if (introspection == nullptr) {
+        rcutils_reset_error();
+        return;
+      }
+      auto members = static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(
+        introspection->data);
+      data_ = std::calloc(1, members->size_of_);
+      if (data_ != nullptr) {
+        members->init_function(data_, rosidl_runtime_cpp::MessageInitialization::ALL);
+        fini_ = members->fini_function;
+      }
+    }
+  }
+
+  ~DynamicMessage()
+  {
+    if (data_ != nullptr) {
+      if (fini_ != nullptr) {
+        fini_(data_);
+      }
+      std::free(data_);
+    }
+  }
+
+  DynamicMessage(const DynamicMessage &) = delete;
+  DynamicMessage & operator=(const DynamicMessage &) = delete;
+
+  void * get() const {return data_;}
+
+private:
+  void (* fini_)(void *) {nullptr};
+  void * data_{nullptr};
+};
+
+struct ReplayCounters
+{
+  uint64_t count{0};
+  uint64_t bytes{0};
+  uint64_t failed{0};
+  uint64_t deserialize_ns{0};
+  uint64_t serialize_ns{0};
+  std::vector<uint64_t> latencies_ns;
+};
+
+// A type of the captures, with the buffers its samples are replayed through
+struct ReplayType
+{
+  std::string name;
+  std::shared_ptr<rcpputils::SharedLibrary> library;
+  const rosidl_message_type_support_t * type_support{nullptr};
+  std::unique_ptr<DynamicMessage> message;
+  std::unique_ptr<DynamicMessage> output;
+  rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+  ReplayCounters counters;
+
+  ~ReplayType()
+  {
+    (void)rmw_serialized_message_fini(&serialized);
+  }
+};
+
+// Publisher and subscription of the topic of a capture file
+struct ReplayStream
+{
+  size_t type;
+  std::unique_ptr<benchmark::Publisher> publisher;
+  std::unique_ptr<benchmark::Subscription> subscription;
+};
+
+struct ReplaySample
+{
+  size_t stream;
+  int64_t reception_timestamp;
+  std::vector<uint8_t> payload;
+};
+
+struct Replay
+{
+  std::vector<std::unique_ptr<ReplayType>> types;
+  std::vector<ReplayStream> streams;
+  // Samples of every capture, in the order they were received
+  std::vector<ReplaySample> samples;
+};
+
+size_t
+find_type(Replay & replay, const std::string & name, bool c_typesupport)
+{
+  for (size_t i = 0; i < replay.types.size(); i++) {
+    if (replay.types[i]->name == name) {
+      return i;
+    }
+  }
+
+  const std::string typesupport_identifier =
+    c_typesupport ? "rosidl_typesupport_c" : "rosidl_typesupport_cpp";
+  std::unique_ptr<ReplayType> type{new ReplayType()};
+  type->name = name;
+  type->library = rclcpp::get_typesupport_library(name, typesupport_identifier);
+  type->type_support =
+    rclcpp::get_message_typesupport_handle(name, typesupport_identifier, *type->library);
+  type->message.reset(new DynamicMessage(type->type_support, c_typesupport));
+  type->output.reset(new DynamicMessage(type->type_support, c_typesupport));
+  if (type->message->get() == nullptr || type->output->get() == nullptr) {
+    throw std::runtime_error("no introspection type support for " + name);
+  }
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  if (rmw_serialized_message_init(&type->serialized, 0, &allocator) != RMW_RET_OK) {
+    rmw_reset_error();
+    throw std::runtime_error("failed to allocate the serialized message of " + name);
+  }
+  replay.types.push_back(std::move(type));
+  return replay.types.size() - 1;
+}
+
+void
+load_capture(Replay & replay, const std::string & path, bool c_typesupport)
+{
+  rmw_gurumdds_cpp::RawCaptureReader reader;
+  if (!reader.open(path.c_str())) {
+    const std::string error = rcutils_get_error_string().str;
+    rcutils_reset_error();
+    throw std::runtime_error(error);
+  }
+
+  ReplayStream stream;
+  stream.type = find_type(replay, reader.get_header()->type_name, c_typesupport);
+  replay.streams.push_back(std::move(stream));
+
+  rmw_gurumdds_cpp::RawCaptureRecord record;
+  while (reader.next(record)) {
+    ReplaySample sample;
+    sample.stream = replay.streams.size() - 1;
+    sample.reception_timestamp = record.header->reception_timestamp;
+    sample.payload.assign(record.payload, record.payload + record.header->size);
+    replay.samples.push_back(std::move(sample));
+  }
+}
+
+// Points a serialized message at the payload of a sample, without a copy
+rmw_serialized_message_t
+view_sample(ReplaySample & sample)
+{
+  rmw_serialized_message_t view = rmw_get_zero_initialized_serialized_message();
+  view.buffer = sample.payload.data();
+  view.buffer_length = sample.payload.size();
+  view.buffer_capacity = sample.payload.size();
+  view.allocator = rcutils_get_default_allocator();
+  return view;
+}
+
+void
+replay_serialization(Replay & replay, int64_t passes)
+{
+  for (int64_t pass = 0; pass < passes; pass++) {
+    for (ReplaySample & sample : replay.samples) {
+      ReplayType & type = *replay.types[replay.streams[sample.stream].type];
+      const rmw_serialized_message_t view = view_sample(sample);
+
+      const uint64_t start = benchmark::now_ns();
+      const bool deserialized =
+        rmw_deserialize(&view, type.type_support, type.message->get()) == RMW_RET_OK;
+      const uint64_t middle = benchmark::now_ns();
+      const bool serialized = deserialized &&
+        rmw_serialize(type.message->get(), type.type_support, &type.serialized) == RMW_RET_OK;
+      const uint64_t end = benchmark::now_ns();
+
+      if (!serialized) {
+        rmw_reset_error();
+        type.counters.failed++;
+        continue;
+      }
+      type.counters.count++;
+      type.counters.bytes += sample.payload.size();
+      type.counters.deserialize_ns += middle - start;
+      type.counters.serialize_ns += end - middle;
+    }
+  }
+}
+
+bool
+replay_transport(
+  Replay & replay, rclcpp::Node & node, bool recorded, const rmw_qos_profile_t & qos,
+  double timeout)
+{
+  rcl_node_t * rcl_node = node.get_node_base_interface()->get_rcl_node_handle();
+  rcl_context_t * context =
+    node.get_node_base_interface()->get_context()->get_rcl_context().get();
+  for (size_t i = 0; i < replay.streams.size(); i++) {
+    ReplayStream & stream = replay.streams[i];
+    const rosidl_message_type_support_t * type_support =
+      replay.types[stream.type]->type_support;
+    const std::string topic = "replay_" + std::to_string(i);
+    stream.publisher.reset(new benchmark::Publisher(rcl_node, type_support, topic, qos));
+    stream.subscription.reset(
+      new benchmark::Subscription(rcl_node, context, type_support, topic, qos));
+    if (!benchmark::wait_for_match(stream.publisher.get(), stream.subscription.get(), timeout)) {
+      std::cerr << "publisher and subscription of " << replay.types[stream.type]->name <<
+        " did not match" << std::endl;
+      return false;
+    }
+  }
+
+  const auto wait_timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(timeout));
+  const auto start = std::chrono::steady_clock::now();
+  const int64_t first_timestamp =
+    replay.samples.empty() ? 0 : replay.samples.front().reception_timestamp;
+  for (ReplaySample & sample : replay.samples) {
+    if (!rclcpp::ok()) {
+      return false;
+    }
+    ReplayStream & stream = replay.streams[sample.stream];
+    ReplayType & type = *replay.types[stream.type];
+
+    // Deserialized up front, the publish serializes it again
+    const rmw_serialized_message_t view = view_sample(sample);
+    if (rmw_deserialize(&view, type.type_support, type.message->get()) != RMW_RET_OK) {
+      rmw_reset_error();
+      type.counters.failed++;
+      continue;
+    }
+    if (recorded) {
+      std::this_thread::sleep_until(
+        start + std::chrono::nanoseconds(sample.reception_timestamp - first_timestamp));
+    }
+
+    const uint64_t publish_ns = benchmark::now_ns();
+    bool taken = stream.publisher->publish(type.message->get());
+    while (taken && !stream.subscription->take(type.output->get())) {
+      taken = stream.subscription->wait(wait_timeout);
+    }
+    if (!taken) {
+      type.counters.failed++;
+      continue;
+    }
+    type.counters.latencies_ns.push_back(benchmark::now_ns() - publish_ns);
+    type.counters.count++;
+    type.counters.bytes += sample.payload.size();
+  }
+  return true;
+}
+
+benchmark::JsonObject
+describe_counters(const ReplayCounters & counters, const std::string & mode)
+{
+  benchmark::JsonObject result;
+  result
+  .add("count", counters.count)
+  .add("bytes", counters.bytes)
+  .add("failed", counters.failed);
+  if (mode == "transport") {
+    result.add("latency_us", benchmark::summarize_latency(counters.latencies_ns));
+    return result;
+  }
+
+  const double count = counters.count > 0 ? static_cast<double>(counters.count) : 1.0;
+  const double bytes = static_cast<double>(counters.bytes);
+  result
+  .add("deserialize_ns", static_cast<double>(counters.deserialize_ns) / count)
+  .add("serialize_ns", static_cast<double>(counters.serialize_ns) / count)
+  .add("deserialize_gbps", counters.deserialize_ns > 0 ? bytes / counters.deserialize_ns : 0.0)
+  .add("serialize_gbps", counters.serialize_ns > 0 ? bytes / counters.serialize_ns : 0.0);
+  return result;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("replay_benchmark");
+    const std::vector<std::string> captures = node->declare_parameter<std::vector<std::string>>(
+      "captures", std::vector<std::string>{});
+    const std::string mode = node->declare_parameter<std::string>("mode", "serialization");
+    const std::string timing = node->declare_parameter<std::string>("timing", "flat");
+    const std::string typesupport = node->declare_parameter<std::string>("typesupport", "cpp");
+    const int64_t passes = std::max<int64_t>(node->declare_parameter<int64_t>("passes", 1), 1);
+    const double timeout = node->declare_parameter<double>("timeout", 10.0);
+    const std::string output = node->declare_parameter<std::string>("output", "");
+
+    Replay replay;
+    try {
+      for (const std::string & path : captures) {
+        load_capture(replay, path, typesupport == "c");
+      }
+    } catch (const std::exception & e) {
+      std::cerr << "failed to load the captures: " << e.what() << std::endl;
+      ret = 1;
+    }
+    std::stable_sort(
+      replay.samples.begin(), replay.samples.end(),
+      [](const ReplaySample & a, const ReplaySample & b) {
+        return a.reception_timestamp < b.reception_timestamp;
+      });
+
+    if (ret == 0 && replay.samples.empty()) {
+      std::cerr << "no samples to replay, set captures:=[<capture file>, ...]" << std::endl;
+      ret = 1;
+    }
+
+    benchmark::ResourceMeter meter;
+    if (ret == 0) {
+      meter.start();
+      if (mode == "transport") {
+        rmw_qos_profile_t qos = rmw_qos_profile_default;
+        qos.depth = 1;
+        if (!replay_transport(replay, *node, timing == "recorded", qos, timeout)) {
+          ret = 1;
+        }
+      } else {
+        replay_serialization(replay, passes);
+      }
+      meter.stop();
+    }
+
+    if (ret == 0) {
+      ReplayCounters total;
+      for (const auto & type : replay.types) {
+        benchmark::JsonObject result;
+        result
+        .add("benchmark", "replay")
+        .add("rmw", rmw_get_implementation_identifier())
+        .add("mode", mode)
+        .add("timing", mode == "transport" ? timing : std::string("flat"))
+        .add("typesupport", typesupport)
+        .add("type", type->name)
+        .add("result", describe_counters(type->counters, mode));
+        benchmark::write_result(output, result);
+
+        total.count += type->counters.count;
+        total.bytes += type->counters.bytes;
+        total.failed += type->counters.failed;
+        total.deserialize_ns += type->counters.deserialize_ns;
+        total.serialize_ns += type->counters.serialize_ns;
+        total.latencies_ns.insert(
+          total.latencies_ns.end(), type->counters.latencies_ns.begin(),
+          type->counters.latencies_ns.end());
+      }
+
+      benchmark::JsonObject result;
+      result
+      .add("benchmark", "replay")
+      .add("rmw", rmw_get_implementation_identifier())
+      .add("mode", mode)
+      .add("timing", mode == "transport" ? timing : std::string("flat"))
+      .add("typesupport", typesupport)
+      .add("type", "total")
+      .add("types", static_cast<uint64_t>(replay.types.size()))
+      .add("seconds", meter.seconds())
+      .add("cpu_percent", meter.cpu_percent())
+      .add("allocations_per_sample", meter.allocations_per(total.count))
+      .add("result", describe_counters(total, mode));
+      benchmark::write_result(output, result);
+      if (total.failed > 0) {
+        ret = 1;
+      }
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
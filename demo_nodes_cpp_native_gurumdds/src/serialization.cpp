@@ -0,0 +1,378 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Cost of rmw_serialize and rmw_deserialize over a set of representative message types,
+// through the C and the C++ type supports. Every case prints one JSON line.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds serialization --ros-args -p cases:="[image]"
+//
+// endian:=opposite makes rmw_gurumdds_cpp write the other byte order, so that deserialization
+// swaps every value. The C messages are filled by deserializing the C++ ones.
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rcutils/allocator.h"
+#include "rcutils/error_handling.h"
+#include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+
+#include "diagnostic_msgs/msg/diagnostic_array.h"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "geometry_msgs/msg/pose_stamped.h"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "geometry_msgs/msg/twist_with_covariance_stamped.h"
+#include "geometry_msgs/msg/twist_with_covariance_stamped.hpp"
+#include "sensor_msgs/msg/image.h"
+#include "sensor_msgs/msg/image.hpp"
+#include "std_msgs/msg/int64.h"
+#include "std_msgs/msg/int64.hpp"
+#include "test_msgs/msg/arrays.h"
+#include "test_msgs/msg/arrays.hpp"
+#include "test_msgs/msg/bounded_sequences.h"
+#include "test_msgs/msg/bounded_sequences.hpp"
+#include "test_msgs/msg/unbounded_sequences.h"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+#include "test_msgs/msg/w_strings.h"
+#include "test_msgs/msg/w_strings.hpp"
+
+#include "benchmark_common.hpp"
+
+namespace
+{
+// Message of a C type support, created and destroyed through its introspection members
+class CMessage
+{
+public:
+  explicit CMessage(const rosidl_message_type_support_t * type_support)
+  {
+    const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_c__identifier);
+    if (introspection == nullptr) {
+      rcutils_reset_error();
+      return;
+    }
+    members_ =
+      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(introspection->data);
+    data_ = std::calloc(1, members_->size_of_);
+    if (data_ != nullptr) {
+      members_->init_function(data_, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+    }
+  }
+
+  ~CMessage()
+  {
+    if (data_ != nullptr) {
+      members_->fini_function(data_);
+      std::free(data_);
+    }
+  }
+
+  CMessage(const CMessage &) = delete;
+  CMessage & operator=(const CMessage &) = delete;
+
+  void * get() const {return data_;}
+
+private:
+  const rosidl_typesupport_introspection_c__MessageMembers * members_{nullptr};
+  void * data_{nullptr};
+};
+
+struct Case
+{
+  std::string name;
+  const rosidl_message_type_support_t * cpp_type_support;
+  const rosidl_message_type_support_t * c_type_support;
+  // Filled C++ message, and an empty one to deserialize into
+  std::shared_ptr<void> cpp_message;
+  std::shared_ptr<void> cpp_output;
+};
+
+template<typename MessageT>
+Case
+make_case(
+  const std::string & name, const MessageT & message,
+  const rosidl_message_type_support_t * c_type_support)
+{
+  Case value;
+  value.name = name;
+  value.cpp_type_support = rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>();
+  value.c_type_support = c_type_support;
+  value.cpp_message = std::make_shared<MessageT>(message);
+  value.cpp_output = std::make_shared<MessageT>();
+  return value;
+}
+
+std::vector<Case>
+make_cases()
+{
+  std::vector<Case> cases;
+
+  std_msgs::msg::Int64 primitive;
+  primitive.data = 42;
+  cases.push_back(
+    make_case("primitive", primitive, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Int64)));
+
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = 1.0;
+  pose.pose.orientation.w = 1.0;
+  cases.push_back(
+    make_case("nested", pose, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, PoseStamped)));
+
+  geometry_msgs::msg::TwistWithCovarianceStamped twist;
+  twist.header.frame_id = "base_link";
+  for (size_t i = 0; i < twist.twist.covariance.size(); i++) {
+    twist.twist.covariance[i] = static_cast<double>(i);
+  }
+  cases.push_back(
+    make_case(
+      "nested_array", twist,
+      ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, TwistWithCovarianceStamped)));
+
+  diagnostic_msgs::msg::DiagnosticArray diagnostics;
+  diagnostics.header.frame_id = "robot";
+  for (int i = 0; i < 20; i++) {
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.name = "component_" + std::to_string(i);
+    status.message = "operating normally";
+    status.hardware_id = "hw_" + std::to_string(i);
+    for (int j = 0; j < 10; j++) {
+      diagnostic_msgs::msg::KeyValue key_value;
+      key_value.key = "key_" + std::to_string(j);
+      key_value.value = "value_" + std::to_string(i * j);
+      status.values.push_back(key_value);
+    }
+    diagnostics.status.push_back(status);
+  }
+  cases.push_back(
+    make_case(
+      "strings", diagnostics, ROSIDL_GET_MSG_TYPE_SUPPORT(diagnostic_msgs, msg, DiagnosticArray)));
+
+  sensor_msgs::msg::Image image;
+  image.header.frame_id = "camera";
+  image.height = 1080;
+  image.width = 1920;
+  image.encoding = "rgb8";
+  image.step = image.width * 3;
+  image.data.assign(static_cast<size_t>(image.step) * image.height, 0x7f);
+  cases.push_back(make_case("image", image, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, Image)));
+
+  test_msgs::msg::Arrays arrays;
+  arrays.string_values = {"first", "second", "third"};
+  cases.push_back(make_case("arrays", arrays, ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, Arrays)));
+
+  test_msgs::msg::UnboundedSequences unbounded;
+  unbounded.bool_values.assign(1000, true);
+  unbounded.int32_values.assign(1000, 7);
+  unbounded.float64_values.assign(1000, 1.5);
+  unbounded.string_values.assign(100, "sequence element");
+  cases.push_back(
+    make_case(
+      "bool_and_unbounded_sequences", unbounded,
+      ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, UnboundedSequences)));
+
+  test_msgs::msg::BoundedSequences bounded;
+  bounded.bool_values.push_back(true);
+  bounded.bool_values.push_back(false);
+  bounded.float64_values.push_back(3.0);
+  bounded.string_values.push_back("bounded");
+  cases.push_back(
+    make_case(
+      "bounded_sequences", bounded,
+      ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BoundedSequences)));
+
+  test_msgs::msg::WStrings wstrings;
+  wstrings.wstring_value = u"wide string value with some length to it";
+  wstrings.unbounded_sequence_of_wstrings.assign(10, u"wide string element");
+  cases.push_back(
+    make_case("wstrings", wstrings, ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, WStrings)));
+
+  return cases;
+}
+
+// Nanoseconds per call, repeating the call until the run lasts at least min_time seconds.
+// Negative if a call failed
+double
+time_calls(double min_time, const std::function<bool()> & call)
+{
+  const uint64_t min_ns = static_cast<uint64_t>(min_time * 1e9);
+  for (uint64_t iterations = 1;; iterations *= 2) {
+    const uint64_t start = benchmark::now_ns();
+    for (uint64_t i = 0; i < iterations; i++) {
+      if (!call()) {
+        return -1.0;
+      }
+    }
+    const uint64_t elapsed = benchmark::now_ns() - start;
+    if (elapsed >= min_ns || iterations >= (1ull << 32)) {
+      return static_cast<double>(elapsed) / static_cast<double>(iterations);
+    }
+  }
+}
+
+double
+gigabytes_per_second(size_t size, double ns)
+{
+  return ns > 0.0 ? static_cast<double>(size) / ns : 0.0;
+}
+
+// Serializes from message and deserializes into output, which is reused by every call
+bool
+measure(
+  const Case & test_case, const char * typesupport, const rosidl_message_type_support_t * ts,
+  const void * message, void * output, const std::string & endian, double min_time,
+  const std::string & output_file)
+{
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+  if (rmw_serialized_message_init(&serialized, 0, &allocator) != RMW_RET_OK) {
+    rmw_reset_error();
+    return false;
+  }
+
+  bool ok = rmw_serialize(message, ts, &serialized) == RMW_RET_OK;
+  const double serialize_ns = !ok ? -1.0 : time_calls(
+    min_time, [&]() {return rmw_serialize(message, ts, &serialized) == RMW_RET_OK;});
+  const double deserialize_ns = !ok ? -1.0 : time_calls(
+    min_time, [&]() {return rmw_deserialize(&serialized, ts, output) == RMW_RET_OK;});
+  const size_t size = serialized.buffer_length;
+
+  size_t max_size = 0;
+  const bool bounded = rmw_get_serialized_message_size(ts, nullptr, &max_size) == RMW_RET_OK;
+  double max_size_ns = -1.0;
+  if (bounded) {
+    max_size_ns = time_calls(
+      min_time, [&]() {
+        return rmw_get_serialized_message_size(ts, nullptr, &max_size) == RMW_RET_OK;
+      });
+  }
+  rmw_reset_error();
+  (void)rmw_serialized_message_fini(&serialized);
+
+  benchmark::JsonObject result;
+  result
+  .add("benchmark", "serialization")
+  .add("rmw", rmw_get_implementation_identifier())
+  .add("message", test_case.name)
+  .add("typesupport", typesupport)
+  .add("endian", endian)
+  .add("serialized_size", static_cast<uint64_t>(size))
+  .add("serialize_ns", serialize_ns)
+  .add("deserialize_ns", deserialize_ns)
+  .add("serialize_gbps", gigabytes_per_second(size, serialize_ns))
+  .add("deserialize_gbps", gigabytes_per_second(size, deserialize_ns));
+  if (bounded) {
+    result
+    .add("max_serialized_size", static_cast<uint64_t>(max_size))
+    .add("max_serialized_size_ns", max_size_ns);
+  }
+  benchmark::write_result(output_file, result);
+  return serialize_ns >= 0.0 && deserialize_ns >= 0.0;
+}
+
+bool
+run_case(
+  const Case & test_case, const std::vector<std::string> & typesupports,
+  const std::string & endian, double min_time, const std::string & output_file)
+{
+  auto has = [&typesupports](const char * typesupport) {
+      return std::find(typesupports.begin(), typesupports.end(), typesupport) !=
+             typesupports.end();
+    };
+
+  bool ok = true;
+  if (has("cpp")) {
+    ok &= measure(
+      test_case, "cpp", test_case.cpp_type_support, test_case.cpp_message.get(),
+      test_case.cpp_output.get(), endian, min_time, output_file);
+  }
+
+  if (has("c")) {
+    CMessage message(test_case.c_type_support);
+    CMessage output(test_case.c_type_support);
+    if (message.get() == nullptr || output.get() == nullptr) {
+      std::cerr << "no C introspection type support for " << test_case.name << std::endl;
+      return false;
+    }
+
+    // Same CDR, so the C message gets the contents of the C++ one
+    rcutils_allocator_t allocator = rcutils_get_default_allocator();
+    rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+    bool filled = rmw_serialized_message_init(&serialized, 0, &allocator) == RMW_RET_OK &&
+      rmw_serialize(
+      test_case.cpp_message.get(), test_case.cpp_type_support, &serialized) == RMW_RET_OK &&
+      rmw_deserialize(&serialized, test_case.c_type_support, message.get()) == RMW_RET_OK;
+    rmw_reset_error();
+    (void)rmw_serialized_message_fini(&serialized);
+    if (!filled) {
+      std::cerr << "failed to fill the C message of " << test_case.name << std::endl;
+      return false;
+    }
+
+    ok &= measure(
+      test_case, "c", test_case.c_type_support, message.get(), output.get(), endian, min_time,
+      output_file);
+  }
+  return ok;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("serialization_benchmark");
+    const std::vector<std::string> selected = node->declare_parameter<std::vector<std::string>>(
+      "cases", std::vector<std::string>{});
+    const std::vector<std::string> typesupports =
+      node->declare_parameter<std::vector<std::string>>(
+      "typesupports", std::vector<std::string>{"cpp", "c"});
+    const std::string endian = node->declare_parameter<std::string>("endian", "native");
+    const double min_time = node->declare_parameter<double>("min_time", 0.5);
+    const std::string output = node->declare_parameter<std::string>("output", "");
+
+    // Read once by rmw_gurumdds_cpp, on the first serialization
+    if (endian == "opposite") {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      setenv("RMW_GURUMDDS_CDR_ENDIAN", "big", 1);
+#else
+      setenv("RMW_GURUMDDS_CDR_ENDIAN", "little", 1);
+#endif
+    }
+
+    for (const Case & test_case : make_cases()) {
+      if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), test_case.name) == selected.end())
+      {
+        continue;
+      }
+      if (!run_case(test_case, typesupports, endian, min_time, output)) {
+        ret = 1;
+      }
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,198 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// One-way throughput: the publisher process sends at the configured rate, or as fast as it
+// can, and the subscriber process counts what it receives.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds throughput --ros-args -p role:=subscriber
+//   ros2 run demo_nodes_cpp_native_gurumdds throughput --ros-args -p role:=publisher -p size:=4096
+//
+// The one-way latency of the subscriber uses the steady clock of the publisher, it is only
+// meaningful when both processes run on the same host.
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "benchmark_common.hpp"
+
+using benchmark::BenchmarkMessage;
+
+template<typename Traits>
+struct Throughput
+{
+  static int run(const benchmark::Options & options, rclcpp::Node & node, const std::string & role)
+  {
+    rcl_node_t * rcl_node = node.get_node_base_interface()->get_rcl_node_handle();
+    const rosidl_message_type_support_t * type_support = Traits::type_support();
+
+    if (role == "subscriber") {
+      rcl_context_t * context =
+        node.get_node_base_interface()->get_context()->get_rcl_context().get();
+      benchmark::Subscription sub(rcl_node, context, type_support, options.topic, options.qos);
+      return subscribe(options, sub);
+    }
+
+    benchmark::Publisher pub(rcl_node, type_support, options.topic, options.qos);
+    return publish(options, pub);
+  }
+
+  static double megabytes_per_second(
+    const benchmark::Options & options, uint64_t messages, double seconds)
+  {
+    if (seconds <= 0.0) {
+      return 0.0;
+    }
+    return static_cast<double>(options.size) * static_cast<double>(messages) / seconds / 1e6;
+  }
+
+  static int publish(const benchmark::Options & options, benchmark::Publisher & pub)
+  {
+    if (!benchmark::wait_for_match(&pub, nullptr, options.timeout)) {
+      std::cerr << "no subscriber process was discovered" << std::endl;
+      return 1;
+    }
+
+    BenchmarkMessage<Traits> message(options.size);
+    const uint64_t period_ns = options.rate > 0.0 ? static_cast<uint64_t>(1e9 / options.rate) : 0;
+    const uint64_t total = options.warmup + options.count;
+    benchmark::ResourceMeter meter;
+    uint64_t failed = 0;
+    uint64_t next_send = benchmark::now_ns();
+
+    for (uint64_t i = 0; i < total && rclcpp::ok(); i++) {
+      if (i == options.warmup) {
+        meter.start();
+      }
+
+      if (period_ns > 0) {
+        uint64_t now = benchmark::now_ns();
+        if (next_send > now) {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(next_send - now));
+        }
+        next_send += period_ns;
+      }
+
+      message.stamp(i, benchmark::now_ns());
+      if (!pub.publish(message.get()) && i >= options.warmup) {
+        failed++;
+      }
+    }
+    meter.stop();
+
+    const uint64_t sent = options.count - failed;
+    benchmark::JsonObject result;
+    result
+    .add("benchmark", "throughput")
+    .add("role", "publisher")
+    .add("options", benchmark::describe_options(options))
+    .add("sent", sent)
+    .add("failed", failed)
+    .add("messages_per_second", meter.seconds() > 0.0 ? sent / meter.seconds() : 0.0)
+    .add("megabytes_per_second", megabytes_per_second(options, sent, meter.seconds()))
+    .add("cpu_percent", meter.cpu_percent())
+    .add("allocations_per_message", meter.allocations_per(options.count));
+    return benchmark::write_result(options, result) ? 0 : 1;
+  }
+
+  // Takes until the last message was received or nothing arrived for the timeout of the options
+  static int subscribe(const benchmark::Options & options, benchmark::Subscription & sub)
+  {
+    BenchmarkMessage<Traits> message(options.size);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(options.count);
+
+    const uint64_t timeout_ns = static_cast<uint64_t>(options.timeout * 1e9);
+    const uint64_t last = options.warmup + options.count - 1;
+    benchmark::ResourceMeter meter;
+    bool measuring = false;
+    uint64_t highest = 0;
+    uint64_t last_receive = benchmark::now_ns();
+    bool done = false;
+
+    while (rclcpp::ok() && !done) {
+      if (!sub.wait(std::chrono::milliseconds(100))) {
+        if (benchmark::now_ns() - last_receive >= timeout_ns) {
+          break;
+        }
+        continue;
+      }
+
+      while (sub.take(message.get())) {
+        const uint64_t receive_time = benchmark::now_ns();
+        last_receive = receive_time;
+        uint64_t sequence_number = 0;
+        uint64_t timestamp = 0;
+        if (!message.read(&sequence_number, &timestamp) || sequence_number < options.warmup) {
+          continue;
+        }
+
+        if (!measuring) {
+          meter.start();
+          measuring = true;
+        }
+        latencies.push_back(receive_time - timestamp);
+        highest = std::max(highest, sequence_number);
+        if (sequence_number == last) {
+          done = true;
+          break;
+        }
+      }
+    }
+    if (measuring) {
+      meter.stop();
+    }
+
+    const uint64_t received = latencies.size();
+    // Messages after the highest one received are not known to be lost when the run times out
+    const uint64_t expected = measuring ? highest - options.warmup + 1 : 0;
+    benchmark::JsonObject result;
+    result
+    .add("benchmark", "throughput")
+    .add("role", "subscriber")
+    .add("options", benchmark::describe_options(options))
+    .add("received", static_cast<uint64_t>(received))
+    .add("lost", expected > received ? expected - received : 0)
+    .add("messages_per_second", meter.seconds() > 0.0 ? received / meter.seconds() : 0.0)
+    .add("megabytes_per_second", megabytes_per_second(options, received, meter.seconds()))
+    .add("latency_us", benchmark::summarize_latency(latencies))
+    .add("cpu_percent", meter.cpu_percent())
+    .add("allocations_per_message", meter.allocations_per(received));
+    return benchmark::write_result(options, result) ? 0 : 1;
+  }
+};
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("throughput");
+    const std::string role = node->declare_parameter<std::string>("role", "publisher");
+    const benchmark::Options options = benchmark::declare_options(*node);
+    try {
+      ret = benchmark::dispatch<Throughput>(options, *node, role);
+    } catch (const std::exception & e) {
+      std::cerr << e.what() << std::endl;
+      ret = 1;
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,411 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Cost of rmw_wait as the number of entities grows. For every entity count and ready fraction
+// a set of each selected kind is created, the ready fraction of the subscriptions gets a
+// sample that is never taken and the ready fraction of the guard conditions is triggered
+// before every wait. Services, clients and events are never ready.
+//
+//   ros2 run demo_nodes_cpp_native_gurumdds wait_set --ros-args \
+//     -p entities:="[1, 100, 10000]" -p ready_fractions:="[0.0, 0.5]"
+//
+// rmw_wait is called directly with a zero timeout, rcl would hide the rmw wait set. With
+// rmw_gurumdds_cpp the time of the attach, wait and processing phases is reported too.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcl/rcl.h"
+#include "rclcpp/rclcpp.hpp"
+#include "rmw/rmw.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+#include "rosidl_typesupport_cpp/service_type_support.hpp"
+
+#include "std_msgs/msg/string.hpp"
+#include "std_srvs/srv/empty.hpp"
+
+#include "rmw_gurumdds_cpp/endpoint_stats.hpp"
+
+#include "benchmark_common.hpp"
+
+namespace
+{
+struct WaitSetOptions
+{
+  std::vector<int64_t> entities;
+  std::vector<double> ready_fractions;
+  bool subscriptions;
+  bool guard_conditions;
+  bool services;
+  bool clients;
+  bool events;
+  uint64_t iterations;
+  std::string output;
+};
+
+// Entities of one measurement, the rmw handles are what rmw_wait is given
+class EntitySet
+{
+public:
+  EntitySet(rcl_node_t * node, rcl_context_t * context)
+  : node_{node}, context_{context}
+  {
+  }
+
+  ~EntitySet()
+  {
+    for (auto & event : events_) {
+      (void)rcl_event_fini(&event);
+    }
+    for (auto & subscription : subscriptions_) {
+      (void)rcl_subscription_fini(&subscription, node_);
+    }
+    for (auto & guard_condition : guard_conditions_) {
+      (void)rcl_guard_condition_fini(&guard_condition);
+    }
+    for (auto & service : services_) {
+      (void)rcl_service_fini(&service, node_);
+    }
+    for (auto & client : clients_) {
+      (void)rcl_client_fini(&client, node_);
+    }
+    rcl_reset_error();
+  }
+
+  bool create(const WaitSetOptions & options, size_t count, size_t ready)
+  {
+    const rosidl_message_type_support_t * message_ts =
+      rosidl_typesupport_cpp::get_message_type_support_handle<std_msgs::msg::String>();
+    const rosidl_service_type_support_t * service_ts =
+      rosidl_typesupport_cpp::get_service_type_support_handle<std_srvs::srv::Empty>();
+
+    subscriptions_.reserve(count);
+    events_.reserve(count);
+    guard_conditions_.reserve(count);
+    services_.reserve(count);
+    clients_.reserve(count);
+
+    for (size_t i = 0; i < count && (options.subscriptions || options.events); i++) {
+      rcl_subscription_options_t sub_options = rcl_subscription_get_default_options();
+      subscriptions_.push_back(rcl_get_zero_initialized_subscription());
+      const bool is_ready = options.subscriptions && i < ready;
+      const char * topic = is_ready ? "wait_set_ready" : "wait_set_idle";
+      if (rcl_subscription_init(
+          &subscriptions_.back(), node_, message_ts, topic, &sub_options) != RCL_RET_OK)
+      {
+        subscriptions_.pop_back();
+        return fail("subscription");
+      }
+      ready_subscriptions_ += is_ready ? 1 : 0;
+
+      if (options.events) {
+        events_.push_back(rcl_get_zero_initialized_event());
+        if (rcl_subscription_event_init(
+            &events_.back(), &subscriptions_.back(),
+            RCL_SUBSCRIPTION_LIVELINESS_CHANGED) != RCL_RET_OK)
+        {
+          events_.pop_back();
+          return fail("event");
+        }
+      }
+    }
+
+    for (size_t i = 0; i < count && options.guard_conditions; i++) {
+      guard_conditions_.push_back(rcl_get_zero_initialized_guard_condition());
+      if (rcl_guard_condition_init(
+          &guard_conditions_.back(), context_,
+          rcl_guard_condition_get_default_options()) != RCL_RET_OK)
+      {
+        guard_conditions_.pop_back();
+        return fail("guard condition");
+      }
+    }
+    ready_guard_conditions_ = options.guard_conditions ? ready : 0;
+
+    for (size_t i = 0; i < count && (options.services || options.clients); i++) {
+      const std::string name = "wait_set_service_" + std::to_string(i);
+      if (options.services) {
+        rcl_service_options_t service_options = rcl_service_get_default_options();
+        services_.push_back(rcl_get_zero_initialized_service());
+        if (rcl_service_init(
+            &services_.back(), node_, service_ts, name.c_str(), &service_options) != RCL_RET_OK)
+        {
+          services_.pop_back();
+          return fail("service");
+        }
+      }
+      if (options.clients) {
+        rcl_client_options_t client_options = rcl_client_get_default_options();
+        clients_.push_back(rcl_get_zero_initialized_client());
+        if (rcl_client_init(
+            &clients_.back(), node_, service_ts, name.c_str(), &client_options) != RCL_RET_OK)
+        {
+          clients_.pop_back();
+          return fail("client");
+        }
+      }
+    }
+
+    collect_handles(options);
+    return true;
+  }
+
+  // Publishes the sample that keeps the ready subscriptions ready
+  bool make_subscriptions_ready(double timeout)
+  {
+    if (ready_subscriptions_ == 0) {
+      return true;
+    }
+
+    const rosidl_message_type_support_t * message_ts =
+      rosidl_typesupport_cpp::get_message_type_support_handle<std_msgs::msg::String>();
+    rmw_qos_profile_t qos = rmw_qos_profile_default;
+    benchmark::Publisher publisher(node_, message_ts, "wait_set_ready", qos);
+
+    const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(timeout));
+    while (publisher.subscription_count() < ready_subscriptions_) {
+      if (!rclcpp::ok() || std::chrono::steady_clock::now() >= deadline) {
+        std::cerr << "ready subscriptions were not matched" << std::endl;
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std_msgs::msg::String message;
+    message.data = "ready";
+    if (!publisher.publish(&message)) {
+      std::cerr << "failed to publish the ready sample" << std::endl;
+      return false;
+    }
+    // Gives the sample time to reach every reader before the wait set is measured
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return true;
+  }
+
+  // rmw_wait clears the entities that are not ready, the arrays are refilled before every wait
+  void reset()
+  {
+    active_subscriptions_ = subscription_handles_;
+    active_guard_conditions_ = guard_condition_handles_;
+    active_services_ = service_handles_;
+    active_clients_ = client_handles_;
+    active_events_ = event_handles_;
+    for (size_t i = 0; i < ready_guard_conditions_; i++) {
+      (void)rcl_trigger_guard_condition(&guard_conditions_[i]);
+    }
+  }
+
+  rmw_ret_t wait(rmw_wait_set_t * wait_set)
+  {
+    rmw_subscriptions_t subscriptions{active_subscriptions_.size(), active_subscriptions_.data()};
+    rmw_guard_conditions_t guard_conditions{
+      active_guard_conditions_.size(), active_guard_conditions_.data()};
+    rmw_services_t services{active_services_.size(), active_services_.data()};
+    rmw_clients_t clients{active_clients_.size(), active_clients_.data()};
+    rmw_events_t events{active_events_.size(), active_events_.data()};
+    rmw_time_t timeout{0, 0};
+    return rmw_wait(
+      &subscriptions, &guard_conditions, &services, &clients, &events, wait_set, &timeout);
+  }
+
+  size_t size() const
+  {
+    return subscription_handles_.size() + guard_condition_handles_.size() +
+           service_handles_.size() + client_handles_.size() + event_handles_.size();
+  }
+
+  size_t ready() const
+  {
+    return ready_subscriptions_ + ready_guard_conditions_;
+  }
+
+private:
+  bool fail(const char * entity)
+  {
+    std::cerr << "failed to create " << entity << ": " << rcl_get_error_string().str << std::endl;
+    rcl_reset_error();
+    return false;
+  }
+
+  void collect_handles(const WaitSetOptions & options)
+  {
+    for (auto & subscription : subscriptions_) {
+      if (options.subscriptions) {
+        subscription_handles_.push_back(rcl_subscription_get_rmw_handle(&subscription)->data);
+      }
+    }
+    for (auto & guard_condition : guard_conditions_) {
+      guard_condition_handles_.push_back(
+        rcl_guard_condition_get_rmw_handle(&guard_condition)->data);
+    }
+    for (auto & service : services_) {
+      service_handles_.push_back(rcl_service_get_rmw_handle(&service)->data);
+    }
+    for (auto & client : clients_) {
+      client_handles_.push_back(rcl_client_get_rmw_handle(&client)->data);
+    }
+    for (auto & event : events_) {
+      event_handles_.push_back(rcl_event_get_rmw_handle(&event));
+    }
+  }
+
+  rcl_node_t * node_;
+  rcl_context_t * context_;
+  std::vector<rcl_subscription_t> subscriptions_;
+  std::vector<rcl_event_t> events_;
+  std::vector<rcl_guard_condition_t> guard_conditions_;
+  std::vector<rcl_service_t> services_;
+  std::vector<rcl_client_t> clients_;
+  size_t ready_subscriptions_{0};
+  size_t ready_guard_conditions_{0};
+
+  std::vector<void *> subscription_handles_;
+  std::vector<void *> guard_condition_handles_;
+  std::vector<void *> service_handles_;
+  std::vector<void *> client_handles_;
+  std::vector<void *> event_handles_;
+  std::vector<void *> active_subscriptions_;
+  std::vector<void *> active_guard_conditions_;
+  std::vector<void *> active_services_;
+  std::vector<void *> active_clients_;
+  std::vector<void *> active_events_;
+};
+
+WaitSetOptions
+declare_wait_set_options(rclcpp::Node & node)
+{
+  WaitSetOptions options;
+  options.entities = node.declare_parameter<std::vector<int64_t>>(
+    "entities", std::vector<int64_t>{1, 10, 100, 1000, 10000});
+  options.ready_fractions = node.declare_parameter<std::vector<double>>(
+    "ready_fractions", std::vector<double>{0.0, 0.01, 0.1, 1.0});
+  const std::vector<std::string> kinds = node.declare_parameter<std::vector<std::string>>(
+    "kinds",
+    std::vector<std::string>{"subscriptions", "guard_conditions", "services", "clients", "events"});
+  auto has_kind = [&kinds](const char * kind) {
+      return std::find(kinds.begin(), kinds.end(), kind) != kinds.end();
+    };
+  options.subscriptions = has_kind("subscriptions");
+  options.guard_conditions = has_kind("guard_conditions");
+  options.services = has_kind("services");
+  options.clients = has_kind("clients");
+  options.events = has_kind("events");
+  options.iterations = static_cast<uint64_t>(
+    std::max<int64_t>(node.declare_parameter<int64_t>("iterations", 1000), 1));
+  options.output = node.declare_parameter<std::string>("output", "");
+  return options;
+}
+
+bool
+measure(
+  rclcpp::Node & node, const WaitSetOptions & options, size_t count, double fraction)
+{
+  rcl_node_t * rcl_node = node.get_node_base_interface()->get_rcl_node_handle();
+  rcl_context_t * context = node.get_node_base_interface()->get_context()->get_rcl_context().get();
+  const size_t ready = std::min(
+    count, static_cast<size_t>(std::lround(std::max(fraction, 0.0) * static_cast<double>(count))));
+
+  EntitySet entities(rcl_node, context);
+  if (!entities.create(options, count, ready) || !entities.make_subscriptions_ready(10.0)) {
+    return false;
+  }
+
+  rmw_wait_set_t * wait_set =
+    rmw_create_wait_set(rcl_context_get_rmw_context(context), entities.size());
+  if (wait_set == nullptr) {
+    std::cerr << "failed to create wait set: " << rmw_get_error_string().str << std::endl;
+    rmw_reset_error();
+    return false;
+  }
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(options.iterations);
+  rmw_gurumdds_cpp::WaitSetStats before{};
+  rmw_gurumdds_cpp::WaitSetStats after{};
+  // Zero with another rmw implementation, which has no phase statistics
+  const bool has_phases = rmw_gurumdds_cpp::get_wait_set_stats(wait_set, &before) == RMW_RET_OK;
+  rmw_reset_error();
+
+  uint64_t failed = 0;
+  for (uint64_t i = 0; i < options.iterations && rclcpp::ok(); i++) {
+    entities.reset();
+    const uint64_t start = benchmark::now_ns();
+    rmw_ret_t ret = entities.wait(wait_set);
+    const uint64_t end = benchmark::now_ns();
+    if (ret != RMW_RET_OK && ret != RMW_RET_TIMEOUT) {
+      rmw_reset_error();
+      failed++;
+      continue;
+    }
+    latencies.push_back(end - start);
+  }
+
+  benchmark::JsonObject result;
+  result
+  .add("benchmark", "wait_set")
+  .add("rmw", rmw_get_implementation_identifier())
+  .add("entities_per_kind", static_cast<uint64_t>(count))
+  .add("entities", static_cast<uint64_t>(entities.size()))
+  .add("ready", static_cast<uint64_t>(entities.ready()))
+  .add("iterations", options.iterations)
+  .add("failed", failed)
+  .add("wait_us", benchmark::summarize_latency(latencies));
+
+  if (has_phases && rmw_gurumdds_cpp::get_wait_set_stats(wait_set, &after) == RMW_RET_OK) {
+    const uint64_t waits = after.wait_count - before.wait_count;
+    auto mean_us = [waits](uint64_t first, uint64_t last) {
+        return waits == 0 ? 0.0 :
+               static_cast<double>(last - first) / static_cast<double>(waits) / 1000.0;
+      };
+    benchmark::JsonObject phases;
+    phases
+    .add("attach", mean_us(before.attach_time_ns, after.attach_time_ns))
+    .add("wait", mean_us(before.wait_time_ns, after.wait_time_ns))
+    .add("process", mean_us(before.process_time_ns, after.process_time_ns));
+    result.add("phase_mean_us", phases);
+  }
+
+  (void)rmw_destroy_wait_set(wait_set);
+  return benchmark::write_result(options.output, result);
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("wait_set_benchmark");
+    const WaitSetOptions options = declare_wait_set_options(*node);
+    for (int64_t count : options.entities) {
+      for (double fraction : options.ready_fractions) {
+        if (!rclcpp::ok() || count <= 0) {
+          continue;
+        }
+        if (!measure(*node, options, static_cast<size_t>(count), fraction)) {
+          ret = 1;
+        }
+      }
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,347 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Fails if the steady state path of a publication or a service call allocates. After a warm up,
+// the heap allocations of the calling thread are counted over:
+//   - publish, wait and take into a reused message, for a plain and a string type
+//   - send request, take request, send response and take response
+// Allocations of the DDS threads, which receive and deliver the samples, are not counted.
+//
+//   RMW_IMPLEMENTATION=rmw_gurumdds_cpp ros2 run demo_nodes_cpp_native_gurumdds zero_allocation
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "rcl/rcl.h"
+#include "rclcpp/rclcpp.hpp"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+#include "rosidl_typesupport_cpp/service_type_support.hpp"
+
+#include "std_msgs/msg/int64.hpp"
+#include "std_msgs/msg/string.hpp"
+#include "std_srvs/srv/set_bool.hpp"
+
+#include "benchmark_common.hpp"
+
+namespace
+{
+thread_local bool t_tracking = false;
+std::atomic<uint64_t> g_tracked_allocations{0};
+std::atomic<uint64_t> g_tracked_bytes{0};
+
+void
+track(size_t size)
+{
+  if (t_tracking) {
+    g_tracked_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_tracked_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+}  // namespace
+
+#ifdef __GLIBC__
+// Interposes the allocator of the process, every library allocating through malloc is seen
+extern "C"
+{
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+
+void * malloc(size_t size)
+{
+  track(size);
+  return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size)
+{
+  track(count * size);
+  return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+  track(size);
+  return __libc_realloc(ptr, size);
+}
+
+void * memalign(size_t alignment, size_t size)
+{
+  track(size);
+  return __libc_memalign(alignment, size);
+}
+
+void * aligned_alloc(size_t alignment, size_t size)
+{
+  track(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void ** ptr, size_t alignment, size_t size)
+{
+  track(size);
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr == nullptr ? ENOMEM : 0;
+}
+}  // extern "C"
+#endif
+
+namespace
+{
+struct HarnessOptions
+{
+  uint64_t warmup;
+  uint64_t iterations;
+  // Allocations tolerated over the iterations of a case
+  uint64_t allowed;
+  double timeout;
+  std::string output;
+};
+
+// Counts the allocations of the calling thread while it is alive
+class TrackingScope
+{
+public:
+  TrackingScope()
+  {
+    allocations_ = g_tracked_allocations.load();
+    bytes_ = g_tracked_bytes.load();
+    t_tracking = true;
+  }
+
+  ~TrackingScope()
+  {
+    t_tracking = false;
+  }
+
+  uint64_t allocations() const {return g_tracked_allocations.load() - allocations_;}
+  uint64_t bytes() const {return g_tracked_bytes.load() - bytes_;}
+
+private:
+  uint64_t allocations_;
+  uint64_t bytes_;
+};
+
+bool
+report(
+  const HarnessOptions & options, const char * name, bool completed, uint64_t allocations,
+  uint64_t bytes)
+{
+  const bool passed = completed && allocations <= options.allowed;
+  benchmark::JsonObject result;
+  result
+  .add("benchmark", "zero_allocation")
+  .add("rmw", rmw_get_implementation_identifier())
+  .add("case", name)
+  .add("iterations", options.iterations)
+  .add("completed", completed ? "true" : "false")
+  .add("allocations", allocations)
+  .add("allocated_bytes", bytes)
+  .add("passed", passed ? "true" : "false");
+  benchmark::write_result(options.output, result);
+  return passed;
+}
+
+template<typename MessageT>
+bool
+run_topic(
+  const HarnessOptions & options, const char * name, rcl_node_t * node, rcl_context_t * context,
+  const MessageT & sample)
+{
+  const rosidl_message_type_support_t * type_support =
+    rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>();
+  rmw_qos_profile_t qos = rmw_qos_profile_default;
+  const std::string topic = std::string("zero_allocation_") + name;
+  benchmark::Publisher pub(node, type_support, topic, qos);
+  benchmark::Subscription sub(node, context, type_support, topic, qos);
+  if (!benchmark::wait_for_match(&pub, &sub, options.timeout)) {
+    std::cerr << "the publisher and the subscription of " << name << " did not match" << std::endl;
+    return report(options, name, false, 0, 0);
+  }
+
+  MessageT received = sample;
+  const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(options.timeout));
+  auto round_trip = [&]() {
+      return pub.publish(&sample) && sub.wait(timeout) && sub.take(&received);
+    };
+
+  for (uint64_t i = 0; i < options.warmup; i++) {
+    if (!round_trip()) {
+      return report(options, name, false, 0, 0);
+    }
+  }
+
+  bool completed = true;
+  TrackingScope scope;
+  for (uint64_t i = 0; i < options.iterations && completed; i++) {
+    completed = round_trip();
+  }
+  const uint64_t allocations = scope.allocations();
+  const uint64_t bytes = scope.bytes();
+  return report(options, name, completed, allocations, bytes);
+}
+
+// Waits until the entity added by add is ready
+template<typename AddFn>
+bool
+wait_for(rcl_wait_set_t * wait_set, std::chrono::nanoseconds timeout, AddFn add)
+{
+  if (rcl_wait_set_clear(wait_set) != RCL_RET_OK || !add()) {
+    rcl_reset_error();
+    return false;
+  }
+  if (rcl_wait(wait_set, timeout.count()) != RCL_RET_OK) {
+    rcl_reset_error();
+    return false;
+  }
+  return true;
+}
+
+bool
+run_service(
+  const HarnessOptions & options, rcl_node_t * node, rcl_context_t * context)
+{
+  const char * name = "service";
+  const rosidl_service_type_support_t * type_support =
+    rosidl_typesupport_cpp::get_service_type_support_handle<std_srvs::srv::SetBool>();
+
+  rcl_service_t service = rcl_get_zero_initialized_service();
+  rcl_client_t client = rcl_get_zero_initialized_client();
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_service_options_t service_options = rcl_service_get_default_options();
+  rcl_client_options_t client_options = rcl_client_get_default_options();
+  if (rcl_service_init(
+      &service, node, type_support, "zero_allocation_service", &service_options) != RCL_RET_OK ||
+    rcl_client_init(
+      &client, node, type_support, "zero_allocation_service", &client_options) != RCL_RET_OK ||
+    rcl_wait_set_init(
+      &wait_set, 0, 0, 0, 1, 1, 0, context, rcl_get_default_allocator()) != RCL_RET_OK)
+  {
+    std::cerr << "failed to create the service: " << rcl_get_error_string().str << std::endl;
+    rcl_reset_error();
+    (void)rcl_wait_set_fini(&wait_set);
+    (void)rcl_client_fini(&client, node);
+    (void)rcl_service_fini(&service, node);
+    rcl_reset_error();
+    return report(options, name, false, 0, 0);
+  }
+
+  std_srvs::srv::SetBool::Request request;
+  request.data = true;
+  std_srvs::srv::SetBool::Request taken_request;
+  std_srvs::srv::SetBool::Response response;
+  response.success = true;
+  response.message = "zero allocation response";
+  std_srvs::srv::SetBool::Response taken_response = response;
+  const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(options.timeout));
+
+  bool available = false;
+  const uint64_t deadline = benchmark::now_ns() + static_cast<uint64_t>(options.timeout * 1e9);
+  while (!available && benchmark::now_ns() < deadline) {
+    if (rcl_service_server_is_available(node, &client, &available) != RCL_RET_OK) {
+      rcl_reset_error();
+    }
+  }
+
+  auto round_trip = [&]() {
+      int64_t sequence_number = 0;
+      rmw_request_id_t request_header;
+      rmw_service_info_t response_header;
+      return
+        rcl_send_request(&client, &request, &sequence_number) == RCL_RET_OK &&
+        wait_for(
+        &wait_set, timeout, [&]() {
+          return rcl_wait_set_add_service(&wait_set, &service, nullptr) == RCL_RET_OK;
+        }) &&
+        rcl_take_request(&service, &request_header, &taken_request) == RCL_RET_OK &&
+        rcl_send_response(&service, &request_header, &response) == RCL_RET_OK &&
+        wait_for(
+        &wait_set, timeout, [&]() {
+          return rcl_wait_set_add_client(&wait_set, &client, nullptr) == RCL_RET_OK;
+        }) &&
+        rcl_take_response_with_info(&client, &response_header, &taken_response) == RCL_RET_OK;
+    };
+
+  bool completed = available;
+  for (uint64_t i = 0; i < options.warmup && completed; i++) {
+    completed = round_trip();
+  }
+
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  if (completed) {
+    TrackingScope scope;
+    for (uint64_t i = 0; i < options.iterations && completed; i++) {
+      completed = round_trip();
+    }
+    allocations = scope.allocations();
+    bytes = scope.bytes();
+  }
+  rcl_reset_error();
+
+  (void)rcl_wait_set_fini(&wait_set);
+  (void)rcl_client_fini(&client, node);
+  (void)rcl_service_fini(&service, node);
+  return report(options, name, completed, allocations, bytes);
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+#ifndef __GLIBC__
+  std::cerr << "allocation tracking needs the glibc allocator" << std::endl;
+  return 0;
+#endif
+
+  rclcpp::init(argc, argv);
+  int ret = 0;
+  {
+    auto node = std::make_shared<rclcpp::Node>("zero_allocation");
+    HarnessOptions options;
+    options.warmup = static_cast<uint64_t>(
+      std::max<int64_t>(node->declare_parameter<int64_t>("warmup", 100), 1));
+    options.iterations = static_cast<uint64_t>(
+      std::max<int64_t>(node->declare_parameter<int64_t>("iterations", 1000), 1));
+    options.allowed = static_cast<uint64_t>(
+      std::max<int64_t>(node->declare_parameter<int64_t>("allowed", 0), 0));
+    options.timeout = node->declare_parameter<double>("timeout", 10.0);
+    options.output = node->declare_parameter<std::string>("output", "");
+
+    rcl_node_t * rcl_node = node->get_node_base_interface()->get_rcl_node_handle();
+    rcl_context_t * context =
+      node->get_node_base_interface()->get_context()->get_rcl_context().get();
+
+    std_msgs::msg::Int64 plain;
+    plain.data = 42;
+    std_msgs::msg::String text;
+    text.data = std::string(256, 's');
+
+    bool passed = true;
+    passed &= run_topic(options, "plain", rcl_node, context, plain);
+    passed &= run_topic(options, "string", rcl_node, context, text);
+    passed &= run_service(options, rcl_node, context);
+    ret = passed ? 0 : 1;
+  }
+  rclcpp::shutdown();
+  return ret;
+}
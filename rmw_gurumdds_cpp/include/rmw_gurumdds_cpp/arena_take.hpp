@@ -0,0 +1,44 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__ARENA_TAKE_HPP_
+#define RMW_GURUMDDS__ARENA_TAKE_HPP_
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Take of a C message whose strings and sequences live in a per allocation
+ * arena, so that takes of a steady stream of samples allocate nothing. The
+ * message is allocated from the arena of the allocation, which each arena take
+ * resets: it stays valid until the next arena take with the same allocation or
+ * until the allocation is finalized, and it must not be finalized by the
+ * caller. Allocations are not thread safe. C++ type supports return
+ * RMW_RET_UNSUPPORTED.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+take_arena_message(
+  const rmw_subscription_t * subscription,
+  rmw_subscription_allocation_t * allocation,
+  void ** ros_message,
+  bool * taken,
+  rmw_message_info_t * message_info);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__ARENA_TAKE_HPP_
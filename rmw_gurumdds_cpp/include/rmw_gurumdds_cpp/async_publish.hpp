@@ -0,0 +1,198 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__ASYNC_PUBLISH_HPP_
+#define RMW_GURUMDDS__ASYNC_PUBLISH_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+#include "rmw_gurumdds_cpp/thread_settings.hpp"
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+class AsyncPublishSender;
+
+// Counters of a publisher that hands its samples to the sender thread
+struct AsyncPublishStatus
+{
+  // Samples waiting in the queue, and the number it holds
+  size_t queue_depth;
+  size_t queue_capacity;
+  uint64_t sent_count;
+  // Samples dropped because the queue was full
+  uint64_t dropped_count;
+  // Samples the sender thread failed to write
+  uint64_t failed_count;
+  // Times the bandwidth limit held back queued samples
+  uint64_t throttled_count;
+};
+
+// RMW_RET_UNSUPPORTED if the publisher does not publish asynchronously
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_async_publish_status(const rmw_publisher_t * publisher, AsyncPublishStatus * status);
+
+struct AsyncSample
+{
+  MessageBuffer * buffer;
+  size_t size;
+  dds_SampleInfoEx info;
+};
+
+/**
+ * Bounded queue that any number of threads push to and a single thread pops
+ * from without taking a lock. Each cell carries the position it is expected
+ * at, so a producer claims a cell with one compare-and-swap of the tail.
+ */
+class AsyncSampleQueue {
+public:
+  bool init(size_t capacity);
+
+  // False if the queue is full
+  bool push(const AsyncSample & sample);
+
+  // Called by the consumer only. False if the queue is empty
+  bool pop(AsyncSample & sample);
+
+  // May be off by the pushes and pops in progress
+  size_t size() const;
+
+  size_t capacity() const;
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> position;
+    AsyncSample sample;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t capacity_ {0};
+  alignas(64) std::atomic<size_t> tail_ {0};
+  alignas(64) std::atomic<size_t> head_ {0};
+};
+
+/**
+ * Asynchronous publishing of a writer. Publish serializes into a pooled
+ * buffer and enqueues it with the sequence number and timestamp it was
+ * published with; the sender thread of its priority lane writes it and
+ * returns the buffer to the pool. With a bandwidth limit, a token bucket of
+ * burst_bytes refilled at bytes_per_second holds the samples back once empty.
+ * A sample larger than the tokens left is still written, the debt delaying
+ * the next ones.
+ */
+class AsyncPublisher {
+public:
+  AsyncPublisher(
+    dds_DataWriter * writer, MessageBufferPool * buffers, const AsyncPublishSettings & settings,
+    AsyncPublishSender * sender);
+
+  bool init();
+
+  // Takes the buffer, which is back in the pool if the sample is dropped
+  rmw_ret_t enqueue(MessageBuffer * buffer, size_t size, const dds_SampleInfoEx & info);
+
+  // Writes the queued samples on the sender thread. True if there was any. When the bandwidth
+  // limit holds samples back, lowers resume_ns to the time the bucket has tokens again
+  bool send(uint64_t now_ns, uint64_t & resume_ns);
+
+  // Writes the queued samples whatever the bandwidth limit. True if there was any
+  bool flush();
+
+  // Waits at most timeout_ns until every enqueued sample is written, false on timeout
+  bool drain(uint64_t timeout_ns);
+
+  void get_status(AsyncPublishStatus & status) const;
+
+  int get_priority() const;
+
+private:
+  void write(const AsyncSample & sample);
+
+  void notify_written();
+
+  dds_DataWriter * writer_;
+  MessageBufferPool * buffers_;
+  AsyncPublishSettings settings_;
+  AsyncPublishSender * sender_;
+  AsyncSampleQueue queue_;
+  // Samples enqueued and not written yet
+  std::atomic<size_t> pending_ {0};
+  std::atomic<uint64_t> sent_count_ {0};
+  std::atomic<uint64_t> dropped_count_ {0};
+  std::atomic<uint64_t> failed_count_ {0};
+  std::atomic<uint64_t> throttled_count_ {0};
+  // Token bucket, used by the sender thread only
+  int64_t tokens_ {0};
+  uint64_t refill_ns_ {0};
+
+  // Wakes the publishers that wait for room in the queue or for it to drain
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::atomic<size_t> waiters_ {0};
+};
+
+// Thread of a context that writes the samples of the asynchronous publishers of one priority lane
+class AsyncPublishSender {
+public:
+  explicit AsyncPublishSender(const ThreadSettings & settings);
+
+  ~AsyncPublishSender();
+
+  AsyncPublishSender(const AsyncPublishSender &) = delete;
+
+  AsyncPublishSender & operator=(const AsyncPublishSender &) = delete;
+
+  // Starts the thread. False if it could not be created
+  bool start();
+
+  void add(AsyncPublisher * publisher);
+
+  // Once it returns the thread does not touch the publisher anymore
+  void remove(AsyncPublisher * publisher);
+
+  // Called after a sample is enqueued, takes the lock only when the thread sleeps
+  void notify();
+
+private:
+  void run();
+
+  ThreadSettings settings_;
+  // Held while the samples are written
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::thread thread_;
+  std::vector<AsyncPublisher *> publishers_;
+  std::atomic_bool sleeping_ {false};
+  bool woken_ {false};
+  bool stop_ {false};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__ASYNC_PUBLISH_HPP_
@@ -0,0 +1,43 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__BUFFER_MEMORY_HPP_
+#define RMW_GURUMDDS__BUFFER_MEMORY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// Values of rmw_context_impl_s::buffer_memory
+#define BUFFER_MEMORY_HEAP 0
+#define BUFFER_MEMORY_LOCKED 1
+#define BUFFER_MEMORY_HUGEPAGES 2
+
+#define BUFFER_MEMORY_HUGEPAGE_SIZE (2u * 1024u * 1024u)
+
+namespace rmw_gurumdds_cpp
+{
+// Parses "heap", "locked" or "hugepages". False if the name is unknown
+bool parse_buffer_memory(const char * name, int & memory);
+
+// Allocates at least `size` bytes of the memory kind and stores the size actually allocated.
+// Locked memory is pre-faulted and mlocked, so that the first write to it does not page fault.
+// Buffers of at least half a huge page are rounded up to huge pages, backed by reserved huge
+// pages if there are any, transparent ones otherwise. Locked memory that cannot be mlocked is
+// still pre-faulted. nullptr on failure
+uint8_t * allocate_buffer_memory(int memory, size_t size, size_t * allocated_size);
+
+void free_buffer_memory(int memory, uint8_t * data, size_t allocated_size);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__BUFFER_MEMORY_HPP_
@@ -0,0 +1,39 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__CDR_BOOL_HPP_
+#define RMW_GURUMDDS__CDR_BOOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rmw_gurumdds_cpp
+{
+// Copies `cnt` one byte booleans, mapping every non-zero byte to 1.
+// `dst` may be equal to `src`.
+void copy_bool_normalized(void * dst, const void * src, size_t cnt);
+
+// Writes the elements of `src` as one byte booleans
+void copy_bool_vector_to_bytes(uint8_t * dst, const std::vector<bool> & src);
+
+// Sets every element of `dst` from one byte booleans, `src` holds dst.size() of them
+void copy_bytes_to_bool_vector(std::vector<bool> & dst, const uint8_t * src);
+
+// Name of the kernel set selected for this CPU
+const char * get_bool_kernel_name();
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__CDR_BOOL_HPP_
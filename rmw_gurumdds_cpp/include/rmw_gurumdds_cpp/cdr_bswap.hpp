@@ -0,0 +1,61 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__CDR_BSWAP_HPP_
+#define RMW_GURUMDDS__CDR_BSWAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rmw_gurumdds_cpp
+{
+inline uint16_t bswap16(uint16_t data)
+{
+  return static_cast<uint16_t>((data >> 8) | (data << 8));
+}
+
+inline uint32_t bswap32(uint32_t data)
+{
+  return (data >> 24) |
+         ((data >> 8) & 0x0000ff00) |
+         ((data << 8) & 0x00ff0000) |
+         (data << 24);
+}
+
+inline uint64_t bswap64(uint64_t data)
+{
+  return (data >> 56) |
+         ((data >> 40) & 0x000000000000ff00ull) |
+         ((data >> 24) & 0x0000000000ff0000ull) |
+         ((data >> 8) & 0x00000000ff000000ull) |
+         ((data << 8) & 0x000000ff00000000ull) |
+         ((data << 24) & 0x0000ff0000000000ull) |
+         ((data << 40) & 0x00ff000000000000ull) |
+         (data << 56);
+}
+
+// Copies `cnt` elements from `src` to `dst`, reversing the byte order of each.
+// Neither pointer has to be aligned, and `dst` may be equal to `src`.
+void bswap_copy16(void * dst, const void * src, size_t cnt);
+
+void bswap_copy32(void * dst, const void * src, size_t cnt);
+
+void bswap_copy64(void * dst, const void * src, size_t cnt);
+
+// Name of the kernel set selected for this CPU
+const char * get_bswap_kernel_name();
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__CDR_BSWAP_HPP_
@@ -19,6 +19,7 @@
 #include <string>
 #include <stdexcept>
 #include <limits>
+#include <vector>
 
 #include "rosidl_runtime_c/string.h"
 #include "rosidl_runtime_c/string_functions.h"
@@ -37,8 +38,30 @@
 #define CDR_HEADER_SIZE 4
 #define CDR_HEADER_ENDIAN_IDX 1
 
+#define CDR_INITIAL_STORAGE_SIZE 256
+
 namespace rmw_gurumdds_cpp
 {
+// Byte order serialized data is written in. Native unless RMW_GURUMDDS_CDR_ENDIAN is
+// set to "little" or "big", in which case other-endian hosts swap on write.
+uint8_t get_cdr_output_endian();
+
+/**
+ * Storage that a serialization buffer can grow on demand, so that a message
+ * can be serialized in a single pass without knowing its size in advance.
+ */
+class CdrGrowableStorage {
+public:
+  virtual ~CdrGrowableStorage() = default;
+
+  // Grows the storage to at least `size` bytes, keeping its contents. Returns nullptr on failure.
+  virtual uint8_t * grow(size_t size) = 0;
+
+  virtual uint8_t * data() const = 0;
+
+  virtual size_t capacity() const = 0;
+};
+
 class CdrBuffer {
 public:
   CdrBuffer(uint8_t * buf, size_t size);
@@ -61,6 +84,16 @@ class CdrSerializationBuffer: public CdrBuffer {
 public:
   CdrSerializationBuffer(uint8_t * buf, size_t size);
 
+  explicit CdrSerializationBuffer(CdrGrowableStorage & storage);
+
+  // Total number of bytes written, including the encapsulation header
+  size_t get_serialized_size() const;
+
+  // True if the data is written in the other byte order
+  bool needs_swap() const;
+
+  void roundup(uint32_t align);
+
   void operator<<(uint8_t src);
 
   void operator<<(uint16_t src);
@@ -84,12 +117,38 @@ public:
   void copy_arr(const uint32_t * arr, size_t cnt);
 
   void copy_arr(const uint64_t * arr, size_t cnt);
+
+  // Booleans are one byte each, non-zero values are written as 1
+  void copy_bool_arr(const bool * arr, size_t cnt);
+
+  void copy_bool_vector(const std::vector<bool> & vec);
+
+private:
+  void reserve(size_t cnt);
+
+  CdrGrowableStorage * storage_ {nullptr};
+  bool swap_ {false};
 };
 
+class DeserializationArena;
+
 class CdrDeserializationBuffer: public CdrBuffer {
 public:
   CdrDeserializationBuffer(uint8_t * buf, size_t size);
 
+  // True if the data was written in the other byte order
+  bool needs_swap() const;
+
+  // Moves to an offset from the end of the encapsulation header
+  void seek(size_t offset);
+
+  void skip(size_t cnt);
+
+  // C strings and sequences read with an arena set are allocated from it, see arena_take.hpp
+  void set_arena(DeserializationArena * arena);
+
+  DeserializationArena * get_arena() const;
+
   void operator>>(uint8_t & dst);
 
   void operator>>(uint16_t & dst);
@@ -114,8 +173,14 @@ public:
 
   void copy_arr(uint64_t * arr, size_t cnt);
 
+  void copy_bool_arr(bool * arr, size_t cnt);
+
+  // Resizes the vector to `cnt` elements
+  void copy_bool_vector(std::vector<bool> & vec, size_t cnt);
+
 private:
   bool swap_;
+  DeserializationArena * arena_ {nullptr};
 };
 } // namespace rmw_gurumdds_cpp
 
@@ -15,6 +15,9 @@
 #ifndef RMW_GURUMDDS__CDR_SERIALIZATION_BUFFER_INL_
 #define RMW_GURUMDDS__CDR_SERIALIZATION_BUFFER_INL_
 
+#include "rmw_gurumdds_cpp/cdr_bool.hpp"
+#include "rmw_gurumdds_cpp/cdr_bswap.hpp"
+
 namespace rmw_gurumdds_cpp
 {
 template<>
@@ -28,23 +31,84 @@ inline CdrSerializationBuffer<true>::CdrSerializationBuffer(uint8_t * buf, size_
     throw std::runtime_error("Insufficient buffer size");
   }
   std::memset(buf, 0, CDR_HEADER_SIZE);
-  buf[CDR_HEADER_ENDIAN_IDX] = CDR_SYSTEM_ENDIAN;
+  buf[CDR_HEADER_ENDIAN_IDX] = get_cdr_output_endian();
+  swap_ = (buf[CDR_HEADER_ENDIAN_IDX] != CDR_SYSTEM_ENDIAN);
   buf_ = buf + CDR_HEADER_SIZE;
   size_ = size - CDR_HEADER_SIZE;
 }
 
+template<>
+inline CdrSerializationBuffer<true>::CdrSerializationBuffer(CdrGrowableStorage & storage)
+  : CdrBuffer{nullptr, 0}
+  , storage_{&storage} {
+  uint8_t * buf = storage.data();
+  if (nullptr == buf || storage.capacity() < CDR_HEADER_SIZE) {
+    buf = storage.grow(CDR_INITIAL_STORAGE_SIZE);
+    if (nullptr == buf) {
+      throw std::runtime_error("Failed to allocate buffer");
+    }
+  }
+
+  std::memset(buf, 0, CDR_HEADER_SIZE);
+  buf[CDR_HEADER_ENDIAN_IDX] = get_cdr_output_endian();
+  swap_ = (buf[CDR_HEADER_ENDIAN_IDX] != CDR_SYSTEM_ENDIAN);
+  buf_ = buf + CDR_HEADER_SIZE;
+  size_ = storage.capacity() - CDR_HEADER_SIZE;
+}
+
 template<>
 inline CdrSerializationBuffer<false>::CdrSerializationBuffer(uint8_t *, size_t)
   : CdrBuffer{nullptr, std::numeric_limits<size_t>::max()} {
 }
 
+template<bool SERIALIZE>
+inline size_t CdrSerializationBuffer<SERIALIZE>::get_serialized_size() const {
+  return offset_ + CDR_HEADER_SIZE;
+}
+
+template<bool SERIALIZE>
+inline bool CdrSerializationBuffer<SERIALIZE>::needs_swap() const {
+  return swap_;
+}
+
+template<bool SERIALIZE>
+inline void CdrSerializationBuffer<SERIALIZE>::reserve(size_t cnt) {
+  if (offset_ + cnt <= size_) {
+    return;
+  }
+
+  if (nullptr == storage_) {
+    throw std::runtime_error("Out of buffer");
+  }
+
+  size_t required = CDR_HEADER_SIZE + offset_ + cnt;
+  size_t grown = storage_->capacity() * 2;
+  uint8_t * buf = storage_->grow(grown > required ? grown : required);
+  if (nullptr == buf) {
+    throw std::runtime_error("Failed to grow buffer");
+  }
+
+  buf_ = buf + CDR_HEADER_SIZE;
+  size_ = storage_->capacity() - CDR_HEADER_SIZE;
+}
+
+template<bool SERIALIZE>
+inline void CdrSerializationBuffer<SERIALIZE>::roundup(uint32_t align) {
+  size_t count = -offset_ & (align - 1);
+  if constexpr (SERIALIZE) {
+    reserve(count);
+    // Padding is not otherwise written, keep it deterministic in reused storage
+    std::memset(buf_ + offset_, 0, count);
+  }
+
+  advance(count);
+}
+
 template<bool SERIALIZE>
 inline void CdrSerializationBuffer<SERIALIZE>::operator<<(uint8_t src) {
   roundup(sizeof(uint8_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + sizeof(uint8_t) > size_) {
-      throw std::runtime_error("Out of buffer");
-    }
+    reserve(sizeof(uint8_t));
     *(reinterpret_cast<uint8_t *>(buf_ + offset_)) = src;
   }
 
@@ -55,8 +119,9 @@ template<bool SERIALIZE>
 inline void CdrSerializationBuffer<SERIALIZE>::operator<<(uint16_t src) {
   roundup(sizeof(uint16_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + sizeof(uint16_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(sizeof(uint16_t));
+    if (swap_) {
+      src = bswap16(src);
     }
     *(reinterpret_cast<uint16_t *>(buf_ + offset_)) = src;
   }
@@ -68,8 +133,9 @@ template<bool SERIALIZE>
 inline void CdrSerializationBuffer<SERIALIZE>::operator<<(uint32_t src) {
   roundup(sizeof(uint32_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + sizeof(uint32_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(sizeof(uint32_t));
+    if (swap_) {
+      src = bswap32(src);
     }
     *(reinterpret_cast<uint32_t *>(buf_ + offset_)) = src;
   }
@@ -81,8 +147,9 @@ template<bool SERIALIZE>
 inline void CdrSerializationBuffer<SERIALIZE>::operator<<(uint64_t src) {
   roundup(sizeof(uint64_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + sizeof(uint64_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(sizeof(uint64_t));
+    if (swap_) {
+      src = bswap64(src);
     }
     *(reinterpret_cast<uint64_t *>(buf_ + offset_)) = src;
   }
@@ -96,9 +163,7 @@ inline void CdrSerializationBuffer<SERIALIZE>::operator<<(const std::string & sr
   *this << static_cast<uint32_t>(src.size() + 1);
   roundup(sizeof(char));  // align of char
   if constexpr (SERIALIZE) {
-    if (offset_ + src.size() + 1 > size_) {
-      throw std::runtime_error("Out of buffer");
-    }
+    reserve(src.size() + 1);
     std::memcpy(buf_ + offset_, src.c_str(), src.size() + 1);
   }
   advance(src.size() + 1);
@@ -110,11 +175,12 @@ inline void CdrSerializationBuffer<SERIALIZE>::operator<<(const std::u16string &
   *this << static_cast<uint32_t>(src.size());
   roundup(sizeof(char16_t));  // align of char16_t
   if constexpr (SERIALIZE) {
-    if (offset_ + (src.size() * sizeof(char16_t)) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(src.size() * sizeof(char16_t));
+    if (swap_) {
+      bswap_copy16(buf_ + offset_, src.data(), src.size());
+    } else {
+      std::memcpy(buf_ + offset_, src.data(), sizeof(char16_t) * src.size());
     }
-
-    std::memcpy(buf_ + offset_, src.data(), sizeof(char16_t) * src.size());
   }
   advance(src.size() * sizeof(char16_t));
 }
@@ -125,9 +191,7 @@ inline void CdrSerializationBuffer<SERIALIZE>::operator<<(const rosidl_runtime_c
   *this << static_cast<uint32_t>(src.size + 1);
   roundup(sizeof(char));  // align of char
   if constexpr (SERIALIZE) {
-    if (offset_ + src.size + 1 > size_) {
-      throw std::runtime_error("Out of buffer");
-    }
+    reserve(src.size + 1);
     std::memcpy(buf_ + offset_, src.data, src.size + 1);
   }
   advance(src.size + 1);
@@ -139,11 +203,12 @@ inline void CdrSerializationBuffer<SERIALIZE>::operator<<(const rosidl_runtime_c
   *this << static_cast<uint32_t>(src.size);
   roundup(sizeof(char16_t));  // align of char16_t
   if constexpr (SERIALIZE) {
-    if (offset_ + (src.size * sizeof(char16_t)) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(src.size * sizeof(char16_t));
+    if (swap_) {
+      bswap_copy16(buf_ + offset_, src.data, src.size);
+    } else {
+      std::memcpy(buf_ + offset_, src.data, sizeof(char16_t) * src.size);
     }
-
-    std::memcpy(buf_ + offset_, src.data, sizeof(char16_t) * src.size);
   }
   advance(src.size * sizeof(char16_t));
 }
@@ -157,9 +222,7 @@ inline void CdrSerializationBuffer<SERIALIZE>::copy_arr(const uint8_t * arr, siz
 
   roundup(sizeof(uint8_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + cnt * sizeof(uint8_t) > size_) {
-      throw std::runtime_error("Out of buffer");
-    }
+    reserve(cnt * sizeof(uint8_t));
     std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint8_t));
   }
   advance(cnt * sizeof(uint8_t));
@@ -174,10 +237,12 @@ inline void CdrSerializationBuffer<SERIALIZE>::copy_arr(const uint16_t * arr, si
 
   roundup(sizeof(uint16_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + cnt * sizeof(uint16_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(cnt * sizeof(uint16_t));
+    if (swap_) {
+      bswap_copy16(buf_ + offset_, arr, cnt);
+    } else {
+      std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint16_t));
     }
-    std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint16_t));
   }
   advance(cnt * sizeof(uint16_t));
 }
@@ -191,10 +256,12 @@ inline void CdrSerializationBuffer<SERIALIZE>::copy_arr(const uint32_t * arr, si
 
   roundup(sizeof(uint32_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + cnt * sizeof(uint32_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(cnt * sizeof(uint32_t));
+    if (swap_) {
+      bswap_copy32(buf_ + offset_, arr, cnt);
+    } else {
+      std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint32_t));
     }
-    std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint32_t));
   }
   advance(cnt * sizeof(uint32_t));
 }
@@ -208,13 +275,35 @@ inline void CdrSerializationBuffer<SERIALIZE>::copy_arr(const uint64_t * arr, si
 
   roundup(sizeof(uint64_t));
   if constexpr (SERIALIZE) {
-    if (offset_ + cnt * sizeof(uint64_t) > size_) {
-      throw std::runtime_error("Out of buffer");
+    reserve(cnt * sizeof(uint64_t));
+    if (swap_) {
+      bswap_copy64(buf_ + offset_, arr, cnt);
+    } else {
+      std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint64_t));
     }
-    std::memcpy(buf_ + offset_, arr, cnt * sizeof(uint64_t));
   }
   advance(cnt * sizeof(uint64_t));
 }
+
+template<bool SERIALIZE>
+inline void CdrSerializationBuffer<SERIALIZE>::copy_bool_arr(const bool * arr, size_t cnt)
+{
+  if constexpr (SERIALIZE) {
+    reserve(cnt);
+    copy_bool_normalized(buf_ + offset_, arr, cnt);
+  }
+  advance(cnt);
+}
+
+template<bool SERIALIZE>
+inline void CdrSerializationBuffer<SERIALIZE>::copy_bool_vector(const std::vector<bool> & vec)
+{
+  if constexpr (SERIALIZE) {
+    reserve(vec.size());
+    copy_bool_vector_to_bytes(buf_ + offset_, vec);
+  }
+  advance(vec.size());
+}
 } // namespace rmw_gurumdds_cpp
 
 #endif  // RMW_GURUMDDS__CDR_SERIALIZATION_BUFFER_INL_
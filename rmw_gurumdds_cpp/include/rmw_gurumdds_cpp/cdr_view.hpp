@@ -0,0 +1,153 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__CDR_VIEW_HPP_
+#define RMW_GURUMDDS__CDR_VIEW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rmw/ret_types.h"
+#include "rmw/serialized_message.h"
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+class CdrDeserializationBuffer;
+
+/**
+ * Read-only view of a serialized message, which reads single members without deserializing
+ * the others. Members are named by a path such as "header.stamp.sec" or "poses[2].position.x".
+ * The stream offsets of the members and elements walked to reach one are cached, so a later
+ * read only skips what was not walked yet. The serialized data must outlive the view.
+ */
+class RMW_GURUMDDS_CPP_PUBLIC_TYPE CdrView {
+public:
+  RMW_GURUMDDS_CPP_PUBLIC
+  CdrView(
+    const rosidl_message_type_support_t * type_supports,
+    const uint8_t * data,
+    size_t size);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  CdrView(
+    const rosidl_message_type_support_t * type_supports,
+    const rmw_serialized_message_t * serialized_message);
+
+  // False if the type support is not an introspection one or the data has no CDR header
+  RMW_GURUMDDS_CPP_PUBLIC
+  bool is_valid() const;
+
+  // The type of the value must match the member, RMW_RET_INVALID_ARGUMENT otherwise
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, bool & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, int8_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, uint8_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, int16_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, uint16_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, int32_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, uint32_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, int64_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, uint64_t & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, float & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, double & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, std::string & value);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t read(const char * path, std::u16string & value);
+
+  // Element count of an array or sequence member
+  RMW_GURUMDDS_CPP_PUBLIC
+  rmw_ret_t get_size(const char * path, size_t & size);
+
+private:
+  struct Field
+  {
+    uint8_t type_id;
+    // True if the field is a whole array or sequence rather than a single value
+    bool is_array;
+    // Element count of a fixed size array, 0 for a sequence
+    size_t array_size;
+    // Stream offset the field starts at, before its alignment
+    size_t position;
+  };
+
+  using ResolveFn = rmw_ret_t (CdrView::*)(const char * path, Field & field);
+
+  template<typename MessageMembersT>
+  rmw_ret_t resolve(const char * path, Field & field);
+
+  template<typename MessageMembersT>
+  size_t get_member_position(
+    CdrDeserializationBuffer & buffer,
+    const MessageMembersT * members,
+    size_t position,
+    uint32_t index);
+
+  template<typename MessageMembersT>
+  bool get_element_position(
+    CdrDeserializationBuffer & buffer,
+    const void * member,
+    size_t position,
+    size_t index,
+    size_t & element_position);
+
+  template<typename T>
+  rmw_ret_t read_value(const char * path, T & value, std::initializer_list<uint8_t> type_ids);
+
+  rmw_ret_t find(const char * path, Field & field);
+
+  const void * members_ {nullptr};
+  ResolveFn resolve_ {nullptr};
+  uint8_t * data_;
+  size_t size_;
+  // Resolved paths
+  std::map<std::string, Field> fields_;
+  // Offsets of the members of a struct, or the elements of an array, walked from its position
+  std::map<std::pair<const void *, size_t>, std::vector<size_t>> offsets_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__CDR_VIEW_HPP_
@@ -0,0 +1,88 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__COMPRESSION_HPP_
+#define RMW_GURUMDDS__COMPRESSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+
+// Endpoint user data advertising the payload compression a reader can undo and a writer uses
+#define COMPRESSION_USER_DATA_KEY "compression"
+#define COMPRESSION_LZ4 "lz4"
+
+// A compressed payload starts with the two bytes of the marker, which no CDR encapsulation
+// identifier has, two bytes of options and the uncompressed size as a little endian uint32.
+// The LZ4 block follows
+#define COMPRESSED_PAYLOAD_MARKER_0 0x4c
+#define COMPRESSED_PAYLOAD_MARKER_1 0x5a
+#define COMPRESSED_PAYLOAD_HEADER_SIZE 8
+
+namespace rmw_gurumdds_cpp
+{
+// True if this build can compress and decompress payloads
+bool is_compression_supported();
+
+bool is_compressed_payload(const void * payload, size_t size);
+
+// Uncompressed size of a compressed payload
+size_t get_decompressed_size(const void * payload, size_t size);
+
+// Decompresses a payload into output, of get_decompressed_size bytes. False with the error
+// message set if it is corrupt or this build cannot decompress it
+bool decompress_payload(const void * payload, size_t size, void * output, size_t output_size);
+
+/**
+ * Compression stage of a writer. A payload of at least the threshold is
+ * compressed when every matched reader advertises the support in its user
+ * data, so readers that cannot decompress keep receiving plain CDR. The
+ * matched readers are looked up again when they change. Only volatile
+ * writers compress, since a durable one would hand its compressed history to
+ * readers that match later.
+ */
+class PayloadCompressor
+{
+public:
+  explicit PayloadCompressor(const CompressionSettings & settings);
+
+  ~PayloadCompressor();
+
+  PayloadCompressor(const PayloadCompressor &) = delete;
+
+  PayloadCompressor & operator=(const PayloadCompressor &) = delete;
+
+  bool should_compress(dds_DataWriter * writer, size_t size);
+
+  // Room compress needs for a payload of size bytes
+  size_t get_max_compressed_size(size_t size) const;
+
+  // Size of the compressed payload in output, 0 if compressing does not make it smaller
+  size_t compress(const void * payload, size_t size, void * output, size_t capacity) const;
+
+private:
+  CompressionSettings settings_;
+  std::mutex mutex_;
+  dds_InstanceHandleSeq * matched_ {nullptr};
+  std::vector<dds_InstanceHandle_t> matched_handles_;
+  bool readers_compatible_ {false};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__COMPRESSION_HPP_
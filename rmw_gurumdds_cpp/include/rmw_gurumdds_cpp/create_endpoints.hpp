@@ -0,0 +1,62 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__CREATE_ENDPOINTS_HPP_
+#define RMW_GURUMDDS__CREATE_ENDPOINTS_HPP_
+
+#include <cstddef>
+
+#include "rmw/rmw.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+// Arguments of rmw_create_publisher, and the publisher created from them
+struct PublisherRequest
+{
+  const rosidl_message_type_support_t * type_supports;
+  const char * topic_name;
+  const rmw_qos_profile_t * qos_policies;
+  const rmw_publisher_options_t * publisher_options;
+  // Set by create_endpoints, destroyed by rmw_destroy_publisher
+  rmw_publisher_t * publisher;
+};
+
+// Arguments of rmw_create_subscription, and the subscription created from them
+struct SubscriptionRequest
+{
+  const rosidl_message_type_support_t * type_supports;
+  const char * topic_name;
+  const rmw_qos_profile_t * qos_policies;
+  const rmw_subscription_options_t * subscription_options;
+  // Set by create_endpoints, destroyed by rmw_destroy_subscription
+  rmw_subscription_t * subscription;
+};
+
+// Creates the publishers and subscriptions of a node at once. The DDS endpoints are created
+// disabled and enabled together, and the discovery update of the node is published once for
+// all of them. Either every endpoint is created, or none is
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+create_endpoints(
+  const rmw_node_t * node,
+  PublisherRequest * publishers,
+  size_t publisher_count,
+  SubscriptionRequest * subscriptions,
+  size_t subscription_count);
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__CREATE_ENDPOINTS_HPP_
@@ -0,0 +1,70 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__DESERIALIZATION_ARENA_HPP_
+#define RMW_GURUMDDS__DESERIALIZATION_ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/buffer_memory.hpp"
+
+#define DESERIALIZATION_ARENA_INITIAL_SIZE 4096
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Bump allocator of the C messages deserialized by arena takes, see
+ * arena_take.hpp. Allocations are not freed one by one, reset() drops all of
+ * them at once. Allocations that do not fit the block get blocks of their own
+ * until the next reset, which replaces the block by one that fits them all, so
+ * that steady state takes allocate from a single block.
+ */
+class DeserializationArena {
+public:
+  // The block is a BUFFER_MEMORY_* kind, see buffer_memory.hpp
+  explicit DeserializationArena(int memory = BUFFER_MEMORY_HEAP);
+
+  ~DeserializationArena();
+
+  DeserializationArena(const DeserializationArena &) = delete;
+
+  DeserializationArena & operator=(const DeserializationArena &) = delete;
+
+  // `alignment` is a power of two, up to alignof(std::max_align_t). nullptr on failure
+  void * allocate(size_t size, size_t alignment);
+
+  // Invalidates every allocation. False if the block could not be grown
+  bool reset();
+
+  // Resets the arena with a block of at least `size` bytes. False on allocation failure
+  bool reserve(size_t size);
+
+  size_t get_capacity() const;
+
+private:
+  bool replace_block(size_t size);
+
+  int memory_;
+  uint8_t * block_ {nullptr};
+  size_t capacity_ {0};
+  size_t used_ {0};
+  // Allocations past the block since the last reset
+  std::vector<uint8_t *> overflow_;
+  size_t overflow_size_ {0};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__DESERIALIZATION_ARENA_HPP_
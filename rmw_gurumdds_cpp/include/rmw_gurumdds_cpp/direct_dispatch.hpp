@@ -0,0 +1,132 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__DIRECT_DISPATCH_HPP_
+#define RMW_GURUMDDS__DIRECT_DISPATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+// Modes of a dispatch callback
+#define DIRECT_DISPATCH_DESERIALIZED 0
+#define DIRECT_DISPATCH_SERIALIZED 1
+// Samples taken from the reader at once
+#define DIRECT_DISPATCH_TAKE_COUNT 32
+
+namespace rmw_gurumdds_cpp
+{
+struct SubscriberInfo;
+
+// A sample handed to a dispatch callback, valid only until the callback returns
+struct DispatchedSample
+{
+  // Message of the subscription type, nullptr in DIRECT_DISPATCH_SERIALIZED mode
+  const void * ros_message;
+  // CDR payload with its encapsulation header, decompressed if the writer compressed it.
+  // nullptr in DIRECT_DISPATCH_DESERIALIZED mode
+  const uint8_t * serialized;
+  size_t serialized_size;
+  rmw_message_info_t message_info;
+};
+
+typedef void (* DispatchCallback)(const DispatchedSample * sample, void * user_data);
+
+/**
+ * Direct dispatch mode of a subscription, for latency critical consumers. The
+ * DDS listener takes every sample as it arrives and calls the callback with it
+ * on the receive thread, without the wait set or the executor; the
+ * subscription does not report new samples meanwhile and is not to be taken
+ * from. With use_workers the samples taken at once are dispatched on the
+ * deserialization workers of the context, when it has them: the callback then
+ * runs on several threads at a time and samples of a batch are not called in
+ * order. The callback must not block nor call back into the subscription.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+set_dispatch_callback(
+  const rmw_subscription_t * subscription,
+  DispatchCallback callback,
+  void * user_data,
+  int mode,
+  bool use_workers);
+
+// Returns the subscription to normal takes, once the running callbacks are done
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+clear_dispatch_callback(const rmw_subscription_t * subscription);
+
+// Callback and messages of a subscription in dispatch mode, used with its dispatch lock held
+class DirectDispatcher {
+public:
+  DirectDispatcher(
+    const MessagePlan * plan, DispatchCallback callback, void * user_data, int mode,
+    bool use_workers);
+
+  ~DirectDispatcher();
+
+  DirectDispatcher(const DirectDispatcher &) = delete;
+
+  DirectDispatcher & operator=(const DirectDispatcher &) = delete;
+
+  // Deserializes or decompresses a payload and calls the callback with it. `slot` picks the
+  // message and buffer used, one per concurrent call. False with the error message set on failure
+  bool dispatch(
+    size_t slot, const void * payload, size_t size, const rmw_message_info_t & message_info);
+
+  // Makes `count` slots and the batch ready. False on allocation failure
+  bool reserve(size_t count);
+
+  bool uses_workers() const;
+
+  // Samples of a take that are dispatched, sized for DIRECT_DISPATCH_TAKE_COUNT by reserve
+  struct Batch
+  {
+    // Indexes of the valid samples in the sequences of the take
+    std::vector<uint32_t> valid_samples;
+    std::vector<rmw_message_info_t> message_infos;
+  };
+
+  Batch & get_batch();
+
+private:
+  struct Slot
+  {
+    // Message of the subscription type, initialized once and reused by every sample
+    std::unique_ptr<std::max_align_t[]> message;
+    std::vector<uint8_t> decompressed;
+  };
+
+  const MessagePlan * plan_;
+  DispatchCallback callback_;
+  void * user_data_;
+  int mode_;
+  bool use_workers_;
+  std::vector<Slot> slots_;
+  Batch batch_;
+};
+
+// Dispatches the samples the subscription holds to its callback, called by its DDS listener
+void dispatch_samples(SubscriberInfo * subscriber_info);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__DIRECT_DISPATCH_HPP_
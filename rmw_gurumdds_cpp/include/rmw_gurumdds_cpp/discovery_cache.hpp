@@ -0,0 +1,133 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__DISCOVERY_CACHE_HPP_
+#define RMW_GURUMDDS__DISCOVERY_CACHE_HPP_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+#include "rosidl_runtime_c/type_hash.h"
+
+// First line of a discovery cache file
+#define DISCOVERY_CACHE_MAGIC "gurumdds_discovery_cache"
+#define DISCOVERY_CACHE_VERSION 1
+
+// Time the entries read from the file have to be discovered again before they are purged
+#define DISCOVERY_CACHE_CONFIRM_TIMEOUT_MS 10000
+// Period the file is rewritten at while the remote graph changes
+#define DISCOVERY_CACHE_SAVE_PERIOD_MS 1000
+
+namespace rmw_gurumdds_cpp
+{
+struct CachedNode
+{
+  std::string node_namespace;
+  std::string node_name;
+  std::vector<rmw_gid_t> readers;
+  std::vector<rmw_gid_t> writers;
+};
+
+struct CachedParticipant
+{
+  rmw_gid_t gid;
+  std::string enclave;
+  std::vector<CachedNode> nodes;
+  // Set once discovery found the participant or took its entities info
+  bool confirmed;
+  bool has_nodes;
+};
+
+struct CachedEntity
+{
+  rmw_gid_t gid;
+  rmw_gid_t participant_gid;
+  std::string topic_name;
+  std::string type_name;
+  rosidl_type_hash_t type_hash;
+  rmw_qos_profile_t qos;
+  bool is_reader;
+  bool confirmed;
+};
+
+/**
+ * Last known remote participants, their nodes and their endpoints, kept in a
+ * file so that a restarted context answers graph queries before discovery
+ * completes. Entries read from the file are unconfirmed until discovery
+ * reports them again, and are purged once the confirmation timeout is over.
+ * The file is rewritten in place, through a temporary file, at most once per
+ * save period while the graph changes and when the context is finalized.
+ */
+class DiscoveryCache {
+public:
+  DiscoveryCache(const std::string & path, uint64_t confirm_timeout_ns);
+
+  // Reads the file, returning the entries that were not discovered yet for the caller to seed the
+  // graph with. A missing file is empty, a malformed one is logged and ignored
+  void load(
+    uint64_t now_ns,
+    std::vector<CachedParticipant> & participants,
+    std::vector<CachedEntity> & entities);
+
+  // Writes the file, false with the error message set if it could not be written
+  bool save();
+
+  void add_participant(const rmw_gid_t & gid, const std::string & enclave);
+
+  void remove_participant(const rmw_gid_t & gid);
+
+  void update_participant(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg);
+
+  void add_entity(const CachedEntity & entity);
+
+  void remove_entity(const rmw_gid_t & gid);
+
+  // Once the confirmation timeout is over, removes the unconfirmed entries and returns them
+  void take_expired(
+    uint64_t now_ns,
+    std::vector<rmw_gid_t> & participants,
+    std::vector<std::pair<rmw_gid_t, bool>> & entities);
+
+  // Saves the file if it changed and the save period is over. False if it could not be written
+  bool save_if_due(uint64_t now_ns);
+
+  // Time of the next expiry or save check, UINT64_MAX if there is none
+  uint64_t get_deadline() const;
+
+private:
+  bool save_unsafe();
+
+  std::string path_;
+  uint64_t confirm_timeout_ns_;
+  mutable std::mutex mutex_;
+  std::map<rmw_gid_t, CachedParticipant, rmw_dds_common::Compare_rmw_gid_t> participants_;
+  std::map<rmw_gid_t, CachedEntity, rmw_dds_common::Compare_rmw_gid_t> entities_;
+  // 0 once the entries read from the file were confirmed or purged
+  uint64_t expiry_ns_ {0};
+  uint64_t next_save_ns_ {0};
+  bool dirty_ {false};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__DISCOVERY_CACHE_HPP_
@@ -0,0 +1,280 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__ENDPOINT_STATS_HPP_
+#define RMW_GURUMDDS__ENDPOINT_STATS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+// Buckets of a latency histogram, the first one ends at 2^LATENCY_HISTOGRAM_FIRST_SHIFT ns
+#define LATENCY_HISTOGRAM_BUCKETS 24
+#define LATENCY_HISTOGRAM_FIRST_SHIFT 10
+
+namespace rmw_gurumdds_cpp
+{
+// Counters of the samples an endpoint published since it was created
+struct WriterStats
+{
+  uint64_t sample_count;
+  // Serialized bytes of the samples, including the encapsulation header
+  uint64_t byte_count;
+  uint64_t serialization_time_ns;
+  // Time in the write calls, which only queue the sample for asynchronous publishers
+  uint64_t write_time_ns;
+  // Of the samples, the ones that failed to be written or were dropped by a full asynchronous
+  // queue
+  uint64_t dropped_count;
+};
+
+// Counters of the samples an endpoint took since it was created
+struct ReaderStats
+{
+  uint64_t sample_count;
+  // Serialized bytes of the samples, including the encapsulation header
+  uint64_t byte_count;
+  // Time deserializing the samples, or copying the serialized ones, outside of the DDS take calls
+  uint64_t deserialization_time_ns;
+  // Time in the DDS take calls, including the samples DDS deserializes itself
+  uint64_t take_time_ns;
+  // Takes that found no sample
+  uint64_t take_no_data_count;
+  // Samples DDS reported as lost, counted for subscriptions only
+  uint64_t lost_count;
+  // Samples skipped in the publication sequence numbers of the matched writers, by losses or by
+  // a history that overwrote them before the take. Counted for subscriptions without a content
+  // filter only
+  uint64_t sequence_gap_count;
+};
+
+// Publication sequence numbers of the samples a subscription took from a matched writer
+struct WriterSequenceStats
+{
+  uint8_t writer_gid[RMW_GID_STORAGE_SIZE];
+  int64_t last_sequence_number;
+  uint64_t gap_count;
+};
+
+// Log-scale histogram of latencies. Bucket 0 counts the latencies below 1024 ns, bucket i > 0
+// the ones from 2^(9 + i) ns to 2^(10 + i) ns and the last bucket all the longer ones
+struct LatencyHistogram
+{
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+};
+
+// Latencies of the samples a subscription took since it was created, recorded only for the
+// readers with latency_stats.enabled in the QoS profile file, see qos_profiles.hpp
+struct SubscriptionLatencyStats
+{
+  // From the source timestamp to the reception timestamp. Unsynchronized clocks of remote
+  // hosts make it meaningless, latencies below 0 are counted as 0
+  LatencyHistogram transport;
+  // From the reception timestamp to the take, the time the sample waited in the reader cache
+  LatencyHistogram queueing;
+};
+
+// Time a wait set spent in each phase of its waits since it was created
+struct WaitSetStats
+{
+  uint64_t wait_count;
+  // Attaching the conditions of the entities, and detaching the ones no longer waited on
+  uint64_t attach_time_ns;
+  // Spinning, polling or blocked in dds_WaitSet_wait
+  uint64_t wait_time_ns;
+  // Clearing the entities that are not ready and collecting the event statuses
+  uint64_t process_time_ns;
+};
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_publisher_stats(const rmw_publisher_t * publisher, WriterStats * stats);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_subscription_stats(const rmw_subscription_t * subscription, ReaderStats * stats);
+
+// Fills the stats of up to capacity writers, of the matched writers the subscription took samples
+// from. count is set to the number of those writers, which may exceed capacity
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_subscription_writer_stats(
+  const rmw_subscription_t * subscription,
+  WriterSequenceStats * stats,
+  size_t capacity,
+  size_t * count);
+
+// RMW_RET_UNSUPPORTED if the subscription does not record latencies
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_subscription_latency_stats(
+  const rmw_subscription_t * subscription,
+  SubscriptionLatencyStats * stats);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_client_stats(const rmw_client_t * client, WriterStats * requests, ReaderStats * responses);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_service_stats(const rmw_service_t * service, ReaderStats * requests, WriterStats * responses);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_wait_set_stats(const rmw_wait_set_t * wait_set, WaitSetStats * stats);
+
+// Monotonic time of the counters
+inline uint64_t stats_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Updated by every thread using the endpoint, the counters are independent so relaxed order
+// is enough
+class WriterCounters {
+public:
+  void on_write(size_t size, uint64_t serialization_ns, uint64_t write_ns)
+  {
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(size, std::memory_order_relaxed);
+    serialization_ns_.fetch_add(serialization_ns, std::memory_order_relaxed);
+    write_ns_.fetch_add(write_ns, std::memory_order_relaxed);
+  }
+
+  void on_drop()
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void get(WriterStats & stats) const;
+
+private:
+  std::atomic<uint64_t> samples_ {0};
+  std::atomic<uint64_t> bytes_ {0};
+  std::atomic<uint64_t> serialization_ns_ {0};
+  std::atomic<uint64_t> write_ns_ {0};
+  std::atomic<uint64_t> dropped_ {0};
+};
+
+class ReaderCounters {
+public:
+  void on_take(size_t count, size_t size, uint64_t deserialization_ns, uint64_t take_ns)
+  {
+    samples_.fetch_add(count, std::memory_order_relaxed);
+    bytes_.fetch_add(size, std::memory_order_relaxed);
+    deserialization_ns_.fetch_add(deserialization_ns, std::memory_order_relaxed);
+    take_ns_.fetch_add(take_ns, std::memory_order_relaxed);
+  }
+
+  void on_no_data(uint64_t take_ns)
+  {
+    no_data_.fetch_add(1, std::memory_order_relaxed);
+    take_ns_.fetch_add(take_ns, std::memory_order_relaxed);
+  }
+
+  void on_sequence_gap(uint64_t count)
+  {
+    sequence_gaps_.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void get(ReaderStats & stats) const;
+
+private:
+  std::atomic<uint64_t> samples_ {0};
+  std::atomic<uint64_t> bytes_ {0};
+  std::atomic<uint64_t> deserialization_ns_ {0};
+  std::atomic<uint64_t> take_ns_ {0};
+  std::atomic<uint64_t> no_data_ {0};
+  std::atomic<uint64_t> sequence_gaps_ {0};
+};
+
+class LatencyHistogramCounters {
+public:
+  void on_latency(int64_t latency_ns)
+  {
+    const uint64_t ns = latency_ns > 0 ? static_cast<uint64_t>(latency_ns) : 0;
+    size_t bucket = 0;
+    for (uint64_t bound = ns >> LATENCY_HISTOGRAM_FIRST_SHIFT;
+      bound != 0 && bucket < LATENCY_HISTOGRAM_BUCKETS - 1; bound >>= 1)
+    {
+      bucket++;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max_ns && !max_ns_.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  void get(LatencyHistogram & histogram) const;
+
+private:
+  std::atomic<uint64_t> count_ {0};
+  std::atomic<uint64_t> total_ns_ {0};
+  std::atomic<uint64_t> max_ns_ {0};
+  std::atomic<uint64_t> buckets_[LATENCY_HISTOGRAM_BUCKETS] = { };
+};
+
+// Timestamps are in ns of the system clock, the clock of the DDS source and reception timestamps
+class LatencyCounters {
+public:
+  void on_sample(int64_t source_timestamp, int64_t received_timestamp)
+  {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    transport_.on_latency(received_timestamp - source_timestamp);
+    queueing_.on_latency(now - received_timestamp);
+  }
+
+  void get(SubscriptionLatencyStats & stats) const;
+
+private:
+  LatencyHistogramCounters transport_;
+  LatencyHistogramCounters queueing_;
+};
+
+// Only successful waits are counted
+class WaitSetCounters {
+public:
+  void on_wait(uint64_t attach_ns, uint64_t wait_ns, uint64_t process_ns)
+  {
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    attach_ns_.fetch_add(attach_ns, std::memory_order_relaxed);
+    wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+    process_ns_.fetch_add(process_ns, std::memory_order_relaxed);
+  }
+
+  void get(WaitSetStats & stats) const;
+
+private:
+  std::atomic<uint64_t> waits_ {0};
+  std::atomic<uint64_t> attach_ns_ {0};
+  std::atomic<uint64_t> wait_ns_ {0};
+  std::atomic<uint64_t> process_ns_ {0};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__ENDPOINT_STATS_HPP_
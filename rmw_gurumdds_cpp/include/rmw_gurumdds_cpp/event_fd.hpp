@@ -0,0 +1,57 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__EVENT_FD_HPP_
+#define RMW_GURUMDDS__EVENT_FD_HPP_
+
+#include "rmw/rmw.h"
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Event fds let an executor multiplex rmw entities with other I/O in a single
+ * epoll_wait. The caller owns the eventfd passed in; every new sample or trigger
+ * adds 1 to its counter from the thread that delivered it, and the entity is
+ * then taken from as usual. Several entities may share one eventfd. An fd of -1
+ * detaches the entity. Not supported on Windows.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+set_subscription_event_fd(rmw_subscription_t * subscription, int event_fd);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+set_service_event_fd(rmw_service_t * service, int event_fd);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+set_client_event_fd(rmw_client_t * client, int event_fd);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+set_guard_condition_event_fd(rmw_guard_condition_t * guard_condition, int event_fd);
+
+// Adds 1 to the counter of the eventfd, ignored if the fd is -1
+void write_event_fd(int event_fd);
+
+void notify_guard_condition_event_fd(dds_GuardCondition * guard_condition);
+
+void remove_guard_condition_event_fd(dds_GuardCondition * guard_condition);
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__EVENT_FD_HPP_
@@ -15,17 +15,35 @@
 #ifndef RMW_GURUMDDS__EVENT_INFO_COMMON_HPP_
 #define RMW_GURUMDDS__EVENT_INFO_COMMON_HPP_
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "rmw/ret_types.h"
 #include "rmw/event_callback_type.h"
+#include "rmw/types.h"
 
 #include "rosidl_runtime_c/message_type_support_struct.h"
 #include "rosidl_runtime_c/service_type_support_struct.h"
 
+#include "rmw_dds_common/gid_utils.hpp"
+
+#include "rmw_gurumdds_cpp/async_publish.hpp"
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/deserialization_arena.hpp"
 #include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/direct_dispatch.hpp"
+#include "rmw_gurumdds_cpp/endpoint_stats.hpp"
+#include "rmw_gurumdds_cpp/intra_context.hpp"
+#include "rmw_gurumdds_cpp/loaned_message_pool.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+#include "rmw_gurumdds_cpp/raw_capture.hpp"
+#include "rmw_gurumdds_cpp/sample_sequence_pool.hpp"
 
 namespace rmw_gurumdds_cpp
 {
@@ -34,6 +52,14 @@ struct event_callback_data_t
   std::mutex mutex;
   rmw_event_callback_t callback {nullptr};
   const void * user_data {nullptr};
+  // eventfd of an executor, see event_fd.hpp
+  int event_fd {-1};
+
+  // True if new samples are reported, the DATA_AVAILABLE listener is needed
+  bool is_set_unsafe() const
+  {
+    return callback != nullptr || event_fd >= 0;
+  }
 };
 
 struct EventInfo
@@ -65,28 +91,66 @@ struct EventInfo
 struct PublisherInfo : EventInfo
 {
   const rosidl_message_type_support_t * rosidl_message_typesupport;
+  const MessagePlan * message_plan;
   const char * implementation_identifier;
   rmw_context_impl_t * ctx;
-  int64_t sequence_number;
+  // Incremented by every publish, which may run on several threads at once
+  std::atomic<int64_t> sequence_number {0};
 
   rmw_gid_t publisher_gid;
   dds_DataWriter * topic_writer;
+  MessageBufferPool message_buffers;
+  // Buffers of the samples handed to the subscriptions of the context
+  SharedMessageBufferPool local_buffers;
+  LoanedMessagePool loan_pool;
+  // Guards the statuses and the listener mask, held only to update or copy them
   std::mutex mutex_event;
+  // Guards the event callbacks, which are invoked without mutex_event
+  std::mutex mutex_event_callback;
   rmw_event_callback_t on_new_event_cb[RMW_EVENT_INVALID] = { };
   const void * user_data_cb[RMW_EVENT_INVALID] = { };
-  dds_GuardCondition* event_guard_cond[RMW_EVENT_INVALID] = { };
+  // Created by get_guard_condition, the DDS listeners skip the ones not created yet
+  std::atomic<dds_GuardCondition *> event_guard_cond[RMW_EVENT_INVALID] = { };
   dds_StatusMask mask = 0;
-  bool inconsistent_topic_changed = false;
+  // Statuses the listener gets whatever the event callbacks, they stay in mask
+  dds_StatusMask internal_mask = 0;
+  // Status kinds kept by the listener, for polls that do not take mutex_event
+  std::atomic<dds_StatusMask> callback_mask {0};
+  std::atomic_bool inconsistent_topic_changed {false};
   dds_InconsistentTopicStatus inconsistent_topic_status = { };
-  bool offered_deadline_missed_changed = false;
+  std::atomic_bool offered_deadline_missed_changed {false};
   dds_OfferedDeadlineMissedStatus offered_deadline_missed_status = { };
-  bool offered_incompatible_qos_changed = false;
+  std::atomic_bool offered_incompatible_qos_changed {false};
   dds_OfferedIncompatibleQosStatus offered_incompatible_qos_status = { };
-  bool liveliness_lost_changed = false;
+  std::atomic_bool liveliness_lost_changed {false};
   dds_LivelinessLostStatus liveliness_lost_status = { };
-  bool publication_matched_changed = false;
+  std::atomic_bool publication_matched_changed {false};
   dds_PublicationMatchedStatus publication_matched_status = { };
   dds_DataWriterListener topic_listener = { };
+  // True if the samples can be handed to the subscriptions of the context, see intra_context.hpp
+  bool local_delivery {false};
+  // Guards the matched readers and the subscriptions the samples are handed to
+  std::mutex mutex_local;
+  std::vector<LocalReader> local_readers;
+  // True if every reader in local_readers belongs to a subscription of the context
+  bool local_ready {false};
+  // Incremented by every lookup of the matched readers, the older ones are not kept
+  uint64_t local_match_stamp {0};
+  // Changed by every update of the readers and every sample written to DDS
+  uint64_t local_generation {0};
+  // True while the samples are handed to the readers rather than written to DDS
+  bool local_active {false};
+  // Subscriptions of earlier readers handed samples since the writer last wrote to DDS
+  std::vector<SubscriberInfo *> local_handed;
+  // Subscriptions the writer marked as mixed, told about its samples written to DDS
+  std::vector<SubscriberInfo *> local_mixed;
+  // Sequence number of the last sample written to DDS
+  int64_t local_last_dds {0};
+  // Queue of the samples the sender thread writes, nullptr if they are written on publish
+  std::unique_ptr<AsyncPublisher> async;
+  // Compresses the larger payloads, nullptr if the topic is not compressed
+  std::unique_ptr<PayloadCompressor> compressor;
+  WriterCounters stats;
 
   rmw_ret_t get_status(rmw_event_type_t event_type, void * event) override;
 
@@ -96,9 +160,10 @@ struct PublisherInfo : EventInfo
 
   bool is_status_changed(rmw_event_type_t event_type) override;
 
-  bool has_callback(rmw_event_type_t event_type) override;
+  // Flag set by the listener of the event, nullptr if the event is not supported
+  std::atomic_bool * get_changed_flag(rmw_event_type_t event_type);
 
-  bool has_callback_unsafe(rmw_event_type_t event_type) const;
+  bool has_callback(rmw_event_type_t event_type) override;
 
   rmw_ret_t set_on_new_event_callback(
     rmw_event_type_t event_type,
@@ -118,44 +183,104 @@ struct PublisherInfo : EventInfo
   void on_publication_matched(const dds_PublicationMatchedStatus & status);
 };
 
-size_t count_unread(
-  dds_DataReader * reader,
-  dds_DataSeq * data_seq,
-  dds_SampleInfoSeq * info_seq,
-  dds_UnsignedLongSeq * raw_data_sizes);
+size_t count_unread(dds_DataReader * reader, SampleSequencePool & sample_pool);
+
+// The DDS loan of a payload handed out in place, or the buffer it was copied to
+struct SerializedLoan
+{
+  SampleSequences sample;
+  std::shared_ptr<const MessageBuffer> buffer;
+};
+
+// Writer matched with a subscription, cached when the first sample of the writer is taken
+struct MatchedPublication
+{
+  std::array<uint8_t, RMW_GID_STORAGE_SIZE> guid;
+  // dds_HANDLE_NIL while only local samples were taken from the writer
+  dds_InstanceHandle_t handle {dds_HANDLE_NIL};
+  // Publication sequence number of the last sample taken from the writer, 0 before the first
+  int64_t last_sequence_number {0};
+  // Sequence numbers skipped by the samples taken from the writer
+  uint64_t gap_count {0};
+};
 
 struct SubscriberInfo : EventInfo
 {
   const rosidl_message_type_support_t * rosidl_message_typesupport;
+  const MessagePlan * message_plan;
   const char * implementation_identifier;
   rmw_context_impl_t * ctx;
+  // Guards the statuses and the listener mask, held only to update or copy them
   std::mutex mutex_event;
+  // Guards the event callbacks, which are invoked without mutex_event
+  std::mutex mutex_event_callback;
   rmw_event_callback_t on_new_event_cb[RMW_EVENT_INVALID] = { };
   const void * user_data_cb[RMW_EVENT_INVALID] = { };
-  dds_GuardCondition* event_guard_cond[RMW_EVENT_INVALID] = { };
+  // Created by get_guard_condition, the DDS listeners skip the ones not created yet
+  std::atomic<dds_GuardCondition *> event_guard_cond[RMW_EVENT_INVALID] = { };
   dds_StatusMask mask = 0;
-  bool requested_deadline_missed_changed = false;
+  // Statuses the listener gets whatever the event callbacks, they stay in mask
+  dds_StatusMask internal_mask = 0;
+  // Status kinds kept by the listener, for polls that do not take mutex_event
+  std::atomic<dds_StatusMask> callback_mask {0};
+  std::atomic_bool requested_deadline_missed_changed {false};
   dds_RequestedDeadlineMissedStatus requested_deadline_missed_status = { };
-  bool requested_incompatible_qos_changed = false;
+  std::atomic_bool requested_incompatible_qos_changed {false};
   dds_RequestedIncompatibleQosStatus requested_incompatible_qos_status = { };
-  bool inconsistent_topic_changed = false;
+  std::atomic_bool inconsistent_topic_changed {false};
   dds_InconsistentTopicStatus inconsistent_topic_status = { };
-  bool liveliness_changed = false;
+  std::atomic_bool liveliness_changed {false};
   dds_LivelinessChangedStatus liveliness_changed_status = { };
-  bool subscription_matched_changed = false;
+  std::atomic_bool subscription_matched_changed {false};
   dds_SubscriptionMatchedStatus subscription_matched_status = { };
-  bool sample_lost_changed = false;
+  std::atomic_bool sample_lost_changed {false};
   dds_SampleLostStatus sample_lost_status = { };
 
   rmw_gid_t subscriber_gid;
   dds_DataReader * topic_reader;
   dds_ReadCondition * read_condition;
+  // Topic the reader was created on when a content filter is set, nullptr otherwise
+  dds_ContentFilteredTopic * filtered_topic {nullptr};
+  // Node of a subscription listed in the graph, nullptr for internal subscriptions
+  const rmw_node_t * node {nullptr};
 
   dds_DataReaderListener topic_listener;
-  dds_DataSeq * data_seq;
-  dds_SampleInfoSeq * info_seq;
-  dds_UnsignedLongSeq * raw_data_sizes;
+  SampleSequencePool sample_pool;
   event_callback_data_t event_callback_data;
+  LoanedMessagePool loan_pool;
+  std::mutex mutex_loans;
+  // DDS loans of the samples that loaned takes handed out in place
+  std::unordered_map<void *, SampleSequences> loaned_samples;
+  // Payloads that serialized loaned takes handed out, see serialized_loan.hpp
+  std::unordered_map<const void *, SerializedLoan> loaned_serialized;
+  std::mutex mutex_publications;
+  // Writers samples were taken from, by GID. The ones no longer matched are dropped by
+  // on_subscription_matched, the local ones by forget_publication
+  std::map<rmw_gid_t, MatchedPublication, rmw_dds_common::Compare_rmw_gid_t> publications;
+  // The same writers by publication handle, for the message info of taken samples
+  std::unordered_map<dds_InstanceHandle_t, MatchedPublication *> publication_handles;
+  // Gaps in the sequence numbers are also reported as RMW_EVENT_MESSAGE_LOST
+  bool report_sequence_gaps {false};
+  // Sequence number gaps reported as lost samples, guarded by mutex_event
+  uint64_t sequence_gap_lost_total {0};
+  int32_t sequence_gap_lost_change {0};
+  // Samples handed over by the publishers of the context, nullptr if the subscription gets none
+  std::unique_ptr<LocalSampleQueue> local_samples;
+  // Deliveries notifying the subscription after their push, waited for by its removal
+  std::atomic<uint32_t> local_notifying {0};
+  ReaderCounters stats;
+  // Latencies of the taken samples, nullptr unless enabled for the topic in the QoS profiles
+  std::unique_ptr<LatencyCounters> latency;
+  // Guards capture, held while the DDS listener appends the samples to it
+  std::mutex mutex_capture;
+  // File the samples are captured into, nullptr unless in capture mode, see raw_capture.hpp
+  std::unique_ptr<RawCaptureWriter> capture;
+  std::atomic_bool capturing {false};
+  // Guards dispatcher, held while the DDS listener runs its callback
+  std::mutex mutex_dispatch;
+  // Callback the samples are handed to, nullptr unless in dispatch mode, see direct_dispatch.hpp
+  std::unique_ptr<DirectDispatcher> dispatcher;
+  std::atomic_bool dispatching {false};
 
   rmw_ret_t get_status(rmw_event_type_t event_type, void * event) override;
 
@@ -165,9 +290,10 @@ struct SubscriberInfo : EventInfo
 
   bool is_status_changed(rmw_event_type_t event_type) override;
 
-  bool has_callback(rmw_event_type_t event_type) override;
+  // Flag set by the listener of the event, nullptr if the event is not supported
+  std::atomic_bool * get_changed_flag(rmw_event_type_t event_type);
 
-  bool has_callback_unsafe(rmw_event_type_t event_type) const;
+  bool has_callback(rmw_event_type_t event_type) override;
 
   rmw_ret_t set_on_new_event_callback(
     rmw_event_type_t event_type,
@@ -191,13 +317,56 @@ struct SubscriberInfo : EventInfo
   void on_sample_lost(const dds_SampleLostStatus& status);
 
   size_t count_unread();
+
+  // Takes the oldest sample handed over by a publisher of the context, false if there is none
+  bool pop_local_sample(LocalSample & sample);
+
+  // Copies the GUID of a matched writer, looking it up in DDS the first time the writer is seen
+  dds_ReturnCode_t get_publication_guid(dds_InstanceHandle_t publication_handle, uint8_t * guid);
+
+  // Counts the samples the writer published since the last one taken from it as lost
+  void on_sequence_number(dds_InstanceHandle_t publication_handle, int64_t sequence_number);
+
+  // Same for a sample handed over by a publisher of the context, which shares the numbering of
+  // its writer
+  void on_local_sequence_number(const rmw_gid_t & publisher_gid, int64_t sequence_number);
+
+  // Sequence number of the last sample taken from the writer, 0 if there is none
+  int64_t get_last_sequence_number(const rmw_gid_t & publisher_gid);
+
+  // Drops a writer of the context that is going away, DDS does not report its local samples
+  void forget_publication(const rmw_gid_t & publisher_gid);
+
+  // Counts skipped sequence numbers as lost, reported as RMW_EVENT_MESSAGE_LOST if enabled
+  void on_sequence_gap(uint64_t gap);
 };
 
+// Storage of rmw_publisher_allocation_t, sized up front so that publishing does not allocate
+struct PublisherAllocation
+{
+  const MessagePlan * message_plan;
+  MessageBuffer message_buffer;
+};
+
+// Storage of rmw_subscription_allocation_t, reused by every take it is passed to
+struct SubscriptionAllocation
+{
+  const MessagePlan * message_plan;
+  SampleSequences sample;
+  // Created by the first arena take, see arena_take.hpp
+  std::unique_ptr<DeserializationArena> arena;
+};
+
+// Reports inconsistent topics to the endpoints of a topic. The listener is stored as the listener
+// context of the topic, which is created and deleted under its topic lock, see topic_locks.hpp
 class TopicEventListener {
 public:
   static rmw_ret_t associate_listener(dds_Topic* topic);
 
-  static rmw_ret_t disassociate_Listener(dds_Topic* topic);
+  static TopicEventListener* get_listener(dds_Topic* topic);
+
+  // Deletes the listener of a topic got before the topic was deleted
+  static void disassociate_listener(TopicEventListener* listener);
 
   static void add_event(dds_Topic* topic, EventInfo* event_info);
 
@@ -209,9 +378,6 @@ private:
   static void on_inconsistent_topic(const dds_Topic* the_topic, const dds_InconsistentTopicStatus* status);
 
 private:
-  static std::map<dds_Topic*, TopicEventListener*> table_;
-  static std::mutex mutex_table_;
-
   std::recursive_mutex mutex_;
   std::vector<EventInfo*> event_list_;
 };
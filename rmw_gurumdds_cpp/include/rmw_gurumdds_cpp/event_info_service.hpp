@@ -15,6 +15,11 @@
 #ifndef RMW_GURUMDDS__EVENT_INFO_SERVICE_HPP_
 #define RMW_GURUMDDS__EVENT_INFO_SERVICE_HPP_
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
 #include "rmw/event_callback_type.h"
 #include "rmw/types.h"
 
@@ -22,16 +27,28 @@
 #include "rosidl_runtime_c/service_type_support_struct.h"
 
 #include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/endpoint_stats.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+#include "rmw_gurumdds_cpp/type_support_service.hpp"
+
+// Listened to on the response reader of a client whether a response callback is set or not
+#define CLIENT_RESPONSE_LISTENER_MASK dds_SUBSCRIPTION_MATCHED_STATUS
+
+// Requests in flight a client keeps track of, the responses to further ones are not checked
+#define PENDING_REQUEST_TABLE_SIZE 4096
 
 namespace rmw_gurumdds_cpp
 {
 struct ClientInfo
 {
   const rosidl_service_type_support_t * service_typesupport;
+  // (De)serializers of service_typesupport
+  ServiceTypeSupport type_support;
   const char * implementation_identifier;
   rmw_context_impl_t * ctx;
-  int64_t sequence_number;
+  // Incremented by every request, which may be sent from several threads at once
+  std::atomic<int64_t> sequence_number {0};
   uint8_t writer_guid[16];
 
   rmw_gid_t publisher_gid;
@@ -39,21 +56,38 @@ struct ClientInfo
   dds_DataWriter * request_writer;
   dds_DataReader * response_reader;
   dds_ReadCondition * read_condition;
+  MessageBufferPool message_buffers;
 
+  dds_DataWriterListener request_listener;
   dds_DataReaderListener response_listener;
-  dds_DataSeq * data_seq;
-  dds_SampleInfoSeq * info_seq;
-  dds_UnsignedLongSeq * raw_data_sizes;
+  SampleSequencePool sample_pool;
   event_callback_data_t event_callback_data;
+  // Kept by the matched listeners of the request writer and the response reader, -1 until known
+  std::atomic<int32_t> matched_request_readers {-1};
+  std::atomic<int32_t> matched_response_writers {-1};
+  std::mutex mutex_pending_requests;
+  // Deadline in steady clock nanoseconds of every request in flight by sequence number, 0 if none
+  std::unordered_map<int64_t, int64_t> pending_requests;
+  // Requests sent while the table was full
+  size_t untracked_requests {0};
+  WriterCounters request_stats;
+  ReaderCounters response_stats;
 
   size_t count_unread()
   {
-    return rmw_gurumdds_cpp::count_unread(response_reader, data_seq, info_seq, raw_data_sizes);
+    return rmw_gurumdds_cpp::count_unread(response_reader, sample_pool);
+  }
+
+  bool is_service_available() const
+  {
+    return matched_request_readers > 0 && matched_response_writers > 0;
   }
 };
 
 struct ServiceInfo {
   const rosidl_service_type_support_t * service_typesupport;
+  // (De)serializers of service_typesupport
+  ServiceTypeSupport type_support;
   const char * implementation_identifier;
   rmw_context_impl_t * ctx;
 
@@ -62,16 +96,17 @@ struct ServiceInfo {
   dds_DataWriter * response_writer;
   dds_DataReader * request_reader;
   dds_ReadCondition * read_condition;
+  MessageBufferPool message_buffers;
 
   dds_DataReaderListener request_listener;
-  dds_DataSeq * data_seq;
-  dds_SampleInfoSeq * info_seq;
-  dds_UnsignedLongSeq * raw_data_sizes;
+  SampleSequencePool sample_pool;
   event_callback_data_t event_callback_data;
+  ReaderCounters request_stats;
+  WriterCounters response_stats;
 
   size_t count_unread()
   {
-    return rmw_gurumdds_cpp::count_unread(request_reader, data_seq, info_seq, raw_data_sizes);
+    return rmw_gurumdds_cpp::count_unread(request_reader, sample_pool);
   }
 };
 } // namespace rmw_gurumdds_cpp
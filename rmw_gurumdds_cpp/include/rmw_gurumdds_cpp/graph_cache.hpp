@@ -15,6 +15,8 @@
 #ifndef RMW_GURUMDDS__GRAPH_CACHE_HPP_
 #define RMW_GURUMDDS__GRAPH_CACHE_HPP_
 
+#include <string_view>
+
 #include "rmw/rmw.h"
 
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
@@ -35,6 +37,24 @@ publish_update(
   rmw_context_impl_t * const ctx,
   void * const msg);
 
+// Triggers the graph guard condition, at most once per graph change delay
+void
+notify_graph_change(rmw_context_impl_t * const ctx);
+
+// Publishes the discovery update and triggers the graph changes held back once their delay is
+// over. timeout is set to the time left until the next one, or to infinite if none is held back
+rmw_ret_t
+flush_deferred(rmw_context_impl_t * const ctx, dds_Duration_t & timeout);
+
+// Holds back the discovery updates of the local entities, from any thread, until the matching
+// release_updates, which publishes the latest of them as one
+rmw_ret_t
+hold_updates(rmw_context_impl_t * const ctx);
+
+rmw_ret_t
+release_updates(rmw_context_impl_t * const ctx);
+
+// The updates of the local entities below are serialized by the graph_mutex of the context
 rmw_ret_t
 on_node_created(
   rmw_context_impl_t * const ctx,
@@ -100,7 +120,7 @@ rmw_ret_t
 add_participant(
   rmw_context_impl_t * const ctx,
   const dds_GUID_t * const dp_guid,
-  const char * const enclave);
+  std::string_view enclave);
 
 rmw_ret_t
 remove_participant(
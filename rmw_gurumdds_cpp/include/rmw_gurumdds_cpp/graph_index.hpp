@@ -0,0 +1,181 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__GRAPH_INDEX_HPP_
+#define RMW_GURUMDDS__GRAPH_INDEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "rmw/names_and_types.h"
+#include "rmw/topic_endpoint_info_array.h"
+#include "rmw/types.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+#include "rosidl_runtime_c/type_hash.h"
+
+#include "rmw_gurumdds_cpp/demangle.hpp"
+#include "rmw_gurumdds_cpp/name_cache.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Immutable view of the topics of the graph at one version of the index.
+ * Shared by every query made until the next discovery change.
+ */
+struct GraphSnapshot
+{
+  uint64_t version;
+  std::map<std::string, size_t> reader_counts;
+  std::map<std::string, size_t> writer_counts;
+  // Types by DDS topic name, by ROS topic name and by ROS service name
+  std::map<std::string, std::set<std::string>> topics;
+  std::map<std::string, std::set<std::string>> ros_topics;
+  std::map<std::string, std::set<std::string>> services;
+};
+
+/**
+ * Per-node and per-topic indexes of the entities in the graph cache, kept
+ * up to date on the same discovery paths. Queries for a single node or topic
+ * visit only the entities of that node or topic, instead of every entity of
+ * the graph.
+ */
+class GraphIndex {
+public:
+  void add_entity(
+    const rmw_gid_t & gid,
+    const std::string & topic_name,
+    const std::string & type_name,
+    const rosidl_type_hash_t & type_hash,
+    const rmw_qos_profile_t & qos,
+    bool is_reader);
+
+  void remove_entity(const rmw_gid_t & gid, bool is_reader);
+
+  // Replaces the nodes of a remote participant by the ones of its announcement
+  void update_participant(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg);
+
+  void remove_participant(const rmw_gid_t & participant_gid);
+
+  void add_node(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_name,
+    const std::string & node_namespace);
+
+  void remove_node(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_name,
+    const std::string & node_namespace);
+
+  void associate_entity(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_name,
+    const std::string & node_namespace,
+    const rmw_gid_t & gid,
+    bool is_reader);
+
+  void dissociate_entity(const rmw_gid_t & gid);
+
+  rmw_ret_t get_names_and_types_by_node(
+    const std::string & node_name,
+    const std::string & node_namespace,
+    DemangleFunction demangle_topic,
+    DemangleFunction demangle_type,
+    bool is_reader,
+    NameCache & names,
+    rcutils_allocator_t * allocator,
+    rmw_names_and_types_t * topic_names_and_types) const;
+
+  rmw_ret_t get_entities_info_by_topic(
+    const std::string & topic_name,
+    DemangleFunction demangle_type,
+    bool is_reader,
+    NameCache & names,
+    rcutils_allocator_t * allocator,
+    rmw_topic_endpoint_info_array_t * endpoints_info) const;
+
+  // Returns the snapshot of the current version without locking, once it was built.
+  // The first query after a discovery change builds it under the index lock
+  std::shared_ptr<const GraphSnapshot> get_snapshot() const;
+
+  uint64_t get_version() const;
+
+private:
+  using GidSet = std::set<rmw_gid_t, rmw_dds_common::Compare_rmw_gid_t>;
+  using NodeKey = std::pair<std::string, std::string>;
+
+  struct EntityEntry
+  {
+    std::string topic_name;
+    std::string type_name;
+    rosidl_type_hash_t type_hash;
+    rmw_qos_profile_t qos;
+  };
+
+  struct NodeEntry
+  {
+    rmw_gid_t participant_gid;
+    GidSet readers;
+    GidSet writers;
+  };
+
+  // Nodes by namespace and name. Names are unique only within a participant
+  using NodeMap = std::multimap<NodeKey, NodeEntry>;
+
+  NodeMap::iterator find_node_unsafe(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_name,
+    const std::string & node_namespace);
+
+  NodeMap::iterator add_node_unsafe(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_name,
+    const std::string & node_namespace);
+
+  void remove_node_unsafe(NodeMap::iterator node);
+
+  void associate_entity_unsafe(NodeMap::iterator node, const rmw_gid_t & gid, bool is_reader);
+
+  std::shared_ptr<const GraphSnapshot> build_snapshot_unsafe(uint64_t version) const;
+
+  mutable std::mutex mutex_;
+  // Bumped under mutex_ by every change of the topics
+  std::atomic<uint64_t> version_ {1};
+  // Accessed with std::atomic_load and std::atomic_store
+  mutable std::shared_ptr<const GraphSnapshot> snapshot_;
+  std::map<rmw_gid_t, EntityEntry, rmw_dds_common::Compare_rmw_gid_t> readers_;
+  std::map<rmw_gid_t, EntityEntry, rmw_dds_common::Compare_rmw_gid_t> writers_;
+  std::map<std::string, GidSet> topic_readers_;
+  std::map<std::string, GidSet> topic_writers_;
+  NodeMap nodes_;
+  // Node of each endpoint associated to one, whether or not the endpoint was discovered yet
+  std::map<rmw_gid_t, NodeMap::iterator, rmw_dds_common::Compare_rmw_gid_t> entity_nodes_;
+  std::map<rmw_gid_t, std::vector<NodeMap::iterator>, rmw_dds_common::Compare_rmw_gid_t>
+  participant_nodes_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__GRAPH_INDEX_HPP_
@@ -0,0 +1,36 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__GUARD_CONDITION_HPP_
+#define RMW_GURUMDDS__GUARD_CONDITION_HPP_
+
+#include <atomic>
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Data of an rmw guard condition
+struct GuardCondition
+{
+  dds_GuardCondition * condition;
+  // Set by the first trigger after a wait cleared the trigger value, later triggers skip DDS
+  std::atomic_bool triggered {false};
+};
+
+// Clears the trigger value of a guard condition returned as active by a wait
+dds_ReturnCode_t clear_guard_condition(GuardCondition * guard_condition);
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__GUARD_CONDITION_HPP_
@@ -0,0 +1,163 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__INTRA_CONTEXT_HPP_
+#define RMW_GURUMDDS__INTRA_CONTEXT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+struct PublisherInfo;
+struct SubscriberInfo;
+
+// A sample a publisher hands to the subscriptions of its context without writing it to DDS
+struct LocalSample
+{
+  // Serialized sample with its encapsulation header, shared by the subscriptions it is handed to
+  std::shared_ptr<const MessageBuffer> buffer;
+  size_t size;
+  int64_t sequence_number;
+  int64_t source_timestamp;
+  int64_t received_timestamp;
+  rmw_gid_t publisher_gid;
+};
+
+// A reader the writer of a publisher is matched with
+struct LocalReader
+{
+  rmw_gid_t gid;
+  // Sequence number of the last sample written to DDS when the reader matched, the reader
+  // gets none of the samples up to it
+  int64_t dds_floor;
+  // Subscription of the context the reader belongs to, nullptr if there is none
+  SubscriberInfo * subscription;
+};
+
+/**
+ * Samples handed to a subscription by the publishers of its context. A KEEP_LAST
+ * queue drops its oldest sample at the history depth, like the DDS reader would.
+ * The guard condition is triggered while the queue is not empty, so that wait
+ * sets wake up for it next to the read condition of the reader.
+ *
+ * The queue is taken from before the reader. A publisher that writes to DDS
+ * again marks the queues it handed samples to as mixed: until they are empty,
+ * their samples and the newer ones it wrote to the reader share the history
+ * depth, counted as they are written rather than looked up in the reader.
+ */
+class LocalSampleQueue {
+public:
+  LocalSampleQueue() = default;
+
+  ~LocalSampleQueue();
+
+  LocalSampleQueue(const LocalSampleQueue &) = delete;
+
+  LocalSampleQueue & operator=(const LocalSampleQueue &) = delete;
+
+  // `depth` of 0 keeps every sample. False on failure
+  bool init(size_t depth);
+
+  dds_GuardCondition * get_condition() const;
+
+  void push(const LocalSample & sample);
+
+  // Drops the oldest samples of a mixed queue that do not fit in the depth next to the newer
+  // samples of the reader, then pops the oldest one
+  bool pop(LocalSample & sample);
+
+  size_t size();
+
+  void set_mixed();
+
+  // Counts a sample written to DDS by a publisher that marked the queue as mixed
+  void on_dds_sample();
+
+private:
+  std::mutex mutex_;
+  std::deque<LocalSample> samples_;
+  size_t depth_ {0};
+  dds_GuardCondition * condition_ {nullptr};
+  std::atomic_bool mixed_ {false};
+  // Samples written to DDS since the queue was mixed, which the reader holds after its samples
+  size_t newer_ {0};
+};
+
+/**
+ * Subscriptions of a context that its publishers can hand samples to directly.
+ * A publisher skips the DDS write only while every reader its writer is matched
+ * with belongs to one of them; as soon as another reader matches, samples go
+ * through DDS again, so that no reader gets a sample twice.
+ *
+ * Each publisher keeps the readers its writer is matched with, updated by its
+ * matched listener and by the additions and removals of subscriptions, so that
+ * a publish only takes the lock of its publisher.
+ *
+ * Each writer keeps its order in a subscription that it switches paths for:
+ * samples still in the local queue are taken before the newer ones of the
+ * reader, and a writer only goes back to local delivery once every
+ * subscription took the last sample it wrote to DDS.
+ */
+class IntraContextDelivery {
+public:
+  void add_subscription(SubscriberInfo * subscriber_info);
+
+  // Waits for the deliveries still notifying the subscription
+  void remove_subscription(SubscriberInfo * subscriber_info);
+
+  // Looks up the matched readers, once the listener of the writer is set
+  void add_publisher(PublisherInfo * publisher_info);
+
+  // Drops the writer of a publisher that is going away from the sequence numbers the
+  // subscriptions keep
+  void remove_publisher(PublisherInfo * publisher_info);
+
+  // Called by the matched listener of the writer. The readers are looked up without the locks
+  void on_publication_matched(PublisherInfo * publisher_info);
+
+  // True if the sample of the publisher is to be handed over, `generation` is passed to deliver.
+  // Every publish of a publisher with local delivery asks, the DDS path included
+  bool is_local_only(PublisherInfo * publisher_info, uint64_t & generation);
+
+  // Numbers and hands over the sample, then notifies the subscriptions without the locks.
+  // False if the readers changed or a sample was written to DDS since is_local_only, the
+  // sample is written to DDS then
+  bool deliver(PublisherInfo * publisher_info, uint64_t generation, LocalSample & sample);
+
+  // Numbers a sample of the publisher that is written to DDS, in the same order as the
+  // samples handed over
+  int64_t number_dds_sample(PublisherInfo * publisher_info);
+
+private:
+  // Resolves the readers of the publisher to the subscriptions, mutex_ and mutex_local held
+  void refresh_readers_unsafe(PublisherInfo * publisher_info);
+
+  std::mutex mutex_;
+  std::vector<SubscriberInfo *> subscriptions_;
+  std::vector<PublisherInfo *> publishers_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__INTRA_CONTEXT_HPP_
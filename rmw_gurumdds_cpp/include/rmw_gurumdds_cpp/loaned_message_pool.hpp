@@ -0,0 +1,82 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__LOANED_MESSAGE_POOL_HPP_
+#define RMW_GURUMDDS__LOANED_MESSAGE_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/buffer_memory.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+
+#define LOANED_MESSAGE_POOL_SIZE 2
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Preallocated sample buffers for loaning messages of a plain type. A loaned
+ * message is placed right after the encapsulation header in its buffer, so
+ * that the buffer is written to the data writer without serialization.
+ */
+class LoanedMessagePool {
+public:
+  LoanedMessagePool() = default;
+
+  ~LoanedMessagePool();
+
+  LoanedMessagePool(const LoanedMessagePool &) = delete;
+
+  LoanedMessagePool & operator=(const LoanedMessagePool &) = delete;
+
+  // True if messages of the plan are laid out in memory as they are serialized
+  static bool can_loan(const MessagePlan * plan);
+
+  // Preallocates `count` buffers of a BUFFER_MEMORY_* kind, more are allocated when all of
+  // them are loaned
+  bool init(const MessagePlan * plan, size_t count, int memory = BUFFER_MEMORY_HEAP);
+
+  // Preallocates buffers until the pool has `count`. False on allocation failure
+  bool reserve(size_t count);
+
+  bool is_enabled() const;
+
+  // Returns an initialized message, or nullptr on allocation failure
+  void * borrow();
+
+  // Returns the serialized sample of a loaned message, or nullptr if the message is not loaned
+  void * get_dds_message(void * ros_message, size_t * size);
+
+  // Finalizes a loaned message and takes its buffer back. False if the message is not loaned
+  bool release(void * ros_message);
+
+private:
+  uint8_t * allocate();
+
+  std::mutex mutex_;
+  const MessagePlan * plan_ {nullptr};
+  int memory_ {BUFFER_MEMORY_HEAP};
+  size_t buffer_size_ {0};
+  size_t allocated_size_ {0};
+  std::vector<uint8_t *> buffers_;
+  std::vector<uint8_t *> free_buffers_;
+  std::unordered_set<void *> loaned_messages_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__LOANED_MESSAGE_POOL_HPP_
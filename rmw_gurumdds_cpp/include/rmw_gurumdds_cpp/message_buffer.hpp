@@ -0,0 +1,124 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__MESSAGE_BUFFER_HPP_
+#define RMW_GURUMDDS__MESSAGE_BUFFER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/buffer_memory.hpp"
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Growable byte buffer owned by an endpoint and reused across writes,
+ * so that steady-state publishing does not allocate.
+ */
+class MessageBuffer: public CdrGrowableStorage {
+public:
+  // `memory` is a BUFFER_MEMORY_* kind, see buffer_memory.hpp
+  explicit MessageBuffer(int memory = BUFFER_MEMORY_HEAP);
+
+  ~MessageBuffer() override;
+
+  MessageBuffer(const MessageBuffer &) = delete;
+
+  MessageBuffer & operator=(const MessageBuffer &) = delete;
+
+  uint8_t * grow(size_t size) override;
+
+  uint8_t * data() const override;
+
+  size_t capacity() const override;
+
+private:
+  int memory_;
+  uint8_t * data_ {nullptr};
+  size_t capacity_ {0};
+};
+
+/**
+ * Message buffers of an endpoint. A write takes a free buffer and returns it
+ * once written, so writes from several threads each reuse a grown buffer
+ * instead of serializing into a freshly allocated one.
+ */
+class MessageBufferPool {
+public:
+  MessageBufferPool() = default;
+
+  ~MessageBufferPool();
+
+  MessageBufferPool(const MessageBufferPool &) = delete;
+
+  MessageBufferPool & operator=(const MessageBufferPool &) = delete;
+
+  // Returns a free buffer, creating one when all are in use. nullptr on allocation failure
+  MessageBuffer * acquire();
+
+  void release(MessageBuffer * buffer);
+
+  // Memory kind of the buffers created from now on
+  void set_memory(int memory);
+
+  // Creates free buffers until the pool has `count` and grows the free ones to `size`, so that
+  // writes do not allocate nor fault in pages. False on allocation failure
+  bool reserve(size_t count, size_t size);
+
+private:
+  std::mutex mutex_;
+  int memory_ {BUFFER_MEMORY_HEAP};
+  std::vector<MessageBuffer *> free_buffers_;
+  size_t buffer_count_ {0};
+};
+
+/**
+ * Message buffers of a publisher that are shared by the subscriptions it hands samples to.
+ * A buffer and the control block of its shared_ptr go back to the pool when the last
+ * subscription drops the sample, so that handing samples over does not allocate once the
+ * pool holds as many buffers as there are samples queued. The buffers keep the pool alive.
+ */
+class SharedMessageBufferPool {
+public:
+  SharedMessageBufferPool();
+
+  SharedMessageBufferPool(const SharedMessageBufferPool &) = delete;
+
+  SharedMessageBufferPool & operator=(const SharedMessageBufferPool &) = delete;
+
+  // Returns a free buffer, creating one when all are in use. nullptr on allocation failure
+  std::shared_ptr<MessageBuffer> acquire();
+
+  // Memory kind of the buffers created from now on
+  void set_memory(int memory);
+
+  // Creates free buffers until `count` can be in use at once and grows them to `size`.
+  // False on allocation failure
+  bool reserve(size_t count, size_t size);
+
+private:
+  struct State;
+  struct Releaser;
+  template<typename T>
+  struct BlockAllocator;
+
+  std::shared_ptr<State> state_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__MESSAGE_BUFFER_HPP_
@@ -62,6 +62,27 @@ RMW_GURUMDDS_SEQ_HELPER(uint8_t, 8);
 RMW_GURUMDDS_SEQ_HELPER(uint16_t, 16);
 RMW_GURUMDDS_SEQ_HELPER(uint32_t, 32);
 RMW_GURUMDDS_SEQ_HELPER(uint64_t, 64);
+
+// Layout shared by the rosidl C sequences of every element type
+struct rmw_seq_header_t
+{
+  void * data;
+  size_t size;
+  size_t capacity;
+};
+
+// Sets the size of a C sequence whose buffer is big enough, false if it has to be allocated.
+// The elements past the size stay initialized and are finalized along with the sequence
+template<typename SequenceT>
+inline bool reuse_sequence(SequenceT * seq, size_t size)
+{
+  if (seq->data == nullptr || size > seq->capacity) {
+    return false;
+  }
+
+  seq->size = size;
+  return true;
+}
 } // namespace rmw_gurumdds_cpp
 
 #include "rmw_gurumdds_cpp/message_serializer.hpp"
@@ -78,49 +78,35 @@ inline void MessageDeserializer<MessageMembersT>::read_boolean(const MessageMemb
       buffer_ >> size;
       if constexpr (LANGUAGE_KIND == LanguageKind::C) {
         auto seq_ptr = (reinterpret_cast<rosidl_runtime_c__boolean__Sequence *>(output + member->offset_));
-        if (seq_ptr->data) {
-          rosidl_runtime_c__boolean__Sequence__fini(seq_ptr);
-        }
+        if (!reuse_sequence(seq_ptr, size)) {
+          if (seq_ptr->data) {
+            rosidl_runtime_c__boolean__Sequence__fini(seq_ptr);
+          }
 
-        bool res = rosidl_runtime_c__boolean__Sequence__init(seq_ptr, size);
-        if (!res) {
-          throw std::runtime_error("Failed to initialize sequence");
+          bool res = rosidl_runtime_c__boolean__Sequence__init(seq_ptr, size);
+          if (!res) {
+            throw std::runtime_error("Failed to initialize sequence");
+          }
         }
 
-        for (uint32_t i = 0; i < size; i++) {
-          uint8_t data = 0;
-          buffer_ >> data;
-          seq_ptr->data[i] = (data != 0);
-        }
+        buffer_.copy_bool_arr(seq_ptr->data, size);
       }
 
       if constexpr (LANGUAGE_KIND == LanguageKind::CXX) {
         auto vec = reinterpret_cast<std::vector<bool> *>(output + member->offset_);
-        vec->resize(static_cast<size_t>(size));
-        for (uint32_t i = 0; i < size; i++) {
-          uint8_t data = 0;
-          buffer_ >> data;
-          vec->at(i) = static_cast<bool>(data != 0);
-        }
+        buffer_.copy_bool_vector(*vec, size);
       }
     } else {
       // Array
       if constexpr (LANGUAGE_KIND == LanguageKind::C) {
-        auto arr = reinterpret_cast<bool *>(output + member->offset_);
-        for (uint32_t i = 0; i < member->array_size_; i++) {
-          uint8_t data = 0;
-          buffer_ >> data;
-          arr[i] = (data != 0);
-        }
+        buffer_.copy_bool_arr(
+          reinterpret_cast<bool *>(output + member->offset_), member->array_size_);
       }
 
       if constexpr (LANGUAGE_KIND == LanguageKind::CXX) {
-        for (uint32_t i = 0; i < member->array_size_; i++) {
-          uint8_t data = 0;
-          buffer_ >> data;
-          *(reinterpret_cast<bool *>(member->get_function(output + member->offset_, i))) =
-            static_cast<bool>(data != 0);
-        }
+        buffer_.copy_bool_arr(
+          reinterpret_cast<bool *>(member->get_function(output + member->offset_, 0)),
+          member->array_size_);
       }
     }
   } else {
@@ -145,13 +131,15 @@ inline void MessageDeserializer<MessageMembersT>::read_wchar(const MessageMember
       uint32_t size = 0;
       buffer_ >> size;
       auto seq_ptr = reinterpret_cast<rosidl_runtime_c__wchar__Sequence *>(output + member->offset_);
-      if (seq_ptr->data) {
-        rosidl_runtime_c__wchar__Sequence__fini(seq_ptr);
-      }
+      if (!reuse_sequence(seq_ptr, size)) {
+        if (seq_ptr->data) {
+          rosidl_runtime_c__wchar__Sequence__fini(seq_ptr);
+        }
 
-      bool res = rosidl_runtime_c__wchar__Sequence__init(seq_ptr, size);
-      if (!res) {
-        throw std::runtime_error("Failed to initialize sequence");
+        bool res = rosidl_runtime_c__wchar__Sequence__init(seq_ptr, size);
+        if (!res) {
+          throw std::runtime_error("Failed to initialize sequence");
+        }
       }
 
       for (uint32_t i = 0; i < size; i++) {
@@ -195,12 +183,14 @@ inline void MessageDeserializer<MessageMembersT>::read_string(const MessageMembe
 
         auto seq_ptr =
           (reinterpret_cast<rosidl_runtime_c__String__Sequence *>(output + member->offset_));
-        if (seq_ptr->data) {
-          rosidl_runtime_c__String__Sequence__fini(seq_ptr);
-        }
-        bool res = rosidl_runtime_c__String__Sequence__init(seq_ptr, size);
-        if (!res) {
-          throw std::runtime_error("Failed to initialize sequence");
+        if (!reuse_sequence(seq_ptr, size)) {
+          if (seq_ptr->data) {
+            rosidl_runtime_c__String__Sequence__fini(seq_ptr);
+          }
+          bool res = rosidl_runtime_c__String__Sequence__init(seq_ptr, size);
+          if (!res) {
+            throw std::runtime_error("Failed to initialize sequence");
+          }
         }
 
         for (uint32_t i = 0; i < size; i++) {
@@ -266,13 +256,15 @@ inline void MessageDeserializer<MessageMembersT>::read_primitive(const MessageMe
     if (!member->array_size_ || member->is_upper_bound_) {
       buffer_ >> size;
       auto seq_ptr = reinterpret_cast<rmw_gurumdds_cpp::rmw_seq_t<PrimitiveT>*>(output + member->offset_);
-      if(nullptr != seq_ptr->data) {
-        seq_ptr->fini();
-      }
+      if (!reuse_sequence(seq_ptr, size)) {
+        if(nullptr != seq_ptr->data) {
+          seq_ptr->fini();
+        }
 
-      bool res = seq_ptr->init(size);
-      if (!res) {
-        throw std::runtime_error("Failed to initialize sequence");
+        bool res = seq_ptr->init(size);
+        if (!res) {
+          throw std::runtime_error("Failed to initialize sequence");
+        }
       }
 
       arr = seq_ptr->data;
@@ -308,12 +300,14 @@ inline void MessageDeserializer<MessageMembersT>::read_wstring(const MessageMemb
         auto seq_ptr =
           (reinterpret_cast<rosidl_runtime_c__U16String__Sequence *>(
             output + member->offset_));
-        if (seq_ptr->data) {
-          rosidl_runtime_c__U16String__Sequence__fini(seq_ptr);
-        }
-        bool res = rosidl_runtime_c__U16String__Sequence__init(seq_ptr, size);
-        if (!res) {
-          throw std::runtime_error("Failed to initialize sequence");
+        if (!reuse_sequence(seq_ptr, size)) {
+          if (seq_ptr->data) {
+            rosidl_runtime_c__U16String__Sequence__fini(seq_ptr);
+          }
+          bool res = rosidl_runtime_c__U16String__Sequence__init(seq_ptr, size);
+          if (!res) {
+            throw std::runtime_error("Failed to initialize sequence");
+          }
         }
 
         for (uint32_t i = 0; i < size; i++) {
@@ -373,7 +367,14 @@ inline void MessageDeserializer<MessageMembersT>::read_struct_arr(const MessageM
     if (!member->array_size_ || member->is_upper_bound_) {
       // Sequence
       buffer_ >> size;
-      member->resize_function(output + member->offset_, static_cast<size_t>(size));
+      void * seq = output + member->offset_;
+      if constexpr (LANGUAGE_KIND == LanguageKind::C) {
+        if (!reuse_sequence(reinterpret_cast<rmw_seq_header_t *>(seq), size)) {
+          member->resize_function(seq, static_cast<size_t>(size));
+        }
+      } else {
+        member->resize_function(seq, static_cast<size_t>(size));
+      }
     }
 
     size = member->size_function(output + member->offset_);
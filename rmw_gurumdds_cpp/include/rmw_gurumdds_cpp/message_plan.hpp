@@ -0,0 +1,147 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__MESSAGE_PLAN_HPP_
+#define RMW_GURUMDDS__MESSAGE_PLAN_HPP_
+
+#if defined(_MSC_VER)
+#include <BaseTsd.h>
+typedef SSIZE_T ssize_t;
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+class MessagePlan;
+
+struct MessagePlanOp
+{
+  using SerializeFn = void (*)(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrSerializationBuffer<true> & buffer, const uint8_t * input);
+  using SizeFn = void (*)(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrSerializationBuffer<false> & buffer, const uint8_t * input);
+  using DeserializeFn = void (*)(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output);
+
+  SerializeFn serialize;
+  SizeFn get_size;
+  DeserializeFn deserialize;
+
+  // Offset from the start of the outermost struct the op list was compiled for
+  uint32_t offset;
+  // Element count of a fixed size array
+  uint32_t array_size;
+  // Size of a single element in memory, or the byte length of a copy run
+  uint32_t element_size;
+  // Non-zero when the op is a naturally aligned block whose memory layout matches CDR
+  uint32_t alignment;
+  // Introspection member, for sequence accessors
+  const void * member;
+  // Element op range of a struct array or sequence, or the ops a copy run replaces
+  uint32_t first;
+  uint32_t last;
+};
+
+/**
+ * Flat list of serialization ops compiled once from a message's introspection
+ * members. Nested structs are inlined; struct arrays and sequences refer to
+ * the op range of their element type. Contiguous primitive members are
+ * coalesced into runs copied with a single memcpy.
+ */
+class MessagePlan {
+public:
+  // Returns the cached plan of the type support, compiling it on first use
+  static const MessagePlan * get(const rosidl_message_type_support_t * type_support);
+
+  const rosidl_message_type_support_t * get_type_support() const;
+
+  size_t get_message_size() const;
+
+  // True if the whole message is serialized by a single copy
+  bool is_plain() const;
+
+  // True if the serialized size of the message has an upper bound
+  bool is_bounded() const;
+
+  // Upper bound of the serialized size, including the encapsulation header. 0 if unbounded
+  size_t get_max_serialized_size() const;
+
+  // Serialized size of a plain message, without the encapsulation header and final padding
+  size_t get_plain_size() const;
+
+  // Largest member alignment of a plain message
+  size_t get_plain_alignment() const;
+
+  // Initializes a message in place to its default values
+  void init_message(void * ros_message) const;
+
+  void fini_message(void * ros_message) const;
+
+  const MessagePlanOp & get_op(uint32_t index) const;
+
+  ssize_t get_serialized_size(const void * ros_message) const;
+
+  bool serialize(const void * ros_message, void * dds_message, size_t size) const;
+
+  bool serialize(const void * ros_message, CdrGrowableStorage & dds_message, size_t * size) const;
+
+  // With an arena the message must be zeroed C memory, its strings and sequences are allocated
+  // from the arena
+  bool deserialize(
+    void * ros_message, void * dds_message, size_t size,
+    DeserializationArena * arena = nullptr) const;
+
+  template<bool SERIALIZE>
+  void run(
+    uint32_t first,
+    uint32_t last,
+    CdrSerializationBuffer<SERIALIZE> & buffer,
+    const uint8_t * input) const;
+
+  void run(uint32_t first, uint32_t last, CdrDeserializationBuffer & buffer, uint8_t * output) const;
+
+private:
+  explicit MessagePlan(const rosidl_message_type_support_t * type_support);
+
+  template<typename MessageMembersT>
+  bool compile();
+
+  template<typename MessageMembersT>
+  bool compile_struct(
+    const MessageMembersT * members,
+    uint32_t base_offset,
+    std::vector<std::pair<size_t, const MessageMembersT *>> & pending);
+
+  void coalesce(std::vector<std::pair<uint32_t, uint32_t>> lists);
+
+  const rosidl_message_type_support_t * type_support_;
+  size_t message_size_ {0};
+  size_t max_serialized_size_ {0};
+  std::vector<MessagePlanOp> ops_;
+  uint32_t root_last_ {0};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__MESSAGE_PLAN_HPP_
@@ -88,36 +88,27 @@ inline void MessageSerializer<SERIALIZE, MessageMembersT>::serialize_boolean(
         auto seq =
           *(reinterpret_cast<const rosidl_runtime_c__boolean__Sequence *>(input + member->offset_));
         buffer << static_cast<uint32_t>(seq.size);
-
-        for (uint32_t i = 0; i < seq.size; i++) {
-          buffer << static_cast<uint8_t>(seq.data[i] == true);
-        }
+        buffer.copy_bool_arr(seq.data, seq.size);
       } else {
         // Array
-        for (uint32_t i = 0; i < member->array_size_; i++) {
-          buffer << static_cast<uint8_t>(
-            (reinterpret_cast<const bool *>(input + member->offset_))[i] == true);
-        }
+        buffer.copy_bool_arr(
+          reinterpret_cast<const bool *>(input + member->offset_), member->array_size_);
       }
     }
 
     if constexpr (LANGUAGE_KIND == LanguageKind::CXX) {
       if (!member->array_size_ || member->is_upper_bound_) {
         // Sequence
-        auto vec =
+        auto & vec =
           *(reinterpret_cast<const std::vector<bool> *>(input + member->offset_));
         buffer << static_cast<uint32_t>(vec.size());
-        for (const auto & i : vec) {
-          buffer << static_cast<uint8_t>(i == true);
-        }
+        buffer.copy_bool_vector(vec);
       } else {
         // Array
         const uint32_t size = member->size_function(input + member->offset_);
-        for (uint32_t i = 0; i < size; i++) {
-          buffer <<
-            *(reinterpret_cast<const uint8_t *>(
-              member->get_const_function(input + member->offset_, i)));
-        }
+        buffer.copy_bool_arr(
+          reinterpret_cast<const bool *>(member->get_const_function(input + member->offset_, 0)),
+          size);
       }
     }
   } else {
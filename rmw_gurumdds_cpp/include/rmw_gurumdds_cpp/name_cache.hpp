@@ -0,0 +1,67 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__NAME_CACHE_HPP_
+#define RMW_GURUMDDS__NAME_CACHE_HPP_
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "rmw_gurumdds_cpp/demangle.hpp"
+
+#define NAME_CACHE_MAX_ENTRIES 16384
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Interned results of the mangle and demangle helpers, looked up without
+ * allocating. Entries are never removed, so the returned references stay
+ * valid for the lifetime of the cache. Once NAME_CACHE_MAX_ENTRIES names are
+ * interned, further results are computed into the storage of the caller.
+ */
+class NameCache {
+public:
+  // Name of a ROS topic or service with its DDS prefix, like create_topic_name
+  const std::string & mangle(const char * prefix, const char * name, std::string & storage);
+
+  // Result of a demangle helper for a name
+  const std::string & demangle(
+    DemangleFunction demangle_fn,
+    const std::string & name,
+    std::string & storage);
+
+private:
+  struct Entry
+  {
+    std::string key;
+    std::string value;
+  };
+
+  // Interns results of the same mangle prefix or demangle helper
+  using Table = std::unordered_map<std::string_view, const Entry *>;
+
+  const Entry & insert_unsafe(Table & table, std::string && key, std::string && value);
+
+  std::mutex mutex_;
+  std::unordered_map<const void *, Table> tables_;
+  std::deque<Entry> entries_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__NAME_CACHE_HPP_
@@ -25,6 +25,9 @@ extern const char * const ros_service_requester_prefix;
 extern const char * const ros_service_response_prefix;
 extern const std::vector<std::string> ros_prefixes;
 
+/// Returns true if `name` starts with `prefix` followed by a '/'.
+bool has_prefix(const std::string & name, const std::string & prefix);
+
 /// Returns `name` stripped of `prefix` if exists, if not return "".
 std::string resolve_prefix(const std::string & name, const std::string & prefix);
 
@@ -0,0 +1,84 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__NETWORK_FLOW_HPP_
+#define RMW_GURUMDDS__NETWORK_FLOW_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rcutils/allocator.h"
+#include "rmw/network_flow_endpoint_array.h"
+#include "rmw/ret_types.h"
+
+// Port mapping of the RTPS specification, the user traffic unicast port of a participant is
+// PB + DG * domain_id + D3 + PG * participant_id
+#define RTPS_PORT_BASE 7400
+#define RTPS_DOMAIN_ID_GAIN 250
+#define RTPS_PARTICIPANT_ID_GAIN 2
+#define RTPS_USER_UNICAST_OFFSET 11
+
+// Largest value of the 6-bit DSCP field
+#define NETWORK_FLOW_DSCP_MAX 63
+
+namespace rmw_gurumdds_cpp
+{
+struct NetworkFlowLocator
+{
+  bool ipv6;
+  std::string address;
+  uint16_t port;
+};
+
+/**
+ * UDP sockets of the process, taken before a participant is created. GurumDDS
+ * does not report the locators of a participant, they are found as the user
+ * traffic sockets bound since the snapshot. Participant creations are
+ * serialized while a snapshot is alive. Empty on systems without /proc.
+ */
+class UdpSocketSnapshot
+{
+public:
+  UdpSocketSnapshot();
+
+  // Unicast locators of the user traffic bound since the snapshot. A socket bound to any
+  // address is listed once per address of the up interfaces of its family
+  std::vector<NetworkFlowLocator> get_user_locators(uint32_t domain_id, bool localhost_only) const;
+
+  struct Socket
+  {
+    bool ipv6;
+    uint8_t address[16];
+    uint16_t port;
+    uint64_t inode;
+  };
+
+private:
+  std::unique_lock<std::mutex> lock_;
+  std::vector<Socket> sockets_;
+};
+
+// Fills an array of UDP flows, one per locator, zero initialized on entry
+rmw_ret_t
+fill_network_flow_endpoints(
+  const std::vector<NetworkFlowLocator> & locators,
+  uint8_t dscp,
+  rcutils_allocator_t * allocator,
+  rmw_network_flow_endpoint_array_t * network_flow_endpoint_array);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__NETWORK_FLOW_HPP_
@@ -35,6 +35,9 @@ dds_duration_to_rmw(const dds_Duration_t & duration);
 int64_t
 dds_time_to_i64(const dds_Time_t & t);
 
+dds_Time_t
+i64_to_dds_time(int64_t t);
+
 bool
 get_datawriter_qos(dds_Publisher * publisher,
   const rmw_qos_profile_t * qos_profile,
@@ -48,6 +51,10 @@ get_datareader_qos(
   const rosidl_type_hash_t & type_hash,
   dds_DataReaderQos * datareader_qos);
 
+// Appends "key=value;" to the user data of an endpoint, false if it does not fit
+bool
+append_user_data(dds_UserDataQosPolicy * user_data, const char * key, const char * value);
+
 rmw_qos_history_policy_t
 convert_history(const dds_HistoryQosPolicy * const policy);
 
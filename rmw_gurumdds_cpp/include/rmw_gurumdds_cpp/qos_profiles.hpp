@@ -0,0 +1,218 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__QOS_PROFILES_HPP_
+#define RMW_GURUMDDS__QOS_PROFILES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+
+// GurumDDS properties of the large sample path, applied to every writer of the participant
+#define RTPS_FRAGMENT_SIZE_PROPERTY "rtps.fragment_size"
+#define RTPS_SEND_WINDOW_PROPERTY "rtps.writer.send_window"
+#define RTPS_BANDWIDTH_LIMIT_PROPERTY "rtps.writer.bandwidth_limit"
+#define RTPS_NACK_RESPONSE_DELAY_PROPERTY "rtps.writer.nack_response_delay_us"
+
+// Fragments carry the sample in UDP datagrams, with room left for the RTPS headers
+#define RTPS_FRAGMENT_SIZE_MIN 1024
+#define RTPS_FRAGMENT_SIZE_MAX 65000
+
+// GurumDDS property of the locators the user traffic of each topic is sent to, a comma-separated
+// list of `<DDS topic pattern>=<unicast|multicast|auto:<readers>>` entries, later ones winning
+#define RTPS_LOCATOR_POLICY_PROPERTY "rtps.locator.topic_policy"
+
+// Locators of the samples of a topic
+#define LOCATOR_POLICY_DEFAULT 0
+#define LOCATOR_POLICY_UNICAST 1
+#define LOCATOR_POLICY_MULTICAST 2
+// Unicast until the writer matches multicast_min_readers readers
+#define LOCATOR_POLICY_AUTO 3
+
+// Sender threads of the asynchronous writers, a writer of a higher lane is never queued behind
+// the samples of a lower one
+#define FLOW_PRIORITY_LANES 3
+// Queue of a writer with a flow controller that does not set async_publish.queue_depth
+#define FLOW_CONTROLLER_QUEUE_DEPTH 64
+// Burst of a bandwidth-limited writer that does not set one, in microseconds of its bandwidth
+#define FLOW_CONTROLLER_BURST_US 10000
+
+namespace rmw_gurumdds_cpp
+{
+// Queue of a writer whose samples are written by the sender thread, 0 to write on publish
+struct AsyncPublishSettings
+{
+  size_t queue_depth {0};
+  // Publishing waits for room in a full queue instead of dropping the sample
+  bool block_when_full {false};
+  // Sender lane, from 0 to FLOW_PRIORITY_LANES - 1
+  int priority {0};
+  // Token bucket of the writer, 0 for no bandwidth limit
+  uint64_t bytes_per_second {0};
+  size_t burst_bytes {0};
+
+  bool enabled() const
+  {
+    return queue_depth > 0;
+  }
+};
+
+// Writer payloads compressed from threshold_bytes on, 0 to write them as they are
+struct CompressionSettings
+{
+  size_t threshold_bytes {0};
+  // LZ4 acceleration, higher values compress faster and less
+  int acceleration {1};
+
+  bool enabled() const
+  {
+    return threshold_bytes > 0;
+  }
+};
+
+// Locators the samples of a topic are sent to, one of LOCATOR_POLICY_*
+struct LocatorSettings
+{
+  int policy {LOCATOR_POLICY_DEFAULT};
+  size_t multicast_min_readers {0};
+};
+
+// "default", "unicast", "multicast" or "auto"
+const char * get_locator_policy_name(int policy);
+
+/**
+ * DDS policies the ROS QoS profile does not cover, set per topic from a file.
+ * Sections start with `[topic <pattern>]`, `[writer <pattern>]` or
+ * `[reader <pattern>]`, where `*` and `?` in the pattern match any characters
+ * of the ROS topic name. Their `key = value` lines override the policies of the
+ * endpoints created on matching topics, later sections winning:
+ *
+ *   history.depth, resource_limits.max_samples, resource_limits.max_instances,
+ *   resource_limits.max_samples_per_instance, latency_budget.duration_us,
+ *   reliability.max_blocking_time_us (writers), transport_priority.value (writers),
+ *   time_based_filter.minimum_separation_us (readers)
+ *
+ * Readers with a minimum separation are handed at most one sample per instance
+ * in each separation period, the others are dropped before they reach the
+ * reader history. The separation must not exceed the deadline period.
+ *
+ * There are no batching settings: GurumDDS has no batch API, and samples held
+ * back by the RMW would still be written one by one.
+ *
+ * Writers with async_publish.queue_depth hand their samples to a sender thread,
+ * async_publish.block_when_full = 1 making a full queue block the publish
+ * instead of dropping the sample, see async_publish.hpp.
+ * Writers with flow_controller.priority or flow_controller.bytes_per_second
+ * publish asynchronously too: the priority picks the sender thread of the
+ * writer, from 0 to FLOW_PRIORITY_LANES - 1, and the bandwidth is enforced by
+ * a token bucket of flow_controller.burst_bytes.
+ * Writers with compression.threshold_bytes compress the larger payloads, with
+ * the LZ4 compression.acceleration, see compression.hpp. Readers with
+ * latency_stats.enabled = 1 record the latencies of the samples they take, see
+ * endpoint_stats.hpp, and readers with sequence_gaps.message_lost = 1 report
+ * the gaps in the sequence numbers of their writers as lost messages.
+ *
+ * The locators of a topic are set in `[topic]` sections only, as both of its
+ * ends must agree on them: locators.multicast = 1 sends its samples to the
+ * multicast locators, for topics with many readers, locators.multicast = 0 to
+ * the unicast locators of each reader, and locators.multicast_min_readers = N
+ * switches a writer to multicast once it matches N readers.
+ *
+ * The lines of a `[participant]` section are passed to GurumDDS as participant
+ * properties, for the RTPS settings that are not policies of an endpoint, such
+ * as the heartbeat period. The settings of large samples have checked names:
+ *
+ *   fragmentation.fragment_size (bytes), flow_control.send_window (fragments in
+ *   flight), flow_control.bytes_per_second (0 for no limit),
+ *   flow_control.nack_response_delay_us
+ *
+ * They apply to each writer of the participant.
+ */
+class QosProfiles {
+public:
+  // Reads the profiles of a file, false with the error message set if it is malformed
+  bool load(const std::string & path);
+
+  bool empty() const;
+
+  void apply(const char * topic_name, dds_DataWriterQos & qos) const;
+
+  void apply(const char * topic_name, dds_DataReaderQos & qos) const;
+
+  AsyncPublishSettings get_async_publish_settings(const char * topic_name) const;
+
+  CompressionSettings get_compression_settings(const char * topic_name) const;
+
+  bool is_latency_stats_enabled(const char * topic_name) const;
+
+  bool is_sequence_gap_lost_enabled(const char * topic_name) const;
+
+  LocatorSettings get_locator_settings(const char * topic_name) const;
+
+  // Value of RTPS_LOCATOR_POLICY_PROPERTY for the participant, empty if no topic sets locators
+  std::string get_locator_policy_property() const;
+
+  const std::vector<std::pair<std::string, std::string>> & get_participant_properties() const;
+
+private:
+  enum class Key
+  {
+    HISTORY_DEPTH,
+    MAX_SAMPLES,
+    MAX_INSTANCES,
+    MAX_SAMPLES_PER_INSTANCE,
+    LATENCY_BUDGET_US,
+    MAX_BLOCKING_TIME_US,
+    TRANSPORT_PRIORITY,
+    MINIMUM_SEPARATION_US,
+    ASYNC_QUEUE_DEPTH,
+    ASYNC_BLOCK_WHEN_FULL,
+    FLOW_PRIORITY,
+    FLOW_BYTES_PER_SECOND,
+    FLOW_BURST_BYTES,
+    COMPRESSION_THRESHOLD,
+    COMPRESSION_ACCELERATION,
+    LATENCY_STATS,
+    SEQUENCE_GAP_LOST,
+    LOCATOR_MULTICAST,
+    LOCATOR_MULTICAST_MIN_READERS,
+  };
+
+  struct Profile
+  {
+    std::string pattern;
+    bool writers;
+    bool readers;
+    std::vector<std::pair<Key, int64_t>> settings;
+  };
+
+  static LocatorSettings get_locator_settings(const Profile & profile, LocatorSettings settings);
+
+  // False if a property with a checked name has an invalid value
+  bool add_participant_property(const std::string & key, const std::string & value);
+
+  template<typename EntityQosT>
+  static void apply_common(const Profile & profile, EntityQosT & qos);
+
+  std::vector<Profile> profiles_;
+  std::vector<std::pair<std::string, std::string>> participant_properties_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__QOS_PROFILES_HPP_
@@ -0,0 +1,216 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__RAW_CAPTURE_HPP_
+#define RMW_GURUMDDS__RAW_CAPTURE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+// "GRMWCAP1", the last field of the file header written
+#define RAW_CAPTURE_MAGIC 0x31504143574d5247ULL
+#define RAW_CAPTURE_VERSION 1
+#define RAW_CAPTURE_NAME_SIZE 256
+#define RAW_CAPTURE_GID_SIZE 16
+// Records between two index entries, and the entries kept per MiB of records
+#define RAW_CAPTURE_INDEX_INTERVAL 64
+#define RAW_CAPTURE_INDEX_ENTRIES_PER_MIB 64
+#define RAW_CAPTURE_MIN_SIZE (1024 * 1024)
+// Size of a record at the end of the record ring that the next record does not follow
+#define RAW_CAPTURE_WRAP UINT32_MAX
+// Flags of a record
+#define RAW_CAPTURE_COMPRESSED 0x1
+
+namespace rmw_gurumdds_cpp
+{
+struct SubscriberInfo;
+
+/**
+ * Layout of a capture file: this header, the index ring, then the record ring.
+ * The writer overwrites the oldest records once the ring is full; the records
+ * from oldest_record to record_count are the valid ones. Offsets are in bytes
+ * from the start of the file, all fields in the byte order of the host.
+ */
+struct RawCaptureFileHeader
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t index_interval;
+  uint64_t index_offset;
+  uint64_t index_capacity;
+  uint64_t records_offset;
+  uint64_t records_size;
+  // ROS names of the topic and its type, such as "std_msgs/msg/String"
+  char topic_name[RAW_CAPTURE_NAME_SIZE];
+  char type_name[RAW_CAPTURE_NAME_SIZE];
+  // Updated after the records they count are written
+  uint64_t record_count;
+  uint64_t oldest_record;
+  // Offset of the oldest record and of the next one, from records_offset
+  uint64_t oldest_offset;
+  uint64_t write_offset;
+  uint64_t index_count;
+  // Records overwritten by newer ones, and the ones larger than the record ring
+  uint64_t overwritten_count;
+  uint64_t dropped_count;
+};
+
+// Written every index_interval records, at position (record / index_interval) % index_capacity
+struct RawCaptureIndexEntry
+{
+  uint64_t record;
+  uint64_t offset;
+  int64_t reception_timestamp;
+};
+
+// Followed by the payload, padded to 8 bytes
+struct RawCaptureRecordHeader
+{
+  // Bytes of the payload, or RAW_CAPTURE_WRAP
+  uint32_t size;
+  uint32_t flags;
+  uint64_t record;
+  int64_t source_timestamp;
+  int64_t reception_timestamp;
+  int64_t sequence_number;
+  uint8_t writer_gid[RAW_CAPTURE_GID_SIZE];
+};
+
+// A record of a capture, valid until the reader moves on or is closed
+struct RawCaptureRecord
+{
+  const RawCaptureRecordHeader * header;
+  // Serialized sample with its encapsulation header, compressed if the writer compressed it
+  const uint8_t * payload;
+};
+
+struct RawCaptureStatus
+{
+  uint64_t captured_count;
+  uint64_t overwritten_count;
+  uint64_t dropped_count;
+};
+
+/**
+ * Capture mode of a subscription, for black-box recorders. The DDS listener
+ * takes every sample as it arrives and appends its raw CDR payload and sample
+ * info to a memory-mapped ring file, without ROS messages or executor
+ * callbacks; the subscription does not report new samples meanwhile and is
+ * not to be taken from. An existing file is replaced. file_size of 0 picks
+ * RAW_CAPTURE_MIN_SIZE. Not supported on Windows.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+start_raw_capture(const rmw_subscription_t * subscription, const char * path, size_t file_size);
+
+// Flushes the file and returns the subscription to normal takes
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+stop_raw_capture(const rmw_subscription_t * subscription);
+
+// RMW_RET_UNSUPPORTED if the subscription does not capture
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+get_raw_capture_status(const rmw_subscription_t * subscription, RawCaptureStatus * status);
+
+// Appender of a capture file, called with the capture lock of the subscription held
+class RawCaptureWriter {
+public:
+  RawCaptureWriter() = default;
+
+  ~RawCaptureWriter();
+
+  RawCaptureWriter(const RawCaptureWriter &) = delete;
+
+  RawCaptureWriter & operator=(const RawCaptureWriter &) = delete;
+
+  // False with the error message set on failure
+  bool open(const char * path, size_t file_size, const char * topic_name, const char * type_name);
+
+  void append(const void * payload, uint32_t size, const RawCaptureRecordHeader & header);
+
+  void sync();
+
+  void get_status(RawCaptureStatus & status) const;
+
+private:
+  RawCaptureRecordHeader * get_record(uint64_t offset) const;
+
+  // Start of the record at offset, which is 0 past the end of the ring
+  uint64_t resolve(uint64_t offset) const;
+
+  void evict_oldest();
+
+  uint8_t * data_ {nullptr};
+  size_t size_ {0};
+  RawCaptureFileHeader * header_ {nullptr};
+  RawCaptureIndexEntry * index_ {nullptr};
+  uint8_t * records_ {nullptr};
+};
+
+/**
+ * Reader of a capture file, for replay tools. A file that is still written is
+ * read up to the records it had when the reader reached them; a record
+ * overwritten meanwhile ends the read.
+ */
+class RMW_GURUMDDS_CPP_PUBLIC_TYPE RawCaptureReader {
+public:
+  RMW_GURUMDDS_CPP_PUBLIC
+  RawCaptureReader() = default;
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  ~RawCaptureReader();
+
+  RawCaptureReader(const RawCaptureReader &) = delete;
+
+  RawCaptureReader & operator=(const RawCaptureReader &) = delete;
+
+  // Starts at the oldest record. False with the error message set on failure
+  RMW_GURUMDDS_CPP_PUBLIC
+  bool open(const char * path);
+
+  RMW_GURUMDDS_CPP_PUBLIC
+  const RawCaptureFileHeader * get_header() const;
+
+  // Moves to the first record received at or after timestamp, found through the index
+  RMW_GURUMDDS_CPP_PUBLIC
+  void seek(int64_t reception_timestamp);
+
+  // False at the end of the capture
+  RMW_GURUMDDS_CPP_PUBLIC
+  bool next(RawCaptureRecord & record);
+
+private:
+  const RawCaptureRecordHeader * get_record(uint64_t offset) const;
+
+  uint64_t resolve(uint64_t offset) const;
+
+  uint8_t * data_ {nullptr};
+  size_t size_ {0};
+  const RawCaptureFileHeader * header_ {nullptr};
+  uint64_t record_ {0};
+  uint64_t offset_ {0};
+};
+
+// Appends the samples the subscription holds to its capture, called by its DDS listener
+void capture_samples(SubscriberInfo * subscriber_info);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__RAW_CAPTURE_HPP_
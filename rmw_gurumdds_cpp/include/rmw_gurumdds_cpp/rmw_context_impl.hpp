@@ -15,10 +15,12 @@
 #ifndef RMW_GURUMDDS__RMW_CONTEXT_IMPL_HPP_
 #define RMW_GURUMDDS__RMW_CONTEXT_IMPL_HPP_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include "rcpputils/scope_exit.hpp"
 #include "rcutils/logging_macros.h"
@@ -37,9 +39,48 @@
 #include "rmw_dds_common/context.hpp"
 #include "rmw_dds_common/msg/participant_entities_info.hpp"
 
+#include "rmw_gurumdds_cpp/async_publish.hpp"
+#include "rmw_gurumdds_cpp/buffer_memory.hpp"
 #include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/discovery_cache.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
+#include "rmw_gurumdds_cpp/graph_index.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/intra_context.hpp"
+#include "rmw_gurumdds_cpp/name_cache.hpp"
+#include "rmw_gurumdds_cpp/network_flow.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+#include "rmw_gurumdds_cpp/source_clock.hpp"
+#include "rmw_gurumdds_cpp/thread_settings.hpp"
+#include "rmw_gurumdds_cpp/topic_locks.hpp"
+#include "rmw_gurumdds_cpp/type_support.hpp"
+#include "rmw_gurumdds_cpp/worker_pool.hpp"
+
+#define PARALLEL_DESERIALIZATION_THRESHOLD 65536
+
+// Participant property GurumDDS reads a static discovery description from
+#define STATIC_DISCOVERY_FILE_PROPERTY "gurumdds.static_discovery.file"
+
+// Participant properties of the GurumDDS shared-memory transport. With the preference set,
+// the locators of the transport are used for the readers and writers of peers on the same host
+#define SHM_TRANSPORT_PROPERTY "rtps.transport.shm.enabled"
+#define SHM_SEGMENT_SIZE_PROPERTY "rtps.transport.shm.segment_size"
+#define SHM_PREFER_LOCAL_PROPERTY "rtps.transport.shm.prefer_same_host"
+
+// Participant properties of the CPU affinity and scheduling of the GurumDDS threads
+#define DDS_THREAD_AFFINITY_PROPERTY "rtps.thread.affinity"
+#define DDS_THREAD_POLICY_PROPERTY "rtps.thread.sched_policy"
+#define DDS_THREAD_PRIORITY_PROPERTY "rtps.thread.sched_priority"
+
+// Values of rmw_context_impl_s::entity_group_policy, how endpoints are spread over the groups
+#define ENTITY_GROUP_ROUND_ROBIN 0
+#define ENTITY_GROUP_BY_TOPIC 1
+#define ENTITY_GROUP_BY_THREAD 2
+
+// Values of rmw_context_impl_s::shm_transport
+#define SHM_TRANSPORT_AUTO (-1)
+#define SHM_TRANSPORT_OFF 0
+#define SHM_TRANSPORT_ON 1
 
 namespace rmw_gurumdds_cpp
 {
@@ -62,6 +103,13 @@ void on_subscription_changed(
 struct rmw_context_impl_s
 {
   rmw_dds_common::Context common_ctx;
+  /* Per-node and per-topic view of common_ctx.graph_cache, updated along with it.
+     Count and names queries read its versioned snapshot. */
+  rmw_gurumdds_cpp::GraphIndex graph_index;
+  /* Mangled and demangled names of the graph queries. */
+  rmw_gurumdds_cpp::NameCache name_cache;
+  /* Types registered with the participant, shared by its publishers and subscriptions. */
+  rmw_gurumdds_cpp::TypeSupportRegistry type_registry;
   rmw_context_t * base;
 
   dds_DomainId_t domain_id;
@@ -70,9 +118,96 @@ struct rmw_context_impl_s
   /* used for all DDS writers/readers created to support rmw_gurumdds_cpp::(Publisher/Subscriber)Info. */
   dds_Publisher * publisher;
   dds_Subscriber * subscriber;
+  /* Publishers and subscribers after the first ones, the endpoints of a context are spread
+     over entity_group_count groups. The graph endpoints always use the first group. */
+  std::vector<dds_Publisher *> publisher_groups;
+  std::vector<dds_Subscriber *> subscriber_groups;
+  size_t entity_group_count{1};
+  int entity_group_policy{ENTITY_GROUP_ROUND_ROBIN};
+  std::atomic<size_t> next_entity_group{0};
+  /* Publisher and subscriber that create their endpoints disabled, used by create_endpoints
+     to enable the endpoints it creates together. */
+  dds_Publisher * bulk_publisher{nullptr};
+  dds_Subscriber * bulk_subscriber{nullptr};
 
   bool service_mapping_basic;
 
+  /* Workers that rmw_take_sequence deserializes large batches on, null if disabled. */
+  std::unique_ptr<rmw_gurumdds_cpp::WorkerPool> deserialization_workers;
+  /* Serialized size of a batch from which it is deserialized in parallel. */
+  size_t parallel_deserialization_threshold{0};
+
+  /* Wait sets poll the trigger values of their conditions instead of blocking. */
+  bool wait_use_polling{false};
+  /* Time in nanoseconds wait sets spin on their conditions before blocking, 0 to always block. */
+  uint64_t wait_spin_ns{0};
+
+  /* Time in nanoseconds after which the response to a request is dropped, 0 for no timeout. */
+  uint64_t request_timeout_ns{0};
+
+  /* Time in nanoseconds that discovery updates are held back to be published as one,
+     0 to publish every update. */
+  uint64_t discovery_update_delay_ns{0};
+  /* Discovery samples the listener thread takes and applies at once, 0 to take one at a time. */
+  size_t discovery_batch_size{0};
+  /* Time in nanoseconds that graph changes are held back to trigger the graph guard condition
+     once, 0 to trigger it on every change. */
+  uint64_t graph_change_delay_ns{0};
+  /* Latest discovery update and graph change held back, done by the listener thread at their
+     deadlines. */
+  std::mutex deferred_mutex;
+  std::unique_ptr<rmw_dds_common::msg::ParticipantEntitiesInfo> discovery_update;
+  uint64_t discovery_update_deadline_ns{0};
+  /* Callers of graph_cache::hold_updates that did not release the updates yet. */
+  size_t discovery_update_holds{0};
+  bool graph_change_pending{false};
+  uint64_t graph_change_deadline_ns{0};
+  /* Name, CPU affinity and scheduling of the listener thread. */
+  rmw_gurumdds_cpp::ThreadSettings listener_thread_settings;
+  /* Values of the DDS_THREAD_*_PROPERTY properties, empty to keep the GurumDDS defaults. */
+  std::string dds_thread_affinity;
+  std::string dds_thread_policy;
+  std::string dds_thread_priority;
+  /* Wakes the listener thread when work is held back, null if nothing is delayed. */
+  dds_GuardCondition * listener_wakeup_gc{nullptr};
+  /* Description of the participants, endpoints and locators to match without waiting for
+     SPDP/SEDP, empty to discover everything. */
+  std::string static_discovery_file;
+  /* File of the per-topic DDS policies, empty for none. Loaded into qos_profiles along with
+     the participant. */
+  std::string qos_profile_file;
+  rmw_gurumdds_cpp::QosProfiles qos_profiles;
+  /* Value of RTPS_LOCATOR_POLICY_PROPERTY built from qos_profiles, empty if no topic sets its
+     locators or GurumDDS does not support the property. */
+  std::string locator_policy;
+  /* Write the samples of the asynchronous publishers, one thread per priority lane started by
+     the first publisher of the lane. */
+  std::unique_ptr<rmw_gurumdds_cpp::AsyncPublishSender> async_senders[FLOW_PRIORITY_LANES];
+  /* CPU affinity and scheduling of the sender threads of the lanes above 0. A non-zero priority
+     is raised by one for each lane above 1. */
+  rmw_gurumdds_cpp::ThreadSettings send_thread_settings;
+  /* Whether same-host traffic uses the shared-memory transport, SHM_TRANSPORT_AUTO to use it
+     for localhost-only discovery. */
+  int shm_transport{SHM_TRANSPORT_AUTO};
+  /* Size in bytes of the shared-memory segment of the participant, empty for the GurumDDS
+     default. */
+  std::string shm_segment_size;
+  /* Memory of the message buffer pools, loan pools and arenas of the endpoints, one of
+     BUFFER_MEMORY_*. */
+  int buffer_memory{BUFFER_MEMORY_HEAP};
+  /* Clock stamping the samples written without a caller-supplied timestamp, one of
+     SOURCE_CLOCK_*. */
+  int source_clock{SOURCE_CLOCK_DDS};
+  /* Subscriptions the publishers of the context hand samples to without DDS, null if
+     disabled. */
+  std::unique_ptr<rmw_gurumdds_cpp::IntraContextDelivery> intra_context;
+  /* Remote graph of the previous run kept on disk, seeding the graph cache, null if
+     disabled. */
+  std::unique_ptr<rmw_gurumdds_cpp::DiscoveryCache> discovery_cache;
+  /* Unicast locators of the user traffic of the participant, the network flows of its
+     endpoints. Empty if they could not be found. */
+  std::vector<rmw_gurumdds_cpp::NetworkFlowLocator> flow_locators;
+
   /* Participant reference count */
   size_t node_count{0};
 
@@ -82,7 +217,12 @@ struct rmw_context_impl_s
   /* Shutdown flag. */
   bool is_shutdown;
 
-  std::mutex endpoint_mutex;
+  /* Locks of the topics that endpoints are created and deleted on. */
+  rmw_gurumdds_cpp::TopicLocks topic_locks;
+  /* Serializes the updates of the graph by the local entities. */
+  std::mutex graph_mutex;
+  /* Guards the start of async_senders. */
+  std::mutex publish_threads_mutex;
 
   explicit rmw_context_impl_s(rmw_context_t * const base);
   ~rmw_context_impl_s();
@@ -104,6 +244,16 @@ struct rmw_context_impl_s
   rmw_ret_t
   finalize_participant();
 
+  // Group of a new endpoint, by entity_group_policy. `topic_name` is the ROS name
+  size_t
+  select_entity_group(const char * topic_name);
+
+  dds_Publisher *
+  get_publisher(size_t group) const;
+
+  dds_Subscriber *
+  get_subscriber(size_t group) const;
+
   rmw_ret_t
   finalize();
 };
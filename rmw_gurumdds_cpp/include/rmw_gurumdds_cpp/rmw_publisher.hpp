@@ -28,17 +28,29 @@ create_publisher(
   const rmw_publisher_options_t * publisher_options,
   const bool internal);
 
+// rmw_create_publisher, creating the writer on pub or, if nullptr, on the entity group of the topic
+rmw_publisher_t *
+create_node_publisher(
+  const rmw_node_t * node,
+  const rosidl_message_type_support_t * type_supports,
+  const char * topic_name,
+  const rmw_qos_profile_t * qos_policies,
+  const rmw_publisher_options_t * publisher_options,
+  dds_Publisher * const pub);
+
 rmw_ret_t
 destroy_publisher(
   rmw_context_impl_t * const ctx,
   rmw_publisher_t * const publisher);
 
+// Without a source_timestamp the sample is stamped by the source clock of the context
 rmw_ret_t
 publish(
   const char * identifier,
   const rmw_publisher_t * publisher,
   const void * ros_message,
-  rmw_publisher_allocation_t * allocation);
+  rmw_publisher_allocation_t * allocation,
+  const dds_Time_t * source_timestamp = nullptr);
 } // namespace rmw_gurumdds_cpp
 
 #endif // RMW_GURUMDDS__RMW_PUBLISHER_HPP_
@@ -28,6 +28,17 @@ create_subscription(
   const rmw_subscription_options_t * subscription_options,
   const bool internal);
 
+// rmw_create_subscription, creating the reader on sub or, if nullptr, on the entity group of the
+// topic
+rmw_subscription_t *
+create_node_subscription(
+  const rmw_node_t * node,
+  const rosidl_message_type_support_t * type_supports,
+  const char * topic_name,
+  const rmw_qos_profile_t * qos_policies,
+  const rmw_subscription_options_t * subscription_options,
+  dds_Subscriber * const sub);
+
 rmw_ret_t
 destroy_subscription(
   rmw_context_impl_t * const ctx,
@@ -0,0 +1,69 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__SAMPLE_SEQUENCE_POOL_HPP_
+#define RMW_GURUMDDS__SAMPLE_SEQUENCE_POOL_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Sequences that a raw read or take of a data reader loans samples into
+struct SampleSequences
+{
+  dds_DataSeq * data_seq;
+  dds_SampleInfoSeq * info_seq;
+  dds_UnsignedLongSeq * raw_data_sizes;
+  uint32_t capacity;
+};
+
+/**
+ * Sample sequences of a data reader that are kept between takes, so that a
+ * take does not create and delete a set of sequences each time. Released sets
+ * are reused by the next take; a set smaller than the largest batch seen so
+ * far is recreated at that size.
+ */
+class SampleSequencePool {
+public:
+  SampleSequencePool() = default;
+
+  ~SampleSequencePool();
+
+  SampleSequencePool(const SampleSequencePool &) = delete;
+
+  SampleSequencePool & operator=(const SampleSequencePool &) = delete;
+
+  static bool create(uint32_t capacity, SampleSequences & sequences);
+
+  static void destroy(const SampleSequences & sequences);
+
+  // Returns sequences that hold at least `count` samples. False on allocation failure
+  bool acquire(uint32_t count, SampleSequences & sequences);
+
+  // Returns the loan of the sequences to the reader and keeps them for the next take
+  void release(dds_DataReader * reader, const SampleSequences & sequences);
+
+private:
+  std::mutex mutex_;
+  std::vector<SampleSequences> free_sequences_;
+  uint32_t capacity_ {1};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__SAMPLE_SEQUENCE_POOL_HPP_
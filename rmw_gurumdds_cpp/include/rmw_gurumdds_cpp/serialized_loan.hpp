@@ -0,0 +1,52 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__SERIALIZED_LOAN_HPP_
+#define RMW_GURUMDDS__SERIALIZED_LOAN_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Serialized take without a copy, for recorders and bridges. The CDR payload
+ * of the sample, encapsulation header included, stays in the DDS cache until
+ * it is returned. A compressed payload is decompressed into a buffer of the
+ * loan. Loans hold samples of the reader history, so they are returned as
+ * soon as the payload is consumed.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+take_loaned_serialized_message(
+  const rmw_subscription_t * subscription,
+  const uint8_t ** buffer,
+  size_t * length,
+  bool * taken,
+  rmw_message_info_t * message_info);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+return_loaned_serialized_message(
+  const rmw_subscription_t * subscription,
+  const uint8_t * buffer);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__SERIALIZED_LOAN_HPP_
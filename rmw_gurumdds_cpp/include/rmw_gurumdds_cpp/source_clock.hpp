@@ -0,0 +1,36 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__SOURCE_CLOCK_HPP_
+#define RMW_GURUMDDS__SOURCE_CLOCK_HPP_
+
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+
+// Values of rmw_context_impl_s::source_clock
+#define SOURCE_CLOCK_DDS 0
+#define SOURCE_CLOCK_REALTIME 1
+#define SOURCE_CLOCK_REALTIME_COARSE 2
+
+namespace rmw_gurumdds_cpp
+{
+// Parses "dds", "realtime" or "coarse". False if the name is unknown
+bool parse_source_clock(const char * name, int & source_clock);
+
+// Reads the clock that stamps the samples written without a caller-supplied timestamp.
+// The coarse clock is only as precise as the scheduler tick, a few milliseconds at most, and
+// clocks missing on the platform fall back to the DDS clock
+void get_source_time(int source_clock, dds_Time_t * time);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__SOURCE_CLOCK_HPP_
@@ -0,0 +1,51 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__THREAD_SETTINGS_HPP_
+#define RMW_GURUMDDS__THREAD_SETTINGS_HPP_
+
+#include <string>
+#include <vector>
+
+namespace rmw_gurumdds_cpp
+{
+// Scheduling policy of ThreadSettings that leaves the policy of the thread unchanged
+#define THREAD_POLICY_UNSET (-1)
+
+/**
+ * Name, CPU affinity and scheduling of a thread the RMW starts. Unset
+ * settings leave the thread as it was created. Applied by the thread itself,
+ * so a setting the system refuses is logged instead of failing the caller.
+ */
+struct ThreadSettings
+{
+  // Shortened to the 15 characters a thread name holds on Linux
+  std::string name;
+  std::vector<int> cpus;
+  int policy {THREAD_POLICY_UNSET};
+  int priority {0};
+
+  // Parses a list such as "0,2-3". False if it is malformed
+  static bool parse_cpus(const char * list, std::vector<int> & cpus);
+
+  // Parses "other", "fifo" or "rr" into a SCHED_* policy. False if it is unknown
+  static bool parse_policy(const char * name, int & policy);
+
+  // Applies the settings to the calling thread
+  void apply() const;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__THREAD_SETTINGS_HPP_
@@ -0,0 +1,50 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__TIMESTAMPED_PUBLISH_HPP_
+#define RMW_GURUMDDS__TIMESTAMPED_PUBLISH_HPP_
+
+#include "rmw/ret_types.h"
+#include "rmw/time.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Publishes stamped with a source timestamp supplied by the caller, such as
+ * the acquisition time of a sensor reading or the recorded time of a replayed
+ * sample, instead of reading the source clock. The timestamp is in nanoseconds
+ * since the epoch, and is reported as the source timestamp of the message info
+ * of the subscriptions. Other publishes are stamped by the clock
+ * RMW_GURUMDDS_SOURCE_CLOCK selects.
+ */
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+publish_with_timestamp(
+  const rmw_publisher_t * publisher,
+  const void * ros_message,
+  rmw_time_point_value_t source_timestamp,
+  rmw_publisher_allocation_t * allocation);
+
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+publish_serialized_message_with_timestamp(
+  const rmw_publisher_t * publisher,
+  const rmw_serialized_message_t * serialized_message,
+  rmw_time_point_value_t source_timestamp);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__TIMESTAMPED_PUBLISH_HPP_
@@ -0,0 +1,66 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__TOPIC_LOCKS_HPP_
+#define RMW_GURUMDDS__TOPIC_LOCKS_HPP_
+
+#include <array>
+#include <mutex>
+#include <string>
+
+// Number of locks the DDS topic names of a context are spread over
+#define TOPIC_LOCK_COUNT 64
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Locks of the DDS topics of a context, by a hash of the topic name. Looking a
+ * topic up or creating it and creating an endpoint on it, and deleting an
+ * endpoint and its topic, hold the lock of the topic, so that endpoints of
+ * other topics are created and deleted in parallel.
+ */
+class TopicLocks {
+public:
+  std::mutex & get(const std::string & topic_name);
+
+private:
+  std::array<std::mutex, TOPIC_LOCK_COUNT> mutexes_;
+};
+
+// Holds the locks of one or two topics, taken in a fixed order
+class TopicLockGuard {
+public:
+  TopicLockGuard() = default;
+
+  ~TopicLockGuard();
+
+  TopicLockGuard(const TopicLockGuard &) = delete;
+
+  TopicLockGuard & operator=(const TopicLockGuard &) = delete;
+
+  void lock(TopicLocks & locks, const std::string & topic_name);
+
+  // The topics of a service may share a lock, which is then taken once
+  void lock(TopicLocks & locks, const std::string & first_name, const std::string & second_name);
+
+  void unlock();
+
+private:
+  std::mutex * first_ {nullptr};
+  std::mutex * second_ {nullptr};
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__TOPIC_LOCKS_HPP_
@@ -0,0 +1,35 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__TRACING_HPP_
+#define RMW_GURUMDDS__TRACING_HPP_
+
+// Tracepoints of tracing_provider.h, compiled out unless the rmw was built with lttng-ust
+#ifdef RMW_GURUMDDS_CPP_TRACING_ENABLED
+#include "rmw_gurumdds_cpp/tracing_provider.h"
+
+#define RMW_GURUMDDS_TRACEPOINT(event_name, ...) \
+  tracepoint(rmw_gurumdds_cpp, event_name, __VA_ARGS__)
+#define RMW_GURUMDDS_TRACEPOINT_ENABLED(event_name) \
+  tracepoint_enabled(rmw_gurumdds_cpp, event_name)
+#define RMW_GURUMDDS_DO_TRACEPOINT(event_name, ...) \
+  do_tracepoint(rmw_gurumdds_cpp, event_name, __VA_ARGS__)
+#else
+#define RMW_GURUMDDS_TRACEPOINT(event_name, ...) ((void)0)
+#define RMW_GURUMDDS_TRACEPOINT_ENABLED(event_name) false
+#define RMW_GURUMDDS_DO_TRACEPOINT(event_name, ...) ((void)0)
+#endif
+
+#endif  // RMW_GURUMDDS__TRACING_HPP_
@@ -0,0 +1,144 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// LTTng-UST tracepoints of this rmw that tracetools has no event for. The tracetools
+// events of the same call (rmw_publish, rmw_take, rmw_take_request...) share its handles
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER rmw_gurumdds_cpp
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "rmw_gurumdds_cpp/tracing_provider.h"
+
+#if !defined(RMW_GURUMDDS__TRACING_PROVIDER_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define RMW_GURUMDDS__TRACING_PROVIDER_H_
+
+#include <stdint.h>
+
+#include <lttng/tracepoint.h>
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  serialize_begin,
+  TP_ARGS(
+    const void *, ros_message_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, ros_message, ros_message_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  serialize_end,
+  TP_ARGS(
+    const void *, ros_message_arg,
+    uint64_t, size_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, ros_message, ros_message_arg)
+    ctf_integer(uint64_t, size, size_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  deserialize_begin,
+  TP_ARGS(
+    const void *, ros_message_arg,
+    uint64_t, size_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, ros_message, ros_message_arg)
+    ctf_integer(uint64_t, size, size_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  deserialize_end,
+  TP_ARGS(
+    const void *, ros_message_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, ros_message, ros_message_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  wait_begin,
+  TP_ARGS(
+    const void *, wait_set_arg,
+    uint32_t, condition_count_arg,
+    int64_t, timeout_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, wait_set, wait_set_arg)
+    ctf_integer(uint32_t, condition_count, condition_count_arg)
+    ctf_integer(int64_t, timeout, timeout_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  wait_end,
+  TP_ARGS(
+    const void *, wait_set_arg,
+    uint32_t, active_count_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, wait_set, wait_set_arg)
+    ctf_integer(uint32_t, active_count, active_count_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  take_request_begin,
+  TP_ARGS(
+    const void *, service_handle_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, service_handle, service_handle_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  send_response_begin,
+  TP_ARGS(
+    const void *, service_handle_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, service_handle, service_handle_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  send_response_end,
+  TP_ARGS(
+    const void *, service_handle_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, service_handle, service_handle_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  take_response_begin,
+  TP_ARGS(
+    const void *, client_handle_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, client_handle, client_handle_arg)
+  )
+)
+
+#endif  // RMW_GURUMDDS__TRACING_PROVIDER_H_
+
+#include <lttng/tracepoint-event.h>
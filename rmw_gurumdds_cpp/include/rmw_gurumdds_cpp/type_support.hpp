@@ -15,23 +15,65 @@
 #ifndef RMW_GURUMDDS__TYPE_SUPPORT_HPP_
 #define RMW_GURUMDDS__TYPE_SUPPORT_HPP_
 
+#include <cstddef>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
-#include "dds_include.hpp"
 #include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "dds_include.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
 namespace rmw_gurumdds_cpp
 {
 dds_TypeSupport*
 create_type_support_and_register(
   dds_DomainParticipant * participant,
-  const rosidl_message_type_support_t * type_support,
+  const MessagePlan * plan,
   const std::string & type_name,
   const std::string & metastring);
 
 void set_type_support_ops(
   dds_TypeSupport* dds_type_support,
-  const rosidl_message_type_support_t* type_support
+  const MessagePlan* plan
   );
+
+// Serialized size of the last sample DDS deserialized through set_type_support_ops on the
+// calling thread, for the stats of the takes that DDS deserializes
+size_t get_last_deserialized_size();
+
+// Types registered with the participant of a context, shared by the endpoints of the same type
+class TypeSupportRegistry {
+public:
+  struct Entry
+  {
+    std::string type_name;
+    const MessagePlan * plan;
+    dds_TypeSupport * dds_typesupport;
+    size_t ref_count;
+  };
+
+  TypeSupportRegistry() = default;
+
+  TypeSupportRegistry(const TypeSupportRegistry &) = delete;
+
+  TypeSupportRegistry & operator=(const TypeSupportRegistry &) = delete;
+
+  // Registers the type with the participant on first use. nullptr on error
+  const Entry * acquire(
+    dds_DomainParticipant * participant,
+    const rosidl_message_type_support_t * type_support);
+
+  // Deletes the dds_TypeSupport of the type once its last endpoint released it
+  void release(const rosidl_message_type_support_t * type_support);
+
+  // Deletes all dds_TypeSupports, called before the participant is deleted
+  void clear();
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<const rosidl_message_type_support_t *, Entry> entries_;
+};
 }
 
 #endif  // RMW_GURUMDDS__TYPE_SUPPORT_HPP_
@@ -26,14 +26,6 @@ template<typename MessageMembersT>
 std::string
 create_type_name(const void * untyped_members);
 
-template<typename MessageMembersT>
-void *
-allocate_message(
-  const void * untyped_members,
-  const uint8_t * ros_message,
-  size_t * size,
-  bool is_service);
-
 template<typename MessageMembersT>
 std::string
 create_metastring(const void * untyped_members, bool is_service);
@@ -47,36 +39,6 @@ create_type_name(const void * untyped_members, const char * identifier);
 
 std::string
 create_metastring(const void * untyped_members, const char * identifier);
-
-void *
-allocate_message(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_message,
-  size_t * size,
-  bool is_service);
-
-ssize_t
-get_serialized_size(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_message);
-
-bool
-serialize_ros_to_cdr(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_message,
-  void * dds_message,
-  size_t size);
-
-bool
-deserialize_cdr_to_ros(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_message,
-  void * dds_message,
-  size_t size);
 } // namespace rmw_gurumdds_cpp
 
 #include "rmw_gurumdds_cpp/type_support_common.inl"
@@ -41,51 +41,6 @@ create_type_name(const void * untyped_members) {
   return type_name.str();
 }
 
-template<typename MessageMembersT>
-void *
-allocate_message(
-  const void * untyped_members,
-  const uint8_t * ros_message,
-  size_t * size,
-  bool is_service) {
-  auto members =
-    static_cast<const MessageMembersT *>(untyped_members);
-  if (nullptr == members) {
-    RMW_SET_ERROR_MSG("Members handle is null");
-    return nullptr;
-  }
-
-  if (nullptr == ros_message) {
-    RMW_SET_ERROR_MSG("ros message is null");
-    return nullptr;
-  }
-
-  if (nullptr == size) {
-    RMW_SET_ERROR_MSG("size pointer is null");
-    return nullptr;
-  }
-
-  rmw_gurumdds_cpp::CdrSerializationBuffer<false> buffer{nullptr, 0};
-  rmw_gurumdds_cpp::MessageSerializer<false, MessageMembersT> serializer{buffer};
-  serializer.serialize(members, ros_message, true);
-  if (is_service) {
-    uint64_t dummy = 0;
-    buffer << dummy;  // client_guid_0
-    buffer << dummy;  // client_guid_1
-    buffer << dummy;  // sequence_number
-    buffer << dummy;  // padding
-  }
-
-  *size = buffer.get_offset() + 4;
-  void * message = calloc(1, *size);
-  if (nullptr == message) {
-    RMW_SET_ERROR_MSG("Failed to allocate memory for dds message");
-    return nullptr;
-  }
-
-  return message;
-}
-
 template<typename MessageMembersT>
 std::string
 parse_struct(const MessageMembersT * members, const char * field_name, bool is_service)
@@ -22,6 +22,8 @@
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/macros.hpp"
 
+#include "rosidl_runtime_c/service_type_support_struct.h"
+
 #include "rosidl_typesupport_introspection_c/field_types.h"
 #include "rosidl_typesupport_introspection_c/identifier.h"
 #include "rosidl_typesupport_introspection_c/message_introspection.h"
@@ -32,7 +34,9 @@
 #include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
 #include "rosidl_typesupport_introspection_cpp/service_introspection.hpp"
 
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
 #include "rmw_gurumdds_cpp/type_support_common.hpp"
+#include "rmw_gurumdds_cpp/tracing.hpp"
 
 #define GET_TYPENAME(T) \
   typename std::remove_pointer<typename std::remove_const<decltype(T)>::type>::type
@@ -53,80 +57,13 @@ create_service_metastring(const void * untyped_members);
 std::pair<std::string, std::string>
 create_service_metastring(const void * untyped_members, const char * identifier);
 
-template<typename ServiceMembersT>
-void *
-allocate_request_basic(
-  const void * untyped_members,
-  const void * ros_request,
-  size_t * size);
-
-void *
-allocate_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  size_t * size);
-
-template<typename ServiceMembersT>
-void *
-allocate_response_basic(
-  const void * untyped_members,
-  const void * ros_response,
-  size_t * size);
-
-void *
-allocate_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  size_t * size);
-
-template<typename ServiceMembersT>
-void *
-allocate_request_enhanced(
-  const void * untyped_members,
-  const void * ros_request,
-  size_t * size);
-
-void *
-allocate_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  size_t * size);
-
-template<typename ServiceMembersT>
-void *
-allocate_response_enhanced(
-  const void * untyped_members,
-  const void * ros_response,
-  size_t * size);
-
-void *
-allocate_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  size_t * size);
-
 template<typename MessageMembersT>
 bool
 serialize_service_basic(
   const void * untyped_members,
   const uint8_t * ros_service,
-  uint8_t * dds_service,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid,
-  bool is_request);
-
-bool
-serialize_service_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_service,
-  void * dds_service,
-  size_t size,
+  CdrGrowableStorage & dds_service,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid,
   bool is_request);
@@ -136,18 +73,8 @@ bool
 serialize_request_basic(
   const void * untyped_members,
   const uint8_t * ros_request,
-  uint8_t * dds_request,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid);
-
-bool
-serialize_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  void * dds_request,
-  size_t size,
+  CdrGrowableStorage & dds_request,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid);
 
@@ -156,18 +83,8 @@ bool
 serialize_response_basic(
   const void * untyped_members,
   const uint8_t * ros_response,
-  uint8_t * dds_response,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid);
-
-bool
-serialize_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  void * dds_response,
-  size_t size,
+  CdrGrowableStorage & dds_response,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid);
 
@@ -176,48 +93,24 @@ bool
 serialize_service_enhanced(
   const void * untyped_members,
   const uint8_t * ros_service,
-  uint8_t * dds_service,
-  size_t size);
-
-bool
-serialize_service_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_service,
-  void * dds_service,
-  size_t size);
+  CdrGrowableStorage & dds_service,
+  size_t * size);
 
 template<typename ServiceMembersT>
 bool
 serialize_request_enhanced(
   const void * untyped_members,
   const uint8_t * ros_request,
-  uint8_t * dds_request,
-  size_t size);
-
-bool
-serialize_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  void * dds_request,
-  size_t size);
+  CdrGrowableStorage & dds_request,
+  size_t * size);
 
 template<typename ServiceMembersT>
 bool
 serialize_response_enhanced(
   const void * untyped_members,
   const uint8_t * ros_response,
-  uint8_t * dds_response,
-  size_t size);
-
-bool
-serialize_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  void * dds_response,
-  size_t size);
+  CdrGrowableStorage & dds_response,
+  size_t * size);
 
 template<typename MessageMembersT>
 bool
@@ -231,18 +124,6 @@ deserialize_service_basic(
   int8_t * client_guid,
   bool is_request);
 
-bool
-deserialize_service_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_service,
-  void * dds_service,
-  size_t size,
-  int32_t * sn_high,
-  uint32_t * sn_low,
-  int8_t * client_guid,
-  bool is_request);
-
 template<typename ServiceMembersT>
 bool
 deserialize_request_basic(
@@ -254,17 +135,6 @@ deserialize_request_basic(
   uint32_t * sn_low,
   int8_t * client_guid);
 
-bool
-deserialize_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_request,
-  void * dds_request,
-  size_t size,
-  int32_t * sn_high,
-  uint32_t * sn_low,
-  int8_t * client_guid);
-
 template<typename ServiceMembersT>
 bool
 deserialize_response_basic(
@@ -276,12 +146,10 @@ deserialize_response_basic(
   uint32_t * sn_low,
   int8_t * client_guid);
 
+// Reads only the request id that prefixes a basic mapping request or response
 bool
-deserialize_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_response,
-  void * dds_response,
+peek_service_header_basic(
+  void * dds_service,
   size_t size,
   int32_t * sn_high,
   uint32_t * sn_low,
@@ -295,14 +163,6 @@ deserialize_service_enhanced(
   uint8_t * dds_service,
   size_t size);
 
-bool
-deserialize_service_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_service,
-  void * dds_service,
-  size_t size);
-
 template<typename ServiceMembersT>
 bool
 deserialize_request_enhanced(
@@ -311,14 +171,6 @@ deserialize_request_enhanced(
   uint8_t * dds_request,
   size_t size);
 
-bool
-deserialize_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_request,
-  void * dds_request,
-  size_t size);
-
 template<typename ServiceMembersT>
 bool
 deserialize_response_enhanced(
@@ -327,13 +179,105 @@ deserialize_response_enhanced(
   uint8_t * dds_response,
   size_t size);
 
-bool
-deserialize_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_response,
-  void * dds_response,
-  size_t size);
+// Request and response (de)serializers of a service type, resolved for its language when the
+// service or client is created
+struct ServiceTypeSupport
+{
+  using SerializeBasicFn = bool (*)(
+    const void *, const uint8_t *, CdrGrowableStorage &, size_t *, int64_t, const uint8_t *, bool);
+  using SerializeEnhancedFn = bool (*)(
+    const void *, const uint8_t *, CdrGrowableStorage &, size_t *);
+  using DeserializeBasicFn = bool (*)(
+    const void *, uint8_t *, uint8_t *, size_t, int32_t *, uint32_t *, int8_t *, bool);
+  using DeserializeEnhancedFn = bool (*)(const void *, uint8_t *, uint8_t *, size_t);
+
+  const void * request_members {nullptr};
+  const void * response_members {nullptr};
+  SerializeBasicFn serialize_basic {nullptr};
+  SerializeEnhancedFn serialize_enhanced {nullptr};
+  DeserializeBasicFn deserialize_basic {nullptr};
+  DeserializeEnhancedFn deserialize_enhanced {nullptr};
+
+  bool init(const rosidl_service_type_support_t * type_support);
+
+  bool serialize_request_basic(
+    const void * ros_request,
+    CdrGrowableStorage & dds_request,
+    size_t * size,
+    int64_t sequence_number,
+    const uint8_t * client_guid) const
+  {
+    return serialize_basic(
+      request_members, static_cast<const uint8_t *>(ros_request), dds_request, size,
+      sequence_number, client_guid, true);
+  }
+
+  bool serialize_response_basic(
+    const void * ros_response,
+    CdrGrowableStorage & dds_response,
+    size_t * size,
+    int64_t sequence_number,
+    const uint8_t * client_guid) const
+  {
+    return serialize_basic(
+      response_members, static_cast<const uint8_t *>(ros_response), dds_response, size,
+      sequence_number, client_guid, false);
+  }
+
+  bool serialize_request_enhanced(
+    const void * ros_request, CdrGrowableStorage & dds_request, size_t * size) const
+  {
+    return serialize_enhanced(
+      request_members, static_cast<const uint8_t *>(ros_request), dds_request, size);
+  }
+
+  bool serialize_response_enhanced(
+    const void * ros_response, CdrGrowableStorage & dds_response, size_t * size) const
+  {
+    return serialize_enhanced(
+      response_members, static_cast<const uint8_t *>(ros_response), dds_response, size);
+  }
+
+  bool deserialize_request_basic(
+    void * ros_request,
+    void * dds_request,
+    size_t size,
+    int32_t * sn_high,
+    uint32_t * sn_low,
+    int8_t * client_guid) const
+  {
+    return deserialize_basic(
+      request_members, static_cast<uint8_t *>(ros_request), static_cast<uint8_t *>(dds_request),
+      size, sn_high, sn_low, client_guid, true);
+  }
+
+  bool deserialize_response_basic(
+    void * ros_response,
+    void * dds_response,
+    size_t size,
+    int32_t * sn_high,
+    uint32_t * sn_low,
+    int8_t * client_guid) const
+  {
+    return deserialize_basic(
+      response_members, static_cast<uint8_t *>(ros_response), static_cast<uint8_t *>(dds_response),
+      size, sn_high, sn_low, client_guid, false);
+  }
+
+  bool deserialize_request_enhanced(void * ros_request, void * dds_request, size_t size) const
+  {
+    return deserialize_enhanced(
+      request_members, static_cast<uint8_t *>(ros_request), static_cast<uint8_t *>(dds_request),
+      size);
+  }
+
+  bool deserialize_response_enhanced(void * ros_response, void * dds_response, size_t size) const
+  {
+    return deserialize_enhanced(
+      response_members, static_cast<uint8_t *>(ros_response),
+      static_cast<uint8_t *>(dds_response), size);
+  }
+};
 
 inline void
 ros_sn_to_dds_sn(int64_t sn_ros, uint64_t * sn_dds);
@@ -59,97 +59,13 @@ create_service_metastring(const void * untyped_members)
   };
 }
 
-template<typename ServiceMembersT>
-void *
-allocate_request_basic(
-  const void * untyped_members,
-  const void * ros_request,
-  size_t * size)
-{
-  auto members = static_cast<const ServiceMembersT *>(untyped_members);
-  if (members == nullptr) {
-    RMW_SET_ERROR_MSG("Members handle is null");
-    return nullptr;
-  }
-
-  return allocate_message<GET_TYPENAME(members->request_members_)>(
-    static_cast<const void *>(members->request_members_),
-    static_cast<const uint8_t *>(ros_request),
-    size,
-    true
-  );
-}
-
-template<typename ServiceMembersT>
-void *
-allocate_response_basic(
-  const void * untyped_members,
-  const void * ros_response,
-  size_t * size)
-{
-  auto members = static_cast<const ServiceMembersT *>(untyped_members);
-  if (members == nullptr) {
-    RMW_SET_ERROR_MSG("Members handle is null");
-    return nullptr;
-  }
-
-  return allocate_message<GET_TYPENAME(members->response_members_)>(
-    static_cast<const void *>(members->response_members_),
-    static_cast<const uint8_t *>(ros_response),
-    size,
-    true
-  );
-}
-
-template<typename ServiceMembersT>
-void *
-allocate_request_enhanced(
-  const void * untyped_members,
-  const void * ros_request,
-  size_t * size)
-{
-  auto members = static_cast<const ServiceMembersT *>(untyped_members);
-  if (members == nullptr) {
-    RMW_SET_ERROR_MSG("Members handle is null");
-    return nullptr;
-  }
-
-  return allocate_message<GET_TYPENAME(members->request_members_)>(
-    static_cast<const void *>(members->request_members_),
-    static_cast<const uint8_t *>(ros_request),
-    size,
-    false
-  );
-}
-
-template<typename ServiceMembersT>
-void *
-allocate_response_enhanced(
-  const void * untyped_members,
-  const void * ros_response,
-  size_t * size)
-{
-  auto members = static_cast<const ServiceMembersT *>(untyped_members);
-  if (members == nullptr) {
-    RMW_SET_ERROR_MSG("Members handle is null");
-    return nullptr;
-  }
-
-  return allocate_message<GET_TYPENAME(members->response_members_)>(
-    static_cast<const void *>(members->response_members_),
-    static_cast<const uint8_t *>(ros_response),
-    size,
-    false
-  );
-}
-
 template<typename MessageMembersT>
 bool
 serialize_service_basic(
   const void * untyped_members,
   const uint8_t * ros_service,
-  uint8_t * dds_service,
-  size_t size,
+  CdrGrowableStorage & dds_service,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid,
   bool is_request)
@@ -164,8 +80,9 @@ serialize_service_basic(
   int32_t sn_high = static_cast<int32_t>((sequence_number & 0xFFFFFFFF00000000LL) >> 8);
   uint32_t sn_low = static_cast<uint32_t>(sequence_number & 0x00000000FFFFFFFFLL);
 
+  RMW_GURUMDDS_TRACEPOINT(serialize_begin, ros_service);
   try {
-    rmw_gurumdds_cpp::CdrSerializationBuffer<true> buffer{dds_service, size};
+    rmw_gurumdds_cpp::CdrSerializationBuffer<true> buffer{dds_service};
     rmw_gurumdds_cpp::MessageSerializer<true, MessageMembersT> serializer{buffer};
     buffer << *(reinterpret_cast<const uint64_t *>(client_guid));
     buffer << *(reinterpret_cast<const uint64_t *>(client_guid + 8));
@@ -179,11 +96,13 @@ serialize_service_basic(
       buffer << *(reinterpret_cast<uint32_t *>(&remoteEx));
     }
     serializer.serialize(members, ros_service, true);
+    *size = buffer.get_serialized_size();
   } catch (std::runtime_error & e) {
     RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to serialize ros message: %s", e.what());
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(serialize_end, ros_service, *size);
   return true;
 }
 
@@ -192,8 +111,8 @@ bool
 serialize_request_basic(
   const void * untyped_members,
   const uint8_t * ros_request,
-  uint8_t * dds_request,
-  size_t size,
+  CdrGrowableStorage & dds_request,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid)
 {
@@ -219,8 +138,8 @@ bool
 serialize_response_basic(
   const void * untyped_members,
   const uint8_t * ros_response,
-  uint8_t * dds_response,
-  size_t size,
+  CdrGrowableStorage & dds_response,
+  size_t * size,
   int64_t sequence_number,
   const uint8_t * client_guid)
 {
@@ -246,8 +165,8 @@ bool
 serialize_service_enhanced(
   const void * untyped_members,
   const uint8_t * ros_service,
-  uint8_t * dds_service,
-  size_t size)
+  CdrGrowableStorage & dds_service,
+  size_t * size)
 {
   auto members =
     static_cast<const MessageMembersT *>(untyped_members);
@@ -256,15 +175,18 @@ serialize_service_enhanced(
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(serialize_begin, ros_service);
   try {
-    rmw_gurumdds_cpp::CdrSerializationBuffer<true> buffer{dds_service, size};
+    rmw_gurumdds_cpp::CdrSerializationBuffer<true> buffer{dds_service};
     rmw_gurumdds_cpp::MessageSerializer<true, MessageMembersT> serializer{buffer};
     serializer.serialize(members, ros_service, true);
+    *size = buffer.get_serialized_size();
   } catch (std::runtime_error & e) {
     RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to serialize ros message: %s", e.what());
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(serialize_end, ros_service, *size);
   return true;
 }
 
@@ -273,8 +195,8 @@ bool
 serialize_request_enhanced(
   const void * untyped_members,
   const uint8_t * ros_request,
-  uint8_t * dds_request,
-  size_t size)
+  CdrGrowableStorage & dds_request,
+  size_t * size)
 {
   auto members = static_cast<const ServiceMembersT *>(untyped_members);
   if (members == nullptr) {
@@ -295,8 +217,8 @@ bool
 serialize_response_enhanced(
   const void * untyped_members,
   const uint8_t * ros_response,
-  uint8_t * dds_response,
-  size_t size)
+  CdrGrowableStorage & dds_response,
+  size_t * size)
 {
   auto members = static_cast<const ServiceMembersT *>(untyped_members);
   if (members == nullptr) {
@@ -331,6 +253,7 @@ deserialize_service_basic(
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(deserialize_begin, ros_service, size);
   try {
     auto buffer = rmw_gurumdds_cpp::CdrDeserializationBuffer(dds_service, size);
     auto deserializer = rmw_gurumdds_cpp::MessageDeserializer<MessageMembersT>(buffer);
@@ -351,6 +274,7 @@ deserialize_service_basic(
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(deserialize_end, ros_service);
   return true;
 }
 
@@ -427,6 +351,7 @@ deserialize_service_enhanced(
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(deserialize_begin, ros_service, size);
   try {
     auto buffer = rmw_gurumdds_cpp::CdrDeserializationBuffer(dds_service, size);
     auto deserializer = rmw_gurumdds_cpp::MessageDeserializer<MessageMembersT>(buffer);
@@ -436,6 +361,7 @@ deserialize_service_enhanced(
     return false;
   }
 
+  RMW_GURUMDDS_TRACEPOINT(deserialize_end, ros_service);
   return true;
 }
 
@@ -0,0 +1,43 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__USER_DATA_HPP_
+#define RMW_GURUMDDS__USER_DATA_HPP_
+
+#include <cstddef>
+#include <string_view>
+
+#include "rmw/ret_types.h"
+
+#include "rosidl_runtime_c/type_hash.h"
+
+namespace rmw_gurumdds_cpp
+{
+// Finds the value of a key in user data formatted as "key=value;...", pointing into the data
+bool find_user_data_value(
+  const void * data,
+  size_t size,
+  std::string_view key,
+  std::string_view & value);
+
+// Like rmw_dds_common::parse_type_hash_from_user_data, without copying the user data.
+// A zero initialized hash is returned if the user data has no type hash
+rmw_ret_t parse_type_hash_from_user_data(
+  const void * data,
+  size_t size,
+  rosidl_type_hash_t & type_hash);
+} // namespace rmw_gurumdds_cpp
+
+#endif // RMW_GURUMDDS__USER_DATA_HPP_
@@ -15,17 +15,59 @@
 #ifndef RMW_GURUMDDS__WAIT_HPP_
 #define RMW_GURUMDDS__WAIT_HPP_
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "rmw/rmw.h"
 
+#include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/endpoint_stats.hpp"
+
 namespace rmw_gurumdds_cpp
 {
+// State of a condition in a wait set, the counters hold the number of a wait
+struct WaitSetCondition
+{
+  // Last wait the condition was passed to
+  uint64_t used {0};
+  // Last wait that returned the condition as active
+  uint64_t active {0};
+  // Statuses enabled on a status condition by the last wait
+  dds_StatusMask mask {0};
+  bool attached {false};
+};
+
 struct WaitSetInfo
 {
   dds_WaitSet * wait_set;
   dds_ConditionSeq * active_conditions;
   dds_ConditionSeq * attached_conditions;
+
+  std::mutex mutex;
+  // Conditions are left attached between waits, executors wait on nearly the same set every time
+  std::unordered_map<dds_Condition *, WaitSetCondition> conditions;
+  // Scratch list of the event conditions of a wait
+  std::vector<dds_Condition *> event_conditions;
+  uint64_t wait_count {0};
+  // Strategy of the context the wait set was created in
+  bool use_polling {false};
+  uint64_t spin_ns {0};
+  bool in_use {false};
+  // Set when an entity is destroyed during a wait, the wait set is emptied on the next wait
+  bool stale {false};
+  WaitSetCounters stats;
 };
 
+// Wait sets created by rmw_create_wait_set keep their conditions attached between waits
+void register_wait_set(WaitSetInfo * wait_set_info);
+
+// Detaches the conditions left attached, before the wait set is deleted
+void unregister_wait_set(WaitSetInfo * wait_set_info);
+
+// Detaches all conditions of the registered wait sets, called before a waitable entity is deleted
+void clean_wait_set_caches();
+
 rmw_ret_t
 wait(
   const char * implementation_identifier,
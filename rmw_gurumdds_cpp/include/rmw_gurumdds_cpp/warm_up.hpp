@@ -0,0 +1,53 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_GURUMDDS__WARM_UP_HPP_
+#define RMW_GURUMDDS__WARM_UP_HPP_
+
+#include <cstddef>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_gurumdds_cpp/visibility_control.h"
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Sizes the buffers of an endpoint before a control loop starts, so that its
+ * first writes and takes neither allocate nor fault in fresh pages. Buffers
+ * are backed by the memory RMW_GURUMDDS_BUFFER_MEMORY selects, pre-faulted
+ * and mlocked unless it is the heap. A `max_serialized_size` of 0 uses the
+ * bound of the type, see rmw_get_serialized_message_size; unbounded types
+ * return RMW_RET_INVALID_ARGUMENT.
+ */
+// Creates `buffer_count` message buffers and loaned messages of the publisher, and as many
+// buffers for the samples it hands to the subscriptions of the context
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+warm_up_publisher(
+  const rmw_publisher_t * publisher,
+  size_t buffer_count,
+  size_t max_serialized_size);
+
+// Sizes the arena of an allocation used by take_arena_message, see arena_take.hpp
+RMW_GURUMDDS_CPP_PUBLIC
+rmw_ret_t
+warm_up_subscription_allocation(
+  const rmw_subscription_t * subscription,
+  rmw_subscription_allocation_t * allocation,
+  size_t max_serialized_size);
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__WARM_UP_HPP_
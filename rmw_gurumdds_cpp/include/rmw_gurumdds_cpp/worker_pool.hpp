@@ -0,0 +1,74 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RMW_GURUMDDS__WORKER_POOL_HPP_
+#define RMW_GURUMDDS__WORKER_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rmw_gurumdds_cpp
+{
+/**
+ * Small set of threads that run the iterations of a loop in parallel with
+ * the calling thread. Only one loop runs on the workers at a time; a caller
+ * that finds them busy runs its loop by itself.
+ */
+class WorkerPool {
+public:
+  WorkerPool() = default;
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+
+  WorkerPool & operator=(const WorkerPool &) = delete;
+
+  // Starts the worker threads. False if a thread could not be created
+  bool start(size_t thread_count);
+
+  size_t get_thread_count() const;
+
+  // Calls fn(i) for every i in [0, count), returns when all the calls are done
+  void parallel_for(size_t count, const std::function<void(size_t)> & fn);
+
+private:
+  void run_worker();
+
+  void run_job(const std::function<void(size_t)> & fn, size_t count);
+
+  std::mutex mutex_;
+  std::condition_variable work_cond_;
+  std::condition_variable done_cond_;
+  std::vector<std::thread> threads_;
+  const std::function<void(size_t)> * job_ {nullptr};
+  size_t job_count_ {0};
+  std::atomic<size_t> next_ {0};
+  size_t active_ {0};
+  uint64_t generation_ {0};
+  bool stop_ {false};
+
+  // Held by the caller whose loop is on the workers
+  std::mutex job_mutex_;
+};
+} // namespace rmw_gurumdds_cpp
+
+#endif  // RMW_GURUMDDS__WORKER_POOL_HPP_
@@ -0,0 +1,379 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <system_error>
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
+
+#include "rmw_gurumdds_cpp/async_publish.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/thread_settings.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+static uint64_t steady_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+rmw_ret_t
+get_async_publish_status(const rmw_publisher_t * publisher, AsyncPublishStatus * status)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(status, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+  if (publisher_info->async == nullptr) {
+    RMW_SET_ERROR_MSG("publisher does not publish asynchronously");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  publisher_info->async->get_status(*status);
+  return RMW_RET_OK;
+}
+
+bool AsyncSampleQueue::init(size_t capacity)
+{
+  cells_.reset(new(std::nothrow) Cell[capacity]);
+  if (cells_ == nullptr) {
+    return false;
+  }
+
+  for (size_t i = 0; i < capacity; i++) {
+    cells_[i].position.store(i, std::memory_order_relaxed);
+  }
+  capacity_ = capacity;
+  return true;
+}
+
+bool AsyncSampleQueue::push(const AsyncSample & sample)
+{
+  size_t position = tail_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell & cell = cells_[position % capacity_];
+    const size_t expected = cell.position.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(expected - position);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        cell.sample = sample;
+        cell.position.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // The cell still holds the sample of the previous lap
+      return false;
+    } else {
+      position = tail_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncSampleQueue::pop(AsyncSample & sample)
+{
+  const size_t position = head_.load(std::memory_order_relaxed);
+  Cell & cell = cells_[position % capacity_];
+  const size_t expected = cell.position.load(std::memory_order_acquire);
+  if (static_cast<std::ptrdiff_t>(expected - (position + 1)) < 0) {
+    return false;
+  }
+
+  sample = cell.sample;
+  cell.position.store(position + capacity_, std::memory_order_release);
+  head_.store(position + 1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t AsyncSampleQueue::size() const
+{
+  const size_t head = head_.load(std::memory_order_relaxed);
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  return tail > head ? tail - head : 0;
+}
+
+size_t AsyncSampleQueue::capacity() const
+{
+  return capacity_;
+}
+
+AsyncPublisher::AsyncPublisher(
+  dds_DataWriter * writer, MessageBufferPool * buffers, const AsyncPublishSettings & settings,
+  AsyncPublishSender * sender)
+: writer_{writer}, buffers_{buffers}, settings_{settings}, sender_{sender}
+{
+}
+
+bool AsyncPublisher::init()
+{
+  tokens_ = static_cast<int64_t>(settings_.burst_bytes);
+  refill_ns_ = steady_time_ns();
+  return queue_.init(settings_.queue_depth);
+}
+
+rmw_ret_t AsyncPublisher::enqueue(
+  MessageBuffer * buffer, size_t size, const dds_SampleInfoEx & info)
+{
+  AsyncSample sample;
+  sample.buffer = buffer;
+  sample.size = size;
+  sample.info = info;
+
+  pending_.fetch_add(1);
+  if (!queue_.push(sample)) {
+    if (!settings_.block_when_full) {
+      pending_.fetch_sub(1);
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      buffers_->release(buffer);
+      return RMW_RET_OK;
+    }
+
+    // The sender notifies the waiters after it pops, which the increment is ordered with
+    std::unique_lock<std::mutex> lock{mutex_};
+    waiters_.fetch_add(1);
+    cond_.wait(lock, [this, &sample]() {return queue_.push(sample);});
+    waiters_.fetch_sub(1);
+  }
+
+  sender_->notify();
+  return RMW_RET_OK;
+}
+
+bool AsyncPublisher::send(uint64_t now_ns, uint64_t & resume_ns)
+{
+  const uint64_t rate = settings_.bytes_per_second;
+  if (rate == 0) {
+    return flush();
+  }
+
+  const auto burst = static_cast<int64_t>(settings_.burst_bytes);
+  if (now_ns > refill_ns_) {
+    // Capped first, so that the product does not overflow after a long idle period
+    const uint64_t elapsed = now_ns - refill_ns_;
+    const auto missing = static_cast<uint64_t>(burst - tokens_);
+    if (elapsed >= missing * 1000000000ull / rate) {
+      tokens_ = burst;
+    } else {
+      tokens_ += static_cast<int64_t>(elapsed * rate / 1000000000ull);
+    }
+    refill_ns_ = now_ns;
+  }
+
+  AsyncSample sample;
+  size_t count = 0;
+  while (count < queue_.capacity() && tokens_ > 0 && queue_.pop(sample)) {
+    tokens_ -= static_cast<int64_t>(sample.size);
+    write(sample);
+    count++;
+  }
+
+  if (tokens_ <= 0 && queue_.size() > 0) {
+    throttled_count_.fetch_add(1, std::memory_order_relaxed);
+    const auto debt = static_cast<uint64_t>(1 - tokens_);
+    resume_ns = std::min<uint64_t>(resume_ns, now_ns + (debt * 1000000000ull + rate - 1) / rate);
+  }
+
+  if (count > 0) {
+    notify_written();
+  }
+  return count > 0;
+}
+
+bool AsyncPublisher::flush()
+{
+  // At most one lap of the queue, so that a busy publisher does not starve the others
+  AsyncSample sample;
+  size_t count = 0;
+  while (count < queue_.capacity() && queue_.pop(sample)) {
+    write(sample);
+    count++;
+  }
+
+  if (count > 0) {
+    notify_written();
+  }
+  return count > 0;
+}
+
+bool AsyncPublisher::drain(uint64_t timeout_ns)
+{
+  if (pending_.load() == 0) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  waiters_.fetch_add(1);
+  auto drained = [this]() {return pending_.load() == 0;};
+  bool result = true;
+  if (timeout_ns == UINT64_MAX) {
+    cond_.wait(lock, drained);
+  } else {
+    result = cond_.wait_for(lock, std::chrono::nanoseconds(timeout_ns), drained);
+  }
+  waiters_.fetch_sub(1);
+  return result;
+}
+
+void AsyncPublisher::get_status(AsyncPublishStatus & status) const
+{
+  status.queue_depth = queue_.size();
+  status.queue_capacity = queue_.capacity();
+  status.sent_count = sent_count_.load(std::memory_order_relaxed);
+  status.dropped_count = dropped_count_.load(std::memory_order_relaxed);
+  status.failed_count = failed_count_.load(std::memory_order_relaxed);
+  status.throttled_count = throttled_count_.load(std::memory_order_relaxed);
+}
+
+int AsyncPublisher::get_priority() const
+{
+  return settings_.priority;
+}
+
+void AsyncPublisher::write(const AsyncSample & sample)
+{
+  dds_SampleInfoEx info = sample.info;
+  dds_ReturnCode_t ret = dds_DataWriter_raw_write_w_sampleinfoex(
+    writer_, sample.buffer->data(), static_cast<uint32_t>(sample.size), &info);
+  if (ret != dds_RETCODE_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      RMW_GURUMDDS_ID, "failed to publish data: %s, %d", dds_ReturnCode_to_string(ret),
+      static_cast<int>(ret));
+    failed_count_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    sent_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  buffers_->release(sample.buffer);
+  pending_.fetch_sub(1);
+}
+
+void AsyncPublisher::notify_written()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load() > 0) {
+    std::lock_guard<std::mutex> guard{mutex_};
+    cond_.notify_all();
+  }
+}
+
+AsyncPublishSender::AsyncPublishSender(const ThreadSettings & settings)
+: settings_{settings}
+{
+}
+
+AsyncPublishSender::~AsyncPublishSender()
+{
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    stop_ = true;
+  }
+  cond_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool AsyncPublishSender::start()
+{
+  try {
+    thread_ = std::thread(&AsyncPublishSender::run, this);
+  } catch (const std::system_error &) {
+    return false;
+  }
+
+  return true;
+}
+
+void AsyncPublishSender::add(AsyncPublisher * publisher)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  publishers_.push_back(publisher);
+}
+
+void AsyncPublishSender::remove(AsyncPublisher * publisher)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  publishers_.erase(
+    std::remove(publishers_.begin(), publishers_.end(), publisher), publishers_.end());
+}
+
+void AsyncPublishSender::notify()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!sleeping_.load()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    woken_ = true;
+  }
+  cond_.notify_one();
+}
+
+void AsyncPublishSender::run()
+{
+  settings_.apply();
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (!stop_) {
+    bool sent = false;
+    uint64_t now = steady_time_ns();
+    // Earliest time a bandwidth-limited publisher has tokens again, UINT64_MAX if none waits
+    uint64_t resume = UINT64_MAX;
+    for (AsyncPublisher * publisher : publishers_) {
+      sent |= publisher->send(now, resume);
+    }
+    if (sent) {
+      // Lets publishers be added and removed while the queues are busy
+      lock.unlock();
+      lock.lock();
+      continue;
+    }
+
+    // A sample enqueued before the flag is set is seen by the second look at the queues
+    sleeping_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    now = steady_time_ns();
+    resume = UINT64_MAX;
+    for (AsyncPublisher * publisher : publishers_) {
+      sent |= publisher->send(now, resume);
+    }
+    if (!sent) {
+      auto woken = [this]() {return stop_ || woken_;};
+      if (resume == UINT64_MAX) {
+        cond_.wait(lock, woken);
+      } else {
+        cond_.wait_until(
+          lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(resume)), woken);
+      }
+    }
+    woken_ = false;
+    sleeping_.store(false);
+  }
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,154 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw_gurumdds_cpp/buffer_memory.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+bool parse_buffer_memory(const char * name, int & memory)
+{
+  if (std::strcmp(name, "heap") == 0) {
+    memory = BUFFER_MEMORY_HEAP;
+    return true;
+  }
+  if (std::strcmp(name, "locked") == 0) {
+    memory = BUFFER_MEMORY_LOCKED;
+    return true;
+  }
+  if (std::strcmp(name, "hugepages") == 0) {
+    memory = BUFFER_MEMORY_HUGEPAGES;
+    return true;
+  }
+  return false;
+}
+
+#if !defined(_WIN32)
+static size_t
+round_up(size_t size, size_t granularity)
+{
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+// The size of a buffer depends only on the requested size, whether huge pages are reserved or
+// not, so that buffers of the same size can be unmapped with that size
+static size_t
+get_mapped_size(int memory, size_t size)
+{
+  if (memory == BUFFER_MEMORY_HUGEPAGES && size >= BUFFER_MEMORY_HUGEPAGE_SIZE / 2) {
+    return round_up(size, BUFFER_MEMORY_HUGEPAGE_SIZE);
+  }
+  return round_up(size > 0 ? size : 1, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+static uint8_t *
+map_pages(int memory, size_t mapped_size)
+{
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+  flags |= MAP_POPULATE;
+#endif
+  const bool huge = memory == BUFFER_MEMORY_HUGEPAGES &&
+    mapped_size % BUFFER_MEMORY_HUGEPAGE_SIZE == 0;
+#if defined(MAP_HUGETLB)
+  if (huge) {
+    void * data =
+      mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      return static_cast<uint8_t *>(data);
+    }
+    RCUTILS_LOG_WARN_ONCE_NAMED(
+      RMW_GURUMDDS_ID, "no huge pages reserved, falling back to transparent huge pages: %s",
+      strerror(errno));
+  }
+#endif
+
+  void * data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+#if defined(MADV_HUGEPAGE)
+  if (huge) {
+    madvise(data, mapped_size, MADV_HUGEPAGE);
+  }
+#else
+  (void)huge;
+#endif
+  return static_cast<uint8_t *>(data);
+}
+#endif
+
+uint8_t * allocate_buffer_memory(int memory, size_t size, size_t * allocated_size)
+{
+#if !defined(_WIN32)
+  if (memory != BUFFER_MEMORY_HEAP) {
+    const size_t mapped_size = get_mapped_size(memory, size);
+    uint8_t * data = map_pages(memory, mapped_size);
+    if (data == nullptr) {
+      return nullptr;
+    }
+    *allocated_size = mapped_size;
+
+    if (mlock(data, *allocated_size) != 0) {
+      RCUTILS_LOG_WARN_ONCE_NAMED(
+        RMW_GURUMDDS_ID, "failed to lock buffer memory, check RLIMIT_MEMLOCK: %s",
+        strerror(errno));
+    }
+    // Faults in the pages that MAP_POPULATE or mlock did not
+    std::memset(data, 0, *allocated_size);
+    return data;
+  }
+#endif
+
+  auto data = static_cast<uint8_t *>(malloc(size > 0 ? size : 1));
+  if (data == nullptr) {
+    return nullptr;
+  }
+  *allocated_size = size;
+  if (memory != BUFFER_MEMORY_HEAP) {
+    // Pages cannot be locked here, they are only pre-faulted
+    std::memset(data, 0, size);
+  }
+  return data;
+}
+
+void free_buffer_memory(int memory, uint8_t * data, size_t allocated_size)
+{
+  if (data == nullptr) {
+    return;
+  }
+#if !defined(_WIN32)
+  if (memory != BUFFER_MEMORY_HEAP) {
+    // Unmapping also unlocks the pages
+    munmap(data, allocated_size);
+    return;
+  }
+#else
+  (void)memory;
+#endif
+  (void)allocated_size;
+  free(data);
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,191 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RMW_GURUMDDS_BOOL_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define RMW_GURUMDDS_BOOL_NEON
+#include <arm_neon.h>
+#endif
+
+// libstdc++ exposes the words of std::vector<bool>, other libraries go bit by bit
+#if defined(__GLIBCXX__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define RMW_GURUMDDS_BOOL_WORDS
+#endif
+
+#include "rmw_gurumdds_cpp/cdr_bool.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+namespace
+{
+static_assert(sizeof(bool) == 1, "booleans are copied as bytes");
+
+using NormalizeFn = void (*)(uint8_t * dst, const uint8_t * src, size_t cnt);
+
+struct BoolKernels
+{
+  const char * name;
+  NormalizeFn normalize;
+};
+
+void normalize_scalar(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  for (size_t i = 0; i < cnt; i++) {
+    dst[i] = (src[i] != 0);
+  }
+}
+
+#if defined(RMW_GURUMDDS_BOOL_X86)
+// SSE2 is part of x86-64, min(byte, 1) maps every non-zero byte to 1
+void normalize_sse2(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  const __m128i one = _mm_set1_epi8(1);
+  size_t i = 0;
+  for (; i + 16 <= cnt; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_min_epu8(block, one));
+  }
+  normalize_scalar(dst + i, src + i, cnt - i);
+}
+
+__attribute__((target("avx2")))
+void normalize_avx2(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  const __m256i one = _mm256_set1_epi8(1);
+  size_t i = 0;
+  for (; i + 32 <= cnt; i += 32) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_min_epu8(block, one));
+  }
+  normalize_sse2(dst + i, src + i, cnt - i);
+}
+#endif
+
+#if defined(RMW_GURUMDDS_BOOL_NEON)
+void normalize_neon(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  const uint8x16_t one = vdupq_n_u8(1);
+  size_t i = 0;
+  for (; i + 16 <= cnt; i += 16) {
+    vst1q_u8(dst + i, vminq_u8(vld1q_u8(src + i), one));
+  }
+  normalize_scalar(dst + i, src + i, cnt - i);
+}
+#endif
+
+BoolKernels select_kernels()
+{
+#if defined(RMW_GURUMDDS_BOOL_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {"avx2", &normalize_avx2};
+  }
+  return {"sse2", &normalize_sse2};
+#elif defined(RMW_GURUMDDS_BOOL_NEON)
+  return {"neon", &normalize_neon};
+#else
+  return {"scalar", &normalize_scalar};
+#endif
+}
+
+const BoolKernels & get_kernels()
+{
+  static const BoolKernels kernels = select_kernels();
+  return kernels;
+}
+
+#if defined(RMW_GURUMDDS_BOOL_WORDS)
+using BitWord = std::_Bit_type;
+constexpr size_t BITS_PER_WORD = sizeof(BitWord) * 8;
+
+// Eight one byte booleans, 0 or 1, for each value of a byte of bits
+constexpr std::array<uint64_t, 256> make_unpack_table()
+{
+  std::array<uint64_t, 256> table {};
+  for (size_t bits = 0; bits < table.size(); bits++) {
+    for (size_t i = 0; i < 8; i++) {
+      table[bits] |= static_cast<uint64_t>((bits >> i) & 1) << (i * 8);
+    }
+  }
+  return table;
+}
+
+constexpr std::array<uint64_t, 256> UNPACK_TABLE = make_unpack_table();
+
+// Packs eight one byte booleans, loaded as a little-endian word, into a byte of bits
+inline uint64_t pack_bytes(uint64_t bytes)
+{
+  // Sets the high bit of every non-zero byte, then moves it to the low bit
+  const uint64_t low = 0x7f7f7f7f7f7f7f7full;
+  bytes = ((((bytes & low) + low) | bytes) & ~low) >> 7;
+  return (bytes * 0x0102040810204080ull) >> 56;
+}
+#endif
+} // namespace
+
+void copy_bool_normalized(void * dst, const void * src, size_t cnt)
+{
+  get_kernels().normalize(static_cast<uint8_t *>(dst), static_cast<const uint8_t *>(src), cnt);
+}
+
+void copy_bool_vector_to_bytes(uint8_t * dst, const std::vector<bool> & src)
+{
+  const size_t size = src.size();
+  size_t i = 0;
+#if defined(RMW_GURUMDDS_BOOL_WORDS)
+  const BitWord * words = src.begin()._M_p;
+  for (; i + BITS_PER_WORD <= size; i += BITS_PER_WORD) {
+    BitWord word = words[i / BITS_PER_WORD];
+    for (size_t byte = 0; byte < sizeof(BitWord); byte++) {
+      std::memcpy(dst + i + byte * 8, &UNPACK_TABLE[(word >> (byte * 8)) & 0xff], 8);
+    }
+  }
+#endif
+  for (; i < size; i++) {
+    dst[i] = src[i];
+  }
+}
+
+void copy_bytes_to_bool_vector(std::vector<bool> & dst, const uint8_t * src)
+{
+  const size_t size = dst.size();
+  size_t i = 0;
+#if defined(RMW_GURUMDDS_BOOL_WORDS)
+  BitWord * words = dst.begin()._M_p;
+  for (; i + BITS_PER_WORD <= size; i += BITS_PER_WORD) {
+    BitWord word = 0;
+    for (size_t byte = 0; byte < sizeof(BitWord); byte++) {
+      uint64_t bytes;
+      std::memcpy(&bytes, src + i + byte * 8, 8);
+      word |= static_cast<BitWord>(pack_bytes(bytes)) << (byte * 8);
+    }
+    words[i / BITS_PER_WORD] = word;
+  }
+#endif
+  for (; i < size; i++) {
+    dst[i] = (src[i] != 0);
+  }
+}
+
+const char * get_bool_kernel_name()
+{
+  return get_kernels().name;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,199 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RMW_GURUMDDS_BSWAP_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define RMW_GURUMDDS_BSWAP_NEON
+#include <arm_neon.h>
+#endif
+
+#include "rmw_gurumdds_cpp/cdr_bswap.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+namespace
+{
+using BswapFn = void (*)(uint8_t * dst, const uint8_t * src, size_t cnt);
+
+struct BswapKernels
+{
+  const char * name;
+  BswapFn copy16;
+  BswapFn copy32;
+  BswapFn copy64;
+};
+
+inline uint16_t bswap(uint16_t data)
+{
+  return bswap16(data);
+}
+
+inline uint32_t bswap(uint32_t data)
+{
+  return bswap32(data);
+}
+
+inline uint64_t bswap(uint64_t data)
+{
+  return bswap64(data);
+}
+
+template<typename T>
+void bswap_copy_scalar(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  for (size_t i = 0; i < cnt; i++) {
+    T value;
+    std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+    value = bswap(value);
+    std::memcpy(dst + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+// Byte shuffle reversing each `sizeof(T)` wide element of a 32 byte block
+template<typename T>
+constexpr std::array<uint8_t, 32> make_shuffle_mask()
+{
+  std::array<uint8_t, 32> mask {};
+  for (size_t i = 0; i < mask.size(); i++) {
+    // Shuffles index within a 16 byte lane
+    size_t lane_index = i % 16;
+    mask[i] = static_cast<uint8_t>(
+      lane_index - lane_index % sizeof(T) + (sizeof(T) - 1 - lane_index % sizeof(T)));
+  }
+  return mask;
+}
+
+template<typename T>
+struct ShuffleMask
+{
+  alignas(32) static constexpr std::array<uint8_t, 32> value = make_shuffle_mask<T>();
+};
+
+#if defined(RMW_GURUMDDS_BSWAP_X86)
+template<typename T>
+__attribute__((target("ssse3")))
+void bswap_copy_ssse3(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(ShuffleMask<T>::value.data()));
+  size_t bytes = cnt * sizeof(T);
+  size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(block, mask));
+  }
+  bswap_copy_scalar<T>(dst + i, src + i, (bytes - i) / sizeof(T));
+}
+
+template<typename T>
+__attribute__((target("avx2")))
+void bswap_copy_avx2(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i *>(ShuffleMask<T>::value.data()));
+  size_t bytes = cnt * sizeof(T);
+  size_t i = 0;
+  for (; i + 64 <= bytes; i += 64) {
+    __m256i block0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(block0, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), _mm256_shuffle_epi8(block1, mask));
+  }
+  for (; i + 32 <= bytes; i += 32) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(block, mask));
+  }
+  bswap_copy_scalar<T>(dst + i, src + i, (bytes - i) / sizeof(T));
+}
+#endif
+
+#if defined(RMW_GURUMDDS_BSWAP_NEON)
+inline uint8x16_t bswap_block(uint8x16_t block, uint16_t)
+{
+  return vrev16q_u8(block);
+}
+
+inline uint8x16_t bswap_block(uint8x16_t block, uint32_t)
+{
+  return vrev32q_u8(block);
+}
+
+inline uint8x16_t bswap_block(uint8x16_t block, uint64_t)
+{
+  return vrev64q_u8(block);
+}
+
+template<typename T>
+void bswap_copy_neon(uint8_t * dst, const uint8_t * src, size_t cnt)
+{
+  size_t bytes = cnt * sizeof(T);
+  size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    vst1q_u8(dst + i, bswap_block(vld1q_u8(src + i), T{}));
+  }
+  bswap_copy_scalar<T>(dst + i, src + i, (bytes - i) / sizeof(T));
+}
+#endif
+
+BswapKernels select_kernels()
+{
+#if defined(RMW_GURUMDDS_BSWAP_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {"avx2", &bswap_copy_avx2<uint16_t>, &bswap_copy_avx2<uint32_t>,
+      &bswap_copy_avx2<uint64_t>};
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return {"ssse3", &bswap_copy_ssse3<uint16_t>, &bswap_copy_ssse3<uint32_t>,
+      &bswap_copy_ssse3<uint64_t>};
+  }
+#elif defined(RMW_GURUMDDS_BSWAP_NEON)
+  return {"neon", &bswap_copy_neon<uint16_t>, &bswap_copy_neon<uint32_t>,
+    &bswap_copy_neon<uint64_t>};
+#endif
+  return {"scalar", &bswap_copy_scalar<uint16_t>, &bswap_copy_scalar<uint32_t>,
+    &bswap_copy_scalar<uint64_t>};
+}
+
+const BswapKernels & get_kernels()
+{
+  static const BswapKernels kernels = select_kernels();
+  return kernels;
+}
+} // namespace
+
+void bswap_copy16(void * dst, const void * src, size_t cnt)
+{
+  get_kernels().copy16(static_cast<uint8_t *>(dst), static_cast<const uint8_t *>(src), cnt);
+}
+
+void bswap_copy32(void * dst, const void * src, size_t cnt)
+{
+  get_kernels().copy32(static_cast<uint8_t *>(dst), static_cast<const uint8_t *>(src), cnt);
+}
+
+void bswap_copy64(void * dst, const void * src, size_t cnt)
+{
+  get_kernels().copy64(static_cast<uint8_t *>(dst), static_cast<const uint8_t *>(src), cnt);
+}
+
+const char * get_bswap_kernel_name()
+{
+  return get_kernels().name;
+}
+} // namespace rmw_gurumdds_cpp
@@ -13,10 +13,35 @@
 // limitations under the License.
 
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+
 #include "rmw_gurumdds_cpp/cdr_buffer.hpp"
 
 namespace rmw_gurumdds_cpp
 {
+static uint8_t read_cdr_output_endian()
+{
+  static constexpr const char * env_name = "RMW_GURUMDDS_CDR_ENDIAN";
+  const char * env_value = getenv(env_name);
+  if (nullptr != env_value) {
+    if (strcmp(env_value, "little") == 0) {
+      return CDR_LITTLE_ENDIAN;
+    }
+    if (strcmp(env_value, "big") == 0) {
+      return CDR_BIG_ENDIAN;
+    }
+  }
+
+  return CDR_SYSTEM_ENDIAN;
+}
+
+uint8_t get_cdr_output_endian()
+{
+  static const uint8_t endian = read_cdr_output_endian();
+  return endian;
+}
+
 CdrBuffer::CdrBuffer(uint8_t * buf, size_t size)
   : buf_{buf}
   , offset_{}
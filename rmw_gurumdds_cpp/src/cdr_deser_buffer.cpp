@@ -13,34 +13,12 @@
 // limitations under the License.
 
 #include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+#include "rmw_gurumdds_cpp/cdr_bool.hpp"
+#include "rmw_gurumdds_cpp/cdr_bswap.hpp"
+#include "rmw_gurumdds_cpp/deserialization_arena.hpp"
 
 namespace rmw_gurumdds_cpp
 {
-static uint16_t bswap16(uint16_t data)
-{
-  return (data >> 8) | (data << 8);
-}
-
-static uint32_t bswap32(uint32_t data)
-{
-  return (data >> 24) |
-         ((data >> 8) & 0x0000ff00) |
-         ((data << 8) & 0x00ff0000) |
-         (data << 24);
-}
-
-static uint64_t bswap64(uint64_t data)
-{
-  return (data >> 56) |
-         ((data >> 40) & 0x000000000000ff00ull) |
-         ((data >> 24) & 0x0000000000ff0000ull) |
-         ((data >> 8) & 0x00000000ff000000ull) |
-         ((data << 8) & 0x000000ff00000000ull) |
-         ((data << 24) & 0x0000ff0000000000ull) |
-         ((data << 40) & 0x00ff000000000000ull) |
-         (data << 56);
-}
-
 CdrDeserializationBuffer::CdrDeserializationBuffer(uint8_t * buf, size_t size)
   : CdrBuffer{buf, size} {
   if (size < CDR_HEADER_SIZE) {
@@ -52,6 +30,32 @@ CdrDeserializationBuffer::CdrDeserializationBuffer(uint8_t * buf, size_t size)
   offset_ = 0;
 }
 
+bool CdrDeserializationBuffer::needs_swap() const {
+  return swap_;
+}
+
+void CdrDeserializationBuffer::seek(size_t offset) {
+  if (offset > size_) {
+    throw std::runtime_error("Out of buffer");
+  }
+  offset_ = offset;
+}
+
+void CdrDeserializationBuffer::skip(size_t cnt) {
+  if (cnt > size_ - offset_) {
+    throw std::runtime_error("Out of buffer");
+  }
+  advance(cnt);
+}
+
+void CdrDeserializationBuffer::set_arena(DeserializationArena * arena) {
+  arena_ = arena;
+}
+
+DeserializationArena * CdrDeserializationBuffer::get_arena() const {
+  return arena_;
+}
+
 void CdrDeserializationBuffer::operator>>(uint8_t & dst) {
   roundup(sizeof(uint8_t));
   if (offset_ + sizeof(uint8_t) > size_) {
@@ -102,7 +106,7 @@ void CdrDeserializationBuffer::operator>>(std::string & dst) {
     *this >> str_size;
     roundup(sizeof(char));  // align of char
     if (str_size == 0) {
-      dst = std::string{};
+      dst.clear();
       return;
     }
     if (offset_ + str_size > size_) {
@@ -114,7 +118,8 @@ void CdrDeserializationBuffer::operator>>(std::string & dst) {
       throw std::runtime_error("String is not null terminated");
     }
 
-    dst = std::string(str, str_size - 1);
+    // Assigned in place, a reused string is not reallocated once it is big enough
+    dst.assign(str, str_size - 1);
     advance(str_size);
 }
 
@@ -123,21 +128,20 @@ void CdrDeserializationBuffer::operator>>(std::u16string & dst) {
   *this >> str_size;
   roundup(sizeof(char16_t));  // align of wchar
   if (str_size == 0) {
-    dst = std::u16string{};
+    dst.clear();
     return;
   }
   if (offset_ + str_size * sizeof(char16_t) > size_) {
     throw std::runtime_error("Out of buffer");
   }
 
-  std::u16string temp(str_size, u'\0');
-  const uint16_t* str = reinterpret_cast<const uint16_t *>(buf_ + offset_);
-  for (uint32_t i = 0; i < str_size; i++) {
-    auto ch = str[i];
-    temp[i] = swap_ ? bswap16(ch) : ch;
+  dst.resize(str_size);
+  if (swap_) {
+    bswap_copy16(&dst[0], buf_ + offset_, str_size);
+  } else {
+    std::memcpy(&dst[0], buf_ + offset_, str_size * sizeof(char16_t));
   }
 
-  dst = std::move(temp);
   advance(str_size * sizeof(char16_t));
 }
 
@@ -145,21 +149,45 @@ void CdrDeserializationBuffer::operator>>(rosidl_runtime_c__String & dst) {
   uint32_t str_size = 0;
   *this >> str_size;
   roundup(sizeof(char));  // align of char
+  if (arena_ != nullptr) {
+    // Arena messages start zeroed, the string is never freed on its own
+    if (offset_ + str_size > size_) {
+      throw std::runtime_error("Out of buffer");
+    }
+    const size_t length = str_size > 0 ? str_size - 1 : 0;
+    auto data = static_cast<char *>(arena_->allocate(length + 1, alignof(char)));
+    if (data == nullptr) {
+      throw std::runtime_error("Failed to allocate string");
+    }
+    std::memcpy(data, buf_ + offset_, length);
+    data[length] = '\0';
+    dst.data = data;
+    dst.size = length;
+    dst.capacity = length + 1;
+    advance(str_size);
+    return;
+  }
   if (str_size == 0) {
     dst.data[0] = '\0';
     dst.size = 0;
-    dst.capacity = 1;
     return;
   }
   if (offset_ + str_size > size_) {
     throw std::runtime_error("Out of buffer");
   }
 
-  rosidl_runtime_c__String__assignn(
-    &dst,
-    reinterpret_cast<const char *>(buf_ + offset_),
-    str_size - 1
-  );
+  // The capacity counts the null terminator, assignn reallocates even when it is big enough
+  if (dst.capacity >= str_size) {
+    std::memcpy(dst.data, buf_ + offset_, str_size - 1);
+    dst.data[str_size - 1] = '\0';
+    dst.size = str_size - 1;
+  } else if (!rosidl_runtime_c__String__assignn(
+      &dst,
+      reinterpret_cast<const char *>(buf_ + offset_),
+      str_size - 1))
+  {
+    throw std::runtime_error("Failed to assign string");
+  }
   advance(str_size);
 }
 
@@ -167,25 +195,47 @@ void CdrDeserializationBuffer::operator>>(rosidl_runtime_c__U16String & dst) {
   uint32_t str_size = 0;
   *this >> str_size;
   roundup(sizeof(char16_t));  // align of wchar
+  if (arena_ != nullptr) {
+    if (offset_ + str_size * sizeof(char16_t) > size_) {
+      throw std::runtime_error("Out of buffer");
+    }
+    auto data = static_cast<uint_least16_t *>(
+      arena_->allocate((str_size + 1) * sizeof(char16_t), alignof(char16_t)));
+    if (data == nullptr) {
+      throw std::runtime_error("Failed to allocate wstring");
+    }
+    if (swap_) {
+      bswap_copy16(data, buf_ + offset_, str_size);
+    } else {
+      std::memcpy(data, buf_ + offset_, str_size * sizeof(char16_t));
+    }
+    data[str_size] = u'\0';
+    dst.data = data;
+    dst.size = str_size;
+    dst.capacity = str_size + 1;
+    advance(str_size * sizeof(char16_t));
+    return;
+  }
   if (str_size == 0) {
     dst.data[0] = u'\0';
     dst.size = 0;
-    dst.capacity = 1;
     return;
   }
   if (offset_ + str_size * sizeof(char16_t) > size_) {
     throw std::runtime_error("Out of buffer");
   }
 
-  bool res = rosidl_runtime_c__U16String__resize(&dst, str_size);
-  if (!res) {
+  if (dst.capacity > str_size) {
+    dst.data[str_size] = u'\0';
+    dst.size = str_size;
+  } else if (!rosidl_runtime_c__U16String__resize(&dst, str_size)) {
     throw std::runtime_error("Failed to resize wstring");
   }
 
-  const uint16_t* str = reinterpret_cast<const uint16_t *>(buf_ + offset_);
-  for (uint32_t i = 0; i < str_size; i++) {
-    auto ch = str[i];
-    dst.data[i] = swap_ ? bswap16(ch) : ch;
+  if (swap_) {
+    bswap_copy16(dst.data, buf_ + offset_, str_size);
+  } else {
+    std::memcpy(dst.data, buf_ + offset_, str_size * sizeof(char16_t));
   }
 
   advance(str_size * sizeof(char16_t));
@@ -214,13 +264,10 @@ void CdrDeserializationBuffer::copy_arr(uint16_t * arr, size_t cnt) {
     throw std::runtime_error("Out of buffer");
   }
 
-  uint16_t* src = reinterpret_cast<uint16_t*>(buf_ + offset_);
   if (swap_) {
-    for (size_t i = 0; i < cnt; i++) {
-      arr[i] = bswap16(src[i]);
-    }
+    bswap_copy16(arr, buf_ + offset_, cnt);
   } else {
-    std::memcpy(arr, src, cnt * sizeof(uint16_t));
+    std::memcpy(arr, buf_ + offset_, cnt * sizeof(uint16_t));
   }
   advance(cnt * sizeof(uint16_t));
 }
@@ -235,13 +282,10 @@ void CdrDeserializationBuffer::copy_arr(uint32_t * arr, size_t cnt) {
     throw std::runtime_error("Out of buffer");
   }
 
-  uint32_t* src = reinterpret_cast<uint32_t*>(buf_ + offset_);
   if (swap_) {
-    for (size_t i = 0; i < cnt; i++) {
-      arr[i] = bswap32(src[i]);
-    }
+    bswap_copy32(arr, buf_ + offset_, cnt);
   } else {
-    std::memcpy(arr, src, cnt * sizeof(uint32_t));
+    std::memcpy(arr, buf_ + offset_, cnt * sizeof(uint32_t));
   }
   advance(cnt * sizeof(uint32_t));
 }
@@ -256,14 +300,30 @@ void CdrDeserializationBuffer::copy_arr(uint64_t * arr, size_t cnt) {
     throw std::runtime_error("Out of buffer");
   }
 
-  uint64_t* src = reinterpret_cast<uint64_t*>(buf_ + offset_);
   if (swap_) {
-    for (size_t i = 0; i < cnt; i++) {
-      arr[i] = bswap32(src[i]);
-    }
+    bswap_copy64(arr, buf_ + offset_, cnt);
   } else {
-    std::memcpy(arr, src, cnt * sizeof(uint64_t));
+    std::memcpy(arr, buf_ + offset_, cnt * sizeof(uint64_t));
   }
   advance(cnt * sizeof(uint64_t));
 }
+
+void CdrDeserializationBuffer::copy_bool_arr(bool * arr, size_t cnt) {
+  if (offset_ + cnt > size_) {
+    throw std::runtime_error("Out of buffer");
+  }
+
+  copy_bool_normalized(arr, buf_ + offset_, cnt);
+  advance(cnt);
+}
+
+void CdrDeserializationBuffer::copy_bool_vector(std::vector<bool> & vec, size_t cnt) {
+  if (offset_ + cnt > size_) {
+    throw std::runtime_error("Out of buffer");
+  }
+
+  vec.resize(cnt);
+  copy_bytes_to_bool_vector(vec, buf_ + offset_);
+  advance(cnt);
+}
 } // namespace rmw_gurumdds_cpp
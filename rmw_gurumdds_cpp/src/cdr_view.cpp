@@ -0,0 +1,486 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+
+#include "rmw/error_handling.h"
+
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+#include "rmw_gurumdds_cpp/cdr_view.hpp"
+#include "rmw_gurumdds_cpp/message_converter.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Serialized size and alignment of a primitive, 0 for strings and structs
+static size_t get_primitive_size(uint8_t type_id)
+{
+  switch (type_id) {
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOLEAN:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_OCTET:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+      return 1;
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_WCHAR:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+      return 2;
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+      return 4;
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_DOUBLE:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+template<typename MessageMembersT>
+static void skip_member(
+  CdrDeserializationBuffer & buffer, const MessageMemberType<MessageMembersT> * member);
+
+template<typename MessageMembersT>
+static void skip_value(
+  CdrDeserializationBuffer & buffer, const MessageMemberType<MessageMembersT> * member)
+{
+  const size_t size = get_primitive_size(member->type_id_);
+  if (size > 0) {
+    buffer.roundup(static_cast<uint32_t>(size));
+    buffer.skip(size);
+    return;
+  }
+
+  uint32_t length = 0;
+  switch (member->type_id_) {
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+      buffer >> length;
+      buffer.skip(length);
+      break;
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+      buffer >> length;
+      buffer.roundup(sizeof(char16_t));
+      buffer.skip(length * sizeof(char16_t));
+      break;
+    case rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+      {
+        auto members = static_cast<const MessageMembersT *>(member->members_->data);
+        for (uint32_t i = 0; i < members->member_count_; i++) {
+          skip_member<MessageMembersT>(buffer, &members->members_[i]);
+        }
+      }
+      break;
+    default:
+      throw std::runtime_error("Unsupported member type");
+  }
+}
+
+template<typename MessageMembersT>
+static void skip_member(
+  CdrDeserializationBuffer & buffer, const MessageMemberType<MessageMembersT> * member)
+{
+  if (!member->is_array_) {
+    skip_value<MessageMembersT>(buffer, member);
+    return;
+  }
+
+  size_t count = member->array_size_;
+  if (!member->array_size_ || member->is_upper_bound_) {
+    uint32_t size = 0;
+    buffer >> size;
+    count = size;
+  }
+
+  // Primitive arrays are aligned once, and not at all when they are empty
+  const size_t size = get_primitive_size(member->type_id_);
+  if (size > 0) {
+    if (count > 0) {
+      buffer.roundup(static_cast<uint32_t>(size));
+      buffer.skip(count * size);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    skip_value<MessageMembersT>(buffer, member);
+  }
+}
+
+template<typename T>
+static void read_cdr(CdrDeserializationBuffer & buffer, T & value)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    uint8_t data = 0;
+    buffer >> data;
+    value = (data != 0);
+  } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::u16string>) {
+    buffer >> value;
+  } else {
+    using BitsT = std::conditional_t<sizeof(T) == 1, uint8_t,
+        std::conditional_t<sizeof(T) == 2, uint16_t,
+        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+    BitsT bits = 0;
+    buffer >> bits;
+    std::memcpy(&value, &bits, sizeof(T));
+  }
+}
+
+CdrView::CdrView(
+  const rosidl_message_type_support_t * type_supports,
+  const uint8_t * data,
+  size_t size)
+  : data_{const_cast<uint8_t *>(data)},
+  size_{size}
+{
+  if (type_supports == nullptr || data == nullptr || size < CDR_HEADER_SIZE) {
+    return;
+  }
+
+  const rosidl_message_type_support_t * type_support =
+    get_message_typesupport_handle(type_supports, rosidl_typesupport_introspection_c__identifier);
+  if (type_support != nullptr) {
+    members_ = type_support->data;
+    resolve_ = &CdrView::resolve<rosidl_typesupport_introspection_c__MessageMembers>;
+    return;
+  }
+
+  rmw_reset_error();
+  type_support = get_message_typesupport_handle(
+    type_supports, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (type_support != nullptr) {
+    members_ = type_support->data;
+    resolve_ = &CdrView::resolve<rosidl_typesupport_introspection_cpp::MessageMembers>;
+    return;
+  }
+  rmw_reset_error();
+}
+
+CdrView::CdrView(
+  const rosidl_message_type_support_t * type_supports,
+  const rmw_serialized_message_t * serialized_message)
+  : CdrView(
+    type_supports,
+    serialized_message != nullptr ? serialized_message->buffer : nullptr,
+    serialized_message != nullptr ? serialized_message->buffer_length : 0)
+{
+}
+
+bool CdrView::is_valid() const
+{
+  return resolve_ != nullptr && members_ != nullptr;
+}
+
+template<typename MessageMembersT>
+size_t CdrView::get_member_position(
+  CdrDeserializationBuffer & buffer,
+  const MessageMembersT * members,
+  size_t position,
+  uint32_t index)
+{
+  std::vector<size_t> & offsets = offsets_[{members, position}];
+  if (offsets.empty()) {
+    offsets.push_back(position);
+  }
+
+  while (offsets.size() <= index) {
+    buffer.seek(offsets.back());
+    skip_member<MessageMembersT>(buffer, &members->members_[offsets.size() - 1]);
+    offsets.push_back(buffer.get_offset());
+  }
+
+  return offsets[index];
+}
+
+template<typename MessageMembersT>
+bool CdrView::get_element_position(
+  CdrDeserializationBuffer & buffer,
+  const void * untyped_member,
+  size_t position,
+  size_t index,
+  size_t & element_position)
+{
+  auto member = static_cast<const MessageMemberType<MessageMembersT> *>(untyped_member);
+  buffer.seek(position);
+  size_t count = member->array_size_;
+  if (!member->array_size_ || member->is_upper_bound_) {
+    uint32_t size = 0;
+    buffer >> size;
+    count = size;
+  }
+
+  if (index >= count) {
+    return false;
+  }
+
+  // The elements of a primitive array are found without walking the ones before
+  const size_t size = get_primitive_size(member->type_id_);
+  if (size > 0) {
+    buffer.roundup(static_cast<uint32_t>(size));
+    element_position = buffer.get_offset() + index * size;
+    return true;
+  }
+
+  std::vector<size_t> & offsets = offsets_[{untyped_member, position}];
+  if (offsets.empty()) {
+    offsets.push_back(buffer.get_offset());
+  }
+
+  while (offsets.size() <= index) {
+    buffer.seek(offsets.back());
+    skip_value<MessageMembersT>(buffer, member);
+    offsets.push_back(buffer.get_offset());
+  }
+
+  element_position = offsets[index];
+  return true;
+}
+
+template<typename MessageMembersT>
+rmw_ret_t CdrView::resolve(const char * path, Field & field)
+{
+  CdrDeserializationBuffer buffer{data_, size_};
+  auto members = static_cast<const MessageMembersT *>(members_);
+  const MessageMemberType<MessageMembersT> * member = nullptr;
+  size_t position = 0;
+  bool is_array = false;
+  const char * it = path;
+  while (true) {
+    const size_t length = strcspn(it, ".[");
+    uint32_t index = 0;
+    while (index < members->member_count_ &&
+      (strncmp(members->members_[index].name_, it, length) != 0 ||
+      members->members_[index].name_[length] != '\0'))
+    {
+      index++;
+    }
+    if (length == 0 || index == members->member_count_) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "no member '%.*s' in '%s'", static_cast<int>(length), it, path);
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+
+    position = get_member_position(buffer, members, position, index);
+    member = &members->members_[index];
+    is_array = member->is_array_;
+    it += length;
+
+    if (*it == '[') {
+      char * index_end = nullptr;
+      const size_t element = strtoull(it + 1, &index_end, 10);
+      if (!is_array || index_end == it + 1 || *index_end != ']') {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("invalid index in '%s'", path);
+        return RMW_RET_INVALID_ARGUMENT;
+      }
+      if (!get_element_position<MessageMembersT>(buffer, member, position, element, position)) {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("index out of range in '%s'", path);
+        return RMW_RET_INVALID_ARGUMENT;
+      }
+      is_array = false;
+      it = index_end + 1;
+    }
+
+    if (*it == '\0') {
+      break;
+    }
+
+    if (*it != '.' || is_array ||
+      member->type_id_ != rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE)
+    {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("invalid member path '%s'", path);
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+
+    members = static_cast<const MessageMembersT *>(member->members_->data);
+    it++;
+  }
+
+  field.type_id = member->type_id_;
+  field.is_array = is_array;
+  field.array_size = member->is_upper_bound_ ? 0 : member->array_size_;
+  field.position = position;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t CdrView::find(const char * path, Field & field)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(path, RMW_RET_INVALID_ARGUMENT);
+  if (!is_valid()) {
+    RMW_SET_ERROR_MSG("view of an unsupported type support or of invalid data");
+    return RMW_RET_ERROR;
+  }
+
+  auto it = fields_.find(path);
+  if (it != fields_.end()) {
+    field = it->second;
+    return RMW_RET_OK;
+  }
+
+  rmw_ret_t ret = RMW_RET_OK;
+  try {
+    ret = (this->*resolve_)(path, field);
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to read serialized message: %s", e.what());
+    return RMW_RET_ERROR;
+  }
+
+  if (ret == RMW_RET_OK) {
+    fields_.emplace(path, field);
+  }
+  return ret;
+}
+
+template<typename T>
+rmw_ret_t CdrView::read_value(
+  const char * path, T & value, std::initializer_list<uint8_t> type_ids)
+{
+  Field field;
+  rmw_ret_t ret = find(path, field);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  bool matched = false;
+  for (uint8_t type_id : type_ids) {
+    matched = matched || field.type_id == type_id;
+  }
+  if (field.is_array || !matched) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("member '%s' is not of the type read", path);
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  try {
+    CdrDeserializationBuffer buffer{data_, size_};
+    buffer.seek(field.position);
+    read_cdr(buffer, value);
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to read serialized message: %s", e.what());
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t CdrView::read(const char * path, bool & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOLEAN});
+}
+
+rmw_ret_t CdrView::read(const char * path, int8_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8});
+}
+
+rmw_ret_t CdrView::read(const char * path, uint8_t & value)
+{
+  return read_value(
+    path, value, {
+      rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8,
+      rosidl_typesupport_introspection_cpp::ROS_TYPE_OCTET,
+      rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR});
+}
+
+rmw_ret_t CdrView::read(const char * path, int16_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16});
+}
+
+rmw_ret_t CdrView::read(const char * path, uint16_t & value)
+{
+  return read_value(
+    path, value, {
+      rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16,
+      rosidl_typesupport_introspection_cpp::ROS_TYPE_WCHAR});
+}
+
+rmw_ret_t CdrView::read(const char * path, int32_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32});
+}
+
+rmw_ret_t CdrView::read(const char * path, uint32_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32});
+}
+
+rmw_ret_t CdrView::read(const char * path, int64_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64});
+}
+
+rmw_ret_t CdrView::read(const char * path, uint64_t & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64});
+}
+
+rmw_ret_t CdrView::read(const char * path, float & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT});
+}
+
+rmw_ret_t CdrView::read(const char * path, double & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_DOUBLE});
+}
+
+rmw_ret_t CdrView::read(const char * path, std::string & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING});
+}
+
+rmw_ret_t CdrView::read(const char * path, std::u16string & value)
+{
+  return read_value(path, value, {rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING});
+}
+
+rmw_ret_t CdrView::get_size(const char * path, size_t & size)
+{
+  Field field;
+  rmw_ret_t ret = find(path, field);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  if (!field.is_array) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("member '%s' is not an array or a sequence", path);
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  if (field.array_size > 0) {
+    size = field.array_size;
+    return RMW_RET_OK;
+  }
+
+  try {
+    CdrDeserializationBuffer buffer{data_, size_};
+    buffer.seek(field.position);
+    uint32_t count = 0;
+    buffer >> count;
+    size = count;
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to read serialized message: %s", e.what());
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,184 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <string_view>
+
+#ifdef RMW_GURUMDDS_CPP_LZ4_ENABLED
+#include <lz4.h>
+#endif
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/user_data.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+bool is_compression_supported()
+{
+#ifdef RMW_GURUMDDS_CPP_LZ4_ENABLED
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool is_compressed_payload(const void * payload, size_t size)
+{
+  const uint8_t * bytes = static_cast<const uint8_t *>(payload);
+  return size >= COMPRESSED_PAYLOAD_HEADER_SIZE &&
+         bytes[0] == COMPRESSED_PAYLOAD_MARKER_0 && bytes[1] == COMPRESSED_PAYLOAD_MARKER_1;
+}
+
+size_t get_decompressed_size(const void * payload, size_t size)
+{
+  if (!is_compressed_payload(payload, size)) {
+    return 0;
+  }
+  const uint8_t * bytes = static_cast<const uint8_t *>(payload) + 4;
+  return static_cast<size_t>(bytes[0]) | static_cast<size_t>(bytes[1]) << 8 |
+         static_cast<size_t>(bytes[2]) << 16 | static_cast<size_t>(bytes[3]) << 24;
+}
+
+bool decompress_payload(const void * payload, size_t size, void * output, size_t output_size)
+{
+#ifdef RMW_GURUMDDS_CPP_LZ4_ENABLED
+  const int decompressed = LZ4_decompress_safe(
+    static_cast<const char *>(payload) + COMPRESSED_PAYLOAD_HEADER_SIZE,
+    static_cast<char *>(output),
+    static_cast<int>(size - COMPRESSED_PAYLOAD_HEADER_SIZE),
+    static_cast<int>(output_size));
+  if (decompressed < 0 || static_cast<size_t>(decompressed) != output_size) {
+    RMW_SET_ERROR_MSG("compressed payload is corrupt");
+    return false;
+  }
+  return true;
+#else
+  (void)payload;
+  (void)size;
+  (void)output;
+  (void)output_size;
+  RMW_SET_ERROR_MSG("received a compressed payload, but rmw_gurumdds_cpp was built without LZ4");
+  return false;
+#endif
+}
+
+PayloadCompressor::PayloadCompressor(const CompressionSettings & settings)
+: settings_(settings)
+{
+}
+
+PayloadCompressor::~PayloadCompressor()
+{
+  if (matched_ != nullptr) {
+    dds_InstanceHandleSeq_delete(matched_);
+  }
+}
+
+bool PayloadCompressor::should_compress(dds_DataWriter * writer, size_t size)
+{
+  if (size < settings_.threshold_bytes) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (matched_ == nullptr) {
+    matched_ = dds_InstanceHandleSeq_create(4);
+    if (matched_ == nullptr) {
+      return false;
+    }
+  }
+  if (dds_DataWriter_get_matched_subscriptions(writer, matched_) != dds_RETCODE_OK) {
+    return false;
+  }
+
+  const uint32_t length = dds_InstanceHandleSeq_length(matched_);
+  bool changed = length != matched_handles_.size();
+  for (uint32_t i = 0; i < length && !changed; i++) {
+    changed = matched_handles_[i] != dds_InstanceHandleSeq_get(matched_, i);
+  }
+  if (!changed) {
+    return readers_compatible_;
+  }
+
+  matched_handles_.clear();
+  readers_compatible_ = length > 0;
+  for (uint32_t i = 0; i < length; i++) {
+    const dds_InstanceHandle_t handle = dds_InstanceHandleSeq_get(matched_, i);
+    dds_SubscriptionBuiltinTopicData data;
+    std::string_view value;
+    if (dds_DataWriter_get_matched_subscription_data(writer, &data, handle) != dds_RETCODE_OK) {
+      // Looked up again by the next write
+      matched_handles_.clear();
+      readers_compatible_ = false;
+      return false;
+    }
+    if (!find_user_data_value(
+        data.user_data.value, data.user_data.size, COMPRESSION_USER_DATA_KEY, value) ||
+      value != COMPRESSION_LZ4)
+    {
+      readers_compatible_ = false;
+    }
+    matched_handles_.push_back(handle);
+  }
+  return readers_compatible_;
+}
+
+size_t PayloadCompressor::get_max_compressed_size(size_t size) const
+{
+#ifdef RMW_GURUMDDS_CPP_LZ4_ENABLED
+  return COMPRESSED_PAYLOAD_HEADER_SIZE +
+         static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+#else
+  return COMPRESSED_PAYLOAD_HEADER_SIZE + size;
+#endif
+}
+
+size_t PayloadCompressor::compress(
+  const void * payload, size_t size, void * output, size_t capacity) const
+{
+#ifdef RMW_GURUMDDS_CPP_LZ4_ENABLED
+  if (size > UINT32_MAX || capacity <= COMPRESSED_PAYLOAD_HEADER_SIZE) {
+    return 0;
+  }
+  const int compressed = LZ4_compress_fast(
+    static_cast<const char *>(payload),
+    static_cast<char *>(output) + COMPRESSED_PAYLOAD_HEADER_SIZE,
+    static_cast<int>(size),
+    static_cast<int>(capacity - COMPRESSED_PAYLOAD_HEADER_SIZE),
+    settings_.acceleration);
+  if (compressed <= 0 || COMPRESSED_PAYLOAD_HEADER_SIZE + static_cast<size_t>(compressed) >= size) {
+    return 0;
+  }
+
+  uint8_t * header = static_cast<uint8_t *>(output);
+  header[0] = COMPRESSED_PAYLOAD_MARKER_0;
+  header[1] = COMPRESSED_PAYLOAD_MARKER_1;
+  header[2] = 0;
+  header[3] = 0;
+  for (size_t i = 0; i < 4; i++) {
+    header[4 + i] = static_cast<uint8_t>(size >> (8 * i));
+  }
+  return COMPRESSED_PAYLOAD_HEADER_SIZE + static_cast<size_t>(compressed);
+#else
+  (void)payload;
+  (void)size;
+  (void)output;
+  (void)capacity;
+  return 0;
+#endif
+}
+} // namespace rmw_gurumdds_cpp
@@ -30,6 +30,7 @@
 
 #include "rmw_gurumdds_cpp/context_listener_thread.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
+#include "rmw_gurumdds_cpp/guard_condition.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/wait.hpp"
@@ -57,6 +58,7 @@ static
 void rmw_gurumdds_listener_thread(rmw_context_impl_t * ctx)
 {
   RCUTILS_LOG_DEBUG_NAMED(RMW_GURUMDDS_ID, "[listener thread] starting up...");
+  ctx->listener_thread_settings.apply();
 
   auto sub_partinfo
     = reinterpret_cast<rmw_gurumdds_cpp::SubscriberInfo *>(ctx->common_ctx.sub->data);
@@ -69,12 +71,14 @@ void rmw_gurumdds_listener_thread(rmw_context_impl_t * ctx)
   bool active = false;
   bool attached_exit = false;
   bool attached_partinfo = false;
+  bool attached_update = false;
 
   dds_Condition * cond_active = nullptr;
   dds_Condition * cond_part_info = nullptr;
 
   dds_GuardCondition * gcond_exit =
-    reinterpret_cast<dds_GuardCondition *>(ctx->common_ctx.listener_thread_gc->data);
+    static_cast<rmw_gurumdds_cpp::GuardCondition *>(
+    ctx->common_ctx.listener_thread_gc->data)->condition;
 
   auto waitset_info = new(std::nothrow) rmw_gurumdds_cpp::WaitSetInfo();
   if (waitset_info == nullptr) {
@@ -109,6 +113,19 @@ void rmw_gurumdds_listener_thread(rmw_context_impl_t * ctx)
   attached_exit = true;
   attached_condition_count += 1;
 
+  if (ctx->listener_wakeup_gc != nullptr) {
+    if (RMW_RET_OK !=
+      dds_WaitSet_attach_condition(
+        waitset_info->wait_set,
+        reinterpret_cast<dds_Condition *>(ctx->listener_wakeup_gc)))
+    {
+      RMW_SET_ERROR_MSG("failed to attach wakeup condition to listener thread waitset");
+      goto cleanup;
+    }
+    attached_update = true;
+    attached_condition_count += 1;
+  }
+
   waitset_info->active_conditions = dds_ConditionSeq_create(attached_condition_count);
   if (waitset_info->active_conditions == nullptr) {
     RMW_SET_ERROR_MSG("failed to create condition sequence");
@@ -121,8 +138,16 @@ void rmw_gurumdds_listener_thread(rmw_context_impl_t * ctx)
     if (!active) {
       continue;
     }
+    if (RMW_RET_OK != rmw_gurumdds_cpp::graph_cache::flush_deferred(ctx, timeout)) {
+      RCUTILS_LOG_ERROR_NAMED(RMW_GURUMDDS_ID, "failed to flush held back discovery work");
+      rmw_reset_error();
+    }
     ret = dds_WaitSet_wait(waitset_info->wait_set, waitset_info->active_conditions, &timeout);
 
+    if (ret == dds_RETCODE_TIMEOUT) {
+      // The delay of held back work is over
+      continue;
+    }
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("wait failed for listener thread");
       goto cleanup;
@@ -142,6 +167,9 @@ void rmw_gurumdds_listener_thread(rmw_context_impl_t * ctx)
       cond_active = dds_ConditionSeq_get(waitset_info->active_conditions, i);
       if (nullptr != cond_part_info && cond_part_info == cond_active) {
         rmw_gurumdds_cpp::graph_cache::on_participant_info(ctx);
+      } else if (cond_active == reinterpret_cast<dds_Condition *>(ctx->listener_wakeup_gc)) {
+        // Woken to wait with the timeout of newly held back work
+        dds_GuardCondition_set_trigger_value(ctx->listener_wakeup_gc, false);
       } else {
         RMW_SET_ERROR_MSG("unexpected active condition");
         goto cleanup;
@@ -170,6 +198,18 @@ cleanup:
           return;
         }
       }
+      if (attached_update) {
+        if (dds_RETCODE_OK !=
+          dds_WaitSet_detach_condition(
+            waitset_info->wait_set,
+            reinterpret_cast<dds_Condition *>(ctx->listener_wakeup_gc)))
+        {
+          RMW_SET_ERROR_MSG(
+            "failed to detach wakeup condition from "
+            "listener thread waitset");
+          return;
+        }
+      }
       if (attached_partinfo) {
         if (dds_RETCODE_OK !=
           dds_WaitSet_detach_condition(
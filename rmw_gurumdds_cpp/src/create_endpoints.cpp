@@ -0,0 +1,184 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
+#include "rmw/rmw.h"
+
+#include "rmw_gurumdds_cpp/create_endpoints.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/graph_cache.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
+#include "rmw_gurumdds_cpp/rmw_publisher.hpp"
+#include "rmw_gurumdds_cpp/rmw_subscription.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+static void destroy_endpoints(
+  const rmw_node_t * node,
+  PublisherRequest * publishers,
+  size_t publisher_count,
+  SubscriptionRequest * subscriptions,
+  size_t subscription_count)
+{
+  rmw_node_t * const destroying_node = const_cast<rmw_node_t *>(node);
+  for (size_t i = 0; i < publisher_count; i++) {
+    if (publishers[i].publisher != nullptr &&
+      rmw_destroy_publisher(destroying_node, publishers[i].publisher) != RMW_RET_OK)
+    {
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "%s", rmw_get_error_string().str);
+      rmw_reset_error();
+    }
+    publishers[i].publisher = nullptr;
+  }
+
+  for (size_t i = 0; i < subscription_count; i++) {
+    if (subscriptions[i].subscription != nullptr &&
+      rmw_destroy_subscription(destroying_node, subscriptions[i].subscription) != RMW_RET_OK)
+    {
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "%s", rmw_get_error_string().str);
+      rmw_reset_error();
+    }
+    subscriptions[i].subscription = nullptr;
+  }
+}
+
+static rmw_ret_t enable_endpoints(
+  PublisherRequest * publishers,
+  size_t publisher_count,
+  SubscriptionRequest * subscriptions,
+  size_t subscription_count)
+{
+  for (size_t i = 0; i < publisher_count; i++) {
+    auto publisher_info = static_cast<PublisherInfo *>(publishers[i].publisher->data);
+    if (dds_Entity_enable(reinterpret_cast<dds_Entity *>(publisher_info->topic_writer)) !=
+      dds_RETCODE_OK)
+    {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "failed to enable datawriter of '%s'", publishers[i].topic_name);
+      return RMW_RET_ERROR;
+    }
+  }
+
+  for (size_t i = 0; i < subscription_count; i++) {
+    auto subscriber_info = static_cast<SubscriberInfo *>(subscriptions[i].subscription->data);
+    if (dds_Entity_enable(reinterpret_cast<dds_Entity *>(subscriber_info->topic_reader)) !=
+      dds_RETCODE_OK)
+    {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "failed to enable datareader of '%s'", subscriptions[i].topic_name);
+      return RMW_RET_ERROR;
+    }
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+create_endpoints(
+  const rmw_node_t * node,
+  PublisherRequest * publishers,
+  size_t publisher_count,
+  SubscriptionRequest * subscriptions,
+  size_t subscription_count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    node,
+    node->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  if (publisher_count > 0) {
+    RMW_CHECK_ARGUMENT_FOR_NULL(publishers, RMW_RET_INVALID_ARGUMENT);
+  }
+  if (subscription_count > 0) {
+    RMW_CHECK_ARGUMENT_FOR_NULL(subscriptions, RMW_RET_INVALID_ARGUMENT);
+  }
+
+  for (size_t i = 0; i < publisher_count; i++) {
+    publishers[i].publisher = nullptr;
+  }
+  for (size_t i = 0; i < subscription_count; i++) {
+    subscriptions[i].subscription = nullptr;
+  }
+
+  rmw_context_impl_t * ctx = node->context->impl;
+  rmw_ret_t ret = graph_cache::hold_updates(ctx);
+  if (ret != RMW_RET_OK) {
+    // Error message already set
+    return ret;
+  }
+
+  // The type registrations and the topics are shared by the endpoints of a type and topic
+  for (size_t i = 0; ret == RMW_RET_OK && i < publisher_count; i++) {
+    const PublisherRequest & request = publishers[i];
+    publishers[i].publisher = create_node_publisher(
+      node, request.type_supports, request.topic_name, request.qos_policies,
+      request.publisher_options, ctx->bulk_publisher);
+    if (publishers[i].publisher == nullptr) {
+      // Error message already set
+      ret = RMW_RET_ERROR;
+    }
+  }
+
+  for (size_t i = 0; ret == RMW_RET_OK && i < subscription_count; i++) {
+    const SubscriptionRequest & request = subscriptions[i];
+    subscriptions[i].subscription = create_node_subscription(
+      node, request.type_supports, request.topic_name, request.qos_policies,
+      request.subscription_options, ctx->bulk_subscriber);
+    if (subscriptions[i].subscription == nullptr) {
+      // Error message already set
+      ret = RMW_RET_ERROR;
+    }
+  }
+
+  // Enabled once all of them exist, so that they are announced and matched together
+  if (ret == RMW_RET_OK) {
+    ret = enable_endpoints(publishers, publisher_count, subscriptions, subscription_count);
+  }
+
+  if (ret != RMW_RET_OK) {
+    // The updates of the deletions are held back as well
+    rmw_error_string_t error = rmw_get_error_string();
+    rmw_reset_error();
+    destroy_endpoints(node, publishers, publisher_count, subscriptions, subscription_count);
+    RMW_SET_ERROR_MSG(error.str);
+  }
+
+  rmw_ret_t release_ret = graph_cache::release_updates(ctx);
+  if (ret == RMW_RET_OK && release_ret != RMW_RET_OK) {
+    rmw_error_string_t error = rmw_get_error_string();
+    rmw_reset_error();
+    destroy_endpoints(node, publishers, publisher_count, subscriptions, subscription_count);
+    RMW_SET_ERROR_MSG(error.str);
+    ret = release_ret;
+  }
+
+  if (ret == RMW_RET_OK) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID,
+      "Created %zu publishers and %zu subscriptions on node '%s%s%s'",
+      publisher_count, subscription_count, node->namespace_,
+      node->namespace_[strlen(node->namespace_) - 1] == '/' ? "" : "/", node->name);
+  }
+
+  return ret;
+}
+} // namespace rmw_gurumdds_cpp
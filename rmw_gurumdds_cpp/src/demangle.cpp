@@ -13,7 +13,6 @@
 // limitations under the License.
 
 #include <cstring>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -23,6 +22,25 @@
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/namespace_prefix.hpp"
 
+// Reformats '<pkg>::msg::dds_::<type>' in [0, end) to '<pkg>/msg/<type>', in a single allocation
+static std::string
+format_ros_type(const std::string & dds_type_name, size_t dds_position, size_t end)
+{
+  static constexpr size_t dds_length = sizeof("dds_::") - 1;
+  std::string result;
+  result.reserve(end - dds_length);
+  for (size_t i = 0; i < dds_position; ++i) {
+    if (dds_type_name[i] == ':' && i + 1 < dds_position && dds_type_name[i + 1] == ':') {
+      result.push_back('/');
+      ++i;
+    } else {
+      result.push_back(dds_type_name[i]);
+    }
+  }
+  result.append(dds_type_name, dds_position + dds_length, end - dds_position - dds_length);
+  return result;
+}
+
 namespace rmw_gurumdds_cpp
 {
 std::string
@@ -34,17 +52,12 @@ demangle_if_ros_topic(const std::string & topic_name)
 std::string
 demangle_if_ros_type(const std::string & dds_type_string)
 {
-  std::string substring = "dds_::";
-  size_t substring_position = dds_type_string.find(substring);
+  size_t substring_position = dds_type_string.find("dds_::");
   if (
-    dds_type_string[dds_type_string.size() - 1] == '_' &&
-    substring_position != std::string::npos)
+    substring_position != std::string::npos &&
+    dds_type_string[dds_type_string.size() - 1] == '_')
   {
-    std::string type_namespace = dds_type_string.substr(0, substring_position);
-    type_namespace = std::regex_replace(type_namespace, std::regex("::"), "/");
-    size_t start = substring_position + substring.size();
-    std::string type_name = dds_type_string.substr(start, dds_type_string.length() - 1 - start);
-    return type_namespace + type_name;
+    return format_ros_type(dds_type_string, substring_position, dds_type_string.size() - 1);
   }
   // not a ROS type
   return dds_type_string;
@@ -56,18 +69,18 @@ demangle_ros_topic_from_topic(const std::string & topic_name)
   return resolve_prefix(topic_name, ros_topic_prefix);
 }
 
-std::string
+static std::string
 _demangle_service_from_topic(
-  const std::string & prefix, const std::string & topic_name, std::string suffix)
+  const std::string & prefix, const std::string & topic_name, const char * suffix)
 {
-  std::string service_name = resolve_prefix(topic_name, prefix);
-  if (service_name.empty()) {
+  if (!has_prefix(topic_name, prefix)) {
     return "";
   }
 
-  size_t suffix_position = service_name.rfind(suffix);
-  if (suffix_position != std::string::npos) {
-    if (service_name.length() - suffix_position - suffix.length() != 0) {
+  const size_t suffix_length = std::strlen(suffix);
+  size_t suffix_position = topic_name.rfind(suffix);
+  if (suffix_position != std::string::npos && suffix_position > prefix.length()) {
+    if (topic_name.length() - suffix_position - suffix_length != 0) {
       RCUTILS_LOG_WARN_NAMED(
         RMW_GURUMDDS_ID,
         "service topic has prefix and suffix,"
@@ -80,7 +93,7 @@ _demangle_service_from_topic(
       "service topic has prefix but no suffix: '%s'", topic_name.c_str());
     return "";
   }
-  return service_name.substr(0, suffix_position);
+  return topic_name.substr(prefix.length(), suffix_position - prefix.length());
 }
 
 std::string
@@ -108,29 +121,26 @@ demangle_service_reply_from_topic(const std::string & topic_name)
 std::string
 demangle_service_type_only(const std::string & dds_type_name)
 {
-  std::string ns_substring = "dds_::";
-  size_t ns_substring_position = dds_type_name.find(ns_substring);
+  size_t ns_substring_position = dds_type_name.find("dds_::");
   if (ns_substring_position == std::string::npos) {
     return "";
   }
 
-  static const std::string suffixes[] = {
-    std::string("_Response_"),
-    std::string("_Request_"),
+  static const char * const suffixes[] = {
+    "_Response_",
+    "_Request_",
   };
-  std::string found_suffix = "";
   size_t suffix_position = std::string::npos;
-  for (const auto & suffix : suffixes) {
+  for (const char * suffix : suffixes) {
     suffix_position = dds_type_name.rfind(suffix);
     if (suffix_position != std::string::npos) {
-      if (dds_type_name.length() - suffix_position - suffix.length() != 0) {
+      if (dds_type_name.length() - suffix_position - std::strlen(suffix) != 0) {
         RCUTILS_LOG_WARN_NAMED(
           RMW_GURUMDDS_ID,
           "service type contains 'dds_::' and a suffix, but not at the end: '%s'",
           dds_type_name.c_str());
         continue;
       }
-      found_suffix = suffix;
       break;
     }
   }
@@ -145,11 +155,7 @@ demangle_service_type_only(const std::string & dds_type_name)
 
   // everything checks out, reformat it from '<pkg>::srv::dds_::<type><suffix>'
   // to '<namespace>/<type>'
-  std::string type_namespace = dds_type_name.substr(0, ns_substring_position);
-  type_namespace = std::regex_replace(type_namespace, std::regex("::"), "/");
-  size_t start = ns_substring_position + ns_substring.length();
-  std::string type_name = dds_type_name.substr(start, suffix_position - start);
-  return type_namespace + type_name;
+  return format_ros_type(dds_type_name, ns_substring_position, suffix_position);
 }
 
 std::string
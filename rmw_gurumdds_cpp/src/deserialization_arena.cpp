@@ -0,0 +1,98 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "rmw_gurumdds_cpp/deserialization_arena.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+DeserializationArena::DeserializationArena(int memory)
+: memory_{memory}
+{
+}
+
+DeserializationArena::~DeserializationArena()
+{
+  for (uint8_t * overflow : overflow_) {
+    free(overflow);
+  }
+  free_buffer_memory(memory_, block_, capacity_);
+}
+
+void * DeserializationArena::allocate(size_t size, size_t alignment)
+{
+  const size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+  if (block_ != nullptr && offset + size <= capacity_) {
+    used_ = offset + size;
+    return block_ + offset;
+  }
+
+  // malloc aligns for any type
+  auto overflow = static_cast<uint8_t *>(malloc(std::max<size_t>(size, 1)));
+  if (overflow == nullptr) {
+    return nullptr;
+  }
+  overflow_.push_back(overflow);
+  overflow_size_ += size + alignment;
+  return overflow;
+}
+
+bool DeserializationArena::reset()
+{
+  if (block_ != nullptr && overflow_size_ == 0) {
+    used_ = 0;
+    return true;
+  }
+
+  return replace_block(
+    std::max<size_t>(DESERIALIZATION_ARENA_INITIAL_SIZE, used_ + overflow_size_));
+}
+
+bool DeserializationArena::reserve(size_t size)
+{
+  if (block_ != nullptr && overflow_size_ == 0 && size <= capacity_) {
+    used_ = 0;
+    return true;
+  }
+
+  return replace_block(
+    std::max<size_t>({DESERIALIZATION_ARENA_INITIAL_SIZE, size, used_ + overflow_size_}));
+}
+
+bool DeserializationArena::replace_block(size_t size)
+{
+  for (uint8_t * overflow : overflow_) {
+    free(overflow);
+  }
+  overflow_.clear();
+  overflow_size_ = 0;
+  used_ = 0;
+
+  free_buffer_memory(memory_, block_, capacity_);
+  capacity_ = 0;
+  block_ = allocate_buffer_memory(memory_, size, &capacity_);
+  if (block_ == nullptr) {
+    capacity_ = 0;
+    return false;
+  }
+  return true;
+}
+
+size_t DeserializationArena::get_capacity() const
+{
+  return capacity_;
+}
+} // namespace rmw_gurumdds_cpp
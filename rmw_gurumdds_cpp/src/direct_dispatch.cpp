@@ -0,0 +1,373 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/direct_dispatch.hpp"
+#include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
+#include "rmw_gurumdds_cpp/type_support_common.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+DirectDispatcher::DirectDispatcher(
+  const MessagePlan * plan, DispatchCallback callback, void * user_data, int mode,
+  bool use_workers)
+: plan_(plan),
+  callback_(callback),
+  user_data_(user_data),
+  mode_(mode),
+  use_workers_(use_workers)
+{
+}
+
+DirectDispatcher::~DirectDispatcher()
+{
+  for (Slot & slot : slots_) {
+    if (slot.message != nullptr) {
+      plan_->fini_message(slot.message.get());
+    }
+  }
+}
+
+bool DirectDispatcher::reserve(size_t count)
+{
+  try {
+    batch_.valid_samples.reserve(DIRECT_DISPATCH_TAKE_COUNT);
+    batch_.message_infos.reserve(DIRECT_DISPATCH_TAKE_COUNT);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+
+  if (slots_.size() >= count) {
+    return true;
+  }
+
+  const size_t first = slots_.size();
+  slots_.resize(count);
+  if (mode_ != DIRECT_DISPATCH_DESERIALIZED) {
+    return true;
+  }
+
+  const size_t words =
+    (plan_->get_message_size() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+  for (size_t i = first; i < count; i++) {
+    slots_[i].message.reset(new(std::nothrow) std::max_align_t[words == 0 ? 1 : words]);
+    if (slots_[i].message == nullptr) {
+      slots_.resize(i);
+      return false;
+    }
+    plan_->init_message(slots_[i].message.get());
+  }
+  return true;
+}
+
+bool DirectDispatcher::uses_workers() const
+{
+  return use_workers_;
+}
+
+DirectDispatcher::Batch & DirectDispatcher::get_batch()
+{
+  return batch_;
+}
+
+bool DirectDispatcher::dispatch(
+  size_t slot_index, const void * payload, size_t size, const rmw_message_info_t & message_info)
+{
+  Slot & slot = slots_[slot_index];
+  DispatchedSample sample{};
+  sample.message_info = message_info;
+
+  if (mode_ == DIRECT_DISPATCH_DESERIALIZED) {
+    // The plan decompresses a compressed payload by itself
+    if (!plan_->deserialize(slot.message.get(), const_cast<void *>(payload), size)) {
+      // Error message already set
+      return false;
+    }
+    sample.ros_message = slot.message.get();
+  } else if (is_compressed_payload(payload, size)) {
+    slot.decompressed.resize(get_decompressed_size(payload, size));
+    if (!decompress_payload(payload, size, slot.decompressed.data(), slot.decompressed.size())) {
+      // Error message already set
+      return false;
+    }
+    sample.serialized = slot.decompressed.data();
+    sample.serialized_size = slot.decompressed.size();
+  } else {
+    sample.serialized = static_cast<const uint8_t *>(payload);
+    sample.serialized_size = size;
+  }
+
+  callback_(&sample, user_data_);
+  return true;
+}
+
+static int64_t time_to_ns(const dds_Time_t & time)
+{
+  return time.sec * static_cast<int64_t>(1000000000) + time.nanosec;
+}
+
+static void
+fill_dispatched_info(
+  SubscriberInfo * subscriber_info,
+  const dds_SampleInfoEx * sampleinfo_ex,
+  rmw_message_info_t & message_info)
+{
+  message_info = rmw_get_zero_initialized_message_info();
+  message_info.source_timestamp = time_to_ns(sampleinfo_ex->info.source_timestamp);
+  message_info.received_timestamp = time_to_ns(sampleinfo_ex->reception_timestamp);
+  int64_t sequence_number = 0;
+  dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
+  message_info.publication_sequence_number = sequence_number;
+  message_info.reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
+  message_info.publisher_gid.implementation_identifier = subscriber_info->implementation_identifier;
+  if (subscriber_info->get_publication_guid(
+      sampleinfo_ex->info.publication_handle, message_info.publisher_gid.data) != dds_RETCODE_OK)
+  {
+    std::memset(message_info.publisher_gid.data, 0, RMW_GID_STORAGE_SIZE);
+  }
+
+  subscriber_info->on_sequence_number(sampleinfo_ex->info.publication_handle, sequence_number);
+  if (subscriber_info->latency != nullptr) {
+    subscriber_info->latency->on_sample(
+      message_info.source_timestamp, message_info.received_timestamp);
+  }
+}
+
+void dispatch_samples(SubscriberInfo * subscriber_info)
+{
+  std::lock_guard<std::mutex> guard{subscriber_info->mutex_dispatch};
+  DirectDispatcher * dispatcher = subscriber_info->dispatcher.get();
+  if (dispatcher == nullptr) {
+    return;
+  }
+
+  WorkerPool * workers =
+    dispatcher->uses_workers() ? subscriber_info->ctx->deserialization_workers.get() : nullptr;
+  if (!dispatcher->reserve(workers != nullptr ? DIRECT_DISPATCH_TAKE_COUNT : 1)) {
+    RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "failed to allocate messages of the dispatch");
+    return;
+  }
+
+  // Samples handed over by the publishers of the context come before the ones of the reader
+  LocalSample sample;
+  while (subscriber_info->pop_local_sample(sample)) {
+    rmw_message_info_t message_info = rmw_get_zero_initialized_message_info();
+    message_info.source_timestamp = sample.source_timestamp;
+    message_info.received_timestamp = sample.received_timestamp;
+    message_info.publication_sequence_number = sample.sequence_number;
+    message_info.reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
+    message_info.publisher_gid = sample.publisher_gid;
+    message_info.publisher_gid.implementation_identifier =
+      subscriber_info->implementation_identifier;
+    subscriber_info->on_local_sequence_number(sample.publisher_gid, sample.sequence_number);
+    if (subscriber_info->latency != nullptr) {
+      subscriber_info->latency->on_sample(sample.source_timestamp, sample.received_timestamp);
+    }
+    if (!dispatcher->dispatch(0, sample.buffer->data(), sample.size, message_info)) {
+      rmw_reset_error();
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to dispatch a local sample of a subscription, it is dropped");
+    }
+  }
+
+  dds_DataReader * topic_reader = subscriber_info->topic_reader;
+  std::vector<uint32_t> & valid_samples = dispatcher->get_batch().valid_samples;
+  std::vector<rmw_message_info_t> & message_infos = dispatcher->get_batch().message_infos;
+  uint32_t taken = DIRECT_DISPATCH_TAKE_COUNT;
+  while (taken == DIRECT_DISPATCH_TAKE_COUNT) {
+    SampleSequences loan{};
+    if (!subscriber_info->sample_pool.acquire(DIRECT_DISPATCH_TAKE_COUNT, loan)) {
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "failed to create sample sequences of the dispatch");
+      break;
+    }
+
+    const uint64_t take_start_ns = stats_time_ns();
+    dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+      topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes,
+      DIRECT_DISPATCH_TAKE_COUNT, dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+    const uint64_t take_ns = stats_time_ns() - take_start_ns;
+    taken = ret == dds_RETCODE_OK ? dds_SampleInfoSeq_length(loan.info_seq) : 0;
+
+    const uint64_t dispatch_start_ns = stats_time_ns();
+    size_t bytes = 0;
+    valid_samples.clear();
+    message_infos.clear();
+    for (uint32_t i = 0; i < taken; i++) {
+      auto sample_info =
+        reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(loan.info_seq, i));
+      if (!sample_info->info.valid_data || dds_DataSeq_get(loan.data_seq, i) == nullptr) {
+        continue;
+      }
+      message_infos.emplace_back();
+      fill_dispatched_info(subscriber_info, sample_info, message_infos.back());
+      valid_samples.push_back(i);
+      bytes += dds_UnsignedLongSeq_get(loan.raw_data_sizes, i);
+    }
+
+    std::atomic<bool> failed{false};
+    auto dispatch = [&](size_t slot, size_t index) {
+      const uint32_t i = valid_samples[index];
+      if (!dispatcher->dispatch(
+          slot, dds_DataSeq_get(loan.data_seq, i), dds_UnsignedLongSeq_get(loan.raw_data_sizes, i),
+          message_infos[index]))
+      {
+        // Reported once by the listener, error state is per thread
+        rmw_reset_error();
+        failed.store(true, std::memory_order_relaxed);
+      }
+    };
+
+    if (workers != nullptr && valid_samples.size() > 1) {
+      // Every sample of the batch has a slot of its own
+      workers->parallel_for(valid_samples.size(), [&](size_t index) {dispatch(index, index);});
+    } else {
+      for (size_t index = 0; index < valid_samples.size(); index++) {
+        dispatch(0, index);
+      }
+    }
+    // The payloads are loaned until every callback of the batch returned
+    subscriber_info->sample_pool.release(topic_reader, loan);
+
+    if (failed.load(std::memory_order_relaxed)) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to dispatch samples of a subscription, they are dropped");
+    }
+    if (taken > 0) {
+      subscriber_info->stats.on_take(
+        valid_samples.size(), bytes, stats_time_ns() - dispatch_start_ns, take_ns);
+    }
+  }
+}
+
+static SubscriberInfo *
+get_dispatch_subscriber_info(const rmw_subscription_t * subscription)
+{
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid subscription data");
+  }
+  return subscriber_info;
+}
+
+rmw_ret_t
+set_dispatch_callback(
+  const rmw_subscription_t * subscription,
+  DispatchCallback callback,
+  void * user_data,
+  int mode,
+  bool use_workers)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(callback, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  if (mode != DIRECT_DISPATCH_DESERIALIZED && mode != DIRECT_DISPATCH_SERIALIZED) {
+    RMW_SET_ERROR_MSG("invalid dispatch mode");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  SubscriberInfo * subscriber_info = get_dispatch_subscriber_info(subscription);
+  if (subscriber_info == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  if (subscriber_info->capturing.load(std::memory_order_acquire)) {
+    RMW_SET_ERROR_MSG("subscription is capturing");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_dispatch};
+    if (subscriber_info->dispatcher != nullptr) {
+      RMW_SET_ERROR_MSG("subscription already has a dispatch callback");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    std::unique_ptr<DirectDispatcher> dispatcher{new(std::nothrow) DirectDispatcher(
+        subscriber_info->message_plan, callback, user_data, mode, use_workers)};
+    if (dispatcher == nullptr || !dispatcher->reserve(1)) {
+      RMW_SET_ERROR_MSG("failed to allocate dispatcher");
+      return RMW_RET_BAD_ALLOC;
+    }
+    subscriber_info->dispatcher = std::move(dispatcher);
+    subscriber_info->dispatching.store(true, std::memory_order_release);
+  }
+
+  dds_ReturnCode_t dds_rc;
+  {
+    std::lock_guard<std::mutex> guard(subscriber_info->event_callback_data.mutex);
+    subscriber_info->mask |= dds_DATA_AVAILABLE_STATUS;
+    dds_rc = dds_DataReader_set_listener(
+      subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
+  }
+
+  // Samples that arrived before the listener was set would wait for the next one
+  dispatch_samples(subscriber_info);
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+clear_dispatch_callback(const rmw_subscription_t * subscription)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  SubscriberInfo * subscriber_info = get_dispatch_subscriber_info(subscription);
+  if (subscriber_info == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  std::unique_ptr<DirectDispatcher> dispatcher;
+  {
+    // Waits for the callbacks the listener is running
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_dispatch};
+    if (subscriber_info->dispatcher == nullptr) {
+      RMW_SET_ERROR_MSG("subscription has no dispatch callback");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    subscriber_info->dispatching.store(false, std::memory_order_release);
+    dispatcher = std::move(subscriber_info->dispatcher);
+  }
+
+  std::lock_guard<std::mutex> guard(subscriber_info->event_callback_data.mutex);
+  if (!subscriber_info->event_callback_data.is_set_unsafe()) {
+    subscriber_info->mask &= ~dds_DATA_AVAILABLE_STATUS;
+  }
+  return check_dds_ret_code(dds_DataReader_set_listener(
+    subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask));
+}
+} // namespace rmw_gurumdds_cpp
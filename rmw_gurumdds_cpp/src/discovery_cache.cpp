@@ -0,0 +1,428 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/discovery_cache.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+static std::string to_hex(const uint8_t * data, size_t size)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(size * 2);
+  for (size_t i = 0; i < size; i++) {
+    hex.push_back(digits[data[i] >> 4]);
+    hex.push_back(digits[data[i] & 0x0f]);
+  }
+  return hex;
+}
+
+static bool from_hex(const std::string & hex, uint8_t * data, size_t size)
+{
+  if (hex.size() != size * 2) {
+    return false;
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    unsigned int byte = 0;
+    if (std::sscanf(hex.c_str() + i * 2, "%2x", &byte) != 1) {
+      return false;
+    }
+    data[i] = static_cast<uint8_t>(byte);
+  }
+  return true;
+}
+
+static bool read_gid(std::istream & in, rmw_gid_t & gid)
+{
+  std::string hex;
+  std::memset(&gid, 0, sizeof(gid));
+  gid.implementation_identifier = RMW_GURUMDDS_ID;
+  return static_cast<bool>(in >> hex) && from_hex(hex, gid.data, RMW_GID_STORAGE_SIZE);
+}
+
+static std::string gid_to_hex(const rmw_gid_t & gid)
+{
+  return to_hex(gid.data, RMW_GID_STORAGE_SIZE);
+}
+
+static bool read_time(std::istream & in, rmw_time_t & time)
+{
+  unsigned long long sec = 0;
+  unsigned long long nsec = 0;
+  if (!(in >> sec >> nsec)) {
+    return false;
+  }
+  time.sec = sec;
+  time.nsec = nsec;
+  return true;
+}
+
+static void write_time(std::ostream & out, const rmw_time_t & time)
+{
+  out << ' ' << static_cast<unsigned long long>(time.sec) << ' ' <<
+    static_cast<unsigned long long>(time.nsec);
+}
+
+static bool read_entity(std::istream & in, CachedEntity & entity)
+{
+  std::string hash;
+  unsigned int hash_version = 0;
+  unsigned int history = 0;
+  unsigned long long depth = 0;
+  unsigned int reliability = 0;
+  unsigned int durability = 0;
+  unsigned int liveliness = 0;
+  rmw_qos_profile_t & qos = entity.qos;
+  if (!read_gid(in, entity.gid) || !read_gid(in, entity.participant_gid) ||
+    !(in >> entity.topic_name >> entity.type_name >> hash_version >> hash >> history >>
+    depth >> reliability >> durability) ||
+    !read_time(in, qos.deadline) || !read_time(in, qos.lifespan) || !(in >> liveliness) ||
+    !read_time(in, qos.liveliness_lease_duration) ||
+    !from_hex(hash, entity.type_hash.value, sizeof(entity.type_hash.value)))
+  {
+    return false;
+  }
+
+  entity.type_hash.version = static_cast<uint8_t>(hash_version);
+  qos.history = static_cast<rmw_qos_history_policy_t>(history);
+  qos.depth = static_cast<size_t>(depth);
+  qos.reliability = static_cast<rmw_qos_reliability_policy_t>(reliability);
+  qos.durability = static_cast<rmw_qos_durability_policy_t>(durability);
+  qos.liveliness = static_cast<rmw_qos_liveliness_policy_t>(liveliness);
+  qos.avoid_ros_namespace_conventions = false;
+  return true;
+}
+
+DiscoveryCache::DiscoveryCache(const std::string & path, uint64_t confirm_timeout_ns)
+: path_{path}, confirm_timeout_ns_{confirm_timeout_ns}
+{
+}
+
+void DiscoveryCache::load(
+  uint64_t now_ns,
+  std::vector<CachedParticipant> & participants,
+  std::vector<CachedEntity> & entities)
+{
+  participants.clear();
+  entities.clear();
+
+  std::ifstream file{path_};
+  if (!file) {
+    return;
+  }
+
+  std::vector<CachedParticipant> read_participants;
+  std::vector<CachedEntity> read_entities;
+  std::string line;
+  size_t line_number = 1;
+  bool valid = static_cast<bool>(std::getline(file, line));
+  if (valid) {
+    std::istringstream in{line};
+    std::string magic;
+    int version = 0;
+    valid = (in >> magic >> version) && magic == DISCOVERY_CACHE_MAGIC &&
+      version == DISCOVERY_CACHE_VERSION;
+  }
+
+  while (valid && std::getline(file, line)) {
+    line_number++;
+    std::istringstream in{line};
+    std::string kind;
+    if (!(in >> kind)) {
+      continue;
+    }
+
+    CachedParticipant * participant =
+      read_participants.empty() ? nullptr : &read_participants.back();
+    CachedNode * node =
+      participant == nullptr || participant->nodes.empty() ? nullptr : &participant->nodes.back();
+    rmw_gid_t gid;
+    if (kind == "participant") {
+      CachedParticipant entry{};
+      valid = read_gid(in, entry.gid);
+      // The rest of the line, empty for no enclave
+      std::getline(in >> std::ws, entry.enclave);
+      read_participants.push_back(std::move(entry));
+    } else if (kind == "node" && participant != nullptr) {
+      CachedNode entry;
+      valid = static_cast<bool>(in >> entry.node_namespace >> entry.node_name);
+      participant->nodes.push_back(std::move(entry));
+      participant->has_nodes = true;
+    } else if (kind == "nodes" && participant != nullptr) {
+      // A participant that announced no node yet is distinguished from one without nodes
+      participant->has_nodes = true;
+    } else if ((kind == "node_reader" || kind == "node_writer") && node != nullptr) {
+      valid = read_gid(in, gid);
+      (kind == "node_reader" ? node->readers : node->writers).push_back(gid);
+    } else if (kind == "reader" || kind == "writer") {
+      CachedEntity entry{};
+      entry.qos = rmw_qos_profile_t{};
+      entry.is_reader = kind == "reader";
+      valid = read_entity(in, entry);
+      read_entities.push_back(std::move(entry));
+    } else {
+      valid = false;
+    }
+  }
+
+  if (!valid) {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "%s:%zu: malformed discovery cache, ignored", path_.c_str(), line_number);
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  // Entries discovered while the file was read are kept as they are
+  for (CachedParticipant & entry : read_participants) {
+    if (participants_.emplace(entry.gid, entry).second) {
+      participants.push_back(std::move(entry));
+    }
+  }
+  for (CachedEntity & entry : read_entities) {
+    if (entities_.emplace(entry.gid, entry).second) {
+      entities.push_back(std::move(entry));
+    }
+  }
+  if (!participants.empty() || !entities.empty()) {
+    expiry_ns_ = now_ns + confirm_timeout_ns_;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID, "seeding graph from discovery cache '%s': participants=%zu, entities=%zu",
+    path_.c_str(), participants.size(), entities.size());
+}
+
+bool DiscoveryCache::save()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (!dirty_) {
+    return true;
+  }
+  return save_unsafe();
+}
+
+void DiscoveryCache::add_participant(const rmw_gid_t & gid, const std::string & enclave)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto it = participants_.find(gid);
+  if (it == participants_.end()) {
+    it = participants_.emplace(gid, CachedParticipant{gid, enclave, {}, true, false}).first;
+  }
+  it->second.enclave = enclave;
+  it->second.confirmed = true;
+  dirty_ = true;
+}
+
+void DiscoveryCache::remove_participant(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (participants_.erase(gid) > 0) {
+    dirty_ = true;
+  }
+}
+
+void DiscoveryCache::update_participant(
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  rmw_gid_t participant_gid;
+  rmw_dds_common::convert_msg_to_gid(&msg.gid, &participant_gid);
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto it = participants_.find(participant_gid);
+  if (it == participants_.end()) {
+    // Announced before the participant was discovered
+    it = participants_.emplace(
+      participant_gid, CachedParticipant{participant_gid, "", {}, true, true}).first;
+  }
+
+  CachedParticipant & participant = it->second;
+  participant.confirmed = true;
+  participant.has_nodes = true;
+  participant.nodes.clear();
+  rmw_gid_t gid;
+  for (const auto & node_info : msg.node_entities_info_seq) {
+    CachedNode node;
+    node.node_namespace = node_info.node_namespace;
+    node.node_name = node_info.node_name;
+    for (const auto & reader_gid : node_info.reader_gid_seq) {
+      rmw_dds_common::convert_msg_to_gid(&reader_gid, &gid);
+      node.readers.push_back(gid);
+    }
+    for (const auto & writer_gid : node_info.writer_gid_seq) {
+      rmw_dds_common::convert_msg_to_gid(&writer_gid, &gid);
+      node.writers.push_back(gid);
+    }
+    participant.nodes.push_back(std::move(node));
+  }
+  dirty_ = true;
+}
+
+void DiscoveryCache::add_entity(const CachedEntity & entity)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  CachedEntity & entry = entities_[entity.gid];
+  entry = entity;
+  entry.confirmed = true;
+  dirty_ = true;
+}
+
+void DiscoveryCache::remove_entity(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (entities_.erase(gid) > 0) {
+    dirty_ = true;
+  }
+}
+
+void DiscoveryCache::take_expired(
+  uint64_t now_ns,
+  std::vector<rmw_gid_t> & participants,
+  std::vector<std::pair<rmw_gid_t, bool>> & entities)
+{
+  participants.clear();
+  entities.clear();
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (expiry_ns_ == 0 || now_ns < expiry_ns_) {
+    return;
+  }
+  expiry_ns_ = 0;
+
+  for (auto it = entities_.begin(); it != entities_.end(); ) {
+    if (it->second.confirmed) {
+      ++it;
+      continue;
+    }
+    entities.emplace_back(it->first, it->second.is_reader);
+    it = entities_.erase(it);
+  }
+  for (auto it = participants_.begin(); it != participants_.end(); ) {
+    if (it->second.confirmed) {
+      ++it;
+      continue;
+    }
+    participants.push_back(it->first);
+    it = participants_.erase(it);
+  }
+
+  if (!participants.empty() || !entities.empty()) {
+    dirty_ = true;
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID, "purged stale discovery cache entries: participants=%zu, entities=%zu",
+      participants.size(), entities.size());
+  }
+}
+
+bool DiscoveryCache::save_if_due(uint64_t now_ns)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (now_ns < next_save_ns_) {
+    return true;
+  }
+
+  // Checked once per period even while nothing changes, as the discovery callbacks of GurumDDS
+  // do not wake the listener thread
+  next_save_ns_ = now_ns + DISCOVERY_CACHE_SAVE_PERIOD_MS * 1000000ull;
+  if (!dirty_) {
+    return true;
+  }
+  return save_unsafe();
+}
+
+uint64_t DiscoveryCache::get_deadline() const
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (expiry_ns_ != 0 && expiry_ns_ < next_save_ns_) {
+    return expiry_ns_;
+  }
+  return next_save_ns_;
+}
+
+bool DiscoveryCache::save_unsafe()
+{
+  // Written aside and renamed, so that a crash while writing leaves the previous file
+  const std::string temp_path = path_ + ".tmp";
+  std::ofstream file{temp_path, std::ios::out | std::ios::trunc};
+  if (!file) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to open discovery cache file '%s'", temp_path.c_str());
+    return false;
+  }
+
+  file << DISCOVERY_CACHE_MAGIC << ' ' << DISCOVERY_CACHE_VERSION << '\n';
+  for (const auto & item : participants_) {
+    const CachedParticipant & participant = item.second;
+    file << "participant " << gid_to_hex(participant.gid) << ' ' << participant.enclave << '\n';
+    if (participant.has_nodes) {
+      file << "nodes\n";
+    }
+    for (const CachedNode & node : participant.nodes) {
+      file << "node " << node.node_namespace << ' ' << node.node_name << '\n';
+      for (const rmw_gid_t & gid : node.readers) {
+        file << "node_reader " << gid_to_hex(gid) << '\n';
+      }
+      for (const rmw_gid_t & gid : node.writers) {
+        file << "node_writer " << gid_to_hex(gid) << '\n';
+      }
+    }
+  }
+  for (const auto & item : entities_) {
+    const CachedEntity & entity = item.second;
+    const rmw_qos_profile_t & qos = entity.qos;
+    file << (entity.is_reader ? "reader " : "writer ") << gid_to_hex(entity.gid) << ' ' <<
+      gid_to_hex(entity.participant_gid) << ' ' << entity.topic_name << ' ' <<
+      entity.type_name << ' ' << static_cast<unsigned int>(entity.type_hash.version) << ' ' <<
+      to_hex(entity.type_hash.value, sizeof(entity.type_hash.value)) << ' ' <<
+      static_cast<unsigned int>(qos.history) << ' ' <<
+      static_cast<unsigned long long>(qos.depth) << ' ' <<
+      static_cast<unsigned int>(qos.reliability) << ' ' <<
+      static_cast<unsigned int>(qos.durability);
+    write_time(file, qos.deadline);
+    write_time(file, qos.lifespan);
+    file << ' ' << static_cast<unsigned int>(qos.liveliness);
+    write_time(file, qos.liveliness_lease_duration);
+    file << '\n';
+  }
+
+  file.close();
+  if (file.fail()) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to write discovery cache file '%s'", temp_path.c_str());
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  if (std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to replace discovery cache file '%s'", path_.c_str());
+    std::remove(temp_path.c_str());
+    return false;
+  }
+
+  dirty_ = false;
+  return true;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,238 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <mutex>
+
+#include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
+
+#include "rmw_gurumdds_cpp/async_publish.hpp"
+#include "rmw_gurumdds_cpp/endpoint_stats.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/event_info_service.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+void WriterCounters::get(WriterStats & stats) const
+{
+  stats.sample_count = samples_.load(std::memory_order_relaxed);
+  stats.byte_count = bytes_.load(std::memory_order_relaxed);
+  stats.serialization_time_ns = serialization_ns_.load(std::memory_order_relaxed);
+  stats.write_time_ns = write_ns_.load(std::memory_order_relaxed);
+  stats.dropped_count = dropped_.load(std::memory_order_relaxed);
+}
+
+void ReaderCounters::get(ReaderStats & stats) const
+{
+  stats.sample_count = samples_.load(std::memory_order_relaxed);
+  stats.byte_count = bytes_.load(std::memory_order_relaxed);
+  stats.deserialization_time_ns = deserialization_ns_.load(std::memory_order_relaxed);
+  stats.take_time_ns = take_ns_.load(std::memory_order_relaxed);
+  stats.take_no_data_count = no_data_.load(std::memory_order_relaxed);
+  stats.lost_count = 0;
+  stats.sequence_gap_count = sequence_gaps_.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogramCounters::get(LatencyHistogram & histogram) const
+{
+  histogram.count = count_.load(std::memory_order_relaxed);
+  histogram.total_ns = total_ns_.load(std::memory_order_relaxed);
+  histogram.max_ns = max_ns_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    histogram.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+}
+
+void LatencyCounters::get(SubscriptionLatencyStats & stats) const
+{
+  transport_.get(stats.transport);
+  queueing_.get(stats.queueing);
+}
+
+void WaitSetCounters::get(WaitSetStats & stats) const
+{
+  stats.wait_count = waits_.load(std::memory_order_relaxed);
+  stats.attach_time_ns = attach_ns_.load(std::memory_order_relaxed);
+  stats.wait_time_ns = wait_ns_.load(std::memory_order_relaxed);
+  stats.process_time_ns = process_ns_.load(std::memory_order_relaxed);
+}
+
+rmw_ret_t
+get_publisher_stats(const rmw_publisher_t * publisher, WriterStats * stats)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(stats, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+  publisher_info->stats.get(*stats);
+
+  // The sender thread counts the samples it drops or fails to write
+  if (publisher_info->async != nullptr) {
+    AsyncPublishStatus status;
+    publisher_info->async->get_status(status);
+    stats->dropped_count += status.dropped_count + status.failed_count;
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_subscription_stats(const rmw_subscription_t * subscription, ReaderStats * stats)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(stats, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+  subscriber_info->stats.get(*stats);
+
+  std::lock_guard<std::mutex> guard{subscriber_info->mutex_event};
+  stats->lost_count = static_cast<uint64_t>(subscriber_info->sample_lost_status.total_count);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_subscription_writer_stats(
+  const rmw_subscription_t * subscription,
+  WriterSequenceStats * stats,
+  size_t capacity,
+  size_t * count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(count, RMW_RET_INVALID_ARGUMENT);
+  if (capacity > 0) {
+    RMW_CHECK_ARGUMENT_FOR_NULL(stats, RMW_RET_INVALID_ARGUMENT);
+  }
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  std::lock_guard<std::mutex> guard{subscriber_info->mutex_publications};
+  size_t index = 0;
+  for (const auto & entry : subscriber_info->publications) {
+    const MatchedPublication & publication = entry.second;
+    // Writers only looked up for the message info have no sequence number yet
+    if (publication.last_sequence_number == 0) {
+      continue;
+    }
+    if (index < capacity) {
+      std::memcpy(stats[index].writer_gid, publication.guid.data(), RMW_GID_STORAGE_SIZE);
+      stats[index].last_sequence_number = publication.last_sequence_number;
+      stats[index].gap_count = publication.gap_count;
+    }
+    index++;
+  }
+  *count = index;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_subscription_latency_stats(
+  const rmw_subscription_t * subscription,
+  SubscriptionLatencyStats * stats)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(stats, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+  if (subscriber_info->latency == nullptr) {
+    RMW_SET_ERROR_MSG("latency statistics are not enabled for the topic of the subscription");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  subscriber_info->latency->get(*stats);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_client_stats(const rmw_client_t * client, WriterStats * requests, ReaderStats * responses)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(requests, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(responses, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    client,
+    client->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto client_info = static_cast<ClientInfo *>(client->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(client_info, RMW_RET_ERROR);
+  client_info->request_stats.get(*requests);
+  client_info->response_stats.get(*responses);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_service_stats(const rmw_service_t * service, ReaderStats * requests, WriterStats * responses)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(requests, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(responses, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    service,
+    service->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto service_info = static_cast<ServiceInfo *>(service->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(service_info, RMW_RET_ERROR);
+  service_info->request_stats.get(*requests);
+  service_info->response_stats.get(*responses);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+get_wait_set_stats(const rmw_wait_set_t * wait_set, WaitSetStats * stats)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(wait_set, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(stats, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    wait_set,
+    wait_set->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto wait_set_info = static_cast<WaitSetInfo *>(wait_set->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(wait_set_info, RMW_RET_ERROR);
+  wait_set_info->stats.get(*stats);
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,227 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
+
+#include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_fd.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/event_info_service.hpp"
+#include "rmw_gurumdds_cpp/guard_condition.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Guard conditions are plain DDS conditions, their eventfds are kept here
+static std::mutex guard_condition_fds_mutex;
+static std::unordered_map<dds_GuardCondition *, int> guard_condition_fds;
+static std::atomic<size_t> guard_condition_fd_count{0};
+
+void
+write_event_fd(int event_fd)
+{
+#ifndef _WIN32
+  if (event_fd < 0) {
+    return;
+  }
+
+  const uint64_t value = 1;
+  while (write(event_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+  }
+#else
+  static_cast<void>(event_fd);
+#endif
+}
+
+void
+notify_guard_condition_event_fd(dds_GuardCondition * guard_condition)
+{
+  if (guard_condition_fd_count.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(guard_condition_fds_mutex);
+  auto it = guard_condition_fds.find(guard_condition);
+  if (it != guard_condition_fds.end()) {
+    write_event_fd(it->second);
+  }
+}
+
+void
+remove_guard_condition_event_fd(dds_GuardCondition * guard_condition)
+{
+  if (guard_condition_fd_count.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(guard_condition_fds_mutex);
+  guard_condition_fds.erase(guard_condition);
+  guard_condition_fd_count.store(guard_condition_fds.size(), std::memory_order_relaxed);
+}
+
+#ifdef _WIN32
+#define RETURN_IF_EVENT_FD_UNSUPPORTED() \
+  RMW_SET_ERROR_MSG("event fds are not supported on this platform"); \
+  return RMW_RET_UNSUPPORTED;
+#else
+#define RETURN_IF_EVENT_FD_UNSUPPORTED()
+#endif
+
+rmw_ret_t
+set_subscription_event_fd(rmw_subscription_t * subscription, int event_fd)
+{
+  RETURN_IF_EVENT_FD_UNSUPPORTED();
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid subscription data");
+    return RMW_RET_ERROR;
+  }
+
+  std::lock_guard<std::mutex> guard(subscriber_info->event_callback_data.mutex);
+  subscriber_info->event_callback_data.event_fd = event_fd;
+  if (subscriber_info->event_callback_data.is_set_unsafe()) {
+    subscriber_info->mask |= dds_DATA_AVAILABLE_STATUS;
+  } else {
+    subscriber_info->mask &= ~dds_DATA_AVAILABLE_STATUS;
+  }
+
+  dds_ReturnCode_t dds_rc = dds_DataReader_set_listener(
+    subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
+
+  // Samples that arrived before the fd was set would not wake the executor up
+  if (event_fd >= 0 && subscriber_info->count_unread() > 0) {
+    write_event_fd(event_fd);
+  }
+
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+set_service_event_fd(rmw_service_t * service, int event_fd)
+{
+  RETURN_IF_EVENT_FD_UNSUPPORTED();
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    service,
+    service->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto service_info = static_cast<ServiceInfo *>(service->data);
+  if (service_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid service data");
+    return RMW_RET_ERROR;
+  }
+
+  std::lock_guard<std::mutex> guard(service_info->event_callback_data.mutex);
+  service_info->event_callback_data.event_fd = event_fd;
+  dds_StatusMask mask = dds_DataReader_get_status_changes(service_info->request_reader);
+  if (service_info->event_callback_data.is_set_unsafe()) {
+    mask |= dds_DATA_AVAILABLE_STATUS;
+  } else {
+    mask &= ~dds_DATA_AVAILABLE_STATUS;
+  }
+
+  dds_ReturnCode_t dds_rc = dds_DataReader_set_listener(
+    service_info->request_reader, &service_info->request_listener, mask);
+
+  if (event_fd >= 0 && service_info->count_unread() > 0) {
+    write_event_fd(event_fd);
+  }
+
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+set_client_event_fd(rmw_client_t * client, int event_fd)
+{
+  RETURN_IF_EVENT_FD_UNSUPPORTED();
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    client,
+    client->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto client_info = static_cast<ClientInfo *>(client->data);
+  if (client_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid client data");
+    return RMW_RET_ERROR;
+  }
+
+  std::lock_guard<std::mutex> guard(client_info->event_callback_data.mutex);
+  client_info->event_callback_data.event_fd = event_fd;
+  dds_StatusMask mask = CLIENT_RESPONSE_LISTENER_MASK;
+  if (client_info->event_callback_data.is_set_unsafe()) {
+    mask |= dds_DATA_AVAILABLE_STATUS;
+  } else {
+    mask &= ~dds_DATA_AVAILABLE_STATUS;
+  }
+
+  dds_ReturnCode_t dds_rc = dds_DataReader_set_listener(
+    client_info->response_reader, &client_info->response_listener, mask);
+
+  if (event_fd >= 0 && client_info->count_unread() > 0) {
+    write_event_fd(event_fd);
+  }
+
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+set_guard_condition_event_fd(rmw_guard_condition_t * guard_condition, int event_fd)
+{
+  RETURN_IF_EVENT_FD_UNSUPPORTED();
+  RMW_CHECK_ARGUMENT_FOR_NULL(guard_condition, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    guard condition,
+    guard_condition->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  dds_GuardCondition * dds_guard_condition =
+    static_cast<GuardCondition *>(guard_condition->data)->condition;
+  std::lock_guard<std::mutex> guard(guard_condition_fds_mutex);
+  if (event_fd >= 0) {
+    guard_condition_fds[dds_guard_condition] = event_fd;
+    if (dds_Condition_get_trigger_value(reinterpret_cast<dds_Condition *>(dds_guard_condition))) {
+      write_event_fd(event_fd);
+    }
+  } else {
+    guard_condition_fds.erase(dds_guard_condition);
+  }
+  guard_condition_fd_count.store(guard_condition_fds.size(), std::memory_order_relaxed);
+
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
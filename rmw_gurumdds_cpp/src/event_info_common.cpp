@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_fd.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
 #include "rmw_gurumdds_cpp/gid.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
@@ -23,95 +26,144 @@
 
 namespace rmw_gurumdds_cpp
 {
-void PublisherInfo::update_inconsistent_topic(int32_t total_count, int32_t total_count_change)
+static void set_trigger_value(const std::atomic<dds_GuardCondition *> & guard_cond, bool value)
 {
-  std::lock_guard guard_callback{mutex_event};
-  inconsistent_topic_changed = true;
-  inconsistent_topic_status.total_count_change += total_count_change;
-  inconsistent_topic_status.total_count = total_count;
+  dds_GuardCondition * condition = guard_cond.load(std::memory_order_acquire);
+  if (condition != nullptr) {
+    dds_GuardCondition_set_trigger_value(condition, value);
+  }
+}
 
-  auto callback = on_new_event_cb[RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE];
-  auto user_data = user_data_cb[RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE];
-  if(nullptr != callback) {
-    callback(user_data, total_count_change);
+// Invokes the event callback without mutex_event, a slow callback only delays other callbacks
+template<typename InfoT>
+static void notify_event(InfoT & info, rmw_event_type_t event_type, int32_t changes)
+{
+  {
+    std::lock_guard guard{info.mutex_event_callback};
+    rmw_event_callback_t callback = info.on_new_event_cb[event_type];
+    if(nullptr != callback) {
+      callback(info.user_data_cb[event_type], changes);
+    }
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE], true);
+  set_trigger_value(info.event_guard_cond[event_type], true);
 }
 
-void PublisherInfo::on_offered_deadline_missed(const dds_OfferedDeadlineMissedStatus & status)
+// Event guard conditions are only needed by wait sets, they are created on first use
+template<typename InfoT>
+static dds_GuardCondition * get_or_create_guard_condition(InfoT & info, rmw_event_type_t event_type)
 {
-  std::lock_guard guard_callback{mutex_event};
-  offered_deadline_missed_changed = true;
-  liveliness_lost_status.total_count_change += status.total_count_change;
-  liveliness_lost_status.total_count = status.total_count;
+  dds_GuardCondition * condition =
+    info.event_guard_cond[event_type].load(std::memory_order_acquire);
+  if (condition != nullptr) {
+    return condition;
+  }
+
+  std::lock_guard guard{info.mutex_event};
+  std::atomic_bool * changed = info.get_changed_flag(event_type);
+  if (changed == nullptr) {
+    return nullptr;
+  }
 
-  auto callback = on_new_event_cb[RMW_EVENT_OFFERED_DEADLINE_MISSED];
-  auto user_data = user_data_cb[RMW_EVENT_OFFERED_DEADLINE_MISSED];
-  if(nullptr != callback) {
-    callback(user_data, liveliness_lost_status.total_count_change);
+  condition = info.event_guard_cond[event_type].load(std::memory_order_relaxed);
+  if (condition == nullptr) {
+    condition = dds_GuardCondition_create();
+    if (condition == nullptr) {
+      return nullptr;
+    }
+
+    // Changes are flagged under mutex_event, one flagged before now has not triggered anything
+    if (*changed) {
+      dds_GuardCondition_set_trigger_value(condition, true);
+    }
+    info.event_guard_cond[event_type].store(condition, std::memory_order_release);
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_OFFERED_DEADLINE_MISSED], true);
+  return condition;
 }
 
-void PublisherInfo::on_offered_incompatible_qos(const dds_OfferedIncompatibleQosStatus & status)
+void PublisherInfo::update_inconsistent_topic(int32_t total_count, int32_t total_count_change)
 {
-  std::lock_guard guard_callback{mutex_event};
-  offered_incompatible_qos_changed = true;
-  offered_incompatible_qos_status.total_count_change += status.total_count_change;
-  offered_incompatible_qos_status.total_count = status.total_count;
-  offered_incompatible_qos_status.last_policy_id = status.last_policy_id;
+  {
+    std::lock_guard guard{mutex_event};
+    inconsistent_topic_status.total_count_change += total_count_change;
+    inconsistent_topic_status.total_count = total_count;
+    inconsistent_topic_changed = true;
+  }
 
-  auto callback = on_new_event_cb[RMW_EVENT_OFFERED_QOS_INCOMPATIBLE];
-  auto user_data = user_data_cb[RMW_EVENT_OFFERED_QOS_INCOMPATIBLE];
-  if(nullptr != callback) {
-    callback(user_data, offered_incompatible_qos_status.total_count_change);
+  notify_event(*this, RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE, total_count_change);
+}
+
+void PublisherInfo::on_offered_deadline_missed(const dds_OfferedDeadlineMissedStatus & status)
+{
+  int32_t changes;
+  {
+    std::lock_guard guard{mutex_event};
+    offered_deadline_missed_status.total_count_change += status.total_count_change;
+    offered_deadline_missed_status.total_count = status.total_count;
+    offered_deadline_missed_changed = true;
+    changes = offered_deadline_missed_status.total_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_OFFERED_QOS_INCOMPATIBLE], true);
+  notify_event(*this, RMW_EVENT_OFFERED_DEADLINE_MISSED, changes);
 }
 
-void PublisherInfo::on_liveliness_lost(const dds_LivelinessLostStatus & status) {
-  std::lock_guard guard_callback{mutex_event};
-  liveliness_lost_changed = true;
-  liveliness_lost_status.total_count_change += status.total_count_change;
-  liveliness_lost_status.total_count = status.total_count;
+void PublisherInfo::on_offered_incompatible_qos(const dds_OfferedIncompatibleQosStatus & status)
+{
+  int32_t changes;
+  {
+    std::lock_guard guard{mutex_event};
+    offered_incompatible_qos_status.total_count_change += status.total_count_change;
+    offered_incompatible_qos_status.total_count = status.total_count;
+    offered_incompatible_qos_status.last_policy_id = status.last_policy_id;
+    offered_incompatible_qos_changed = true;
+    changes = offered_incompatible_qos_status.total_count_change;
+  }
 
-  auto callback = on_new_event_cb[RMW_EVENT_LIVELINESS_LOST];
-  auto user_data = user_data_cb[RMW_EVENT_LIVELINESS_LOST];
-  if(nullptr != callback) {
-    callback(user_data, liveliness_lost_status.total_count_change);
+  notify_event(*this, RMW_EVENT_OFFERED_QOS_INCOMPATIBLE, changes);
+}
+
+void PublisherInfo::on_liveliness_lost(const dds_LivelinessLostStatus & status) {
+  int32_t changes;
+  {
+    std::lock_guard guard{mutex_event};
+    liveliness_lost_status.total_count_change += status.total_count_change;
+    liveliness_lost_status.total_count = status.total_count;
+    liveliness_lost_changed = true;
+    changes = liveliness_lost_status.total_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_LIVELINESS_LOST], true);
+  notify_event(*this, RMW_EVENT_LIVELINESS_LOST, changes);
 }
 
 void PublisherInfo::on_publication_matched(const dds_PublicationMatchedStatus & status) {
-  std::lock_guard guard_callback{mutex_event};
-  publication_matched_changed = true;
-  publication_matched_status.total_count_change += status.total_count_change;
-  publication_matched_status.total_count = status.total_count;
-  publication_matched_status.current_count_change += status.current_count_change;
-  publication_matched_status.current_count = status.current_count;
+  if (local_delivery) {
+    ctx->intra_context->on_publication_matched(this);
+  }
 
-  auto callback = on_new_event_cb[RMW_EVENT_PUBLICATION_MATCHED];
-  auto user_data = user_data_cb[RMW_EVENT_PUBLICATION_MATCHED];
-  if(nullptr != callback) {
-    callback(user_data, publication_matched_status.total_count_change);
+  int32_t changes;
+  {
+    std::lock_guard guard{mutex_event};
+    publication_matched_status.total_count_change += status.total_count_change;
+    publication_matched_status.total_count = status.total_count;
+    publication_matched_status.current_count_change += status.current_count_change;
+    publication_matched_status.current_count = status.current_count;
+    publication_matched_changed = true;
+    changes = publication_matched_status.total_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_PUBLICATION_MATCHED], true);
+  notify_event(*this, RMW_EVENT_PUBLICATION_MATCHED, changes);
 }
 
 rmw_ret_t PublisherInfo::set_on_new_event_callback(
   rmw_event_type_t event_type,
   const void * user_data,
   rmw_event_callback_t callback) {
-  std::lock_guard guard{mutex_event};
+  std::lock_guard callback_guard{mutex_event_callback};
+  std::unique_lock guard{mutex_event};
   dds_StatusMask event_status_type = rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type);
+  int32_t changes = 0;
   if(callback != nullptr) {
-    int32_t changes;
     dds_Topic* topic;
     switch(event_type) {
       case RMW_EVENT_LIVELINESS_LOST:
@@ -140,7 +192,10 @@ rmw_ret_t PublisherInfo::set_on_new_event_callback(
         inconsistent_topic_changed = false;
         break;
       case RMW_EVENT_PUBLICATION_MATCHED:
-        dds_DataWriter_get_publication_matched_status(topic_writer, &publication_matched_status);
+        // Kept by the listener when it always gets the status, reading it would drop changes
+        if ((internal_mask & event_status_type) == 0) {
+          dds_DataWriter_get_publication_matched_status(topic_writer, &publication_matched_status);
+        }
         changes = publication_matched_status.total_count_change;
         publication_matched_status.total_count_change = 0;
         publication_matched_status.current_count_change = 0;
@@ -150,20 +205,23 @@ rmw_ret_t PublisherInfo::set_on_new_event_callback(
           return RMW_RET_UNSUPPORTED;
     }
 
-    if(changes > 0) {
-      callback(user_data, changes);
-    }
-
     mask |= event_status_type;
     on_new_event_cb[event_type] = callback;
     user_data_cb[event_type] = user_data;
   } else {
-    mask &= ~event_status_type;
+    mask &= ~event_status_type | internal_mask;
     on_new_event_cb[event_type] = nullptr;
     user_data_cb[event_type] = nullptr;
   }
 
+  callback_mask = mask;
   dds_DataWriter_set_listener(topic_writer, &topic_listener, mask);
+  guard.unlock();
+
+  if(changes > 0) {
+    callback(user_data, changes);
+  }
+
   return RMW_RET_OK;
 }
 
@@ -234,7 +292,7 @@ rmw_ret_t PublisherInfo::get_status(rmw_event_type_t event_type, void * event)
     return RMW_RET_UNSUPPORTED;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[event_type], false);
+  set_trigger_value(event_guard_cond[event_type], false);
   return RMW_RET_OK;
 }
 
@@ -245,36 +303,40 @@ dds_StatusCondition * PublisherInfo::get_status_condition()
 
 dds_GuardCondition * PublisherInfo::get_guard_condition(rmw_event_type_t event_type)
 {
-  return event_guard_cond[event_type];
+  return get_or_create_guard_condition(*this, event_type);
+}
+
+std::atomic_bool * PublisherInfo::get_changed_flag(rmw_event_type_t event_type)
+{
+  switch(event_type) {
+    case RMW_EVENT_LIVELINESS_LOST:
+      return &liveliness_lost_changed;
+    case RMW_EVENT_OFFERED_DEADLINE_MISSED:
+      return &offered_deadline_missed_changed;
+    case RMW_EVENT_OFFERED_QOS_INCOMPATIBLE:
+      return &offered_incompatible_qos_changed;
+    case RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE:
+      return &inconsistent_topic_changed;
+    case RMW_EVENT_PUBLICATION_MATCHED:
+      return &publication_matched_changed;
+    default:
+      return nullptr;
+  }
 }
 
 bool PublisherInfo::is_status_changed(rmw_event_type_t event_type)
 {
-  std::lock_guard lock_guard{mutex_event};
+  // The flags are set before the guard condition is triggered, mutex_event is not needed
   bool changed = false;
-  if(has_callback_unsafe(event_type)) {
-    switch(event_type) {
-      case RMW_EVENT_LIVELINESS_LOST:
-        changed = liveliness_lost_changed;
-        break;
-      case RMW_EVENT_OFFERED_DEADLINE_MISSED:
-        changed = offered_deadline_missed_changed;
-        break;
-      case RMW_EVENT_OFFERED_QOS_INCOMPATIBLE:
-        changed = offered_incompatible_qos_changed;
-        break;
-      case RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE:
-        changed = inconsistent_topic_changed;
-        break;
-      case RMW_EVENT_PUBLICATION_MATCHED:
-        changed = publication_matched_changed;
-        break;
-      default:
-        return false;
+  if(has_callback(event_type)) {
+    std::atomic_bool * flag = get_changed_flag(event_type);
+    if(nullptr == flag) {
+      return false;
     }
 
+    changed = *flag;
     if(changed) {
-      dds_GuardCondition_set_trigger_value(event_guard_cond[event_type], false);
+      set_trigger_value(event_guard_cond[event_type], false);
     }
   }
 
@@ -286,15 +348,9 @@ bool PublisherInfo::is_status_changed(rmw_event_type_t event_type)
 }
 
 bool PublisherInfo::has_callback(rmw_event_type_t event_type)
-{
-  std::lock_guard lock_guard{mutex_event};
-  return has_callback_unsafe(event_type);
-}
-
-bool PublisherInfo::has_callback_unsafe(rmw_event_type_t event_type) const
 {
   // RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE is always used with a callback
-  return ((mask | dds_INCONSISTENT_TOPIC_STATUS) & rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type)) > 0;
+  return ((callback_mask | dds_INCONSISTENT_TOPIC_STATUS) & rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type)) > 0;
 }
 
 rmw_ret_t SubscriberInfo::set_on_new_event_callback(
@@ -302,10 +358,11 @@ rmw_ret_t SubscriberInfo::set_on_new_event_callback(
   const void * user_data,
   rmw_event_callback_t callback)
 {
-  std::lock_guard guard{mutex_event};
+  std::lock_guard callback_guard{mutex_event_callback};
+  std::unique_lock guard{mutex_event};
   dds_StatusMask event_status_type = rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type);
+  int32_t changes = 0;
   if(callback != nullptr) {
-    int32_t changes;
     dds_Topic* topic;
     switch(event_type) {
       case RMW_EVENT_LIVELINESS_CHANGED:
@@ -330,8 +387,9 @@ rmw_ret_t SubscriberInfo::set_on_new_event_callback(
         break;
       case RMW_EVENT_MESSAGE_LOST:
         dds_DataReader_get_sample_lost_status(topic_reader, &sample_lost_status);
-        changes = sample_lost_status.total_count_change;
+        changes = sample_lost_status.total_count_change + sequence_gap_lost_change;
         sample_lost_status.total_count_change = 0;
+        sequence_gap_lost_change = 0;
         sample_lost_changed = false;
         break;
       case RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE:
@@ -342,7 +400,11 @@ rmw_ret_t SubscriberInfo::set_on_new_event_callback(
         inconsistent_topic_changed = false;
         break;
       case RMW_EVENT_SUBSCRIPTION_MATCHED:
-        dds_DataReader_get_subscription_matched_status(topic_reader, &subscription_matched_status);
+        // Kept by the listener when it always gets the status, reading it would drop changes
+        if ((internal_mask & event_status_type) == 0) {
+          dds_DataReader_get_subscription_matched_status(
+            topic_reader, &subscription_matched_status);
+        }
         changes = subscription_matched_status.total_count_change;
         subscription_matched_status.total_count_change = 0;
         subscription_matched_status.current_count_change = 0;
@@ -352,20 +414,23 @@ rmw_ret_t SubscriberInfo::set_on_new_event_callback(
         return RMW_RET_UNSUPPORTED;
     }
 
-    if(changes > 0) {
-      callback(user_data, changes);
-    }
-
     mask |= event_status_type;
     on_new_event_cb[event_type] = callback;
     user_data_cb[event_type] = user_data;
   } else {
-    mask &= ~event_status_type;
+    mask &= ~event_status_type | internal_mask;
     on_new_event_cb[event_type] = nullptr;
     user_data_cb[event_type] = nullptr;
   }
 
+  callback_mask = mask;
   dds_DataReader_set_listener(topic_reader, &topic_listener, mask);
+  guard.unlock();
+
+  if(changes > 0) {
+    callback(user_data, changes);
+  }
+
   return RMW_RET_OK;
 }
 
@@ -410,16 +475,21 @@ rmw_ret_t SubscriberInfo::get_status(rmw_event_type_t event_type, void * event)
     rmw_status->last_policy_kind = rmw_gurumdds_cpp::convert_qos_policy(requested_incompatible_qos_status.last_policy_id);
     requested_incompatible_qos_status.total_count_change = 0;
   } else if (event_type == RMW_EVENT_MESSAGE_LOST) {
-    if(sample_lost_changed) {
+    // Without the listener, the flag is only set by sequence number gaps
+    if(sample_lost_changed && (mask & dds_SAMPLE_LOST_STATUS) != 0) {
       sample_lost_changed = false;
     } else {
+      sample_lost_changed = false;
       dds_DataReader_get_sample_lost_status(topic_reader, &sample_lost_status);
     }
 
     auto rmw_status = static_cast<rmw_message_lost_status_t *>(event);
-    rmw_status->total_count = sample_lost_status.total_count;
-    rmw_status->total_count_change = sample_lost_status.total_count_change;
+    rmw_status->total_count =
+      sample_lost_status.total_count + static_cast<int32_t>(sequence_gap_lost_total);
+    rmw_status->total_count_change =
+      sample_lost_status.total_count_change + sequence_gap_lost_change;
     sample_lost_status.total_count_change = 0;
+    sequence_gap_lost_change = 0;
   } else if (event_type == RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE) {
     if(inconsistent_topic_changed) {
       inconsistent_topic_changed = false;
@@ -450,22 +520,19 @@ rmw_ret_t SubscriberInfo::get_status(rmw_event_type_t event_type, void * event)
     return RMW_RET_UNSUPPORTED;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[event_type], false);
+  set_trigger_value(event_guard_cond[event_type], false);
   return RMW_RET_OK;
 }
 
 void SubscriberInfo::update_inconsistent_topic(int32_t total_count, int32_t total_count_change) {
-  inconsistent_topic_status.total_count_change += total_count_change;
-  inconsistent_topic_status.total_count = total_count;
-  inconsistent_topic_changed = true;
-
-  auto callback = on_new_event_cb[RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE];
-  auto user_data = user_data_cb[RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE];
-  if(nullptr != callback) {
-    callback(user_data, total_count_change);
+  {
+    std::lock_guard guard{mutex_event};
+    inconsistent_topic_status.total_count_change += total_count_change;
+    inconsistent_topic_status.total_count = total_count;
+    inconsistent_topic_changed = true;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE], true);
+  notify_event(*this, RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE, total_count_change);
 }
 
 dds_StatusCondition * SubscriberInfo::get_status_condition()
@@ -475,36 +542,41 @@ dds_StatusCondition * SubscriberInfo::get_status_condition()
 
 dds_GuardCondition * SubscriberInfo::get_guard_condition(rmw_event_type_t event_type)
 {
-  return event_guard_cond[event_type];
+  return get_or_create_guard_condition(*this, event_type);
+}
+
+std::atomic_bool * SubscriberInfo::get_changed_flag(rmw_event_type_t event_type)
+{
+  switch(event_type) {
+    case RMW_EVENT_LIVELINESS_CHANGED:
+      return &liveliness_changed;
+    case RMW_EVENT_REQUESTED_DEADLINE_MISSED:
+      return &requested_deadline_missed_changed;
+    case RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE:
+      return &requested_incompatible_qos_changed;
+    case RMW_EVENT_MESSAGE_LOST:
+      return &sample_lost_changed;
+    case RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE:
+      return &inconsistent_topic_changed;
+    case RMW_EVENT_SUBSCRIPTION_MATCHED:
+      return &subscription_matched_changed;
+    default:
+      return nullptr;
+  }
 }
 
 bool SubscriberInfo::is_status_changed(rmw_event_type_t event_type)
 {
-  std::lock_guard lock_guard{mutex_event};
   bool changed = false;
-  if(has_callback_unsafe(event_type)) {
-    switch(event_type) {
-      case RMW_EVENT_LIVELINESS_CHANGED:
-        changed = liveliness_changed;
-        break;
-      case RMW_EVENT_REQUESTED_DEADLINE_MISSED:
-        changed = requested_deadline_missed_changed;
-        break;
-      case RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE:
-        changed = requested_incompatible_qos_changed;
-        break;
-      case RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE:
-        changed = inconsistent_topic_changed;
-        break;
-      case RMW_EVENT_SUBSCRIPTION_MATCHED:
-        changed = subscription_matched_changed;
-        break;
-      default:
-        return false;
+  if(has_callback(event_type)) {
+    std::atomic_bool * flag = get_changed_flag(event_type);
+    if(nullptr == flag) {
+      return false;
     }
 
+    changed = *flag;
     if(changed) {
-      dds_GuardCondition_set_trigger_value(event_guard_cond[event_type], false);
+      set_trigger_value(event_guard_cond[event_type], false);
     }
   }
 
@@ -515,18 +587,20 @@ bool SubscriberInfo::is_status_changed(rmw_event_type_t event_type)
   return changed;
 }
 
-size_t count_unread(
-  dds_DataReader * reader,
-  dds_DataSeq * data_seq,
-  dds_SampleInfoSeq * info_seq,
-  dds_UnsignedLongSeq * raw_data_sizes)
+size_t count_unread(dds_DataReader * reader, SampleSequencePool & sample_pool)
 {
+  SampleSequences sequences{};
+  if (!sample_pool.acquire(1, sequences)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return 0;
+  }
+
   dds_ReturnCode_t rc = dds_DataReader_raw_read(
     reader,
     dds_HANDLE_NIL,
-    data_seq,
-    info_seq,
-    raw_data_sizes,
+    sequences.data_seq,
+    sequences.info_seq,
+    sequences.raw_data_sizes,
     dds_LENGTH_UNLIMITED,
     dds_NOT_READ_SAMPLE_STATE,
     dds_ANY_VIEW_STATE,
@@ -537,125 +611,333 @@ size_t count_unread(
 
   if (dds_RETCODE_OK != rc && dds_RETCODE_NO_DATA != rc) {
     RMW_SET_ERROR_MSG("failed to read raw data from DDS reader");
-    return count;
   } else if(dds_RETCODE_OK == rc) {
-    count = dds_SampleInfoSeq_length(info_seq);
-  }
-
-  rc = dds_DataReader_raw_return_loan(reader, data_seq, info_seq, raw_data_sizes);
-  if (dds_RETCODE_OK != rc && dds_RETCODE_NO_DATA != rc) {
-    RMW_SET_ERROR_MSG("failed to read raw data from DDS reader");
-    return count;
+    count = dds_SampleInfoSeq_length(sequences.info_seq);
   }
 
+  sample_pool.release(reader, sequences);
   return count;
 }
 
 size_t SubscriberInfo::count_unread()
 {
-  return rmw_gurumdds_cpp::count_unread(topic_reader, data_seq, info_seq, raw_data_sizes);
+  size_t count = rmw_gurumdds_cpp::count_unread(topic_reader, sample_pool);
+  if (local_samples != nullptr) {
+    count += local_samples->size();
+  }
+  return count;
+}
+
+bool SubscriberInfo::pop_local_sample(LocalSample & sample)
+{
+  if (local_samples == nullptr) {
+    return false;
+  }
+
+  return local_samples->pop(sample);
 }
 
 void SubscriberInfo::on_requested_deadline_missed(const dds_RequestedDeadlineMissedStatus & status)
 {
-  std::lock_guard guard(mutex_event);
-  requested_deadline_missed_changed = true;
-  requested_deadline_missed_status.total_count_change += status.total_count_change;
-  requested_deadline_missed_status.total_count = status.total_count;
-  auto callback = on_new_event_cb[RMW_EVENT_LIVELINESS_CHANGED];
-  auto user_data = user_data_cb[RMW_EVENT_LIVELINESS_CHANGED];
-  if(nullptr != callback) {
-    callback(user_data, requested_deadline_missed_status.total_count_change);
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    requested_deadline_missed_status.total_count_change += status.total_count_change;
+    requested_deadline_missed_status.total_count = status.total_count;
+    requested_deadline_missed_changed = true;
+    changes = requested_deadline_missed_status.total_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_REQUESTED_DEADLINE_MISSED], true);
+  notify_event(*this, RMW_EVENT_REQUESTED_DEADLINE_MISSED, changes);
 }
 
 void SubscriberInfo::on_requested_incompatible_qos(const dds_RequestedIncompatibleQosStatus & status)
 {
-  std::lock_guard guard(mutex_event);
-  requested_incompatible_qos_changed = true;
-  requested_incompatible_qos_status.total_count_change += status.total_count_change;
-  requested_incompatible_qos_status.total_count = status.total_count;
-  requested_incompatible_qos_status.last_policy_id = status.last_policy_id;
-  auto callback = on_new_event_cb[RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE];
-  auto user_data = user_data_cb[RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE];
-  if(nullptr != callback) {
-    callback(user_data, requested_incompatible_qos_status.total_count_change);
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    requested_incompatible_qos_status.total_count_change += status.total_count_change;
+    requested_incompatible_qos_status.total_count = status.total_count;
+    requested_incompatible_qos_status.last_policy_id = status.last_policy_id;
+    requested_incompatible_qos_changed = true;
+    changes = requested_incompatible_qos_status.total_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE], true);
+  notify_event(*this, RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE, changes);
 }
 
 void SubscriberInfo::on_data_available() {
+  if (capturing.load(std::memory_order_acquire)) {
+    capture_samples(this);
+    return;
+  }
+
+  if (dispatching.load(std::memory_order_acquire)) {
+    dispatch_samples(this);
+    return;
+  }
+
   std::lock_guard<std::mutex> guard(event_callback_data.mutex);
   if(event_callback_data.callback) {
-    event_callback_data.callback(event_callback_data.user_data, count_unread());
+    // Notified once per received sample, counting the unread ones would read the whole history
+    event_callback_data.callback(event_callback_data.user_data, 1);
   }
+  write_event_fd(event_callback_data.event_fd);
 }
 
 void SubscriberInfo::on_liveliness_changed(const dds_LivelinessChangedStatus & status)
 {
-  std::lock_guard guard(mutex_event);
-  liveliness_changed = true;
-  liveliness_changed_status.alive_count_change += status.alive_count_change;
-  liveliness_changed_status.not_alive_count_change += status.not_alive_count_change;
-  liveliness_changed_status.alive_count = status.alive_count;
-  liveliness_changed_status.not_alive_count = status.not_alive_count;
-  auto callback = on_new_event_cb[RMW_EVENT_LIVELINESS_CHANGED];
-  auto user_data = user_data_cb[RMW_EVENT_LIVELINESS_CHANGED];
-  if(nullptr != callback) {
-    callback(user_data, liveliness_changed_status.alive_count_change);
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    liveliness_changed_status.alive_count_change += status.alive_count_change;
+    liveliness_changed_status.not_alive_count_change += status.not_alive_count_change;
+    liveliness_changed_status.alive_count = status.alive_count;
+    liveliness_changed_status.not_alive_count = status.not_alive_count;
+    liveliness_changed = true;
+    changes = liveliness_changed_status.alive_count_change;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_LIVELINESS_CHANGED], true);
+  notify_event(*this, RMW_EVENT_LIVELINESS_CHANGED, changes);
 }
 
-void SubscriberInfo::on_subscription_matched(const dds_SubscriptionMatchedStatus & status)
+static rmw_gid_t to_gid(const uint8_t * guid)
+{
+  rmw_gid_t gid;
+  gid.implementation_identifier = RMW_GURUMDDS_ID;
+  std::memcpy(gid.data, guid, RMW_GID_STORAGE_SIZE);
+  return gid;
+}
+
+dds_ReturnCode_t SubscriberInfo::get_publication_guid(
+  dds_InstanceHandle_t publication_handle,
+  uint8_t * guid)
 {
-  std::lock_guard guard(mutex_event);
-  subscription_matched_changed = true;
-  subscription_matched_status.total_count_change += status.total_count_change;
-  subscription_matched_status.current_count_change += status.current_count_change;
-  subscription_matched_status.current_count = status.current_count;
-  subscription_matched_status.total_count = status.total_count;
-  auto callback = on_new_event_cb[RMW_EVENT_SUBSCRIPTION_MATCHED];
-  auto user_data = user_data_cb[RMW_EVENT_SUBSCRIPTION_MATCHED];
-  if(nullptr != callback) {
-    callback(user_data, subscription_matched_status.total_count_change);
+  {
+    std::lock_guard guard(mutex_publications);
+    auto it = publication_handles.find(publication_handle);
+    if (it != publication_handles.end()) {
+      std::memcpy(guid, it->second->guid.data(), RMW_GID_STORAGE_SIZE);
+      return dds_RETCODE_OK;
+    }
+  }
+
+  dds_ReturnCode_t ret =
+    dds_DataReader_get_guid_from_publication_handle(topic_reader, publication_handle, guid);
+  if (ret != dds_RETCODE_OK) {
+    return ret;
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_SUBSCRIPTION_MATCHED], true);
+  std::lock_guard guard(mutex_publications);
+  // Another take or a local sample may have cached the writer meanwhile, its sequence number
+  // is kept
+  MatchedPublication & entry = publications[to_gid(guid)];
+  std::memcpy(entry.guid.data(), guid, RMW_GID_STORAGE_SIZE);
+  entry.handle = publication_handle;
+  publication_handles[publication_handle] = &entry;
+  return dds_RETCODE_OK;
 }
 
-void SubscriberInfo::on_sample_lost(const dds_SampleLostStatus & status) {
-  std::lock_guard guard(mutex_event);
-  sample_lost_changed = true;
-  sample_lost_status.total_count_change += status.total_count_change;
-  sample_lost_status.total_count = status.total_count;
-  auto callback = on_new_event_cb[RMW_EVENT_MESSAGE_LOST];
-  auto user_data = user_data_cb[RMW_EVENT_MESSAGE_LOST];
-  if(nullptr != callback) {
-    callback(user_data, sample_lost_status.total_count_change);
+// Gap between the sample and the last one taken from the writer
+static uint64_t
+update_sequence_number(MatchedPublication & publication, int64_t sequence_number)
+{
+  uint64_t gap = 0;
+  // Samples of a late joined writer and reordered samples are not counted
+  if (publication.last_sequence_number != 0 &&
+    sequence_number > publication.last_sequence_number + 1)
+  {
+    gap = static_cast<uint64_t>(sequence_number - publication.last_sequence_number - 1);
+    publication.gap_count += gap;
+  }
+  publication.last_sequence_number = std::max(publication.last_sequence_number, sequence_number);
+  return gap;
+}
+
+void SubscriberInfo::on_sequence_number(
+  dds_InstanceHandle_t publication_handle,
+  int64_t sequence_number)
+{
+  // Samples dropped by the content filter leave gaps that are not losses
+  if (filtered_topic != nullptr) {
+    return;
+  }
+
+  uint64_t gap = 0;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    {
+      std::lock_guard guard(mutex_publications);
+      auto it = publication_handles.find(publication_handle);
+      if (it != publication_handles.end()) {
+        gap = update_sequence_number(*it->second, sequence_number);
+        break;
+      }
+    }
+
+    // Caches the writer, its first sample is not a gap
+    uint8_t guid[RMW_GID_STORAGE_SIZE] = {};
+    if (get_publication_guid(publication_handle, guid) != dds_RETCODE_OK) {
+      return;
+    }
   }
 
-  dds_GuardCondition_set_trigger_value(event_guard_cond[RMW_EVENT_MESSAGE_LOST], true);
+  on_sequence_gap(gap);
 }
 
-bool SubscriberInfo::has_callback(rmw_event_type_t event_type)
+void SubscriberInfo::on_local_sequence_number(
+  const rmw_gid_t & publisher_gid,
+  int64_t sequence_number)
 {
-  std::lock_guard guard(mutex_event);
-  return has_callback_unsafe(event_type);
+  if (filtered_topic != nullptr) {
+    return;
+  }
+
+  uint64_t gap;
+  {
+    // Caches the writer on its first sample, handed over or taken through DDS
+    std::lock_guard guard(mutex_publications);
+    auto result = publications.try_emplace(publisher_gid);
+    MatchedPublication & publication = result.first->second;
+    if (result.second) {
+      std::memcpy(publication.guid.data(), publisher_gid.data, RMW_GID_STORAGE_SIZE);
+    }
+    gap = update_sequence_number(publication, sequence_number);
+  }
+
+  on_sequence_gap(gap);
 }
 
-bool SubscriberInfo::has_callback_unsafe(rmw_event_type_t event_type) const
+int64_t SubscriberInfo::get_last_sequence_number(const rmw_gid_t & publisher_gid)
 {
-  // RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE is always used with a callback
-  return ((mask | dds_INCONSISTENT_TOPIC_STATUS) & rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type)) > 0;
+  std::lock_guard guard(mutex_publications);
+  auto it = publications.find(publisher_gid);
+  return it != publications.end() ? it->second.last_sequence_number : 0;
 }
 
-std::mutex TopicEventListener::mutex_table_;
-std::map<dds_Topic*, TopicEventListener*> TopicEventListener::table_;
+void SubscriberInfo::forget_publication(const rmw_gid_t & publisher_gid)
+{
+  std::lock_guard guard(mutex_publications);
+  auto it = publications.find(publisher_gid);
+  if (it == publications.end()) {
+    return;
+  }
+  if (it->second.handle != dds_HANDLE_NIL) {
+    publication_handles.erase(it->second.handle);
+  }
+  publications.erase(it);
+}
+
+void SubscriberInfo::on_sequence_gap(uint64_t gap)
+{
+  if (gap == 0) {
+    return;
+  }
+  stats.on_sequence_gap(gap);
+
+  if (!report_sequence_gaps) {
+    return;
+  }
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    sequence_gap_lost_total += gap;
+    sequence_gap_lost_change += static_cast<int32_t>(gap);
+    sample_lost_changed = true;
+    changes = sample_lost_status.total_count_change + sequence_gap_lost_change;
+  }
+
+  notify_event(*this, RMW_EVENT_MESSAGE_LOST, changes);
+}
+
+// Keeps the writers still matched with the reader, looked up without mutex_publications
+static void prune_publications(SubscriberInfo * subscriber_info, uint32_t matched_count)
+{
+  dds_InstanceHandleSeq * matched = dds_InstanceHandleSeq_create(matched_count);
+  if (matched == nullptr) {
+    return;
+  }
+
+  if (dds_DataReader_get_matched_publications(subscriber_info->topic_reader, matched) ==
+    dds_RETCODE_OK)
+  {
+    std::unordered_map<dds_InstanceHandle_t, MatchedPublication *> kept;
+    std::lock_guard guard(subscriber_info->mutex_publications);
+    auto & handles = subscriber_info->publication_handles;
+    for (uint32_t i = 0; i < dds_InstanceHandleSeq_length(matched); i++) {
+      auto it = handles.find(dds_InstanceHandleSeq_get(matched, i));
+      if (it != handles.end()) {
+        kept.emplace(*it);
+      }
+    }
+
+    // The writers only local samples were taken from have no handle to check
+    auto & publications = subscriber_info->publications;
+    for (auto it = publications.begin(); it != publications.end(); ) {
+      if (it->second.handle != dds_HANDLE_NIL && kept.count(it->second.handle) == 0) {
+        it = publications.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    handles.swap(kept);
+  }
+  dds_InstanceHandleSeq_delete(matched);
+}
+
+void SubscriberInfo::on_subscription_matched(const dds_SubscriptionMatchedStatus & status)
+{
+  if (status.current_count == 0) {
+    std::lock_guard guard(mutex_publications);
+    publications.clear();
+    publication_handles.clear();
+  } else if (status.current_count_change == -1) {
+    std::lock_guard guard(mutex_publications);
+    auto it = publication_handles.find(status.last_publication_handle);
+    if (it != publication_handles.end()) {
+      publications.erase(to_gid(it->second->guid.data()));
+      publication_handles.erase(it);
+    }
+  } else if (status.current_count_change < 0) {
+    // Only the last of the writers that went away is known
+    prune_publications(this, static_cast<uint32_t>(status.current_count));
+  }
+
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    subscription_matched_status.total_count_change += status.total_count_change;
+    subscription_matched_status.current_count_change += status.current_count_change;
+    subscription_matched_status.current_count = status.current_count;
+    subscription_matched_status.total_count = status.total_count;
+    subscription_matched_changed = true;
+    changes = subscription_matched_status.total_count_change;
+  }
+
+  notify_event(*this, RMW_EVENT_SUBSCRIPTION_MATCHED, changes);
+}
+
+void SubscriberInfo::on_sample_lost(const dds_SampleLostStatus & status) {
+  int32_t changes;
+  {
+    std::lock_guard guard(mutex_event);
+    sample_lost_status.total_count_change += status.total_count_change;
+    sample_lost_status.total_count = status.total_count;
+    sample_lost_changed = true;
+    changes = sample_lost_status.total_count_change;
+  }
+
+  notify_event(*this, RMW_EVENT_MESSAGE_LOST, changes);
+}
+
+bool SubscriberInfo::has_callback(rmw_event_type_t event_type)
+{
+  // Sequence number gaps are only seen by takes, they trigger the event guard condition
+  if (event_type == RMW_EVENT_MESSAGE_LOST && report_sequence_gaps) {
+    return true;
+  }
+  // RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE is always used with a callback
+  return ((callback_mask | dds_INCONSISTENT_TOPIC_STATUS) & rmw_gurumdds_cpp::get_status_kind_from_rmw(event_type)) > 0;
+}
 
 rmw_ret_t TopicEventListener::associate_listener(dds_Topic * topic) {
   auto event_listener = new(std::nothrow) TopicEventListener{};
@@ -663,11 +945,6 @@ rmw_ret_t TopicEventListener::associate_listener(dds_Topic * topic) {
     return RMW_RET_ERROR;
   }
 
-  std::lock_guard guard{mutex_table_};
-  if(!table_.emplace(topic, event_listener).second) {
-    return RMW_RET_ERROR;
-  }
-
   dds_TopicListener listener{};
   listener.on_inconsistent_topic = &TopicEventListener::on_inconsistent_topic;
   dds_Topic_set_listener_context(topic, event_listener);
@@ -675,25 +952,16 @@ rmw_ret_t TopicEventListener::associate_listener(dds_Topic * topic) {
   return RMW_RET_OK;
 }
 
-rmw_ret_t TopicEventListener::disassociate_Listener(dds_Topic * topic) {
-  std::lock_guard guard{mutex_table_};
-  auto it = table_.find(topic);
-  if(table_.end() == it) {
-    return RMW_RET_ERROR;
-  }
+TopicEventListener * TopicEventListener::get_listener(dds_Topic * topic) {
+  return static_cast<TopicEventListener*>(dds_Topic_get_listener_context(topic));
+}
 
-  auto listener = it->second;
-  std::unique_lock listener_guard{listener->mutex_};
-  dds_Topic_set_listener_context(topic, nullptr);
-  listener_guard.unlock();
-  table_.erase(it);
+void TopicEventListener::disassociate_listener(TopicEventListener * listener) {
   delete listener;
-  return RMW_RET_OK;
 }
 
 void TopicEventListener::on_inconsistent_topic(const dds_Topic* the_topic, const dds_InconsistentTopicStatus* status) {
-  auto topic = const_cast<dds_Topic*>(the_topic);
-  auto listener = static_cast<TopicEventListener*>(dds_Topic_get_listener_context(topic));
+  auto listener = get_listener(const_cast<dds_Topic*>(the_topic));
   if(nullptr == listener) {
     return;
   }
@@ -709,16 +977,14 @@ void TopicEventListener::on_inconsistent_topic(const dds_InconsistentTopicStatus
 }
 
 void TopicEventListener::add_event(dds_Topic * topic, EventInfo * event_info) {
-  std::lock_guard guard{mutex_table_};
-  auto it = table_.find(topic);
-  if(table_.end() == it) {
+  auto listener = get_listener(topic);
+  if(nullptr == listener) {
     return;
   }
 
-  auto listener = it->second;
-  std::unique_lock listener_guard{listener->mutex_};
+  std::lock_guard listener_guard{listener->mutex_};
   auto list_it = std::find(listener->event_list_.begin(), listener->event_list_.end(), event_info);
-  if(listener->event_list_.end() == list_it) {
+  if(listener->event_list_.end() != list_it) {
     return;
   }
 
@@ -726,19 +992,17 @@ void TopicEventListener::add_event(dds_Topic * topic, EventInfo * event_info) {
 }
 
 void TopicEventListener::remove_event(dds_Topic * topic, EventInfo * event_info) {
-  std::lock_guard guard{mutex_table_};
-  auto it = table_.find(topic);
-  if(table_.end() == it) {
+  auto listener = get_listener(topic);
+  if(nullptr == listener) {
     return;
   }
 
-    auto listener = it->second;
-    std::unique_lock listener_guard{listener->mutex_};
-    auto list_it = std::find(listener->event_list_.begin(), listener->event_list_.end(), event_info);
-    if(listener->event_list_.end() == list_it) {
-      return;
-    }
+  std::lock_guard listener_guard{listener->mutex_};
+  auto list_it = std::find(listener->event_list_.begin(), listener->event_list_.end(), event_info);
+  if(listener->event_list_.end() == list_it) {
+    return;
+  }
 
-    listener->event_list_.erase(list_it);
+  listener->event_list_.erase(list_it);
 }
 } // namespace rmw_gurumdds_cpp
@@ -12,23 +12,165 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "rcpputils/scope_exit.hpp"
 
+#include "rmw/message_sequence.h"
 #include "rmw/publisher_options.h"
 #include "rmw/subscription_options.h"
 #include "rmw/qos_profiles.h"
 #include "rmw_dds_common/qos.hpp"
 
 #include "rmw_gurumdds_cpp/context_listener_thread.hpp"
+#include "rmw_gurumdds_cpp/discovery_cache.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
 #include "rmw_gurumdds_cpp/qos.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/gid.hpp"
 #include "rmw_gurumdds_cpp/rmw_publisher.hpp"
 #include "rmw_gurumdds_cpp/rmw_subscription.hpp"
+#include "rmw_gurumdds_cpp/user_data.hpp"
 
 #include "rosidl_typesupport_cpp/message_type_support.hpp"
 
+static uint64_t steady_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Keeps the update if updates are delayed or held back, returns false if it is to be published
+// right away. Every update carries all the entities of the participant, so only the latest one
+// is kept
+static bool defer_update(rmw_context_impl_t * ctx, const void * msg, rmw_ret_t & ret)
+{
+  const auto & update = *static_cast<const rmw_dds_common::msg::ParticipantEntitiesInfo *>(msg);
+  std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+  if (ctx->discovery_update_delay_ns == 0 && ctx->discovery_update_holds == 0) {
+    return false;
+  }
+
+  ret = RMW_RET_OK;
+  if (ctx->discovery_update != nullptr) {
+    *ctx->discovery_update = update;
+    return true;
+  }
+
+  ctx->discovery_update.reset(
+    new (std::nothrow) rmw_dds_common::msg::ParticipantEntitiesInfo(update));
+  if (ctx->discovery_update == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate discovery update");
+    ret = RMW_RET_BAD_ALLOC;
+    return true;
+  }
+
+  ctx->discovery_update_deadline_ns = steady_time_ns() + ctx->discovery_update_delay_ns;
+  if (ctx->listener_wakeup_gc != nullptr) {
+    dds_GuardCondition_set_trigger_value(ctx->listener_wakeup_gc, true);
+  }
+  return true;
+}
+
+static void trigger_graph_guard_condition(rmw_context_impl_t * ctx)
+{
+  rmw_guard_condition_t * graph_guard_condition = ctx->common_ctx.graph_guard_condition;
+  if (graph_guard_condition != nullptr &&
+    rmw_trigger_guard_condition(graph_guard_condition) != RMW_RET_OK)
+  {
+    RMW_SET_ERROR_MSG("failed to trigger graph guard condition");
+  }
+}
+
+static void update_participant_info(
+  rmw_context_impl_t * ctx,
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  if (std::memcmp(&msg.gid.data, ctx->common_ctx.gid.data, RMW_GID_STORAGE_SIZE) == 0) {
+    return;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID,
+    "---- updating participant entities: "
+    "0x%08X.0x%08X.0x%08X.0x%08X",
+    reinterpret_cast<const uint32_t *>(&msg.gid.data)[0],
+    reinterpret_cast<const uint32_t *>(&msg.gid.data)[1],
+    reinterpret_cast<const uint32_t *>(&msg.gid.data)[2],
+    reinterpret_cast<const uint32_t *>(&msg.gid.data)[3]);
+
+  ctx->common_ctx.graph_cache.update_participant_entities(msg);
+  ctx->graph_index.update_participant(msg);
+  if (ctx->discovery_cache != nullptr) {
+    ctx->discovery_cache->update_participant(msg);
+  }
+}
+
+// Takes up to discovery_batch_size samples at a time, deserialized by the workers of
+// rmw_take_sequence for large batches. Every sample carries all the entities of its
+// participant, so only the latest sample of each participant in a batch is applied
+static rmw_ret_t take_participant_info_batches(rmw_context_impl_t * ctx)
+{
+  const size_t batch_size = ctx->discovery_batch_size;
+  // Only the listener thread of the context takes discovery samples
+  thread_local std::vector<rmw_dds_common::msg::ParticipantEntitiesInfo> messages;
+  thread_local std::vector<void *> message_ptrs;
+  thread_local std::vector<rmw_message_info_t> message_infos;
+  thread_local std::vector<size_t> latest;
+  thread_local std::set<rmw_gid_t, rmw_dds_common::Compare_rmw_gid_t> participants;
+  if (messages.size() != batch_size) {
+    messages.resize(batch_size);
+    message_ptrs.resize(batch_size);
+    message_infos.resize(batch_size);
+    for (size_t i = 0; i < batch_size; i++) {
+      message_ptrs[i] = &messages[i];
+    }
+  }
+
+  rmw_message_sequence_t message_sequence = rmw_get_zero_initialized_message_sequence();
+  message_sequence.data = message_ptrs.data();
+  message_sequence.capacity = batch_size;
+  rmw_message_info_sequence_t message_info_sequence =
+    rmw_get_zero_initialized_message_info_sequence();
+  message_info_sequence.data = message_infos.data();
+  message_info_sequence.capacity = batch_size;
+
+  size_t taken = 0;
+  do {
+    if (RMW_RET_OK != rmw_take_sequence(
+        ctx->common_ctx.sub, batch_size, &message_sequence, &message_info_sequence,
+        &taken, nullptr))
+    {
+      RMW_SET_ERROR_MSG("failed to take discovery samples");
+      return RMW_RET_ERROR;
+    }
+
+    latest.clear();
+    participants.clear();
+    for (size_t i = taken; i-- > 0; ) {
+      rmw_gid_t gid;
+      rmw_dds_common::convert_msg_to_gid(&messages[i].gid, &gid);
+      if (participants.insert(gid).second) {
+        latest.push_back(i);
+      }
+    }
+
+    for (size_t i : latest) {
+      update_participant_info(ctx, messages[i]);
+    }
+  } while (taken == batch_size);
+
+  return RMW_RET_OK;
+}
+
 static rmw_ret_t add_entity(
   rmw_context_impl_t * ctx,
   const rmw_gid_t * const endp_gid,
@@ -44,7 +186,6 @@ static rmw_ret_t add_entity(
   const dds_LifespanQosPolicy * const lifespan,
   const bool is_reader,
   const bool local) {
-  RCUTILS_UNUSED(local);
   size_t history_depth = RMW_QOS_POLICY_DEPTH_SYSTEM_DEFAULT;
   rmw_qos_history_policy_e history_kind = RMW_QOS_POLICY_HISTORY_UNKNOWN;
   if (history != nullptr) {
@@ -92,6 +233,13 @@ static rmw_ret_t add_entity(
     is_reader,
     local);
 
+  // Confirms an entity seeded from the cache, which the graph cache already holds
+  if (!local && ctx->discovery_cache != nullptr) {
+    ctx->discovery_cache->add_entity(
+      rmw_gurumdds_cpp::CachedEntity{
+        *endp_gid, *dp_gid, topic_name, type_name, type_hash, qos_profile, is_reader, true});
+  }
+
   if (!ctx->common_ctx.graph_cache.add_entity(
     *endp_gid,
     std::string(topic_name),
@@ -115,6 +263,14 @@ static rmw_ret_t add_entity(
     return RMW_RET_ERROR;
   }
 
+  ctx->graph_index.add_entity(
+    *endp_gid,
+    topic_name,
+    type_name,
+    type_hash,
+    qos_profile,
+    is_reader);
+
   return RMW_RET_OK;
 }
 
@@ -126,6 +282,10 @@ static rmw_ret_t remove_entity(
     RMW_SET_ERROR_MSG("failed to remove entity from graph_cache");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.remove_entity(gid, is_reader);
+  if (ctx->discovery_cache != nullptr) {
+    ctx->discovery_cache->remove_entity(gid);
+  }
 
   RCUTILS_LOG_DEBUG_NAMED(
     RMW_GURUMDDS_ID,
@@ -271,6 +431,81 @@ static rmw_ret_t add_local_subscriber(
 }
 
 namespace rmw_gurumdds_cpp::graph_cache {
+// Seeds the graph with the remote entities of the previous run, which stay until discovery
+// confirms them or the cache purges them
+static void seed_discovery_cache(rmw_context_impl_t * ctx)
+{
+  std::vector<rmw_gurumdds_cpp::CachedParticipant> participants;
+  std::vector<rmw_gurumdds_cpp::CachedEntity> entities;
+  ctx->discovery_cache->load(steady_time_ns(), participants, entities);
+
+  for (const auto & participant : participants) {
+    ctx->common_ctx.graph_cache.add_participant(participant.gid, participant.enclave);
+  }
+
+  for (const auto & entity : entities) {
+    if (ctx->common_ctx.graph_cache.add_entity(
+        entity.gid, entity.topic_name, entity.type_name, entity.type_hash,
+        entity.participant_gid, entity.qos, entity.is_reader))
+    {
+      ctx->graph_index.add_entity(
+        entity.gid, entity.topic_name, entity.type_name, entity.type_hash, entity.qos,
+        entity.is_reader);
+    }
+  }
+
+  for (const auto & participant : participants) {
+    if (!participant.has_nodes) {
+      continue;
+    }
+
+    rmw_dds_common::msg::ParticipantEntitiesInfo msg;
+    rmw_dds_common::convert_gid_to_msg(&participant.gid, &msg.gid);
+    for (const auto & node : participant.nodes) {
+      rmw_dds_common::msg::NodeEntitiesInfo node_info;
+      node_info.node_namespace = node.node_namespace;
+      node_info.node_name = node.node_name;
+      rmw_dds_common::msg::Gid gid;
+      for (const rmw_gid_t & reader_gid : node.readers) {
+        rmw_dds_common::convert_gid_to_msg(&reader_gid, &gid);
+        node_info.reader_gid_seq.push_back(gid);
+      }
+      for (const rmw_gid_t & writer_gid : node.writers) {
+        rmw_dds_common::convert_gid_to_msg(&writer_gid, &gid);
+        node_info.writer_gid_seq.push_back(gid);
+      }
+      msg.node_entities_info_seq.push_back(std::move(node_info));
+    }
+    ctx->common_ctx.graph_cache.update_participant_entities(msg);
+    ctx->graph_index.update_participant(msg);
+  }
+}
+
+// Purges the cached entries discovery did not confirm in time and saves the cache if it is due.
+// Returns the time it is to be called again
+static uint64_t update_discovery_cache(rmw_context_impl_t * ctx)
+{
+  const uint64_t now = steady_time_ns();
+  std::vector<rmw_gid_t> participants;
+  std::vector<std::pair<rmw_gid_t, bool>> entities;
+  ctx->discovery_cache->take_expired(now, participants, entities);
+  for (const auto & entity : entities) {
+    if (ctx->common_ctx.graph_cache.remove_entity(entity.first, entity.second)) {
+      ctx->graph_index.remove_entity(entity.first, entity.second);
+    }
+  }
+  for (const rmw_gid_t & gid : participants) {
+    ctx->common_ctx.graph_cache.remove_participant(gid);
+    ctx->graph_index.remove_participant(gid);
+  }
+
+  if (!ctx->discovery_cache->save_if_due(now)) {
+    RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "%s", rmw_get_error_string().str);
+    rmw_reset_error();
+  }
+  return ctx->discovery_cache->get_deadline();
+}
+
 rmw_ret_t
 initialize(rmw_context_impl_t * const ctx)
 {
@@ -338,16 +573,26 @@ initialize(rmw_context_impl_t * const ctx)
     return RMW_RET_BAD_ALLOC;
   }
 
+  if (ctx->discovery_update_delay_ns > 0 || ctx->graph_change_delay_ns > 0) {
+    ctx->listener_wakeup_gc = dds_GuardCondition_create();
+    if (ctx->listener_wakeup_gc == nullptr) {
+      RMW_SET_ERROR_MSG("failed to create listener thread wakeup guard condition");
+      return RMW_RET_BAD_ALLOC;
+    }
+  }
+
   ctx->common_ctx.graph_cache.set_on_change_callback(
-    [gcond = ctx->common_ctx.graph_guard_condition]()
+    [ctx]()
     {
-      rmw_ret_t ret = rmw_trigger_guard_condition(gcond);
-      if (ret != RMW_RET_OK) {
-        RMW_SET_ERROR_MSG("failed to trigger graph cache on_change_callback");
-      }
+      notify_graph_change(ctx);
     });
 
-  ctx->common_ctx.publish_callback = [](const rmw_publisher_t * pub, const void * msg) {
+  ctx->common_ctx.publish_callback = [ctx](const rmw_publisher_t * pub, const void * msg) {
+    rmw_ret_t ret;
+    if (defer_update(ctx, msg, ret)) {
+      return ret;
+    }
+
     return rmw_gurumdds_cpp::publish(
       RMW_GURUMDDS_ID,
       pub,
@@ -359,6 +604,10 @@ initialize(rmw_context_impl_t * const ctx)
   std::string dp_enclave = ctx->base->options.enclave;
   ctx->common_ctx.graph_cache.add_participant(ctx->common_ctx.gid, dp_enclave);
 
+  if (ctx->discovery_cache != nullptr) {
+    seed_discovery_cache(ctx);
+  }
+
   return RMW_RET_OK;
 }
 
@@ -372,6 +621,31 @@ finalize(rmw_context_impl_t * const ctx)
 
   ctx->common_ctx.graph_cache.clear_on_change_callback();
 
+  // The listener thread is stopped, an update still held back is published right away.
+  // Changes reported from now on are not held back anymore, nobody waits for them
+  std::unique_ptr<rmw_dds_common::msg::ParticipantEntitiesInfo> update;
+  dds_GuardCondition * listener_wakeup_gc = nullptr;
+  {
+    std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+    update = std::move(ctx->discovery_update);
+    ctx->graph_change_pending = false;
+    listener_wakeup_gc = ctx->listener_wakeup_gc;
+    ctx->listener_wakeup_gc = nullptr;
+  }
+  if (update != nullptr && RMW_RET_OK != publish_update(ctx, update.get())) {
+    RCUTILS_LOG_ERROR_NAMED(RMW_GURUMDDS_ID, "failed to publish held back discovery update");
+    rmw_reset_error();
+  }
+
+  if (listener_wakeup_gc != nullptr) {
+    dds_GuardCondition_delete(listener_wakeup_gc);
+  }
+
+  if (ctx->discovery_cache != nullptr && !ctx->discovery_cache->save()) {
+    RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "%s", rmw_get_error_string().str);
+    rmw_reset_error();
+  }
+
   if (ctx->common_ctx.graph_guard_condition) {
     if (RMW_RET_OK !=
       rmw_destroy_guard_condition(ctx->common_ctx.graph_guard_condition))
@@ -434,17 +708,116 @@ publish_update(
   return RMW_RET_OK;
 }
 
+void
+notify_graph_change(rmw_context_impl_t * const ctx)
+{
+  if (ctx->graph_change_delay_ns == 0) {
+    trigger_graph_guard_condition(ctx);
+    return;
+  }
+
+  // Changes until the deadline of the first one are reported together
+  std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+  if (!ctx->graph_change_pending && ctx->listener_wakeup_gc != nullptr) {
+    ctx->graph_change_pending = true;
+    ctx->graph_change_deadline_ns = steady_time_ns() + ctx->graph_change_delay_ns;
+    dds_GuardCondition_set_trigger_value(ctx->listener_wakeup_gc, true);
+  }
+}
+
+rmw_ret_t
+flush_deferred(rmw_context_impl_t * const ctx, dds_Duration_t & timeout)
+{
+  timeout = {dds_DURATION_INFINITE_SEC, dds_DURATION_INFINITE_NSEC};
+  const uint64_t cache_deadline =
+    ctx->discovery_cache != nullptr ? update_discovery_cache(ctx) : UINT64_MAX;
+  std::unique_ptr<rmw_dds_common::msg::ParticipantEntitiesInfo> update;
+  bool graph_changed = false;
+  {
+    std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+    const uint64_t now = steady_time_ns();
+    uint64_t next_deadline = cache_deadline;
+    // A held back update is published by the last release_updates
+    if (ctx->discovery_update != nullptr && ctx->discovery_update_holds == 0) {
+      if (now < ctx->discovery_update_deadline_ns) {
+        next_deadline = ctx->discovery_update_deadline_ns;
+      } else {
+        update = std::move(ctx->discovery_update);
+      }
+    }
+    if (ctx->graph_change_pending) {
+      if (now < ctx->graph_change_deadline_ns) {
+        next_deadline = std::min(next_deadline, ctx->graph_change_deadline_ns);
+      } else {
+        ctx->graph_change_pending = false;
+        graph_changed = true;
+      }
+    }
+
+    if (next_deadline != UINT64_MAX) {
+      const uint64_t left = next_deadline > now ? next_deadline - now : 0;
+      timeout.sec = static_cast<int32_t>(left / 1000000000ull);
+      timeout.nanosec = static_cast<uint32_t>(left % 1000000000ull);
+    }
+  }
+
+  if (graph_changed) {
+    trigger_graph_guard_condition(ctx);
+  }
+
+  if (update != nullptr) {
+    return publish_update(ctx, update.get());
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+hold_updates(rmw_context_impl_t * const ctx)
+{
+  std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+  ctx->discovery_update_holds++;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+release_updates(rmw_context_impl_t * const ctx)
+{
+  // Taken first, as by the updates of the local entities, so that no later update is published
+  // before the one held back
+  std::lock_guard<std::mutex> graph_guard{ctx->graph_mutex};
+  std::unique_ptr<rmw_dds_common::msg::ParticipantEntitiesInfo> update;
+  {
+    std::lock_guard<std::mutex> guard{ctx->deferred_mutex};
+    if (ctx->discovery_update_holds == 0) {
+      RMW_SET_ERROR_MSG("discovery updates are not held back");
+      return RMW_RET_ERROR;
+    }
+    if (--ctx->discovery_update_holds == 0) {
+      update = std::move(ctx->discovery_update);
+    }
+  }
+
+  if (update != nullptr) {
+    return publish_update(ctx, update.get());
+  }
+
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 on_node_created(
   rmw_context_impl_t * const ctx,
   const rmw_node_t * const node)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   rmw_ret_t rc = ctx->common_ctx.add_node_graph(
     node->name, node->namespace_);
   if (RMW_RET_OK != rc) {
     RMW_SET_ERROR_MSG("failed to add node graph");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.add_node(ctx->common_ctx.gid, node->name, node->namespace_);
 
   RCUTILS_LOG_DEBUG_NAMED(
     RMW_GURUMDDS_ID,
@@ -466,12 +839,14 @@ on_node_deleted(
   rmw_context_impl_t * const ctx,
   const rmw_node_t * const node)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   rmw_ret_t rc = ctx->common_ctx.remove_node_graph(
     node->name, node->namespace_);
   if (RMW_RET_OK != rc) {
     RMW_SET_ERROR_MSG("failed to remove node graph");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.remove_node(ctx->common_ctx.gid, node->name, node->namespace_);
 
   return RMW_RET_OK;
 }
@@ -482,6 +857,7 @@ on_publisher_created(
   const rmw_node_t * const node,
   PublisherInfo * const pub)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   const rosidl_type_hash_s& type_hash = *pub->rosidl_message_typesupport->get_type_hash_func(pub->rosidl_message_typesupport);
   rmw_ret_t rc = add_local_publisher(ctx, node, pub->topic_writer, type_hash, pub->publisher_gid);
   if (RMW_RET_OK != rc) {
@@ -496,6 +872,8 @@ on_publisher_created(
     remove_entity(ctx, pub->publisher_gid, false);
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, pub->publisher_gid, false);
 
   return RMW_RET_OK;
 }
@@ -506,11 +884,13 @@ on_publisher_deleted(
   const rmw_node_t * const node,
   PublisherInfo * const pub)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   rmw_ret_t rc = remove_entity(ctx, pub->publisher_gid, false);
   if (RMW_RET_OK != rc) {
     RMW_SET_ERROR_MSG("failed to remove entity of publisher");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.dissociate_entity(pub->publisher_gid);
 
   rc = ctx->common_ctx.remove_publisher_graph(
     pub->publisher_gid, node->name, node->namespace_);
@@ -528,6 +908,7 @@ on_subscriber_created(
   const rmw_node_t * const node,
   SubscriberInfo * const sub)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   const rosidl_type_hash_s& type_hash = *sub->rosidl_message_typesupport->get_type_hash_func(sub->rosidl_message_typesupport);
   rmw_ret_t rc = add_local_subscriber(ctx, node, sub->topic_reader, type_hash, sub->subscriber_gid);
   if (RMW_RET_OK != rc) {
@@ -543,6 +924,8 @@ on_subscriber_created(
     remove_entity(ctx, sub->subscriber_gid, false);
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, sub->subscriber_gid, true);
 
   return RMW_RET_OK;
 }
@@ -553,11 +936,13 @@ on_subscriber_deleted(
   const rmw_node_t * const node,
   SubscriberInfo * const sub)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   rmw_ret_t rc = remove_entity(ctx, sub->subscriber_gid, true);
   if (RMW_RET_OK != rc) {
     RMW_SET_ERROR_MSG("failed to remove entity of subscriber");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.dissociate_entity(sub->subscriber_gid);
 
   rc = ctx->common_ctx.remove_subscriber_graph(
     sub->subscriber_gid, node->name, node->namespace_);
@@ -575,6 +960,7 @@ on_service_created(
   const rmw_node_t * const node,
   ServiceInfo * const svc)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   const rmw_gid_t pub_gid = svc->publisher_gid;
   const rmw_gid_t sub_gid = svc->subscriber_gid;
   bool add_pub = false;
@@ -614,6 +1000,10 @@ on_service_created(
     RMW_SET_ERROR_MSG("failed to add service graph");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, sub_gid, true);
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, pub_gid, false);
 
   scope_exit_entities_reset.cancel();
   return RMW_RET_OK;
@@ -625,7 +1015,10 @@ on_service_deleted(
   const rmw_node_t * const node,
   ServiceInfo * const svc)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   bool failed = false;
+  ctx->graph_index.dissociate_entity(svc->subscriber_gid);
+  ctx->graph_index.dissociate_entity(svc->publisher_gid);
   rmw_ret_t rc = remove_entity(ctx, svc->subscriber_gid, true);
   failed = failed && (RMW_RET_OK == rc);
 
@@ -646,6 +1039,7 @@ on_client_created(
   const rmw_node_t * const node,
   ClientInfo * const client)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   const rmw_gid_t pub_gid = client->publisher_gid;
   const rmw_gid_t sub_gid = client->subscriber_gid;
   bool add_pub = false;
@@ -684,6 +1078,10 @@ on_client_created(
     RMW_SET_ERROR_MSG("failed to add client graph");
     return RMW_RET_ERROR;
   }
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, sub_gid, true);
+  ctx->graph_index.associate_entity(
+    ctx->common_ctx.gid, node->name, node->namespace_, pub_gid, false);
 
   scope_exit_entities_reset.cancel();
   return RMW_RET_OK;
@@ -695,7 +1093,10 @@ on_client_deleted(
   const rmw_node_t * const node,
   ClientInfo * const client)
 {
+  std::lock_guard<std::mutex> guard{ctx->graph_mutex};
   bool failed = false;
+  ctx->graph_index.dissociate_entity(client->subscriber_gid);
+  ctx->graph_index.dissociate_entity(client->publisher_gid);
   rmw_ret_t rc = remove_entity(ctx, client->subscriber_gid, true);
   failed = failed && (RMW_RET_OK == rc);
 
@@ -713,6 +1114,10 @@ on_client_deleted(
 rmw_ret_t
 on_participant_info(rmw_context_impl_t * ctx)
 {
+  if (ctx->discovery_batch_size > 0) {
+    return take_participant_info_batches(ctx);
+  }
+
   bool taken = false;
   rmw_dds_common::msg::ParticipantEntitiesInfo msg;
 
@@ -722,20 +1127,7 @@ on_participant_info(rmw_context_impl_t * ctx)
       return RMW_RET_ERROR;
     }
     if (taken) {
-      if (std::memcmp(&msg.gid.data, ctx->common_ctx.gid.data, RMW_GID_STORAGE_SIZE) == 0) {
-        continue;
-      }
-
-      RCUTILS_LOG_DEBUG_NAMED(
-        RMW_GURUMDDS_ID,
-        "---- updating participant entities: "
-        "0x%08X.0x%08X.0x%08X.0x%08X",
-        reinterpret_cast<const uint32_t *>(&msg.gid.data)[0],
-        reinterpret_cast<const uint32_t *>(&msg.gid.data)[1],
-        reinterpret_cast<const uint32_t *>(&msg.gid.data)[2],
-        reinterpret_cast<const uint32_t *>(&msg.gid.data)[3]);
-
-      ctx->common_ctx.graph_cache.update_participant_entities(msg);
+      update_participant_info(ctx, msg);
     }
   } while (taken);
 
@@ -746,7 +1138,7 @@ rmw_ret_t
 add_participant(
   rmw_context_impl_t * const ctx,
   const dds_GUID_t * const dp_guid,
-  const char * const enclave)
+  std::string_view enclave)
 {
   rmw_gid_t gid;
   rmw_gurumdds_cpp::guid_to_gid(*dp_guid, gid);
@@ -756,13 +1148,11 @@ add_participant(
     return RMW_RET_OK;
   }
 
-  std::string enclave_str;
-  if (nullptr != enclave) {
-    enclave_str = enclave;
+  ctx->common_ctx.graph_cache.add_participant(gid, std::string{enclave});
+  if (ctx->discovery_cache != nullptr) {
+    ctx->discovery_cache->add_participant(gid, std::string{enclave});
   }
 
-  ctx->common_ctx.graph_cache.add_participant(gid, enclave_str);
-
   return RMW_RET_OK;
 }
 
@@ -780,6 +1170,10 @@ remove_participant(
   }
 
   ctx->common_ctx.graph_cache.remove_participant(gid);
+  ctx->graph_index.remove_participant(gid);
+  if (ctx->discovery_cache != nullptr) {
+    ctx->discovery_cache->remove_participant(gid);
+  }
 
   return RMW_RET_OK;
 }
@@ -809,7 +1203,7 @@ add_remote_entity(
   }
 
   rosidl_type_hash_s type_hash;
-  if(RMW_RET_OK != rmw_dds_common::parse_type_hash_from_user_data(
+  if(RMW_RET_OK != rmw_gurumdds_cpp::parse_type_hash_from_user_data(
     user_data.value, user_data.size, type_hash)) {
     type_hash = rosidl_get_zero_initialized_type_hash();
     rmw_reset_error();
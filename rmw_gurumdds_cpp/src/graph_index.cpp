@@ -0,0 +1,462 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
+#include <string>
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/topic_endpoint_info.h"
+
+#include "rmw_gurumdds_cpp/graph_index.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+void
+GraphIndex::add_entity(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_qos_profile_t & qos,
+  bool is_reader)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto & entities = is_reader ? readers_ : writers_;
+  auto & topics = is_reader ? topic_readers_ : topic_writers_;
+  auto it = entities.find(gid);
+  if (it != entities.end()) {
+    if (it->second.topic_name == topic_name) {
+      it->second.type_name = type_name;
+      it->second.type_hash = type_hash;
+      it->second.qos = qos;
+      version_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+
+    auto topic = topics.find(it->second.topic_name);
+    if (topic != topics.end()) {
+      topic->second.erase(gid);
+      if (topic->second.empty()) {
+        topics.erase(topic);
+      }
+    }
+    entities.erase(it);
+  }
+
+  entities.emplace(gid, EntityEntry{topic_name, type_name, type_hash, qos});
+  topics[topic_name].insert(gid);
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+void
+GraphIndex::remove_entity(const rmw_gid_t & gid, bool is_reader)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto & entities = is_reader ? readers_ : writers_;
+  auto & topics = is_reader ? topic_readers_ : topic_writers_;
+  auto it = entities.find(gid);
+  if (it == entities.end()) {
+    return;
+  }
+
+  auto topic = topics.find(it->second.topic_name);
+  if (topic != topics.end()) {
+    topic->second.erase(gid);
+    if (topic->second.empty()) {
+      topics.erase(topic);
+    }
+  }
+  entities.erase(it);
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+void
+GraphIndex::update_participant(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  rmw_gid_t participant_gid;
+  rmw_dds_common::convert_msg_to_gid(&msg.gid, &participant_gid);
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto participant = participant_nodes_.find(participant_gid);
+  if (participant != participant_nodes_.end()) {
+    // Copied, removing a node erases it from the list
+    std::vector<NodeMap::iterator> nodes = participant->second;
+    for (auto node : nodes) {
+      remove_node_unsafe(node);
+    }
+  }
+
+  for (const auto & node_info : msg.node_entities_info_seq) {
+    auto node = add_node_unsafe(participant_gid, node_info.node_name, node_info.node_namespace);
+    rmw_gid_t gid;
+    for (const auto & reader_gid : node_info.reader_gid_seq) {
+      rmw_dds_common::convert_msg_to_gid(&reader_gid, &gid);
+      associate_entity_unsafe(node, gid, true);
+    }
+    for (const auto & writer_gid : node_info.writer_gid_seq) {
+      rmw_dds_common::convert_msg_to_gid(&writer_gid, &gid);
+      associate_entity_unsafe(node, gid, false);
+    }
+  }
+}
+
+void
+GraphIndex::remove_participant(const rmw_gid_t & participant_gid)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto participant = participant_nodes_.find(participant_gid);
+  if (participant == participant_nodes_.end()) {
+    return;
+  }
+
+  // Copied, removing a node erases it from the list
+  std::vector<NodeMap::iterator> nodes = participant->second;
+  for (auto node : nodes) {
+    remove_node_unsafe(node);
+  }
+}
+
+void
+GraphIndex::add_node(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_name,
+  const std::string & node_namespace)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  add_node_unsafe(participant_gid, node_name, node_namespace);
+}
+
+void
+GraphIndex::remove_node(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_name,
+  const std::string & node_namespace)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto node = find_node_unsafe(participant_gid, node_name, node_namespace);
+  if (node != nodes_.end()) {
+    remove_node_unsafe(node);
+  }
+}
+
+void
+GraphIndex::associate_entity(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_name,
+  const std::string & node_namespace,
+  const rmw_gid_t & gid,
+  bool is_reader)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto node = find_node_unsafe(participant_gid, node_name, node_namespace);
+  if (node == nodes_.end()) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID,
+      "[graph] entity of unknown node not indexed: node=%s::%s",
+      node_namespace.c_str(), node_name.c_str());
+    return;
+  }
+
+  associate_entity_unsafe(node, gid, is_reader);
+}
+
+void
+GraphIndex::dissociate_entity(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto it = entity_nodes_.find(gid);
+  if (it == entity_nodes_.end()) {
+    return;
+  }
+
+  it->second->second.readers.erase(gid);
+  it->second->second.writers.erase(gid);
+  entity_nodes_.erase(it);
+}
+
+rmw_ret_t
+GraphIndex::get_names_and_types_by_node(
+  const std::string & node_name,
+  const std::string & node_namespace,
+  DemangleFunction demangle_topic,
+  DemangleFunction demangle_type,
+  bool is_reader,
+  NameCache & names,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * topic_names_and_types) const
+{
+  std::map<std::string, std::set<std::string>> topics;
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    auto node = nodes_.find(NodeKey{node_namespace, node_name});
+    if (node == nodes_.end()) {
+      return RMW_RET_NODE_NAME_NON_EXISTENT;
+    }
+
+    const auto & entities = is_reader ? readers_ : writers_;
+    const GidSet & gids = is_reader ? node->second.readers : node->second.writers;
+    std::string topic_storage;
+    std::string type_storage;
+    for (const rmw_gid_t & gid : gids) {
+      auto entity = entities.find(gid);
+      if (entity == entities.end()) {
+        // Announced by the participant, not discovered yet
+        continue;
+      }
+
+      const std::string & topic_name =
+        names.demangle(demangle_topic, entity->second.topic_name, topic_storage);
+      if (topic_name.empty()) {
+        continue;
+      }
+      topics[topic_name].insert(
+        names.demangle(demangle_type, entity->second.type_name, type_storage));
+    }
+  }
+
+  return copy_topics_names_and_types(topics, allocator, true, topic_names_and_types);
+}
+
+rmw_ret_t
+GraphIndex::get_entities_info_by_topic(
+  const std::string & topic_name,
+  DemangleFunction demangle_type,
+  bool is_reader,
+  NameCache & names,
+  rcutils_allocator_t * allocator,
+  rmw_topic_endpoint_info_array_t * endpoints_info) const
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  const auto & topics = is_reader ? topic_readers_ : topic_writers_;
+  auto topic = topics.find(topic_name);
+  if (topic == topics.end()) {
+    return RMW_RET_OK;
+  }
+
+  rmw_ret_t ret =
+    rmw_topic_endpoint_info_array_init_with_size(endpoints_info, topic->second.size(), allocator);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  auto fail_cleanup = [endpoints_info, allocator]() {
+      if (rmw_topic_endpoint_info_array_fini(endpoints_info, allocator) != RMW_RET_OK) {
+        RCUTILS_LOG_ERROR("error during report of error: %s", rmw_get_error_string().str);
+      }
+    };
+
+  const auto & entities = is_reader ? readers_ : writers_;
+  std::string type_storage;
+  size_t index = 0;
+  for (const rmw_gid_t & gid : topic->second) {
+    const EntityEntry & entity = entities.at(gid);
+    const char * node_name = "_NODE_NAME_UNKNOWN_";
+    const char * node_namespace = "_NODE_NAMESPACE_UNKNOWN_";
+    auto node = entity_nodes_.find(gid);
+    if (node != entity_nodes_.end()) {
+      node_namespace = node->second->first.first.c_str();
+      node_name = node->second->first.second.c_str();
+    }
+
+    rmw_topic_endpoint_info_t & info = endpoints_info->info_array[index++];
+    ret = rmw_topic_endpoint_info_set_node_name(&info, node_name, allocator);
+    if (ret == RMW_RET_OK) {
+      ret = rmw_topic_endpoint_info_set_node_namespace(&info, node_namespace, allocator);
+    }
+    if (ret == RMW_RET_OK) {
+      const std::string & type_name = names.demangle(demangle_type, entity.type_name, type_storage);
+      ret = rmw_topic_endpoint_info_set_topic_type(&info, type_name.c_str(), allocator);
+    }
+    if (ret == RMW_RET_OK) {
+      ret = rmw_topic_endpoint_info_set_topic_type_hash(&info, &entity.type_hash);
+    }
+    if (ret == RMW_RET_OK) {
+      ret = rmw_topic_endpoint_info_set_endpoint_type(
+        &info, is_reader ? RMW_ENDPOINT_SUBSCRIPTION : RMW_ENDPOINT_PUBLISHER);
+    }
+    if (ret == RMW_RET_OK) {
+      ret = rmw_topic_endpoint_info_set_gid(&info, gid.data, RMW_GID_STORAGE_SIZE);
+    }
+    if (ret == RMW_RET_OK) {
+      ret = rmw_topic_endpoint_info_set_qos_profile(&info, &entity.qos);
+    }
+    if (ret != RMW_RET_OK) {
+      fail_cleanup();
+      return ret;
+    }
+  }
+
+  return RMW_RET_OK;
+}
+
+std::shared_ptr<const GraphSnapshot>
+GraphIndex::get_snapshot() const
+{
+  std::shared_ptr<const GraphSnapshot> snapshot = std::atomic_load(&snapshot_);
+  if (snapshot != nullptr && snapshot->version == version_.load(std::memory_order_acquire)) {
+    return snapshot;
+  }
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  // Another query may have built it while waiting for the lock
+  snapshot = std::atomic_load(&snapshot_);
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  if (snapshot != nullptr && snapshot->version == version) {
+    return snapshot;
+  }
+
+  std::shared_ptr<const GraphSnapshot> built = build_snapshot_unsafe(version);
+  if (built == nullptr) {
+    // Error message already set
+    return nullptr;
+  }
+  std::atomic_store(&snapshot_, built);
+  return built;
+}
+
+uint64_t
+GraphIndex::get_version() const
+{
+  return version_.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<const GraphSnapshot>
+GraphIndex::build_snapshot_unsafe(uint64_t version) const
+{
+  GraphSnapshot * snapshot = new(std::nothrow) GraphSnapshot{};
+  if (snapshot == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate graph snapshot");
+    return nullptr;
+  }
+  std::shared_ptr<const GraphSnapshot> shared{snapshot};
+
+  snapshot->version = version;
+  for (const auto & topic : topic_readers_) {
+    snapshot->reader_counts.emplace(topic.first, topic.second.size());
+  }
+  for (const auto & topic : topic_writers_) {
+    snapshot->writer_counts.emplace(topic.first, topic.second.size());
+  }
+
+  // Demangled once per topic and type, not once per entity
+  for (const auto * entities : {&readers_, &writers_}) {
+    for (const auto & entity : *entities) {
+      snapshot->topics[entity.second.topic_name].insert(entity.second.type_name);
+    }
+  }
+  for (const auto & topic : snapshot->topics) {
+    const std::string ros_topic = demangle_ros_topic_from_topic(topic.first);
+    const std::string service = demangle_service_from_topic(topic.first);
+    for (const std::string & type_name : topic.second) {
+      if (!ros_topic.empty()) {
+        snapshot->ros_topics[ros_topic].insert(demangle_if_ros_type(type_name));
+      }
+      if (!service.empty()) {
+        snapshot->services[service].insert(demangle_service_type_only(type_name));
+      }
+    }
+  }
+
+  return shared;
+}
+
+GraphIndex::NodeMap::iterator
+GraphIndex::find_node_unsafe(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_name,
+  const std::string & node_namespace)
+{
+  auto range = nodes_.equal_range(NodeKey{node_namespace, node_name});
+  for (auto it = range.first; it != range.second; ++it) {
+    const rmw_gid_t & gid = it->second.participant_gid;
+    if (std::memcmp(gid.data, participant_gid.data, RMW_GID_STORAGE_SIZE) == 0) {
+      return it;
+    }
+  }
+
+  return nodes_.end();
+}
+
+GraphIndex::NodeMap::iterator
+GraphIndex::add_node_unsafe(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_name,
+  const std::string & node_namespace)
+{
+  auto node = find_node_unsafe(participant_gid, node_name, node_namespace);
+  if (node != nodes_.end()) {
+    return node;
+  }
+
+  node = nodes_.emplace(NodeKey{node_namespace, node_name}, NodeEntry{participant_gid, {}, {}});
+  participant_nodes_[participant_gid].push_back(node);
+  return node;
+}
+
+void
+GraphIndex::remove_node_unsafe(NodeMap::iterator node)
+{
+  for (const GidSet * gids : {&node->second.readers, &node->second.writers}) {
+    for (const rmw_gid_t & gid : *gids) {
+      auto it = entity_nodes_.find(gid);
+      if (it != entity_nodes_.end() && it->second == node) {
+        entity_nodes_.erase(it);
+      }
+    }
+  }
+
+  auto participant = participant_nodes_.find(node->second.participant_gid);
+  if (participant != participant_nodes_.end()) {
+    auto & nodes = participant->second;
+    for (auto it = nodes.begin(); it != nodes.end(); ++it) {
+      if (*it == node) {
+        nodes.erase(it);
+        break;
+      }
+    }
+    if (nodes.empty()) {
+      participant_nodes_.erase(participant);
+    }
+  }
+
+  nodes_.erase(node);
+}
+
+void
+GraphIndex::associate_entity_unsafe(NodeMap::iterator node, const rmw_gid_t & gid, bool is_reader)
+{
+  auto it = entity_nodes_.find(gid);
+  if (it != entity_nodes_.end()) {
+    if (it->second == node) {
+      return;
+    }
+    it->second->second.readers.erase(gid);
+    it->second->second.writers.erase(gid);
+    it->second = node;
+  } else {
+    entity_nodes_.emplace(gid, node);
+  }
+
+  (is_reader ? node->second.readers : node->second.writers).insert(gid);
+}
+} // namespace rmw_gurumdds_cpp
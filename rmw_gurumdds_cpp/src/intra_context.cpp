@@ -0,0 +1,408 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/gid.hpp"
+#include "rmw_gurumdds_cpp/intra_context.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+LocalSampleQueue::~LocalSampleQueue()
+{
+  if (condition_ != nullptr) {
+    dds_GuardCondition_delete(condition_);
+  }
+}
+
+bool LocalSampleQueue::init(size_t depth)
+{
+  depth_ = depth;
+  condition_ = dds_GuardCondition_create();
+  return condition_ != nullptr;
+}
+
+dds_GuardCondition * LocalSampleQueue::get_condition() const
+{
+  return condition_;
+}
+
+void LocalSampleQueue::push(const LocalSample & sample)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (depth_ > 0 && samples_.size() >= depth_) {
+    samples_.pop_front();
+  }
+  samples_.push_back(sample);
+  dds_GuardCondition_set_trigger_value(condition_, true);
+}
+
+bool LocalSampleQueue::pop(LocalSample & sample)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (mixed_.load(std::memory_order_relaxed) && depth_ > 0) {
+    while (!samples_.empty() && samples_.size() + newer_ > depth_) {
+      samples_.pop_front();
+    }
+  }
+
+  if (samples_.empty()) {
+    mixed_.store(false, std::memory_order_relaxed);
+    newer_ = 0;
+    dds_GuardCondition_set_trigger_value(condition_, false);
+    return false;
+  }
+
+  sample = std::move(samples_.front());
+  samples_.pop_front();
+  if (samples_.empty()) {
+    mixed_.store(false, std::memory_order_relaxed);
+    newer_ = 0;
+    dds_GuardCondition_set_trigger_value(condition_, false);
+  }
+  return true;
+}
+
+size_t LocalSampleQueue::size()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  return samples_.size();
+}
+
+void LocalSampleQueue::set_mixed()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (!samples_.empty()) {
+    mixed_.store(true, std::memory_order_relaxed);
+  }
+}
+
+void LocalSampleQueue::on_dds_sample()
+{
+  if (!mixed_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (mixed_.load(std::memory_order_relaxed)) {
+    newer_++;
+  }
+}
+
+static bool is_same_gid(const rmw_gid_t & gid, const rmw_gid_t & other)
+{
+  return std::memcmp(gid.data, other.data, sizeof(gid.data)) == 0;
+}
+
+static const LocalReader *
+find_reader(const std::vector<LocalReader> & readers, const rmw_gid_t & gid)
+{
+  for (const LocalReader & reader : readers) {
+    if (is_same_gid(reader.gid, gid)) {
+      return &reader;
+    }
+  }
+  return nullptr;
+}
+
+static void add_unique(std::vector<SubscriberInfo *> & list, SubscriberInfo * subscriber_info)
+{
+  if (std::find(list.begin(), list.end(), subscriber_info) == list.end()) {
+    list.push_back(subscriber_info);
+  }
+}
+
+static void erase_value(std::vector<SubscriberInfo *> & list, SubscriberInfo * subscriber_info)
+{
+  list.erase(std::remove(list.begin(), list.end(), subscriber_info), list.end());
+}
+
+// Marks the queues the publisher handed samples to as mixed, before it writes to DDS.
+// mutex_local held
+static void leave_local_unsafe(PublisherInfo * publisher_info)
+{
+  if (!publisher_info->local_active) {
+    return;
+  }
+
+  // The samples written to DDS from now on are newer than the ones left in the queues
+  std::vector<SubscriberInfo *> & handed = publisher_info->local_handed;
+  for (const LocalReader & reader : publisher_info->local_readers) {
+    if (reader.subscription != nullptr) {
+      add_unique(handed, reader.subscription);
+    }
+  }
+  for (SubscriberInfo * subscriber_info : handed) {
+    subscriber_info->local_samples->set_mixed();
+    add_unique(publisher_info->local_mixed, subscriber_info);
+  }
+  handed.clear();
+  publisher_info->local_active = false;
+}
+
+// GIDs of the readers the writer is matched with, false if they cannot be looked up
+static bool get_matched_gids(dds_DataWriter * topic_writer, std::vector<rmw_gid_t> & gids)
+{
+  dds_InstanceHandleSeq * matched = dds_InstanceHandleSeq_create(4);
+  if (matched == nullptr) {
+    return false;
+  }
+
+  bool result = dds_DataWriter_get_matched_subscriptions(topic_writer, matched) == dds_RETCODE_OK;
+  const uint32_t length = result ? dds_InstanceHandleSeq_length(matched) : 0;
+  try {
+    gids.reserve(length);
+  } catch (const std::bad_alloc &) {
+    result = false;
+  }
+
+  for (uint32_t i = 0; i < length && result; i++) {
+    dds_SubscriptionBuiltinTopicData data;
+    result = dds_DataWriter_get_matched_subscription_data(
+      topic_writer, &data, dds_InstanceHandleSeq_get(matched, i)) == dds_RETCODE_OK;
+    if (result) {
+      rmw_gid_t gid;
+      guid_to_gid(Guid_t{data}, gid);
+      gids.push_back(gid);
+    }
+  }
+  dds_InstanceHandleSeq_delete(matched);
+  return result;
+}
+
+void IntraContextDelivery::add_subscription(SubscriberInfo * subscriber_info)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  subscriptions_.push_back(subscriber_info);
+  for (PublisherInfo * publisher_info : publishers_) {
+    std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+    refresh_readers_unsafe(publisher_info);
+  }
+}
+
+void IntraContextDelivery::remove_subscription(SubscriberInfo * subscriber_info)
+{
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    erase_value(subscriptions_, subscriber_info);
+    for (PublisherInfo * publisher_info : publishers_) {
+      std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+      refresh_readers_unsafe(publisher_info);
+      erase_value(publisher_info->local_handed, subscriber_info);
+      erase_value(publisher_info->local_mixed, subscriber_info);
+    }
+  }
+
+  // A delivery that pushed its sample before may still be notifying the subscription
+  while (subscriber_info->local_notifying.load() > 0) {
+    std::this_thread::yield();
+  }
+}
+
+void IntraContextDelivery::add_publisher(PublisherInfo * publisher_info)
+{
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    publishers_.push_back(publisher_info);
+  }
+
+  // The readers matched before the listener was set are not reported to it
+  on_publication_matched(publisher_info);
+}
+
+void IntraContextDelivery::remove_publisher(PublisherInfo * publisher_info)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  publishers_.erase(
+    std::remove(publishers_.begin(), publishers_.end(), publisher_info), publishers_.end());
+  for (SubscriberInfo * subscriber_info : subscriptions_) {
+    subscriber_info->forget_publication(publisher_info->publisher_gid);
+  }
+}
+
+void IntraContextDelivery::on_publication_matched(PublisherInfo * publisher_info)
+{
+  uint64_t stamp;
+  {
+    std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+    stamp = ++publisher_info->local_match_stamp;
+  }
+
+  // Without the locks, a publish does not wait for DDS
+  std::vector<rmw_gid_t> gids;
+  bool known = get_matched_gids(publisher_info->topic_writer, gids);
+  std::vector<LocalReader> readers;
+  try {
+    readers.reserve(gids.size());
+  } catch (const std::bad_alloc &) {
+    known = false;
+  }
+
+  std::lock_guard<std::mutex> guard{mutex_};
+  std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+  if (stamp != publisher_info->local_match_stamp) {
+    // A newer lookup sets the readers
+    return;
+  }
+
+  // Unknown readers are left empty, the samples are written to DDS until the next match
+  for (size_t i = 0; i < gids.size() && known; i++) {
+    const LocalReader * matched = find_reader(publisher_info->local_readers, gids[i]);
+    if (matched != nullptr) {
+      readers.push_back(*matched);
+    } else {
+      readers.push_back(LocalReader{gids[i], publisher_info->local_last_dds, nullptr});
+    }
+  }
+
+  // The subscriptions of the readers that went away may still hold the samples handed to them
+  for (const LocalReader & matched : publisher_info->local_readers) {
+    if (publisher_info->local_active && matched.subscription != nullptr &&
+      find_reader(readers, matched.gid) == nullptr)
+    {
+      add_unique(publisher_info->local_handed, matched.subscription);
+    }
+  }
+  publisher_info->local_readers.swap(readers);
+  refresh_readers_unsafe(publisher_info);
+}
+
+void IntraContextDelivery::refresh_readers_unsafe(PublisherInfo * publisher_info)
+{
+  // Without matched readers the sample is written to DDS, for readers that match later on
+  bool ready = !publisher_info->local_readers.empty();
+  for (LocalReader & reader : publisher_info->local_readers) {
+    auto it = std::find_if(
+      subscriptions_.begin(), subscriptions_.end(),
+      [&reader](const SubscriberInfo * subscriber_info) {
+        return is_same_gid(subscriber_info->subscriber_gid, reader.gid);
+      });
+    // A reader of another context, or one that cannot be handed samples
+    SubscriberInfo * subscription = it != subscriptions_.end() ? *it : nullptr;
+    if (subscription != reader.subscription) {
+      // The earlier subscription may still hold the samples handed to it
+      if (publisher_info->local_active && reader.subscription != nullptr) {
+        add_unique(publisher_info->local_handed, reader.subscription);
+      }
+      reader.subscription = subscription;
+    }
+    ready = ready && subscription != nullptr;
+  }
+
+  // A publish that found the writer local goes through DDS once a reader cannot be handed to
+  if (ready != publisher_info->local_ready) {
+    publisher_info->local_ready = ready;
+    publisher_info->local_generation++;
+  }
+}
+
+bool IntraContextDelivery::is_local_only(PublisherInfo * publisher_info, uint64_t & generation)
+{
+  std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+  if (!publisher_info->local_ready) {
+    return false;
+  }
+
+  generation = publisher_info->local_generation;
+  if (publisher_info->local_active) {
+    return true;
+  }
+
+  // A sample written to DDS that a subscription did not take yet would be taken after the
+  // local ones. A reader that matched after it was written is not sent it, unless it is still
+  // queued
+  const int64_t last_dds = publisher_info->local_last_dds;
+  if (publisher_info->async != nullptr && !publisher_info->async->drain(0)) {
+    return false;
+  }
+  for (const LocalReader & reader : publisher_info->local_readers) {
+    if (reader.dds_floor < last_dds &&
+      reader.subscription->get_last_sequence_number(publisher_info->publisher_gid) < last_dds)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IntraContextDelivery::deliver(
+  PublisherInfo * publisher_info,
+  uint64_t generation,
+  LocalSample & sample)
+{
+  // Subscriptions to notify once the lock is released. A callback that publishes from the
+  // notification appends its own after them, and removes them before returning
+  static thread_local std::vector<SubscriberInfo *> notified;
+  const size_t first = notified.size();
+  {
+    std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+    if (generation != publisher_info->local_generation) {
+      return false;
+    }
+
+    std::vector<LocalReader> & readers = publisher_info->local_readers;
+    try {
+      notified.reserve(first + readers.size());
+    } catch (const std::bad_alloc &) {
+      // Written to DDS instead
+      return false;
+    }
+
+    // The subscriptions took the samples the writer wrote to DDS
+    if (!publisher_info->local_active) {
+      publisher_info->local_mixed.clear();
+      publisher_info->local_active = true;
+    }
+
+    sample.sequence_number =
+      publisher_info->sequence_number.fetch_add(1, std::memory_order_relaxed) + 1;
+    for (const LocalReader & reader : readers) {
+      reader.subscription->local_samples->push(sample);
+      reader.subscription->local_notifying.fetch_add(1);
+      notified.push_back(reader.subscription);
+    }
+  }
+
+  // Direct dispatch and capture take the sample from the notification, which must not hold
+  // the lock: their callbacks may publish or create and delete endpoints
+  const size_t last = notified.size();
+  for (size_t i = first; i < last; i++) {
+    notified[i]->on_data_available();
+    notified[i]->local_notifying.fetch_sub(1);
+  }
+  notified.resize(first);
+  return true;
+}
+
+int64_t IntraContextDelivery::number_dds_sample(PublisherInfo * publisher_info)
+{
+  std::lock_guard<std::mutex> local_guard{publisher_info->mutex_local};
+  leave_local_unsafe(publisher_info);
+  const int64_t sequence_number =
+    publisher_info->sequence_number.fetch_add(1, std::memory_order_relaxed) + 1;
+  publisher_info->local_last_dds = sequence_number;
+  // A publish that found the writer local hands its sample over after this one is taken
+  publisher_info->local_generation++;
+  for (SubscriberInfo * subscriber_info : publisher_info->local_mixed) {
+    subscriber_info->local_samples->on_dds_sample();
+  }
+  return sequence_number;
+}
+} // namespace rmw_gurumdds_cpp
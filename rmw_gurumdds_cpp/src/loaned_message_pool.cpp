@@ -0,0 +1,141 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+#include "rmw_gurumdds_cpp/loaned_message_pool.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Keeps the message aligned for any member, the header is placed directly before it
+static constexpr size_t loaned_message_offset = alignof(std::max_align_t);
+
+LoanedMessagePool::~LoanedMessagePool() {
+  for (uint8_t * buffer : buffers_) {
+    free_buffer_memory(memory_, buffer, allocated_size_);
+  }
+}
+
+bool LoanedMessagePool::can_loan(const MessagePlan * plan) {
+  // Byte-swapped output is not a copy of the message memory
+  return plan->is_plain() && get_cdr_output_endian() == CDR_SYSTEM_ENDIAN;
+}
+
+bool LoanedMessagePool::init(const MessagePlan * plan, size_t count, int memory) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  plan_ = plan;
+  memory_ = memory;
+  // The serialized sample is padded to 4 bytes, which may extend past the message
+  buffer_size_ = loaned_message_offset + plan->get_message_size() + sizeof(uint32_t);
+  buffers_.reserve(count);
+  free_buffers_.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    uint8_t * buffer = allocate();
+    if (buffer == nullptr) {
+      return false;
+    }
+    free_buffers_.push_back(buffer);
+  }
+
+  return true;
+}
+
+bool LoanedMessagePool::reserve(size_t count) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  try {
+    buffers_.reserve(count);
+    free_buffers_.reserve(count);
+    loaned_messages_.reserve(count);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+
+  while (buffers_.size() < count) {
+    uint8_t * buffer = allocate();
+    if (buffer == nullptr) {
+      return false;
+    }
+    free_buffers_.push_back(buffer);
+  }
+  return true;
+}
+
+bool LoanedMessagePool::is_enabled() const {
+  return plan_ != nullptr;
+}
+
+uint8_t * LoanedMessagePool::allocate() {
+  // Every buffer of a kind is rounded up to the same size
+  uint8_t * buffer = allocate_buffer_memory(memory_, buffer_size_, &allocated_size_);
+  if (buffer == nullptr) {
+    return nullptr;
+  }
+
+  uint8_t * header = buffer + loaned_message_offset - CDR_HEADER_SIZE;
+  std::memset(header, 0, CDR_HEADER_SIZE);
+  header[CDR_HEADER_ENDIAN_IDX] = CDR_SYSTEM_ENDIAN;
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+void * LoanedMessagePool::borrow() {
+  std::lock_guard<std::mutex> guard{mutex_};
+  uint8_t * buffer = nullptr;
+  if (free_buffers_.empty()) {
+    buffer = allocate();
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+  } else {
+    buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+  }
+
+  void * ros_message = buffer + loaned_message_offset;
+  loaned_messages_.insert(ros_message);
+  plan_->init_message(ros_message);
+  return ros_message;
+}
+
+void * LoanedMessagePool::get_dds_message(void * ros_message, size_t * size) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (loaned_messages_.find(ros_message) == loaned_messages_.end()) {
+    return nullptr;
+  }
+
+  // Same final padding as the serializer, zeroed since it may hold tail padding of the message
+  size_t plain_size = plan_->get_plain_size();
+  size_t padded_size = (plain_size + 3) & ~static_cast<size_t>(3);
+  auto data = static_cast<uint8_t *>(ros_message);
+  std::memset(data + plain_size, 0, padded_size - plain_size);
+
+  *size = CDR_HEADER_SIZE + padded_size;
+  return data - CDR_HEADER_SIZE;
+}
+
+bool LoanedMessagePool::release(void * ros_message) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (loaned_messages_.erase(ros_message) == 0) {
+    return false;
+  }
+
+  plan_->fini_message(ros_message);
+  free_buffers_.push_back(static_cast<uint8_t *>(ros_message) - loaned_message_offset);
+  return true;
+}
+} // namespace rmw_gurumdds_cpp
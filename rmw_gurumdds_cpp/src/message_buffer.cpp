@@ -0,0 +1,305 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+MessageBuffer::MessageBuffer(int memory)
+  : memory_{memory} {
+}
+
+MessageBuffer::~MessageBuffer() {
+  free_buffer_memory(memory_, data_, capacity_);
+}
+
+uint8_t * MessageBuffer::grow(size_t size) {
+  if (size <= capacity_) {
+    return data_;
+  }
+
+  if (memory_ != BUFFER_MEMORY_HEAP) {
+    // Mapped memory is not reallocated in place, the grown buffer is a new mapping
+    size_t allocated_size = 0;
+    uint8_t * new_data = allocate_buffer_memory(memory_, size, &allocated_size);
+    if (nullptr == new_data) {
+      return nullptr;
+    }
+    if (nullptr != data_) {
+      std::memcpy(new_data, data_, capacity_);
+      free_buffer_memory(memory_, data_, capacity_);
+    }
+    data_ = new_data;
+    capacity_ = allocated_size;
+    return data_;
+  }
+
+  void * new_data = realloc(data_, size);
+  if (nullptr == new_data) {
+    return nullptr;
+  }
+
+  data_ = static_cast<uint8_t *>(new_data);
+  capacity_ = size;
+  return data_;
+}
+
+uint8_t * MessageBuffer::data() const {
+  return data_;
+}
+
+size_t MessageBuffer::capacity() const {
+  return capacity_;
+}
+
+MessageBufferPool::~MessageBufferPool() {
+  for (MessageBuffer * buffer : free_buffers_) {
+    delete buffer;
+  }
+}
+
+MessageBuffer * MessageBufferPool::acquire() {
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (!free_buffers_.empty()) {
+    MessageBuffer * buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+    return buffer;
+  }
+
+  // Room for every buffer is reserved up front, so that release does not allocate
+  try {
+    free_buffers_.reserve(buffer_count_ + 1);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+
+  MessageBuffer * buffer = new(std::nothrow) MessageBuffer(memory_);
+  if (nullptr != buffer) {
+    buffer_count_++;
+  }
+  return buffer;
+}
+
+void MessageBufferPool::release(MessageBuffer * buffer) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  free_buffers_.push_back(buffer);
+}
+
+void MessageBufferPool::set_memory(int memory) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  memory_ = memory;
+}
+
+bool MessageBufferPool::reserve(size_t count, size_t size) {
+  std::lock_guard<std::mutex> guard{mutex_};
+  try {
+    free_buffers_.reserve(std::max(count, buffer_count_));
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+
+  while (buffer_count_ < count) {
+    MessageBuffer * buffer = new(std::nothrow) MessageBuffer(memory_);
+    if (nullptr == buffer) {
+      return false;
+    }
+    free_buffers_.push_back(buffer);
+    buffer_count_++;
+  }
+
+  // Buffers in use are grown by the write they are used for
+  for (MessageBuffer * buffer : free_buffers_) {
+    if (nullptr == buffer->grow(size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct SharedMessageBufferPool::State
+{
+  std::mutex mutex;
+  int memory {BUFFER_MEMORY_HEAP};
+  std::vector<MessageBuffer *> free_buffers;
+  size_t buffer_count {0};
+  // Control blocks of the shared_ptrs, which are all of the same type
+  std::vector<void *> free_blocks;
+  size_t block_count {0};
+  size_t block_size {0};
+
+  ~State()
+  {
+    for (MessageBuffer * buffer : free_buffers) {
+      delete buffer;
+    }
+    for (void * block : free_blocks) {
+      ::operator delete(block);
+    }
+  }
+};
+
+struct SharedMessageBufferPool::Releaser
+{
+  std::shared_ptr<State> state;
+
+  void operator()(MessageBuffer * buffer) const
+  {
+    std::lock_guard<std::mutex> guard{state->mutex};
+    state->free_buffers.push_back(buffer);
+  }
+};
+
+template<typename T>
+struct SharedMessageBufferPool::BlockAllocator
+{
+  using value_type = T;
+
+  // Keeps the pool alive until the control block is deallocated
+  std::shared_ptr<State> state;
+
+  explicit BlockAllocator(std::shared_ptr<State> pool_state)
+  : state{std::move(pool_state)}
+  {
+  }
+
+  template<typename U>
+  BlockAllocator(const BlockAllocator<U> & other)
+  : state{other.state}
+  {
+  }
+
+  T * allocate(size_t n)
+  {
+    const size_t size = n * sizeof(T);
+    std::lock_guard<std::mutex> guard{state->mutex};
+    if (state->block_size == 0) {
+      state->block_size = size;
+    }
+    if (size != state->block_size) {
+      return static_cast<T *>(::operator new(size));
+    }
+    if (!state->free_blocks.empty()) {
+      void * block = state->free_blocks.back();
+      state->free_blocks.pop_back();
+      return static_cast<T *>(block);
+    }
+
+    // Room for every block is reserved up front, so that deallocate does not allocate
+    state->free_blocks.reserve(state->block_count + 1);
+    void * block = ::operator new(size);
+    state->block_count++;
+    return static_cast<T *>(block);
+  }
+
+  void deallocate(T * p, size_t n)
+  {
+    std::lock_guard<std::mutex> guard{state->mutex};
+    if (n * sizeof(T) != state->block_size) {
+      ::operator delete(p);
+      return;
+    }
+    state->free_blocks.push_back(p);
+  }
+
+  template<typename U>
+  bool operator==(const BlockAllocator<U> & other) const
+  {
+    return state == other.state;
+  }
+
+  template<typename U>
+  bool operator!=(const BlockAllocator<U> & other) const
+  {
+    return state != other.state;
+  }
+};
+
+SharedMessageBufferPool::SharedMessageBufferPool() {
+  // Checked by every call, so that a failure shows up as the allocation failure of a write
+  try {
+    state_ = std::make_shared<State>();
+  } catch (const std::bad_alloc &) {
+  }
+}
+
+std::shared_ptr<MessageBuffer> SharedMessageBufferPool::acquire() {
+  if (state_ == nullptr) {
+    return nullptr;
+  }
+
+  MessageBuffer * buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> guard{state_->mutex};
+    if (!state_->free_buffers.empty()) {
+      buffer = state_->free_buffers.back();
+      state_->free_buffers.pop_back();
+    } else {
+      // Room for every buffer is reserved up front, so that the release does not allocate
+      try {
+        state_->free_buffers.reserve(state_->buffer_count + 1);
+      } catch (const std::bad_alloc &) {
+        return nullptr;
+      }
+      buffer = new(std::nothrow) MessageBuffer(state_->memory);
+      if (nullptr == buffer) {
+        return nullptr;
+      }
+      state_->buffer_count++;
+    }
+  }
+
+  try {
+    return std::shared_ptr<MessageBuffer>(
+      buffer, Releaser{state_}, BlockAllocator<MessageBuffer>{state_});
+  } catch (const std::bad_alloc &) {
+    // The buffer was released
+    return nullptr;
+  }
+}
+
+void SharedMessageBufferPool::set_memory(int memory) {
+  if (state_ == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard{state_->mutex};
+  state_->memory = memory;
+}
+
+bool SharedMessageBufferPool::reserve(size_t count, size_t size) {
+  std::vector<std::shared_ptr<MessageBuffer>> buffers;
+  try {
+    buffers.reserve(count);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+
+  // The buffers are in use at once, so that the pool creates the missing ones, and go back
+  // to the pool when they are dropped
+  for (size_t i = 0; i < count; i++) {
+    std::shared_ptr<MessageBuffer> buffer = acquire();
+    if (buffer == nullptr || nullptr == buffer->grow(size)) {
+      return false;
+    }
+    buffers.push_back(std::move(buffer));
+  }
+  return true;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,1131 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include "rmw/error_handling.h"
+
+#include "rosidl_runtime_c/message_initialization.h"
+#include "rosidl_runtime_cpp/message_initialization.hpp"
+
+#include "rosidl_typesupport_introspection_c/field_types.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/deserialization_arena.hpp"
+#include "rmw_gurumdds_cpp/message_converter.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+#include "rmw_gurumdds_cpp/tracing.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+namespace
+{
+template<typename MessageMemberT>
+inline const MessageMemberT * get_member(const MessagePlanOp & op)
+{
+  return static_cast<const MessageMemberT *>(op.member);
+}
+
+template<typename T>
+struct PrimitiveOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    buffer << *reinterpret_cast<const T *>(input + op.offset);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    buffer >> *reinterpret_cast<T *>(output + op.offset);
+  }
+};
+
+// Fixed size arrays are contiguous in both C arrays and std::array
+template<typename T>
+struct PrimitiveArrayOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    buffer.copy_arr(reinterpret_cast<const T *>(input + op.offset), op.array_size);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    buffer.copy_arr(reinterpret_cast<T *>(output + op.offset), op.array_size);
+  }
+};
+
+// Points a C sequence of an arena message at zeroed arena memory. False without an arena
+template<typename SequenceT>
+inline bool arena_sequence(
+  CdrDeserializationBuffer & buffer, SequenceT * seq, size_t size, size_t element_size)
+{
+  DeserializationArena * arena = buffer.get_arena();
+  if (arena == nullptr) {
+    return false;
+  }
+
+  void * data = nullptr;
+  if (size > 0) {
+    data = arena->allocate(size * element_size, alignof(std::max_align_t));
+    if (data == nullptr) {
+      throw std::runtime_error("Failed to allocate sequence");
+    }
+    std::memset(data, 0, size * element_size);
+  }
+
+  seq->data = static_cast<decltype(seq->data)>(data);
+  seq->size = size;
+  seq->capacity = size;
+  return true;
+}
+
+template<typename T>
+struct CPrimitiveSequenceOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto seq = reinterpret_cast<const rmw_seq_t<T> *>(input + op.offset);
+    buffer << static_cast<uint32_t>(seq->size);
+    buffer.copy_arr(seq->data, seq->size);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    uint32_t size = 0;
+    buffer >> size;
+    auto seq = reinterpret_cast<rmw_seq_t<T> *>(output + op.offset);
+    if (!arena_sequence(buffer, seq, size, sizeof(T)) && !reuse_sequence(seq, size)) {
+      if (nullptr != seq->data) {
+        seq->fini();
+      }
+
+      if (!seq->init(size)) {
+        throw std::runtime_error("Failed to initialize sequence");
+      }
+    }
+
+    buffer.copy_arr(seq->data, size);
+  }
+};
+
+template<typename T>
+struct CxxPrimitiveSequenceOp
+{
+  using MessageMemberT = rosidl_typesupport_introspection_cpp::MessageMember;
+
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    const void * vec = input + op.offset;
+    const uint32_t size = static_cast<uint32_t>(member->size_function(vec));
+    buffer << size;
+    if (size > 0) {
+      buffer.copy_arr(reinterpret_cast<const T *>(member->get_const_function(vec, 0)), size);
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    void * vec = output + op.offset;
+    uint32_t size = 0;
+    buffer >> size;
+    member->resize_function(vec, static_cast<size_t>(size));
+    if (size > 0) {
+      buffer.copy_arr(reinterpret_cast<T *>(member->get_function(vec, 0)), size);
+    }
+  }
+};
+
+struct BooleanOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    buffer << static_cast<uint8_t>(*reinterpret_cast<const bool *>(input + op.offset));
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    uint8_t data = 0;
+    buffer >> data;
+    *reinterpret_cast<bool *>(output + op.offset) = (data != 0);
+  }
+};
+
+struct BooleanArrayOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    buffer.copy_bool_arr(reinterpret_cast<const bool *>(input + op.offset), op.array_size);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    buffer.copy_bool_arr(reinterpret_cast<bool *>(output + op.offset), op.array_size);
+  }
+};
+
+struct CBooleanSequenceOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto seq = reinterpret_cast<const rosidl_runtime_c__boolean__Sequence *>(input + op.offset);
+    buffer << static_cast<uint32_t>(seq->size);
+    buffer.copy_bool_arr(seq->data, seq->size);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    uint32_t size = 0;
+    buffer >> size;
+    auto seq = reinterpret_cast<rosidl_runtime_c__boolean__Sequence *>(output + op.offset);
+    if (!arena_sequence(buffer, seq, size, sizeof(bool)) && !reuse_sequence(seq, size)) {
+      if (nullptr != seq->data) {
+        rosidl_runtime_c__boolean__Sequence__fini(seq);
+      }
+
+      if (!rosidl_runtime_c__boolean__Sequence__init(seq, size)) {
+        throw std::runtime_error("Failed to initialize sequence");
+      }
+    }
+
+    buffer.copy_bool_arr(seq->data, size);
+  }
+};
+
+struct CxxBooleanSequenceOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto & vec = *reinterpret_cast<const std::vector<bool> *>(input + op.offset);
+    buffer << static_cast<uint32_t>(vec.size());
+    buffer.copy_bool_vector(vec);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    auto & vec = *reinterpret_cast<std::vector<bool> *>(output + op.offset);
+    uint32_t size = 0;
+    buffer >> size;
+    buffer.copy_bool_vector(vec, size);
+  }
+};
+
+template<typename StringT>
+struct CStringTraits {};
+
+template<>
+struct CStringTraits<rosidl_runtime_c__String>
+{
+  using SequenceT = rosidl_runtime_c__String__Sequence;
+  static bool init(SequenceT * seq, size_t size) {return rosidl_runtime_c__String__Sequence__init(seq, size);}
+  static void fini(SequenceT * seq) {rosidl_runtime_c__String__Sequence__fini(seq);}
+};
+
+template<>
+struct CStringTraits<rosidl_runtime_c__U16String>
+{
+  using SequenceT = rosidl_runtime_c__U16String__Sequence;
+  static bool init(SequenceT * seq, size_t size) {
+    return rosidl_runtime_c__U16String__Sequence__init(seq, size);
+  }
+  static void fini(SequenceT * seq) {rosidl_runtime_c__U16String__Sequence__fini(seq);}
+};
+
+inline void read_string(CdrDeserializationBuffer & buffer, rosidl_runtime_c__String & dst)
+{
+  // Arena strings are allocated by the buffer
+  if (nullptr == dst.data && nullptr == buffer.get_arena() &&
+    !rosidl_runtime_c__String__init(&dst))
+  {
+    throw std::runtime_error("Failed to initialize string");
+  }
+
+  buffer >> dst;
+}
+
+inline void read_string(CdrDeserializationBuffer & buffer, rosidl_runtime_c__U16String & dst)
+{
+  // Arena strings are allocated by the buffer
+  if (nullptr == dst.data && nullptr == buffer.get_arena() &&
+    !rosidl_runtime_c__U16String__init(&dst))
+  {
+    throw std::runtime_error("Failed to initialize string");
+  }
+
+  buffer >> dst;
+}
+
+inline void read_string(CdrDeserializationBuffer & buffer, std::string & dst)
+{
+  buffer >> dst;
+}
+
+inline void read_string(CdrDeserializationBuffer & buffer, std::u16string & dst)
+{
+  buffer >> dst;
+}
+
+template<typename StringT>
+struct StringOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    buffer << *reinterpret_cast<const StringT *>(input + op.offset);
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    read_string(buffer, *reinterpret_cast<StringT *>(output + op.offset));
+  }
+};
+
+template<typename StringT>
+struct StringArrayOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto arr = reinterpret_cast<const StringT *>(input + op.offset);
+    for (uint32_t i = 0; i < op.array_size; i++) {
+      buffer << arr[i];
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    auto arr = reinterpret_cast<StringT *>(output + op.offset);
+    for (uint32_t i = 0; i < op.array_size; i++) {
+      read_string(buffer, arr[i]);
+    }
+  }
+};
+
+template<typename StringT>
+struct CStringSequenceOp
+{
+  using SequenceT = typename CStringTraits<StringT>::SequenceT;
+
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto seq = reinterpret_cast<const SequenceT *>(input + op.offset);
+    buffer << static_cast<uint32_t>(seq->size);
+    for (size_t i = 0; i < seq->size; i++) {
+      buffer << seq->data[i];
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    uint32_t size = 0;
+    buffer >> size;
+    auto seq = reinterpret_cast<SequenceT *>(output + op.offset);
+    if (!arena_sequence(buffer, seq, size, sizeof(StringT)) && !reuse_sequence(seq, size)) {
+      if (nullptr != seq->data) {
+        CStringTraits<StringT>::fini(seq);
+      }
+
+      if (!CStringTraits<StringT>::init(seq, size)) {
+        throw std::runtime_error("Failed to initialize sequence");
+      }
+    }
+
+    for (uint32_t i = 0; i < size; i++) {
+      read_string(buffer, seq->data[i]);
+    }
+  }
+};
+
+template<typename StringT>
+struct CxxStringSequenceOp
+{
+  using MessageMemberT = rosidl_typesupport_introspection_cpp::MessageMember;
+
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    const void * vec = input + op.offset;
+    const uint32_t size = static_cast<uint32_t>(member->size_function(vec));
+    buffer << size;
+    if (size > 0) {
+      auto arr = reinterpret_cast<const StringT *>(member->get_const_function(vec, 0));
+      for (uint32_t i = 0; i < size; i++) {
+        buffer << arr[i];
+      }
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan &, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    void * vec = output + op.offset;
+    uint32_t size = 0;
+    buffer >> size;
+    member->resize_function(vec, static_cast<size_t>(size));
+    if (size > 0) {
+      auto arr = reinterpret_cast<StringT *>(member->get_function(vec, 0));
+      for (uint32_t i = 0; i < size; i++) {
+        buffer >> arr[i];
+      }
+    }
+  }
+};
+
+struct StructArrayOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    const uint8_t * element = input + op.offset;
+    for (uint32_t i = 0; i < op.array_size; i++, element += op.element_size) {
+      plan.run(op.first, op.last, buffer, element);
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    uint8_t * element = output + op.offset;
+    for (uint32_t i = 0; i < op.array_size; i++, element += op.element_size) {
+      plan.run(op.first, op.last, buffer, element);
+    }
+  }
+};
+
+template<typename MessageMemberT>
+struct StructSequenceOp
+{
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    const void * seq = input + op.offset;
+    const uint32_t size = static_cast<uint32_t>(member->size_function(seq));
+    buffer << size;
+    if (size > 0) {
+      auto element = reinterpret_cast<const uint8_t *>(member->get_const_function(seq, 0));
+      for (uint32_t i = 0; i < size; i++, element += op.element_size) {
+        plan.run(op.first, op.last, buffer, element);
+      }
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    auto member = get_member<MessageMemberT>(op);
+    void * seq = output + op.offset;
+    uint32_t size = 0;
+    buffer >> size;
+    if constexpr (get_language_kind<MessageMemberT>() == LanguageKind::C) {
+      // The generated resize function always reallocates and reinitializes the elements
+      auto header = reinterpret_cast<rmw_seq_header_t *>(seq);
+      if (!arena_sequence(buffer, header, size, op.element_size) &&
+        !reuse_sequence(header, size) &&
+        !member->resize_function(seq, static_cast<size_t>(size)))
+      {
+        throw std::runtime_error("Failed to resize sequence");
+      }
+    } else {
+      member->resize_function(seq, static_cast<size_t>(size));
+    }
+
+    if (size > 0) {
+      auto element = reinterpret_cast<uint8_t *>(member->get_function(seq, 0));
+      for (uint32_t i = 0; i < size; i++, element += op.element_size) {
+        plan.run(op.first, op.last, buffer, element);
+      }
+    }
+  }
+};
+
+// Copies a run of contiguous primitives at once when the stream is aligned like the
+// message in memory, otherwise falls back to the ops it replaces
+struct CopyRunOp
+{
+  template<typename BufferT>
+  static bool is_aligned(const MessagePlan & plan, const MessagePlanOp & op, BufferT & buffer)
+  {
+    buffer.roundup(plan.get_op(op.first).alignment);
+    return ((buffer.get_offset() - op.offset) & (op.alignment - 1)) == 0;
+  }
+
+  template<bool SERIALIZE>
+  static void serialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrSerializationBuffer<SERIALIZE> & buffer, const uint8_t * input)
+  {
+    if (!buffer.needs_swap() && is_aligned(plan, op, buffer)) {
+      buffer.copy_arr(input + op.offset, op.element_size);
+    } else {
+      plan.run(op.first, op.last, buffer, input);
+    }
+  }
+
+  static void deserialize(
+    const MessagePlan & plan, const MessagePlanOp & op,
+    CdrDeserializationBuffer & buffer, uint8_t * output)
+  {
+    if (!buffer.needs_swap() && is_aligned(plan, op, buffer)) {
+      buffer.copy_arr(output + op.offset, op.element_size);
+    } else {
+      plan.run(op.first, op.last, buffer, output);
+    }
+  }
+};
+
+template<typename OpT>
+inline void set_handlers(MessagePlanOp & op)
+{
+  op.serialize = &OpT::template serialize<true>;
+  op.get_size = &OpT::template serialize<false>;
+  op.deserialize = &OpT::deserialize;
+}
+
+template<typename MessageMemberT>
+inline bool is_sequence(const MessageMemberT * member)
+{
+  return member->is_array_ && (!member->array_size_ || member->is_upper_bound_);
+}
+
+template<typename MessageMemberT, typename T>
+inline void set_primitive_handlers(MessagePlanOp & op, const MessageMemberT * member)
+{
+  op.element_size = sizeof(T);
+  if (!member->is_array_) {
+    op.alignment = sizeof(T);
+    set_handlers<PrimitiveOp<T>>(op);
+  } else if (!is_sequence(member)) {
+    op.alignment = sizeof(T);
+    set_handlers<PrimitiveArrayOp<T>>(op);
+  } else if constexpr (get_language_kind<MessageMemberT>() == LanguageKind::C) {
+    set_handlers<CPrimitiveSequenceOp<T>>(op);
+  } else {
+    set_handlers<CxxPrimitiveSequenceOp<T>>(op);
+  }
+}
+
+template<typename MessageMemberT, typename CStringT, typename CxxStringT>
+inline void set_string_handlers(MessagePlanOp & op, const MessageMemberT * member)
+{
+  constexpr bool IS_C = get_language_kind<MessageMemberT>() == LanguageKind::C;
+  using StringT = std::conditional_t<IS_C, CStringT, CxxStringT>;
+  op.element_size = sizeof(StringT);
+  if (!member->is_array_) {
+    set_handlers<StringOp<StringT>>(op);
+  } else if (!is_sequence(member)) {
+    set_handlers<StringArrayOp<StringT>>(op);
+  } else if constexpr (IS_C) {
+    set_handlers<CStringSequenceOp<StringT>>(op);
+  } else {
+    set_handlers<CxxStringSequenceOp<StringT>>(op);
+  }
+}
+
+// Upper bound of a serialized size. Once a member of varying length is passed the
+// exact offset is unknown, and every alignment is assumed to need full padding.
+struct MaxSerializedSize
+{
+  size_t size {0};
+  bool exact {true};
+  bool bounded {true};
+
+  void add(size_t alignment, size_t bytes)
+  {
+    size += exact ? (-size & (alignment - 1)) : alignment - 1;
+    size += bytes;
+  }
+};
+
+template<typename MessageMembersT>
+void add_max_serialized_size(const MessageMembersT * members, MaxSerializedSize & max_size)
+{
+  using MessageMemberT = MessageMemberType<MessageMembersT>;
+  for (uint32_t i = 0; i < members->member_count_ && max_size.bounded; i++) {
+    const MessageMemberT * member = members->members_ + i;
+    size_t count = member->is_array_ ? member->array_size_ : 1;
+    bool varying = false;
+    if (is_sequence(member)) {
+      if (!member->is_upper_bound_) {
+        max_size.bounded = false;
+        return;
+      }
+      max_size.add(sizeof(uint32_t), sizeof(uint32_t));
+      varying = true;
+    }
+
+    switch (member->type_id_) {
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOLEAN:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_OCTET:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+        max_size.add(sizeof(uint8_t), count * sizeof(uint8_t));
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_WCHAR:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+        max_size.add(sizeof(uint16_t), count * sizeof(uint16_t));
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+        max_size.add(sizeof(uint32_t), count * sizeof(uint32_t));
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_DOUBLE:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+        max_size.add(sizeof(uint64_t), count * sizeof(uint64_t));
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+      {
+        if (member->string_upper_bound_ == 0) {
+          max_size.bounded = false;
+          return;
+        }
+
+        // Strings carry a terminating null, wide strings do not
+        bool wide = member->type_id_ == rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING;
+        size_t char_size = wide ? sizeof(char16_t) : sizeof(char);
+        size_t length = wide ? member->string_upper_bound_ : member->string_upper_bound_ + 1;
+        for (size_t j = 0; j < count; j++) {
+          max_size.add(sizeof(uint32_t), sizeof(uint32_t));
+          max_size.add(char_size, length * char_size);
+          max_size.exact = false;
+        }
+        break;
+      }
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+      {
+        auto inner = static_cast<const MessageMembersT *>(member->members_->data);
+        for (size_t j = 0; j < count && max_size.bounded; j++) {
+          add_max_serialized_size(inner, max_size);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+
+    if (varying) {
+      max_size.exact = false;
+    }
+  }
+}
+}  // namespace
+
+const MessagePlan * MessagePlan::get(const rosidl_message_type_support_t * type_support)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const rosidl_message_type_support_t *,
+    std::unique_ptr<MessagePlan>> plans;
+
+  std::lock_guard<std::mutex> guard{mutex};
+  auto it = plans.find(type_support);
+  if (it != plans.end()) {
+    return it->second.get();
+  }
+
+  std::unique_ptr<MessagePlan> plan{new(std::nothrow) MessagePlan{type_support}};
+  if (nullptr == plan) {
+    RMW_SET_ERROR_MSG("failed to allocate MessagePlan");
+    return nullptr;
+  }
+
+  bool compiled = false;
+  if (type_support->typesupport_identifier == rosidl_typesupport_introspection_c__identifier) {
+    compiled = plan->compile<rosidl_typesupport_introspection_c__MessageMembers>();
+  } else if (type_support->typesupport_identifier ==
+    rosidl_typesupport_introspection_cpp::typesupport_identifier)
+  {
+    compiled = plan->compile<rosidl_typesupport_introspection_cpp::MessageMembers>();
+  } else {
+    RMW_SET_ERROR_MSG("Unknown typesupport identifier");
+  }
+
+  if (!compiled) {
+    return nullptr;
+  }
+
+  return plans.emplace(type_support, std::move(plan)).first->second.get();
+}
+
+MessagePlan::MessagePlan(const rosidl_message_type_support_t * type_support)
+: type_support_{type_support} {
+}
+
+const rosidl_message_type_support_t * MessagePlan::get_type_support() const
+{
+  return type_support_;
+}
+
+size_t MessagePlan::get_message_size() const
+{
+  return message_size_;
+}
+
+bool MessagePlan::is_plain() const
+{
+  return root_last_ == 1 && ops_[0].alignment != 0;
+}
+
+bool MessagePlan::is_bounded() const
+{
+  return max_serialized_size_ != 0;
+}
+
+size_t MessagePlan::get_max_serialized_size() const
+{
+  return max_serialized_size_;
+}
+
+size_t MessagePlan::get_plain_size() const
+{
+  return static_cast<size_t>(ops_[0].element_size) * std::max<uint32_t>(ops_[0].array_size, 1);
+}
+
+size_t MessagePlan::get_plain_alignment() const
+{
+  return ops_[0].alignment;
+}
+
+void MessagePlan::init_message(void * ros_message) const
+{
+  if (type_support_->typesupport_identifier == rosidl_typesupport_introspection_c__identifier) {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(type_support_->data);
+    members->init_function(ros_message, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+  } else {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(type_support_->data);
+    members->init_function(ros_message, rosidl_runtime_cpp::MessageInitialization::ALL);
+  }
+}
+
+void MessagePlan::fini_message(void * ros_message) const
+{
+  if (type_support_->typesupport_identifier == rosidl_typesupport_introspection_c__identifier) {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(type_support_->data);
+    members->fini_function(ros_message);
+  } else {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(type_support_->data);
+    members->fini_function(ros_message);
+  }
+}
+
+const MessagePlanOp & MessagePlan::get_op(uint32_t index) const
+{
+  return ops_[index];
+}
+
+ssize_t MessagePlan::get_serialized_size(const void * ros_message) const
+{
+  if (ros_message == nullptr) {
+    RMW_SET_ERROR_MSG("ros message is null");
+    return -1;
+  }
+
+  CdrSerializationBuffer<false> buffer{nullptr, 0};
+  run(0, root_last_, buffer, static_cast<const uint8_t *>(ros_message));
+  buffer.roundup(4);
+
+  return static_cast<ssize_t>(buffer.get_serialized_size());
+}
+
+bool MessagePlan::serialize(const void * ros_message, void * dds_message, size_t size) const
+{
+  RMW_GURUMDDS_TRACEPOINT(serialize_begin, ros_message);
+  try {
+    CdrSerializationBuffer<true> buffer{static_cast<uint8_t *>(dds_message), size};
+    run(0, root_last_, buffer, static_cast<const uint8_t *>(ros_message));
+    buffer.roundup(4);
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to serialize ros message: %s", e.what());
+    return false;
+  }
+
+  RMW_GURUMDDS_TRACEPOINT(serialize_end, ros_message, size);
+  return true;
+}
+
+bool MessagePlan::serialize(
+  const void * ros_message,
+  CdrGrowableStorage & dds_message,
+  size_t * size) const
+{
+  RMW_GURUMDDS_TRACEPOINT(serialize_begin, ros_message);
+  try {
+    CdrSerializationBuffer<true> buffer{dds_message};
+    run(0, root_last_, buffer, static_cast<const uint8_t *>(ros_message));
+    buffer.roundup(4);
+    *size = buffer.get_serialized_size();
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to serialize ros message: %s", e.what());
+    return false;
+  }
+
+  RMW_GURUMDDS_TRACEPOINT(serialize_end, ros_message, *size);
+  return true;
+}
+
+bool MessagePlan::deserialize(
+  void * ros_message, void * dds_message, size_t size, DeserializationArena * arena) const
+{
+  if (is_compressed_payload(dds_message, size)) {
+    // Reused by the next compressed sample of the thread
+    static thread_local std::vector<uint8_t> decompressed;
+    decompressed.resize(get_decompressed_size(dds_message, size));
+    if (!decompress_payload(dds_message, size, decompressed.data(), decompressed.size())) {
+      // Error message already set
+      return false;
+    }
+    dds_message = decompressed.data();
+    size = decompressed.size();
+  }
+
+  RMW_GURUMDDS_TRACEPOINT(deserialize_begin, ros_message, size);
+  try {
+    CdrDeserializationBuffer buffer{static_cast<uint8_t *>(dds_message), size};
+    buffer.set_arena(arena);
+    run(0, root_last_, buffer, static_cast<uint8_t *>(ros_message));
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to deserialize dds message: %s", e.what());
+    return false;
+  }
+
+  RMW_GURUMDDS_TRACEPOINT(deserialize_end, ros_message);
+  return true;
+}
+
+template<bool SERIALIZE>
+void MessagePlan::run(
+  uint32_t first,
+  uint32_t last,
+  CdrSerializationBuffer<SERIALIZE> & buffer,
+  const uint8_t * input) const
+{
+  for (uint32_t i = first; i < last; i++) {
+    const MessagePlanOp & op = ops_[i];
+    if constexpr (SERIALIZE) {
+      op.serialize(*this, op, buffer, input);
+    } else {
+      op.get_size(*this, op, buffer, input);
+    }
+  }
+}
+
+template void MessagePlan::run<true>(
+  uint32_t, uint32_t, CdrSerializationBuffer<true> &, const uint8_t *) const;
+template void MessagePlan::run<false>(
+  uint32_t, uint32_t, CdrSerializationBuffer<false> &, const uint8_t *) const;
+
+void MessagePlan::run(
+  uint32_t first,
+  uint32_t last,
+  CdrDeserializationBuffer & buffer,
+  uint8_t * output) const
+{
+  for (uint32_t i = first; i < last; i++) {
+    const MessagePlanOp & op = ops_[i];
+    op.deserialize(*this, op, buffer, output);
+  }
+}
+
+template<typename MessageMembersT>
+bool MessagePlan::compile()
+{
+  auto members = static_cast<const MessageMembersT *>(type_support_->data);
+  if (members == nullptr) {
+    RMW_SET_ERROR_MSG("Members handle is null");
+    return false;
+  }
+
+  message_size_ = members->size_of_;
+
+  std::vector<std::pair<size_t, const MessageMembersT *>> pending;
+  if (!compile_struct(members, 0, pending)) {
+    return false;
+  }
+  root_last_ = static_cast<uint32_t>(ops_.size());
+
+  // Element types of struct arrays and sequences get their own op range, compiled once
+  std::map<const MessageMembersT *, std::pair<uint32_t, uint32_t>> ranges;
+  for (size_t i = 0; i < pending.size(); i++) {
+    const auto [index, element] = pending[i];
+    auto it = ranges.find(element);
+    if (it == ranges.end()) {
+      auto first = static_cast<uint32_t>(ops_.size());
+      if (!compile_struct(element, 0, pending)) {
+        return false;
+      }
+      it = ranges.emplace(element, std::make_pair(first, static_cast<uint32_t>(ops_.size()))).first;
+    }
+
+    ops_[index].first = it->second.first;
+    ops_[index].last = it->second.second;
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> lists{{0, root_last_}};
+  for (const auto & range : ranges) {
+    lists.push_back(range.second);
+  }
+  coalesce(std::move(lists));
+
+  MaxSerializedSize max_size;
+  add_max_serialized_size(members, max_size);
+  if (max_size.bounded) {
+    max_size.add(4, 0);
+    max_serialized_size_ = CDR_HEADER_SIZE + max_size.size;
+  }
+
+  return true;
+}
+
+void MessagePlan::coalesce(std::vector<std::pair<uint32_t, uint32_t>> lists)
+{
+  std::vector<MessagePlanOp> ops;
+  std::vector<size_t> runs;
+  std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t>> moved;
+  for (const auto & list : lists) {
+    auto first = static_cast<uint32_t>(ops.size());
+    for (uint32_t i = list.first; i < list.second; ) {
+      const MessagePlanOp & head = ops_[i];
+      uint32_t end = i + 1;
+      uint32_t run_end = head.offset + head.element_size * std::max<uint32_t>(head.array_size, 1);
+      uint32_t run_align = head.alignment;
+      if (head.alignment != 0 && head.offset % head.alignment == 0) {
+        // Extend over members that follow without padding and are naturally aligned
+        for (; end < list.second; end++) {
+          const MessagePlanOp & next = ops_[end];
+          if (next.alignment == 0 || next.offset != run_end || next.offset % next.alignment != 0) {
+            break;
+          }
+          run_end += next.element_size * std::max<uint32_t>(next.array_size, 1);
+          run_align = std::max(run_align, next.alignment);
+        }
+      }
+
+      if (end - i < 2) {
+        ops.push_back(head);
+        i++;
+        continue;
+      }
+
+      MessagePlanOp run{};
+      set_handlers<CopyRunOp>(run);
+      run.offset = head.offset;
+      run.element_size = run_end - head.offset;
+      run.alignment = run_align;
+      run.first = i;
+      run.last = end;
+      runs.push_back(ops.size());
+      ops.push_back(run);
+      i = end;
+    }
+    moved.emplace(list, std::make_pair(first, static_cast<uint32_t>(ops.size())));
+  }
+
+  // Struct arrays and sequences are the only other ops with an element range
+  for (auto & op : ops) {
+    if (op.alignment == 0 && op.last != 0) {
+      const auto & range = moved.at({op.first, op.last});
+      op.first = range.first;
+      op.last = range.second;
+    }
+  }
+
+  // Ops replaced by a run are kept after all lists for its fallback path
+  for (size_t index : runs) {
+    auto first = static_cast<uint32_t>(ops.size());
+    ops.insert(ops.end(), ops_.begin() + ops[index].first, ops_.begin() + ops[index].last);
+    ops[index].first = first;
+    ops[index].last = static_cast<uint32_t>(ops.size());
+  }
+
+  root_last_ = moved.at(lists.front()).second;
+  ops_ = std::move(ops);
+}
+
+template<typename MessageMembersT>
+bool MessagePlan::compile_struct(
+  const MessageMembersT * members,
+  uint32_t base_offset,
+  std::vector<std::pair<size_t, const MessageMembersT *>> & pending)
+{
+  using MessageMemberT = MessageMemberType<MessageMembersT>;
+  for (uint32_t i = 0; i < members->member_count_; i++) {
+    const MessageMemberT * member = members->members_ + i;
+    MessagePlanOp op{};
+    op.offset = base_offset + member->offset_;
+    op.array_size = static_cast<uint32_t>(member->array_size_);
+    op.member = member;
+
+    switch (member->type_id_) {
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOLEAN:
+        op.element_size = sizeof(bool);
+        if (!member->is_array_) {
+          set_handlers<BooleanOp>(op);
+        } else if (!is_sequence(member)) {
+          set_handlers<BooleanArrayOp>(op);
+        } else if constexpr (get_language_kind<MessageMemberT>() == LanguageKind::C) {
+          set_handlers<CBooleanSequenceOp>(op);
+        } else {
+          set_handlers<CxxBooleanSequenceOp>(op);
+        }
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_OCTET:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+        set_primitive_handlers<MessageMemberT, uint8_t>(op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_WCHAR:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+        set_primitive_handlers<MessageMemberT, uint16_t>(op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+        set_primitive_handlers<MessageMemberT, uint32_t>(op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_DOUBLE:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+        set_primitive_handlers<MessageMemberT, uint64_t>(op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+        set_string_handlers<MessageMemberT, rosidl_runtime_c__String, std::string>(op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+        set_string_handlers<MessageMemberT, rosidl_runtime_c__U16String, std::u16string>(
+          op, member);
+        break;
+      case rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+      {
+        if (member->members_ == nullptr || member->members_->data == nullptr) {
+          RMW_SET_ERROR_MSG("Members handle is null");
+          return false;
+        }
+
+        auto inner = static_cast<const MessageMembersT *>(member->members_->data);
+        if (!member->is_array_) {
+          // Nested structs are inlined at their offset
+          if (!compile_struct(inner, op.offset, pending)) {
+            return false;
+          }
+          continue;
+        }
+
+        op.element_size = static_cast<uint32_t>(inner->size_of_);
+        if (!is_sequence(member)) {
+          set_handlers<StructArrayOp>(op);
+        } else {
+          set_handlers<StructSequenceOp<MessageMemberT>>(op);
+        }
+        pending.emplace_back(ops_.size(), inner);
+        break;
+      }
+      default:
+        RMW_SET_ERROR_MSG("Unknown type");
+        return false;
+    }
+
+    ops_.push_back(op);
+  }
+
+  return true;
+}
+} // namespace rmw_gurumdds_cpp
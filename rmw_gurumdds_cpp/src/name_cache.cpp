@@ -0,0 +1,74 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "rmw_gurumdds_cpp/name_cache.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+const std::string &
+NameCache::mangle(const char * prefix, const char * name, std::string & storage)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  Table & table = tables_[prefix];
+  auto it = table.find(std::string_view{name});
+  if (it != table.end()) {
+    return it->second->value;
+  }
+
+  if (entries_.size() >= NAME_CACHE_MAX_ENTRIES) {
+    storage.assign(prefix).append(name);
+    return storage;
+  }
+
+  std::string mangled{prefix};
+  mangled.append(name);
+  return insert_unsafe(table, std::string{name}, std::move(mangled)).value;
+}
+
+const std::string &
+NameCache::demangle(
+  DemangleFunction demangle_fn,
+  const std::string & name,
+  std::string & storage)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  Table & table = tables_[reinterpret_cast<const void *>(demangle_fn)];
+  auto it = table.find(std::string_view{name});
+  if (it != table.end()) {
+    return it->second->value;
+  }
+
+  std::string demangled = demangle_fn(name);
+  if (entries_.size() >= NAME_CACHE_MAX_ENTRIES) {
+    storage = std::move(demangled);
+    return storage;
+  }
+
+  return insert_unsafe(table, std::string{name}, std::move(demangled)).value;
+}
+
+const NameCache::Entry &
+NameCache::insert_unsafe(Table & table, std::string && key, std::string && value)
+{
+  // deque::emplace_back does not move the existing entries the table refers to
+  const Entry & entry = entries_.emplace_back(Entry{std::move(key), std::move(value)});
+  table.emplace(std::string_view{entry.key}, &entry);
+  return entry;
+}
+} // namespace rmw_gurumdds_cpp
@@ -25,10 +25,18 @@ const char * const ros_service_response_prefix = "rr";
 const std::vector<std::string> ros_prefixes
   = {ros_topic_prefix, ros_service_requester_prefix, ros_service_response_prefix};
 
+bool
+has_prefix(const std::string & name, const std::string & prefix)
+{
+  return name.size() > prefix.size() &&
+         name.compare(0, prefix.size(), prefix) == 0 &&
+         name[prefix.size()] == '/';
+}
+
 std::string
 resolve_prefix(const std::string & name, const std::string & prefix)
 {
-  if (name.rfind(prefix + "/", 0) == 0) {
+  if (has_prefix(name, prefix)) {
     return name.substr(prefix.length());
   }
   return "";
@@ -38,7 +46,7 @@ std::string
 get_ros_prefix_if_exists(const std::string & topic_name)
 {
   for (const auto & prefix : ros_prefixes) {
-    if (topic_name.rfind(prefix, 0) == 0 && topic_name.at(prefix.length()) == '/') {
+    if (has_prefix(topic_name, prefix)) {
       return prefix;
     }
   }
@@ -49,7 +57,7 @@ std::string
 strip_ros_prefix_if_exists(const std::string & topic_name)
 {
   for (const auto & prefix : ros_prefixes) {
-    if (topic_name.rfind(prefix, 0) == 0 && topic_name.at(prefix.length()) == '/') {
+    if (has_prefix(topic_name, prefix)) {
       return topic_name.substr(prefix.length());
     }
   }
@@ -0,0 +1,241 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "rmw/error_handling.h"
+#include "rmw/network_flow_endpoint.h"
+
+#include "rmw_gurumdds_cpp/network_flow.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+static std::mutex participant_creation_mutex;
+
+#ifdef __linux__
+// Inodes of the sockets opened by the process
+static std::set<uint64_t>
+get_socket_inodes()
+{
+  std::set<uint64_t> inodes;
+  DIR * dir = opendir("/proc/self/fd");
+  if (dir == nullptr) {
+    return inodes;
+  }
+
+  char target[64];
+  for (struct dirent * entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+    const std::string path = std::string("/proc/self/fd/") + entry->d_name;
+    const ssize_t length = readlink(path.c_str(), target, sizeof(target) - 1);
+    if (length <= 0) {
+      continue;
+    }
+    target[length] = '\0';
+    unsigned long long inode = 0;
+    if (sscanf(target, "socket:[%llu]", &inode) == 1) {
+      inodes.insert(inode);
+    }
+  }
+  closedir(dir);
+  return inodes;
+}
+
+// Lines of /proc/net/udp and udp6 hold "sl local_address rem_address st ... uid timeout inode",
+// the address words in host byte order
+static void
+read_udp_sockets(
+  const char * path, bool ipv6, const std::set<uint64_t> & inodes,
+  std::vector<UdpSocketSnapshot::Socket> & sockets)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string slot, local, remote, state, queues, timer, retransmits, uid, timeout;
+    uint64_t inode = 0;
+    if (!(fields >> slot >> local >> remote >> state >> queues >> timer >> retransmits >> uid >>
+      timeout >> inode) || inodes.count(inode) == 0)
+    {
+      continue;
+    }
+
+    const size_t colon = local.find(':');
+    const size_t address_length = ipv6 ? 32 : 8;
+    if (colon != address_length) {
+      continue;
+    }
+
+    UdpSocketSnapshot::Socket socket{};
+    socket.ipv6 = ipv6;
+    socket.inode = inode;
+    socket.port = static_cast<uint16_t>(std::stoul(local.substr(colon + 1), nullptr, 16));
+    for (size_t word = 0; word < address_length / 8; word++) {
+      const uint32_t value =
+        static_cast<uint32_t>(std::stoul(local.substr(word * 8, 8), nullptr, 16));
+      std::memcpy(socket.address + word * 4, &value, sizeof(value));
+    }
+    sockets.push_back(socket);
+  }
+}
+
+static std::vector<UdpSocketSnapshot::Socket>
+get_udp_sockets()
+{
+  std::vector<UdpSocketSnapshot::Socket> sockets;
+  const std::set<uint64_t> inodes = get_socket_inodes();
+  read_udp_sockets("/proc/net/udp", false, inodes, sockets);
+  read_udp_sockets("/proc/net/udp6", true, inodes, sockets);
+  return sockets;
+}
+
+// Addresses of the up interfaces of a family, the loopback ones only if localhost_only
+static std::vector<std::string>
+get_interface_addresses(bool ipv6, bool localhost_only)
+{
+  std::vector<std::string> addresses;
+  struct ifaddrs * interfaces = nullptr;
+  if (getifaddrs(&interfaces) != 0) {
+    return addresses;
+  }
+
+  char buffer[INET6_ADDRSTRLEN];
+  for (struct ifaddrs * it = interfaces; it != nullptr; it = it->ifa_next) {
+    const int family = ipv6 ? AF_INET6 : AF_INET;
+    if (it->ifa_addr == nullptr || it->ifa_addr->sa_family != family ||
+      (it->ifa_flags & IFF_UP) == 0 || ((it->ifa_flags & IFF_LOOPBACK) != 0) != localhost_only)
+    {
+      continue;
+    }
+    const void * address = ipv6 ?
+      static_cast<const void *>(&reinterpret_cast<sockaddr_in6 *>(it->ifa_addr)->sin6_addr) :
+      static_cast<const void *>(&reinterpret_cast<sockaddr_in *>(it->ifa_addr)->sin_addr);
+    if (inet_ntop(family, address, buffer, sizeof(buffer)) != nullptr) {
+      addresses.push_back(buffer);
+    }
+  }
+  freeifaddrs(interfaces);
+  return addresses;
+}
+#endif
+
+UdpSocketSnapshot::UdpSocketSnapshot()
+: lock_(participant_creation_mutex)
+{
+#ifdef __linux__
+  sockets_ = get_udp_sockets();
+#endif
+}
+
+std::vector<NetworkFlowLocator>
+UdpSocketSnapshot::get_user_locators(uint32_t domain_id, bool localhost_only) const
+{
+  std::vector<NetworkFlowLocator> locators;
+#ifdef __linux__
+  const uint32_t first_port =
+    RTPS_PORT_BASE + RTPS_DOMAIN_ID_GAIN * domain_id + RTPS_USER_UNICAST_OFFSET;
+  for (const Socket & socket : get_udp_sockets()) {
+    bool known = false;
+    for (const Socket & old_socket : sockets_) {
+      known = known || old_socket.inode == socket.inode;
+    }
+    // The metatraffic sockets of the participant and the sockets of other domains are skipped
+    if (known || socket.port < first_port ||
+      (socket.port - first_port) % RTPS_PARTICIPANT_ID_GAIN != 0 ||
+      socket.port >= first_port + RTPS_DOMAIN_ID_GAIN - RTPS_USER_UNICAST_OFFSET)
+    {
+      continue;
+    }
+
+    static const uint8_t any[16] = { };
+    std::vector<std::string> addresses;
+    if (std::memcmp(socket.address, any, socket.ipv6 ? 16 : 4) == 0) {
+      addresses = get_interface_addresses(socket.ipv6, localhost_only);
+      if (addresses.empty() && !localhost_only) {
+        addresses = get_interface_addresses(socket.ipv6, true);
+      }
+    } else {
+      char buffer[INET6_ADDRSTRLEN];
+      if (inet_ntop(
+          socket.ipv6 ? AF_INET6 : AF_INET, socket.address, buffer, sizeof(buffer)) != nullptr)
+      {
+        addresses.push_back(buffer);
+      }
+    }
+    for (const std::string & address : addresses) {
+      locators.push_back({socket.ipv6, address, socket.port});
+    }
+  }
+#else
+  (void)domain_id;
+  (void)localhost_only;
+#endif
+  return locators;
+}
+
+rmw_ret_t
+fill_network_flow_endpoints(
+  const std::vector<NetworkFlowLocator> & locators,
+  uint8_t dscp,
+  rcutils_allocator_t * allocator,
+  rmw_network_flow_endpoint_array_t * network_flow_endpoint_array)
+{
+  if (locators.empty()) {
+    RMW_SET_ERROR_MSG("the locators of the participant are unknown");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  rmw_ret_t ret = rmw_network_flow_endpoint_array_init(
+    network_flow_endpoint_array, locators.size(), allocator);
+  if (ret != RMW_RET_OK) {
+    // Error message already set
+    return ret;
+  }
+
+  for (size_t i = 0; i < locators.size(); i++) {
+    rmw_network_flow_endpoint_t * endpoint = &network_flow_endpoint_array->network_flow_endpoint[i];
+    endpoint->transport_protocol = RMW_TRANSPORT_PROTOCOL_UDP;
+    endpoint->internet_protocol =
+      locators[i].ipv6 ? RMW_INTERNET_PROTOCOL_IPV6 : RMW_INTERNET_PROTOCOL_IPV4;
+    endpoint->transport_port = locators[i].port;
+    endpoint->flow_label = 0;
+    endpoint->dscp = dscp;
+    ret = rmw_network_flow_endpoint_set_internet_address(
+      endpoint, locators[i].address.c_str(), locators[i].address.size());
+    if (ret != RMW_RET_OK) {
+      (void)rmw_network_flow_endpoint_array_fini(network_flow_endpoint_array);
+      return ret;
+    }
+  }
+
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
@@ -63,6 +63,14 @@ dds_time_to_i64(const dds_Time_t & t) {
           + static_cast<int64_t>(t.nanosec));
 }
 
+dds_Time_t
+i64_to_dds_time(int64_t t) {
+  dds_Time_t time;
+  time.sec = static_cast<int32_t>(t / 1000000000LL);
+  time.nanosec = static_cast<uint32_t>(t % 1000000000LL);
+  return time;
+}
+
 template<typename dds_EntityQos>
 bool
 set_entity_qos_from_profile_generic(
@@ -208,6 +216,25 @@ bool get_datareader_qos(
   return true;
 }
 
+bool
+append_user_data(dds_UserDataQosPolicy * user_data, const char * key, const char * value)
+{
+  // The user data is a NUL terminated "key=value;" list
+  const void * end = std::memchr(user_data->value, '\0', sizeof(user_data->value));
+  const size_t length = end == nullptr ? sizeof(user_data->value) :
+    static_cast<size_t>(static_cast<const uint8_t *>(end) -
+    reinterpret_cast<const uint8_t *>(user_data->value));
+  const std::string item = std::string{key} + "=" + value + ";";
+  if (length + item.size() >= sizeof(user_data->value)) {
+    return false;
+  }
+
+  std::memcpy(reinterpret_cast<uint8_t *>(user_data->value) + length, item.data(), item.size());
+  reinterpret_cast<uint8_t *>(user_data->value)[length + item.size()] = '\0';
+  user_data->size = static_cast<uint32_t>(length + item.size());
+  return true;
+}
+
 rmw_qos_history_policy_t
 convert_history(const dds_HistoryQosPolicy * const policy)
 {
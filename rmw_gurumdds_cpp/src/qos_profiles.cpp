@@ -0,0 +1,458 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/namespace_prefix.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+static std::string trim(const std::string & s)
+{
+  const char * spaces = " \t\r";
+  size_t first = s.find_first_not_of(spaces);
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  size_t last = s.find_last_not_of(spaces);
+  return s.substr(first, last - first + 1);
+}
+
+// Matches `*` to any run of characters and `?` to any single one
+static bool match_pattern(const char * pattern, const char * name)
+{
+  const char * star = nullptr;
+  const char * resume = nullptr;
+  while (*name != '\0') {
+    if (*pattern == '*') {
+      star = pattern++;
+      resume = name;
+    } else if (*pattern == '?' || *pattern == *name) {
+      pattern++;
+      name++;
+    } else if (star != nullptr) {
+      pattern = star + 1;
+      name = ++resume;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '*') {
+    pattern++;
+  }
+  return *pattern == '\0';
+}
+
+static dds_Duration_t us_to_duration(int64_t us)
+{
+  dds_Duration_t duration;
+  duration.sec = static_cast<int32_t>(us / 1000000);
+  duration.nanosec = static_cast<uint32_t>((us % 1000000) * 1000);
+  return duration;
+}
+
+const char * get_locator_policy_name(int policy)
+{
+  switch (policy) {
+    case LOCATOR_POLICY_UNICAST:
+      return "unicast";
+    case LOCATOR_POLICY_MULTICAST:
+      return "multicast";
+    case LOCATOR_POLICY_AUTO:
+      return "auto";
+    default:
+      return "default";
+  }
+}
+
+bool QosProfiles::load(const std::string & path)
+{
+  static const std::pair<const char *, Key> keys[] = {
+    {"history.depth", Key::HISTORY_DEPTH},
+    {"resource_limits.max_samples", Key::MAX_SAMPLES},
+    {"resource_limits.max_instances", Key::MAX_INSTANCES},
+    {"resource_limits.max_samples_per_instance", Key::MAX_SAMPLES_PER_INSTANCE},
+    {"latency_budget.duration_us", Key::LATENCY_BUDGET_US},
+    {"reliability.max_blocking_time_us", Key::MAX_BLOCKING_TIME_US},
+    {"transport_priority.value", Key::TRANSPORT_PRIORITY},
+    {"time_based_filter.minimum_separation_us", Key::MINIMUM_SEPARATION_US},
+    {"async_publish.queue_depth", Key::ASYNC_QUEUE_DEPTH},
+    {"async_publish.block_when_full", Key::ASYNC_BLOCK_WHEN_FULL},
+    {"flow_controller.priority", Key::FLOW_PRIORITY},
+    {"flow_controller.bytes_per_second", Key::FLOW_BYTES_PER_SECOND},
+    {"flow_controller.burst_bytes", Key::FLOW_BURST_BYTES},
+    {"compression.threshold_bytes", Key::COMPRESSION_THRESHOLD},
+    {"compression.acceleration", Key::COMPRESSION_ACCELERATION},
+    {"latency_stats.enabled", Key::LATENCY_STATS},
+    {"sequence_gaps.message_lost", Key::SEQUENCE_GAP_LOST},
+    {"locators.multicast", Key::LOCATOR_MULTICAST},
+    {"locators.multicast_min_readers", Key::LOCATOR_MULTICAST_MIN_READERS},
+  };
+
+  std::ifstream file{path};
+  if (!file) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("failed to open qos profile file '%s'", path.c_str());
+    return false;
+  }
+
+  profiles_.clear();
+  participant_properties_.clear();
+
+  // Lines before the first section are rejected
+  bool in_participant = false;
+  Profile * profile = nullptr;
+  std::string line;
+  for (size_t line_number = 1; std::getline(file, line); line_number++) {
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+
+    if (line.front() == '[') {
+      if (line.back() != ']') {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "%s:%zu: unterminated section header", path.c_str(), line_number);
+        return false;
+      }
+      std::string header = trim(line.substr(1, line.size() - 2));
+      size_t space = header.find_first_of(" \t");
+      std::string kind = header.substr(0, space);
+      std::string pattern = space == std::string::npos ? "" : trim(header.substr(space));
+
+      in_participant = false;
+      profile = nullptr;
+      if (kind == "participant" && pattern.empty()) {
+        in_participant = true;
+      } else if ((kind == "topic" || kind == "writer" || kind == "reader") && !pattern.empty()) {
+        profiles_.push_back(Profile{pattern, kind != "reader", kind != "writer", {}});
+        profile = &profiles_.back();
+      } else {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "%s:%zu: unknown section '%s'", path.c_str(), line_number, header.c_str());
+        return false;
+      }
+      continue;
+    }
+
+    size_t equals = line.find('=');
+    if (equals == std::string::npos || (!in_participant && profile == nullptr)) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "%s:%zu: expected 'key = value' in a section", path.c_str(), line_number);
+      return false;
+    }
+    std::string key = trim(line.substr(0, equals));
+    std::string value = trim(line.substr(equals + 1));
+
+    if (in_participant) {
+      if (!add_participant_property(key, value)) {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "%s:%zu: invalid setting '%s = %s'", path.c_str(), line_number, key.c_str(),
+          value.c_str());
+        return false;
+      }
+      continue;
+    }
+
+    const Key * found = nullptr;
+    for (const auto & entry : keys) {
+      if (key == entry.first) {
+        found = &entry.second;
+      }
+    }
+    char * end = nullptr;
+    errno = 0;
+    long long number = std::strtoll(value.c_str(), &end, 10);
+    if (found == nullptr || value.empty() || *end != '\0' || errno != 0 || number < 0) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "%s:%zu: invalid setting '%s = %s'", path.c_str(), line_number, key.c_str(),
+        value.c_str());
+      return false;
+    }
+    const bool locators =
+      *found == Key::LOCATOR_MULTICAST || *found == Key::LOCATOR_MULTICAST_MIN_READERS;
+    if (locators && !(profile->writers && profile->readers)) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "%s:%zu: '%s' is only valid in a [topic] section", path.c_str(), line_number,
+        key.c_str());
+      return false;
+    }
+    if ((*found == Key::LOCATOR_MULTICAST && number > 1) ||
+      (*found == Key::FLOW_PRIORITY && number >= FLOW_PRIORITY_LANES))
+    {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "%s:%zu: invalid setting '%s = %s'", path.c_str(), line_number, key.c_str(),
+        value.c_str());
+      return false;
+    }
+    profile->settings.emplace_back(*found, static_cast<int64_t>(number));
+  }
+
+  return true;
+}
+
+bool QosProfiles::add_participant_property(const std::string & key, const std::string & value)
+{
+  static const struct
+  {
+    const char * key;
+    const char * property;
+    long long min;
+    long long max;
+  } checked[] = {
+    {"fragmentation.fragment_size", RTPS_FRAGMENT_SIZE_PROPERTY,
+      RTPS_FRAGMENT_SIZE_MIN, RTPS_FRAGMENT_SIZE_MAX},
+    {"flow_control.send_window", RTPS_SEND_WINDOW_PROPERTY, 1, INT32_MAX},
+    {"flow_control.bytes_per_second", RTPS_BANDWIDTH_LIMIT_PROPERTY, 0, INT64_MAX},
+    {"flow_control.nack_response_delay_us", RTPS_NACK_RESPONSE_DELAY_PROPERTY, 0, INT32_MAX},
+  };
+
+  for (const auto & entry : checked) {
+    if (key != entry.key) {
+      continue;
+    }
+    char * end = nullptr;
+    errno = 0;
+    long long number = std::strtoll(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno != 0 || number < entry.min || number > entry.max) {
+      return false;
+    }
+    participant_properties_.emplace_back(entry.property, value);
+    return true;
+  }
+
+  // Other properties are passed as they are, the ones GurumDDS does not support are ignored
+  participant_properties_.emplace_back(key, value);
+  return true;
+}
+
+bool QosProfiles::empty() const
+{
+  return profiles_.empty() && participant_properties_.empty();
+}
+
+template<typename EntityQosT>
+void QosProfiles::apply_common(const Profile & profile, EntityQosT & qos)
+{
+  for (const auto & setting : profile.settings) {
+    const int64_t value = setting.second;
+    switch (setting.first) {
+      case Key::HISTORY_DEPTH:
+        // A KEEP_ALL history has no depth
+        if (qos.history.kind == dds_KEEP_LAST_HISTORY_QOS) {
+          qos.history.depth = static_cast<int32_t>(value);
+        }
+        break;
+      case Key::MAX_SAMPLES:
+        qos.resource_limits.max_samples = static_cast<int32_t>(value);
+        break;
+      case Key::MAX_INSTANCES:
+        qos.resource_limits.max_instances = static_cast<int32_t>(value);
+        break;
+      case Key::MAX_SAMPLES_PER_INSTANCE:
+        qos.resource_limits.max_samples_per_instance = static_cast<int32_t>(value);
+        break;
+      case Key::LATENCY_BUDGET_US:
+        qos.latency_budget.duration = us_to_duration(value);
+        break;
+      default:
+        // Writer policies and the settings got by the caller, such as async publishing
+        break;
+    }
+  }
+}
+
+void QosProfiles::apply(const char * topic_name, dds_DataWriterQos & qos) const
+{
+  for (const Profile & profile : profiles_) {
+    if (!profile.writers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    apply_common(profile, qos);
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::MAX_BLOCKING_TIME_US) {
+        qos.reliability.max_blocking_time = us_to_duration(setting.second);
+      } else if (setting.first == Key::TRANSPORT_PRIORITY) {
+        qos.transport_priority.value = static_cast<int32_t>(setting.second);
+      }
+    }
+  }
+}
+
+void QosProfiles::apply(const char * topic_name, dds_DataReaderQos & qos) const
+{
+  for (const Profile & profile : profiles_) {
+    if (!profile.readers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    apply_common(profile, qos);
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::MINIMUM_SEPARATION_US) {
+        qos.time_based_filter.minimum_separation = us_to_duration(setting.second);
+      }
+    }
+  }
+}
+
+AsyncPublishSettings QosProfiles::get_async_publish_settings(const char * topic_name) const
+{
+  AsyncPublishSettings settings;
+  for (const Profile & profile : profiles_) {
+    if (!profile.writers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::ASYNC_QUEUE_DEPTH) {
+        settings.queue_depth = static_cast<size_t>(setting.second);
+      } else if (setting.first == Key::ASYNC_BLOCK_WHEN_FULL) {
+        settings.block_when_full = setting.second != 0;
+      } else if (setting.first == Key::FLOW_PRIORITY) {
+        settings.priority = static_cast<int>(setting.second);
+      } else if (setting.first == Key::FLOW_BYTES_PER_SECOND) {
+        settings.bytes_per_second = static_cast<uint64_t>(setting.second);
+      } else if (setting.first == Key::FLOW_BURST_BYTES) {
+        settings.burst_bytes = static_cast<size_t>(setting.second);
+      }
+    }
+  }
+
+  // A flow controller needs the sender thread
+  if (settings.queue_depth == 0 && (settings.priority > 0 || settings.bytes_per_second > 0)) {
+    settings.queue_depth = FLOW_CONTROLLER_QUEUE_DEPTH;
+  }
+  if (settings.bytes_per_second > 0 && settings.burst_bytes == 0) {
+    settings.burst_bytes = static_cast<size_t>(
+      std::max<uint64_t>(settings.bytes_per_second / (1000000 / FLOW_CONTROLLER_BURST_US), 1));
+  }
+  return settings;
+}
+
+CompressionSettings QosProfiles::get_compression_settings(const char * topic_name) const
+{
+  CompressionSettings settings;
+  for (const Profile & profile : profiles_) {
+    if (!profile.writers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::COMPRESSION_THRESHOLD) {
+        settings.threshold_bytes = static_cast<size_t>(setting.second);
+      } else if (setting.first == Key::COMPRESSION_ACCELERATION) {
+        // LZ4 clamps the acceleration to 65537
+        settings.acceleration = static_cast<int>(std::min<int64_t>(setting.second, 65537));
+        settings.acceleration = std::max(settings.acceleration, 1);
+      }
+    }
+  }
+  return settings;
+}
+
+bool QosProfiles::is_latency_stats_enabled(const char * topic_name) const
+{
+  bool enabled = false;
+  for (const Profile & profile : profiles_) {
+    if (!profile.readers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::LATENCY_STATS) {
+        enabled = setting.second != 0;
+      }
+    }
+  }
+  return enabled;
+}
+
+bool QosProfiles::is_sequence_gap_lost_enabled(const char * topic_name) const
+{
+  bool enabled = false;
+  for (const Profile & profile : profiles_) {
+    if (!profile.readers || !match_pattern(profile.pattern.c_str(), topic_name)) {
+      continue;
+    }
+    for (const auto & setting : profile.settings) {
+      if (setting.first == Key::SEQUENCE_GAP_LOST) {
+        enabled = setting.second != 0;
+      }
+    }
+  }
+  return enabled;
+}
+
+LocatorSettings
+QosProfiles::get_locator_settings(const Profile & profile, LocatorSettings settings)
+{
+  for (const auto & setting : profile.settings) {
+    if (setting.first == Key::LOCATOR_MULTICAST) {
+      settings.policy = setting.second != 0 ? LOCATOR_POLICY_MULTICAST : LOCATOR_POLICY_UNICAST;
+      settings.multicast_min_readers = 0;
+    } else if (setting.first == Key::LOCATOR_MULTICAST_MIN_READERS) {
+      // A single reader is as many as multicast ever reaches
+      if (setting.second > 1) {
+        settings.policy = LOCATOR_POLICY_AUTO;
+        settings.multicast_min_readers = static_cast<size_t>(setting.second);
+      } else {
+        settings.policy = LOCATOR_POLICY_MULTICAST;
+        settings.multicast_min_readers = 0;
+      }
+    }
+  }
+  return settings;
+}
+
+LocatorSettings QosProfiles::get_locator_settings(const char * topic_name) const
+{
+  LocatorSettings settings;
+  for (const Profile & profile : profiles_) {
+    if (match_pattern(profile.pattern.c_str(), topic_name)) {
+      settings = get_locator_settings(profile, settings);
+    }
+  }
+  return settings;
+}
+
+std::string QosProfiles::get_locator_policy_property() const
+{
+  std::string value;
+  for (const Profile & profile : profiles_) {
+    const LocatorSettings settings = get_locator_settings(profile, LocatorSettings{});
+    if (settings.policy == LOCATOR_POLICY_DEFAULT) {
+      continue;
+    }
+    if (!value.empty()) {
+      value += ',';
+    }
+    // Patterns match ROS topic names, GurumDDS sees the names with the ROS topic prefix
+    value += std::string(ros_topic_prefix) + profile.pattern + '=';
+    value += get_locator_policy_name(settings.policy);
+    if (settings.policy == LOCATOR_POLICY_AUTO) {
+      value += ':' + std::to_string(settings.multicast_min_readers);
+    }
+  }
+  return value;
+}
+
+const std::vector<std::pair<std::string, std::string>> &
+QosProfiles::get_participant_properties() const
+{
+  return participant_properties_;
+}
+} // namespace rmw_gurumdds_cpp
@@ -0,0 +1,633 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/demangle.hpp"
+#include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/raw_capture.hpp"
+#include "rmw_gurumdds_cpp/type_support_common.hpp"
+#include "rmw_gurumdds_cpp/type_support_service.hpp"
+
+// Samples taken from the reader at once
+#define RAW_CAPTURE_TAKE_COUNT 32
+
+namespace rmw_gurumdds_cpp
+{
+static uint64_t align_record(uint64_t size)
+{
+  return (size + 7) & ~static_cast<uint64_t>(7);
+}
+
+#if !defined(_WIN32)
+// The header fields are shared with the readers of the file
+static uint64_t load_field(const uint64_t & field)
+{
+  return __atomic_load_n(&field, __ATOMIC_ACQUIRE);
+}
+
+static void store_field(uint64_t & field, uint64_t value)
+{
+  __atomic_store_n(&field, value, __ATOMIC_RELEASE);
+}
+
+RawCaptureWriter::~RawCaptureWriter()
+{
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+bool RawCaptureWriter::open(
+  const char * path, size_t file_size, const char * topic_name, const char * type_name)
+{
+  if (file_size == 0) {
+    file_size = RAW_CAPTURE_MIN_SIZE;
+  }
+  if (file_size < RAW_CAPTURE_MIN_SIZE) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "capture file size must be at least %d bytes", RAW_CAPTURE_MIN_SIZE);
+    return false;
+  }
+  file_size = static_cast<size_t>(align_record(file_size));
+
+  const uint64_t index_capacity = file_size / (1024 * 1024) * RAW_CAPTURE_INDEX_ENTRIES_PER_MIB;
+  const uint64_t index_offset = align_record(sizeof(RawCaptureFileHeader));
+  const uint64_t records_offset =
+    align_record(index_offset + index_capacity * sizeof(RawCaptureIndexEntry));
+
+  int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to create capture file '%s': %s", path, strerror(errno));
+    return false;
+  }
+  // The file is extended with zeros, so every header field starts at 0
+  if (ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to size capture file '%s': %s", path, strerror(errno));
+    close(fd);
+    return false;
+  }
+  void * data = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to map capture file '%s': %s", path, strerror(errno));
+    return false;
+  }
+
+  data_ = static_cast<uint8_t *>(data);
+  size_ = file_size;
+  header_ = reinterpret_cast<RawCaptureFileHeader *>(data_);
+  index_ = reinterpret_cast<RawCaptureIndexEntry *>(data_ + index_offset);
+  records_ = data_ + records_offset;
+
+  header_->version = RAW_CAPTURE_VERSION;
+  header_->index_interval = RAW_CAPTURE_INDEX_INTERVAL;
+  header_->index_offset = index_offset;
+  header_->index_capacity = index_capacity;
+  header_->records_offset = records_offset;
+  header_->records_size = file_size - records_offset;
+  std::strncpy(header_->topic_name, topic_name, RAW_CAPTURE_NAME_SIZE - 1);
+  std::strncpy(header_->type_name, type_name, RAW_CAPTURE_NAME_SIZE - 1);
+  store_field(header_->magic, RAW_CAPTURE_MAGIC);
+  return true;
+}
+
+RawCaptureRecordHeader * RawCaptureWriter::get_record(uint64_t offset) const
+{
+  return reinterpret_cast<RawCaptureRecordHeader *>(records_ + offset);
+}
+
+uint64_t RawCaptureWriter::resolve(uint64_t offset) const
+{
+  if (header_->records_size - offset < sizeof(RawCaptureRecordHeader) ||
+    get_record(offset)->size == RAW_CAPTURE_WRAP)
+  {
+    return 0;
+  }
+  return offset;
+}
+
+void RawCaptureWriter::evict_oldest()
+{
+  const RawCaptureRecordHeader * oldest = get_record(header_->oldest_offset);
+  const uint64_t next =
+    header_->oldest_offset + sizeof(RawCaptureRecordHeader) + align_record(oldest->size);
+  // Readers check oldest_record before they trust oldest_offset
+  store_field(header_->oldest_record, header_->oldest_record + 1);
+  store_field(header_->oldest_offset, resolve(next));
+  header_->overwritten_count++;
+}
+
+void RawCaptureWriter::append(
+  const void * payload, uint32_t size, const RawCaptureRecordHeader & header)
+{
+  const uint64_t records_size = header_->records_size;
+  const uint64_t need = sizeof(RawCaptureRecordHeader) + align_record(size);
+  if (need > records_size) {
+    header_->dropped_count++;
+    return;
+  }
+
+  // Records are contiguous, the end of the ring is skipped if the record does not fit there
+  uint64_t write = header_->write_offset;
+  const auto wrap = [this, &write, records_size]() {
+      if (write < records_size) {
+        get_record(write)->size = RAW_CAPTURE_WRAP;
+      }
+      write = 0;
+    };
+  for (;;) {
+    if (header_->oldest_record == header_->record_count) {
+      if (records_size - write < need) {
+        wrap();
+      }
+      store_field(header_->oldest_offset, write);
+      break;
+    }
+    const uint64_t oldest = header_->oldest_offset;
+    if (oldest < write) {
+      if (records_size - write >= need) {
+        break;
+      }
+      wrap();
+    } else if (oldest - write >= need) {
+      break;
+    } else {
+      evict_oldest();
+    }
+  }
+
+  const uint64_t record = header_->record_count;
+  RawCaptureRecordHeader * target = get_record(write);
+  *target = header;
+  target->size = size;
+  target->record = record;
+  std::memcpy(target + 1, payload, size);
+
+  if (record % RAW_CAPTURE_INDEX_INTERVAL == 0 && header_->index_capacity > 0) {
+    const uint64_t entry = record / RAW_CAPTURE_INDEX_INTERVAL;
+    index_[entry % header_->index_capacity] =
+      RawCaptureIndexEntry{record, write, header.reception_timestamp};
+    store_field(header_->index_count, entry + 1);
+  }
+
+  store_field(header_->write_offset, write + need);
+  store_field(header_->record_count, record + 1);
+}
+
+void RawCaptureWriter::sync()
+{
+  msync(data_, size_, MS_SYNC);
+}
+
+void RawCaptureWriter::get_status(RawCaptureStatus & status) const
+{
+  status.captured_count = header_->record_count;
+  status.overwritten_count = header_->overwritten_count;
+  status.dropped_count = header_->dropped_count;
+}
+
+RawCaptureReader::~RawCaptureReader()
+{
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+bool RawCaptureReader::open(const char * path)
+{
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to open capture file '%s': %s", path, strerror(errno));
+    return false;
+  }
+  struct stat file_stat;
+  void * data = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 &&
+    static_cast<size_t>(file_stat.st_size) >= sizeof(RawCaptureFileHeader))
+  {
+    data = mmap(
+      nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("failed to map capture file '%s'", path);
+    return false;
+  }
+
+  const auto header = static_cast<const RawCaptureFileHeader *>(data);
+  const size_t size = static_cast<size_t>(file_stat.st_size);
+  if (load_field(header->magic) != RAW_CAPTURE_MAGIC ||
+    header->version != RAW_CAPTURE_VERSION ||
+    header->index_interval == 0 ||
+    header->index_offset + header->index_capacity * sizeof(RawCaptureIndexEntry) >
+    header->records_offset ||
+    header->records_offset + header->records_size > size)
+  {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("'%s' is not a capture file", path);
+    munmap(data, size);
+    return false;
+  }
+
+  data_ = static_cast<uint8_t *>(data);
+  size_ = size;
+  header_ = header;
+  record_ = load_field(header_->oldest_record);
+  offset_ = load_field(header_->oldest_offset);
+  return true;
+}
+
+const RawCaptureFileHeader * RawCaptureReader::get_header() const
+{
+  return header_;
+}
+
+const RawCaptureRecordHeader * RawCaptureReader::get_record(uint64_t offset) const
+{
+  return reinterpret_cast<const RawCaptureRecordHeader *>(
+    data_ + header_->records_offset + offset);
+}
+
+uint64_t RawCaptureReader::resolve(uint64_t offset) const
+{
+  if (header_->records_size - offset < sizeof(RawCaptureRecordHeader) ||
+    get_record(offset)->size == RAW_CAPTURE_WRAP)
+  {
+    return 0;
+  }
+  return offset;
+}
+
+void RawCaptureReader::seek(int64_t reception_timestamp)
+{
+  record_ = load_field(header_->oldest_record);
+  offset_ = load_field(header_->oldest_offset);
+
+  // Entries that were not overwritten in the index and describe records still in the ring
+  const uint64_t interval = header_->index_interval;
+  const uint64_t count = load_field(header_->index_count);
+  uint64_t first = (record_ + interval - 1) / interval;
+  if (count > header_->index_capacity) {
+    first = std::max(first, count - header_->index_capacity);
+  }
+  const auto index = reinterpret_cast<const RawCaptureIndexEntry *>(
+    data_ + header_->index_offset);
+
+  // Last entry received before the timestamp, the scan starts there
+  uint64_t low = first;
+  uint64_t high = count;
+  while (low < high) {
+    const uint64_t middle = low + (high - low) / 2;
+    if (index[middle % header_->index_capacity].reception_timestamp < reception_timestamp) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low > first) {
+    const RawCaptureIndexEntry & entry = index[(low - 1) % header_->index_capacity];
+    if (entry.record == (low - 1) * interval && entry.record >= record_) {
+      record_ = entry.record;
+      offset_ = entry.offset;
+    }
+  }
+
+  RawCaptureRecord record;
+  for (;;) {
+    const uint64_t record_number = record_;
+    const uint64_t offset = offset_;
+    if (!next(record)) {
+      break;
+    }
+    if (record.header->reception_timestamp >= reception_timestamp) {
+      record_ = record_number;
+      offset_ = offset;
+      break;
+    }
+  }
+}
+
+bool RawCaptureReader::next(RawCaptureRecord & record)
+{
+  if (record_ >= load_field(header_->record_count)) {
+    return false;
+  }
+  // Records overwritten before the reader reached them are skipped
+  const uint64_t oldest = load_field(header_->oldest_record);
+  if (record_ < oldest) {
+    record_ = oldest;
+    offset_ = load_field(header_->oldest_offset);
+  }
+
+  offset_ = resolve(offset_);
+  const RawCaptureRecordHeader * header = get_record(offset_);
+  if (header->record != record_ ||
+    header->size > header_->records_size - offset_ - sizeof(RawCaptureRecordHeader))
+  {
+    return false;
+  }
+
+  record.header = header;
+  record.payload = reinterpret_cast<const uint8_t *>(header + 1);
+  offset_ += sizeof(RawCaptureRecordHeader) + align_record(header->size);
+  record_++;
+  return true;
+}
+#else
+RawCaptureWriter::~RawCaptureWriter() = default;
+
+bool RawCaptureWriter::open(const char *, size_t, const char *, const char *)
+{
+  RMW_SET_ERROR_MSG("raw capture is not supported on this platform");
+  return false;
+}
+
+void RawCaptureWriter::append(const void *, uint32_t, const RawCaptureRecordHeader &)
+{
+}
+
+void RawCaptureWriter::sync()
+{
+}
+
+void RawCaptureWriter::get_status(RawCaptureStatus & status) const
+{
+  status = RawCaptureStatus{};
+}
+
+RawCaptureReader::~RawCaptureReader() = default;
+
+bool RawCaptureReader::open(const char *)
+{
+  RMW_SET_ERROR_MSG("raw capture is not supported on this platform");
+  return false;
+}
+
+const RawCaptureFileHeader * RawCaptureReader::get_header() const
+{
+  return header_;
+}
+
+void RawCaptureReader::seek(int64_t)
+{
+}
+
+bool RawCaptureReader::next(RawCaptureRecord &)
+{
+  return false;
+}
+#endif
+
+static int64_t time_to_ns(const dds_Time_t & time)
+{
+  return time.sec * static_cast<int64_t>(1000000000) + time.nanosec;
+}
+
+void capture_samples(SubscriberInfo * subscriber_info)
+{
+  std::lock_guard<std::mutex> guard{subscriber_info->mutex_capture};
+  RawCaptureWriter * capture = subscriber_info->capture.get();
+  if (capture == nullptr) {
+    return;
+  }
+
+  // Samples handed over by the publishers of the context come before the ones of the reader
+  LocalSample local_sample;
+  while (subscriber_info->pop_local_sample(local_sample)) {
+    RawCaptureRecordHeader header{};
+    header.source_timestamp = local_sample.source_timestamp;
+    header.reception_timestamp = local_sample.received_timestamp;
+    header.sequence_number = local_sample.sequence_number;
+    std::memcpy(
+      header.writer_gid, local_sample.publisher_gid.data,
+      std::min(sizeof(local_sample.publisher_gid.data), sizeof(header.writer_gid)));
+    capture->append(local_sample.buffer->data(), static_cast<uint32_t>(local_sample.size), header);
+    subscriber_info->on_local_sequence_number(
+      local_sample.publisher_gid, local_sample.sequence_number);
+  }
+
+  dds_DataReader * topic_reader = subscriber_info->topic_reader;
+  uint32_t taken = RAW_CAPTURE_TAKE_COUNT;
+  while (taken == RAW_CAPTURE_TAKE_COUNT) {
+    SampleSequences loan{};
+    if (!subscriber_info->sample_pool.acquire(RAW_CAPTURE_TAKE_COUNT, loan)) {
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "failed to create sample sequences of the capture");
+      break;
+    }
+
+    const uint64_t take_start_ns = stats_time_ns();
+    dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+      topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes,
+      RAW_CAPTURE_TAKE_COUNT, dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+    const uint64_t take_ns = stats_time_ns() - take_start_ns;
+    taken = ret == dds_RETCODE_OK ? dds_SampleInfoSeq_length(loan.info_seq) : 0;
+
+    const uint64_t append_start_ns = stats_time_ns();
+    size_t count = 0;
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < taken; i++) {
+      auto sample_info =
+        reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(loan.info_seq, i));
+      void * sample = dds_DataSeq_get(loan.data_seq, i);
+      if (!sample_info->info.valid_data || sample == nullptr) {
+        continue;
+      }
+
+      const uint32_t size = dds_UnsignedLongSeq_get(loan.raw_data_sizes, i);
+      RawCaptureRecordHeader header{};
+      header.flags = is_compressed_payload(sample, size) ? RAW_CAPTURE_COMPRESSED : 0;
+      header.source_timestamp = time_to_ns(sample_info->info.source_timestamp);
+      header.reception_timestamp = time_to_ns(sample_info->reception_timestamp);
+      dds_sn_to_ros_sn(sample_info->seq, &header.sequence_number);
+      // Also tells the publishers of the context that the capture took the sample
+      subscriber_info->on_sequence_number(
+        sample_info->info.publication_handle, header.sequence_number);
+      uint8_t gid[RMW_GID_STORAGE_SIZE] = {};
+      if (subscriber_info->get_publication_guid(
+          sample_info->info.publication_handle, gid) == dds_RETCODE_OK)
+      {
+        std::memcpy(header.writer_gid, gid, std::min(sizeof(gid), sizeof(header.writer_gid)));
+      }
+      capture->append(sample, size, header);
+      count++;
+      bytes += size;
+    }
+    subscriber_info->sample_pool.release(topic_reader, loan);
+
+    if (taken > 0) {
+      subscriber_info->stats.on_take(count, bytes, stats_time_ns() - append_start_ns, take_ns);
+    }
+  }
+}
+
+static SubscriberInfo *
+get_capture_subscriber_info(const rmw_subscription_t * subscription)
+{
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid subscription data");
+  }
+  return subscriber_info;
+}
+
+rmw_ret_t
+start_raw_capture(const rmw_subscription_t * subscription, const char * path, size_t file_size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(path, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  SubscriberInfo * subscriber_info = get_capture_subscriber_info(subscription);
+  if (subscriber_info == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  const rosidl_message_type_support_t * type_support =
+    subscriber_info->message_plan->get_type_support();
+  const std::string type_name = demangle_if_ros_type(
+    create_type_name(type_support->data, type_support->typesupport_identifier));
+
+  if (subscriber_info->dispatching.load(std::memory_order_acquire)) {
+    RMW_SET_ERROR_MSG("subscription has a dispatch callback");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_capture};
+    if (subscriber_info->capture != nullptr) {
+      RMW_SET_ERROR_MSG("subscription is already capturing");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    std::unique_ptr<RawCaptureWriter> capture{new(std::nothrow) RawCaptureWriter()};
+    if (capture == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate capture");
+      return RMW_RET_BAD_ALLOC;
+    }
+    if (!capture->open(path, file_size, subscription->topic_name, type_name.c_str())) {
+      // Error message already set
+      return RMW_RET_ERROR;
+    }
+    subscriber_info->capture = std::move(capture);
+    subscriber_info->capturing.store(true, std::memory_order_release);
+  }
+
+  dds_ReturnCode_t dds_rc;
+  {
+    std::lock_guard<std::mutex> guard(subscriber_info->event_callback_data.mutex);
+    subscriber_info->mask |= dds_DATA_AVAILABLE_STATUS;
+    dds_rc = dds_DataReader_set_listener(
+      subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
+  }
+
+  // Samples that arrived before the listener was set would wait for the next one
+  capture_samples(subscriber_info);
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+stop_raw_capture(const rmw_subscription_t * subscription)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  SubscriberInfo * subscriber_info = get_capture_subscriber_info(subscription);
+  if (subscriber_info == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  std::unique_ptr<RawCaptureWriter> capture;
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_capture};
+    if (subscriber_info->capture == nullptr) {
+      RMW_SET_ERROR_MSG("subscription is not capturing");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    subscriber_info->capturing.store(false, std::memory_order_release);
+    capture = std::move(subscriber_info->capture);
+  }
+
+  dds_ReturnCode_t dds_rc;
+  {
+    std::lock_guard<std::mutex> guard(subscriber_info->event_callback_data.mutex);
+    if (!subscriber_info->event_callback_data.is_set_unsafe()) {
+      subscriber_info->mask &= ~dds_DATA_AVAILABLE_STATUS;
+    }
+    dds_rc = dds_DataReader_set_listener(
+      subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
+  }
+
+  capture->sync();
+  return check_dds_ret_code(dds_rc);
+}
+
+rmw_ret_t
+get_raw_capture_status(const rmw_subscription_t * subscription, RawCaptureStatus * status)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(status, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  SubscriberInfo * subscriber_info = get_capture_subscriber_info(subscription);
+  if (subscriber_info == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  std::lock_guard<std::mutex> guard{subscriber_info->mutex_capture};
+  if (subscriber_info->capture == nullptr) {
+    RMW_SET_ERROR_MSG("subscription is not capturing");
+    return RMW_RET_UNSUPPORTED;
+  }
+  subscriber_info->capture->get_status(*status);
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <utility>
 
+#include "rcpputils/scope_exit.hpp"
+
 #include "rcutils/error_handling.h"
 #include "rcutils/logging_macros.h"
 
@@ -31,6 +35,7 @@
 #include "tracetools/tracetools.h"
 
 #include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_fd.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
@@ -38,8 +43,86 @@
 #include "rmw_gurumdds_cpp/qos.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/gid.hpp"
+#include "rmw_gurumdds_cpp/tracing.hpp"
 #include "rmw_gurumdds_cpp/type_support_service.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+// Triggers the graph guard condition when availability changes, so wait_for_service wakes up
+static void update_matched_count(ClientInfo * info, std::atomic<int32_t> & count, int32_t current_count)
+{
+  bool was_available = info->is_service_available();
+  count = current_count;
+  if (was_available == info->is_service_available()) {
+    return;
+  }
+
+  graph_cache::notify_graph_change(info->ctx);
+}
+
+// Matches made before the listener was set are not reported, the count is seeded unless known
+static void init_matched_count(std::atomic<int32_t> & count, int32_t current_count)
+{
+  int32_t unknown = -1;
+  count.compare_exchange_strong(unknown, current_count);
+}
+
+static int64_t steady_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void remove_expired_requests(ClientInfo * info, int64_t now)
+{
+  for (auto it = info->pending_requests.begin(); it != info->pending_requests.end();) {
+    if (it->second != 0 && it->second <= now) {
+      it = info->pending_requests.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// Records a request before it is sent, so that its response is only accepted once
+static void add_pending_request(ClientInfo * info, int64_t sequence_number)
+{
+  const uint64_t timeout = info->ctx->request_timeout_ns;
+  const int64_t now = timeout > 0 ? steady_time_ns() : 0;
+  std::lock_guard guard{info->mutex_pending_requests};
+  if (info->pending_requests.size() >= PENDING_REQUEST_TABLE_SIZE) {
+    remove_expired_requests(info, now > 0 ? now : steady_time_ns());
+  }
+
+  if (info->pending_requests.size() >= PENDING_REQUEST_TABLE_SIZE) {
+    info->untracked_requests++;
+    return;
+  }
+
+  info->pending_requests[sequence_number] = timeout > 0 ? now + static_cast<int64_t>(timeout) : 0;
+}
+
+// False if the response is late or not for a request in flight, it is then dropped undeserialized
+static bool take_pending_request(ClientInfo * info, int64_t sequence_number)
+{
+  std::lock_guard guard{info->mutex_pending_requests};
+  auto it = info->pending_requests.find(sequence_number);
+  if (it == info->pending_requests.end()) {
+    // Requests sent while the table was full cannot be told apart, their responses are accepted
+    if (info->untracked_requests > 0) {
+      info->untracked_requests--;
+      return true;
+    }
+    return false;
+  }
+
+  const int64_t deadline = it->second;
+  info->pending_requests.erase(it);
+  return deadline == 0 || steady_time_ns() < deadline;
+}
+}  // namespace rmw_gurumdds_cpp
 
 extern "C"
 {
@@ -95,14 +178,17 @@ rmw_create_client(
   }
 
   rmw_context_impl_t * ctx = node->context->impl;
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
+  // Held until the topics are created or found and their endpoints created on them
+  rmw_gurumdds_cpp::TopicLockGuard topic_guard;
 
   rmw_gurumdds_cpp::ClientInfo * client_info = nullptr;
   rmw_client_t * rmw_client = nullptr;
 
   dds_DomainParticipant * participant = ctx->participant;
-  dds_Publisher * publisher = ctx->publisher;
-  dds_Subscriber * subscriber = ctx->subscriber;
+  // The writer and the reader of a service share a group
+  const size_t entity_group = ctx->select_entity_group(service_name);
+  dds_Publisher * publisher = ctx->get_publisher(entity_group);
+  dds_Subscriber * subscriber = ctx->get_subscriber(entity_group);
 
   dds_DataReaderQos datareader_qos;
   dds_DataWriterQos datawriter_qos;
@@ -110,9 +196,6 @@ rmw_create_client(
   dds_DataWriter * request_writer = nullptr;
   dds_DataReader * response_reader = nullptr;
   dds_DataReaderListener response_listener;
-  dds_DataSeq* data_seq = nullptr;
-  dds_SampleInfoSeq* info_seq = nullptr;
-  dds_UnsignedLongSeq* raw_data_sizes = nullptr;
   dds_ReadCondition * read_condition = nullptr;
   dds_TypeSupport * request_typesupport = nullptr;
   dds_TypeSupport * response_typesupport = nullptr;
@@ -150,6 +233,7 @@ rmw_create_client(
     rmw_gurumdds_cpp::ros_service_requester_prefix, service_name, "Request", &adapted_qos_policies);
   response_topic_name = rmw_gurumdds_cpp::create_topic_name(
     rmw_gurumdds_cpp::ros_service_response_prefix, service_name, "Reply", &adapted_qos_policies);
+  topic_guard.lock(ctx->topic_locks, request_topic_name, response_topic_name);
 
   service_metastring =
     rmw_gurumdds_cpp::create_service_metastring(type_support->data, type_support->typesupport_identifier);
@@ -314,43 +398,76 @@ rmw_create_client(
     goto fail;
   }
 
-  data_seq = dds_DataSeq_create(1);
-  if (nullptr == data_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate data_seq");
-    return nullptr;
-  }
-  info_seq = dds_SampleInfoSeq_create(1);
-  if (nullptr == info_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate info_seq");
-    return nullptr;
-  }
-  raw_data_sizes = dds_UnsignedLongSeq_create(1);
-  if (nullptr == raw_data_sizes) {
-    RMW_SET_ERROR_MSG("failed to allocate raw_data_sizes");
-    return nullptr;
-  }
-
   dds_DataReader_set_listener_context(response_reader, client_info);
   response_listener.on_data_available = [](const dds_DataReader * response_reader){
     dds_DataReader* reader = const_cast<dds_DataReader*>(response_reader);
     auto* info = static_cast<rmw_gurumdds_cpp::ClientInfo*>(dds_DataReader_get_listener_context(reader));
     std::lock_guard<std::mutex> guard(info->event_callback_data.mutex);
     if(info->event_callback_data.callback) {
-      info->event_callback_data.callback(info->event_callback_data.user_data, info->count_unread());
+      // One notification per received response
+      info->event_callback_data.callback(info->event_callback_data.user_data, 1);
     }
+    rmw_gurumdds_cpp::write_event_fd(info->event_callback_data.event_fd);
+  };
+
+  response_listener.on_subscription_matched = [](
+    const dds_DataReader * response_reader, const dds_SubscriptionMatchedStatus * status) {
+    dds_DataReader* reader = const_cast<dds_DataReader*>(response_reader);
+    auto* info = static_cast<rmw_gurumdds_cpp::ClientInfo*>(dds_DataReader_get_listener_context(reader));
+    rmw_gurumdds_cpp::update_matched_count(info, info->matched_response_writers, status->current_count);
+  };
+
+  client_info->request_listener.on_publication_matched = [](
+    const dds_DataWriter * request_writer, const dds_PublicationMatchedStatus * status) {
+    dds_DataWriter* writer = const_cast<dds_DataWriter*>(request_writer);
+    auto* info = static_cast<rmw_gurumdds_cpp::ClientInfo*>(dds_DataWriter_get_listener_context(writer));
+    rmw_gurumdds_cpp::update_matched_count(info, info->matched_request_readers, status->current_count);
   };
 
   client_info->request_writer = request_writer;
   client_info->response_reader = response_reader;
   client_info->read_condition = read_condition;
   client_info->response_listener = response_listener;
-  client_info->data_seq = data_seq;
-  client_info->info_seq = info_seq;
-  client_info->raw_data_sizes = raw_data_sizes;
   client_info->implementation_identifier = RMW_GURUMDDS_ID;
   client_info->service_typesupport = type_support;
+  if (!client_info->type_support.init(type_support)) {
+    // Error message already set
+    goto fail;
+  }
   client_info->sequence_number = 0;
   client_info->ctx = ctx;
+  client_info->message_buffers.set_memory(ctx->buffer_memory);
+
+  // rmw_service_server_is_available reads the matched counts instead of querying DDS
+  dds_DataWriter_set_listener_context(request_writer, client_info);
+  ret = dds_DataWriter_set_listener(
+    request_writer, &client_info->request_listener, dds_PUBLICATION_MATCHED_STATUS);
+  if (ret == dds_RETCODE_OK) {
+    ret = dds_DataReader_set_listener(
+      response_reader, &client_info->response_listener, CLIENT_RESPONSE_LISTENER_MASK);
+  }
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to set matched listeners");
+    goto fail;
+  }
+
+  {
+    dds_PublicationMatchedStatus publication_matched_status;
+    if (dds_DataWriter_get_publication_matched_status(
+        request_writer, &publication_matched_status) == dds_RETCODE_OK)
+    {
+      rmw_gurumdds_cpp::init_matched_count(
+        client_info->matched_request_readers, publication_matched_status.current_count);
+    }
+
+    dds_SubscriptionMatchedStatus subscription_matched_status;
+    if (dds_DataReader_get_subscription_matched_status(
+        response_reader, &subscription_matched_status) == dds_RETCODE_OK)
+    {
+      rmw_gurumdds_cpp::init_matched_count(
+        client_info->matched_response_writers, subscription_matched_status.current_count);
+    }
+  }
 
   // Set GUID
   dds_DataWriter_get_guid(request_writer, client_guid);
@@ -462,23 +579,20 @@ rmw_destroy_client(rmw_node_t * node, rmw_client_t * client)
 
   dds_ReturnCode_t ret;
   rmw_context_impl_t * ctx = node->context->impl;
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
 
   auto client_info = static_cast<rmw_gurumdds_cpp::ClientInfo *>(client->data);
 
   if (client_info != nullptr) {
+    rmw_gurumdds_cpp::clean_wait_set_caches();
     if (client_info->request_writer != nullptr) {
-      ret = dds_Publisher_delete_datawriter(ctx->publisher, client_info->request_writer);
+      ret = dds_Publisher_delete_datawriter(
+        dds_DataWriter_get_publisher(client_info->request_writer), client_info->request_writer);
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to delete datawriter");
         return RMW_RET_ERROR;
       }
     }
 
-    dds_DataSeq_delete(client_info->data_seq);
-    dds_SampleInfoSeq_delete(client_info->info_seq);
-    dds_UnsignedLongSeq_delete(client_info->raw_data_sizes);
-
     if (client_info->response_reader != nullptr) {
       if (client_info->read_condition != nullptr) {
         ret = dds_DataReader_delete_readcondition(
@@ -488,7 +602,8 @@ rmw_destroy_client(rmw_node_t * node, rmw_client_t * client)
           return RMW_RET_ERROR;
         }
       }
-      ret = dds_Subscriber_delete_datareader(ctx->subscriber, client_info->response_reader);
+      ret = dds_Subscriber_delete_datareader(
+        dds_DataReader_get_subscriber(client_info->response_reader), client_info->response_reader);
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to delete datareader");
         return RMW_RET_ERROR;
@@ -543,64 +658,7 @@ rmw_service_server_is_available(
     return RMW_RET_ERROR;
   }
 
-  dds_DataWriter * request_writer = client_info->request_writer;
-  if (request_writer == nullptr) {
-    RMW_SET_ERROR_MSG("request writer is null");
-    return RMW_RET_ERROR;
-  }
-
-  dds_DataReader * response_reader = client_info->response_reader;
-  if (response_reader == nullptr) {
-    RMW_SET_ERROR_MSG("response reader is null");
-    return RMW_RET_ERROR;
-  }
-
-  *is_available = false;
-
-  dds_InstanceHandleSeq * seq = dds_InstanceHandleSeq_create(4);
-  if (seq == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create instance handle sequence");
-    return RMW_RET_ERROR;
-  }
-
-  // Look for matching request reader
-  if (dds_DataWriter_get_matched_subscriptions(request_writer, seq) != dds_RETCODE_OK) {
-    RMW_SET_ERROR_MSG("failed to get matched subscriptions");
-    dds_InstanceHandleSeq_delete(seq);
-    return RMW_RET_ERROR;
-  }
-
-  auto sub_cnt = dds_InstanceHandleSeq_length(seq);
-  dds_InstanceHandleSeq_delete(seq);
-
-  // Matching request reader not found
-  if (sub_cnt == 0) {
-    return RMW_RET_OK;
-  }
-
-  seq = dds_InstanceHandleSeq_create(4);
-  if (seq == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create instance handle sequence");
-    return RMW_RET_ERROR;
-  }
-
-  // Look for matching response writer
-  if (dds_DataReader_get_matched_publications(response_reader, seq) != dds_RETCODE_OK) {
-    RMW_SET_ERROR_MSG("failed to get matched publications");
-    dds_InstanceHandleSeq_delete(seq);
-    return RMW_RET_ERROR;
-  }
-
-  auto pub_cnt = dds_InstanceHandleSeq_length(seq);
-  dds_InstanceHandleSeq_delete(seq);
-
-  // Matching response writer not found
-  if (pub_cnt == 0) {
-    return RMW_RET_OK;
-  }
-
-  *is_available = true;
-
+  *is_available = client_info->is_service_available();
   return RMW_RET_OK;
 }
 
@@ -753,77 +811,75 @@ rmw_send_request(
     return RMW_RET_ERROR;
   }
 
-  auto type_support = client_info->service_typesupport;
-  if (type_support == nullptr) {
-    RMW_SET_ERROR_MSG("typesupport handle is null");
-    return RMW_RET_ERROR;
+  const rmw_gurumdds_cpp::ServiceTypeSupport & type_support = client_info->type_support;
+
+  rmw_gurumdds_cpp::MessageBuffer * pooled_buffer = client_info->message_buffers.acquire();
+  if (pooled_buffer == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate message buffer");
+    return RMW_RET_BAD_ALLOC;
   }
+  auto scope_exit_buffer_release = rcpputils::make_scope_exit(
+    [client_info, pooled_buffer]() {
+      client_info->message_buffers.release(pooled_buffer);
+    });
+  rmw_gurumdds_cpp::MessageBuffer & message_buffer = *pooled_buffer;
 
   size_t size = 0;
+  const int64_t sequence_number =
+    client_info->sequence_number.fetch_add(1, std::memory_order_relaxed) + 1;
+  *sequence_id = sequence_number;
 
-  if (client_info->ctx->service_mapping_basic) {
-    void * dds_request = rmw_gurumdds_cpp::allocate_request_basic(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_request,
-      &size
-    );
+  rmw_gurumdds_cpp::add_pending_request(client_info, sequence_number);
+  auto scope_exit_pending_request = rcpputils::make_scope_exit(
+    [client_info, sequence_number]() {
+      rmw_gurumdds_cpp::take_pending_request(client_info, sequence_number);
+    });
 
-    if (dds_request == nullptr) {
-      return RMW_RET_ERROR;
-    }
-
-    bool res = rmw_gurumdds_cpp::serialize_request_basic(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_request,
-      dds_request,
-      size,
-      ++client_info->sequence_number,
+  const uint64_t serialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+  if (client_info->ctx->service_mapping_basic) {
+    bool res = type_support.serialize_request_basic(
+            ros_request,
+      message_buffer,
+      &size,
+      sequence_number,
       client_info->writer_guid
     );
 
     if (!res) {
-      RMW_SET_ERROR_MSG("failed to serialize message");
-      free(dds_request);
+      // Error message already set
       return RMW_RET_ERROR;
     }
 
-    if (dds_DataWriter_raw_write(request_writer, dds_request, size) != dds_RETCODE_OK) {
+    void * dds_request = message_buffer.data();
+
+    const uint64_t write_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    dds_ReturnCode_t ret = dds_DataWriter_raw_write(request_writer, dds_request, size);
+    client_info->request_stats.on_write(
+      size, write_start_ns - serialize_start_ns,
+      rmw_gurumdds_cpp::stats_time_ns() - write_start_ns);
+    if (ret != dds_RETCODE_OK) {
+      client_info->request_stats.on_drop();
       RMW_SET_ERROR_MSG("failed to send request");
-      free(dds_request);
       return RMW_RET_ERROR;
     }
-    free(dds_request);
   } else {
-    void * dds_request = rmw_gurumdds_cpp::allocate_request_enhanced(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_request,
+    bool res = type_support.serialize_request_enhanced(
+            ros_request,
+      message_buffer,
       &size
     );
 
-    if (dds_request == nullptr) {
-      return RMW_RET_ERROR;
-    }
-
-    bool res = rmw_gurumdds_cpp::serialize_request_enhanced(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_request,
-      dds_request,
-      size
-    );
-
     if (!res) {
-      RMW_SET_ERROR_MSG("failed to serialize message");
-      free(dds_request);
+      // Error message already set
       return RMW_RET_ERROR;
     }
 
+    void * dds_request = message_buffer.data();
+    const uint64_t serialization_ns = rmw_gurumdds_cpp::stats_time_ns() - serialize_start_ns;
+
     dds_SampleInfoEx sampleinfo_ex;
     std::memset(&sampleinfo_ex, 0, sizeof(dds_SampleInfoEx));
-    rmw_gurumdds_cpp::ros_sn_to_dds_sn(++client_info->sequence_number, &sampleinfo_ex.seq);
+    rmw_gurumdds_cpp::ros_sn_to_dds_sn(sequence_number, &sampleinfo_ex.seq);
     rmw_gurumdds_cpp::ros_guid_to_dds_guid(
       reinterpret_cast<const uint8_t *>(client_info->writer_guid),
       reinterpret_cast<uint8_t *>(&sampleinfo_ex.src_guid));
@@ -834,18 +890,19 @@ rmw_send_request(
         static_cast<const void *>(ros_request),
         *sequence_id);
 
-    if (dds_DataWriter_raw_write_w_sampleinfoex(
-        request_writer, dds_request, size, &sampleinfo_ex) != dds_RETCODE_OK)
-    {
+    const uint64_t write_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    dds_ReturnCode_t ret =
+      dds_DataWriter_raw_write_w_sampleinfoex(request_writer, dds_request, size, &sampleinfo_ex);
+    client_info->request_stats.on_write(
+      size, serialization_ns, rmw_gurumdds_cpp::stats_time_ns() - write_start_ns);
+    if (ret != dds_RETCODE_OK) {
+      client_info->request_stats.on_drop();
       RMW_SET_ERROR_MSG("failed to send request");
-      free(dds_request);
       return RMW_RET_ERROR;
     }
-    free(dds_request);
   }
 
-  *sequence_id = client_info->sequence_number;
-
+  scope_exit_pending_request.cancel();
   return RMW_RET_OK;
 }
 
@@ -866,6 +923,7 @@ rmw_take_response(
   RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
 
   *taken = false;
+  RMW_GURUMDDS_TRACEPOINT(take_response_begin, static_cast<const void *>(client));
 
   auto client_info = static_cast<rmw_gurumdds_cpp::ClientInfo *>(client->data);
   if (client_info == nullptr) {
@@ -879,55 +937,42 @@ rmw_take_response(
     return RMW_RET_ERROR;
   }
 
-  auto type_support = client_info->service_typesupport;
-  if (type_support == nullptr) {
-    RMW_SET_ERROR_MSG("typesupport handle is null");
-    return RMW_RET_ERROR;
-  }
+  const rmw_gurumdds_cpp::ServiceTypeSupport & type_support = client_info->type_support;
 
-  dds_DataSeq * data_values = dds_DataSeq_create(1);
-  if (data_values == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create data sequence");
-    return RMW_RET_ERROR;
+  rmw_gurumdds_cpp::SampleSequences sequences{};
+  if (!client_info->sample_pool.acquire(1, sequences)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return RMW_RET_BAD_ALLOC;
   }
 
-  dds_SampleInfoSeq * sample_infos = dds_SampleInfoSeq_create(1);
-  if (sample_infos == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample info sequence");
-    dds_DataSeq_delete(data_values);
-    return RMW_RET_ERROR;
-  }
+  auto scope_exit_sequences_release = rcpputils::make_scope_exit(
+    [client_info, response_reader, &sequences]() {
+      client_info->sample_pool.release(response_reader, sequences);
+    });
 
-  dds_UnsignedLongSeq * sample_sizes = dds_UnsignedLongSeq_create(1);
-  if (sample_sizes == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample size sequence");
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    return RMW_RET_ERROR;
-  }
+  dds_DataSeq * data_values = sequences.data_seq;
+  dds_SampleInfoSeq * sample_infos = sequences.info_seq;
+  dds_UnsignedLongSeq * sample_sizes = sequences.raw_data_sizes;
 
   dds_ReturnCode_t ret = dds_RETCODE_OK;
+  // Time of the takes, which skip the responses to other clients
+  uint64_t take_ns = 0;
 
   if (client_info->ctx->service_mapping_basic) {
     while (ret == dds_RETCODE_OK) {
+      const uint64_t take_start_ns = rmw_gurumdds_cpp::stats_time_ns();
       ret = dds_DataReader_raw_take(
         response_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, 1,
         dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+      take_ns += rmw_gurumdds_cpp::stats_time_ns() - take_start_ns;
 
       if (ret == dds_RETCODE_NO_DATA) {
-        dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
+        client_info->response_stats.on_no_data(take_ns);
         return RMW_RET_OK;
       }
 
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to take data");
-        dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
 
@@ -935,10 +980,6 @@ rmw_take_response(
       if (sample_info->valid_data) {
         void * sample = dds_DataSeq_get(data_values, 0);
         if (sample == nullptr) {
-          dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
           return RMW_RET_ERROR;
         }
         uint32_t size = dds_UnsignedLongSeq_get(sample_sizes, 0);
@@ -946,10 +987,8 @@ rmw_take_response(
         uint32_t sn_low = 0;
         int8_t client_guid[16] = {0};
         dds_SampleInfoEx * sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(sample_info);
-        bool res = rmw_gurumdds_cpp::deserialize_response_basic(
-          type_support->data,
-          type_support->typesupport_identifier,
-          ros_response,
+        // Responses reach every client of the service, only this client's are deserialized
+        bool res = rmw_gurumdds_cpp::peek_service_header_basic(
           sample,
           static_cast<size_t>(size),
           &sn_high,
@@ -959,14 +998,29 @@ rmw_take_response(
 
         if (!res) {
           // Error message already set
-          dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
           return RMW_RET_ERROR;
         }
 
-        if (std::memcmp(client_info->writer_guid, client_guid, RMW_GID_STORAGE_SIZE) == 0) {
+        if (std::memcmp(client_info->writer_guid, client_guid, RMW_GID_STORAGE_SIZE) == 0 &&
+          rmw_gurumdds_cpp::take_pending_request(client_info, ((int64_t)sn_high) << 32 | sn_low))
+        {
+          const uint64_t deserialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+          res = type_support.deserialize_response_basic(
+                        ros_response,
+            sample,
+            static_cast<size_t>(size),
+            &sn_high,
+            &sn_low,
+            client_guid
+          );
+
+          if (!res) {
+            // Error message already set
+            return RMW_RET_ERROR;
+          }
+          client_info->response_stats.on_take(
+            1, size, rmw_gurumdds_cpp::stats_time_ns() - deserialize_start_ns, take_ns);
+
           request_header->source_timestamp =
             sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
             sample_info->source_timestamp.nanosec;
@@ -986,24 +1040,19 @@ rmw_take_response(
     }
   } else {
     while (ret == dds_RETCODE_OK) {
+      const uint64_t take_start_ns = rmw_gurumdds_cpp::stats_time_ns();
       ret = dds_DataReader_raw_take_w_sampleinfoex(
         response_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, 1,
         dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+      take_ns += rmw_gurumdds_cpp::stats_time_ns() - take_start_ns;
 
       if (ret == dds_RETCODE_NO_DATA) {
-        dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
+        client_info->response_stats.on_no_data(take_ns);
         return RMW_RET_OK;
       }
 
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to take data");
-        dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
 
@@ -1011,10 +1060,6 @@ rmw_take_response(
       if (sample_info->valid_data) {
         void * sample = dds_DataSeq_get(data_values, 0);
         if (sample == nullptr) {
-          dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
           return RMW_RET_ERROR;
         }
         uint32_t size = dds_UnsignedLongSeq_get(sample_sizes, 0);
@@ -1024,24 +1069,24 @@ rmw_take_response(
         rmw_gurumdds_cpp::dds_guid_to_ros_guid(reinterpret_cast<int8_t *>(&sampleinfo_ex->src_guid), client_guid);
         rmw_gurumdds_cpp::dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
 
-        bool res = rmw_gurumdds_cpp::deserialize_response_enhanced(
-          type_support->data,
-          type_support->typesupport_identifier,
-          ros_response,
-          sample,
-          static_cast<size_t>(size)
-        );
-
-        if (!res) {
-          // Error message already set
-          dds_DataReader_raw_return_loan(response_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
-          return RMW_RET_ERROR;
-        }
+        // The request id is in the sample info, other clients' responses are never deserialized
+        if (std::memcmp(client_info->writer_guid, client_guid, RMW_GID_STORAGE_SIZE) == 0 &&
+          rmw_gurumdds_cpp::take_pending_request(client_info, sequence_number))
+        {
+          const uint64_t deserialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+          bool res = type_support.deserialize_response_enhanced(
+                        ros_response,
+            sample,
+            static_cast<size_t>(size)
+          );
+
+          if (!res) {
+            // Error message already set
+            return RMW_RET_ERROR;
+          }
+          client_info->response_stats.on_take(
+            1, size, rmw_gurumdds_cpp::stats_time_ns() - deserialize_start_ns, take_ns);
 
-        if (std::memcmp(client_info->writer_guid, client_guid, RMW_GID_STORAGE_SIZE) == 0) {
           request_header->source_timestamp =
             sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
             sample_info->source_timestamp.nanosec;
@@ -1061,9 +1106,6 @@ rmw_take_response(
     }
   }
 
-  dds_DataSeq_delete(data_values);
-  dds_SampleInfoSeq_delete(sample_infos);
-  dds_UnsignedLongSeq_delete(sample_sizes);
 
   TRACETOOLS_TRACEPOINT(
     rmw_take_response,
@@ -1095,7 +1137,7 @@ rmw_client_set_on_new_response_callback(
   }
 
   std::lock_guard<std::mutex> guard(client_info->event_callback_data.mutex);
-  dds_StatusMask mask = dds_DataReader_get_status_changes(client_info->response_reader);
+  dds_StatusMask mask = CLIENT_RESPONSE_LISTENER_MASK;
   dds_ReturnCode_t dds_rc = dds_RETCODE_ERROR;
 
   if (callback) {
@@ -1111,7 +1153,9 @@ rmw_client_set_on_new_response_callback(
   } else {
     client_info->event_callback_data.callback = nullptr;
     client_info->event_callback_data.user_data = nullptr;
-    mask &= ~dds_DATA_AVAILABLE_STATUS;
+    if (!client_info->event_callback_data.is_set_unsafe()) {
+      mask &= ~dds_DATA_AVAILABLE_STATUS;
+    }
     dds_rc = dds_DataReader_set_listener(client_info->response_reader, &client_info->response_listener, mask);
   }
 
@@ -13,54 +13,23 @@
 // limitations under the License.
 
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
-#include <map>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
-#include "rmw/impl/cpp/key_value.hpp"
-
 #include "rmw_gurumdds_cpp/gid.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
+#include "rmw_gurumdds_cpp/user_data.hpp"
 
 using rmw_dds_common::msg::ParticipantEntitiesInfo;
 
 namespace rmw_gurumdds_cpp
 {
-static inline std::map<std::string, std::vector<uint8_t>>
-parse_map(uint8_t * const data, const uint32_t data_len)
-{
-  std::vector<uint8_t> data_vec(data, data + data_len);
-  std::map<std::string, std::vector<uint8_t>> map
-    = rmw::impl::cpp::parse_key_value(data_vec);
-  return map;
-}
-
-static inline rmw_ret_t
-get_user_data_key(
-  dds_ParticipantBuiltinTopicData * data,
-  const std::string& key,
-  std::string & value,
-  bool & found)
-{
-  found = false;
-  uint8_t * user_data =
-    static_cast<uint8_t *>(data->user_data.value);
-  const uint32_t user_data_len = data->user_data.size;
-  if (user_data_len == 0) {
-    return RMW_RET_OK;
-  }
-
-  auto map = parse_map(user_data, user_data_len);
-  auto name_found = map.find(key);
-  if (name_found != map.end()) {
-    value = std::string(name_found->second.begin(), name_found->second.end());
-    found = true;
-  }
-
-  return RMW_RET_OK;
-}
-
 void on_participant_changed(
   const dds_DomainParticipant * a_participant,
   const dds_ParticipantBuiltinTopicData * data,
@@ -78,20 +47,8 @@ void on_participant_changed(
   if (handle == dds_HANDLE_NIL) {
     rmw_gurumdds_cpp::graph_cache::remove_participant(ctx, &dp_guid);
   } else {
-    std::string enclave_str;
-    bool enclave_found;
-    dds_ReturnCode_t rc =
-      get_user_data_key(
-      const_cast<dds_ParticipantBuiltinTopicData *>(data),
-      "securitycontext", enclave_str, enclave_found);
-    if (RMW_RET_OK != rc) {
-      RMW_SET_ERROR_MSG("failed to parse user data for enclave");
-    }
-
-    const char * enclave = nullptr;
-    if (enclave_found) {
-      enclave = enclave_str.c_str();
-    }
+    std::string_view enclave;
+    find_user_data_value(data->user_data.value, data->user_data.size, "securitycontext", enclave);
 
     if (RMW_RET_OK != rmw_gurumdds_cpp::graph_cache::add_participant(ctx, &dp_guid, enclave)) {
       RMW_SET_ERROR_MSG("failed to assert remote participant in graph");
@@ -306,6 +263,9 @@ rmw_context_impl_s::initialize_participant(
   const char * const * check_props = nullptr;
   uint32_t props_count;
   bool remote_support = false;
+  bool static_discovery_supported = false;
+  bool shm_supported = false;
+  bool dds_thread_settings_supported = false;
   const char * props_ptr;
 
   dds_DomainParticipantFactory_get_supported_participant_props(factory, &check_props, &props_count);
@@ -313,7 +273,15 @@ rmw_context_impl_s::initialize_participant(
     props_ptr = strstr(check_props[i], "on_remote");
     if (props_ptr != nullptr) {
       remote_support = true;
-      break;
+    }
+    if (strcmp(check_props[i], STATIC_DISCOVERY_FILE_PROPERTY) == 0) {
+      static_discovery_supported = true;
+    }
+    if (strcmp(check_props[i], SHM_TRANSPORT_PROPERTY) == 0) {
+      shm_supported = true;
+    }
+    if (strcmp(check_props[i], DDS_THREAD_AFFINITY_PROPERTY) == 0) {
+      dds_thread_settings_supported = true;
     }
   }
   if (!remote_support) {
@@ -357,37 +325,134 @@ rmw_context_impl_s::initialize_participant(
   static_discovery_id += node_name;
 
   /* Create DomainParticipant */
-  if (RMW_AUTOMATIC_DISCOVERY_RANGE_LOCALHOST == this->base->options.discovery_options.automatic_discovery_range) {
+  std::vector<dds_StringProperty> props;
+  const bool localhost_only = RMW_AUTOMATIC_DISCOVERY_RANGE_LOCALHOST ==
+    this->base->options.discovery_options.automatic_discovery_range;
+  if (localhost_only) {
     // TODO: localhost only
-    dds_StringProperty props[] = {
+    props.push_back(
       {const_cast<char *>("rtps.interface.ip"),
-        const_cast<void *>(static_cast<const void *>("127.0.0.1"))},
-      {const_cast<char *>("gurumdds.static_discovery.id"),
-        const_cast<void *>(static_cast<const void *>(static_discovery_id.c_str()))},
-      {const_cast<char *>("dcps.participant.listener.on_remote_participant_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_participant_changed)},
-      {const_cast<char *>("dcps.participant.listener.on_remote_publication_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_publication_changed)},
-      {const_cast<char *>("dcps.participant.listener.on_remote_subscription_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_subscription_changed)},
-      {nullptr, nullptr},
-    };
-    this->participant = dds_DomainParticipantFactory_create_participant_w_props(
-      factory, this->domain_id, &participant_qos, nullptr, 0, props);
-  } else {
-    dds_StringProperty props[] = {
-      {const_cast<char *>("gurumdds.static_discovery.id"),
-        const_cast<void *>(static_cast<const void *>(static_discovery_id.c_str()))},
-      {const_cast<char *>("dcps.participant.listener.on_remote_participant_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_participant_changed)},
-      {const_cast<char *>("dcps.participant.listener.on_remote_publication_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_publication_changed)},
-      {const_cast<char *>("dcps.participant.listener.on_remote_subscription_changed"),
-        reinterpret_cast<void *>(rmw_gurumdds_cpp::on_subscription_changed)},
-      {nullptr, nullptr},
+        const_cast<void *>(static_cast<const void *>("127.0.0.1"))});
+  }
+
+  // Loopback UDP stays the transport of discovery and of peers on other hosts
+  bool use_shm = this->shm_transport == SHM_TRANSPORT_ON ||
+    (this->shm_transport == SHM_TRANSPORT_AUTO && localhost_only);
+  if (use_shm && !shm_supported) {
+    if (this->shm_transport == SHM_TRANSPORT_ON) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "shared-memory transport is not supported by this GurumDDS");
+    }
+    use_shm = false;
+  }
+  if (use_shm) {
+    props.push_back(
+      {const_cast<char *>(SHM_TRANSPORT_PROPERTY),
+        const_cast<void *>(static_cast<const void *>("1"))});
+    props.push_back(
+      {const_cast<char *>(SHM_PREFER_LOCAL_PROPERTY),
+        const_cast<void *>(static_cast<const void *>("1"))});
+    if (!this->shm_segment_size.empty()) {
+      props.push_back(
+        {const_cast<char *>(SHM_SEGMENT_SIZE_PROPERTY),
+          const_cast<void *>(static_cast<const void *>(this->shm_segment_size.c_str()))});
+    }
+  }
+  const bool dds_thread_settings_set = !this->dds_thread_affinity.empty() ||
+    !this->dds_thread_policy.empty() || !this->dds_thread_priority.empty();
+  if (dds_thread_settings_set && !dds_thread_settings_supported) {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "thread settings of the participant are not supported by this GurumDDS");
+  } else if (dds_thread_settings_set) {
+    const std::pair<const char *, const std::string *> thread_props[] = {
+      {DDS_THREAD_AFFINITY_PROPERTY, &this->dds_thread_affinity},
+      {DDS_THREAD_POLICY_PROPERTY, &this->dds_thread_policy},
+      {DDS_THREAD_PRIORITY_PROPERTY, &this->dds_thread_priority},
     };
+    for (const auto & prop : thread_props) {
+      if (!prop.second->empty()) {
+        props.push_back(
+          {const_cast<char *>(prop.first),
+            const_cast<void *>(static_cast<const void *>(prop.second->c_str()))});
+      }
+    }
+  }
+
+  props.push_back(
+    {const_cast<char *>("gurumdds.static_discovery.id"),
+      const_cast<void *>(static_cast<const void *>(static_discovery_id.c_str()))});
+  if (!this->static_discovery_file.empty()) {
+    if (!static_discovery_supported) {
+      RCUTILS_LOG_ERROR_NAMED(
+        RMW_GURUMDDS_ID, "static discovery file is not supported by this GurumDDS");
+      return RMW_RET_ERROR;
+    }
+    FILE * file = fopen(this->static_discovery_file.c_str(), "r");
+    if (file == nullptr) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "failed to open static discovery file '%s'", this->static_discovery_file.c_str());
+      return RMW_RET_ERROR;
+    }
+    fclose(file);
+    props.push_back(
+      {const_cast<char *>(STATIC_DISCOVERY_FILE_PROPERTY),
+        const_cast<void *>(static_cast<const void *>(this->static_discovery_file.c_str()))});
+  }
+  if (!this->qos_profile_file.empty()) {
+    if (!this->qos_profiles.load(this->qos_profile_file)) {
+      // Error message already set
+      return RMW_RET_ERROR;
+    }
+    for (const auto & prop : this->qos_profiles.get_participant_properties()) {
+      bool supported = false;
+      for (uint32_t i = 0; i < props_count && !supported; i++) {
+        supported = prop.first == check_props[i];
+      }
+      if (!supported) {
+        RCUTILS_LOG_WARN_NAMED(
+          RMW_GURUMDDS_ID, "ignoring participant property '%s' not supported by this GurumDDS",
+          prop.first.c_str());
+        continue;
+      }
+      props.push_back(
+        {const_cast<char *>(prop.first.c_str()),
+          const_cast<void *>(static_cast<const void *>(prop.second.c_str()))});
+    }
+
+    this->locator_policy = this->qos_profiles.get_locator_policy_property();
+    bool locator_policy_supported = false;
+    for (uint32_t i = 0; i < props_count && !locator_policy_supported; i++) {
+      locator_policy_supported = strcmp(check_props[i], RTPS_LOCATOR_POLICY_PROPERTY) == 0;
+    }
+    if (!this->locator_policy.empty() && !locator_policy_supported) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "the locators of the topics are not supported by this GurumDDS, "
+        "their samples are sent to the default locators");
+      this->locator_policy.clear();
+    }
+    if (!this->locator_policy.empty()) {
+      props.push_back(
+        {const_cast<char *>(RTPS_LOCATOR_POLICY_PROPERTY),
+          const_cast<void *>(static_cast<const void *>(this->locator_policy.c_str()))});
+    }
+  }
+  props.push_back(
+    {const_cast<char *>("dcps.participant.listener.on_remote_participant_changed"),
+      reinterpret_cast<void *>(rmw_gurumdds_cpp::on_participant_changed)});
+  props.push_back(
+    {const_cast<char *>("dcps.participant.listener.on_remote_publication_changed"),
+      reinterpret_cast<void *>(rmw_gurumdds_cpp::on_publication_changed)});
+  props.push_back(
+    {const_cast<char *>("dcps.participant.listener.on_remote_subscription_changed"),
+      reinterpret_cast<void *>(rmw_gurumdds_cpp::on_subscription_changed)});
+  props.push_back({nullptr, nullptr});
+  {
+    rmw_gurumdds_cpp::UdpSocketSnapshot sockets;
     this->participant = dds_DomainParticipantFactory_create_participant_w_props(
-      factory, this->domain_id, &participant_qos, nullptr, 0, props);
+      factory, this->domain_id, &participant_qos, nullptr, 0, props.data());
+    if (this->participant != nullptr) {
+      this->flow_locators = sockets.get_user_locators(this->domain_id, localhost_only);
+    }
   }
 
   if (this->participant == nullptr) {
@@ -435,6 +500,70 @@ rmw_context_impl_s::initialize_participant(
     return RMW_RET_ERROR;
   }
 
+  /* Create the other entity groups */
+  for (size_t i = 1; i < this->entity_group_count; i++) {
+    ret = dds_DomainParticipant_get_default_publisher_qos(this->participant, &publisher_qos);
+    if (ret != dds_RETCODE_OK) {
+      RMW_SET_ERROR_MSG("failed to get default publisher qos");
+      return RMW_RET_ERROR;
+    }
+
+    dds_Publisher * group_publisher =
+      dds_DomainParticipant_create_publisher(this->participant, &publisher_qos, nullptr, 0);
+    dds_PublisherQos_finalize(&publisher_qos);
+    if (group_publisher == nullptr) {
+      RMW_SET_ERROR_MSG("failed to create publisher");
+      return RMW_RET_ERROR;
+    }
+    this->publisher_groups.push_back(group_publisher);
+
+    ret = dds_DomainParticipant_get_default_subscriber_qos(this->participant, &subscriber_qos);
+    if (ret != dds_RETCODE_OK) {
+      RMW_SET_ERROR_MSG("failed to get default subscriber qos");
+      return RMW_RET_ERROR;
+    }
+
+    dds_Subscriber * group_subscriber =
+      dds_DomainParticipant_create_subscriber(this->participant, &subscriber_qos, nullptr, 0);
+    dds_SubscriberQos_finalize(&subscriber_qos);
+    if (group_subscriber == nullptr) {
+      RMW_SET_ERROR_MSG("failed to create subscriber");
+      return RMW_RET_ERROR;
+    }
+    this->subscriber_groups.push_back(group_subscriber);
+  }
+
+  /* Create the group of the endpoints created together */
+  ret = dds_DomainParticipant_get_default_publisher_qos(this->participant, &publisher_qos);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to get default publisher qos");
+    return RMW_RET_ERROR;
+  }
+
+  publisher_qos.entity_factory.autoenable_created_entities = false;
+  this->bulk_publisher =
+    dds_DomainParticipant_create_publisher(this->participant, &publisher_qos, nullptr, 0);
+  dds_PublisherQos_finalize(&publisher_qos);
+  if (this->bulk_publisher == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create publisher");
+    return RMW_RET_ERROR;
+  }
+
+  ret = dds_DomainParticipant_get_default_subscriber_qos(this->participant, &subscriber_qos);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to get default subscriber qos");
+    return RMW_RET_ERROR;
+  }
+
+  subscriber_qos.entity_factory.autoenable_created_entities = false;
+  this->bulk_subscriber =
+    dds_DomainParticipant_create_subscriber(this->participant, &subscriber_qos, nullptr, 0);
+  dds_SubscriberQos_finalize(&subscriber_qos);
+  if (this->bulk_subscriber == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create subscriber");
+    return RMW_RET_ERROR;
+  }
+
   // Initialize graph_cache
   if (rmw_gurumdds_cpp::graph_cache::initialize(this) != RMW_RET_OK) {
     RMW_SET_ERROR_MSG("failed to initialize graph cache");
@@ -447,11 +576,41 @@ rmw_context_impl_s::initialize_participant(
 
   RCUTILS_LOG_DEBUG_NAMED(
     RMW_GURUMDDS_ID,
-    "DomainParticipant initialized");
+    "DomainParticipant initialized%s", use_shm ? " with the shared-memory transport" : "");
 
   return RMW_RET_OK;
 }
 
+size_t
+rmw_context_impl_s::select_entity_group(const char * topic_name)
+{
+  const size_t count = this->publisher_groups.size() + 1;
+  if (count == 1) {
+    return 0;
+  }
+
+  switch (this->entity_group_policy) {
+    case ENTITY_GROUP_BY_TOPIC:
+      return std::hash<std::string_view>{}(topic_name) % count;
+    case ENTITY_GROUP_BY_THREAD:
+      return std::hash<std::thread::id>{}(std::this_thread::get_id()) % count;
+    default:
+      return this->next_entity_group.fetch_add(1, std::memory_order_relaxed) % count;
+  }
+}
+
+dds_Publisher *
+rmw_context_impl_s::get_publisher(size_t group) const
+{
+  return group == 0 ? this->publisher : this->publisher_groups[group - 1];
+}
+
+dds_Subscriber *
+rmw_context_impl_s::get_subscriber(size_t group) const
+{
+  return group == 0 ? this->subscriber : this->subscriber_groups[group - 1];
+}
+
 rmw_ret_t
 rmw_context_impl_s::finalize_participant()
 {
@@ -461,6 +620,52 @@ rmw_context_impl_s::finalize_participant()
     return RMW_RET_ERROR;
   }
 
+  /* Delete the other entity groups */
+  while (!this->publisher_groups.empty()) {
+    dds_Publisher * group_publisher = this->publisher_groups.back();
+    if (dds_RETCODE_OK != dds_Publisher_delete_contained_entities(group_publisher) ||
+      dds_RETCODE_OK != dds_DomainParticipant_delete_publisher(this->participant, group_publisher))
+    {
+      RMW_SET_ERROR_MSG("failed to delete publisher");
+      return RMW_RET_ERROR;
+    }
+    this->publisher_groups.pop_back();
+  }
+
+  while (!this->subscriber_groups.empty()) {
+    dds_Subscriber * group_subscriber = this->subscriber_groups.back();
+    if (dds_RETCODE_OK != dds_Subscriber_delete_contained_entities(group_subscriber) ||
+      dds_RETCODE_OK !=
+      dds_DomainParticipant_delete_subscriber(this->participant, group_subscriber))
+    {
+      RMW_SET_ERROR_MSG("failed to delete subscriber");
+      return RMW_RET_ERROR;
+    }
+    this->subscriber_groups.pop_back();
+  }
+
+  if (this->bulk_publisher != nullptr) {
+    if (dds_RETCODE_OK != dds_Publisher_delete_contained_entities(this->bulk_publisher) ||
+      dds_RETCODE_OK !=
+      dds_DomainParticipant_delete_publisher(this->participant, this->bulk_publisher))
+    {
+      RMW_SET_ERROR_MSG("failed to delete publisher");
+      return RMW_RET_ERROR;
+    }
+    this->bulk_publisher = nullptr;
+  }
+
+  if (this->bulk_subscriber != nullptr) {
+    if (dds_RETCODE_OK != dds_Subscriber_delete_contained_entities(this->bulk_subscriber) ||
+      dds_RETCODE_OK !=
+      dds_DomainParticipant_delete_subscriber(this->participant, this->bulk_subscriber))
+    {
+      RMW_SET_ERROR_MSG("failed to delete subscriber");
+      return RMW_RET_ERROR;
+    }
+    this->bulk_subscriber = nullptr;
+  }
+
   /* Delete publisher */
   if (this->publisher != nullptr) {
     if (dds_RETCODE_OK !=
@@ -497,6 +702,8 @@ rmw_context_impl_s::finalize_participant()
     this->subscriber = nullptr;
   }
 
+  this->type_registry.clear();
+
   /* Delete DomainParticipant */
   if (this->participant != nullptr) {
     dds_DomainParticipantFactory * factory = dds_DomainParticipantFactory_get_instance();
@@ -513,6 +720,7 @@ rmw_context_impl_s::finalize_participant()
       return RMW_RET_ERROR;
     }
     this->participant = nullptr;
+    this->flow_locators.clear();
   }
 
   RCUTILS_LOG_DEBUG_NAMED(
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include "rmw/error_handling.h"
@@ -23,11 +24,35 @@
 
 #include "rmw_dds_common/context.hpp"
 
+#include "rmw_gurumdds_cpp/graph_index.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
 #include "rmw_gurumdds_cpp/namespace_prefix.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 
+namespace rmw_gurumdds_cpp
+{
+// Counted from the graph snapshot, without taking the graph locks while nothing changed
+static rmw_ret_t
+count_entities(
+  const GraphIndex & index,
+  const std::string & topic_name,
+  bool is_reader,
+  size_t * count)
+{
+  std::shared_ptr<const GraphSnapshot> snapshot = index.get_snapshot();
+  if (snapshot == nullptr) {
+    // Error message already set
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  const auto & counts = is_reader ? snapshot->reader_counts : snapshot->writer_counts;
+  auto it = counts.find(topic_name);
+  *count = it != counts.end() ? it->second : 0;
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
+
 extern "C"
 {
 rmw_ret_t
@@ -57,11 +82,12 @@ rmw_count_publishers(
 
   RMW_CHECK_ARGUMENT_FOR_NULL(count, RMW_RET_INVALID_ARGUMENT);
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  const std::string mangled_topic_name = rmw_gurumdds_cpp::create_topic_name(
-    rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", false);
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string & mangled_topic_name = ctx->name_cache.mangle(
+    rmw_gurumdds_cpp::ros_topic_prefix, topic_name, storage);
 
-  return common_ctx->graph_cache.get_writer_count(mangled_topic_name, count);
+  return rmw_gurumdds_cpp::count_entities(ctx->graph_index, mangled_topic_name, false, count);
 }
 
 rmw_ret_t
@@ -91,11 +117,12 @@ rmw_count_subscribers(
 
   RMW_CHECK_ARGUMENT_FOR_NULL(count, RMW_RET_INVALID_ARGUMENT);
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  const std::string mangled_topic_name = rmw_gurumdds_cpp::create_topic_name(
-    rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", false);
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string & mangled_topic_name = ctx->name_cache.mangle(
+    rmw_gurumdds_cpp::ros_topic_prefix, topic_name, storage);
 
-  return common_ctx->graph_cache.get_reader_count(mangled_topic_name, count);
+  return rmw_gurumdds_cpp::count_entities(ctx->graph_index, mangled_topic_name, true, count);
 }
 
 rmw_ret_t
@@ -124,11 +151,12 @@ rmw_count_clients(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  const std::string mangled_service_name = rmw_gurumdds_cpp::create_topic_name(
-    rmw_gurumdds_cpp::ros_service_response_prefix, service_name, "", false);
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string & mangled_service_name = ctx->name_cache.mangle(
+    rmw_gurumdds_cpp::ros_service_response_prefix, service_name, storage);
 
-  return common_ctx->graph_cache.get_reader_count(mangled_service_name, count);
+  return rmw_gurumdds_cpp::count_entities(ctx->graph_index, mangled_service_name, true, count);
 }
 
 rmw_ret_t
@@ -157,10 +185,11 @@ rmw_count_services(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  const std::string mangled_service_name = rmw_gurumdds_cpp::create_topic_name(
-    rmw_gurumdds_cpp::ros_service_response_prefix, service_name, "", false);
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string & mangled_service_name = ctx->name_cache.mangle(
+    rmw_gurumdds_cpp::ros_service_response_prefix, service_name, storage);
 
-  return common_ctx->graph_cache.get_writer_count(mangled_service_name, count);
+  return rmw_gurumdds_cpp::count_entities(ctx->graph_index, mangled_service_name, false, count);
 }
 }  // extern "C"
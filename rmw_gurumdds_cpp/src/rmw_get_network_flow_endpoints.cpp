@@ -12,23 +12,69 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
+#include <algorithm>
+
+#include "rcutils/macros.h"
+
 #include "rmw/error_handling.h"
 #include "rmw/get_network_flow_endpoints.h"
+#include "rmw/impl/cpp/macros.hpp"
 #include "rmw/types.h"
 
+#include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/network_flow.hpp"
+#include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
+
 extern "C"
 {
+// The flows of an endpoint are the unicast locators of its participant. The DSCP of a
+// publisher is its transport priority, which can be set per topic by the QoS profile file
 rmw_ret_t
 rmw_publisher_get_network_flow_endpoints(
   const rmw_publisher_t * publisher,
   rcutils_allocator_t * allocator,
   rmw_network_flow_endpoint_array_t * network_flow_endpoint_array)
 {
-  RCUTILS_UNUSED(publisher);
-  RCUTILS_UNUSED(allocator);
-  RCUTILS_UNUSED(network_flow_endpoint_array);
-  RMW_SET_ERROR_MSG("rmw_publisher_get_network_flow_endpoint not implemented");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(network_flow_endpoint_array, RMW_RET_INVALID_ARGUMENT);
+  if (rmw_network_flow_endpoint_array_check_zero(network_flow_endpoint_array) != RMW_RET_OK) {
+    // Error message already set
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  rmw_gurumdds_cpp::PublisherInfo * publisher_info =
+    static_cast<rmw_gurumdds_cpp::PublisherInfo *>(publisher->data);
+  if (publisher_info == nullptr) {
+    RMW_SET_ERROR_MSG("publisher info handle is null");
+    return RMW_RET_ERROR;
+  }
+
+  dds_DataWriterQos dds_qos;
+  dds_ReturnCode_t ret = dds_DataWriter_get_qos(publisher_info->topic_writer, &dds_qos);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("publisher can't get data writer qos policies");
+    return RMW_RET_ERROR;
+  }
+  const uint8_t dscp = static_cast<uint8_t>(
+    std::min<int32_t>(
+      std::max<int32_t>(dds_qos.transport_priority.value, 0), NETWORK_FLOW_DSCP_MAX));
+  ret = dds_DataWriterQos_finalize(&dds_qos);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to finalize datawriter qos");
+    return RMW_RET_ERROR;
+  }
+
+  return rmw_gurumdds_cpp::fill_network_flow_endpoints(
+    publisher_info->ctx->flow_locators, dscp, allocator, network_flow_endpoint_array);
 }
 
 rmw_ret_t
@@ -37,10 +83,29 @@ rmw_subscription_get_network_flow_endpoints(
   rcutils_allocator_t * allocator,
   rmw_network_flow_endpoint_array_t * network_flow_endpoint_array)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(allocator);
-  RCUTILS_UNUSED(network_flow_endpoint_array);
-  RMW_SET_ERROR_MSG("rmw_subscription_get_network_flow_endpoint not implemented");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(network_flow_endpoint_array, RMW_RET_INVALID_ARGUMENT);
+  if (rmw_network_flow_endpoint_array_check_zero(network_flow_endpoint_array) != RMW_RET_OK) {
+    // Error message already set
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  rmw_gurumdds_cpp::SubscriberInfo * subscriber_info =
+    static_cast<rmw_gurumdds_cpp::SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("subscriber info handle is null");
+    return RMW_RET_ERROR;
+  }
+
+  // Readers send no data, their flows are unmarked
+  return rmw_gurumdds_cpp::fill_network_flow_endpoints(
+    subscriber_info->ctx->flow_locators, 0, allocator, network_flow_endpoint_array);
 }
 }   // extern "C"
@@ -53,17 +53,23 @@ rmw_get_publishers_info_by_topic(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  std::string mangled_topic_name = topic_name;
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string * mangled_topic_name = &storage;
   DemangleFunction demangle_type = rmw_gurumdds_cpp::identity_demangle;
   if (!no_mangle) {
-    mangled_topic_name = rmw_gurumdds_cpp::create_topic_name(rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", false);
+    mangled_topic_name =
+      &ctx->name_cache.mangle(rmw_gurumdds_cpp::ros_topic_prefix, topic_name, storage);
     demangle_type = rmw_gurumdds_cpp::demangle_if_ros_type;
+  } else {
+    storage = topic_name;
   }
 
-  return common_ctx->graph_cache.get_writers_info_by_topic(
-    mangled_topic_name,
+  return ctx->graph_index.get_entities_info_by_topic(
+    *mangled_topic_name,
     demangle_type,
+    false,
+    ctx->name_cache,
     allocator,
     publishers_info);
 }
@@ -91,17 +97,23 @@ rmw_get_subscriptions_info_by_topic(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  std::string mangled_topic_name = topic_name;
+  rmw_context_impl_t * ctx = node->context->impl;
+  std::string storage;
+  const std::string * mangled_topic_name = &storage;
   DemangleFunction demangle_type = rmw_gurumdds_cpp::identity_demangle;
   if (!no_mangle) {
-    mangled_topic_name = rmw_gurumdds_cpp::create_topic_name(rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", false);
+    mangled_topic_name =
+      &ctx->name_cache.mangle(rmw_gurumdds_cpp::ros_topic_prefix, topic_name, storage);
     demangle_type = rmw_gurumdds_cpp::demangle_if_ros_type;
+  } else {
+    storage = topic_name;
   }
 
-  return common_ctx->graph_cache.get_readers_info_by_topic(
-    mangled_topic_name,
+  return ctx->graph_index.get_entities_info_by_topic(
+    *mangled_topic_name,
     demangle_type,
+    true,
+    ctx->name_cache,
     allocator,
     subscriptions_info);
 }
@@ -12,13 +12,37 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <new>
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/rmw.h"
 
 #include "rmw_gurumdds_cpp/dds_include.hpp"
+#include "rmw_gurumdds_cpp/event_fd.hpp"
+#include "rmw_gurumdds_cpp/guard_condition.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+dds_ReturnCode_t clear_guard_condition(GuardCondition * guard_condition)
+{
+  // The flag is cleared first, a trigger racing with the clear is restored below
+  guard_condition->triggered.store(false, std::memory_order_release);
+  dds_ReturnCode_t ret = dds_GuardCondition_set_trigger_value(guard_condition->condition, false);
+  if (ret != dds_RETCODE_OK) {
+    return ret;
+  }
+
+  if (guard_condition->triggered.load(std::memory_order_acquire)) {
+    ret = dds_GuardCondition_set_trigger_value(guard_condition->condition, true);
+  }
+
+  return ret;
+}
+} // namespace rmw_gurumdds_cpp
 
 extern "C"
 {
@@ -42,17 +66,24 @@ rmw_create_guard_condition(rmw_context_t * context)
     return nullptr;
   }
 
-  dds_GuardCondition * dds_guard_condition = dds_GuardCondition_create();
-  if (dds_guard_condition == nullptr) {
+  auto gurumdds_guard_condition = new(std::nothrow) rmw_gurumdds_cpp::GuardCondition();
+  if (gurumdds_guard_condition == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate guard condition data");
+    goto fail;
+  }
+
+  gurumdds_guard_condition->condition = dds_GuardCondition_create();
+  if (gurumdds_guard_condition->condition == nullptr) {
     RMW_SET_ERROR_MSG("failed to create guard condition");
     goto fail;
   }
 
   guard_condition->implementation_identifier = RMW_GURUMDDS_ID;
-  guard_condition->data = dds_guard_condition;
+  guard_condition->data = gurumdds_guard_condition;
   return guard_condition;
 
 fail:
+  delete gurumdds_guard_condition;
   if (guard_condition != nullptr) {
     rmw_guard_condition_free(guard_condition);
   }
@@ -70,9 +101,12 @@ rmw_destroy_guard_condition(rmw_guard_condition_t * guard_condition)
     RMW_GURUMDDS_ID,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  dds_GuardCondition * dds_guard_condition =
-    static_cast<dds_GuardCondition *>(guard_condition->data);
-  dds_GuardCondition_delete(dds_guard_condition);
+  auto gurumdds_guard_condition =
+    static_cast<rmw_gurumdds_cpp::GuardCondition *>(guard_condition->data);
+  rmw_gurumdds_cpp::clean_wait_set_caches();
+  rmw_gurumdds_cpp::remove_guard_condition_event_fd(gurumdds_guard_condition->condition);
+  dds_GuardCondition_delete(gurumdds_guard_condition->condition);
+  delete gurumdds_guard_condition;
   rmw_guard_condition_free(guard_condition);
 
   return RMW_RET_OK;
@@ -88,12 +122,19 @@ rmw_trigger_guard_condition(const rmw_guard_condition_t * guard_condition)
     RMW_GURUMDDS_ID,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  dds_GuardCondition * dds_guard_condition =
-    static_cast<dds_GuardCondition *>(guard_condition->data);
-  dds_ReturnCode_t ret = dds_GuardCondition_set_trigger_value(dds_guard_condition, true);
-  if (ret != dds_RETCODE_OK) {
-    return RMW_RET_ERROR;
+  auto gurumdds_guard_condition =
+    static_cast<rmw_gurumdds_cpp::GuardCondition *>(guard_condition->data);
+  // Already triggered and not waited on since, the DDS trigger value is still set
+  if (!gurumdds_guard_condition->triggered.exchange(true, std::memory_order_acq_rel)) {
+    dds_ReturnCode_t ret =
+      dds_GuardCondition_set_trigger_value(gurumdds_guard_condition->condition, true);
+    if (ret != dds_RETCODE_OK) {
+      gurumdds_guard_condition->triggered.store(false, std::memory_order_release);
+      return RMW_RET_ERROR;
+    }
   }
+  // Event fds are notified on every trigger, their readers never clear the trigger value
+  rmw_gurumdds_cpp::notify_guard_condition_event_fd(gurumdds_guard_condition->condition);
 
   return RMW_RET_OK;
 }
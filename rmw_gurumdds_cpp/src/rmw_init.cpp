@@ -145,11 +145,260 @@ rmw_init(const rmw_init_options_t * options, rmw_context_t * context)
   char * mapping_env_value = nullptr;
   bool service_mapping_basic = false;
 
+  const char * threads_env = "RMW_GURUMDDS_DESERIALIZATION_THREADS";
+  const char * threshold_env = "RMW_GURUMDDS_DESERIALIZATION_THRESHOLD";
+  char * threads_env_value = nullptr;
+  char * threshold_env_value = nullptr;
+  size_t deserialization_threads = 0;
+  size_t deserialization_threshold = PARALLEL_DESERIALIZATION_THRESHOLD;
+
+  const char * polling_env = "RMW_GURUMDDS_WAIT_USE_POLLING";
+  const char * spin_env = "RMW_GURUMDDS_WAIT_SPIN_NS";
+  char * polling_env_value = nullptr;
+  char * spin_env_value = nullptr;
+  bool wait_use_polling = false;
+  uint64_t wait_spin_ns = 0;
+
+  const char * request_timeout_env = "RMW_GURUMDDS_REQUEST_TIMEOUT_MS";
+  char * request_timeout_env_value = nullptr;
+  uint64_t request_timeout_ns = 0;
+
+  const char * discovery_delay_env = "RMW_GURUMDDS_DISCOVERY_UPDATE_DELAY_MS";
+  char * discovery_delay_env_value = nullptr;
+  uint64_t discovery_update_delay_ns = 0;
+
+  const char * discovery_batch_env = "RMW_GURUMDDS_DISCOVERY_BATCH_SIZE";
+  char * discovery_batch_env_value = nullptr;
+  size_t discovery_batch_size = 0;
+
+  const char * graph_delay_env = "RMW_GURUMDDS_GRAPH_CHANGE_DELAY_MS";
+  char * graph_delay_env_value = nullptr;
+  uint64_t graph_change_delay_ns = 0;
+
+  const char * static_discovery_env = "RMW_GURUMDDS_STATIC_DISCOVERY_FILE";
+  char * static_discovery_env_value = nullptr;
+
+  const char * qos_profile_env = "RMW_GURUMDDS_QOS_PROFILE_FILE";
+  char * qos_profile_env_value = nullptr;
+
+  const char * listener_name_env = "RMW_GURUMDDS_LISTENER_THREAD_NAME";
+  const char * listener_affinity_env = "RMW_GURUMDDS_LISTENER_THREAD_AFFINITY";
+  const char * listener_policy_env = "RMW_GURUMDDS_LISTENER_THREAD_POLICY";
+  const char * listener_priority_env = "RMW_GURUMDDS_LISTENER_THREAD_PRIORITY";
+  const char * dds_affinity_env = "RMW_GURUMDDS_DDS_THREAD_AFFINITY";
+  const char * dds_policy_env = "RMW_GURUMDDS_DDS_THREAD_POLICY";
+  const char * dds_priority_env = "RMW_GURUMDDS_DDS_THREAD_PRIORITY";
+  char * listener_name_env_value = nullptr;
+  char * listener_affinity_env_value = nullptr;
+  char * listener_policy_env_value = nullptr;
+  char * listener_priority_env_value = nullptr;
+  char * dds_affinity_env_value = nullptr;
+  char * dds_policy_env_value = nullptr;
+  char * dds_priority_env_value = nullptr;
+  rmw_gurumdds_cpp::ThreadSettings listener_thread_settings;
+  listener_thread_settings.name = "gurumdds_listen";
+
+  const char * send_affinity_env = "RMW_GURUMDDS_PRIORITY_SEND_THREAD_AFFINITY";
+  const char * send_policy_env = "RMW_GURUMDDS_PRIORITY_SEND_THREAD_POLICY";
+  const char * send_priority_env = "RMW_GURUMDDS_PRIORITY_SEND_THREAD_PRIORITY";
+  char * send_affinity_env_value = nullptr;
+  char * send_policy_env_value = nullptr;
+  char * send_priority_env_value = nullptr;
+  rmw_gurumdds_cpp::ThreadSettings send_thread_settings;
+
+  const char * groups_env = "RMW_GURUMDDS_ENTITY_GROUPS";
+  const char * group_policy_env = "RMW_GURUMDDS_ENTITY_GROUP_POLICY";
+  char * groups_env_value = nullptr;
+  char * group_policy_env_value = nullptr;
+  size_t entity_group_count = 1;
+  int entity_group_policy = ENTITY_GROUP_ROUND_ROBIN;
+
+  const char * shm_env = "RMW_GURUMDDS_SHM_TRANSPORT";
+  const char * shm_segment_env = "RMW_GURUMDDS_SHM_SEGMENT_SIZE";
+  char * shm_env_value = nullptr;
+  char * shm_segment_env_value = nullptr;
+  int shm_transport = SHM_TRANSPORT_AUTO;
+
+  const char * intra_context_env = "RMW_GURUMDDS_INTRA_CONTEXT_DELIVERY";
+  char * intra_context_env_value = nullptr;
+  bool intra_context_delivery = false;
+
+  const char * buffer_memory_env = "RMW_GURUMDDS_BUFFER_MEMORY";
+  char * buffer_memory_env_value = nullptr;
+  int buffer_memory = BUFFER_MEMORY_HEAP;
+
+  const char * discovery_cache_env = "RMW_GURUMDDS_DISCOVERY_CACHE_FILE";
+  const char * discovery_cache_timeout_env = "RMW_GURUMDDS_DISCOVERY_CACHE_TIMEOUT";
+  char * discovery_cache_env_value = nullptr;
+  char * discovery_cache_timeout_env_value = nullptr;
+  uint64_t discovery_cache_timeout_ns = DISCOVERY_CACHE_CONFIRM_TIMEOUT_MS * 1000000ull;
+
+  const char * source_clock_env = "RMW_GURUMDDS_SOURCE_CLOCK";
+  char * source_clock_env_value = nullptr;
+  int source_clock = SOURCE_CLOCK_DDS;
+
   mapping_env_value = getenv(mapping_env);
   if (mapping_env_value != nullptr) {
     service_mapping_basic = (strcmp(mapping_env_value, "basic") == 0);
   }
 
+  threads_env_value = getenv(threads_env);
+  if (threads_env_value != nullptr) {
+    deserialization_threads = strtoul(threads_env_value, nullptr, 10);
+  }
+
+  threshold_env_value = getenv(threshold_env);
+  if (threshold_env_value != nullptr) {
+    deserialization_threshold = strtoul(threshold_env_value, nullptr, 10);
+  }
+
+  polling_env_value = getenv(polling_env);
+  if (polling_env_value != nullptr) {
+    wait_use_polling = (strcmp(polling_env_value, "1") == 0);
+  }
+
+  spin_env_value = getenv(spin_env);
+  if (spin_env_value != nullptr) {
+    wait_spin_ns = strtoull(spin_env_value, nullptr, 10);
+  }
+
+  request_timeout_env_value = getenv(request_timeout_env);
+  if (request_timeout_env_value != nullptr) {
+    request_timeout_ns = strtoull(request_timeout_env_value, nullptr, 10) * 1000000ull;
+  }
+
+  discovery_delay_env_value = getenv(discovery_delay_env);
+  if (discovery_delay_env_value != nullptr) {
+    discovery_update_delay_ns = strtoull(discovery_delay_env_value, nullptr, 10) * 1000000ull;
+  }
+
+  discovery_batch_env_value = getenv(discovery_batch_env);
+  if (discovery_batch_env_value != nullptr) {
+    discovery_batch_size = strtoul(discovery_batch_env_value, nullptr, 10);
+  }
+
+  graph_delay_env_value = getenv(graph_delay_env);
+  if (graph_delay_env_value != nullptr) {
+    graph_change_delay_ns = strtoull(graph_delay_env_value, nullptr, 10) * 1000000ull;
+  }
+
+  static_discovery_env_value = getenv(static_discovery_env);
+
+  qos_profile_env_value = getenv(qos_profile_env);
+
+  listener_name_env_value = getenv(listener_name_env);
+  if (listener_name_env_value != nullptr) {
+    listener_thread_settings.name = listener_name_env_value;
+  }
+
+  listener_affinity_env_value = getenv(listener_affinity_env);
+  if (listener_affinity_env_value != nullptr &&
+    !rmw_gurumdds_cpp::ThreadSettings::parse_cpus(
+      listener_affinity_env_value, listener_thread_settings.cpus))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring malformed %s: %s", listener_affinity_env,
+      listener_affinity_env_value);
+    listener_thread_settings.cpus.clear();
+  }
+
+  listener_policy_env_value = getenv(listener_policy_env);
+  if (listener_policy_env_value != nullptr &&
+    !rmw_gurumdds_cpp::ThreadSettings::parse_policy(
+      listener_policy_env_value, listener_thread_settings.policy))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring unknown %s: %s", listener_policy_env, listener_policy_env_value);
+  }
+
+  listener_priority_env_value = getenv(listener_priority_env);
+  if (listener_priority_env_value != nullptr) {
+    listener_thread_settings.priority =
+      static_cast<int>(strtol(listener_priority_env_value, nullptr, 10));
+  }
+
+  send_affinity_env_value = getenv(send_affinity_env);
+  if (send_affinity_env_value != nullptr &&
+    !rmw_gurumdds_cpp::ThreadSettings::parse_cpus(
+      send_affinity_env_value, send_thread_settings.cpus))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring malformed %s: %s", send_affinity_env, send_affinity_env_value);
+    send_thread_settings.cpus.clear();
+  }
+
+  send_policy_env_value = getenv(send_policy_env);
+  if (send_policy_env_value != nullptr &&
+    !rmw_gurumdds_cpp::ThreadSettings::parse_policy(
+      send_policy_env_value, send_thread_settings.policy))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring unknown %s: %s", send_policy_env, send_policy_env_value);
+  }
+
+  send_priority_env_value = getenv(send_priority_env);
+  if (send_priority_env_value != nullptr) {
+    send_thread_settings.priority =
+      static_cast<int>(strtol(send_priority_env_value, nullptr, 10));
+  }
+
+  dds_affinity_env_value = getenv(dds_affinity_env);
+  dds_policy_env_value = getenv(dds_policy_env);
+  dds_priority_env_value = getenv(dds_priority_env);
+
+  groups_env_value = getenv(groups_env);
+  if (groups_env_value != nullptr && strtoul(groups_env_value, nullptr, 10) > 0) {
+    entity_group_count = strtoul(groups_env_value, nullptr, 10);
+  }
+
+  group_policy_env_value = getenv(group_policy_env);
+  if (group_policy_env_value != nullptr) {
+    if (strcmp(group_policy_env_value, "topic") == 0) {
+      entity_group_policy = ENTITY_GROUP_BY_TOPIC;
+    } else if (strcmp(group_policy_env_value, "thread") == 0) {
+      entity_group_policy = ENTITY_GROUP_BY_THREAD;
+    }
+  }
+
+  shm_env_value = getenv(shm_env);
+  if (shm_env_value != nullptr) {
+    if (strcmp(shm_env_value, "1") == 0) {
+      shm_transport = SHM_TRANSPORT_ON;
+    } else if (strcmp(shm_env_value, "0") == 0) {
+      shm_transport = SHM_TRANSPORT_OFF;
+    }
+  }
+
+  shm_segment_env_value = getenv(shm_segment_env);
+
+  intra_context_env_value = getenv(intra_context_env);
+  if (intra_context_env_value != nullptr) {
+    intra_context_delivery = (strcmp(intra_context_env_value, "1") == 0);
+  }
+
+  buffer_memory_env_value = getenv(buffer_memory_env);
+  if (buffer_memory_env_value != nullptr &&
+    !rmw_gurumdds_cpp::parse_buffer_memory(buffer_memory_env_value, buffer_memory))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring unknown %s: %s", buffer_memory_env, buffer_memory_env_value);
+  }
+
+  discovery_cache_env_value = getenv(discovery_cache_env);
+  discovery_cache_timeout_env_value = getenv(discovery_cache_timeout_env);
+  if (discovery_cache_timeout_env_value != nullptr) {
+    discovery_cache_timeout_ns =
+      strtoull(discovery_cache_timeout_env_value, nullptr, 10) * 1000000ull;
+  }
+
+  source_clock_env_value = getenv(source_clock_env);
+  if (source_clock_env_value != nullptr &&
+    !rmw_gurumdds_cpp::parse_source_clock(source_clock_env_value, source_clock))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "ignoring unknown %s: %s", source_clock_env, source_clock_env_value);
+  }
+
   context->instance_id = options->instance_id;
   context->implementation_identifier = RMW_GURUMDDS_ID;
   context->actual_domain_id = RMW_DEFAULT_DOMAIN_ID != options->domain_id ? options->domain_id : 0u;
@@ -160,6 +409,66 @@ rmw_init(const rmw_init_options_t * options, rmw_context_t * context)
   }
   context->impl->is_shutdown = false;
   context->impl->service_mapping_basic = service_mapping_basic;
+  context->impl->parallel_deserialization_threshold = deserialization_threshold;
+  context->impl->wait_use_polling = wait_use_polling;
+  context->impl->wait_spin_ns = wait_spin_ns;
+  context->impl->request_timeout_ns = request_timeout_ns;
+  context->impl->discovery_update_delay_ns = discovery_update_delay_ns;
+  context->impl->discovery_batch_size = discovery_batch_size;
+  context->impl->graph_change_delay_ns = graph_change_delay_ns;
+  if (static_discovery_env_value != nullptr) {
+    context->impl->static_discovery_file = static_discovery_env_value;
+  }
+  if (qos_profile_env_value != nullptr) {
+    context->impl->qos_profile_file = qos_profile_env_value;
+  }
+  context->impl->listener_thread_settings = listener_thread_settings;
+  context->impl->send_thread_settings = send_thread_settings;
+  if (dds_affinity_env_value != nullptr) {
+    context->impl->dds_thread_affinity = dds_affinity_env_value;
+  }
+  if (dds_policy_env_value != nullptr) {
+    context->impl->dds_thread_policy = dds_policy_env_value;
+  }
+  if (dds_priority_env_value != nullptr) {
+    context->impl->dds_thread_priority = dds_priority_env_value;
+  }
+  context->impl->entity_group_count = entity_group_count;
+  context->impl->entity_group_policy = entity_group_policy;
+  context->impl->shm_transport = shm_transport;
+  context->impl->buffer_memory = buffer_memory;
+  context->impl->source_clock = source_clock;
+  if (shm_segment_env_value != nullptr && strtoul(shm_segment_env_value, nullptr, 10) > 0) {
+    context->impl->shm_segment_size = shm_segment_env_value;
+  }
+  if (intra_context_delivery) {
+    context->impl->intra_context.reset(new (std::nothrow) rmw_gurumdds_cpp::IntraContextDelivery());
+    if (context->impl->intra_context == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate intra-context delivery");
+      ret = RMW_RET_BAD_ALLOC;
+      goto fail;
+    }
+  }
+  if (discovery_cache_env_value != nullptr && discovery_cache_env_value[0] != '\0') {
+    context->impl->discovery_cache.reset(
+      new (std::nothrow) rmw_gurumdds_cpp::DiscoveryCache(
+        discovery_cache_env_value, discovery_cache_timeout_ns));
+    if (context->impl->discovery_cache == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate discovery cache");
+      ret = RMW_RET_BAD_ALLOC;
+      goto fail;
+    }
+  }
+  if (deserialization_threads > 0) {
+    context->impl->deserialization_workers.reset(new (std::nothrow) rmw_gurumdds_cpp::WorkerPool());
+    if (context->impl->deserialization_workers == nullptr ||
+      !context->impl->deserialization_workers->start(deserialization_threads))
+    {
+      // Batches are still deserialized, only on the calling thread
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "failed to start deserialization threads");
+      context->impl->deserialization_workers.reset();
+    }
+  }
 
   ret = rmw_init_options_copy(options, &context->options);
   if (ret != RMW_RET_OK) {
@@ -36,7 +36,7 @@
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 
 using GetNamesAndTypesByNodeFunction = rmw_ret_t (*)(
-  rmw_dds_common::Context *,
+  rmw_context_impl_t *,
   const std::string &,
   const std::string &,
   DemangleFunction,
@@ -88,13 +88,12 @@ get_topic_names_and_types_by_node(
   if (RMW_RET_OK != ret) {
     return ret;
   }
-  auto common_ctx = &node->context->impl->common_ctx;
   if (no_demangle) {
     demangle_topic = rmw_gurumdds_cpp::identity_demangle;
     demangle_type = rmw_gurumdds_cpp::identity_demangle;
   }
   return get_names_and_types_by_node(
-    common_ctx,
+    node->context->impl,
     node_name,
     node_namespace,
     demangle_topic,
@@ -105,7 +104,7 @@ get_topic_names_and_types_by_node(
 
 static inline rmw_ret_t
 get_reader_names_and_types_by_node(
-  rmw_dds_common::Context * common_context,
+  rmw_context_impl_t * ctx,
   const std::string & node_name,
   const std::string & node_namespace,
   DemangleFunction demangle_topic,
@@ -113,18 +112,20 @@ get_reader_names_and_types_by_node(
   rcutils_allocator_t * allocator,
   rmw_names_and_types_t * topic_names_and_types)
 {
-  return common_context->graph_cache.get_reader_names_and_types_by_node(
+  return ctx->graph_index.get_names_and_types_by_node(
     node_name,
     node_namespace,
     demangle_topic,
     demangle_type,
+    true,
+    ctx->name_cache,
     allocator,
     topic_names_and_types);
 }
 
 static inline rmw_ret_t
 get_writer_names_and_types_by_node(
-  rmw_dds_common::Context * common_context,
+  rmw_context_impl_t * ctx,
   const std::string & node_name,
   const std::string & node_namespace,
   DemangleFunction demangle_topic,
@@ -132,11 +133,13 @@ get_writer_names_and_types_by_node(
   rcutils_allocator_t * allocator,
   rmw_names_and_types_t * topic_names_and_types)
 {
-  return common_context->graph_cache.get_writer_names_and_types_by_node(
+  return ctx->graph_index.get_names_and_types_by_node(
     node_name,
     node_namespace,
     demangle_topic,
     demangle_type,
+    false,
+    ctx->name_cache,
     allocator,
     topic_names_and_types);
 }
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
 
@@ -23,6 +25,7 @@
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/macros.hpp"
+#include "rmw/time.h"
 #include "rmw/types.h"
 #include "rmw/validate_full_topic_name.h"
 
@@ -30,6 +33,8 @@
 
 #include "tracetools/tracetools.h"
 
+#include "rmw_gurumdds_cpp/async_publish.hpp"
+#include "rmw_gurumdds_cpp/compression.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
@@ -38,13 +43,29 @@
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/gid.hpp"
 #include "rmw_gurumdds_cpp/rmw_publisher.hpp"
+#include "rmw_gurumdds_cpp/source_clock.hpp"
+#include "rmw_gurumdds_cpp/timestamped_publish.hpp"
+#include "rmw_gurumdds_cpp/thread_settings.hpp"
 #include "rmw_gurumdds_cpp/type_support.hpp"
 #include "rmw_gurumdds_cpp/type_support_common.hpp"
 #include "rmw_gurumdds_cpp/type_support_service.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
+#include "rmw_gurumdds_cpp/warm_up.hpp"
 
 namespace rmw_gurumdds_cpp
 {
+// Samples of a writer with these policies reach a local reader the same way without DDS
+static bool can_deliver_locally(const dds_DataWriterQos & qos)
+{
+  return qos.durability.kind == dds_VOLATILE_DURABILITY_QOS &&
+         qos.liveliness.kind == dds_AUTOMATIC_LIVELINESS_QOS &&
+         qos.deadline.period.sec == dds_DURATION_INFINITE_SEC &&
+         qos.deadline.period.nanosec == dds_DURATION_INFINITE_NSEC &&
+         qos.lifespan.duration.sec == dds_DURATION_INFINITE_SEC &&
+         qos.lifespan.duration.nanosec == dds_DURATION_INFINITE_NSEC;
+}
+
 rmw_publisher_t *
 create_publisher(
   rmw_context_impl_t * const ctx,
@@ -57,8 +78,6 @@ create_publisher(
   const rmw_publisher_options_t * publisher_options,
   const bool internal)
 {
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
-
   const rosidl_message_type_support_t * type_support =
     get_message_typesupport_handle(type_supports, rosidl_typesupport_introspection_c__identifier);
   if (type_support == nullptr) {
@@ -78,30 +97,29 @@ create_publisher(
   dds_DataWriterQos datawriter_qos;
   dds_Topic * topic = nullptr;
   dds_TopicDescription * topic_desc = nullptr;
-  dds_TypeSupport * dds_typesupport = nullptr;
   dds_ReturnCode_t ret;
 
-  std::string type_name =
-    create_type_name(type_support->data, type_support->typesupport_identifier);
-  if (type_name.empty()) {
-    // Error message is already set
-    return nullptr;
-  }
-
   std::string processed_topic_name = rmw_gurumdds_cpp::create_topic_name(
     rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", qos_policies);
 
-  std::string metastring =
-    create_metastring(type_support->data, type_support->typesupport_identifier);
-  if (metastring.empty()) {
+  // Released once the writer holds the topic, before the graph is updated
+  TopicLockGuard topic_guard;
+  topic_guard.lock(ctx->topic_locks, processed_topic_name);
+
+  // The type name, the dds_TypeSupport and the plan are shared by the endpoints of the type
+  const TypeSupportRegistry::Entry * registered_type =
+    ctx->type_registry.acquire(participant, type_support);
+  if (registered_type == nullptr) {
     // Error message is already set
     return nullptr;
   }
+  auto scope_exit_type_release = rcpputils::make_scope_exit(
+    [ctx, type_support]() {
+      ctx->type_registry.release(type_support);
+    });
 
-  dds_typesupport = create_type_support_and_register(participant, type_support, type_name, metastring);
-  if (dds_typesupport == nullptr) {
-    return nullptr;
-  }
+  const std::string & type_name = registered_type->type_name;
+  const MessagePlan * message_plan = registered_type->plan;
 
   topic_desc = dds_DomainParticipant_lookup_topicdescription(
     participant, processed_topic_name.c_str());
@@ -144,6 +162,50 @@ create_publisher(
     // Error message already set
     return nullptr;
   }
+  ctx->qos_profiles.apply(topic_name, datawriter_qos);
+
+  // GurumDDS picks the locators of the topic from the RTPS_LOCATOR_POLICY_PROPERTY of the
+  // participant, the ones it does not support were reported when it was created
+  const LocatorSettings locator_settings = ctx->qos_profiles.get_locator_settings(topic_name);
+  if (!internal && !ctx->locator_policy.empty()) {
+    if (locator_settings.policy == LOCATOR_POLICY_AUTO) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        RMW_GURUMDDS_ID, "'%s' is sent to multicast locators from %zu matched readers on",
+        topic_name, locator_settings.multicast_min_readers);
+    } else if (locator_settings.policy != LOCATOR_POLICY_DEFAULT) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        RMW_GURUMDDS_ID, "'%s' is sent to %s locators", topic_name,
+        get_locator_policy_name(locator_settings.policy));
+    }
+  }
+
+  // Writers that compress advertise it, readers can tell their samples apart anyway
+  const CompressionSettings compression_settings =
+    internal ? CompressionSettings{} : ctx->qos_profiles.get_compression_settings(topic_name);
+  bool compressed = compression_settings.enabled();
+  if (compressed && !is_compression_supported()) {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "rmw_gurumdds_cpp was built without LZ4, '%s' is not compressed",
+      topic_name);
+    compressed = false;
+  }
+  if (compressed && datawriter_qos.durability.kind != dds_VOLATILE_DURABILITY_QOS) {
+    // Readers matched later get the samples of the history, whether or not they can decompress
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "'%s' is not compressed, its writer keeps samples for late readers",
+      topic_name);
+    compressed = false;
+  }
+  if (compressed &&
+    !append_user_data(&datawriter_qos.user_data, COMPRESSION_USER_DATA_KEY, COMPRESSION_LZ4))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "no room in the user data of '%s' to advertise compression", topic_name);
+    compressed = false;
+  }
+
+  const bool local_delivery =
+    ctx->intra_context != nullptr && !internal && can_deliver_locally(datawriter_qos);
 
   topic_writer = dds_Publisher_create_datawriter(pub, topic, &datawriter_qos, nullptr, 0);
   if (topic_writer == nullptr) {
@@ -196,18 +258,24 @@ create_publisher(
   publisher_info->topic_writer = topic_writer;
   publisher_info->topic_listener = listener;
   publisher_info->rosidl_message_typesupport = type_support;
+  publisher_info->message_plan = message_plan;
+  publisher_info->message_buffers.set_memory(ctx->buffer_memory);
+  publisher_info->local_buffers.set_memory(ctx->buffer_memory);
+  if (LoanedMessagePool::can_loan(message_plan) &&
+    !publisher_info->loan_pool.init(message_plan, LOANED_MESSAGE_POOL_SIZE, ctx->buffer_memory))
+  {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message pool");
+    return nullptr;
+  }
   publisher_info->implementation_identifier = RMW_GURUMDDS_ID;
   publisher_info->sequence_number = 0;
   publisher_info->ctx = ctx;
-  publisher_info->event_guard_cond[RMW_EVENT_LIVELINESS_LOST] = dds_GuardCondition_create();
-  publisher_info->event_guard_cond[RMW_EVENT_OFFERED_DEADLINE_MISSED] = dds_GuardCondition_create();
-  publisher_info->event_guard_cond[RMW_EVENT_OFFERED_QOS_INCOMPATIBLE] = dds_GuardCondition_create();
-  publisher_info->event_guard_cond[RMW_EVENT_PUBLISHER_INCOMPATIBLE_TYPE] = dds_GuardCondition_create();
-  publisher_info->event_guard_cond[RMW_EVENT_PUBLICATION_MATCHED] = dds_GuardCondition_create();
+  publisher_info->local_delivery = local_delivery;
   dds_TypeSupport* reader_dds_type = dds_DataWriter_get_typesupport(topic_writer);
-  set_type_support_ops(reader_dds_type, type_support);
+  set_type_support_ops(reader_dds_type, message_plan);
 
   TopicEventListener::add_event(topic, publisher_info);
+  topic_guard.unlock();
 
   rmw_gurumdds_cpp::entity_get_gid(
     reinterpret_cast<dds_Entity *>(publisher_info->topic_writer),
@@ -241,7 +309,7 @@ create_publisher(
     topic_name,
     strlen(topic_name) + 1);
   rmw_publisher->options = *publisher_options;
-  rmw_publisher->can_loan_messages = false;
+  rmw_publisher->can_loan_messages = publisher_info->loan_pool.is_enabled();
 
   if (!internal) {
     if (rmw_gurumdds_cpp::graph_cache::on_publisher_created(ctx, node, publisher_info) != RMW_RET_OK) {
@@ -250,9 +318,67 @@ create_publisher(
     }
   }
 
-  dds_TypeSupport_delete(dds_typesupport);
-  dds_typesupport = nullptr;
+  std::unique_lock<std::mutex> threads_lock{ctx->publish_threads_mutex};
+  const AsyncPublishSettings async_settings =
+    ctx->qos_profiles.get_async_publish_settings(topic_name);
+  if (!internal && async_settings.enabled()) {
+    const int lane = async_settings.priority;
+    std::unique_ptr<AsyncPublishSender> & sender = ctx->async_senders[lane];
+    if (sender == nullptr) {
+      ThreadSettings thread_settings;
+      thread_settings.name = "gurumdds_send";
+      if (lane > 0) {
+        thread_settings = ctx->send_thread_settings;
+        thread_settings.name = "gurumdds_send" + std::to_string(lane);
+        if (thread_settings.priority > 0) {
+          thread_settings.priority += lane - 1;
+        }
+      }
+      sender.reset(new(std::nothrow) AsyncPublishSender(thread_settings));
+      if (sender == nullptr || !sender->start()) {
+        RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "failed to start asynchronous publish thread");
+        sender.reset();
+      }
+    }
+    if (sender != nullptr) {
+      std::unique_ptr<AsyncPublisher> async{new(std::nothrow) AsyncPublisher(
+          topic_writer, &publisher_info->message_buffers, async_settings, sender.get())};
+      if (async == nullptr || !async->init()) {
+        // Samples are still published, on the thread that publishes them
+        RCUTILS_LOG_WARN_NAMED(
+          RMW_GURUMDDS_ID, "failed to allocate asynchronous publish queue of '%s'", topic_name);
+      } else {
+        RCUTILS_LOG_DEBUG_NAMED(
+          RMW_GURUMDDS_ID, "flow controller of '%s': lane=%d, bytes_per_second=%llu, burst=%zu",
+          topic_name, lane, static_cast<unsigned long long>(async_settings.bytes_per_second),
+          async_settings.burst_bytes);
+        sender->add(async.get());
+        publisher_info->async = std::move(async);
+      }
+    }
+  }
+  threads_lock.unlock();
+
+  if (compressed) {
+    publisher_info->compressor.reset(new(std::nothrow) PayloadCompressor(compression_settings));
+    if (publisher_info->compressor == nullptr) {
+      // Samples are still published, uncompressed
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to allocate payload compressor of '%s'", topic_name);
+    }
+  }
+
+  if (local_delivery) {
+    // The matched readers are kept as they go, see IntraContextDelivery
+    publisher_info->internal_mask = dds_PUBLICATION_MATCHED_STATUS;
+    publisher_info->mask = publisher_info->internal_mask;
+    publisher_info->callback_mask = publisher_info->mask;
+    dds_DataWriter_set_listener(
+      topic_writer, &publisher_info->topic_listener, publisher_info->mask);
+    ctx->intra_context->add_publisher(publisher_info);
+  }
 
+  scope_exit_type_release.cancel();
   scope_exit_rmw_publisher_delete.cancel();
 
   rmw_gid_t gid;
@@ -267,24 +393,43 @@ destroy_publisher(
   rmw_context_impl_t * const ctx,
   rmw_publisher_t * const publisher)
 {
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
-
   auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
   if (publisher_info == nullptr) {
     RMW_SET_ERROR_MSG("invalid publisher data");
     return RMW_RET_ERROR;
   }
 
+  // Event wait sets may still hold the status condition and the event guard conditions
+  clean_wait_set_caches();
+
   dds_ReturnCode_t ret;
+  std::unique_lock<std::mutex> threads_lock{ctx->publish_threads_mutex};
+  if (publisher_info->async != nullptr) {
+    ctx->async_senders[publisher_info->async->get_priority()]->remove(
+      publisher_info->async.get());
+  }
+  threads_lock.unlock();
+
+  if (publisher_info->async != nullptr) {
+    // The samples still queued are written by this thread
+    while (publisher_info->async->flush()) {
+    }
+    publisher_info->async.reset();
+  }
+
   if (publisher_info->topic_writer != nullptr) {
     dds_Topic * topic = dds_DataWriter_get_topic(publisher_info->topic_writer);
-    ret = dds_Publisher_delete_datawriter(ctx->publisher, publisher_info->topic_writer);
+    TopicLockGuard topic_guard;
+    topic_guard.lock(ctx->topic_locks, dds_Topic_get_name(topic));
+    ret = dds_Publisher_delete_datawriter(
+      dds_DataWriter_get_publisher(publisher_info->topic_writer), publisher_info->topic_writer);
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("failed to delete datawriter");
       return RMW_RET_ERROR;
     }
     publisher_info->topic_writer = nullptr;
     TopicEventListener::remove_event(topic, publisher_info);
+    TopicEventListener * topic_listener = TopicEventListener::get_listener(topic);
 
     ret = dds_DomainParticipant_delete_topic(ctx->participant, topic);
     if (ret == dds_RETCODE_PRECONDITION_NOT_MET) {
@@ -293,143 +438,313 @@ destroy_publisher(
       RMW_SET_ERROR_MSG("failed to delete topic");
       return RMW_RET_ERROR;
     } else {
-      TopicEventListener::disassociate_Listener(topic);
+      TopicEventListener::disassociate_listener(topic_listener);
     }
   }
 
-  for(auto condition: publisher_info->event_guard_cond) {
+  if (publisher_info->local_delivery) {
+    ctx->intra_context->remove_publisher(publisher_info);
+  }
+
+  for(dds_GuardCondition * condition: publisher_info->event_guard_cond) {
     if(nullptr != condition) {
       dds_GuardCondition_delete(condition);
     }
   }
 
+  ctx->type_registry.release(publisher_info->rosidl_message_typesupport);
   delete publisher_info;
   publisher->data = nullptr;
 
   return RMW_RET_OK;
 }
 
-rmw_ret_t publish(
-  const char* identifier,
-  const rmw_publisher_t* publisher,
-  const void* ros_message,
-  rmw_publisher_allocation_t* allocation) {
-  RCUTILS_UNUSED(allocation);
-  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
-    publisher,
-    identifier,
-    RMW_GURUMDDS_ID,
-    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-
-
-  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
-  RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
-
-  dds_DataWriter * topic_writer = publisher_info->topic_writer;
-  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_writer, RMW_RET_ERROR);
-
-  const rosidl_message_type_support_t * rosidl_typesupport =
-    publisher_info->rosidl_message_typesupport;
-  if (rosidl_typesupport == nullptr) {
-    RMW_SET_ERROR_MSG("rosidl typesupport handle is null");
-    return RMW_RET_ERROR;
+// Hands the sample to the asynchronous queue or the writer of the publisher
+static rmw_ret_t write_dds_sample(
+  const rmw_publisher_t * publisher,
+  PublisherInfo * publisher_info,
+  const void * dds_message,
+  size_t size,
+  dds_SampleInfoEx & sampleinfo_ex,
+  MessageBuffer ** owned_buffer)
+{
+  if (publisher_info->async != nullptr) {
+    MessageBuffer * buffer = nullptr;
+    if (owned_buffer != nullptr && *owned_buffer != nullptr) {
+      buffer = *owned_buffer;
+      *owned_buffer = nullptr;
+    } else {
+      buffer = publisher_info->message_buffers.acquire();
+      if (buffer == nullptr || buffer->grow(size) == nullptr) {
+        if (buffer != nullptr) {
+          publisher_info->message_buffers.release(buffer);
+        }
+        RMW_SET_ERROR_MSG("failed to allocate message buffer");
+        return RMW_RET_BAD_ALLOC;
+      }
+      std::memcpy(buffer->data(), dds_message, size);
+    }
+    return publisher_info->async->enqueue(buffer, size, sampleinfo_ex);
   }
 
-  size_t size = 0;
-  void * dds_message = allocate_message(
-    rosidl_typesupport->data,
-    rosidl_typesupport->typesupport_identifier,
-    ros_message,
-    &size,
-    false
-  );
+  dds_ReturnCode_t ret = dds_DataWriter_raw_write_w_sampleinfoex(
+      publisher_info->topic_writer, dds_message, static_cast<uint32_t>(size), &sampleinfo_ex);
 
-  if (dds_message == nullptr) {
-    // Error message already set
+  if (ret != dds_RETCODE_OK) {
+    std::stringstream errmsg;
+    errmsg << "failed to publish data: " << dds_ReturnCode_to_string(ret) << ", " << ret;
+    RMW_SET_ERROR_MSG(errmsg.str().c_str());
     return RMW_RET_ERROR;
   }
 
-  bool result = serialize_ros_to_cdr(
-    rosidl_typesupport->data,
-    rosidl_typesupport->typesupport_identifier,
-    ros_message,
-    dds_message,
-    size
-  );
-  if (!result) {
-    RMW_SET_ERROR_MSG("failed to serialize message");
-    free(dds_message);
-    return RMW_RET_ERROR;
-  }
+  RCUTILS_LOG_DEBUG_NAMED(RMW_GURUMDDS_ID, "Published data on topic %s", publisher->topic_name);
+
+  return RMW_RET_OK;
+}
 
+// owned_buffer is the pooled buffer dds_message is in, which the asynchronous queue may take.
+// serialization_ns is the time dds_message took to serialize, counted in the publisher stats.
+// Without a source_timestamp the sample is stamped by the source clock of the context
+static rmw_ret_t write_sample(
+  const rmw_publisher_t * publisher,
+  PublisherInfo * publisher_info,
+  const void * source,
+  const void * dds_message,
+  size_t size,
+  uint64_t serialization_ns,
+  const dds_Time_t * source_timestamp = nullptr,
+  MessageBuffer ** owned_buffer = nullptr)
+{
   dds_SampleInfoEx sampleinfo_ex;
   std::memset(&sampleinfo_ex, 0, sizeof(dds_SampleInfoEx));
-  ros_sn_to_dds_sn(++publisher_info->sequence_number, &sampleinfo_ex.seq);
+  // Numbered in the order of the samples handed to the subscriptions of the context
+  const int64_t sequence_number = publisher_info->local_delivery ?
+    publisher_info->ctx->intra_context->number_dds_sample(publisher_info) :
+    publisher_info->sequence_number.fetch_add(1, std::memory_order_relaxed) + 1;
+  ros_sn_to_dds_sn(sequence_number, &sampleinfo_ex.seq);
   rmw_gurumdds_cpp::ros_guid_to_dds_guid(
       reinterpret_cast<const uint8_t *>(publisher_info->publisher_gid.data),
       reinterpret_cast<uint8_t *>(&sampleinfo_ex.src_guid));
 
-  dds_Time_get_current_time(&sampleinfo_ex.info.source_timestamp);
+  if (source_timestamp != nullptr) {
+    sampleinfo_ex.info.source_timestamp = *source_timestamp;
+  } else {
+    get_source_time(publisher_info->ctx->source_clock, &sampleinfo_ex.info.source_timestamp);
+  }
   TRACETOOLS_TRACEPOINT(
     rmw_publish,
     static_cast<const void *>(publisher),
-    ros_message,
+    source,
     rmw_gurumdds_cpp::dds_time_to_i64(sampleinfo_ex.info.source_timestamp)
   );
 
-  dds_ReturnCode_t ret = dds_DataWriter_raw_write_w_sampleinfoex(
-      topic_writer, dds_message, size, &sampleinfo_ex);
+  const uint64_t write_start_ns = stats_time_ns();
+  MessageBuffer * compressed_buffer = nullptr;
+  PayloadCompressor * compressor = publisher_info->compressor.get();
+  if (compressor != nullptr && compressor->should_compress(publisher_info->topic_writer, size)) {
+    compressed_buffer = publisher_info->message_buffers.acquire();
+    size_t compressed_size = 0;
+    if (compressed_buffer != nullptr &&
+      compressed_buffer->grow(compressor->get_max_compressed_size(size)) != nullptr)
+    {
+      compressed_size = compressor->compress(
+        dds_message, size, compressed_buffer->data(), compressed_buffer->capacity());
+    }
+    if (compressed_size > 0) {
+      // The source buffer stays with the caller, the queue may take the compressed one
+      dds_message = compressed_buffer->data();
+      size = compressed_size;
+      owned_buffer = &compressed_buffer;
+    }
+  }
 
-  if (ret != dds_RETCODE_OK) {
-    std::stringstream errmsg;
-    errmsg << "failed to publish data: " << dds_ReturnCode_to_string(ret) << ", " << ret;
-    RMW_SET_ERROR_MSG(errmsg.str().c_str());
-    free(dds_message);
-    return RMW_RET_ERROR;
+  rmw_ret_t ret =
+    write_dds_sample(publisher, publisher_info, dds_message, size, sampleinfo_ex, owned_buffer);
+  if (compressed_buffer != nullptr) {
+    publisher_info->message_buffers.release(compressed_buffer);
+  }
+  publisher_info->stats.on_write(size, serialization_ns, stats_time_ns() - write_start_ns);
+  if (ret != RMW_RET_OK) {
+    publisher_info->stats.on_drop();
   }
 
-  RCUTILS_LOG_DEBUG_NAMED(RMW_GURUMDDS_ID, "Published data on topic %s", publisher->topic_name);
+  return ret;
+}
+
+// Hands the serialized sample to the subscriptions of the context, writing it to DDS if they
+// changed. source is the message the sample was serialized from, for the trace
+static rmw_ret_t deliver_local(
+  const rmw_publisher_t * publisher,
+  PublisherInfo * publisher_info,
+  const void * source,
+  const std::shared_ptr<MessageBuffer> & message_buffer,
+  size_t size,
+  uint64_t serialization_ns,
+  uint64_t generation,
+  const dds_Time_t * source_timestamp)
+{
+  const uint64_t deliver_start_ns = stats_time_ns();
+  dds_Time_t now;
+  get_source_time(publisher_info->ctx->source_clock, &now);
+
+  LocalSample sample;
+  sample.buffer = message_buffer;
+  sample.size = size;
+  sample.sequence_number = 0;
+  sample.source_timestamp = dds_time_to_i64(source_timestamp != nullptr ? *source_timestamp : now);
+  sample.received_timestamp = dds_time_to_i64(now);
+  sample.publisher_gid = publisher_info->publisher_gid;
+  if (!publisher_info->ctx->intra_context->deliver(publisher_info, generation, sample)) {
+    return write_sample(
+      publisher, publisher_info, source, message_buffer->data(), size, serialization_ns,
+      source_timestamp);
+  }
+  publisher_info->stats.on_write(size, serialization_ns, stats_time_ns() - deliver_start_ns);
 
-  free(dds_message);
+  TRACETOOLS_TRACEPOINT(
+    rmw_publish,
+    static_cast<const void *>(publisher),
+    source,
+    sample.source_timestamp
+  );
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID, "Handed data over to local subscriptions on topic %s", publisher->topic_name);
 
   return RMW_RET_OK;
 }
-} // namespace rmw_gurumdds_cpp
 
-extern "C"
-{
-rmw_ret_t
-rmw_init_publisher_allocation(
-  const rosidl_message_type_support_t * type_support,
-  const rosidl_runtime_c__Sequence__bound * message_bounds,
-  rmw_publisher_allocation_t * allocation)
+// Serializes the message for the subscriptions of the context
+static rmw_ret_t publish_local(
+  const rmw_publisher_t * publisher,
+  PublisherInfo * publisher_info,
+  const void * ros_message,
+  uint64_t generation,
+  const dds_Time_t * source_timestamp)
 {
-  RCUTILS_UNUSED(type_support);
-  RCUTILS_UNUSED(message_bounds);
-  RCUTILS_UNUSED(allocation);
+  // Shared by the queues of the subscriptions, it goes back to the pool once they drop it
+  std::shared_ptr<MessageBuffer> message_buffer = publisher_info->local_buffers.acquire();
+  if (message_buffer == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate message buffer");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  const uint64_t serialize_start_ns = stats_time_ns();
+  size_t size = 0;
+  if (!publisher_info->message_plan->serialize(ros_message, *message_buffer, &size)) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
 
-  RMW_SET_ERROR_MSG("rmw_init_publisher_allocation is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return deliver_local(
+    publisher, publisher_info, ros_message, message_buffer, size,
+    stats_time_ns() - serialize_start_ns, generation, source_timestamp);
 }
 
-rmw_ret_t
-rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
+// Copies an already serialized sample for the subscriptions of the context
+static rmw_ret_t publish_local_copy(
+  const rmw_publisher_t * publisher,
+  PublisherInfo * publisher_info,
+  const void * source,
+  const void * dds_message,
+  size_t size,
+  uint64_t generation,
+  const dds_Time_t * source_timestamp)
 {
-  RCUTILS_UNUSED(allocation);
+  std::shared_ptr<MessageBuffer> message_buffer = publisher_info->local_buffers.acquire();
+  if (message_buffer == nullptr || message_buffer->grow(size) == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate message buffer");
+    return RMW_RET_BAD_ALLOC;
+  }
+  std::memcpy(message_buffer->data(), dds_message, size);
+
+  return deliver_local(
+    publisher, publisher_info, source, message_buffer, size, 0, generation, source_timestamp);
+}
+
+rmw_ret_t publish(
+  const char* identifier,
+  const rmw_publisher_t* publisher,
+  const void* ros_message,
+  rmw_publisher_allocation_t* allocation,
+  const dds_Time_t * source_timestamp) {
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+
+  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+
+  dds_DataWriter * topic_writer = publisher_info->topic_writer;
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_writer, RMW_RET_ERROR);
+
+  const MessagePlan * message_plan = publisher_info->message_plan;
+  if (message_plan == nullptr) {
+    RMW_SET_ERROR_MSG("message plan is null");
+    return RMW_RET_ERROR;
+  }
+
+  uint64_t generation = 0;
+  if (publisher_info->local_delivery &&
+    publisher_info->ctx->intra_context->is_local_only(publisher_info, generation))
+  {
+    return publish_local(publisher, publisher_info, ros_message, generation, source_timestamp);
+  }
+
+  MessageBuffer * message_buffer = nullptr;
+  MessageBuffer * pooled_buffer = nullptr;
+  if (allocation != nullptr) {
+    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+      allocation,
+      allocation->implementation_identifier,
+      RMW_GURUMDDS_ID,
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+    auto publisher_allocation = static_cast<PublisherAllocation *>(allocation->data);
+    if (publisher_allocation == nullptr || publisher_allocation->message_plan != message_plan) {
+      RMW_SET_ERROR_MSG("allocation was not initialized for the type of this publisher");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    message_buffer = &publisher_allocation->message_buffer;
+  } else {
+    pooled_buffer = publisher_info->message_buffers.acquire();
+    if (pooled_buffer == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate message buffer");
+      return RMW_RET_BAD_ALLOC;
+    }
+    message_buffer = pooled_buffer;
+  }
+  auto scope_exit_buffer_release = rcpputils::make_scope_exit(
+    [publisher_info, &pooled_buffer]() {
+      if (pooled_buffer != nullptr) {
+        publisher_info->message_buffers.release(pooled_buffer);
+      }
+    });
+
+  const uint64_t serialize_start_ns = stats_time_ns();
+  size_t size = 0;
+  bool result = message_plan->serialize(ros_message, *message_buffer, &size);
+  if (!result) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
 
-  RMW_SET_ERROR_MSG("rmw_fini_publisher_allocation is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return write_sample(
+    publisher, publisher_info, ros_message, message_buffer->data(), size,
+    stats_time_ns() - serialize_start_ns, source_timestamp, &pooled_buffer);
 }
 
 rmw_publisher_t *
-rmw_create_publisher(
+create_node_publisher(
   const rmw_node_t * node,
   const rosidl_message_type_support_t * type_supports,
   const char * topic_name,
   const rmw_qos_profile_t * qos_policies,
-  const rmw_publisher_options_t * publisher_options)
+  const rmw_publisher_options_t * publisher_options,
+  dds_Publisher * const pub)
 {
   RMW_CHECK_ARGUMENT_FOR_NULL(node, nullptr);
   RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
@@ -482,7 +797,7 @@ rmw_create_publisher(
     ctx,
     node,
     ctx->participant,
-    ctx->publisher,
+    pub != nullptr ? pub : ctx->get_publisher(ctx->select_entity_group(topic_name)),
     type_supports,
     topic_name,
     &adapted_qos_policies,
@@ -503,6 +818,203 @@ rmw_create_publisher(
   return rmw_pub;
 }
 
+static rmw_ret_t
+publish_serialized(
+  const rmw_publisher_t * publisher,
+  const rmw_serialized_message_t * serialized_message,
+  const dds_Time_t * source_timestamp)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+
+  dds_DataWriter * topic_writer = publisher_info->topic_writer;
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_writer, RMW_RET_ERROR);
+
+  uint64_t generation = 0;
+  if (publisher_info->local_delivery &&
+    publisher_info->ctx->intra_context->is_local_only(publisher_info, generation))
+  {
+    return publish_local_copy(
+      publisher, publisher_info, serialized_message, serialized_message->buffer,
+      serialized_message->buffer_length, generation, source_timestamp);
+  }
+
+  return write_sample(
+    publisher, publisher_info, serialized_message,
+    serialized_message->buffer, serialized_message->buffer_length, 0, source_timestamp);
+}
+
+rmw_ret_t
+publish_with_timestamp(
+  const rmw_publisher_t * publisher,
+  const void * ros_message,
+  rmw_time_point_value_t source_timestamp,
+  rmw_publisher_allocation_t * allocation)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  if (source_timestamp < 0) {
+    RMW_SET_ERROR_MSG("source timestamp is before the epoch");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  const dds_Time_t timestamp = i64_to_dds_time(source_timestamp);
+  return publish(
+    publisher->implementation_identifier, publisher, ros_message, allocation, &timestamp);
+}
+
+rmw_ret_t
+publish_serialized_message_with_timestamp(
+  const rmw_publisher_t * publisher,
+  const rmw_serialized_message_t * serialized_message,
+  rmw_time_point_value_t source_timestamp)
+{
+  if (source_timestamp < 0) {
+    RMW_SET_ERROR_MSG("source timestamp is before the epoch");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  const dds_Time_t timestamp = i64_to_dds_time(source_timestamp);
+  return publish_serialized(publisher, serialized_message, &timestamp);
+}
+
+rmw_ret_t
+warm_up_publisher(
+  const rmw_publisher_t * publisher,
+  size_t buffer_count,
+  size_t max_serialized_size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto publisher_info = static_cast<PublisherInfo *>(publisher->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+
+  const MessagePlan * message_plan = publisher_info->message_plan;
+  if (max_serialized_size == 0) {
+    if (!message_plan->is_bounded()) {
+      RMW_SET_ERROR_MSG("message type is unbounded, a maximum serialized size is required");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    max_serialized_size = message_plan->get_max_serialized_size();
+  }
+
+  if (!publisher_info->message_buffers.reserve(buffer_count, max_serialized_size)) {
+    RMW_SET_ERROR_MSG("failed to allocate message buffers");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  if (publisher_info->local_delivery &&
+    !publisher_info->local_buffers.reserve(buffer_count, max_serialized_size))
+  {
+    RMW_SET_ERROR_MSG("failed to allocate local message buffers");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  if (publisher_info->loan_pool.is_enabled() &&
+    !publisher_info->loan_pool.reserve(buffer_count))
+  {
+    RMW_SET_ERROR_MSG("failed to allocate loaned messages");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
+
+extern "C"
+{
+rmw_ret_t
+rmw_init_publisher_allocation(
+  const rosidl_message_type_support_t * type_support,
+  const rosidl_runtime_c__Sequence__bound * message_bounds,
+  rmw_publisher_allocation_t * allocation)
+{
+  // rosidl does not generate bounds data, the bounds of the introspection members are used
+  RCUTILS_UNUSED(message_bounds);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(type_support, rosidl_typesupport_introspection_c__identifier);
+  if (introspection_type_support == nullptr) {
+    rcutils_reset_error();
+    introspection_type_support = get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+    if (introspection_type_support == nullptr) {
+      rcutils_reset_error();
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+  }
+
+  const rmw_gurumdds_cpp::MessagePlan * message_plan =
+    rmw_gurumdds_cpp::MessagePlan::get(introspection_type_support);
+  if (message_plan == nullptr) {
+    // Error message is already set
+    return RMW_RET_ERROR;
+  }
+
+  auto publisher_allocation = new(std::nothrow) rmw_gurumdds_cpp::PublisherAllocation();
+  if (publisher_allocation == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate publisher allocation");
+    return RMW_RET_BAD_ALLOC;
+  }
+  publisher_allocation->message_plan = message_plan;
+
+  // Unbounded types start from the initial size and keep what they grow to
+  size_t size = message_plan->is_bounded() ?
+    message_plan->get_max_serialized_size() : CDR_INITIAL_STORAGE_SIZE;
+  if (publisher_allocation->message_buffer.grow(size) == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate serialization buffer");
+    delete publisher_allocation;
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  allocation->implementation_identifier = RMW_GURUMDDS_ID;
+  allocation->data = publisher_allocation;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation,
+    allocation->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  delete static_cast<rmw_gurumdds_cpp::PublisherAllocation *>(allocation->data);
+  allocation->implementation_identifier = nullptr;
+  allocation->data = nullptr;
+  return RMW_RET_OK;
+}
+
+rmw_publisher_t *
+rmw_create_publisher(
+  const rmw_node_t * node,
+  const rosidl_message_type_support_t * type_supports,
+  const char * topic_name,
+  const rmw_qos_profile_t * qos_policies,
+  const rmw_publisher_options_t * publisher_options)
+{
+  return rmw_gurumdds_cpp::create_node_publisher(
+    node, type_supports, topic_name, qos_policies, publisher_options, nullptr);
+}
+
 rmw_ret_t
 rmw_publisher_count_matched_subscriptions(
   const rmw_publisher_t * publisher,
@@ -581,7 +1093,22 @@ rmw_publisher_wait_for_all_acked(const rmw_publisher_t * publisher, rmw_time_t w
     return RMW_RET_ERROR;
   }
 
+  // Queued samples are waited for as well, the acknowledgments in the time that is left
   dds_Duration_t timeout = rmw_gurumdds_cpp::rmw_time_to_dds(wait_timeout);
+  if (publisher_info->async != nullptr) {
+    const bool infinite = rmw_time_equal(wait_timeout, RMW_DURATION_INFINITE);
+    const uint64_t timeout_ns = infinite ? UINT64_MAX : rmw_time_total_nsec(wait_timeout);
+    const uint64_t drain_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    if (!publisher_info->async->drain(timeout_ns)) {
+      return RMW_RET_TIMEOUT;
+    }
+    if (!infinite) {
+      const uint64_t elapsed_ns = rmw_gurumdds_cpp::stats_time_ns() - drain_start_ns;
+      const uint64_t left_ns = elapsed_ns < timeout_ns ? timeout_ns - elapsed_ns : 0;
+      timeout = rmw_gurumdds_cpp::rmw_time_to_dds(rmw_time_from_nsec(left_ns));
+    }
+  }
+
   dds_ReturnCode_t ret = dds_DataWriter_wait_for_acknowledgments(
     publisher_info->topic_writer, &timeout);
 
@@ -725,67 +1252,56 @@ rmw_publish_serialized_message(
   const rmw_publisher_t * publisher,
   const rmw_serialized_message_t * serialized_message,
   rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_UNUSED(allocation);
+  return rmw_gurumdds_cpp::publish_serialized(publisher, serialized_message, nullptr);
+}
+
+rmw_ret_t
+rmw_publish_loaned_message(
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation)
 {
   RCUTILS_UNUSED(allocation);
   RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
     publisher,
     publisher->implementation_identifier,
     RMW_GURUMDDS_ID,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported by this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
+
   auto publisher_info = static_cast<rmw_gurumdds_cpp::PublisherInfo *>(publisher->data);
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
 
-  dds_DataWriter * topic_writer = publisher_info->topic_writer;
-  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_writer, RMW_RET_ERROR);
-
-  dds_SampleInfoEx sampleinfo_ex{};
-  rmw_gurumdds_cpp::ros_sn_to_dds_sn(++publisher_info->sequence_number, &sampleinfo_ex.seq);
-  rmw_gurumdds_cpp::ros_guid_to_dds_guid(
-    reinterpret_cast<const uint8_t *>(publisher_info->publisher_gid.data),
-    reinterpret_cast<uint8_t *>(&sampleinfo_ex.src_guid));
-
-  dds_Time_get_current_time(&sampleinfo_ex.info.source_timestamp);
-  TRACETOOLS_TRACEPOINT(
-    rmw_publish,
-    static_cast<const void *>(publisher),
-    serialized_message,
-    rmw_gurumdds_cpp::dds_time_to_i64(sampleinfo_ex.info.source_timestamp)
-  );
-
-  dds_ReturnCode_t ret = dds_DataWriter_raw_write_w_sampleinfoex(
-    topic_writer,
-    serialized_message->buffer,
-    static_cast<uint32_t>(serialized_message->buffer_length),
-    &sampleinfo_ex
-  );
-
-  if (ret != dds_RETCODE_OK) {
-    std::stringstream errmsg;
-    errmsg << "failed to publish data: " << dds_ReturnCode_to_string(ret) << ", " << ret;
-    RMW_SET_ERROR_MSG(errmsg.str().c_str());
-    return RMW_RET_ERROR;
+  size_t size = 0;
+  void * dds_message = publisher_info->loan_pool.get_dds_message(ros_message, &size);
+  if (dds_message == nullptr) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_INVALID_ARGUMENT;
   }
 
-  RCUTILS_LOG_DEBUG_NAMED(RMW_GURUMDDS_ID, "Published data on topic %s", publisher->topic_name);
-
-  return RMW_RET_OK;
-}
-
-rmw_ret_t
-rmw_publish_loaned_message(
-  const rmw_publisher_t * publisher,
-  void * ros_message,
-  rmw_publisher_allocation_t * allocation)
-{
-  RCUTILS_UNUSED(publisher);
-  RCUTILS_UNUSED(ros_message);
-  RCUTILS_UNUSED(allocation);
+  // The loan ends with the publish, whether or not the write succeeds
+  rmw_ret_t ret;
+  uint64_t generation = 0;
+  if (publisher_info->local_delivery &&
+    publisher_info->ctx->intra_context->is_local_only(publisher_info, generation))
+  {
+    ret = rmw_gurumdds_cpp::publish_local_copy(
+      publisher, publisher_info, ros_message, dds_message, size, generation, nullptr);
+  } else {
+    ret = rmw_gurumdds_cpp::write_sample(
+      publisher, publisher_info, ros_message, dds_message, size, 0);
+  }
+  publisher_info->loan_pool.release(ros_message);
 
-  RMW_SET_ERROR_MSG("rmw_publish_loaned_message is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return ret;
 }
 
 rmw_ret_t
@@ -794,12 +1310,46 @@ rmw_borrow_loaned_message(
   const rosidl_message_type_support_t * type_support,
   void ** ros_message)
 {
-  RCUTILS_UNUSED(publisher);
-  RCUTILS_UNUSED(type_support);
-  RCUTILS_UNUSED(ros_message);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  if (*ros_message != nullptr) {
+    RMW_SET_ERROR_MSG("ros_message is not null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported by this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  auto publisher_info = static_cast<rmw_gurumdds_cpp::PublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+
+  const rosidl_message_type_support_t * publisher_type_support =
+    publisher_info->rosidl_message_typesupport;
+  if (get_message_typesupport_handle(
+      type_support, publisher_type_support->typesupport_identifier) != publisher_type_support)
+  {
+    rcutils_reset_error();
+    RMW_SET_ERROR_MSG("type support does not match the publisher");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  void * message = publisher_info->loan_pool.borrow();
+  if (message == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
 
-  RMW_SET_ERROR_MSG("rmw_borrow_loaned_message is not supported");
-  return RMW_RET_UNSUPPORTED;
+  *ros_message = message;
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
@@ -807,10 +1357,27 @@ rmw_return_loaned_message_from_publisher(
   const rmw_publisher_t * publisher,
   void * loaned_message)
 {
-  RCUTILS_UNUSED(publisher);
-  RCUTILS_UNUSED(loaned_message);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported by this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
 
-  RMW_SET_ERROR_MSG("rmw_return_loaned_message_from_publisher is not supported");
-  return RMW_RET_UNSUPPORTED;
+  auto publisher_info = static_cast<rmw_gurumdds_cpp::PublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher_info, RMW_RET_ERROR);
+
+  if (!publisher_info->loan_pool.release(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  return RMW_RET_OK;
 }
 }  // extern "C"
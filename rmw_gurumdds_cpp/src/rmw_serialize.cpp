@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "rcutils/macros.h"
+
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 #include "rmw/serialized_message.h"
@@ -21,7 +23,44 @@
 #include "rosidl_typesupport_introspection_c/message_introspection.h"
 #include "rosidl_typesupport_introspection_cpp/identifier.hpp"
 
-#include "rmw_gurumdds_cpp/type_support_common.hpp"
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+
+namespace
+{
+// Lets the serializer grow the caller's buffer through its own allocator
+class SerializedMessageStorage: public rmw_gurumdds_cpp::CdrGrowableStorage {
+public:
+  explicit SerializedMessageStorage(rmw_serialized_message_t * message)
+    : message_{message} {
+  }
+
+  uint8_t * grow(size_t size) override {
+    if (size <= message_->buffer_capacity) {
+      return message_->buffer;
+    }
+
+    if (rmw_serialized_message_resize(message_, size) != RMW_RET_OK) {
+      // The serializer reports its own error
+      rmw_reset_error();
+      return nullptr;
+    }
+
+    return message_->buffer;
+  }
+
+  uint8_t * data() const override {
+    return message_->buffer;
+  }
+
+  size_t capacity() const override {
+    return message_->buffer_capacity;
+  }
+
+private:
+  rmw_serialized_message_t * message_;
+};
+}  // namespace
 
 extern "C"
 {
@@ -42,41 +81,28 @@ rmw_serialize(
     }
   }
 
-  ssize_t ssize = rmw_gurumdds_cpp::get_serialized_size(
-    ts->data,
-    ts->typesupport_identifier,
-    ros_message
-  );
-  if (ssize < 0) {
-    RMW_SET_ERROR_MSG("failed to get size of serialized message");
+  const rmw_gurumdds_cpp::MessagePlan * plan = rmw_gurumdds_cpp::MessagePlan::get(ts);
+  if (plan == nullptr) {
+    // Error message already set
     return RMW_RET_ERROR;
   }
 
-  size_t size = static_cast<size_t>(ssize);
+  SerializedMessageStorage storage{serialized_message};
 
-  serialized_message->buffer_length = size;
-  if (serialized_message->buffer_capacity < size) {
-    serialized_message->allocator.deallocate(
-      serialized_message->buffer, serialized_message->allocator.state);
-    serialized_message->buffer = static_cast<uint8_t *>(
-      serialized_message->allocator.allocate(
-        serialized_message->buffer_length,
-        serialized_message->allocator.state));
-    serialized_message->buffer_capacity = size;
+  // Bounded types are sized once up front, unbounded ones grow geometrically while serializing
+  if (plan->is_bounded() && storage.grow(plan->get_max_serialized_size()) == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate serialized message buffer");
+    return RMW_RET_BAD_ALLOC;
   }
 
-  bool res = rmw_gurumdds_cpp::serialize_ros_to_cdr(
-    ts->data,
-    ts->typesupport_identifier,
-    ros_message,
-    serialized_message->buffer,
-    size
-  );
+  size_t size = 0;
+  bool res = plan->serialize(ros_message, storage, &size);
   if (!res) {
     // Error message already set
     return RMW_RET_ERROR;
   }
 
+  serialized_message->buffer_length = size;
   return RMW_RET_OK;
 }
 
@@ -97,9 +123,13 @@ rmw_deserialize(
     }
   }
 
-  bool res = rmw_gurumdds_cpp::deserialize_cdr_to_ros(
-    ts->data,
-    ts->typesupport_identifier,
+  const rmw_gurumdds_cpp::MessagePlan * plan = rmw_gurumdds_cpp::MessagePlan::get(ts);
+  if (plan == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  bool res = plan->deserialize(
     ros_message,
     serialized_message->buffer,
     serialized_message->buffer_length
@@ -114,11 +144,40 @@ rmw_deserialize(
 
 rmw_ret_t
 rmw_get_serialized_message_size(
-  const rosidl_message_type_support_t * /*type_support*/,
-  const rosidl_runtime_c__Sequence__bound * /*message_bounds*/,
-  size_t * /*size*/)
+  const rosidl_message_type_support_t * type_support,
+  const rosidl_runtime_c__Sequence__bound * message_bounds,
+  size_t * size)
 {
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  // rosidl does not generate bounds data, the bounds of the introspection members are used
+  RCUTILS_UNUSED(message_bounds);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+
+  const rosidl_message_type_support_t * ts =
+    get_message_typesupport_handle(type_support, rosidl_typesupport_introspection_c__identifier);
+  if (ts == nullptr) {
+    ts = get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+    if (ts == nullptr) {
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  // The maximum is computed once, when the plan of the type is compiled
+  const rmw_gurumdds_cpp::MessagePlan * plan = rmw_gurumdds_cpp::MessagePlan::get(ts);
+  if (plan == nullptr) {
+    // Error message already set
+    return RMW_RET_ERROR;
+  }
+
+  if (!plan->is_bounded()) {
+    RMW_SET_ERROR_MSG(
+      "message type has an unbounded string or sequence, its serialized size has no maximum");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  *size = plan->get_max_serialized_size();
+  return RMW_RET_OK;
 }
 }  // extern "C"
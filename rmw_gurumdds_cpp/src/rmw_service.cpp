@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <utility>
 
+#include "rcpputils/scope_exit.hpp"
+
 #include "rcutils/error_handling.h"
 #include "rcutils/logging_macros.h"
 
@@ -28,6 +31,7 @@
 #include "tracetools/tracetools.h"
 
 #include "rmw_gurumdds_cpp/event_converter.hpp"
+#include "rmw_gurumdds_cpp/event_fd.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
@@ -38,7 +42,9 @@
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
 #include "rmw_gurumdds_cpp/event_info_service.hpp"
 
+#include "rmw_gurumdds_cpp/tracing.hpp"
 #include "rmw_gurumdds_cpp/type_support_service.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
 
 extern "C"
 {
@@ -94,23 +100,23 @@ rmw_create_service(
   }
 
   rmw_context_impl_t * ctx = node->context->impl;
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
+  // Held until the topics are created or found and their endpoints created on them
+  rmw_gurumdds_cpp::TopicLockGuard topic_guard;
 
   rmw_gurumdds_cpp::ServiceInfo * service_info = nullptr;
   rmw_service_t * rmw_service = nullptr;
 
   dds_DomainParticipant * participant = ctx->participant;
-  dds_Publisher * publisher = ctx->publisher;
-  dds_Subscriber * subscriber = ctx->subscriber;
+  // The writer and the reader of a service share a group
+  const size_t entity_group = ctx->select_entity_group(service_name);
+  dds_Publisher * publisher = ctx->get_publisher(entity_group);
+  dds_Subscriber * subscriber = ctx->get_subscriber(entity_group);
 
   dds_DataReaderQos datareader_qos;
   dds_DataWriterQos datawriter_qos;
 
   dds_DataReader * request_reader = nullptr;
   dds_DataReaderListener request_listener;
-  dds_DataSeq* data_seq = nullptr;
-  dds_SampleInfoSeq* info_seq = nullptr;
-  dds_UnsignedLongSeq* raw_data_sizes = nullptr;
   dds_DataWriter * response_writer = nullptr;
   dds_ReadCondition * read_condition = nullptr;
   dds_TypeSupport * request_typesupport = nullptr;
@@ -149,6 +155,7 @@ rmw_create_service(
     rmw_gurumdds_cpp::ros_service_requester_prefix, service_name, "Request", &adapted_qos_policies);
   response_topic_name = rmw_gurumdds_cpp::create_topic_name(
     rmw_gurumdds_cpp::ros_service_response_prefix, service_name, "Reply", &adapted_qos_policies);
+  topic_guard.lock(ctx->topic_locks, request_topic_name, response_topic_name);
 
   service_metastring =
     rmw_gurumdds_cpp::create_service_metastring(type_support->data, type_support->typesupport_identifier);
@@ -312,42 +319,30 @@ rmw_create_service(
     goto fail;
   }
 
-  data_seq = dds_DataSeq_create(1);
-  if (nullptr == data_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate data_seq");
-    return nullptr;
-  }
-  info_seq = dds_SampleInfoSeq_create(1);
-  if (nullptr == info_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate info_seq");
-    return nullptr;
-  }
-  raw_data_sizes = dds_UnsignedLongSeq_create(1);
-  if (nullptr == raw_data_sizes) {
-    RMW_SET_ERROR_MSG("failed to allocate raw_data_sizes");
-    return nullptr;
-  }
-
   dds_DataReader_set_listener_context(request_reader, service_info);
   request_listener.on_data_available = [](const dds_DataReader * request_reader){
     dds_DataReader* reader = const_cast<dds_DataReader*>(request_reader);
     rmw_gurumdds_cpp::ServiceInfo* info = static_cast<rmw_gurumdds_cpp::ServiceInfo*>(dds_DataReader_get_listener_context(reader));
     std::lock_guard<std::mutex> guard(info->event_callback_data.mutex);
     if(info->event_callback_data.callback) {
-      info->event_callback_data.callback(info->event_callback_data.user_data, info->count_unread());
+      // One notification per received request
+      info->event_callback_data.callback(info->event_callback_data.user_data, 1);
     }
+    rmw_gurumdds_cpp::write_event_fd(info->event_callback_data.event_fd);
   };
 
   service_info->response_writer = response_writer;
   service_info->request_reader = request_reader;
   service_info->read_condition = read_condition;
   service_info->request_listener = request_listener;
-  service_info->data_seq = data_seq;
-  service_info->info_seq = info_seq;
-  service_info->raw_data_sizes = raw_data_sizes;
   service_info->implementation_identifier = RMW_GURUMDDS_ID;
   service_info->service_typesupport = type_support;
+  if (!service_info->type_support.init(type_support)) {
+    // Error message already set
+    goto fail;
+  }
   service_info->ctx = ctx;
+  service_info->message_buffers.set_memory(ctx->buffer_memory);
 
   rmw_gurumdds_cpp::entity_get_gid(
     reinterpret_cast<dds_Entity *>(service_info->response_writer),
@@ -448,23 +443,20 @@ rmw_destroy_service(rmw_node_t * node, rmw_service_t * service)
 
   dds_ReturnCode_t ret;
   rmw_context_impl_t * ctx = node->context->impl;
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
 
   rmw_gurumdds_cpp::ServiceInfo * service_info = static_cast<rmw_gurumdds_cpp::ServiceInfo *>(service->data);
   if (service_info != nullptr) {
+    rmw_gurumdds_cpp::clean_wait_set_caches();
     if (service_info->response_writer != nullptr) {
       ret = dds_Publisher_delete_datawriter(
-        ctx->publisher, service_info->response_writer);
+        dds_DataWriter_get_publisher(service_info->response_writer),
+        service_info->response_writer);
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to delete datawriter");
         return RMW_RET_ERROR;
       }
     }
 
-    dds_DataSeq_delete(service_info->data_seq);
-    dds_SampleInfoSeq_delete(service_info->info_seq);
-    dds_UnsignedLongSeq_delete(service_info->raw_data_sizes);
-
     if (service_info->request_reader != nullptr) {
       if (service_info->read_condition != nullptr) {
         ret = dds_DataReader_delete_readcondition(
@@ -475,7 +467,7 @@ rmw_destroy_service(rmw_node_t * node, rmw_service_t * service)
         }
       }
       ret = dds_Subscriber_delete_datareader(
-        ctx->subscriber, service_info->request_reader);
+        dds_DataReader_get_subscriber(service_info->request_reader), service_info->request_reader);
       if (ret != dds_RETCODE_OK) {
         RMW_SET_ERROR_MSG("failed to delete datareader");
         return RMW_RET_ERROR;
@@ -620,6 +612,7 @@ rmw_take_request(
   RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
 
   *taken = false;
+  RMW_GURUMDDS_TRACEPOINT(take_request_begin, static_cast<const void *>(service));
 
   rmw_gurumdds_cpp::ServiceInfo * service_info = static_cast<rmw_gurumdds_cpp::ServiceInfo *>(service->data);
   if (service_info == nullptr) {
@@ -633,52 +626,37 @@ rmw_take_request(
     return RMW_RET_ERROR;
   }
 
-  auto type_support = service_info->service_typesupport;
-  if (type_support == nullptr) {
-    RMW_SET_ERROR_MSG("typesupport handle is null");
-    return RMW_RET_ERROR;
-  }
+  const rmw_gurumdds_cpp::ServiceTypeSupport & type_support = service_info->type_support;
 
-  dds_DataSeq * data_values = dds_DataSeq_create(1);
-  if (data_values == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create data sequence");
-    return RMW_RET_ERROR;
+  rmw_gurumdds_cpp::SampleSequences sequences{};
+  if (!service_info->sample_pool.acquire(1, sequences)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return RMW_RET_BAD_ALLOC;
   }
 
-  dds_SampleInfoSeq * sample_infos = dds_SampleInfoSeq_create(1);
-  if (sample_infos == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample info sequence");
-    dds_DataSeq_delete(data_values);
-    return RMW_RET_ERROR;
-  }
+  auto scope_exit_sequences_release = rcpputils::make_scope_exit(
+    [service_info, request_reader, &sequences]() {
+      service_info->sample_pool.release(request_reader, sequences);
+    });
 
-  dds_UnsignedLongSeq * sample_sizes = dds_UnsignedLongSeq_create(1);
-  if (sample_sizes == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample size sequence");
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    return RMW_RET_ERROR;
-  }
+  dds_DataSeq * data_values = sequences.data_seq;
+  dds_SampleInfoSeq * sample_infos = sequences.info_seq;
+  dds_UnsignedLongSeq * sample_sizes = sequences.raw_data_sizes;
 
   if (service_info->ctx->service_mapping_basic) {
+    const uint64_t take_start_ns = rmw_gurumdds_cpp::stats_time_ns();
     dds_ReturnCode_t ret = dds_DataReader_raw_take(
       request_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, 1,
       dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+    const uint64_t take_ns = rmw_gurumdds_cpp::stats_time_ns() - take_start_ns;
 
     if (ret == dds_RETCODE_NO_DATA) {
-      dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
+      service_info->request_stats.on_no_data(take_ns);
       return RMW_RET_OK;
     }
 
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("failed to take data");
-      dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
       return RMW_RET_ERROR;
     }
 
@@ -686,10 +664,6 @@ rmw_take_request(
     if (sample_info->valid_data) {
       void * sample = dds_DataSeq_get(data_values, 0);
       if (sample == nullptr) {
-        dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
       uint32_t size = dds_UnsignedLongSeq_get(sample_sizes, 0);
@@ -698,10 +672,9 @@ rmw_take_request(
       int8_t client_guid[16] = {0};
       dds_SampleInfoEx * sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(sample_info);
 
-      bool res = rmw_gurumdds_cpp::deserialize_request_basic(
-        type_support->data,
-        type_support->typesupport_identifier,
-        ros_request,
+      const uint64_t deserialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+      bool res = type_support.deserialize_request_basic(
+                ros_request,
         sample,
         static_cast<size_t>(size),
         &sn_high,
@@ -711,12 +684,10 @@ rmw_take_request(
 
       if (!res) {
         // Error message already set
-        dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
+      service_info->request_stats.on_take(
+        1, size, rmw_gurumdds_cpp::stats_time_ns() - deserialize_start_ns, take_ns);
 
       request_header->source_timestamp =
         sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
@@ -728,29 +699,20 @@ rmw_take_request(
       std::memcpy(request_header->request_id.writer_guid, client_guid, RMW_GID_STORAGE_SIZE);
     }
 
-    dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    dds_UnsignedLongSeq_delete(sample_sizes);
   } else {
+    const uint64_t take_start_ns = rmw_gurumdds_cpp::stats_time_ns();
     dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
       request_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, 1,
       dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+    const uint64_t take_ns = rmw_gurumdds_cpp::stats_time_ns() - take_start_ns;
 
     if (ret == dds_RETCODE_NO_DATA) {
-      dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
+      service_info->request_stats.on_no_data(take_ns);
       return RMW_RET_OK;
     }
 
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("failed to take data");
-      dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
       return RMW_RET_ERROR;
     }
 
@@ -758,10 +720,6 @@ rmw_take_request(
     if (sample_info->valid_data) {
       void * sample = dds_DataSeq_get(data_values, 0);
       if (sample == nullptr) {
-        dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
       uint32_t size = dds_UnsignedLongSeq_get(sample_sizes, 0);
@@ -771,22 +729,19 @@ rmw_take_request(
       rmw_gurumdds_cpp::dds_guid_to_ros_guid(reinterpret_cast<int8_t *>(&sampleinfo_ex->src_guid), client_guid);
       rmw_gurumdds_cpp::dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
 
-      bool res = rmw_gurumdds_cpp::deserialize_request_enhanced(
-        type_support->data,
-        type_support->typesupport_identifier,
-        ros_request,
+      const uint64_t deserialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+      bool res = type_support.deserialize_request_enhanced(
+                ros_request,
         sample,
         static_cast<size_t>(size)
       );
 
       if (!res) {
         // Error message already set
-        dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
         return RMW_RET_ERROR;
       }
+      service_info->request_stats.on_take(
+        1, size, rmw_gurumdds_cpp::stats_time_ns() - deserialize_start_ns, take_ns);
 
       request_header->source_timestamp =
         sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
@@ -798,10 +753,6 @@ rmw_take_request(
       std::memcpy(request_header->request_id.writer_guid, client_guid, RMW_GID_STORAGE_SIZE);
     }
 
-    dds_DataReader_raw_return_loan(request_reader, data_values, sample_infos, sample_sizes);
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    dds_UnsignedLongSeq_delete(sample_sizes);
   }
 
   *taken = true;
@@ -830,6 +781,7 @@ rmw_send_response(
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
   RMW_CHECK_ARGUMENT_FOR_NULL(request_header, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_ARGUMENT_FOR_NULL(ros_response, RMW_RET_INVALID_ARGUMENT);
+  RMW_GURUMDDS_TRACEPOINT(send_response_begin, static_cast<const void *>(service));
 
   rmw_gurumdds_cpp::ServiceInfo * service_info = static_cast<rmw_gurumdds_cpp::ServiceInfo *>(service->data);
   if (service_info == nullptr) {
@@ -843,75 +795,63 @@ rmw_send_response(
     return RMW_RET_ERROR;
   }
 
-  auto type_support = service_info->service_typesupport;
-  if (type_support == nullptr) {
-    RMW_SET_ERROR_MSG("typesupport handle is null");
-    return RMW_RET_ERROR;
+  const rmw_gurumdds_cpp::ServiceTypeSupport & type_support = service_info->type_support;
+
+  rmw_gurumdds_cpp::MessageBuffer * pooled_buffer = service_info->message_buffers.acquire();
+  if (pooled_buffer == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate message buffer");
+    return RMW_RET_BAD_ALLOC;
   }
+  auto scope_exit_buffer_release = rcpputils::make_scope_exit(
+    [service_info, pooled_buffer]() {
+      service_info->message_buffers.release(pooled_buffer);
+    });
+  rmw_gurumdds_cpp::MessageBuffer & message_buffer = *pooled_buffer;
 
   size_t size = 0;
 
+  const uint64_t serialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
   if (service_info->ctx->service_mapping_basic) {
-    void * dds_response = rmw_gurumdds_cpp::allocate_response_basic(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_response,
-      &size
-    );
-
-    if (dds_response == nullptr) {
-      return RMW_RET_ERROR;
-    }
-
-    bool res = rmw_gurumdds_cpp::serialize_response_basic(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_response,
-      dds_response,
-      size,
+    bool res = type_support.serialize_response_basic(
+            ros_response,
+      message_buffer,
+      &size,
       request_header->sequence_number,
       request_header->writer_guid
     );
 
     if (!res) {
-      RMW_SET_ERROR_MSG("failed to serialize message");
-      free(dds_response);
+      // Error message already set
       return RMW_RET_ERROR;
     }
 
-    if (dds_DataWriter_raw_write(response_writer, dds_response, size) != dds_RETCODE_OK) {
+    void * dds_response = message_buffer.data();
+
+    const uint64_t write_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    dds_ReturnCode_t ret = dds_DataWriter_raw_write(response_writer, dds_response, size);
+    service_info->response_stats.on_write(
+      size, write_start_ns - serialize_start_ns,
+      rmw_gurumdds_cpp::stats_time_ns() - write_start_ns);
+    if (ret != dds_RETCODE_OK) {
+      service_info->response_stats.on_drop();
       RMW_SET_ERROR_MSG("failed to publish data");
-      free(dds_response);
       return RMW_RET_ERROR;
     }
-    free(dds_response);
   } else {
-    void * dds_response = rmw_gurumdds_cpp::allocate_response_enhanced(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_response,
+    bool res = type_support.serialize_response_enhanced(
+            ros_response,
+      message_buffer,
       &size
     );
 
-    if (dds_response == nullptr) {
-      // Error message already set
-      return RMW_RET_ERROR;
-    }
-
-    bool res = rmw_gurumdds_cpp::serialize_response_enhanced(
-      type_support->data,
-      type_support->typesupport_identifier,
-      ros_response,
-      dds_response,
-      size
-    );
-
     if (!res) {
       // Error message already set
-      free(dds_response);
       return RMW_RET_ERROR;
     }
 
+    void * dds_response = message_buffer.data();
+    const uint64_t serialization_ns = rmw_gurumdds_cpp::stats_time_ns() - serialize_start_ns;
+
     dds_SampleInfoEx sampleinfo_ex;
     std::memset(&sampleinfo_ex, 0, sizeof(dds_SampleInfoEx));
     rmw_gurumdds_cpp::ros_sn_to_dds_sn(request_header->sequence_number, &sampleinfo_ex.seq);
@@ -919,7 +859,8 @@ rmw_send_response(
       request_header->writer_guid,
       reinterpret_cast<uint8_t *>(&sampleinfo_ex.src_guid));
 
-    dds_Time_get_current_time(&sampleinfo_ex.info.source_timestamp);
+    rmw_gurumdds_cpp::get_source_time(
+      service_info->ctx->source_clock, &sampleinfo_ex.info.source_timestamp);
     TRACETOOLS_TRACEPOINT(
       rmw_send_response,
       static_cast<const void *>(service),
@@ -928,16 +869,19 @@ rmw_send_response(
       request_header->sequence_number,
       rmw_gurumdds_cpp::dds_time_to_i64(sampleinfo_ex.info.source_timestamp));
 
-    if (dds_DataWriter_raw_write_w_sampleinfoex(
-        response_writer, dds_response, size, &sampleinfo_ex) != dds_RETCODE_OK)
-    {
+    const uint64_t write_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    dds_ReturnCode_t ret =
+      dds_DataWriter_raw_write_w_sampleinfoex(response_writer, dds_response, size, &sampleinfo_ex);
+    service_info->response_stats.on_write(
+      size, serialization_ns, rmw_gurumdds_cpp::stats_time_ns() - write_start_ns);
+    if (ret != dds_RETCODE_OK) {
+      service_info->response_stats.on_drop();
       RMW_SET_ERROR_MSG("failed to send response");
-      free(dds_response);
       return RMW_RET_ERROR;
     }
-    free(dds_response);
   }
 
+  RMW_GURUMDDS_TRACEPOINT(send_response_end, static_cast<const void *>(service));
   return RMW_RET_OK;
 }
 
@@ -976,7 +920,9 @@ rmw_service_set_on_new_request_callback(
   } else {
     service_info->event_callback_data.callback = nullptr;
     service_info->event_callback_data.user_data = nullptr;
-    mask &= ~dds_DATA_AVAILABLE_STATUS;
+    if (!service_info->event_callback_data.is_set_unsafe()) {
+      mask &= ~dds_DATA_AVAILABLE_STATUS;
+    }
     dds_rc = dds_DataReader_set_listener(service_info->request_reader, &service_info->request_listener, mask);
   }
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <map>
+#include <memory>
 #include <set>
 
 #include "rcutils/allocator.h"
@@ -25,8 +26,9 @@
 #include "rmw/rmw.h"
 
 #include "rmw_gurumdds_cpp/dds_include.hpp"
-#include "rmw_gurumdds_cpp/demangle.hpp"
+#include "rmw_gurumdds_cpp/graph_index.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 
 extern "C"
@@ -50,11 +52,14 @@ rmw_get_service_names_and_types(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  return common_ctx->graph_cache.get_names_and_types(
-    rmw_gurumdds_cpp::demangle_service_from_topic,
-    rmw_gurumdds_cpp::demangle_service_type_only,
-    allocator,
-    service_names_and_types);
+  std::shared_ptr<const rmw_gurumdds_cpp::GraphSnapshot> snapshot =
+    node->context->impl->graph_index.get_snapshot();
+  if (snapshot == nullptr) {
+    // Error message already set
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  return rmw_gurumdds_cpp::copy_topics_names_and_types(
+    snapshot->services, allocator, true, service_names_and_types);
 }
 }  // extern "C"
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include "rcutils/allocator.h"
 #include "rcutils/error_handling.h"
 
 #include "rcpputils/scope_exit.hpp"
@@ -30,6 +35,9 @@
 
 #include "tracetools/tracetools.h"
 
+#include "rmw_gurumdds_cpp/arena_take.hpp"
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/deserialization_arena.hpp"
 #include "rmw_gurumdds_cpp/event_converter.hpp"
 #include "rmw_gurumdds_cpp/graph_cache.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
@@ -39,13 +47,119 @@
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/gid.hpp"
 #include "rmw_gurumdds_cpp/rmw_subscription.hpp"
+#include "rmw_gurumdds_cpp/serialized_loan.hpp"
 #include "rmw_gurumdds_cpp/type_support.hpp"
 #include "rmw_gurumdds_cpp/type_support_common.hpp"
 #include "rmw_gurumdds_cpp/type_support_service.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
+#include "rmw_gurumdds_cpp/wait.hpp"
+#include "rmw_gurumdds_cpp/warm_up.hpp"
 
 namespace rmw_gurumdds_cpp
 {
+static bool
+is_content_filter_set(const rmw_subscription_content_filter_options_t * options)
+{
+  return options != nullptr && options->filter_expression != nullptr &&
+         options->filter_expression[0] != '\0';
+}
+
+static dds_StringSeq *
+create_expression_parameters(const rcutils_string_array_t & parameters)
+{
+  dds_StringSeq * seq = dds_StringSeq_create(static_cast<uint32_t>(parameters.size));
+  if (seq == nullptr) {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < parameters.size; i++) {
+    dds_StringSeq_add(seq, parameters.data[i]);
+  }
+
+  return seq;
+}
+
+static dds_ContentFilteredTopic *
+create_filtered_topic(
+  dds_DomainParticipant * participant,
+  dds_Topic * topic,
+  const rmw_subscription_content_filter_options_t * options)
+{
+  // Filtered topics are local to the participant, only their names have to be unique
+  static std::atomic<uint32_t> filtered_topic_id{0};
+  std::string name = std::string(dds_Topic_get_name(topic)) + "_filtered_" +
+    std::to_string(filtered_topic_id.fetch_add(1, std::memory_order_relaxed));
+
+  dds_StringSeq * parameters = create_expression_parameters(options->expression_parameters);
+  if (parameters == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate expression parameters");
+    return nullptr;
+  }
+
+  dds_ContentFilteredTopic * filtered_topic = dds_DomainParticipant_create_contentfilteredtopic(
+    participant, name.c_str(), topic, options->filter_expression, parameters);
+  dds_StringSeq_delete(parameters);
+  if (filtered_topic == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create content filtered topic");
+    return nullptr;
+  }
+
+  return filtered_topic;
+}
+
+// History depth of the local sample queue, or -1 if the publishers of the context always
+// write the samples of the reader to DDS. Samples are not handed over while a content filter
+// is set, the filter is evaluated by DDS, nor while samples are down-sampled by a time-based
+// filter
+static int64_t
+get_local_queue_depth(
+  const dds_DataReaderQos & qos,
+  const rmw_subscription_options_t * options)
+{
+  if (options->ignore_local_publications ||
+    qos.deadline.period.sec != dds_DURATION_INFINITE_SEC ||
+    qos.deadline.period.nanosec != dds_DURATION_INFINITE_NSEC ||
+    qos.time_based_filter.minimum_separation.sec != 0 ||
+    qos.time_based_filter.minimum_separation.nanosec != 0)
+  {
+    return -1;
+  }
+
+  return qos.history.kind == dds_KEEP_LAST_HISTORY_QOS ? qos.history.depth : 0;
+}
+
+// Creates the queue that the publishers of the context hand samples to, if the reader can be
+// handed samples. False on failure
+static bool
+init_local_samples(SubscriberInfo * subscriber_info, int64_t depth)
+{
+  if (depth < 0) {
+    return true;
+  }
+
+  std::unique_ptr<LocalSampleQueue> queue{new(std::nothrow) LocalSampleQueue()};
+  if (queue == nullptr || !queue->init(static_cast<size_t>(depth))) {
+    return false;
+  }
+
+  subscriber_info->local_samples = std::move(queue);
+  if (subscriber_info->filtered_topic == nullptr) {
+    subscriber_info->ctx->intra_context->add_subscription(subscriber_info);
+  }
+  return true;
+}
+
+static dds_Topic *
+get_related_topic(const SubscriberInfo * subscriber_info)
+{
+  if (subscriber_info->filtered_topic != nullptr) {
+    return dds_ContentFilteredTopic_get_related_topic(subscriber_info->filtered_topic);
+  }
+
+  return reinterpret_cast<dds_Topic *>(
+    dds_DataReader_get_topicdescription(subscriber_info->topic_reader));
+}
+
 rmw_subscription_t *
 create_subscription(
   rmw_context_impl_t * const ctx,
@@ -58,8 +172,6 @@ create_subscription(
   const rmw_subscription_options_t * subscription_options,
   const bool internal)
 {
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
-
   const rosidl_message_type_support_t * type_support =
     get_message_typesupport_handle(type_supports, rosidl_typesupport_introspection_c__identifier);
   if (type_support == nullptr) {
@@ -78,36 +190,32 @@ create_subscription(
   dds_DataReader * topic_reader = nullptr;
   dds_DataReaderQos datareader_qos;
   dds_DataReaderListener topic_listener;
-  dds_DataSeq* data_seq = nullptr;
-  dds_SampleInfoSeq* info_seq = nullptr;
-  dds_UnsignedLongSeq* raw_data_sizes = nullptr;
   dds_Topic * topic = nullptr;
   dds_TopicDescription * topic_desc = nullptr;
   dds_ReadCondition * read_condition = nullptr;
-  dds_TypeSupport * dds_typesupport = nullptr;
   dds_ReturnCode_t ret;
 
-  std::string type_name =
-    create_type_name(type_support->data, type_support->typesupport_identifier);
-  if (type_name.empty()) {
-    // Error message is already set
-    return nullptr;
-  }
-
   std::string processed_topic_name = rmw_gurumdds_cpp::create_topic_name(
     rmw_gurumdds_cpp::ros_topic_prefix, topic_name, "", qos_policies);
 
-  std::string metastring =
-    create_metastring(type_support->data, type_support->typesupport_identifier);
-  if (metastring.empty()) {
+  // Released once the reader holds the topic, before the graph is updated
+  TopicLockGuard topic_guard;
+  topic_guard.lock(ctx->topic_locks, processed_topic_name);
+
+  // The type name, the dds_TypeSupport and the plan are shared by the endpoints of the type
+  const TypeSupportRegistry::Entry * registered_type =
+    ctx->type_registry.acquire(participant, type_support);
+  if (registered_type == nullptr) {
     // Error message is already set
     return nullptr;
   }
+  auto scope_exit_type_release = rcpputils::make_scope_exit(
+    [ctx, type_support]() {
+      ctx->type_registry.release(type_support);
+    });
 
-  dds_typesupport = create_type_support_and_register(participant, type_support, type_name, metastring);
-  if (dds_typesupport == nullptr) {
-    return nullptr;
-  }
+  const std::string & type_name = registered_type->type_name;
+  const MessagePlan * message_plan = registered_type->plan;
 
   topic_desc = dds_DomainParticipant_lookup_topicdescription(
     participant, processed_topic_name.c_str());
@@ -150,11 +258,54 @@ create_subscription(
     // Error message already set
     return nullptr;
   }
+  ctx->qos_profiles.apply(topic_name, datareader_qos);
+
+  // GurumDDS picks the locators of the topic from the RTPS_LOCATOR_POLICY_PROPERTY of the
+  // participant, the ones it does not support were reported when it was created
+  const LocatorSettings locator_settings = ctx->qos_profiles.get_locator_settings(topic_name);
+  if (!internal && !ctx->locator_policy.empty()) {
+    if (locator_settings.policy == LOCATOR_POLICY_AUTO) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        RMW_GURUMDDS_ID, "'%s' is sent to multicast locators from %zu matched readers on",
+        topic_name, locator_settings.multicast_min_readers);
+    } else if (locator_settings.policy != LOCATOR_POLICY_DEFAULT) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        RMW_GURUMDDS_ID, "'%s' is sent to %s locators", topic_name,
+        get_locator_policy_name(locator_settings.policy));
+    }
+  }
+
+  // Writers compress their payloads only while every matched reader advertises it
+  if (!internal && is_compression_supported() &&
+    !append_user_data(&datareader_qos.user_data, COMPRESSION_USER_DATA_KEY, COMPRESSION_LZ4))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      RMW_GURUMDDS_ID, "no room in the user data of '%s' to advertise compression", topic_name);
+  }
+
+  const int64_t local_queue_depth = ctx->intra_context != nullptr && !internal ?
+    get_local_queue_depth(datareader_qos, subscription_options) : -1;
+
+  dds_ContentFilteredTopic * filtered_topic = nullptr;
+  if (is_content_filter_set(subscription_options->content_filter_options)) {
+    filtered_topic = create_filtered_topic(
+      participant, topic, subscription_options->content_filter_options);
+    if (filtered_topic == nullptr) {
+      // Error message already set
+      dds_DataReaderQos_finalize(&datareader_qos);
+      return nullptr;
+    }
+  }
 
-  topic_reader = dds_Subscriber_create_datareader(sub, topic, &datareader_qos, nullptr, 0);
+  topic_reader = dds_Subscriber_create_datareader(
+    sub, filtered_topic != nullptr ? reinterpret_cast<dds_Topic *>(filtered_topic) : topic,
+    &datareader_qos, nullptr, 0);
   if (topic_reader == nullptr) {
     RMW_SET_ERROR_MSG("failed to create datareader");
     dds_DataReaderQos_finalize(&datareader_qos);
+    if (filtered_topic != nullptr) {
+      dds_DomainParticipant_delete_contentfilteredtopic(participant, filtered_topic);
+    }
     return nullptr;
   }
 
@@ -177,22 +328,6 @@ create_subscription(
     return nullptr;
   }
 
-  data_seq = dds_DataSeq_create(1);
-  if (nullptr == data_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate data_seq");
-    return nullptr;
-  }
-  info_seq = dds_SampleInfoSeq_create(1);
-  if (nullptr == info_seq) {
-    RMW_SET_ERROR_MSG("failed to allocate info_seq");
-    return nullptr;
-  }
-  raw_data_sizes = dds_UnsignedLongSeq_create(1);
-  if (nullptr == raw_data_sizes) {
-    RMW_SET_ERROR_MSG("failed to allocate raw_data_sizes");
-    return nullptr;
-  }
-
   dds_DataReader_set_listener_context(topic_reader, subscriber_info);
   topic_listener.on_requested_deadline_missed = [](const dds_DataReader* topic_reader,
                                                    const dds_RequestedDeadlineMissedStatus* status) {
@@ -234,23 +369,40 @@ create_subscription(
 
   subscriber_info->topic_reader = topic_reader;
   subscriber_info->read_condition = read_condition;
+  subscriber_info->filtered_topic = filtered_topic;
+  subscriber_info->node = internal ? nullptr : node;
   subscriber_info->topic_listener = topic_listener;
-  subscriber_info->data_seq = data_seq;
-  subscriber_info->info_seq = info_seq;
-  subscriber_info->raw_data_sizes = raw_data_sizes;
+  // The matched writers are pruned as they go, see on_subscription_matched
+  subscriber_info->internal_mask = dds_SUBSCRIPTION_MATCHED_STATUS;
+  subscriber_info->mask = subscriber_info->internal_mask;
+  subscriber_info->callback_mask = subscriber_info->mask;
+  dds_DataReader_set_listener(
+    topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
   subscriber_info->rosidl_message_typesupport = type_support;
+  subscriber_info->message_plan = message_plan;
+  // Samples that cannot be loaned in place are deserialized into the pool
+  if (message_plan->is_plain() &&
+    !subscriber_info->loan_pool.init(message_plan, LOANED_MESSAGE_POOL_SIZE))
+  {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message pool");
+    return nullptr;
+  }
+  if (!internal && ctx->qos_profiles.is_latency_stats_enabled(topic_name)) {
+    subscriber_info->latency.reset(new(std::nothrow) LatencyCounters());
+    if (subscriber_info->latency == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate latency counters");
+      return nullptr;
+    }
+  }
+  subscriber_info->report_sequence_gaps =
+    !internal && ctx->qos_profiles.is_sequence_gap_lost_enabled(topic_name);
   subscriber_info->implementation_identifier = RMW_GURUMDDS_ID;
   subscriber_info->ctx = ctx;
-  subscriber_info->event_guard_cond[RMW_EVENT_LIVELINESS_CHANGED] = dds_GuardCondition_create();
-  subscriber_info->event_guard_cond[RMW_EVENT_REQUESTED_DEADLINE_MISSED] = dds_GuardCondition_create();
-  subscriber_info->event_guard_cond[RMW_EVENT_REQUESTED_QOS_INCOMPATIBLE] = dds_GuardCondition_create();
-  subscriber_info->event_guard_cond[RMW_EVENT_MESSAGE_LOST] = dds_GuardCondition_create();
-  subscriber_info->event_guard_cond[RMW_EVENT_SUBSCRIPTION_INCOMPATIBLE_TYPE] = dds_GuardCondition_create();
-  subscriber_info->event_guard_cond[RMW_EVENT_SUBSCRIPTION_MATCHED] = dds_GuardCondition_create();
   dds_TypeSupport* reader_dds_type = dds_DataReader_get_typesupport(topic_reader);
-  set_type_support_ops(reader_dds_type, type_support);
+  set_type_support_ops(reader_dds_type, message_plan);
 
   TopicEventListener::add_event(topic, subscriber_info);
+  topic_guard.unlock();
 
   rmw_gurumdds_cpp::entity_get_gid(
     reinterpret_cast<dds_Entity *>(subscriber_info->topic_reader),
@@ -284,8 +436,8 @@ create_subscription(
     topic_name,
     strlen(topic_name) + 1);
   rmw_subscription->options = *subscription_options;
-  rmw_subscription->can_loan_messages = false;
-  rmw_subscription->is_cft_enabled = false;
+  rmw_subscription->can_loan_messages = subscriber_info->loan_pool.is_enabled();
+  rmw_subscription->is_cft_enabled = filtered_topic != nullptr;
 
   if (!internal) {
     if (rmw_gurumdds_cpp::graph_cache::on_subscriber_created(ctx, node, subscriber_info) != RMW_RET_OK) {
@@ -294,9 +446,13 @@ create_subscription(
     }
   }
 
-  dds_TypeSupport_delete(dds_typesupport);
-  dds_typesupport = nullptr;
+  // Last, a failed creation does not leave the subscription registered
+  if (!init_local_samples(subscriber_info, local_queue_depth)) {
+    RMW_SET_ERROR_MSG("failed to create local sample queue");
+    return nullptr;
+  }
 
+  scope_exit_type_release.cancel();
   scope_exit_rmw_subscription_delete.cancel();
 
   TRACETOOLS_TRACEPOINT(rmw_subscription_init, rmw_subscription, subscriber_info->subscriber_gid.data);
@@ -308,23 +464,47 @@ destroy_subscription(
   rmw_context_impl_t * const ctx,
   rmw_subscription_t * const subscription)
 {
-  std::lock_guard<std::mutex> guard(ctx->endpoint_mutex);
-
   auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
   if (subscriber_info == nullptr) {
     RMW_SET_ERROR_MSG("invalid subscriber data");
     return RMW_RET_ERROR;
   }
 
-  dds_DataSeq_delete(subscriber_info->data_seq);
-  dds_SampleInfoSeq_delete(subscriber_info->info_seq);
-  dds_UnsignedLongSeq_delete(subscriber_info->raw_data_sizes);
+  // The read condition and the event guard conditions are about to be deleted
+  clean_wait_set_caches();
+
+  // No publisher hands samples over once the subscription is removed
+  if (subscriber_info->local_samples != nullptr && subscriber_info->filtered_topic == nullptr) {
+    ctx->intra_context->remove_subscription(subscriber_info);
+  }
+
+  for (const auto & loaned_sample : subscriber_info->loaned_samples) {
+    if (subscriber_info->topic_reader != nullptr) {
+      const SampleSequences & loan = loaned_sample.second;
+      dds_DataReader_raw_return_loan(
+        subscriber_info->topic_reader, loan.data_seq, loan.info_seq, loan.raw_data_sizes);
+    }
+    SampleSequencePool::destroy(loaned_sample.second);
+  }
+  subscriber_info->loaned_samples.clear();
+  for (const auto & loaned_payload : subscriber_info->loaned_serialized) {
+    const SampleSequences & loan = loaned_payload.second.sample;
+    if (loan.data_seq == nullptr) {
+      continue;
+    }
+    if (subscriber_info->topic_reader != nullptr) {
+      dds_DataReader_raw_return_loan(
+        subscriber_info->topic_reader, loan.data_seq, loan.info_seq, loan.raw_data_sizes);
+    }
+    SampleSequencePool::destroy(loan);
+  }
+  subscriber_info->loaned_serialized.clear();
 
   dds_ReturnCode_t ret;
   if (subscriber_info->topic_reader != nullptr) {
-    dds_Topic * topic =
-      reinterpret_cast<dds_Topic *>(dds_DataReader_get_topicdescription(
-        subscriber_info->topic_reader));
+    dds_Topic * topic = get_related_topic(subscriber_info);
+    TopicLockGuard topic_guard;
+    topic_guard.lock(ctx->topic_locks, dds_Topic_get_name(topic));
 
     ret = dds_DataReader_delete_readcondition(subscriber_info->topic_reader, subscriber_info->read_condition);
     if (dds_RETCODE_OK != ret) {
@@ -332,13 +512,25 @@ destroy_subscription(
       return RMW_RET_ERROR;
     }
 
-    ret = dds_Subscriber_delete_datareader(ctx->subscriber, subscriber_info->topic_reader);
+    ret = dds_Subscriber_delete_datareader(
+      dds_DataReader_get_subscriber(subscriber_info->topic_reader), subscriber_info->topic_reader);
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("failed to delete datareader");
       return RMW_RET_ERROR;
     }
 
+    if (subscriber_info->filtered_topic != nullptr) {
+      ret = dds_DomainParticipant_delete_contentfilteredtopic(
+        ctx->participant, subscriber_info->filtered_topic);
+      if (ret != dds_RETCODE_OK) {
+        RMW_SET_ERROR_MSG("failed to delete content filtered topic");
+        return RMW_RET_ERROR;
+      }
+      subscriber_info->filtered_topic = nullptr;
+    }
+
     TopicEventListener::remove_event(topic, subscriber_info);
+    TopicEventListener * topic_listener = TopicEventListener::get_listener(topic);
     subscriber_info->topic_reader = nullptr;
     ret = dds_DomainParticipant_delete_topic(ctx->participant, topic);
     if (ret == dds_RETCODE_PRECONDITION_NOT_MET) {
@@ -347,21 +539,137 @@ destroy_subscription(
       RMW_SET_ERROR_MSG("failed to delete topic");
       return RMW_RET_ERROR;
     } else {
-      TopicEventListener::disassociate_Listener(topic);
+      TopicEventListener::disassociate_listener(topic_listener);
     }
   }
 
-  for(auto condition: subscriber_info->event_guard_cond) {
+  for(dds_GuardCondition * condition: subscriber_info->event_guard_cond) {
     if(nullptr != condition) {
       dds_GuardCondition_delete(condition);
     }
   }
 
+  ctx->type_registry.release(subscriber_info->rosidl_message_typesupport);
   delete subscriber_info;
   subscription->data = nullptr;
   return RMW_RET_OK;
 }
 
+static void
+fill_message_info(
+  const char * identifier,
+  SubscriberInfo * subscriber_info,
+  const dds_SampleInfoEx * sampleinfo_ex,
+  rmw_message_info_t * message_info)
+{
+  int64_t sequence_number = 0;
+  rmw_gurumdds_cpp::dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
+  message_info->source_timestamp =
+    sampleinfo_ex->info.source_timestamp.sec * static_cast<int64_t>(1000000000) +
+    sampleinfo_ex->info.source_timestamp.nanosec;
+  message_info->received_timestamp =
+    sampleinfo_ex->reception_timestamp.sec * static_cast<int64_t>(1000000000) +
+    sampleinfo_ex->reception_timestamp.nanosec;
+  message_info->publication_sequence_number = sequence_number;
+  message_info->reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
+  rmw_gid_t * sender_gid = &message_info->publisher_gid;
+  sender_gid->implementation_identifier = identifier;
+  std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
+  dds_ReturnCode_t ret = subscriber_info->get_publication_guid(
+    sampleinfo_ex->info.publication_handle, sender_gid->data);
+  if (ret != dds_RETCODE_OK) {
+    if (ret == dds_RETCODE_ERROR) {
+      RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "Failed to get publication handle");
+    }
+    std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
+  }
+}
+
+static void
+fill_message_info(
+  const char * identifier,
+  const LocalSample & sample,
+  rmw_message_info_t * message_info)
+{
+  message_info->source_timestamp = sample.source_timestamp;
+  message_info->received_timestamp = sample.received_timestamp;
+  message_info->publication_sequence_number = sample.sequence_number;
+  message_info->reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
+  message_info->publisher_gid = sample.publisher_gid;
+  message_info->publisher_gid.implementation_identifier = identifier;
+}
+
+// Records the latency and the sequence number of a taken sample
+static void
+record_sample(SubscriberInfo * subscriber_info, const dds_SampleInfoEx * sampleinfo_ex)
+{
+  int64_t sequence_number = 0;
+  dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
+  subscriber_info->on_sequence_number(sampleinfo_ex->info.publication_handle, sequence_number);
+
+  if (subscriber_info->latency != nullptr) {
+    subscriber_info->latency->on_sample(
+      sampleinfo_ex->info.source_timestamp.sec * static_cast<int64_t>(1000000000) +
+      sampleinfo_ex->info.source_timestamp.nanosec,
+      sampleinfo_ex->reception_timestamp.sec * static_cast<int64_t>(1000000000) +
+      sampleinfo_ex->reception_timestamp.nanosec);
+  }
+}
+
+static void
+record_sample(SubscriberInfo * subscriber_info, const LocalSample & sample)
+{
+  subscriber_info->on_local_sequence_number(sample.publisher_gid, sample.sequence_number);
+
+  if (subscriber_info->latency != nullptr) {
+    subscriber_info->latency->on_sample(sample.source_timestamp, sample.received_timestamp);
+  }
+}
+
+// Takes a sample handed over by a publisher of the context, before the ones of the reader.
+// `convert` stores the sample in the output of the take and sets the message it was stored in.
+// *taken stays false if there is none
+template<typename ConvertFn>
+static rmw_ret_t
+take_local(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  SubscriberInfo * subscriber_info,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  ConvertFn && convert)
+{
+  LocalSample sample;
+  const uint64_t take_start_ns = stats_time_ns();
+  if (!subscriber_info->pop_local_sample(sample)) {
+    return RMW_RET_OK;
+  }
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
+
+  const uint64_t convert_start_ns = stats_time_ns();
+  const void * message = nullptr;
+  rmw_ret_t ret = convert(sample, message);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  subscriber_info->stats.on_take(1, sample.size, stats_time_ns() - convert_start_ns, take_ns);
+  record_sample(subscriber_info, sample);
+
+  *taken = true;
+  if (message_info != nullptr) {
+    fill_message_info(identifier, sample, message_info);
+  }
+
+  TRACETOOLS_TRACEPOINT(
+    rmw_take,
+    static_cast<const void *>(subscription),
+    message,
+    sample.source_timestamp,
+    *taken);
+
+  return RMW_RET_OK;
+}
+
 static rmw_ret_t
 take(
   const char * identifier,
@@ -386,9 +694,28 @@ take(
   dds_DataReader * topic_reader = subscriber_info->topic_reader;
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_reader, RMW_RET_ERROR);
 
+  rmw_ret_t local_ret = take_local(
+    identifier, subscription, subscriber_info, taken, message_info,
+    [subscriber_info, ros_message](const LocalSample & sample, const void *& message) {
+      message = ros_message;
+      if (!subscriber_info->message_plan->deserialize(
+          ros_message, sample.buffer->data(), sample.size))
+      {
+        // Error message already set
+        return RMW_RET_ERROR;
+      }
+      return RMW_RET_OK;
+    });
+  if (local_ret != RMW_RET_OK || *taken) {
+    return local_ret;
+  }
+
   dds_SampleInfoEx sample_info{};
+  const uint64_t take_start_ns = stats_time_ns();
   dds_ReturnCode_t ret = dds_DataReader_take_next_sample_w_info_ex(topic_reader, ros_message, &sample_info);
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
   if (ret == dds_RETCODE_NO_DATA) {
+    subscriber_info->stats.on_no_data(take_ns);
     RCUTILS_LOG_DEBUG_NAMED(
       RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
     return RMW_RET_OK;
@@ -403,58 +730,909 @@ take(
     RMW_GURUMDDS_ID, "Received data on topic %s", subscription->topic_name);
   if (sample_info.info.valid_data) {
     *taken = true;
+    // DDS deserialized the sample within the take
+    subscriber_info->stats.on_take(1, get_last_deserialized_size(), 0, take_ns);
+    record_sample(subscriber_info, &sample_info);
     if (message_info != nullptr) {
-      int64_t sequence_number = 0;
-      rmw_gurumdds_cpp::dds_sn_to_ros_sn(sample_info.seq, &sequence_number);
-      message_info->source_timestamp =
-        sample_info.info.source_timestamp.sec * static_cast<int64_t>(1000000000) +
-        sample_info.info.source_timestamp.nanosec;
-      message_info->received_timestamp =
-        sample_info.reception_timestamp.sec * static_cast<int64_t>(1000000000) +
-        sample_info.reception_timestamp.nanosec;
-      message_info->publication_sequence_number = sequence_number;
-      message_info->reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
-      rmw_gid_t * sender_gid = &message_info->publisher_gid;
-      sender_gid->implementation_identifier = identifier;
-      std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
-      ret = dds_DataReader_get_guid_from_publication_handle(
-        topic_reader, sample_info.info.publication_handle, sender_gid->data);
-      if (ret != dds_RETCODE_OK) {
-        if (ret == dds_RETCODE_ERROR) {
-          RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "Failed to get publication handle");
-        }
-        std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
+      fill_message_info(identifier, subscriber_info, &sample_info, message_info);
+    }
+  } else {
+    subscriber_info->stats.on_no_data(take_ns);
+  }
+
+  TRACETOOLS_TRACEPOINT(
+    rmw_take,
+    static_cast<const void *>(subscription),
+    static_cast<const void *>(ros_message),
+    (message_info ? message_info->source_timestamp : 0LL),
+    *taken);
+
+  return RMW_RET_OK;
+}
+
+// Grows the buffer geometrically, so that payloads of a slowly growing size are not reallocated
+// by every take
+static rmw_ret_t
+reserve_serialized_message(rmw_serialized_message_t * serialized_message, size_t size)
+{
+  if (serialized_message->buffer_capacity >= size) {
+    return RMW_RET_OK;
+  }
+  return rmw_serialized_message_resize(
+    serialized_message, std::max(size, serialized_message->buffer_capacity * 2));
+}
+
+static rmw_ret_t
+take_serialized(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation)
+{
+  *taken = false;
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  dds_DataReader * topic_reader = subscriber_info->topic_reader;
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_reader, RMW_RET_ERROR);
+
+  SubscriptionAllocation * subscription_allocation = nullptr;
+  if (allocation != nullptr) {
+    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+      allocation,
+      allocation->implementation_identifier,
+      identifier,
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+    subscription_allocation = static_cast<SubscriptionAllocation *>(allocation->data);
+    if (subscription_allocation == nullptr ||
+      subscription_allocation->message_plan != subscriber_info->message_plan)
+    {
+      RMW_SET_ERROR_MSG("allocation was not initialized for the type of this subscription");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+  }
+
+  rmw_ret_t local_ret = take_local(
+    identifier, subscription, subscriber_info, taken, message_info,
+    [serialized_message](const LocalSample & sample, const void *& message) {
+      message = serialized_message;
+      rmw_ret_t rmw_ret = reserve_serialized_message(serialized_message, sample.size);
+      if (rmw_ret != RMW_RET_OK) {
+        // Error message already set
+        return rmw_ret;
+      }
+      std::memcpy(serialized_message->buffer, sample.buffer->data(), sample.size);
+      serialized_message->buffer_length = sample.size;
+      return RMW_RET_OK;
+    });
+  if (local_ret != RMW_RET_OK || *taken) {
+    return local_ret;
+  }
+
+  SampleSequences loan{};
+  if (subscription_allocation != nullptr) {
+    loan = subscription_allocation->sample;
+  } else if (!subscriber_info->sample_pool.acquire(1, loan)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  auto scope_exit_loan_return = rcpputils::make_scope_exit(
+    [subscriber_info, topic_reader, &loan, subscription_allocation]() {
+      if (subscription_allocation != nullptr) {
+        dds_DataReader_raw_return_loan(topic_reader, loan.data_seq, loan.info_seq, loan.raw_data_sizes);
+      } else {
+        subscriber_info->sample_pool.release(topic_reader, loan);
       }
+    });
+
+  const uint64_t take_start_ns = stats_time_ns();
+  dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+    topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes, 1,
+    dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
+
+  if (ret == dds_RETCODE_NO_DATA) {
+    subscriber_info->stats.on_no_data(take_ns);
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
+    return RMW_RET_OK;
+  }
+
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to take data");
+    return RMW_RET_ERROR;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID, "Received data on topic %s", subscription->topic_name);
+
+  dds_SampleInfo * sample_info = dds_SampleInfoSeq_get(loan.info_seq, 0);
+
+  if (sample_info->valid_data) {
+    void * sample = dds_DataSeq_get(loan.data_seq, 0);
+    if (sample == nullptr) {
+      RMW_SET_ERROR_MSG("failed to take data");
+      return RMW_RET_ERROR;
+    }
+
+    const uint64_t copy_start_ns = stats_time_ns();
+    const uint32_t sample_size = dds_UnsignedLongSeq_get(loan.raw_data_sizes, 0);
+    // The serialized message is the CDR payload, decompressed if the writer compressed it
+    const bool compressed = is_compressed_payload(sample, sample_size);
+    const size_t message_size =
+      compressed ? get_decompressed_size(sample, sample_size) : sample_size;
+    rmw_ret_t rmw_ret = reserve_serialized_message(serialized_message, message_size);
+    if (rmw_ret != RMW_RET_OK) {
+      // Error message already set
+      return rmw_ret;
+    }
+
+    if (!compressed) {
+      std::memcpy(serialized_message->buffer, sample, sample_size);
+    } else if (!decompress_payload(
+        sample, sample_size, serialized_message->buffer, message_size))
+    {
+      // Error message already set
+      return RMW_RET_ERROR;
+    }
+    serialized_message->buffer_length = message_size;
+
+    *taken = true;
+    subscriber_info->stats.on_take(1, sample_size, stats_time_ns() - copy_start_ns, take_ns);
+    record_sample(subscriber_info, reinterpret_cast<dds_SampleInfoEx *>(sample_info));
+
+    if (message_info != nullptr) {
+      fill_message_info(
+        identifier, subscriber_info,
+        reinterpret_cast<dds_SampleInfoEx *>(sample_info), message_info);
     }
+  } else {
+    subscriber_info->stats.on_no_data(take_ns);
+  }
+
+  TRACETOOLS_TRACEPOINT(
+    rmw_take,
+    static_cast<const void *>(subscription),
+    static_cast<const void *>(serialized_message),
+    (message_info ? message_info->source_timestamp : 0LL),
+    *taken);
+
+  return RMW_RET_OK;
+}
+
+static rmw_ret_t
+take_loaned(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info)
+{
+  *taken = false;
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  if (!subscription->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported by this subscription");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  dds_DataReader * topic_reader = subscriber_info->topic_reader;
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_reader, RMW_RET_ERROR);
+
+  rmw_ret_t local_ret = take_local(
+    identifier, subscription, subscriber_info, taken, message_info,
+    [subscriber_info, loaned_message](const LocalSample & sample, const void *& message) {
+      void * ros_message = subscriber_info->loan_pool.borrow();
+      if (ros_message == nullptr) {
+        RMW_SET_ERROR_MSG("failed to allocate loaned message");
+        return RMW_RET_BAD_ALLOC;
+      }
+      if (!subscriber_info->message_plan->deserialize(
+          ros_message, sample.buffer->data(), sample.size))
+      {
+        // Error message already set
+        subscriber_info->loan_pool.release(ros_message);
+        return RMW_RET_ERROR;
+      }
+      *loaned_message = ros_message;
+      message = ros_message;
+      return RMW_RET_OK;
+    });
+  if (local_ret != RMW_RET_OK || *taken) {
+    return local_ret;
+  }
+
+  SampleSequences loan{};
+  if (!subscriber_info->sample_pool.acquire(1, loan)) {
+    RMW_SET_ERROR_MSG("failed to create loaned sample sequences");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  const uint64_t take_start_ns = stats_time_ns();
+  dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+    topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes, 1,
+    dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
+
+  if (ret == dds_RETCODE_NO_DATA) {
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    subscriber_info->stats.on_no_data(take_ns);
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
+    return RMW_RET_OK;
+  }
+
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to take data");
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    return RMW_RET_ERROR;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID, "Received data on topic %s", subscription->topic_name);
+
+  auto sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(loan.info_seq, 0));
+  if (!sampleinfo_ex->info.valid_data) {
+    subscriber_info->stats.on_no_data(take_ns);
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    return RMW_RET_OK;
+  }
+
+  auto sample = static_cast<uint8_t *>(dds_DataSeq_get(loan.data_seq, 0));
+  if (sample == nullptr) {
+    RMW_SET_ERROR_MSG("failed to take data");
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    return RMW_RET_ERROR;
+  }
+
+  // A native-endian sample is the message itself, if it is suitably aligned in the DDS cache
+  const uint64_t deserialize_start_ns = stats_time_ns();
+  const MessagePlan * message_plan = subscriber_info->message_plan;
+  uint32_t sample_size = dds_UnsignedLongSeq_get(loan.raw_data_sizes, 0);
+  void * ros_message = sample + CDR_HEADER_SIZE;
+  bool in_place = sample_size >= CDR_HEADER_SIZE + message_plan->get_message_size() &&
+    !is_compressed_payload(sample, sample_size) &&
+    sample[CDR_HEADER_ENDIAN_IDX] == CDR_SYSTEM_ENDIAN &&
+    reinterpret_cast<uintptr_t>(ros_message) % message_plan->get_plain_alignment() == 0;
+  if (in_place) {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_loans};
+    subscriber_info->loaned_samples.emplace(ros_message, loan);
+  } else {
+    ros_message = subscriber_info->loan_pool.borrow();
+    if (ros_message == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate loaned message");
+      subscriber_info->sample_pool.release(topic_reader, loan);
+      return RMW_RET_BAD_ALLOC;
+    }
+
+    if (!message_plan->deserialize(ros_message, sample, sample_size)) {
+      // Error message already set
+      subscriber_info->loan_pool.release(ros_message);
+      subscriber_info->sample_pool.release(topic_reader, loan);
+      return RMW_RET_ERROR;
+    }
+    subscriber_info->sample_pool.release(topic_reader, loan);
+  }
+  subscriber_info->stats.on_take(1, sample_size, stats_time_ns() - deserialize_start_ns, take_ns);
+  record_sample(subscriber_info, sampleinfo_ex);
+
+  *loaned_message = ros_message;
+  *taken = true;
+
+  if (message_info != nullptr) {
+    fill_message_info(identifier, subscriber_info, sampleinfo_ex, message_info);
+  }
+
+  TRACETOOLS_TRACEPOINT(
+    rmw_take,
+    static_cast<const void *>(subscription),
+    static_cast<const void *>(ros_message),
+    (message_info ? message_info->source_timestamp : 0LL),
+    *taken);
+
+  return RMW_RET_OK;
+}
+
+// A reader cannot move to another topic description, so adding, changing or removing
+// the filter expression replaces the reader. The subscription gets a new GID.
+static rmw_ret_t
+replace_topic_reader(
+  SubscriberInfo * subscriber_info,
+  const rmw_subscription_content_filter_options_t * options)
+{
+  rmw_context_impl_t * ctx = subscriber_info->ctx;
+  {
+    std::lock_guard<std::mutex> guard(subscriber_info->mutex_loans);
+    if (!subscriber_info->loaned_samples.empty() || !subscriber_info->loaned_serialized.empty()) {
+      RMW_SET_ERROR_MSG("cannot change the content filter while messages are loaned");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  // The new reader stays in the group of the one it replaces
+  dds_Subscriber * subscriber = dds_DataReader_get_subscriber(subscriber_info->topic_reader);
+  dds_Topic * topic = get_related_topic(subscriber_info);
+  dds_DataReaderQos datareader_qos;
+  dds_ReturnCode_t ret = dds_DataReader_get_qos(subscriber_info->topic_reader, &datareader_qos);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to get datareader qos");
+    return RMW_RET_ERROR;
+  }
+
+  dds_ContentFilteredTopic * filtered_topic = nullptr;
+  if (options != nullptr) {
+    filtered_topic = create_filtered_topic(ctx->participant, topic, options);
+    if (filtered_topic == nullptr) {
+      // Error message already set
+      dds_DataReaderQos_finalize(&datareader_qos);
+      return RMW_RET_ERROR;
+    }
+  }
+
+  dds_DataReader * topic_reader = dds_Subscriber_create_datareader(
+    subscriber,
+    filtered_topic != nullptr ? reinterpret_cast<dds_Topic *>(filtered_topic) : topic,
+    &datareader_qos, nullptr, 0);
+  dds_DataReaderQos_finalize(&datareader_qos);
+  if (topic_reader == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create datareader");
+    if (filtered_topic != nullptr) {
+      dds_DomainParticipant_delete_contentfilteredtopic(ctx->participant, filtered_topic);
+    }
+    return RMW_RET_ERROR;
+  }
+
+  // The group of create_endpoints creates its readers disabled
+  if (subscriber == ctx->bulk_subscriber &&
+    dds_Entity_enable(reinterpret_cast<dds_Entity *>(topic_reader)) != dds_RETCODE_OK)
+  {
+    RMW_SET_ERROR_MSG("failed to enable datareader");
+    dds_Subscriber_delete_datareader(subscriber, topic_reader);
+    if (filtered_topic != nullptr) {
+      dds_DomainParticipant_delete_contentfilteredtopic(ctx->participant, filtered_topic);
+    }
+    return RMW_RET_ERROR;
+  }
+
+  dds_ReadCondition * read_condition = dds_DataReader_create_readcondition(
+    topic_reader, dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+  if (read_condition == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create read condition");
+    dds_Subscriber_delete_datareader(subscriber, topic_reader);
+    if (filtered_topic != nullptr) {
+      dds_DomainParticipant_delete_contentfilteredtopic(ctx->participant, filtered_topic);
+    }
+    return RMW_RET_ERROR;
+  }
+
+  if (subscriber_info->node != nullptr &&
+    graph_cache::on_subscriber_deleted(ctx, subscriber_info->node, subscriber_info) != RMW_RET_OK)
+  {
+    RMW_SET_ERROR_MSG("failed to update graph for subscriber");
+    dds_DataReader_delete_readcondition(topic_reader, read_condition);
+    dds_Subscriber_delete_datareader(subscriber, topic_reader);
+    if (filtered_topic != nullptr) {
+      dds_DomainParticipant_delete_contentfilteredtopic(ctx->participant, filtered_topic);
+    }
+    return RMW_RET_ERROR;
+  }
+
+  // Registered again with the GID of the new reader, if it has no filter
+  if (subscriber_info->local_samples != nullptr && subscriber_info->filtered_topic == nullptr) {
+    ctx->intra_context->remove_subscription(subscriber_info);
+  }
+
+  clean_wait_set_caches();
+  dds_DataReader_delete_readcondition(subscriber_info->topic_reader, subscriber_info->read_condition);
+  dds_Subscriber_delete_datareader(subscriber, subscriber_info->topic_reader);
+  if (subscriber_info->filtered_topic != nullptr) {
+    dds_DomainParticipant_delete_contentfilteredtopic(
+      ctx->participant, subscriber_info->filtered_topic);
+  }
+
+  {
+    std::lock_guard<std::mutex> callback_guard(subscriber_info->event_callback_data.mutex);
+    std::lock_guard<std::mutex> event_guard(subscriber_info->mutex_event);
+    subscriber_info->topic_reader = topic_reader;
+    subscriber_info->read_condition = read_condition;
+    subscriber_info->filtered_topic = filtered_topic;
+    dds_DataReader_set_listener_context(topic_reader, subscriber_info);
+    if (subscriber_info->mask != 0) {
+      dds_DataReader_set_listener(
+        topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(subscriber_info->mutex_publications);
+    subscriber_info->publications.clear();
+    subscriber_info->publication_handles.clear();
+  }
+
+  entity_get_gid(reinterpret_cast<dds_Entity *>(topic_reader), subscriber_info->subscriber_gid);
+  if (subscriber_info->local_samples != nullptr && filtered_topic == nullptr) {
+    ctx->intra_context->add_subscription(subscriber_info);
+  }
+
+  if (subscriber_info->node != nullptr &&
+    graph_cache::on_subscriber_created(ctx, subscriber_info->node, subscriber_info) != RMW_RET_OK)
+  {
+    RMW_SET_ERROR_MSG("failed to update graph for subscriber");
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+
+static rmw_ret_t
+set_content_filter(
+  rmw_subscription_t * subscription,
+  const rmw_subscription_content_filter_options_t * options)
+{
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid subscription data");
+    return RMW_RET_ERROR;
+  }
+
+  // Serializes the changes of the filter with the endpoints created and deleted on the topic
+  TopicLockGuard topic_guard;
+  topic_guard.lock(
+    subscriber_info->ctx->topic_locks, dds_Topic_get_name(get_related_topic(subscriber_info)));
+  const bool enable = is_content_filter_set(options);
+  if (!enable && subscriber_info->filtered_topic == nullptr) {
+    return RMW_RET_OK;
+  }
+
+  // Only the parameters changed, the reader is kept and DDS filters with the new values
+  if (enable && subscriber_info->filtered_topic != nullptr &&
+    strcmp(
+      dds_ContentFilteredTopic_get_filter_expression(subscriber_info->filtered_topic),
+      options->filter_expression) == 0)
+  {
+    dds_StringSeq * parameters = create_expression_parameters(options->expression_parameters);
+    if (parameters == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate expression parameters");
+      return RMW_RET_BAD_ALLOC;
+    }
+
+    dds_ReturnCode_t ret = dds_ContentFilteredTopic_set_expression_parameters(
+      subscriber_info->filtered_topic, parameters);
+    dds_StringSeq_delete(parameters);
+    if (ret != dds_RETCODE_OK) {
+      RMW_SET_ERROR_MSG("failed to set expression parameters");
+      return check_dds_ret_code(ret);
+    }
+
+    return RMW_RET_OK;
+  }
+
+  rmw_ret_t rc = replace_topic_reader(subscriber_info, enable ? options : nullptr);
+  if (rc != RMW_RET_OK) {
+    return rc;
+  }
+
+  subscription->is_cft_enabled = enable;
+  return RMW_RET_OK;
+}
+
+static rmw_ret_t
+get_content_filter(
+  const rmw_subscription_t * subscription,
+  rcutils_allocator_t * allocator,
+  rmw_subscription_content_filter_options_t * options)
+{
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  if (subscriber_info == nullptr) {
+    RMW_SET_ERROR_MSG("invalid subscription data");
+    return RMW_RET_ERROR;
+  }
+
+  // Serializes the changes of the filter with the endpoints created and deleted on the topic
+  TopicLockGuard topic_guard;
+  topic_guard.lock(
+    subscriber_info->ctx->topic_locks, dds_Topic_get_name(get_related_topic(subscriber_info)));
+  if (subscriber_info->filtered_topic == nullptr) {
+    RMW_SET_ERROR_MSG("content filter is not set on the subscription");
+    return RMW_RET_ERROR;
+  }
+
+  dds_StringSeq * parameters = dds_StringSeq_create(0);
+  if (parameters == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate expression parameters");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  auto scope_exit_parameters_delete = rcpputils::make_scope_exit(
+    [parameters]() {
+      dds_StringSeq_delete(parameters);
+    });
+
+  dds_ReturnCode_t ret = dds_ContentFilteredTopic_get_expression_parameters(
+    subscriber_info->filtered_topic, parameters);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to get expression parameters");
+    return check_dds_ret_code(ret);
+  }
+
+  const uint32_t parameter_count = dds_StringSeq_length(parameters);
+  std::vector<const char *> parameter_argv(parameter_count);
+  for (uint32_t i = 0; i < parameter_count; i++) {
+    parameter_argv[i] = dds_StringSeq_get(parameters, i);
+  }
+
+  // Copies the expression and the parameters with the caller's allocator
+  return rmw_subscription_content_filter_options_init(
+    dds_ContentFilteredTopic_get_filter_expression(subscriber_info->filtered_topic),
+    parameter_count,
+    parameter_argv.data(),
+    allocator,
+    options);
+}
+
+rmw_subscription_t *
+create_node_subscription(
+  const rmw_node_t * node,
+  const rosidl_message_type_support_t * type_supports,
+  const char * topic_name,
+  const rmw_qos_profile_t * qos_policies,
+  const rmw_subscription_options_t * subscription_options,
+  dds_Subscriber * const sub)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, nullptr);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    node,
+    node->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return nullptr);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_supports, nullptr);
+  RMW_CHECK_ARGUMENT_FOR_NULL(topic_name, nullptr);
+  if (strlen(topic_name) == 0) {
+    RMW_SET_ERROR_MSG("topic_name argument is empty");
+    return nullptr;
+  }
+  RMW_CHECK_ARGUMENT_FOR_NULL(qos_policies, nullptr);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription_options, nullptr);
+
+  // Adapt any 'best available' QoS options
+  rmw_qos_profile_t adapted_qos_policies = *qos_policies;
+  rmw_ret_t ret = rmw_dds_common::qos_profile_get_best_available_for_topic_subscription(
+    node, topic_name, &adapted_qos_policies, rmw_get_publishers_info_by_topic);
+  if (ret != RMW_RET_OK) {
+    return nullptr;
+  }
+
+  if (!adapted_qos_policies.avoid_ros_namespace_conventions) {
+    int validation_result = RMW_TOPIC_VALID;
+    ret = rmw_validate_full_topic_name(topic_name, &validation_result, nullptr);
+    if (ret != RMW_RET_OK) {
+      return nullptr;
+    }
+    if (validation_result != RMW_TOPIC_VALID) {
+      const char * reason = rmw_full_topic_name_validation_result_string(validation_result);
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "topic name is invalid: %s", reason);
+      return nullptr;
+    }
+  }
+
+  if (subscription_options->require_unique_network_flow_endpoints ==
+    RMW_UNIQUE_NETWORK_FLOW_ENDPOINTS_STRICTLY_REQUIRED)
+  {
+    RMW_SET_ERROR_MSG("Unique network flow endpoints not supported on subscriptions");
+    return nullptr;
+  }
+
+  rmw_context_impl_t * ctx = node->context->impl;
+
+  rmw_subscription_t * const rmw_sub =
+    rmw_gurumdds_cpp::create_subscription(
+    ctx,
+    node,
+    ctx->participant,
+    sub != nullptr ? sub : ctx->get_subscriber(ctx->select_entity_group(topic_name)),
+    type_supports,
+    topic_name,
+    &adapted_qos_policies,
+    subscription_options,
+    RMW_AUTOMATIC_DISCOVERY_RANGE_LOCALHOST == ctx->base->options.discovery_options.automatic_discovery_range);
+
+  if (rmw_sub == nullptr) {
+    RMW_SET_ERROR_MSG("failed to create RMW subscription");
+    return nullptr;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID,
+    "Created subscription with topic '%s' on node '%s%s%s'",
+    topic_name, node->namespace_,
+    node->namespace_[strlen(node->namespace_) - 1] == '/' ? "" : "/", node->name);
+
+  return rmw_sub;
+}
+
+rmw_ret_t
+take_loaned_serialized_message(
+  const rmw_subscription_t * subscription,
+  const uint8_t ** buffer,
+  size_t * length,
+  bool * taken,
+  rmw_message_info_t * message_info)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(buffer, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(length, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  *taken = false;
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  dds_DataReader * topic_reader = subscriber_info->topic_reader;
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_reader, RMW_RET_ERROR);
+
+  // The loan keeps the buffer shared with the other subscriptions of the context
+  rmw_ret_t local_ret = take_local(
+    RMW_GURUMDDS_ID, subscription, subscriber_info, taken, message_info,
+    [subscriber_info, buffer, length](const LocalSample & sample, const void *& message) {
+      message = sample.buffer->data();
+      std::lock_guard<std::mutex> guard{subscriber_info->mutex_loans};
+      subscriber_info->loaned_serialized.emplace(message, SerializedLoan{{}, sample.buffer});
+      *buffer = sample.buffer->data();
+      *length = sample.size;
+      return RMW_RET_OK;
+    });
+  if (local_ret != RMW_RET_OK || *taken) {
+    return local_ret;
+  }
+
+  SampleSequences loan{};
+  if (!subscriber_info->sample_pool.acquire(1, loan)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  const uint64_t take_start_ns = stats_time_ns();
+  dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+    topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes, 1,
+    dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
+
+  if (ret == dds_RETCODE_NO_DATA) {
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    subscriber_info->stats.on_no_data(take_ns);
+    RCUTILS_LOG_DEBUG_NAMED(
+      RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
+    return RMW_RET_OK;
+  }
+
+  if (ret != dds_RETCODE_OK) {
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    RMW_SET_ERROR_MSG("failed to take data");
+    return RMW_RET_ERROR;
+  }
+
+  auto sampleinfo_ex =
+    reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(loan.info_seq, 0));
+  if (!sampleinfo_ex->info.valid_data) {
+    subscriber_info->stats.on_no_data(take_ns);
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    return RMW_RET_OK;
+  }
+
+  auto sample = static_cast<uint8_t *>(dds_DataSeq_get(loan.data_seq, 0));
+  if (sample == nullptr) {
+    RMW_SET_ERROR_MSG("failed to take data");
+    subscriber_info->sample_pool.release(topic_reader, loan);
+    return RMW_RET_ERROR;
+  }
+
+  const uint64_t copy_start_ns = stats_time_ns();
+  const uint32_t sample_size = dds_UnsignedLongSeq_get(loan.raw_data_sizes, 0);
+  SerializedLoan serialized_loan{};
+  if (is_compressed_payload(sample, sample_size)) {
+    const size_t message_size = get_decompressed_size(sample, sample_size);
+    std::shared_ptr<MessageBuffer> decompressed{new(std::nothrow) MessageBuffer()};
+    if (decompressed == nullptr || decompressed->grow(message_size) == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate message buffer");
+      subscriber_info->sample_pool.release(topic_reader, loan);
+      return RMW_RET_BAD_ALLOC;
+    }
+    if (!decompress_payload(sample, sample_size, decompressed->data(), message_size)) {
+      // Error message already set
+      subscriber_info->sample_pool.release(topic_reader, loan);
+      return RMW_RET_ERROR;
+    }
+    *buffer = decompressed->data();
+    *length = message_size;
+    serialized_loan.buffer = std::move(decompressed);
+  } else {
+    serialized_loan.sample = loan;
+    *buffer = sample;
+    *length = sample_size;
+  }
+
+  if (message_info != nullptr) {
+    fill_message_info(RMW_GURUMDDS_ID, subscriber_info, sampleinfo_ex, message_info);
+  }
+  if (serialized_loan.buffer != nullptr) {
+    subscriber_info->sample_pool.release(topic_reader, loan);
+  }
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_loans};
+    subscriber_info->loaned_serialized.emplace(*buffer, serialized_loan);
+  }
+  *taken = true;
+  subscriber_info->stats.on_take(1, sample_size, stats_time_ns() - copy_start_ns, take_ns);
+  record_sample(subscriber_info, sampleinfo_ex);
+
+  TRACETOOLS_TRACEPOINT(
+    rmw_take,
+    static_cast<const void *>(subscription),
+    static_cast<const void *>(*buffer),
+    (message_info ? message_info->source_timestamp : 0LL),
+    *taken);
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+return_loaned_serialized_message(
+  const rmw_subscription_t * subscription,
+  const uint8_t * buffer)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(buffer, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  SerializedLoan serialized_loan{};
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_loans};
+    auto it = subscriber_info->loaned_serialized.find(buffer);
+    if (it == subscriber_info->loaned_serialized.end()) {
+      RMW_SET_ERROR_MSG("payload was not loaned by this subscription");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    serialized_loan = std::move(it->second);
+    subscriber_info->loaned_serialized.erase(it);
+  }
+
+  if (serialized_loan.sample.data_seq != nullptr) {
+    subscriber_info->sample_pool.release(subscriber_info->topic_reader, serialized_loan.sample);
+  }
+  return RMW_RET_OK;
+}
+
+// Checks that arena takes of the subscription can use the allocation
+static rmw_ret_t
+get_arena_allocation(
+  const SubscriberInfo * subscriber_info,
+  rmw_subscription_allocation_t * allocation,
+  SubscriptionAllocation ** subscription_allocation)
+{
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation,
+    allocation->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  *subscription_allocation = static_cast<SubscriptionAllocation *>(allocation->data);
+  if (*subscription_allocation == nullptr ||
+    (*subscription_allocation)->message_plan != subscriber_info->message_plan)
+  {
+    RMW_SET_ERROR_MSG("allocation was not initialized for the type of this subscription");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // C++ messages own their members
+  const MessagePlan * plan = subscriber_info->message_plan;
+  if (plan->get_type_support()->typesupport_identifier !=
+    rosidl_typesupport_introspection_c__identifier)
+  {
+    RMW_SET_ERROR_MSG("arena takes are only supported by C introspection type supports");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  return RMW_RET_OK;
+}
+
+static DeserializationArena *
+get_arena(const SubscriberInfo * subscriber_info, SubscriptionAllocation * subscription_allocation)
+{
+  if (subscription_allocation->arena == nullptr) {
+    subscription_allocation->arena.reset(
+      new(std::nothrow) DeserializationArena(subscriber_info->ctx->buffer_memory));
+    if (subscription_allocation->arena == nullptr) {
+      RMW_SET_ERROR_MSG("failed to allocate deserialization arena");
+    }
+  }
+  return subscription_allocation->arena.get();
+}
+
+// Deserializes a sample into a new message of the arena of the allocation, which invalidates
+// the message of the previous arena take
+static rmw_ret_t
+deserialize_arena_message(
+  SubscriberInfo * subscriber_info,
+  SubscriptionAllocation * subscription_allocation,
+  void * sample,
+  size_t sample_size,
+  void ** ros_message)
+{
+  DeserializationArena * arena = get_arena(subscriber_info, subscription_allocation);
+  if (arena == nullptr) {
+    // Error message already set
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  const MessagePlan * plan = subscription_allocation->message_plan;
+  void * message = nullptr;
+  if (arena->reset()) {
+    message = arena->allocate(plan->get_message_size(), alignof(std::max_align_t));
+  }
+  if (message == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate message from the deserialization arena");
+    return RMW_RET_BAD_ALLOC;
+  }
+  std::memset(message, 0, plan->get_message_size());
+
+  if (!plan->deserialize(message, sample, sample_size, arena)) {
+    // Error message already set
+    return RMW_RET_ERROR;
   }
 
-  TRACETOOLS_TRACEPOINT(
-    rmw_take,
-    static_cast<const void *>(subscription),
-    static_cast<const void *>(ros_message),
-    (message_info ? message_info->source_timestamp : 0LL),
-    *taken);
-
+  *ros_message = message;
   return RMW_RET_OK;
 }
 
-static rmw_ret_t
-take_serialized(
-  const char * identifier,
+rmw_ret_t
+take_arena_message(
   const rmw_subscription_t * subscription,
-  rmw_serialized_message_t * serialized_message,
+  rmw_subscription_allocation_t * allocation,
+  void ** ros_message,
   bool * taken,
-  rmw_message_info_t * message_info,
-  rmw_subscription_allocation_t * allocation)
+  rmw_message_info_t * message_info)
 {
-  RCUTILS_UNUSED(allocation);
-  *taken = false;
-
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
     subscription,
     subscription->implementation_identifier,
-    identifier,
+    RMW_GURUMDDS_ID,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  *taken = false;
 
   auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
@@ -462,124 +1640,139 @@ take_serialized(
   dds_DataReader * topic_reader = subscriber_info->topic_reader;
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(topic_reader, RMW_RET_ERROR);
 
-  dds_DataSeq * data_values = dds_DataSeq_create(1);
-  if (data_values == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create data sequence");
-    return RMW_RET_ERROR;
+  SubscriptionAllocation * subscription_allocation = nullptr;
+  rmw_ret_t rmw_ret =
+    get_arena_allocation(subscriber_info, allocation, &subscription_allocation);
+  if (rmw_ret != RMW_RET_OK) {
+    // Error message already set
+    return rmw_ret;
   }
 
-  dds_SampleInfoSeq * sample_infos = dds_SampleInfoSeq_create(1);
-  if (sample_infos == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample info sequence");
-    dds_DataSeq_delete(data_values);
-    return RMW_RET_ERROR;
+  rmw_ret_t local_ret = take_local(
+    RMW_GURUMDDS_ID, subscription, subscriber_info, taken, message_info,
+    [subscriber_info, subscription_allocation, ros_message](
+      const LocalSample & sample, const void *& message) {
+      rmw_ret_t rmw_ret = deserialize_arena_message(
+        subscriber_info, subscription_allocation, sample.buffer->data(), sample.size,
+        ros_message);
+      message = *ros_message;
+      return rmw_ret;
+    });
+  if (local_ret != RMW_RET_OK || *taken) {
+    return local_ret;
   }
 
-  dds_UnsignedLongSeq * sample_sizes = dds_UnsignedLongSeq_create(1);
-  if (sample_sizes == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample size sequence");
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    return RMW_RET_ERROR;
-  }
+  SampleSequences & loan = subscription_allocation->sample;
+  auto scope_exit_loan_return = rcpputils::make_scope_exit(
+    [topic_reader, &loan]() {
+      dds_DataReader_raw_return_loan(
+        topic_reader, loan.data_seq, loan.info_seq, loan.raw_data_sizes);
+    });
 
+  const uint64_t take_start_ns = stats_time_ns();
   dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
-    topic_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, 1,
+    topic_reader, dds_HANDLE_NIL, loan.data_seq, loan.info_seq, loan.raw_data_sizes, 1,
     dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+  const uint64_t take_ns = stats_time_ns() - take_start_ns;
 
   if (ret == dds_RETCODE_NO_DATA) {
+    subscriber_info->stats.on_no_data(take_ns);
     RCUTILS_LOG_DEBUG_NAMED(
       RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
-    dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    dds_UnsignedLongSeq_delete(sample_sizes);
     return RMW_RET_OK;
   }
 
   if (ret != dds_RETCODE_OK) {
     RMW_SET_ERROR_MSG("failed to take data");
-    dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    dds_UnsignedLongSeq_delete(sample_sizes);
     return RMW_RET_ERROR;
   }
 
-  RCUTILS_LOG_DEBUG_NAMED(
-    RMW_GURUMDDS_ID, "Received data on topic %s", subscription->topic_name);
-
-  dds_SampleInfo * sample_info = dds_SampleInfoSeq_get(sample_infos, 0);
-
-  if (sample_info->valid_data) {
-    void * sample = dds_DataSeq_get(data_values, 0);
-    if (sample == nullptr) {
-      RMW_SET_ERROR_MSG("failed to take data");
-      dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
-      return RMW_RET_ERROR;
-    }
-
-    uint32_t sample_size = dds_UnsignedLongSeq_get(sample_sizes, 0);
-    serialized_message->buffer_length = sample_size;
-    if (serialized_message->buffer_capacity < sample_size) {
-      rmw_ret_t rmw_ret = rmw_serialized_message_resize(serialized_message, sample_size);
-      if (rmw_ret != RMW_RET_OK) {
-        // Error message already set
-        dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-        dds_DataSeq_delete(data_values);
-        dds_SampleInfoSeq_delete(sample_infos);
-        dds_UnsignedLongSeq_delete(sample_sizes);
-        return rmw_ret;
-      }
-    }
-
-    std::memcpy(serialized_message->buffer, sample, sample_size);
+  auto sampleinfo_ex =
+    reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(loan.info_seq, 0));
+  if (!sampleinfo_ex->info.valid_data) {
+    subscriber_info->stats.on_no_data(take_ns);
+    return RMW_RET_OK;
+  }
 
-    *taken = true;
+  void * sample = dds_DataSeq_get(loan.data_seq, 0);
+  if (sample == nullptr) {
+    RMW_SET_ERROR_MSG("failed to take data");
+    return RMW_RET_ERROR;
+  }
 
-    if (message_info != nullptr) {
-      int64_t sequence_number = 0;
-      dds_SampleInfoEx * sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(sample_info);
-      rmw_gurumdds_cpp::dds_sn_to_ros_sn(sampleinfo_ex->seq, &sequence_number);
-      message_info->source_timestamp =
-        sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
-        sample_info->source_timestamp.nanosec;
-      message_info->received_timestamp =
-        sampleinfo_ex->reception_timestamp.sec * static_cast<int64_t>(1000000000) +
-        sampleinfo_ex->reception_timestamp.nanosec;
-      message_info->publication_sequence_number = sequence_number;
-      message_info->reception_sequence_number = RMW_MESSAGE_INFO_SEQUENCE_NUMBER_UNSUPPORTED;
-      rmw_gid_t * sender_gid = &message_info->publisher_gid;
-      sender_gid->implementation_identifier = identifier;
-      std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
-      dds_ReturnCode_t ret = dds_DataReader_get_guid_from_publication_handle(
-        topic_reader, sample_info->publication_handle, sender_gid->data);
-      if (ret != dds_RETCODE_OK) {
-        if (ret == dds_RETCODE_ERROR) {
-          RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "Failed to get publication handle");
-        }
-        std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
-      }
-    }
+  const uint64_t deserialize_start_ns = stats_time_ns();
+  const uint32_t sample_size = dds_UnsignedLongSeq_get(loan.raw_data_sizes, 0);
+  rmw_ret = deserialize_arena_message(
+    subscriber_info, subscription_allocation, sample, sample_size, ros_message);
+  if (rmw_ret != RMW_RET_OK) {
+    return rmw_ret;
   }
 
-  dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-  dds_DataSeq_delete(data_values);
-  dds_SampleInfoSeq_delete(sample_infos);
-  dds_UnsignedLongSeq_delete(sample_sizes);
+  *taken = true;
+  subscriber_info->stats.on_take(
+    1, sample_size, stats_time_ns() - deserialize_start_ns, take_ns);
+  record_sample(subscriber_info, sampleinfo_ex);
+  if (message_info != nullptr) {
+    fill_message_info(RMW_GURUMDDS_ID, subscriber_info, sampleinfo_ex, message_info);
+  }
 
   TRACETOOLS_TRACEPOINT(
     rmw_take,
     static_cast<const void *>(subscription),
-    static_cast<const void *>(serialized_message),
+    static_cast<const void *>(*ros_message),
     (message_info ? message_info->source_timestamp : 0LL),
     *taken);
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+warm_up_subscription_allocation(
+  const rmw_subscription_t * subscription,
+  rmw_subscription_allocation_t * allocation,
+  size_t max_serialized_size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscriber_info = static_cast<SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  SubscriptionAllocation * subscription_allocation = nullptr;
+  rmw_ret_t ret = get_arena_allocation(subscriber_info, allocation, &subscription_allocation);
+  if (ret != RMW_RET_OK) {
+    // Error message already set
+    return ret;
+  }
+
+  const MessagePlan * plan = subscription_allocation->message_plan;
+  if (max_serialized_size == 0) {
+    if (!plan->is_bounded()) {
+      RMW_SET_ERROR_MSG("message type is unbounded, a maximum serialized size is required");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    max_serialized_size = plan->get_max_serialized_size();
+  }
+
+  DeserializationArena * arena = get_arena(subscriber_info, subscription_allocation);
+  if (arena == nullptr) {
+    // Error message already set
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  // Strings and sequences take about their serialized size, plus the alignment of each sequence
+  if (!arena->reserve(plan->get_message_size() + 2 * max_serialized_size)) {
+    RMW_SET_ERROR_MSG("failed to allocate deserialization arena");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  return RMW_RET_OK;
+}
 } // namespace rmw_gurumdds_cpp
 
 extern "C"
@@ -590,21 +1783,68 @@ rmw_init_subscription_allocation(
   const rosidl_runtime_c__Sequence__bound * message_bounds,
   rmw_subscription_allocation_t * allocation)
 {
-  RCUTILS_UNUSED(type_support);
+  // rosidl does not generate bounds data, the bounds of the introspection members are used
   RCUTILS_UNUSED(message_bounds);
-  RCUTILS_UNUSED(allocation);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
 
-  RMW_SET_ERROR_MSG("rmw_init_subscription_allocation is not supported");
-  return RMW_RET_UNSUPPORTED;
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(type_support, rosidl_typesupport_introspection_c__identifier);
+  if (introspection_type_support == nullptr) {
+    rcutils_reset_error();
+    introspection_type_support = get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+    if (introspection_type_support == nullptr) {
+      rcutils_reset_error();
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+  }
+
+  const rmw_gurumdds_cpp::MessagePlan * message_plan =
+    rmw_gurumdds_cpp::MessagePlan::get(introspection_type_support);
+  if (message_plan == nullptr) {
+    // Error message is already set
+    return RMW_RET_ERROR;
+  }
+
+  auto subscription_allocation = new(std::nothrow) rmw_gurumdds_cpp::SubscriptionAllocation();
+  if (subscription_allocation == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate subscription allocation");
+    return RMW_RET_BAD_ALLOC;
+  }
+  subscription_allocation->message_plan = message_plan;
+
+  if (!rmw_gurumdds_cpp::SampleSequencePool::create(1, subscription_allocation->sample)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    delete subscription_allocation;
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  allocation->implementation_identifier = RMW_GURUMDDS_ID;
+  allocation->data = subscription_allocation;
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
 rmw_fini_subscription_allocation(rmw_subscription_allocation_t * allocation)
 {
-  RCUTILS_UNUSED(allocation);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation,
+    allocation->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  RMW_SET_ERROR_MSG("rmw_fini_subscription_allocation is not supported");
-  return RMW_RET_UNSUPPORTED;
+  auto subscription_allocation =
+    static_cast<rmw_gurumdds_cpp::SubscriptionAllocation *>(allocation->data);
+  if (subscription_allocation != nullptr) {
+    rmw_gurumdds_cpp::SampleSequencePool::destroy(subscription_allocation->sample);
+    delete subscription_allocation;
+  }
+  allocation->implementation_identifier = nullptr;
+  allocation->data = nullptr;
+  return RMW_RET_OK;
 }
 
 rmw_subscription_t *
@@ -615,76 +1855,8 @@ rmw_create_subscription(
   const rmw_qos_profile_t * qos_policies,
   const rmw_subscription_options_t * subscription_options)
 {
-  RMW_CHECK_ARGUMENT_FOR_NULL(node, nullptr);
-  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
-    node,
-    node->implementation_identifier,
-    RMW_GURUMDDS_ID,
-    return nullptr);
-  RMW_CHECK_ARGUMENT_FOR_NULL(type_supports, nullptr);
-  RMW_CHECK_ARGUMENT_FOR_NULL(topic_name, nullptr);
-  if (strlen(topic_name) == 0) {
-    RMW_SET_ERROR_MSG("topic_name argument is empty");
-    return nullptr;
-  }
-  RMW_CHECK_ARGUMENT_FOR_NULL(qos_policies, nullptr);
-  RMW_CHECK_ARGUMENT_FOR_NULL(subscription_options, nullptr);
-
-  // Adapt any 'best available' QoS options
-  rmw_qos_profile_t adapted_qos_policies = *qos_policies;
-  rmw_ret_t ret = rmw_dds_common::qos_profile_get_best_available_for_topic_subscription(
-    node, topic_name, &adapted_qos_policies, rmw_get_publishers_info_by_topic);
-  if (ret != RMW_RET_OK) {
-    return nullptr;
-  }
-
-  if (!adapted_qos_policies.avoid_ros_namespace_conventions) {
-    int validation_result = RMW_TOPIC_VALID;
-    ret = rmw_validate_full_topic_name(topic_name, &validation_result, nullptr);
-    if (ret != RMW_RET_OK) {
-      return nullptr;
-    }
-    if (validation_result != RMW_TOPIC_VALID) {
-      const char * reason = rmw_full_topic_name_validation_result_string(validation_result);
-      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
-        "topic name is invalid: %s", reason);
-      return nullptr;
-    }
-  }
-
-  if (subscription_options->require_unique_network_flow_endpoints ==
-    RMW_UNIQUE_NETWORK_FLOW_ENDPOINTS_STRICTLY_REQUIRED)
-  {
-    RMW_SET_ERROR_MSG("Unique network flow endpoints not supported on subscriptions");
-    return nullptr;
-  }
-
-  rmw_context_impl_t * ctx = node->context->impl;
-
-  rmw_subscription_t * const rmw_sub =
-    rmw_gurumdds_cpp::create_subscription(
-    ctx,
-    node,
-    ctx->participant,
-    ctx->subscriber,
-    type_supports,
-    topic_name,
-    &adapted_qos_policies,
-    subscription_options,
-    RMW_AUTOMATIC_DISCOVERY_RANGE_LOCALHOST == ctx->base->options.discovery_options.automatic_discovery_range);
-
-  if (rmw_sub == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create RMW subscription");
-    return nullptr;
-  }
-
-  RCUTILS_LOG_DEBUG_NAMED(
-    RMW_GURUMDDS_ID,
-    "Created subscription with topic '%s' on node '%s%s%s'",
-    topic_name, node->namespace_,
-    node->namespace_[strlen(node->namespace_) - 1] == '/' ? "" : "/", node->name);
-
-  return rmw_sub;
+  return rmw_gurumdds_cpp::create_node_subscription(
+    node, type_supports, topic_name, qos_policies, subscription_options, nullptr);
 }
 
 rmw_ret_t
@@ -909,117 +2081,145 @@ rmw_take_sequence(
   dds_DataReader * topic_reader = info->topic_reader;
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(topic_reader, "topic reader is null", return RMW_RET_ERROR);
 
-  dds_DataSeq * data_values = dds_DataSeq_create(count);
-  if (data_values == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create data sequence");
-    return RMW_RET_ERROR;
+  // Samples handed over by the publishers of the context come before the ones of the reader
+  rmw_gurumdds_cpp::LocalSample local_sample;
+  const uint64_t local_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+  size_t local_size = 0;
+  while (*taken < count && info->pop_local_sample(local_sample)) {
+    if (!info->message_plan->deserialize(
+        message_sequence->data[*taken], local_sample.buffer->data(), local_sample.size))
+    {
+      // Error message already set
+      message_sequence->size = *taken;
+      message_info_sequence->size = *taken;
+      return RMW_RET_ERROR;
+    }
+    rmw_gurumdds_cpp::fill_message_info(
+      RMW_GURUMDDS_ID, local_sample, &message_info_sequence->data[*taken]);
+    rmw_gurumdds_cpp::record_sample(info, local_sample);
+    (*taken)++;
+    local_size += local_sample.size;
   }
 
-  dds_SampleInfoSeq * sample_infos = dds_SampleInfoSeq_create(count);
-  if (sample_infos == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample info sequence");
-    dds_DataSeq_delete(data_values);
-    return RMW_RET_ERROR;
+  if (*taken > 0) {
+    info->stats.on_take(*taken, local_size, rmw_gurumdds_cpp::stats_time_ns() - local_start_ns, 0);
+    if (*taken == count) {
+      message_sequence->size = *taken;
+      message_info_sequence->size = *taken;
+      return RMW_RET_OK;
+    }
   }
 
-  dds_UnsignedLongSeq * sample_sizes = dds_UnsignedLongSeq_create(count);
-  if (sample_sizes == nullptr) {
-    RMW_SET_ERROR_MSG("failed to create sample size sequence");
-    dds_DataSeq_delete(data_values);
-    dds_SampleInfoSeq_delete(sample_infos);
-    return RMW_RET_ERROR;
+  rmw_gurumdds_cpp::SampleSequences sequences{};
+  if (!info->sample_pool.acquire(static_cast<uint32_t>(count), sequences)) {
+    RMW_SET_ERROR_MSG("failed to create sample sequences");
+    return RMW_RET_BAD_ALLOC;
   }
 
+  auto scope_exit_sequences_release = rcpputils::make_scope_exit(
+    [info, topic_reader, &sequences]() {
+      info->sample_pool.release(topic_reader, sequences);
+    });
+
+  dds_DataSeq * data_values = sequences.data_seq;
+  dds_SampleInfoSeq * sample_infos = sequences.info_seq;
+  dds_UnsignedLongSeq * sample_sizes = sequences.raw_data_sizes;
+
+  // Positions of the valid samples of a batch, kept between calls on the thread
+  thread_local std::vector<uint32_t> valid_samples;
+  rmw_context_impl_t * ctx = info->ctx;
+  // Time of the take that found the reader empty
+  uint64_t no_data_take_ns = 0;
+
   while (*taken < count) {
-    dds_ReturnCode_t ret = dds_DataReader_raw_take(
-      topic_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes, count,
+    size_t requested = count - *taken;
+    const uint64_t take_start_ns = rmw_gurumdds_cpp::stats_time_ns();
+    dds_ReturnCode_t ret = dds_DataReader_raw_take_w_sampleinfoex(
+      topic_reader, dds_HANDLE_NIL, data_values, sample_infos, sample_sizes,
+      static_cast<int32_t>(requested),
       dds_ANY_SAMPLE_STATE, dds_ANY_VIEW_STATE, dds_ANY_INSTANCE_STATE);
+    const uint64_t deserialize_start_ns = rmw_gurumdds_cpp::stats_time_ns();
 
     if (ret == dds_RETCODE_NO_DATA) {
+      no_data_take_ns = deserialize_start_ns - take_start_ns;
       RCUTILS_LOG_DEBUG_NAMED(
         RMW_GURUMDDS_ID, "No data on topic %s", subscription->topic_name);
-      dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
       break;
     }
 
     if (ret != dds_RETCODE_OK) {
       RMW_SET_ERROR_MSG("failed to take data");
-      dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-      dds_DataSeq_delete(data_values);
-      dds_SampleInfoSeq_delete(sample_infos);
-      dds_UnsignedLongSeq_delete(sample_sizes);
       return RMW_RET_ERROR;
     }
 
     RCUTILS_LOG_DEBUG_NAMED(
       RMW_GURUMDDS_ID, "Received data on topic %s", subscription->topic_name);
 
-    const uint32_t length =  dds_SampleInfoSeq_length(sample_infos);
+    const uint32_t length = dds_SampleInfoSeq_length(sample_infos);
+    size_t batch_size = 0;
+    valid_samples.clear();
     for (uint32_t i = 0; i < length; i++) {
-      dds_SampleInfo * sample_info = dds_SampleInfoSeq_get(sample_infos, i);
-
-      if (sample_info->valid_data) {
-        void * sample = dds_DataSeq_get(data_values, i);
-        if (sample == nullptr) {
-          RMW_SET_ERROR_MSG("failed to get message");
-          dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
-          return RMW_RET_ERROR;
-        }
-        uint32_t sample_size = dds_UnsignedLongSeq_get(sample_sizes, i);
-        bool result = rmw_gurumdds_cpp::deserialize_cdr_to_ros(
-          info->rosidl_message_typesupport->data,
-          info->rosidl_message_typesupport->typesupport_identifier,
-          message_sequence->data[*taken],
-          sample,
-          static_cast<size_t>(sample_size)
-        );
-        if (!result) {
-          RMW_SET_ERROR_MSG("failed to deserialize message");
-          dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
-          dds_DataSeq_delete(data_values);
-          dds_SampleInfoSeq_delete(sample_infos);
-          dds_UnsignedLongSeq_delete(sample_sizes);
-          return RMW_RET_ERROR;
-        }
-
-        auto message_info = &(message_info_sequence->data[*taken]);
-        auto sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(sample_info);
-
-        message_info->source_timestamp =
-          sample_info->source_timestamp.sec * static_cast<int64_t>(1000000000) +
-          sample_info->source_timestamp.nanosec;
-        message_info->received_timestamp =
-          sampleinfo_ex->reception_timestamp.sec * static_cast<int64_t>(1000000000) +
-          sampleinfo_ex->reception_timestamp.nanosec;
-        rmw_gid_t * sender_gid = &message_info->publisher_gid;
-        sender_gid->implementation_identifier = RMW_GURUMDDS_ID;
-        std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
-
-        dds_ReturnCode_t ret = dds_DataReader_get_guid_from_publication_handle(
-          topic_reader, sample_info->publication_handle, sender_gid->data);
-        if (ret != dds_RETCODE_OK) {
-          if (ret == dds_RETCODE_ERROR) {
-            RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "Failed to get publication handle");
-          }
-          std::memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
-        }
-
-        (*taken)++;
+      auto sampleinfo_ex = reinterpret_cast<dds_SampleInfoEx *>(dds_SampleInfoSeq_get(sample_infos, i));
+      if (sampleinfo_ex->info.valid_data) {
+        rmw_gurumdds_cpp::fill_message_info(
+          RMW_GURUMDDS_ID, info, sampleinfo_ex,
+          &message_info_sequence->data[*taken + valid_samples.size()]);
+        rmw_gurumdds_cpp::record_sample(info, sampleinfo_ex);
+        valid_samples.push_back(i);
+        batch_size += dds_UnsignedLongSeq_get(sample_sizes, i);
+      }
+    }
+
+    std::atomic<bool> failed{false};
+    auto deserialize = [&](size_t index) {
+      uint32_t i = valid_samples[index];
+      void * sample = dds_DataSeq_get(data_values, i);
+      uint32_t sample_size = dds_UnsignedLongSeq_get(sample_sizes, i);
+      if (sample == nullptr ||
+        !info->message_plan->deserialize(
+          message_sequence->data[*taken + index], sample, static_cast<size_t>(sample_size)))
+      {
+        // Reported once by the calling thread, error state is per thread
+        rmw_reset_error();
+        failed.store(true, std::memory_order_relaxed);
       }
+    };
+
+    if (ctx->deserialization_workers != nullptr &&
+      batch_size >= ctx->parallel_deserialization_threshold)
+    {
+      ctx->deserialization_workers->parallel_for(valid_samples.size(), deserialize);
+    } else {
+      for (size_t index = 0; index < valid_samples.size(); index++) {
+        deserialize(index);
+      }
+    }
+
+    if (failed.load(std::memory_order_relaxed)) {
+      RMW_SET_ERROR_MSG("failed to deserialize message");
+      return RMW_RET_ERROR;
     }
+    info->stats.on_take(
+      valid_samples.size(), batch_size,
+      rmw_gurumdds_cpp::stats_time_ns() - deserialize_start_ns,
+      deserialize_start_ns - take_start_ns);
+
+    *taken += valid_samples.size();
     dds_DataReader_raw_return_loan(topic_reader, data_values, sample_infos, sample_sizes);
+
+    // A short batch drained the reader, a full one with invalid samples leaves room for more
+    if (length < requested) {
+      break;
+    }
+  }
+
+  if (*taken == 0) {
+    info->stats.on_no_data(no_data_take_ns);
   }
 
   message_sequence->size = *taken;
   message_info_sequence->size = *taken;
 
-  dds_DataSeq_delete(data_values);
-  dds_SampleInfoSeq_delete(sample_infos);
-  dds_UnsignedLongSeq_delete(sample_sizes);
-
   return RMW_RET_OK;
 }
 
@@ -1071,13 +2271,13 @@ rmw_take_loaned_message(
   bool * taken,
   rmw_subscription_allocation_t * allocation)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(loaned_message);
-  RCUTILS_UNUSED(taken);
   RCUTILS_UNUSED(allocation);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
 
-  RMW_SET_ERROR_MSG("rmw_take_loaned_message is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_gurumdds_cpp::take_loaned(
+    RMW_GURUMDDS_ID, subscription, loaned_message, taken, nullptr);
 }
 
 rmw_ret_t
@@ -1088,14 +2288,14 @@ rmw_take_loaned_message_with_info(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(loaned_message);
-  RCUTILS_UNUSED(taken);
-  RCUTILS_UNUSED(message_info);
   RCUTILS_UNUSED(allocation);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(message_info, RMW_RET_INVALID_ARGUMENT);
 
-  RMW_SET_ERROR_MSG("rmw_take_loaned_message_with_info is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_gurumdds_cpp::take_loaned(
+    RMW_GURUMDDS_ID, subscription, loaned_message, taken, message_info);
 }
 
 rmw_ret_t
@@ -1103,11 +2303,43 @@ rmw_return_loaned_message_from_subscription(
   const rmw_subscription_t * subscription,
   void * loaned_message)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(loaned_message);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  RMW_SET_ERROR_MSG("rmw_return_loaned_message_from_subscription is not supported");
-  return RMW_RET_UNSUPPORTED;
+  if (!subscription->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported by this subscription");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  auto subscriber_info = static_cast<rmw_gurumdds_cpp::SubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(subscriber_info, RMW_RET_ERROR);
+
+  rmw_gurumdds_cpp::SampleSequences loan{};
+  {
+    std::lock_guard<std::mutex> guard{subscriber_info->mutex_loans};
+    auto it = subscriber_info->loaned_samples.find(loaned_message);
+    if (it != subscriber_info->loaned_samples.end()) {
+      loan = it->second;
+      subscriber_info->loaned_samples.erase(it);
+    }
+  }
+
+  if (loan.data_seq != nullptr) {
+    subscriber_info->sample_pool.release(subscriber_info->topic_reader, loan);
+    return RMW_RET_OK;
+  }
+
+  if (!subscriber_info->loan_pool.release(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this subscription");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
@@ -1144,7 +2376,9 @@ rmw_subscription_set_on_new_message_callback(
   } else {
     subscriber_info->event_callback_data.callback = nullptr;
     subscriber_info->event_callback_data.user_data = nullptr;
-    subscriber_info->mask &= ~dds_DATA_AVAILABLE_STATUS;
+    if (!subscriber_info->event_callback_data.is_set_unsafe()) {
+      subscriber_info->mask &= ~dds_DATA_AVAILABLE_STATUS;
+    }
   }
 
   dds_rc = dds_DataReader_set_listener(subscriber_info->topic_reader, &subscriber_info->topic_listener, subscriber_info->mask);
@@ -1157,11 +2391,15 @@ rmw_subscription_set_content_filter(
   rmw_subscription_t * subscription,
   const rmw_subscription_content_filter_options_t * options)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(options);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(options, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  RMW_SET_ERROR_MSG("rmw_subscription_set_content_filter is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_gurumdds_cpp::set_content_filter(subscription, options);
 }
 
 rmw_ret_t
@@ -1170,12 +2408,16 @@ rmw_subscription_get_content_filter(
   rcutils_allocator_t * allocator,
   rmw_subscription_content_filter_options_t * options)
 {
-  RCUTILS_UNUSED(subscription);
-  RCUTILS_UNUSED(allocator);
-  RCUTILS_UNUSED(options);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ALLOCATOR(allocator, return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(options, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    RMW_GURUMDDS_ID,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  RMW_SET_ERROR_MSG("rmw_subscription_get_content_filter is not supported");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_gurumdds_cpp::get_content_filter(subscription, allocator, options);
 }
 
 rmw_ret_t
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <map>
+#include <memory>
 #include <set>
 
 #include "rcutils/allocator.h"
@@ -24,8 +25,9 @@
 #include "rmw/rmw.h"
 
 #include "rmw_gurumdds_cpp/dds_include.hpp"
-#include "rmw_gurumdds_cpp/demangle.hpp"
+#include "rmw_gurumdds_cpp/graph_index.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/names_and_types_helpers.hpp"
 #include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 
 extern "C"
@@ -50,16 +52,16 @@ rmw_get_topic_names_and_types(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  DemangleFunction demangle_topic = rmw_gurumdds_cpp::demangle_ros_topic_from_topic;
-  DemangleFunction demangle_type = rmw_gurumdds_cpp::demangle_if_ros_type;
-
-  if (no_demangle) {
-    demangle_topic = rmw_gurumdds_cpp::identity_demangle;
-    demangle_type = rmw_gurumdds_cpp::identity_demangle;
+  // Demangled when the snapshot was built, copied as is
+  std::shared_ptr<const rmw_gurumdds_cpp::GraphSnapshot> snapshot =
+    node->context->impl->graph_index.get_snapshot();
+  if (snapshot == nullptr) {
+    // Error message already set
+    return RMW_RET_BAD_ALLOC;
   }
 
-  auto common_ctx = &node->context->impl->common_ctx;
-  return common_ctx->graph_cache.get_names_and_types(
-    demangle_topic, demangle_type, allocator, topic_names_and_types);
+  return rmw_gurumdds_cpp::copy_topics_names_and_types(
+    no_demangle ? snapshot->topics : snapshot->ros_topics,
+    allocator, true, topic_names_and_types);
 }
 }  // extern "C"
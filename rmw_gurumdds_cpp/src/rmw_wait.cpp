@@ -19,6 +19,7 @@
 
 #include "rmw_gurumdds_cpp/dds_include.hpp"
 #include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/rmw_context_impl.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
 #include "rmw_gurumdds_cpp/wait.hpp"
 
@@ -49,8 +50,8 @@ rmw_create_wait_set(rmw_context_t * context, size_t max_conditions)
   }
 
   wait_set->implementation_identifier = RMW_GURUMDDS_ID;
-  wait_set->data = rmw_allocate(sizeof(rmw_gurumdds_cpp::WaitSetInfo));
-  wait_set_info = static_cast<rmw_gurumdds_cpp::WaitSetInfo *>(wait_set->data);
+  wait_set_info = new(std::nothrow) rmw_gurumdds_cpp::WaitSetInfo();
+  wait_set->data = wait_set_info;
 
   if (!wait_set_info) {
     RMW_SET_ERROR_MSG("failed to allocate wait set");
@@ -75,6 +76,9 @@ rmw_create_wait_set(rmw_context_t * context, size_t max_conditions)
     goto fail;
   }
 
+  wait_set_info->use_polling = context->impl->wait_use_polling;
+  wait_set_info->spin_ns = context->impl->wait_spin_ns;
+  rmw_gurumdds_cpp::register_wait_set(wait_set_info);
   return wait_set;
 
 fail:
@@ -91,14 +95,11 @@ fail:
       dds_WaitSet_delete(wait_set_info->wait_set);
     }
 
+    delete wait_set_info;
     wait_set_info = nullptr;
   }
 
   if (wait_set != nullptr) {
-    if (wait_set->data != nullptr) {
-      rmw_free(wait_set->data);
-    }
-
     rmw_wait_set_free(wait_set);
   }
 
@@ -116,6 +117,7 @@ rmw_destroy_wait_set(rmw_wait_set_t * wait_set)
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
   rmw_gurumdds_cpp::WaitSetInfo * wait_set_info = static_cast<rmw_gurumdds_cpp::WaitSetInfo *>(wait_set->data);
+  rmw_gurumdds_cpp::unregister_wait_set(wait_set_info);
 
   if (wait_set_info->active_conditions != nullptr) {
     dds_ConditionSeq_delete(wait_set_info->active_conditions);
@@ -129,11 +131,9 @@ rmw_destroy_wait_set(rmw_wait_set_t * wait_set)
     dds_WaitSet_delete(wait_set_info->wait_set);
   }
 
+  delete wait_set_info;
   wait_set_info = nullptr;
-
-  if (wait_set->data != nullptr) {
-    rmw_free(wait_set->data);
-  }
+  wait_set->data = nullptr;
 
   if (wait_set != nullptr) {
     rmw_wait_set_free(wait_set);
@@ -0,0 +1,86 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rmw_gurumdds_cpp/sample_sequence_pool.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+SampleSequencePool::~SampleSequencePool() {
+  for (const SampleSequences & sequences : free_sequences_) {
+    destroy(sequences);
+  }
+}
+
+bool SampleSequencePool::create(uint32_t capacity, SampleSequences & sequences) {
+  sequences.data_seq = dds_DataSeq_create(capacity);
+  sequences.info_seq = dds_SampleInfoSeq_create(capacity);
+  sequences.raw_data_sizes = dds_UnsignedLongSeq_create(capacity);
+  sequences.capacity = capacity;
+  if (sequences.data_seq == nullptr || sequences.info_seq == nullptr ||
+    sequences.raw_data_sizes == nullptr)
+  {
+    destroy(sequences);
+    sequences = SampleSequences{};
+    return false;
+  }
+
+  return true;
+}
+
+void SampleSequencePool::destroy(const SampleSequences & sequences) {
+  if (sequences.data_seq != nullptr) {
+    dds_DataSeq_delete(sequences.data_seq);
+  }
+  if (sequences.info_seq != nullptr) {
+    dds_SampleInfoSeq_delete(sequences.info_seq);
+  }
+  if (sequences.raw_data_sizes != nullptr) {
+    dds_UnsignedLongSeq_delete(sequences.raw_data_sizes);
+  }
+}
+
+bool SampleSequencePool::acquire(uint32_t count, SampleSequences & sequences) {
+  SampleSequences reused{};
+  uint32_t capacity;
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    if (count > capacity_) {
+      capacity_ = count;
+    }
+    capacity = capacity_;
+    if (!free_sequences_.empty()) {
+      reused = free_sequences_.back();
+      free_sequences_.pop_back();
+    }
+  }
+
+  if (reused.data_seq != nullptr) {
+    if (reused.capacity >= capacity) {
+      sequences = reused;
+      return true;
+    }
+    destroy(reused);
+  }
+
+  return create(capacity, sequences);
+}
+
+void SampleSequencePool::release(dds_DataReader * reader, const SampleSequences & sequences) {
+  dds_DataReader_raw_return_loan(
+    reader, sequences.data_seq, sequences.info_seq, sequences.raw_data_sizes);
+  std::lock_guard<std::mutex> guard{mutex_};
+  free_sequences_.push_back(sequences);
+}
+} // namespace rmw_gurumdds_cpp
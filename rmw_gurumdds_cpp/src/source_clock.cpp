@@ -0,0 +1,57 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <ctime>
+
+#include "rmw_gurumdds_cpp/source_clock.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+bool parse_source_clock(const char * name, int & source_clock)
+{
+  if (std::strcmp(name, "dds") == 0) {
+    source_clock = SOURCE_CLOCK_DDS;
+    return true;
+  }
+  if (std::strcmp(name, "realtime") == 0) {
+    source_clock = SOURCE_CLOCK_REALTIME;
+    return true;
+  }
+  if (std::strcmp(name, "coarse") == 0) {
+    source_clock = SOURCE_CLOCK_REALTIME_COARSE;
+    return true;
+  }
+  return false;
+}
+
+void get_source_time(int source_clock, dds_Time_t * time)
+{
+#if defined(__linux__)
+  if (source_clock != SOURCE_CLOCK_DDS) {
+    struct timespec now;
+    const clockid_t clock =
+      source_clock == SOURCE_CLOCK_REALTIME_COARSE ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME;
+    if (clock_gettime(clock, &now) == 0) {
+      time->sec = static_cast<decltype(time->sec)>(now.tv_sec);
+      time->nanosec = static_cast<decltype(time->nanosec)>(now.tv_nsec);
+      return;
+    }
+  }
+#else
+  (void)source_clock;
+#endif
+  dds_Time_get_current_time(time);
+}
+} // namespace rmw_gurumdds_cpp
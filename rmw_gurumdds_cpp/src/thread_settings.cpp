@@ -0,0 +1,127 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw_gurumdds_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/thread_settings.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+bool ThreadSettings::parse_cpus(const char * list, std::vector<int> & cpus)
+{
+  cpus.clear();
+  const char * p = list;
+  while (*p != '\0') {
+    char * end = nullptr;
+    long first = std::strtol(p, &end, 10);
+    if (end == p || first < 0) {
+      return false;
+    }
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = std::strtol(p + 1, &end, 10);
+      if (end == p + 1 || last < first) {
+        return false;
+      }
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+    if (*p == ',') {
+      p++;
+    } else if (*p != '\0') {
+      return false;
+    }
+  }
+  return !cpus.empty();
+}
+
+bool ThreadSettings::parse_policy(const char * name, int & policy)
+{
+#if defined(__linux__)
+  if (std::strcmp(name, "other") == 0) {
+    policy = SCHED_OTHER;
+    return true;
+  }
+  if (std::strcmp(name, "fifo") == 0) {
+    policy = SCHED_FIFO;
+    return true;
+  }
+  if (std::strcmp(name, "rr") == 0) {
+    policy = SCHED_RR;
+    return true;
+  }
+#else
+  (void)name;
+  (void)policy;
+#endif
+  return false;
+}
+
+void ThreadSettings::apply() const
+{
+#if defined(__linux__)
+  if (!name.empty()) {
+    std::string short_name = name.substr(0, 15);
+    int ret = pthread_setname_np(pthread_self(), short_name.c_str());
+    if (ret != 0) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to name thread '%s': %s", short_name.c_str(), strerror(ret));
+    }
+  }
+
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+      if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to set the CPU affinity of a thread: %s", strerror(ret));
+    }
+  }
+
+  if (policy != THREAD_POLICY_UNSET) {
+    sched_param param{};
+    param.sched_priority = priority;
+    int ret = pthread_setschedparam(pthread_self(), policy, &param);
+    if (ret != 0) {
+      RCUTILS_LOG_WARN_NAMED(
+        RMW_GURUMDDS_ID, "failed to set the scheduling of a thread: %s", strerror(ret));
+    }
+  }
+#else
+  if (!name.empty() || !cpus.empty() || policy != THREAD_POLICY_UNSET) {
+    RCUTILS_LOG_WARN_NAMED(RMW_GURUMDDS_ID, "thread settings are not supported on this platform");
+  }
+#endif
+}
+} // namespace rmw_gurumdds_cpp
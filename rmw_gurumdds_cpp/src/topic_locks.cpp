@@ -0,0 +1,69 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <functional>
+#include <utility>
+
+#include "rmw_gurumdds_cpp/topic_locks.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+std::mutex & TopicLocks::get(const std::string & topic_name)
+{
+  return mutexes_[std::hash<std::string>{}(topic_name) % mutexes_.size()];
+}
+
+TopicLockGuard::~TopicLockGuard()
+{
+  unlock();
+}
+
+void TopicLockGuard::lock(TopicLocks & locks, const std::string & topic_name)
+{
+  first_ = &locks.get(topic_name);
+  first_->lock();
+}
+
+void TopicLockGuard::lock(
+  TopicLocks & locks, const std::string & first_name, const std::string & second_name)
+{
+  std::mutex * first = &locks.get(first_name);
+  std::mutex * second = &locks.get(second_name);
+  if (first == second) {
+    second = nullptr;
+  } else if (std::less<std::mutex *>{}(second, first)) {
+    std::swap(first, second);
+  }
+
+  first->lock();
+  if (second != nullptr) {
+    second->lock();
+  }
+  first_ = first;
+  second_ = second;
+}
+
+void TopicLockGuard::unlock()
+{
+  if (second_ != nullptr) {
+    second_->unlock();
+    second_ = nullptr;
+  }
+  if (first_ != nullptr) {
+    first_->unlock();
+    first_ = nullptr;
+  }
+}
+} // namespace rmw_gurumdds_cpp
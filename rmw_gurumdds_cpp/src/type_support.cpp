@@ -12,77 +12,56 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <utility>
+
 #include "rmw_gurumdds_cpp/type_support.hpp"
+#include "rcutils/logging_macros.h"
 #include "rmw/error_handling.h"
-#include "rosidl_typesupport_introspection_c/message_introspection.h"
-#include "rosidl_typesupport_introspection_c/identifier.h"
-#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
-#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rmw_gurumdds_cpp/identifier.hpp"
 #include "rmw_gurumdds_cpp/type_support_common.hpp"
 
 namespace rmw_gurumdds_cpp
 {
 
 static size_t get_size(void* context) {
-  auto rosidl_typesupport = reinterpret_cast<const rosidl_message_type_support_t *>(context);
-  if (rosidl_typesupport->typesupport_identifier == rosidl_typesupport_introspection_c__identifier) {
-    auto members = static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(rosidl_typesupport->data);
-    return members->size_of_;
-  } else if (rosidl_typesupport->typesupport_identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    auto members = static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(rosidl_typesupport->data);
-    return members->size_of_;
-  } else {
-    return 0;
-  }
+  auto plan = reinterpret_cast<const MessagePlan *>(context);
+  return plan->get_message_size();
 }
 
 static size_t get_serialize_size(void* context, void* data) {
-  auto rosidl_typesupport = reinterpret_cast<const rosidl_message_type_support_t *>(context);
-  return get_serialized_size(rosidl_typesupport->data, rosidl_typesupport->typesupport_identifier, data);
+  auto plan = reinterpret_cast<const MessagePlan *>(context);
+  return plan->get_serialized_size(data);
 }
 
 static size_t serialize_direct(void* context, void* data, void* buffer, size_t buffer_size) {
-  auto rosidl_typesupport = reinterpret_cast<const rosidl_message_type_support_t *>(context);
-  serialize_ros_to_cdr(
-    rosidl_typesupport->data,
-    rosidl_typesupport->typesupport_identifier,
-    data,
-    buffer,
-    buffer_size);
+  auto plan = reinterpret_cast<const MessagePlan *>(context);
+  plan->serialize(data, buffer, buffer_size);
   return buffer_size;
 }
 
+static thread_local size_t last_deserialized_size = 0;
+
 static bool deserialize_direct(void* context, void* buffer, size_t buffer_size, void* data) {
-  auto rosidl_typesupport = reinterpret_cast<const rosidl_message_type_support_t *>(context);
-  return deserialize_cdr_to_ros(
-    rosidl_typesupport->data,
-    rosidl_typesupport->typesupport_identifier,
-    data,
-    buffer,
-    buffer_size);
+  auto plan = reinterpret_cast<const MessagePlan *>(context);
+  last_deserialized_size = buffer_size;
+  return plan->deserialize(data, buffer, buffer_size);
 }
 
 dds_TypeSupport*
 create_type_support_and_register(
   dds_DomainParticipant * participant,
-  const rosidl_message_type_support_t * type_support,
+  const MessagePlan * plan,
   const std::string & type_name,
   const std::string & metastring) {
   dds_ReturnCode_t ret = dds_RETCODE_OK;
   dds_TypeSupport * dds_type_support{};
-  dds_TypeSupport_ops dds_ops{};
   dds_type_support = dds_TypeSupport_create(metastring.c_str());
   if(nullptr == dds_type_support) {
     RMW_SET_ERROR_MSG("failed to create typesupport");
     return nullptr;
   }
 
-  dds_ops.context = const_cast<rosidl_message_type_support_t *>(type_support);
-  dds_ops.get_size = get_size;
-  dds_ops.get_serialized_size = get_serialize_size;
-  dds_ops.serialize_direct = serialize_direct;
-  dds_ops.deserialize_direct = deserialize_direct;
-  dds_TypeSupport_set_operations(dds_type_support, &dds_ops);
+  set_type_support_ops(dds_type_support, plan);
   ret = dds_TypeSupport_register_type(dds_type_support, participant, type_name.c_str());
   if(dds_RETCODE_OK != ret) {
     RMW_SET_ERROR_MSG("failed to register type to domain participant");
@@ -90,18 +69,98 @@ create_type_support_and_register(
     return nullptr;
   }
 
+  RCUTILS_LOG_DEBUG_NAMED(
+    RMW_GURUMDDS_ID,
+    "Registered type '%s' with %s layout", type_name.c_str(),
+    plan->is_plain() ? "plain (single copy)" : "non-plain");
+
   return dds_type_support;
 }
 
 void set_type_support_ops(
   dds_TypeSupport* dds_type_support,
-  const rosidl_message_type_support_t* type_support) {
+  const MessagePlan* plan) {
+  // The plan is cached for the lifetime of the process, so it can outlive the type support
   dds_TypeSupport_ops dds_ops{};
-  dds_ops.context = const_cast<rosidl_message_type_support_t *>(type_support);
+  dds_ops.context = const_cast<MessagePlan *>(plan);
   dds_ops.get_size = get_size;
   dds_ops.get_serialized_size = get_serialize_size;
   dds_ops.serialize_direct = serialize_direct;
   dds_ops.deserialize_direct = deserialize_direct;
   dds_TypeSupport_set_operations(dds_type_support, &dds_ops);
 }
+
+size_t get_last_deserialized_size() {
+  return last_deserialized_size;
+}
+
+const TypeSupportRegistry::Entry *
+TypeSupportRegistry::acquire(
+  dds_DomainParticipant * participant,
+  const rosidl_message_type_support_t * type_support)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(type_support);
+  if (it != entries_.end()) {
+    it->second.ref_count++;
+    return &it->second;
+  }
+
+  std::string type_name =
+    create_type_name(type_support->data, type_support->typesupport_identifier);
+  if (type_name.empty()) {
+    // Error message is already set
+    return nullptr;
+  }
+
+  // The metastring is only needed to create the dds_TypeSupport, so it is not kept
+  std::string metastring =
+    create_metastring(type_support->data, type_support->typesupport_identifier);
+  if (metastring.empty()) {
+    // Error message is already set
+    return nullptr;
+  }
+
+  const MessagePlan * plan = MessagePlan::get(type_support);
+  if (plan == nullptr) {
+    // Error message is already set
+    return nullptr;
+  }
+
+  dds_TypeSupport * dds_typesupport =
+    create_type_support_and_register(participant, plan, type_name, metastring);
+  if (dds_typesupport == nullptr) {
+    return nullptr;
+  }
+
+  Entry & entry = entries_[type_support];
+  entry.type_name = std::move(type_name);
+  entry.plan = plan;
+  entry.dds_typesupport = dds_typesupport;
+  entry.ref_count = 1;
+  return &entry;
+}
+
+void
+TypeSupportRegistry::release(const rosidl_message_type_support_t * type_support)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(type_support);
+  if (it == entries_.end() || --it->second.ref_count > 0) {
+    return;
+  }
+
+  dds_TypeSupport_delete(it->second.dds_typesupport);
+  entries_.erase(it);
+}
+
+void
+TypeSupportRegistry::clear()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto & entry : entries_) {
+    dds_TypeSupport_delete(entry.second.dds_typesupport);
+  }
+  entries_.clear();
+}
 }
@@ -46,475 +46,58 @@ create_service_metastring(const void * untyped_members, const char * identifier)
   return {"", ""};
 }
 
-void *
-allocate_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  size_t * size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return allocate_request_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return allocate_request_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-void *
-allocate_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  size_t * size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return allocate_response_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return allocate_response_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-void *
-allocate_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  size_t * size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return allocate_request_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return allocate_request_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-void *
-allocate_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  size_t * size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return allocate_response_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return allocate_response_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-bool
-serialize_service_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_service,
-  void * dds_service,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid,
-  bool is_request)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_service_basic<rosidl_typesupport_introspection_c__MessageMembers>(
-      untyped_members, reinterpret_cast<const uint8_t *>(ros_service), reinterpret_cast<uint8_t *>(dds_service), size,
-      sequence_number, client_guid, is_request);
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_service_basic<rosidl_typesupport_introspection_cpp::MessageMembers>(
-      untyped_members, reinterpret_cast<const uint8_t *>(ros_service), reinterpret_cast<uint8_t *>(dds_service), size,
-      sequence_number, client_guid, is_request);
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-serialize_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  void * dds_request,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_request_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size,
-      sequence_number,
-      client_guid
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_request_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size,
-      sequence_number,
-      client_guid
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-serialize_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  void * dds_response,
-  size_t size,
-  int64_t sequence_number,
-  const uint8_t * client_guid)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_response_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size,
-      sequence_number,
-      client_guid
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_response_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size,
-      sequence_number,
-      client_guid
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-serialize_service_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_service,
-  void * dds_service,
-  size_t size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_service_enhanced<rosidl_typesupport_introspection_c__MessageMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_service_enhanced<rosidl_typesupport_introspection_cpp::MessageMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-serialize_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_request,
-  void * dds_request,
-  size_t size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_request_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_request_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-serialize_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  const void * ros_response,
-  void * dds_response,
-  size_t size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return serialize_response_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return serialize_response_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<const uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
 bool
-deserialize_service_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_service,
+peek_service_header_basic(
   void * dds_service,
   size_t size,
   int32_t * sn_high,
   uint32_t * sn_low,
-  int8_t * client_guid,
-  bool is_request)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_service_basic<rosidl_typesupport_introspection_c__MessageMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size,
-      sn_high,
-      sn_low,
-      client_guid,
-      is_request
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_service_basic<rosidl_typesupport_introspection_cpp::MessageMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size,
-      sn_high,
-      sn_low,
-      client_guid,
-      is_request
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-deserialize_request_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_request,
-  void * dds_request,
-  size_t size,
-  int32_t * sn_high,
-  uint32_t * sn_low,
-  int8_t * client_guid)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_request_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size,
-      sn_high,
-      sn_low,
-      client_guid
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_request_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size,
-      sn_high,
-      sn_low,
-      client_guid
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-deserialize_response_basic(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_response,
-  void * dds_response,
-  size_t size,
-  int32_t * sn_high,
-  uint32_t * sn_low,
   int8_t * client_guid)
 {
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_response_basic<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size,
-      sn_high,
-      sn_low,
-      client_guid
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_response_basic<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size,
-      sn_high,
-      sn_low,
-      client_guid
-    );
-  }
-
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
-}
-
-bool
-deserialize_service_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_service,
-  void * dds_service,
-  size_t size)
-{
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_service_enhanced<rosidl_typesupport_introspection_c__MessageMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_service_enhanced<rosidl_typesupport_introspection_cpp::MessageMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_service),
-      reinterpret_cast<uint8_t *>(dds_service),
-      size
-    );
+  try {
+    auto buffer = CdrDeserializationBuffer(reinterpret_cast<uint8_t *>(dds_service), size);
+    buffer >> *(reinterpret_cast<uint64_t *>(client_guid));
+    buffer >> *(reinterpret_cast<uint64_t *>(client_guid + 8));
+    buffer >> *(reinterpret_cast<uint32_t *>(sn_high));
+    buffer >> *sn_low;
+  } catch (std::runtime_error & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to deserialize dds message: %s", e.what());
+    return false;
   }
 
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
+  return true;
 }
 
-bool
-deserialize_request_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_request,
-  void * dds_request,
-  size_t size)
+template<typename ServiceMembersT>
+static bool
+resolve_service_type_support(const void * untyped_members, ServiceTypeSupport & type_support)
 {
-  if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_request_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size
-    );
-  } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_request_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_request),
-      reinterpret_cast<uint8_t *>(dds_request),
-      size
-    );
+  auto members = static_cast<const ServiceMembersT *>(untyped_members);
+  if (members == nullptr) {
+    RMW_SET_ERROR_MSG("Members handle is null");
+    return false;
   }
 
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return false;
+  using MessageMembersT = GET_TYPENAME(members->request_members_);
+  type_support.request_members = members->request_members_;
+  type_support.response_members = members->response_members_;
+  type_support.serialize_basic = serialize_service_basic<MessageMembersT>;
+  type_support.serialize_enhanced = serialize_service_enhanced<MessageMembersT>;
+  type_support.deserialize_basic = deserialize_service_basic<MessageMembersT>;
+  type_support.deserialize_enhanced = deserialize_service_enhanced<MessageMembersT>;
+  return true;
 }
 
 bool
-deserialize_response_enhanced(
-  const void * untyped_members,
-  const char * identifier,
-  void * ros_response,
-  void * dds_response,
-  size_t size)
+ServiceTypeSupport::init(const rosidl_service_type_support_t * type_support)
 {
+  const char * identifier = type_support->typesupport_identifier;
   if (identifier == rosidl_typesupport_introspection_c__identifier) {
-    return deserialize_response_enhanced<rosidl_typesupport_introspection_c__ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size
-    );
+    return resolve_service_type_support<rosidl_typesupport_introspection_c__ServiceMembers>(
+      type_support->data, *this);
   } else if (identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier) {
-    return deserialize_response_enhanced<rosidl_typesupport_introspection_cpp::ServiceMembers>(
-      untyped_members,
-      reinterpret_cast<uint8_t *>(ros_response),
-      reinterpret_cast<uint8_t *>(dds_response),
-      size
-    );
+    return resolve_service_type_support<rosidl_typesupport_introspection_cpp::ServiceMembers>(
+      type_support->data, *this);
   }
 
   RMW_SET_ERROR_MSG("Unknown typesupport identifier");
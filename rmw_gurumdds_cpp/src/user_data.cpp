@@ -0,0 +1,81 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <string_view>
+
+#include "rcutils/types/rcutils_ret.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/user_data.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+bool
+find_user_data_value(
+  const void * data,
+  size_t size,
+  std::string_view key,
+  std::string_view & value)
+{
+  if (data == nullptr) {
+    return false;
+  }
+
+  std::string_view user_data{static_cast<const char *>(data), size};
+  while (!user_data.empty()) {
+    size_t end = user_data.find(';');
+    std::string_view item = user_data.substr(0, end);
+    user_data.remove_prefix(end == std::string_view::npos ? user_data.size() : end + 1);
+
+    size_t separator = item.find('=');
+    if (separator != std::string_view::npos && item.substr(0, separator) == key) {
+      value = item.substr(separator + 1);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+rmw_ret_t
+parse_type_hash_from_user_data(
+  const void * data,
+  size_t size,
+  rosidl_type_hash_t & type_hash)
+{
+  std::string_view value;
+  if (!find_user_data_value(data, size, "typehash", value)) {
+    type_hash = rosidl_get_zero_initialized_type_hash();
+    return RMW_RET_OK;
+  }
+
+  // "RIHS01_" followed by the hex digits of the hash
+  char type_hash_str[sizeof("RIHS01_") + 2 * ROSIDL_TYPE_HASH_SIZE];
+  if (value.size() >= sizeof(type_hash_str)) {
+    RMW_SET_ERROR_MSG("type hash in user data is too long");
+    return RMW_RET_ERROR;
+  }
+  std::memcpy(type_hash_str, value.data(), value.size());
+  type_hash_str[value.size()] = '\0';
+
+  if (RCUTILS_RET_OK != rosidl_parse_type_hash_string(type_hash_str, &type_hash)) {
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+} // namespace rmw_gurumdds_cpp
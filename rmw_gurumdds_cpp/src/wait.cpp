@@ -12,12 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "rcpputils/scope_exit.hpp"
 
+#include "rcutils/time.h"
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/macros.hpp"
@@ -26,6 +30,8 @@
 #include "rmw_gurumdds_cpp/event_converter.hpp"
 #include "rmw_gurumdds_cpp/event_info_common.hpp"
 #include "rmw_gurumdds_cpp/event_info_service.hpp"
+#include "rmw_gurumdds_cpp/guard_condition.hpp"
+#include "rmw_gurumdds_cpp/tracing.hpp"
 #include "rmw_gurumdds_cpp/wait.hpp"
 
 #define CHECK_ATTACH(ret) \
@@ -44,13 +50,119 @@
 
 namespace rmw_gurumdds_cpp
 {
+static std::mutex wait_sets_mutex;
+static std::unordered_set<WaitSetInfo *> wait_sets;
+
+void
+register_wait_set(WaitSetInfo * wait_set_info)
+{
+  std::lock_guard<std::mutex> guard(wait_sets_mutex);
+  wait_sets.insert(wait_set_info);
+}
+
+// Empties the DDS wait set, the caller holds the lock of the wait set
+static void
+detach_all_conditions(WaitSetInfo * wait_set_info)
+{
+  wait_set_info->conditions.clear();
+  wait_set_info->stale = false;
+  dds_ConditionSeq * attached_conditions = wait_set_info->attached_conditions;
+  dds_ReturnCode_t ret = dds_WaitSet_get_conditions(wait_set_info->wait_set, attached_conditions);
+  if (ret != dds_RETCODE_OK) {
+    RMW_SET_ERROR_MSG("failed to get attached conditions for wait set");
+    return;
+  }
+
+  const uint32_t condition_seq_length = dds_ConditionSeq_length(attached_conditions);
+  for (uint32_t i = 0; i < condition_seq_length; ++i) {
+    ret = dds_WaitSet_detach_condition(
+      wait_set_info->wait_set, dds_ConditionSeq_get(attached_conditions, i));
+    if (ret != dds_RETCODE_OK) {
+      RMW_SET_ERROR_MSG("failed to detach condition from wait set");
+    }
+  }
+
+  while (dds_ConditionSeq_length(attached_conditions) > 0) {
+    dds_ConditionSeq_remove(attached_conditions, 0);
+  }
+}
+
+void
+unregister_wait_set(WaitSetInfo * wait_set_info)
+{
+  std::lock_guard<std::mutex> guard(wait_sets_mutex);
+  wait_sets.erase(wait_set_info);
+  std::lock_guard<std::mutex> wait_set_guard(wait_set_info->mutex);
+  detach_all_conditions(wait_set_info);
+}
+
+void
+clean_wait_set_caches()
+{
+  std::lock_guard<std::mutex> guard(wait_sets_mutex);
+  for (WaitSetInfo * wait_set_info : wait_sets) {
+    std::lock_guard<std::mutex> wait_set_guard(wait_set_info->mutex);
+    if (wait_set_info->in_use) {
+      wait_set_info->stale = true;
+    } else if (!wait_set_info->conditions.empty()) {
+      detach_all_conditions(wait_set_info);
+    }
+  }
+}
+
+// Marks the condition as used by this wait, attaching it only if the previous wait did not
+static dds_ReturnCode_t
+attach_condition(WaitSetInfo * wait_set_info, dds_Condition * condition)
+{
+  WaitSetCondition & state = wait_set_info->conditions[condition];
+  state.used = wait_set_info->wait_count;
+  if (state.attached) {
+    return dds_RETCODE_OK;
+  }
+
+  dds_ReturnCode_t ret = dds_WaitSet_attach_condition(wait_set_info->wait_set, condition);
+  if (ret == dds_RETCODE_OK) {
+    state.attached = true;
+  }
+
+  return ret;
+}
+
+static bool
+is_condition_active(WaitSetInfo * wait_set_info, const void * condition)
+{
+  auto it = wait_set_info->conditions.find(
+    reinterpret_cast<dds_Condition *>(const_cast<void *>(condition)));
+  return it != wait_set_info->conditions.end() && it->second.active == wait_set_info->wait_count;
+}
+
+// Number of entities passed to a wait, only evaluated when the wait_begin tracepoint is enabled
+[[maybe_unused]] static uint32_t
+count_conditions(
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  const rmw_events_t * events)
+{
+  size_t count = 0;
+  count += subscriptions != nullptr ? subscriptions->subscriber_count : 0;
+  count += guard_conditions != nullptr ? guard_conditions->guard_condition_count : 0;
+  count += services != nullptr ? services->service_count : 0;
+  count += clients != nullptr ? clients->client_count : 0;
+  count += events != nullptr ? events->event_count : 0;
+  return static_cast<uint32_t>(count);
+}
+
+// Collects the conditions of the events into the scratch list of the wait set
 static rmw_ret_t
 gather_event_conditions(
-  rmw_events_t * events,
-  std::unordered_set<dds_Condition*> & status_conditions)
+  WaitSetInfo * wait_set_info,
+  rmw_events_t * events)
 {
   RMW_CHECK_ARGUMENT_FOR_NULL(events, RMW_RET_INVALID_ARGUMENT);
-  std::unordered_map<dds_StatusCondition *, dds_StatusMask> status_map;
+  std::vector<dds_Condition *> & event_conditions = wait_set_info->event_conditions;
+  event_conditions.clear();
 
   for (size_t i = 0; i < events->event_count; i++) {
     auto now = static_cast<rmw_event_t *>(events->events[i]);
@@ -75,20 +187,26 @@ gather_event_conditions(
         continue;
       }
 
-      status_conditions.insert(reinterpret_cast<dds_Condition *>(condition));
+      event_conditions.push_back(reinterpret_cast<dds_Condition *>(condition));
     }
 
-    auto& mask = status_map[event_info->get_status_condition()];
-    mask |= get_status_kind_from_rmw(event_type);
+    // The statuses of all events of an entity are gathered on its status condition
+    auto status_condition = reinterpret_cast<dds_Condition *>(event_info->get_status_condition());
+    WaitSetCondition & state = wait_set_info->conditions[status_condition];
+    if (state.used != wait_set_info->wait_count) {
+      state.used = wait_set_info->wait_count;
+      state.mask = 0;
+      event_conditions.push_back(status_condition);
+    }
+    state.mask |= get_status_kind_from_rmw(event_type);
   }
 
-  for(auto & pair : status_map) {
-    if(pair.second == 0) {
-      continue;
+  for (dds_Condition * condition : event_conditions) {
+    const WaitSetCondition & state = wait_set_info->conditions[condition];
+    if (state.mask != 0) {
+      dds_StatusCondition_set_enabled_statuses(
+        reinterpret_cast<dds_StatusCondition *>(condition), state.mask);
     }
-
-    dds_StatusCondition_set_enabled_statuses(pair.first, pair.second);
-    status_conditions.insert(reinterpret_cast<dds_Condition *>(pair.first));
   }
 
   return RMW_RET_OK;
@@ -193,91 +311,69 @@ wait_w_polling(
   return triggered ? RMW_RET_OK : RMW_RET_TIMEOUT;
 }
 
-rmw_ret_t
-wait(
-  const char * implementation_identifier,
-  rmw_subscriptions_t * subscriptions,
-  rmw_guard_conditions_t * guard_conditions,
-  rmw_services_t * services,
-  rmw_clients_t * clients,
-  rmw_events_t * events,
-  rmw_wait_set_t * wait_set,
-  const rmw_time_t * wait_timeout)
+// Detaches the conditions the previous wait used and this one does not
+static rmw_ret_t
+detach_unused_conditions(WaitSetInfo * wait_set_info)
 {
-  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RMW_RET_INVALID_ARGUMENT);
-  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-  auto atexit = rcpputils::make_scope_exit([&]() {
-    if (wait_set == nullptr) {
-      RMW_SET_ERROR_MSG("wait set handle is null");
-      return;
-    }
-
-    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
-      wait set handle, wait_set->implementation_identifier,
-      implementation_identifier, return );
-
-    WaitSetInfo * wait_set_info = static_cast<WaitSetInfo *>(wait_set->data);
-    if (wait_set_info == nullptr) {
-      RMW_SET_ERROR_MSG("WaitSet implementation struct is null");
-      return;
+  auto & conditions = wait_set_info->conditions;
+  for (auto it = conditions.begin(); it != conditions.end(); ) {
+    if (it->second.used == wait_set_info->wait_count) {
+      ++it;
+      continue;
     }
 
-    dds_WaitSet * dds_wait_set = static_cast<dds_WaitSet *>(wait_set_info->wait_set);
-    if (dds_wait_set == nullptr) {
-      RMW_SET_ERROR_MSG("DDS wait set handle is null");
-      return;
+    if (it->second.attached) {
+      rmw_ret_t rmw_ret_code = detach_condition(wait_set_info->wait_set, it->first);
+      if (rmw_ret_code != RMW_RET_OK) {
+        return rmw_ret_code;
+      }
     }
+    it = conditions.erase(it);
+  }
 
-    dds_ConditionSeq * attached_conditions =
-      static_cast<dds_ConditionSeq *>(wait_set_info->attached_conditions);
-    if (attached_conditions == nullptr) {
-      RMW_SET_ERROR_MSG("DDS condition sequence handle is null");
-      return;
-    }
+  return RMW_RET_OK;
+}
 
-    dds_ReturnCode_t ret = dds_WaitSet_get_conditions(dds_wait_set, attached_conditions);
-    if (ret != dds_RETCODE_OK) {
-      RMW_SET_ERROR_MSG("failed to get attached conditions for wait set");
-      return;
-    }
+// Checks the trigger values of the attached conditions until one is set or the budget runs out
+static bool
+spin_for_conditions(
+  WaitSetInfo * wait_set_info,
+  dds_ConditionSeq * active_conditions,
+  std::chrono::nanoseconds budget)
+{
+  while (dds_ConditionSeq_length(active_conditions) > 0) {
+    dds_ConditionSeq_remove(active_conditions, dds_ConditionSeq_length(active_conditions) - 1);
+  }
 
-    const uint32_t condition_seq_length = dds_ConditionSeq_length(attached_conditions);
-    for (uint32_t i = 0; i < condition_seq_length; ++i) {
-      ret = dds_WaitSet_detach_condition(
-        dds_wait_set, dds_ConditionSeq_get(attached_conditions, i));
-      if (ret != dds_RETCODE_OK) {
-        RMW_SET_ERROR_MSG("failed to detach condition from wait set");
+  const auto deadline = std::chrono::steady_clock::now() + budget;
+  do {
+    for (const auto & pair : wait_set_info->conditions) {
+      if (pair.second.attached && dds_Condition_get_trigger_value(pair.first)) {
+        dds_ConditionSeq_add(active_conditions, pair.first);
       }
     }
 
-    while (dds_ConditionSeq_length(attached_conditions) > 0) {
-      dds_ConditionSeq_remove(attached_conditions, 0);
+    if (dds_ConditionSeq_length(active_conditions) > 0) {
+      return true;
     }
-  });
-
-  RMW_CHECK_ARGUMENT_FOR_NULL(wait_set, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
-    wait set handle, wait_set->implementation_identifier,
-    implementation_identifier, return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-
-  WaitSetInfo * wait_set_info = static_cast<WaitSetInfo *>(wait_set->data);
-  if (wait_set_info == nullptr) {
-    RMW_SET_ERROR_MSG("WaitSet implementation struct is null");
-    return RMW_RET_ERROR;
-  }
+  } while (std::chrono::steady_clock::now() < deadline);
 
-  dds_WaitSet * dds_wait_set = static_cast<dds_WaitSet *>(wait_set_info->wait_set);
-  if (dds_wait_set == nullptr) {
-    RMW_SET_ERROR_MSG("DDS wait set handle is null");
-    return RMW_RET_ERROR;
-  }
+  return false;
+}
 
-  dds_ConditionSeq * active_conditions =
-    static_cast<dds_ConditionSeq *>(wait_set_info->active_conditions);
-  if (active_conditions == nullptr) {
-    RMW_SET_ERROR_MSG("DDS condition sequence handle is null");
-    return RMW_RET_ERROR;
+static rmw_ret_t
+attach_conditions(
+  WaitSetInfo * wait_set_info,
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events)
+{
+  if (wait_set_info->stale) {
+    detach_all_conditions(wait_set_info);
   }
+  wait_set_info->wait_count++;
 
   if (subscriptions != nullptr) {
     for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
@@ -294,35 +390,41 @@ wait(
         return RMW_RET_ERROR;
       }
 
-      dds_ReturnCode_t ret = dds_WaitSet_attach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
+      dds_ReturnCode_t ret = attach_condition(
+        wait_set_info, reinterpret_cast<dds_Condition *>(read_condition));
       CHECK_ATTACH(ret);
+
+      // Triggered while samples handed over by the publishers of the context are queued
+      if (subscriber_info->local_samples != nullptr) {
+        ret = attach_condition(
+          wait_set_info,
+          reinterpret_cast<dds_Condition *>(subscriber_info->local_samples->get_condition()));
+        CHECK_ATTACH(ret);
+      }
     }
   }
 
-  std::unordered_set<dds_Condition *> status_conditions;
-
-  rmw_ret_t ret_code = gather_event_conditions(events, status_conditions);
+  rmw_ret_t ret_code = gather_event_conditions(wait_set_info, events);
   if (ret_code != RMW_RET_OK) {
     return ret_code;
   }
 
-  for (auto status_condition : status_conditions) {
-    dds_ReturnCode_t ret = dds_WaitSet_attach_condition(dds_wait_set, status_condition);
+  for (dds_Condition * event_condition : wait_set_info->event_conditions) {
+    dds_ReturnCode_t ret = attach_condition(wait_set_info, event_condition);
     CHECK_ATTACH(ret);
   }
 
   if (guard_conditions != nullptr) {
     for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
       auto * guard_condition =
-        static_cast<dds_GuardCondition *>(guard_conditions->guard_conditions[i]);
+        static_cast<GuardCondition *>(guard_conditions->guard_conditions[i]);
       if (guard_condition == nullptr) {
         RMW_SET_ERROR_MSG("guard condition handle is null");
         return RMW_RET_ERROR;
       }
 
-      dds_ReturnCode_t ret = dds_WaitSet_attach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(guard_condition));
+      dds_ReturnCode_t ret = attach_condition(
+        wait_set_info, reinterpret_cast<dds_Condition *>(guard_condition->condition));
       CHECK_ATTACH(ret);
     }
   }
@@ -341,8 +443,8 @@ wait(
         return RMW_RET_ERROR;
       }
 
-      dds_ReturnCode_t ret = dds_WaitSet_attach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
+      dds_ReturnCode_t ret = attach_condition(
+        wait_set_info, reinterpret_cast<dds_Condition *>(read_condition));
       CHECK_ATTACH(ret);
     }
   }
@@ -361,114 +463,156 @@ wait(
         return RMW_RET_ERROR;
       }
 
-      dds_ReturnCode_t ret = dds_WaitSet_attach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
+      dds_ReturnCode_t ret = attach_condition(
+        wait_set_info, reinterpret_cast<dds_Condition *>(read_condition));
       CHECK_ATTACH(ret);
     }
   }
 
-  rmw_ret_t rret = RMW_RET_OK;
-  static constexpr const char * env_name = "RMW_GURUMDDS_WAIT_USE_POLLING";
-  static bool initialized_polling = false;
-  static bool polling = false;
-  if(!initialized_polling) {
-    initialized_polling = true;
-    char * env_value = nullptr;
-    env_value = getenv(env_name);
-    if (nullptr != env_value) {
-      polling = (strcmp(env_value, "1") == 0);
-    }
+  return detach_unused_conditions(wait_set_info);
+}
+
+rmw_ret_t
+wait(
+  const char * implementation_identifier,
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events,
+  rmw_wait_set_t * wait_set,
+  const rmw_time_t * wait_timeout)
+{
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(wait_set, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    wait set handle, wait_set->implementation_identifier,
+    implementation_identifier, return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  WaitSetInfo * wait_set_info = static_cast<WaitSetInfo *>(wait_set->data);
+  if (wait_set_info == nullptr) {
+    RMW_SET_ERROR_MSG("WaitSet implementation struct is null");
+    return RMW_RET_ERROR;
+  }
+
+  dds_WaitSet * dds_wait_set = static_cast<dds_WaitSet *>(wait_set_info->wait_set);
+  if (dds_wait_set == nullptr) {
+    RMW_SET_ERROR_MSG("DDS wait set handle is null");
+    return RMW_RET_ERROR;
   }
 
-  if (!polling) {  // Default: use dds_WaitSet_wait()
-    dds_Duration_t timeout;
-    if (wait_timeout == nullptr) {
-      timeout.sec = dds_DURATION_INFINITE_SEC;
-      timeout.nanosec = dds_DURATION_ZERO_NSEC;
-    } else {
-      timeout.sec = static_cast<int32_t>(wait_timeout->sec);
-      timeout.nanosec = static_cast<uint32_t>(wait_timeout->nsec);
+  dds_ConditionSeq * active_conditions =
+    static_cast<dds_ConditionSeq *>(wait_set_info->active_conditions);
+  if (active_conditions == nullptr || wait_set_info->attached_conditions == nullptr) {
+    RMW_SET_ERROR_MSG("DDS condition sequence handle is null");
+    return RMW_RET_ERROR;
+  }
+
+  // Conditions stay attached for the next wait, a failed wait leaves the wait set empty
+  auto atexit = rcpputils::make_scope_exit([wait_set_info]() {
+    std::lock_guard<std::mutex> guard(wait_set_info->mutex);
+    wait_set_info->in_use = false;
+    detach_all_conditions(wait_set_info);
+  });
+
+  const uint64_t attach_start_ns = stats_time_ns();
+  {
+    std::lock_guard<std::mutex> guard(wait_set_info->mutex);
+    wait_set_info->in_use = true;
+    rmw_ret_t ret_code = attach_conditions(
+      wait_set_info, subscriptions, guard_conditions, services, clients, events);
+    if (ret_code != RMW_RET_OK) {
+      return ret_code;
     }
+  }
 
-    dds_ReturnCode_t status = dds_WaitSet_wait(dds_wait_set, active_conditions, &timeout);
-    if (status != dds_RETCODE_OK && status != dds_RETCODE_TIMEOUT) {
-      RMW_SET_ERROR_MSG("failed to wait on wait set");
-      return RMW_RET_ERROR;
+  const uint64_t wait_start_ns = stats_time_ns();
+  RMW_GURUMDDS_TRACEPOINT(
+    wait_begin,
+    static_cast<const void *>(wait_set),
+    count_conditions(subscriptions, guard_conditions, services, clients, events),
+    wait_timeout == nullptr ? INT64_C(-1) :
+    static_cast<int64_t>(RCUTILS_S_TO_NS(wait_timeout->sec) + wait_timeout->nsec));
+
+  rmw_ret_t rret = RMW_RET_OK;
+  if (!wait_set_info->use_polling) {  // Default: use dds_WaitSet_wait()
+    std::chrono::nanoseconds remaining = std::chrono::nanoseconds::max();
+    if (wait_timeout != nullptr) {
+      remaining = std::chrono::seconds(wait_timeout->sec) +
+        std::chrono::nanoseconds(wait_timeout->nsec);
     }
 
-    if (status == dds_RETCODE_TIMEOUT) {
-      rret = RMW_RET_TIMEOUT;
+    bool triggered = false;
+    if (wait_set_info->spin_ns > 0) {
+      const auto spin_start = std::chrono::steady_clock::now();
+      const auto budget = std::min(remaining, std::chrono::nanoseconds(wait_set_info->spin_ns));
+      triggered = spin_for_conditions(wait_set_info, active_conditions, budget);
+      if (!triggered && wait_timeout != nullptr) {
+        remaining -= std::min(remaining, std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - spin_start));
+      }
     }
-  } else {  // use polilng
-    rret = wait_w_polling(dds_wait_set, active_conditions, wait_timeout);
-  }
 
-  const uint32_t active_cond_length = dds_ConditionSeq_length(active_conditions);
-  if (subscriptions != nullptr) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      SubscriberInfo * subscriber_info =
-        static_cast<SubscriberInfo *>(subscriptions->subscribers[i]);
-      if (subscriber_info == nullptr) {
-        RMW_SET_ERROR_MSG("subscriber info handle is null");
-        return RMW_RET_ERROR;
+    if (!triggered) {
+      dds_Duration_t timeout;
+      if (wait_timeout == nullptr) {
+        timeout.sec = dds_DURATION_INFINITE_SEC;
+        timeout.nanosec = dds_DURATION_ZERO_NSEC;
+      } else {
+        timeout.sec = static_cast<int32_t>(remaining.count() / 1000000000);
+        timeout.nanosec = static_cast<uint32_t>(remaining.count() % 1000000000);
       }
 
-      dds_ReadCondition * read_condition = subscriber_info->read_condition;
-      if (!read_condition) {
-        RMW_SET_ERROR_MSG("read condition handle is null");
+      dds_ReturnCode_t status = dds_WaitSet_wait(dds_wait_set, active_conditions, &timeout);
+      if (status != dds_RETCODE_OK && status != dds_RETCODE_TIMEOUT) {
+        RMW_SET_ERROR_MSG("failed to wait on wait set");
         return RMW_RET_ERROR;
       }
 
-      uint32_t j = 0;
-      for (; j < active_cond_length; ++j) {
-        if (
-          dds_ConditionSeq_get(active_conditions, j) ==
-          reinterpret_cast<dds_Condition *>(read_condition)) {
-          break;
-        }
+      if (status == dds_RETCODE_TIMEOUT) {
+        rret = RMW_RET_TIMEOUT;
       }
+    }
+  } else {  // use polilng
+    rret = wait_w_polling(dds_wait_set, active_conditions, wait_timeout);
+  }
 
-      if (j >= active_cond_length) {
-        subscriptions->subscribers[i] = nullptr;
-      }
+  // Tags the active conditions with this wait, so that each entity is checked in constant time
+  const uint64_t process_start_ns = stats_time_ns();
+  const uint32_t active_cond_length = dds_ConditionSeq_length(active_conditions);
+  RMW_GURUMDDS_TRACEPOINT(wait_end, static_cast<const void *>(wait_set), active_cond_length);
+  for (uint32_t i = 0; i < active_cond_length; ++i) {
+    auto it = wait_set_info->conditions.find(dds_ConditionSeq_get(active_conditions, i));
+    if (it != wait_set_info->conditions.end()) {
+      it->second.active = wait_set_info->wait_count;
+    }
+  }
 
-      rmw_ret_t rmw_ret_code = detach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
-      if (rmw_ret_code != RMW_RET_OK) {
-        return rmw_ret_code;
+  if (subscriptions != nullptr) {
+    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+      auto * subscriber_info = static_cast<SubscriberInfo *>(subscriptions->subscribers[i]);
+      if (!is_condition_active(wait_set_info, subscriber_info->read_condition) &&
+        (subscriber_info->local_samples == nullptr ||
+        !is_condition_active(wait_set_info, subscriber_info->local_samples->get_condition())))
+      {
+        subscriptions->subscribers[i] = nullptr;
       }
     }
   }
 
   if (guard_conditions != nullptr) {
     for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      auto * condition =
-        static_cast<dds_Condition *>(guard_conditions->guard_conditions[i]);
-      if (condition == nullptr) {
-        RMW_SET_ERROR_MSG("condition handle is null");
-        return RMW_RET_ERROR;
-      }
-
-      uint32_t j = 0;
-      for (; j < active_cond_length; ++j) {
-        if (dds_ConditionSeq_get(active_conditions, j) == condition) {
-          auto * guard = reinterpret_cast<dds_GuardCondition *>(condition);
-          dds_ReturnCode_t ret = dds_GuardCondition_set_trigger_value(guard, false);
-          if (ret != dds_RETCODE_OK) {
-            RMW_SET_ERROR_MSG("failed to set trigger value");
-            return RMW_RET_ERROR;
-          }
-          break;
-        }
-      }
-
-      if (j >= active_cond_length) {
+      auto * guard = static_cast<GuardCondition *>(guard_conditions->guard_conditions[i]);
+      if (!is_condition_active(wait_set_info, guard->condition)) {
         guard_conditions->guard_conditions[i] = nullptr;
+        continue;
       }
 
-      rmw_ret_t rmw_ret_code = detach_condition(dds_wait_set, condition);
-      if (rmw_ret_code != RMW_RET_OK) {
-        return rmw_ret_code;
+      dds_ReturnCode_t ret = clear_guard_condition(guard);
+      if (ret != dds_RETCODE_OK) {
+        RMW_SET_ERROR_MSG("failed to set trigger value");
+        return RMW_RET_ERROR;
       }
     }
   }
@@ -476,80 +620,36 @@ wait(
   if (services != nullptr) {
     for (size_t i = 0; i < services->service_count; ++i) {
       auto * service_info = static_cast<ServiceInfo *>(services->services[i]);
-      if (service_info == nullptr) {
-        RMW_SET_ERROR_MSG("service info handle is null");
-        return RMW_RET_ERROR;
-      }
-
-      dds_ReadCondition * read_condition = service_info->read_condition;
-      if (read_condition == nullptr) {
-        RMW_SET_ERROR_MSG("read condition handle is null");
-        return RMW_RET_ERROR;
-      }
-
-      uint32_t j = 0;
-      for (; j < active_cond_length; ++j) {
-        if (
-          dds_ConditionSeq_get(active_conditions, j) ==
-          reinterpret_cast<dds_Condition *>(read_condition))
-        {
-          break;
-        }
-      }
-
-      if (j >= active_cond_length) {
+      if (!is_condition_active(wait_set_info, service_info->read_condition)) {
         services->services[i] = nullptr;
       }
-
-      rmw_ret_t rmw_ret_code = detach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
-      if (rmw_ret_code != RMW_RET_OK) {
-        return rmw_ret_code;
-      }
     }
   }
 
   if (clients != nullptr) {
     for (size_t i = 0; i < clients->client_count; ++i) {
       auto * client_info = static_cast<ClientInfo *>(clients->clients[i]);
-      if (client_info == nullptr) {
-        RMW_SET_ERROR_MSG("client info handle is null");
-        return RMW_RET_ERROR;
-      }
-
-      dds_ReadCondition * read_condition = client_info->read_condition;
-      if (read_condition == nullptr) {
-        RMW_SET_ERROR_MSG("read condition handle is null");
-        return RMW_RET_ERROR;
-      }
-
-      uint32_t j = 0;
-      for (; j < active_cond_length; ++j) {
-        if (
-          dds_ConditionSeq_get(active_conditions, j) ==
-          reinterpret_cast<dds_Condition *>(read_condition))
-        {
-          break;
-        }
-      }
-
-      if (j >= active_cond_length) {
+      if (!is_condition_active(wait_set_info, client_info->read_condition)) {
         clients->clients[i] = nullptr;
       }
-
-      rmw_ret_t rmw_ret_code = detach_condition(
-        dds_wait_set, reinterpret_cast<dds_Condition *>(read_condition));
-      if (rmw_ret_code != RMW_RET_OK) {
-        return rmw_ret_code;
-      }
     }
   }
 
+  {
+    std::lock_guard<std::mutex> guard(wait_set_info->mutex);
+    wait_set_info->in_use = false;
+  }
+  atexit.cancel();
+
   rmw_ret_t rmw_ret_code = handle_active_event_conditions(events);
   if (rmw_ret_code != RMW_RET_OK) {
     return rmw_ret_code;
   }
 
+  wait_set_info->stats.on_wait(
+    wait_start_ns - attach_start_ns,
+    process_start_ns - wait_start_ns,
+    stats_time_ns() - process_start_ns);
   return rret;
 }
 } // namespace rmw_gurumdds_cpp
@@ -0,0 +1,109 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <system_error>
+
+#include "rmw_gurumdds_cpp/worker_pool.hpp"
+
+namespace rmw_gurumdds_cpp
+{
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    stop_ = true;
+  }
+  work_cond_.notify_all();
+  for (std::thread & thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkerPool::start(size_t thread_count) {
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    try {
+      threads_.emplace_back(&WorkerPool::run_worker, this);
+    } catch (const std::system_error &) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t WorkerPool::get_thread_count() const {
+  return threads_.size();
+}
+
+void WorkerPool::parallel_for(size_t count, const std::function<void(size_t)> & fn) {
+  std::unique_lock<std::mutex> job_lock{job_mutex_, std::try_to_lock};
+  if (!job_lock.owns_lock() || threads_.empty() || count < 2) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    job_ = &fn;
+    job_count_ = count;
+    next_.store(0, std::memory_order_relaxed);
+    generation_++;
+  }
+  work_cond_.notify_all();
+
+  run_job(fn, count);
+
+  // A worker that wakes up after the job is cleared leaves it alone
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_cond_.wait(lock, [this]() {return active_ == 0;});
+  job_ = nullptr;
+}
+
+void WorkerPool::run_worker() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  uint64_t generation = 0;
+  while (true) {
+    work_cond_.wait(lock, [this, generation]() {return stop_ || generation_ != generation;});
+    if (stop_) {
+      return;
+    }
+
+    generation = generation_;
+    if (job_ == nullptr) {
+      continue;
+    }
+
+    const std::function<void(size_t)> * job = job_;
+    size_t count = job_count_;
+    active_++;
+    lock.unlock();
+
+    run_job(*job, count);
+
+    lock.lock();
+    if (--active_ == 0) {
+      done_cond_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::run_job(const std::function<void(size_t)> & fn, size_t count) {
+  for (size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1)) {
+    fn(i);
+  }
+}
+} // namespace rmw_gurumdds_cpp
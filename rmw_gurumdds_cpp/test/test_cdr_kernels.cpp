@@ -0,0 +1,126 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rmw_gurumdds_cpp/cdr_bool.hpp"
+#include "rmw_gurumdds_cpp/cdr_bswap.hpp"
+
+using namespace rmw_gurumdds_cpp;
+
+// Counts around the block sizes of the vector kernels, so that their tails are covered too
+static const size_t counts[] = {0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 257};
+
+template<typename T>
+static std::vector<uint8_t> make_bytes(size_t cnt, size_t misalignment)
+{
+  std::vector<uint8_t> bytes(misalignment + cnt * sizeof(T));
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  return bytes;
+}
+
+template<typename T, typename BswapFn, typename CopyFn>
+static void check_bswap(BswapFn bswap, CopyFn copy)
+{
+  for (size_t cnt : counts) {
+    for (size_t misalignment = 0; misalignment < sizeof(T); misalignment++) {
+      const std::vector<uint8_t> src = make_bytes<T>(cnt, misalignment);
+      std::vector<uint8_t> dst(cnt * sizeof(T) + 2, 0xee);
+      copy(dst.data() + 1, src.data() + misalignment, cnt);
+
+      std::vector<uint8_t> in_place = src;
+      copy(in_place.data() + misalignment, in_place.data() + misalignment, cnt);
+
+      for (size_t i = 0; i < cnt; i++) {
+        T value;
+        T swapped;
+        T swapped_in_place;
+        std::memcpy(&value, src.data() + misalignment + i * sizeof(T), sizeof(T));
+        std::memcpy(&swapped, dst.data() + 1 + i * sizeof(T), sizeof(T));
+        std::memcpy(&swapped_in_place, in_place.data() + misalignment + i * sizeof(T), sizeof(T));
+        ASSERT_EQ(bswap(value), swapped) << "count " << cnt << ", element " << i;
+        ASSERT_EQ(bswap(value), swapped_in_place) << "count " << cnt << ", element " << i;
+      }
+      // Nothing is written past the elements
+      EXPECT_EQ(0xee, dst[0]);
+      EXPECT_EQ(0xee, dst[1 + cnt * sizeof(T)]);
+    }
+  }
+}
+
+TEST(TestCdrKernels, scalar_bswap) {
+  EXPECT_EQ(0x3412u, bswap16(0x1234u));
+  EXPECT_EQ(0x78563412u, bswap32(0x12345678u));
+  EXPECT_EQ(0xefcdab8967452301ull, bswap64(0x0123456789abcdefull));
+}
+
+TEST(TestCdrKernels, bswap_copy) {
+  ASSERT_NE(nullptr, get_bswap_kernel_name());
+  check_bswap<uint16_t>(bswap16, bswap_copy16);
+  check_bswap<uint32_t>(bswap32, bswap_copy32);
+  check_bswap<uint64_t>(bswap64, bswap_copy64);
+}
+
+TEST(TestCdrKernels, bool_normalized) {
+  ASSERT_NE(nullptr, get_bool_kernel_name());
+  for (size_t cnt : counts) {
+    std::vector<uint8_t> src(cnt + 1);
+    for (size_t i = 0; i < src.size(); i++) {
+      src[i] = static_cast<uint8_t>(i % 3 == 0 ? 0 : i * 7);
+    }
+    std::vector<uint8_t> dst(cnt + 1, 0xee);
+    copy_bool_normalized(dst.data(), src.data() + 1, cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      ASSERT_EQ(src[i + 1] != 0 ? 1 : 0, dst[i]) << "count " << cnt << ", element " << i;
+    }
+    EXPECT_EQ(0xee, dst[cnt]);
+
+    copy_bool_normalized(src.data(), src.data(), cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      ASSERT_LE(src[i], 1);
+    }
+  }
+}
+
+TEST(TestCdrKernels, bool_vector) {
+  for (size_t cnt : counts) {
+    std::vector<bool> values(cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      values[i] = (i * 5) % 7 < 3;
+    }
+
+    std::vector<uint8_t> bytes(cnt + 1, 0xee);
+    copy_bool_vector_to_bytes(bytes.data(), values);
+    for (size_t i = 0; i < cnt; i++) {
+      ASSERT_EQ(values[i] ? 1 : 0, bytes[i]) << "count " << cnt << ", element " << i;
+    }
+    EXPECT_EQ(0xee, bytes[cnt]);
+
+    // Any non-zero byte reads as true
+    for (size_t i = 0; i < cnt; i++) {
+      bytes[i] = bytes[i] != 0 ? static_cast<uint8_t>(i | 0x80) : 0;
+    }
+    std::vector<bool> output(cnt, false);
+    copy_bytes_to_bool_vector(output, bytes.data());
+    EXPECT_EQ(values, output) << "count " << cnt;
+  }
+}
@@ -0,0 +1,159 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "rmw/error_handling.h"
+
+#include "rosidl_typesupport_introspection_cpp/message_type_support_decl.hpp"
+
+#include "test_msgs/msg/nested.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+#include "test_msgs/msg/detail/nested__rosidl_typesupport_introspection_cpp.hpp"
+#include "test_msgs/msg/detail/unbounded_sequences__rosidl_typesupport_introspection_cpp.hpp"
+
+#include "rmw_gurumdds_cpp/cdr_view.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+
+using rmw_gurumdds_cpp::CdrView;
+using rmw_gurumdds_cpp::MessageBuffer;
+using rmw_gurumdds_cpp::MessagePlan;
+
+template<typename MessageT>
+static const rosidl_message_type_support_t * get_type_support()
+{
+  return rosidl_typesupport_introspection_cpp::get_message_type_support_handle<MessageT>();
+}
+
+template<typename MessageT>
+static size_t serialize(const MessageT & message, MessageBuffer & buffer)
+{
+  const MessagePlan * plan = MessagePlan::get(get_type_support<MessageT>());
+  size_t size = 0;
+  if (plan == nullptr || !plan->serialize(&message, buffer, &size)) {
+    return 0;
+  }
+  return size;
+}
+
+TEST(TestCdrView, reads_nested_members) {
+  test_msgs::msg::Nested message;
+  message.basic_types_value.int32_value = -123456;
+  message.basic_types_value.uint64_value = 42;
+  message.basic_types_value.float64_value = 0.125;
+  MessageBuffer buffer;
+  const size_t size = serialize(message, buffer);
+  ASSERT_GT(size, 0u);
+
+  CdrView view{get_type_support<test_msgs::msg::Nested>(), buffer.data(), size};
+  ASSERT_TRUE(view.is_valid());
+
+  int32_t int32_value = 0;
+  uint64_t uint64_value = 0;
+  double float64_value = 0.0;
+  // Read out of order, so that the later reads start from cached offsets
+  EXPECT_EQ(RMW_RET_OK, view.read("basic_types_value.uint64_value", uint64_value));
+  EXPECT_EQ(RMW_RET_OK, view.read("basic_types_value.int32_value", int32_value));
+  EXPECT_EQ(RMW_RET_OK, view.read("basic_types_value.float64_value", float64_value));
+  EXPECT_EQ(42u, uint64_value);
+  EXPECT_EQ(-123456, int32_value);
+  EXPECT_EQ(0.125, float64_value);
+}
+
+TEST(TestCdrView, reads_sequence_elements) {
+  test_msgs::msg::UnboundedSequences message;
+  message.int32_values = {5, 6, 7};
+  message.string_values = {"first", "second"};
+  message.basic_types_values.resize(3);
+  message.basic_types_values[2].int16_value = -7;
+  message.alignment_check = 99;
+  MessageBuffer buffer;
+  const size_t size = serialize(message, buffer);
+  ASSERT_GT(size, 0u);
+
+  CdrView view{get_type_support<test_msgs::msg::UnboundedSequences>(), buffer.data(), size};
+  ASSERT_TRUE(view.is_valid());
+
+  size_t count = 0;
+  EXPECT_EQ(RMW_RET_OK, view.get_size("int32_values", count));
+  EXPECT_EQ(3u, count);
+  EXPECT_EQ(RMW_RET_OK, view.get_size("float32_values", count));
+  EXPECT_EQ(0u, count);
+
+  int32_t int32_value = 0;
+  EXPECT_EQ(RMW_RET_OK, view.read("int32_values[2]", int32_value));
+  EXPECT_EQ(7, int32_value);
+  std::string string_value;
+  EXPECT_EQ(RMW_RET_OK, view.read("string_values[1]", string_value));
+  EXPECT_EQ("second", string_value);
+  int16_t int16_value = 0;
+  EXPECT_EQ(RMW_RET_OK, view.read("basic_types_values[2].int16_value", int16_value));
+  EXPECT_EQ(-7, int16_value);
+  EXPECT_EQ(RMW_RET_OK, view.read("alignment_check", int32_value));
+  EXPECT_EQ(99, int32_value);
+}
+
+TEST(TestCdrView, rejects_invalid_paths) {
+  test_msgs::msg::UnboundedSequences message;
+  message.int32_values = {1};
+  MessageBuffer buffer;
+  const size_t size = serialize(message, buffer);
+  ASSERT_GT(size, 0u);
+
+  CdrView view{get_type_support<test_msgs::msg::UnboundedSequences>(), buffer.data(), size};
+  ASSERT_TRUE(view.is_valid());
+
+  int32_t int32_value = 0;
+  double float64_value = 0.0;
+  size_t count = 0;
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.read("no_such_member", int32_value));
+  rmw_reset_error();
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.read("int32_values[1]", int32_value));
+  rmw_reset_error();
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.read("int32_values[x]", int32_value));
+  rmw_reset_error();
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.read("int32_values[0]", float64_value));
+  rmw_reset_error();
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.read("int32_values", int32_value));
+  rmw_reset_error();
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, view.get_size("alignment_check", count));
+  rmw_reset_error();
+}
+
+TEST(TestCdrView, truncated_data) {
+  test_msgs::msg::UnboundedSequences message;
+  message.int32_values = {1, 2, 3, 4};
+  message.alignment_check = 1;
+  MessageBuffer buffer;
+  const size_t size = serialize(message, buffer);
+  ASSERT_GT(size, 0u);
+
+  // Without the encapsulation header there is nothing to view
+  CdrView empty{get_type_support<test_msgs::msg::UnboundedSequences>(), buffer.data(), 2};
+  EXPECT_FALSE(empty.is_valid());
+  int32_t int32_value = 0;
+  EXPECT_EQ(RMW_RET_ERROR, empty.read("alignment_check", int32_value));
+  rmw_reset_error();
+
+  CdrView view{get_type_support<test_msgs::msg::UnboundedSequences>(), buffer.data(), size - 8};
+  ASSERT_TRUE(view.is_valid());
+  EXPECT_EQ(RMW_RET_ERROR, view.read("alignment_check", int32_value));
+  rmw_reset_error();
+}
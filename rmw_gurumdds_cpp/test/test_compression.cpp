@@ -0,0 +1,156 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+
+using rmw_gurumdds_cpp::CompressionSettings;
+using rmw_gurumdds_cpp::PayloadCompressor;
+
+// A CDR payload that compresses well: the encapsulation header, then repeated words
+static std::vector<uint8_t> make_payload(size_t size)
+{
+  std::vector<uint8_t> payload(size);
+  payload[1] = 0x01;
+  for (size_t i = 4; i < size; i++) {
+    payload[i] = static_cast<uint8_t>((i / 16) % 4);
+  }
+  return payload;
+}
+
+static PayloadCompressor make_compressor()
+{
+  CompressionSettings settings;
+  settings.threshold_bytes = 1;
+  return PayloadCompressor{settings};
+}
+
+TEST(TestCompression, plain_payloads) {
+  const std::vector<uint8_t> payload = make_payload(64);
+  EXPECT_FALSE(rmw_gurumdds_cpp::is_compressed_payload(payload.data(), payload.size()));
+  EXPECT_EQ(0u, rmw_gurumdds_cpp::get_decompressed_size(payload.data(), payload.size()));
+
+  // The marker alone is not a compressed payload without the rest of the header
+  const uint8_t marker[] = {COMPRESSED_PAYLOAD_MARKER_0, COMPRESSED_PAYLOAD_MARKER_1, 0, 0};
+  EXPECT_FALSE(rmw_gurumdds_cpp::is_compressed_payload(marker, sizeof(marker)));
+}
+
+TEST(TestCompression, round_trip) {
+  if (!rmw_gurumdds_cpp::is_compression_supported()) {
+    GTEST_SKIP() << "built without LZ4";
+  }
+  const PayloadCompressor compressor = make_compressor();
+  const std::vector<uint8_t> payload = make_payload(64 * 1024 + 3);
+  std::vector<uint8_t> compressed(compressor.get_max_compressed_size(payload.size()));
+  const size_t size =
+    compressor.compress(payload.data(), payload.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0u);
+  ASSERT_LT(size, payload.size());
+
+  EXPECT_TRUE(rmw_gurumdds_cpp::is_compressed_payload(compressed.data(), size));
+  EXPECT_EQ(payload.size(), rmw_gurumdds_cpp::get_decompressed_size(compressed.data(), size));
+  std::vector<uint8_t> output(payload.size());
+  ASSERT_TRUE(
+    rmw_gurumdds_cpp::decompress_payload(compressed.data(), size, output.data(), output.size()))
+    << rmw_get_error_string().str;
+  EXPECT_EQ(payload, output);
+}
+
+TEST(TestCompression, payloads_that_do_not_shrink) {
+  if (!rmw_gurumdds_cpp::is_compression_supported()) {
+    GTEST_SKIP() << "built without LZ4";
+  }
+  const PayloadCompressor compressor = make_compressor();
+
+  // Random bytes
+  std::vector<uint8_t> payload(256);
+  uint32_t state = 12345;
+  for (uint8_t & byte : payload) {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(state >> 16);
+  }
+  std::vector<uint8_t> compressed(compressor.get_max_compressed_size(payload.size()));
+  EXPECT_EQ(
+    0u, compressor.compress(payload.data(), payload.size(), compressed.data(), compressed.size()));
+
+  // No room for the block
+  const std::vector<uint8_t> compressible = make_payload(4096);
+  EXPECT_EQ(
+    0u, compressor.compress(
+      compressible.data(), compressible.size(), compressed.data(),
+      COMPRESSED_PAYLOAD_HEADER_SIZE));
+}
+
+TEST(TestCompression, truncated_and_corrupt_payloads) {
+  if (!rmw_gurumdds_cpp::is_compression_supported()) {
+    GTEST_SKIP() << "built without LZ4";
+  }
+  const PayloadCompressor compressor = make_compressor();
+  const std::vector<uint8_t> payload = make_payload(16 * 1024);
+  std::vector<uint8_t> compressed(compressor.get_max_compressed_size(payload.size()));
+  const size_t size =
+    compressor.compress(payload.data(), payload.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0u);
+
+  std::vector<uint8_t> output(payload.size());
+  for (size_t truncated : {size - 1, size / 2, size_t{COMPRESSED_PAYLOAD_HEADER_SIZE + 1}}) {
+    EXPECT_FALSE(
+      rmw_gurumdds_cpp::decompress_payload(
+        compressed.data(), truncated, output.data(), output.size())) << truncated;
+    EXPECT_TRUE(rmw_error_is_set());
+    rmw_reset_error();
+  }
+
+  // An uncompressed size that does not match the block
+  EXPECT_FALSE(
+    rmw_gurumdds_cpp::decompress_payload(
+      compressed.data(), size, output.data(), output.size() - 1));
+  rmw_reset_error();
+  output.resize(payload.size() + 1);
+  EXPECT_FALSE(
+    rmw_gurumdds_cpp::decompress_payload(compressed.data(), size, output.data(), output.size()));
+  rmw_reset_error();
+}
+
+TEST(TestCompression, unsupported_build) {
+  if (rmw_gurumdds_cpp::is_compression_supported()) {
+    GTEST_SKIP() << "built with LZ4";
+  }
+  const PayloadCompressor compressor = make_compressor();
+  const std::vector<uint8_t> payload = make_payload(4096);
+  std::vector<uint8_t> compressed(compressor.get_max_compressed_size(payload.size()));
+  EXPECT_EQ(
+    0u, compressor.compress(payload.data(), payload.size(), compressed.data(), compressed.size()));
+
+  // Compressed by a writer of another build
+  uint8_t header[COMPRESSED_PAYLOAD_HEADER_SIZE + 4] =
+  {COMPRESSED_PAYLOAD_MARKER_0, COMPRESSED_PAYLOAD_MARKER_1, 0, 0, 16, 0, 0, 0};
+  ASSERT_TRUE(rmw_gurumdds_cpp::is_compressed_payload(header, sizeof(header)));
+  EXPECT_EQ(16u, rmw_gurumdds_cpp::get_decompressed_size(header, sizeof(header)));
+  uint8_t output[16];
+  EXPECT_FALSE(
+    rmw_gurumdds_cpp::decompress_payload(header, sizeof(header), output, sizeof(output)));
+  EXPECT_TRUE(rmw_error_is_set());
+  rmw_reset_error();
+}
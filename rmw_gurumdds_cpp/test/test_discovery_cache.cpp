@@ -0,0 +1,284 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+
+#include "rmw_gurumdds_cpp/discovery_cache.hpp"
+
+using rmw_gurumdds_cpp::CachedEntity;
+using rmw_gurumdds_cpp::CachedParticipant;
+using rmw_gurumdds_cpp::DiscoveryCache;
+
+static const uint64_t timeout_ns = 1000;
+
+static rmw_gid_t make_gid(uint8_t seed)
+{
+  rmw_gid_t gid{};
+  for (size_t i = 0; i < RMW_GID_STORAGE_SIZE; i++) {
+    gid.data[i] = static_cast<uint8_t>(seed + i);
+  }
+  return gid;
+}
+
+static bool gid_equal(const rmw_gid_t & a, const rmw_gid_t & b)
+{
+  return std::memcmp(a.data, b.data, RMW_GID_STORAGE_SIZE) == 0;
+}
+
+static CachedEntity make_entity(uint8_t seed, const rmw_gid_t & participant_gid, bool is_reader)
+{
+  CachedEntity entity{};
+  entity.gid = make_gid(seed);
+  entity.participant_gid = participant_gid;
+  entity.topic_name = "rt/chatter";
+  entity.type_name = "std_msgs::msg::dds_::String_";
+  entity.type_hash.version = 1;
+  for (size_t i = 0; i < sizeof(entity.type_hash.value); i++) {
+    entity.type_hash.value[i] = static_cast<uint8_t>(0xf0 - i);
+  }
+  entity.qos.history = RMW_QOS_POLICY_HISTORY_KEEP_LAST;
+  entity.qos.depth = 7;
+  entity.qos.reliability = RMW_QOS_POLICY_RELIABILITY_RELIABLE;
+  entity.qos.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+  entity.qos.deadline = {1, 500};
+  entity.qos.lifespan = {2, 0};
+  entity.qos.liveliness = RMW_QOS_POLICY_LIVELINESS_AUTOMATIC;
+  entity.qos.liveliness_lease_duration = {3, 250};
+  entity.is_reader = is_reader;
+  return entity;
+}
+
+class TestDiscoveryCache : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+    rmw_reset_error();
+  }
+
+  void write_file(const std::string & contents)
+  {
+    std::ofstream file{path_, std::ios::out | std::ios::trunc};
+    file << contents;
+  }
+
+  // Saves a participant with a node and two endpoints
+  void save_graph()
+  {
+    DiscoveryCache cache{path_, timeout_ns};
+    cache.add_participant(participant_gid_, "/enclave");
+
+    rmw_dds_common::msg::ParticipantEntitiesInfo info;
+    rmw_dds_common::convert_gid_to_msg(&participant_gid_, &info.gid);
+    rmw_dds_common::msg::NodeEntitiesInfo node;
+    node.node_namespace = "/ns";
+    node.node_name = "talker";
+    rmw_dds_common::msg::Gid gid_msg;
+    rmw_dds_common::convert_gid_to_msg(&reader_.gid, &gid_msg);
+    node.reader_gid_seq.push_back(gid_msg);
+    rmw_dds_common::convert_gid_to_msg(&writer_.gid, &gid_msg);
+    node.writer_gid_seq.push_back(gid_msg);
+    info.node_entities_info_seq.push_back(node);
+    cache.update_participant(info);
+
+    cache.add_entity(reader_);
+    cache.add_entity(writer_);
+    ASSERT_TRUE(cache.save()) << rmw_get_error_string().str;
+  }
+
+  const std::string path_ = ::testing::TempDir() + "test_discovery_cache.txt";
+  const rmw_gid_t participant_gid_ = make_gid(0x10);
+  const CachedEntity reader_ = make_entity(0x40, participant_gid_, true);
+  const CachedEntity writer_ = make_entity(0x80, participant_gid_, false);
+};
+
+TEST_F(TestDiscoveryCache, save_and_load) {
+  save_graph();
+
+  DiscoveryCache cache{path_, timeout_ns};
+  std::vector<CachedParticipant> participants;
+  std::vector<CachedEntity> entities;
+  cache.load(0, participants, entities);
+
+  ASSERT_EQ(1u, participants.size());
+  const CachedParticipant & participant = participants[0];
+  EXPECT_TRUE(gid_equal(participant_gid_, participant.gid));
+  EXPECT_EQ("/enclave", participant.enclave);
+  EXPECT_FALSE(participant.confirmed);
+  EXPECT_TRUE(participant.has_nodes);
+  ASSERT_EQ(1u, participant.nodes.size());
+  EXPECT_EQ("/ns", participant.nodes[0].node_namespace);
+  EXPECT_EQ("talker", participant.nodes[0].node_name);
+  ASSERT_EQ(1u, participant.nodes[0].readers.size());
+  EXPECT_TRUE(gid_equal(reader_.gid, participant.nodes[0].readers[0]));
+  ASSERT_EQ(1u, participant.nodes[0].writers.size());
+  EXPECT_TRUE(gid_equal(writer_.gid, participant.nodes[0].writers[0]));
+
+  ASSERT_EQ(2u, entities.size());
+  for (const CachedEntity & entity : entities) {
+    const CachedEntity & expected = entity.is_reader ? reader_ : writer_;
+    EXPECT_TRUE(gid_equal(expected.gid, entity.gid));
+    EXPECT_TRUE(gid_equal(participant_gid_, entity.participant_gid));
+    EXPECT_EQ(expected.topic_name, entity.topic_name);
+    EXPECT_EQ(expected.type_name, entity.type_name);
+    EXPECT_EQ(expected.type_hash.version, entity.type_hash.version);
+    EXPECT_EQ(
+      0, std::memcmp(
+        expected.type_hash.value, entity.type_hash.value, sizeof(entity.type_hash.value)));
+    EXPECT_EQ(expected.qos.history, entity.qos.history);
+    EXPECT_EQ(expected.qos.depth, entity.qos.depth);
+    EXPECT_EQ(expected.qos.reliability, entity.qos.reliability);
+    EXPECT_EQ(expected.qos.durability, entity.qos.durability);
+    EXPECT_EQ(expected.qos.deadline.sec, entity.qos.deadline.sec);
+    EXPECT_EQ(expected.qos.deadline.nsec, entity.qos.deadline.nsec);
+    EXPECT_EQ(expected.qos.lifespan.sec, entity.qos.lifespan.sec);
+    EXPECT_EQ(expected.qos.liveliness, entity.qos.liveliness);
+    EXPECT_EQ(
+      expected.qos.liveliness_lease_duration.nsec, entity.qos.liveliness_lease_duration.nsec);
+    EXPECT_FALSE(entity.confirmed);
+  }
+}
+
+TEST_F(TestDiscoveryCache, unconfirmed_entries_expire) {
+  save_graph();
+
+  DiscoveryCache cache{path_, timeout_ns};
+  std::vector<CachedParticipant> participants;
+  std::vector<CachedEntity> entities;
+  cache.load(100, participants, entities);
+  // Nothing changed, so the first check does not write the file
+  EXPECT_TRUE(cache.save_if_due(100));
+  EXPECT_EQ(100 + timeout_ns, cache.get_deadline());
+
+  std::vector<rmw_gid_t> expired_participants;
+  std::vector<std::pair<rmw_gid_t, bool>> expired_entities;
+  cache.take_expired(100 + timeout_ns - 1, expired_participants, expired_entities);
+  EXPECT_TRUE(expired_participants.empty());
+  EXPECT_TRUE(expired_entities.empty());
+
+  // Discovery reports the participant and the writer again, the reader is gone
+  cache.add_participant(participant_gid_, "/enclave");
+  cache.add_entity(writer_);
+  cache.take_expired(100 + timeout_ns, expired_participants, expired_entities);
+  EXPECT_TRUE(expired_participants.empty());
+  ASSERT_EQ(1u, expired_entities.size());
+  EXPECT_TRUE(gid_equal(reader_.gid, expired_entities[0].first));
+  EXPECT_TRUE(expired_entities[0].second);
+
+  // Purged once
+  cache.take_expired(200 + timeout_ns, expired_participants, expired_entities);
+  EXPECT_TRUE(expired_entities.empty());
+
+  ASSERT_TRUE(cache.save()) << rmw_get_error_string().str;
+  DiscoveryCache reloaded{path_, timeout_ns};
+  reloaded.load(0, participants, entities);
+  EXPECT_EQ(1u, participants.size());
+  ASSERT_EQ(1u, entities.size());
+  EXPECT_TRUE(gid_equal(writer_.gid, entities[0].gid));
+}
+
+TEST_F(TestDiscoveryCache, discovered_entries_are_not_seeded) {
+  save_graph();
+
+  DiscoveryCache cache{path_, timeout_ns};
+  cache.add_participant(participant_gid_, "/other");
+  cache.add_entity(reader_);
+  std::vector<CachedParticipant> participants;
+  std::vector<CachedEntity> entities;
+  cache.load(0, participants, entities);
+  EXPECT_TRUE(participants.empty());
+  ASSERT_EQ(1u, entities.size());
+  EXPECT_TRUE(gid_equal(writer_.gid, entities[0].gid));
+}
+
+TEST_F(TestDiscoveryCache, removed_entries_are_not_saved) {
+  DiscoveryCache cache{path_, timeout_ns};
+  cache.add_participant(participant_gid_, "");
+  cache.add_entity(reader_);
+  cache.add_entity(writer_);
+  cache.remove_entity(reader_.gid);
+  // Saved on the first check, then once per period
+  EXPECT_TRUE(cache.save_if_due(0));
+  cache.remove_participant(participant_gid_);
+  EXPECT_TRUE(cache.save_if_due(1));
+
+  DiscoveryCache reloaded{path_, timeout_ns};
+  std::vector<CachedParticipant> participants;
+  std::vector<CachedEntity> entities;
+  reloaded.load(0, participants, entities);
+  ASSERT_EQ(1u, participants.size());
+  EXPECT_EQ("", participants[0].enclave);
+  EXPECT_FALSE(participants[0].has_nodes);
+  ASSERT_EQ(1u, entities.size());
+  EXPECT_TRUE(gid_equal(writer_.gid, entities[0].gid));
+
+  EXPECT_TRUE(cache.save_if_due(DISCOVERY_CACHE_SAVE_PERIOD_MS * 1000000ull));
+  DiscoveryCache saved_again{path_, timeout_ns};
+  saved_again.load(0, participants, entities);
+  EXPECT_TRUE(participants.empty());
+  EXPECT_EQ(1u, entities.size());
+}
+
+TEST_F(TestDiscoveryCache, missing_file) {
+  DiscoveryCache cache{path_ + ".missing", timeout_ns};
+  std::vector<CachedParticipant> participants;
+  std::vector<CachedEntity> entities;
+  cache.load(0, participants, entities);
+  EXPECT_TRUE(participants.empty());
+  EXPECT_TRUE(entities.empty());
+}
+
+TEST_F(TestDiscoveryCache, malformed_files_are_ignored) {
+  const std::string header =
+    std::string(DISCOVERY_CACHE_MAGIC) + ' ' + std::to_string(DISCOVERY_CACHE_VERSION) + '\n';
+  const std::string gid(RMW_GID_STORAGE_SIZE * 2, 'a');
+  const std::string participant = "participant " + gid + " /enclave\n";
+  const std::string malformed[] = {
+    "",
+    "not_a_discovery_cache 1\n" + participant,
+    std::string(DISCOVERY_CACHE_MAGIC) + " 999\n" + participant,
+    header + "participant 0123\n",
+    header + "participant " + std::string(RMW_GID_STORAGE_SIZE * 2, 'z') + "\n",
+    header + participant + "unknown line\n",
+    // Nodes and their endpoints belong to a participant
+    header + "node /ns talker\n",
+    header + participant + "node_reader " + gid + "\n",
+    header + participant + "writer " + gid + " " + gid + " rt/chatter\n",
+  };
+
+  for (const std::string & contents : malformed) {
+    write_file(contents);
+    DiscoveryCache cache{path_, timeout_ns};
+    std::vector<CachedParticipant> participants;
+    std::vector<CachedEntity> entities;
+    cache.load(0, participants, entities);
+    EXPECT_TRUE(participants.empty()) << contents;
+    EXPECT_TRUE(entities.empty()) << contents;
+    EXPECT_EQ(UINT64_C(0), cache.get_deadline()) << contents;
+  }
+}
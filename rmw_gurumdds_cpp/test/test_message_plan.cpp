@@ -0,0 +1,234 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rmw/error_handling.h"
+
+#include "rosidl_runtime_c/string_functions.h"
+#include "rosidl_typesupport_introspection_cpp/message_type_support_decl.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/nested.hpp"
+#include "test_msgs/msg/strings.h"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+#include "test_msgs/msg/detail/basic_types__rosidl_typesupport_introspection_cpp.hpp"
+#include "test_msgs/msg/detail/nested__rosidl_typesupport_introspection_cpp.hpp"
+#include "test_msgs/msg/detail/strings__rosidl_typesupport_introspection_c.h"
+#include "test_msgs/msg/detail/unbounded_sequences__rosidl_typesupport_introspection_cpp.hpp"
+
+#include "rmw_gurumdds_cpp/cdr_buffer.hpp"
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/message_buffer.hpp"
+#include "rmw_gurumdds_cpp/message_plan.hpp"
+
+using rmw_gurumdds_cpp::MessageBuffer;
+using rmw_gurumdds_cpp::MessagePlan;
+
+template<typename MessageT>
+static const MessagePlan * get_plan()
+{
+  return MessagePlan::get(
+    rosidl_typesupport_introspection_cpp::get_message_type_support_handle<MessageT>());
+}
+
+static test_msgs::msg::BasicTypes make_basic_types()
+{
+  test_msgs::msg::BasicTypes message;
+  message.bool_value = true;
+  message.byte_value = 0xa5;
+  message.char_value = 'x';
+  message.float32_value = 1.5f;
+  message.float64_value = -2.25;
+  message.int8_value = -8;
+  message.uint8_value = 8;
+  message.int16_value = -1600;
+  message.uint16_value = 1600;
+  message.int32_value = -320000;
+  message.uint32_value = 320000;
+  message.int64_value = -6400000000LL;
+  message.uint64_value = 6400000000ULL;
+  return message;
+}
+
+TEST(TestMessagePlan, basic_types_round_trip) {
+  const MessagePlan * plan = get_plan<test_msgs::msg::BasicTypes>();
+  ASSERT_NE(nullptr, plan);
+  EXPECT_TRUE(plan->is_bounded());
+
+  const test_msgs::msg::BasicTypes message = make_basic_types();
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+  EXPECT_EQ(static_cast<ssize_t>(size), plan->get_serialized_size(&message));
+  EXPECT_LE(size, plan->get_max_serialized_size());
+  EXPECT_EQ(CDR_SYSTEM_ENDIAN, buffer.data()[CDR_HEADER_ENDIAN_IDX]);
+  // The members that follow the three single bytes are aligned from the end of the header
+  EXPECT_EQ(0x01, buffer.data()[CDR_HEADER_SIZE]);
+  EXPECT_EQ(0xa5, buffer.data()[CDR_HEADER_SIZE + 1]);
+  float float32_value = 0.0f;
+  std::memcpy(&float32_value, buffer.data() + CDR_HEADER_SIZE + 4, sizeof(float32_value));
+  EXPECT_EQ(1.5f, float32_value);
+
+  test_msgs::msg::BasicTypes output;
+  ASSERT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  EXPECT_EQ(message, output);
+}
+
+TEST(TestMessagePlan, bools_are_normalized) {
+  const MessagePlan * plan = get_plan<test_msgs::msg::BasicTypes>();
+  ASSERT_NE(nullptr, plan);
+
+  const test_msgs::msg::BasicTypes message = make_basic_types();
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+
+  // Writers of other implementations may send any non-zero byte for true
+  buffer.data()[CDR_HEADER_SIZE] = 0x7f;
+  test_msgs::msg::BasicTypes output;
+  ASSERT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  uint8_t stored = 0;
+  std::memcpy(&stored, &output.bool_value, sizeof(stored));
+  EXPECT_EQ(1u, stored);
+}
+
+TEST(TestMessagePlan, nested_round_trip) {
+  const MessagePlan * plan = get_plan<test_msgs::msg::Nested>();
+  ASSERT_NE(nullptr, plan);
+
+  test_msgs::msg::Nested message;
+  message.basic_types_value = make_basic_types();
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+
+  test_msgs::msg::Nested output;
+  ASSERT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  EXPECT_EQ(message, output);
+}
+
+TEST(TestMessagePlan, unbounded_sequences_round_trip) {
+  const MessagePlan * plan = get_plan<test_msgs::msg::UnboundedSequences>();
+  ASSERT_NE(nullptr, plan);
+  EXPECT_FALSE(plan->is_bounded());
+  EXPECT_EQ(0u, plan->get_max_serialized_size());
+
+  test_msgs::msg::UnboundedSequences message;
+  message.bool_values = {true, false, true, true, false};
+  message.byte_values = {0x00, 0xff};
+  message.float64_values = {1.0, -1.0, 0.5};
+  message.int16_values = {-1, 2, -3};
+  message.int32_values = {10, 20, 30, 40};
+  message.uint64_values = {UINT64_MAX};
+  message.string_values = {"", "one", "two words"};
+  message.basic_types_values = {make_basic_types(), test_msgs::msg::BasicTypes{}};
+  message.alignment_check = 42;
+
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+  EXPECT_EQ(static_cast<ssize_t>(size), plan->get_serialized_size(&message));
+
+  test_msgs::msg::UnboundedSequences output;
+  ASSERT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  EXPECT_EQ(message, output);
+
+  // Reusing the output shrinks the sequences it held
+  test_msgs::msg::UnboundedSequences empty;
+  ASSERT_TRUE(plan->serialize(&empty, buffer, &size));
+  ASSERT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  EXPECT_EQ(empty, output);
+}
+
+TEST(TestMessagePlan, truncated_payload_fails) {
+  const MessagePlan * plan = get_plan<test_msgs::msg::UnboundedSequences>();
+  ASSERT_NE(nullptr, plan);
+
+  test_msgs::msg::UnboundedSequences message;
+  message.int32_values = {1, 2, 3, 4, 5, 6, 7, 8};
+  message.string_values = {"truncated"};
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+
+  test_msgs::msg::UnboundedSequences output;
+  for (size_t truncated : {size_t{0}, size_t{2}, size_t{CDR_HEADER_SIZE + 2}, size / 2}) {
+    EXPECT_FALSE(plan->deserialize(&output, buffer.data(), truncated)) << truncated;
+    rmw_reset_error();
+  }
+}
+
+TEST(TestMessagePlan, c_strings_round_trip) {
+  const rosidl_message_type_support_t * type_support =
+    ROSIDL_TYPESUPPORT_INTERFACE__MESSAGE_SYMBOL_NAME(
+    rosidl_typesupport_introspection_c, test_msgs, msg, Strings)();
+  const MessagePlan * plan = MessagePlan::get(type_support);
+  ASSERT_NE(nullptr, plan);
+
+  test_msgs__msg__Strings message;
+  ASSERT_TRUE(test_msgs__msg__Strings__init(&message));
+  ASSERT_TRUE(rosidl_runtime_c__String__assign(&message.string_value, "a longer string value"));
+  ASSERT_TRUE(rosidl_runtime_c__String__assign(&message.bounded_string_value, "bounded"));
+
+  MessageBuffer buffer;
+  size_t size = 0;
+  EXPECT_TRUE(plan->serialize(&message, buffer, &size));
+
+  test_msgs__msg__Strings output;
+  ASSERT_TRUE(test_msgs__msg__Strings__init(&output));
+  EXPECT_TRUE(plan->deserialize(&output, buffer.data(), size));
+  EXPECT_TRUE(test_msgs__msg__Strings__are_equal(&message, &output));
+
+  test_msgs__msg__Strings__fini(&output);
+  test_msgs__msg__Strings__fini(&message);
+}
+
+TEST(TestMessagePlan, compressed_round_trip) {
+  if (!rmw_gurumdds_cpp::is_compression_supported()) {
+    GTEST_SKIP() << "built without LZ4";
+  }
+  const MessagePlan * plan = get_plan<test_msgs::msg::UnboundedSequences>();
+  ASSERT_NE(nullptr, plan);
+
+  test_msgs::msg::UnboundedSequences message;
+  message.int32_values.assign(4096, 7);
+  MessageBuffer buffer;
+  size_t size = 0;
+  ASSERT_TRUE(plan->serialize(&message, buffer, &size));
+
+  rmw_gurumdds_cpp::CompressionSettings settings;
+  settings.threshold_bytes = 1;
+  rmw_gurumdds_cpp::PayloadCompressor compressor{settings};
+  std::vector<uint8_t> compressed(compressor.get_max_compressed_size(size));
+  const size_t compressed_size =
+    compressor.compress(buffer.data(), size, compressed.data(), compressed.size());
+  ASSERT_GT(compressed_size, 0u);
+  ASSERT_LT(compressed_size, size);
+
+  test_msgs::msg::UnboundedSequences output;
+  ASSERT_TRUE(plan->deserialize(&output, compressed.data(), compressed_size));
+  EXPECT_EQ(message, output);
+
+  // A truncated block does not decompress to the size of its header
+  EXPECT_FALSE(plan->deserialize(&output, compressed.data(), compressed_size - 1));
+  rmw_reset_error();
+}
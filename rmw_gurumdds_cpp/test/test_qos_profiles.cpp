@@ -0,0 +1,205 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+
+using rmw_gurumdds_cpp::QosProfiles;
+
+class TestQosProfiles : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+    rmw_reset_error();
+  }
+
+  bool load(const std::string & contents)
+  {
+    std::ofstream file{path_, std::ios::out | std::ios::trunc};
+    file << contents;
+    file.close();
+    return profiles_.load(path_);
+  }
+
+  const std::string path_ = ::testing::TempDir() + "test_qos_profiles.ini";
+  QosProfiles profiles_;
+};
+
+TEST_F(TestQosProfiles, applies_matching_sections) {
+  ASSERT_TRUE(
+    load(
+      "# Comments and blank lines are skipped\n"
+      "\n"
+      "[topic /sensors/*]\n"
+      "history.depth = 5  # trailing comment\n"
+      "latency_budget.duration_us = 1500000\n"
+      "[writer /sensors/camera]\n"
+      "reliability.max_blocking_time_us = 2500\n"
+      "transport_priority.value = 3\n"
+      "[reader /sensors/?amera]\n"
+      "history.depth = 9\n"
+      "time_based_filter.minimum_separation_us = 100000\n")) << rmw_get_error_string().str;
+  EXPECT_FALSE(profiles_.empty());
+
+  dds_DataWriterQos writer_qos{};
+  writer_qos.history.kind = dds_KEEP_LAST_HISTORY_QOS;
+  profiles_.apply("/sensors/camera", writer_qos);
+  EXPECT_EQ(5, writer_qos.history.depth);
+  EXPECT_EQ(1, writer_qos.latency_budget.duration.sec);
+  EXPECT_EQ(500000000u, writer_qos.latency_budget.duration.nanosec);
+  EXPECT_EQ(0, writer_qos.reliability.max_blocking_time.sec);
+  EXPECT_EQ(2500000u, writer_qos.reliability.max_blocking_time.nanosec);
+  EXPECT_EQ(3, writer_qos.transport_priority.value);
+
+  // Later sections win
+  dds_DataReaderQos reader_qos{};
+  reader_qos.history.kind = dds_KEEP_LAST_HISTORY_QOS;
+  profiles_.apply("/sensors/camera", reader_qos);
+  EXPECT_EQ(9, reader_qos.history.depth);
+  EXPECT_EQ(100000000u, reader_qos.time_based_filter.minimum_separation.nanosec);
+
+  // A KEEP_ALL history has no depth to override
+  dds_DataWriterQos keep_all_qos{};
+  keep_all_qos.history.kind = dds_KEEP_ALL_HISTORY_QOS;
+  keep_all_qos.history.depth = 1;
+  profiles_.apply("/sensors/lidar", keep_all_qos);
+  EXPECT_EQ(1, keep_all_qos.history.depth);
+
+  dds_DataWriterQos other_qos{};
+  other_qos.history.kind = dds_KEEP_LAST_HISTORY_QOS;
+  other_qos.history.depth = 1;
+  profiles_.apply("/chatter", other_qos);
+  EXPECT_EQ(1, other_qos.history.depth);
+  EXPECT_EQ(0, other_qos.transport_priority.value);
+}
+
+TEST_F(TestQosProfiles, endpoint_settings) {
+  ASSERT_TRUE(
+    load(
+      "[writer /fast]\n"
+      "async_publish.queue_depth = 16\n"
+      "async_publish.block_when_full = 1\n"
+      "[writer /limited]\n"
+      "flow_controller.bytes_per_second = 1000000\n"
+      "compression.threshold_bytes = 4096\n"
+      "compression.acceleration = 100000\n"
+      "[reader /fast]\n"
+      "latency_stats.enabled = 1\n"
+      "sequence_gaps.message_lost = 1\n")) << rmw_get_error_string().str;
+
+  const rmw_gurumdds_cpp::AsyncPublishSettings fast = profiles_.get_async_publish_settings("/fast");
+  EXPECT_EQ(16u, fast.queue_depth);
+  EXPECT_TRUE(fast.block_when_full);
+  EXPECT_EQ(0u, fast.bytes_per_second);
+
+  // A flow controller publishes asynchronously, with a default queue and burst
+  const rmw_gurumdds_cpp::AsyncPublishSettings limited =
+    profiles_.get_async_publish_settings("/limited");
+  EXPECT_EQ(static_cast<size_t>(FLOW_CONTROLLER_QUEUE_DEPTH), limited.queue_depth);
+  EXPECT_EQ(1000000u, limited.bytes_per_second);
+  EXPECT_EQ(
+    static_cast<size_t>(1000000 / (1000000 / FLOW_CONTROLLER_BURST_US)),
+    limited.burst_bytes);
+
+  const rmw_gurumdds_cpp::CompressionSettings compression =
+    profiles_.get_compression_settings("/limited");
+  EXPECT_EQ(4096u, compression.threshold_bytes);
+  EXPECT_EQ(65537, compression.acceleration);
+  EXPECT_FALSE(profiles_.get_compression_settings("/fast").enabled());
+
+  EXPECT_TRUE(profiles_.is_latency_stats_enabled("/fast"));
+  EXPECT_TRUE(profiles_.is_sequence_gap_lost_enabled("/fast"));
+  EXPECT_FALSE(profiles_.is_latency_stats_enabled("/limited"));
+}
+
+TEST_F(TestQosProfiles, locators_and_participant_properties) {
+  ASSERT_TRUE(
+    load(
+      "[participant]\n"
+      "fragmentation.fragment_size = 8192\n"
+      "rtps.heartbeat_period_ms = 50\n"
+      "[topic /map]\n"
+      "locators.multicast = 1\n"
+      "[topic /points*]\n"
+      "locators.multicast_min_readers = 3\n")) << rmw_get_error_string().str;
+
+  const auto & properties = profiles_.get_participant_properties();
+  ASSERT_EQ(2u, properties.size());
+  EXPECT_EQ(RTPS_FRAGMENT_SIZE_PROPERTY, properties[0].first);
+  EXPECT_EQ("8192", properties[0].second);
+  EXPECT_EQ("rtps.heartbeat_period_ms", properties[1].first);
+  EXPECT_EQ("50", properties[1].second);
+
+  EXPECT_EQ(LOCATOR_POLICY_MULTICAST, profiles_.get_locator_settings("/map").policy);
+  const rmw_gurumdds_cpp::LocatorSettings points = profiles_.get_locator_settings("/points2");
+  EXPECT_EQ(LOCATOR_POLICY_AUTO, points.policy);
+  EXPECT_EQ(3u, points.multicast_min_readers);
+  EXPECT_EQ(LOCATOR_POLICY_DEFAULT, profiles_.get_locator_settings("/chatter").policy);
+  EXPECT_EQ("rt/map=multicast,rt/points*=auto:3", profiles_.get_locator_policy_property());
+}
+
+TEST_F(TestQosProfiles, empty_file) {
+  ASSERT_TRUE(load("# nothing but a comment\n\n")) << rmw_get_error_string().str;
+  EXPECT_TRUE(profiles_.empty());
+}
+
+TEST_F(TestQosProfiles, missing_file) {
+  EXPECT_FALSE(profiles_.load(path_ + ".missing"));
+  EXPECT_TRUE(rmw_error_is_set());
+}
+
+TEST_F(TestQosProfiles, malformed_files) {
+  const char * malformed[] = {
+    // Settings outside of a section
+    "history.depth = 5\n",
+    "[topic /a\nhistory.depth = 5\n",
+    "[service /a]\n",
+    "[topic]\n",
+    "[participant /a]\n",
+    "[topic /a]\nhistory.depth\n",
+    "[topic /a]\n= 5\n",
+    "[topic /a]\nhistory.size = 5\n",
+    "[topic /a]\nhistory.depth =\n",
+    "[topic /a]\nhistory.depth = five\n",
+    "[topic /a]\nhistory.depth = 5x\n",
+    "[topic /a]\nhistory.depth = -1\n",
+    "[topic /a]\nhistory.depth = 99999999999999999999\n",
+    // Both ends of a topic must agree on its locators
+    "[writer /a]\nlocators.multicast = 1\n",
+    "[reader /a]\nlocators.multicast_min_readers = 2\n",
+    "[topic /a]\nlocators.multicast = 2\n",
+    "[writer /a]\nflow_controller.priority = 3\n",
+    "[participant]\nfragmentation.fragment_size = 100\n",
+    "[participant]\nfragmentation.fragment_size = 70000\n",
+    "[participant]\nflow_control.send_window = 0\n",
+    "[participant]\nflow_control.bytes_per_second = fast\n",
+  };
+
+  for (const char * contents : malformed) {
+    EXPECT_FALSE(load(contents)) << contents;
+    EXPECT_TRUE(rmw_error_is_set()) << contents;
+    rmw_reset_error();
+  }
+}
@@ -0,0 +1,229 @@
+// Copyright 2024 GurumNetworks, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_gurumdds_cpp/compression.hpp"
+#include "rmw_gurumdds_cpp/qos_profiles.hpp"
+#include "rmw_gurumdds_cpp/raw_capture.hpp"
+
+using rmw_gurumdds_cpp::RawCaptureReader;
+using rmw_gurumdds_cpp::RawCaptureRecord;
+using rmw_gurumdds_cpp::RawCaptureRecordHeader;
+using rmw_gurumdds_cpp::RawCaptureStatus;
+using rmw_gurumdds_cpp::RawCaptureWriter;
+
+class TestRawCapture : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+    std::remove(copy_path_.c_str());
+    rmw_reset_error();
+  }
+
+  // Appends a payload whose bytes and timestamps derive from the sequence number
+  void append(RawCaptureWriter & writer, int64_t sequence_number, size_t size)
+  {
+    std::vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; i++) {
+      payload[i] = static_cast<uint8_t>(sequence_number + i);
+    }
+    RawCaptureRecordHeader header{};
+    header.sequence_number = sequence_number;
+    header.source_timestamp = sequence_number * 10 - 1;
+    header.reception_timestamp = sequence_number * 10;
+    header.writer_gid[0] = 0x42;
+    writer.append(payload.data(), static_cast<uint32_t>(size), header);
+  }
+
+  static void expect_record(const RawCaptureRecord & record, int64_t sequence_number, size_t size)
+  {
+    ASSERT_NE(nullptr, record.header);
+    EXPECT_EQ(sequence_number, record.header->sequence_number);
+    EXPECT_EQ(sequence_number * 10 - 1, record.header->source_timestamp);
+    EXPECT_EQ(sequence_number * 10, record.header->reception_timestamp);
+    EXPECT_EQ(0x42, record.header->writer_gid[0]);
+    ASSERT_EQ(size, record.header->size);
+    for (size_t i = 0; i < size; i++) {
+      ASSERT_EQ(static_cast<uint8_t>(sequence_number + i), record.payload[i]) << i;
+    }
+  }
+
+  const std::string path_ = ::testing::TempDir() + "test_raw_capture.cap";
+  const std::string copy_path_ = path_ + ".copy";
+};
+
+#if !defined(_WIN32)
+TEST_F(TestRawCapture, write_and_read) {
+  RawCaptureWriter writer;
+  ASSERT_TRUE(writer.open(path_.c_str(), 0, "/chatter", "std_msgs/msg/String"))
+    << rmw_get_error_string().str;
+  for (int64_t i = 0; i < 10; i++) {
+    append(writer, i, 1 + static_cast<size_t>(i) * 3);
+  }
+
+  RawCaptureReader reader;
+  ASSERT_TRUE(reader.open(path_.c_str())) << rmw_get_error_string().str;
+  const rmw_gurumdds_cpp::RawCaptureFileHeader * header = reader.get_header();
+  EXPECT_EQ(RAW_CAPTURE_MAGIC, header->magic);
+  EXPECT_STREQ("/chatter", header->topic_name);
+  EXPECT_STREQ("std_msgs/msg/String", header->type_name);
+  EXPECT_EQ(10u, header->record_count);
+
+  RawCaptureRecord record;
+  for (int64_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(reader.next(record)) << i;
+    expect_record(record, i, 1 + static_cast<size_t>(i) * 3);
+    EXPECT_EQ(static_cast<uint64_t>(i), record.header->record);
+  }
+  EXPECT_FALSE(reader.next(record));
+
+  // Records appended while the file is read are picked up
+  append(writer, 10, 8);
+  ASSERT_TRUE(reader.next(record));
+  expect_record(record, 10, 8);
+
+  RawCaptureStatus status;
+  writer.get_status(status);
+  EXPECT_EQ(11u, status.captured_count);
+  EXPECT_EQ(0u, status.overwritten_count);
+  EXPECT_EQ(0u, status.dropped_count);
+}
+
+TEST_F(TestRawCapture, ring_overwrites_oldest_records) {
+  RawCaptureWriter writer;
+  ASSERT_TRUE(writer.open(path_.c_str(), RAW_CAPTURE_MIN_SIZE, "/points", "pkg/msg/Points"))
+    << rmw_get_error_string().str;
+  const size_t size = 100 * 1000 + 5;
+  for (int64_t i = 0; i < 40; i++) {
+    append(writer, i, size);
+  }
+  // Larger than the whole ring
+  append(writer, 40, RAW_CAPTURE_MIN_SIZE);
+
+  RawCaptureStatus status;
+  writer.get_status(status);
+  EXPECT_EQ(40u, status.captured_count);
+  EXPECT_GT(status.overwritten_count, 0u);
+  EXPECT_EQ(1u, status.dropped_count);
+
+  RawCaptureReader reader;
+  ASSERT_TRUE(reader.open(path_.c_str())) << rmw_get_error_string().str;
+  RawCaptureRecord record;
+  int64_t expected = static_cast<int64_t>(status.overwritten_count);
+  while (reader.next(record)) {
+    expect_record(record, expected, size);
+    expected++;
+  }
+  EXPECT_EQ(40, expected);
+}
+
+TEST_F(TestRawCapture, seek_by_reception_time) {
+  RawCaptureWriter writer;
+  ASSERT_TRUE(writer.open(path_.c_str(), 0, "/imu", "sensor_msgs/msg/Imu"))
+    << rmw_get_error_string().str;
+  // Several index intervals
+  for (int64_t i = 0; i < 5 * RAW_CAPTURE_INDEX_INTERVAL; i++) {
+    append(writer, i, 16);
+  }
+
+  RawCaptureReader reader;
+  ASSERT_TRUE(reader.open(path_.c_str())) << rmw_get_error_string().str;
+  RawCaptureRecord record;
+
+  reader.seek(1005);
+  ASSERT_TRUE(reader.next(record));
+  expect_record(record, 101, 16);
+
+  reader.seek(RAW_CAPTURE_INDEX_INTERVAL * 20);
+  ASSERT_TRUE(reader.next(record));
+  expect_record(record, 2 * RAW_CAPTURE_INDEX_INTERVAL, 16);
+
+  reader.seek(0);
+  ASSERT_TRUE(reader.next(record));
+  expect_record(record, 0, 16);
+
+  reader.seek(INT64_MAX);
+  EXPECT_FALSE(reader.next(record));
+}
+
+TEST_F(TestRawCapture, compressed_records) {
+  RawCaptureWriter writer;
+  ASSERT_TRUE(writer.open(path_.c_str(), 0, "/map", "nav_msgs/msg/OccupancyGrid"))
+    << rmw_get_error_string().str;
+
+  // Captured as the writer sent it, with the flag set from its marker
+  uint8_t payload[COMPRESSED_PAYLOAD_HEADER_SIZE + 4] =
+  {COMPRESSED_PAYLOAD_MARKER_0, COMPRESSED_PAYLOAD_MARKER_1, 0, 0, 32, 0, 0, 0, 1, 2, 3, 4};
+  RawCaptureRecordHeader header{};
+  header.flags = rmw_gurumdds_cpp::is_compressed_payload(payload, sizeof(payload)) ?
+    RAW_CAPTURE_COMPRESSED : 0;
+  writer.append(payload, sizeof(payload), header);
+
+  RawCaptureReader reader;
+  ASSERT_TRUE(reader.open(path_.c_str())) << rmw_get_error_string().str;
+  RawCaptureRecord record;
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(static_cast<uint32_t>(RAW_CAPTURE_COMPRESSED), record.header->flags);
+  ASSERT_EQ(sizeof(payload), record.header->size);
+  EXPECT_EQ(0, std::memcmp(payload, record.payload, sizeof(payload)));
+  EXPECT_TRUE(rmw_gurumdds_cpp::is_compressed_payload(record.payload, record.header->size));
+  EXPECT_EQ(32u, rmw_gurumdds_cpp::get_decompressed_size(record.payload, record.header->size));
+}
+
+TEST_F(TestRawCapture, invalid_files) {
+  RawCaptureWriter writer;
+  EXPECT_FALSE(writer.open(path_.c_str(), RAW_CAPTURE_MIN_SIZE - 1, "/a", "pkg/msg/A"));
+  rmw_reset_error();
+
+  RawCaptureReader reader;
+  EXPECT_FALSE(reader.open((path_ + ".missing").c_str()));
+  rmw_reset_error();
+
+  {
+    std::ofstream file{path_, std::ios::out | std::ios::trunc};
+    file << std::string(4096, 'x');
+  }
+  EXPECT_FALSE(reader.open(path_.c_str()));
+  rmw_reset_error();
+
+  // A capture file cut short
+  ASSERT_TRUE(writer.open(path_.c_str(), 0, "/a", "pkg/msg/A")) << rmw_get_error_string().str;
+  append(writer, 0, 16);
+  writer.sync();
+  {
+    std::ifstream in{path_, std::ios::binary};
+    std::vector<char> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    ASSERT_GT(data.size(), 4096u);
+    std::ofstream out{copy_path_, std::ios::binary | std::ios::trunc};
+    out.write(data.data(), 4096);
+  }
+  EXPECT_FALSE(reader.open(copy_path_.c_str()));
+  rmw_reset_error();
+}
+#endif